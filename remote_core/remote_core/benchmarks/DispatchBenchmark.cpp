@@ -0,0 +1,156 @@
+//
+//  DispatchBenchmark.cpp
+//  remote_core_dispatch_benchmark
+//
+//  Created by David Moore on 10/19/26.
+//  Copyright © 2026 David Moore. All rights reserved.
+//
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <thread>
+#include <vector>
+#include "DispatchQueue.hpp"
+#include "LegacyDispatchQueue.hpp"
+#include "TestSupport.hpp"
+
+using namespace RemoteCore;
+
+typedef std::chrono::steady_clock Clock;
+
+namespace {
+    void waitForCount(const std::atomic<size_t> &counter, size_t count) {
+        while (counter.load() < count) {
+            std::this_thread::yield();
+        }
+    }
+    
+    void printThroughput(const char *implementation, const char *scenario, size_t blockCount, Clock::duration duration) {
+        double seconds = std::chrono::duration<double>(duration).count();
+        printf("%-8s %-40s %10.0f blocks/s\n", implementation, scenario, blockCount / seconds);
+    }
+    
+    /**
+     One producer executing trivial blocks on a single serial queue.
+     */
+    template <typename Queue>
+    void benchmarkSerialThroughput(const char *implementation, size_t blockCount) {
+        std::atomic<size_t> counter(0);
+        auto queue = std::make_unique<Queue>("benchmark.serial", 1);
+        
+        auto startTime = Clock::now();
+        for (size_t i = 0; i < blockCount; i++) {
+            queue->execute([&counter]() {
+                counter++;
+            });
+        }
+        
+        waitForCount(counter, blockCount);
+        printThroughput(implementation, "serial queue, 1 producer", blockCount, Clock::now() - startTime);
+    }
+    
+    /**
+     Several producers executing trivial blocks on one concurrent queue.
+     */
+    template <typename Queue>
+    void benchmarkConcurrentThroughput(const char *implementation, size_t blockCount, size_t threadCount) {
+        std::atomic<size_t> counter(0);
+        auto queue = std::make_unique<Queue>("benchmark.concurrent", threadCount);
+        
+        auto startTime = Clock::now();
+        std::vector<std::thread> producers;
+        for (size_t i = 0; i < threadCount; i++) {
+            producers.emplace_back([&]() {
+                for (size_t j = 0; j < blockCount / threadCount; j++) {
+                    queue->execute([&counter]() {
+                        counter++;
+                    });
+                }
+            });
+        }
+        
+        for (auto &producer : producers) {
+            producer.join();
+        }
+        
+        waitForCount(counter, (blockCount / threadCount) * threadCount);
+        
+        char scenario[64];
+        snprintf(scenario, sizeof(scenario), "%zu-thread queue, %zu producers", threadCount, threadCount);
+        printThroughput(implementation, scenario, blockCount, Clock::now() - startTime);
+    }
+    
+    /**
+     One producer spreading trivial blocks across many serial queues, like the controllers of the daemon do.
+     */
+    template <typename Queue>
+    void benchmarkManySerialQueues(const char *implementation, size_t blockCount, size_t queueCount) {
+        std::atomic<size_t> counter(0);
+        std::vector<std::unique_ptr<Queue>> queues;
+        for (size_t i = 0; i < queueCount; i++) {
+            queues.push_back(std::make_unique<Queue>("benchmark.many", 1));
+        }
+        
+        auto startTime = Clock::now();
+        for (size_t i = 0; i < blockCount; i++) {
+            queues[i % queueCount]->execute([&counter]() {
+                counter++;
+            });
+        }
+        
+        waitForCount(counter, blockCount);
+        
+        char scenario[64];
+        snprintf(scenario, sizeof(scenario), "%zu serial queues, 1 producer", queueCount);
+        printThroughput(implementation, scenario, blockCount, Clock::now() - startTime);
+    }
+    
+    /**
+     Time from executing a block until it starts running, on an otherwise idle queue.
+     */
+    template <typename Queue>
+    void benchmarkLatency(const char *implementation, size_t sampleCount, size_t threadCount) {
+        std::vector<Clock::duration> latencies(sampleCount);
+        std::atomic<size_t> counter(0);
+        auto queue = std::make_unique<Queue>("benchmark.latency", threadCount);
+        
+        for (size_t i = 0; i < sampleCount; i++) {
+            auto executeTime = Clock::now();
+            queue->execute([&latencies, &counter, executeTime, i]() {
+                latencies[i] = Clock::now() - executeTime;
+                counter++;
+            });
+            
+            waitForCount(counter, i + 1);
+            std::this_thread::sleep_for(std::chrono::microseconds(50));
+        }
+        
+        std::sort(latencies.begin(), latencies.end());
+        printf("%-8s %zu-thread queue latency %19s p50 %7.1f us, p99 %7.1f us\n", implementation, threadCount, "", TestSupport::percentile(latencies, 0.5), TestSupport::percentile(latencies, 0.99));
+    }
+}
+
+int main(int argc, const char *argv[]) {
+    size_t blockCount = argc > 1 ? (size_t)std::atol(argv[1]) : 1000000;
+    size_t threadCount = std::max(2u, std::thread::hardware_concurrency());
+    
+    benchmarkSerialThroughput<LegacyDispatchQueue>("legacy", blockCount);
+    benchmarkSerialThroughput<DispatchQueue>("current", blockCount);
+    
+    benchmarkConcurrentThroughput<LegacyDispatchQueue>("legacy", blockCount, threadCount);
+    benchmarkConcurrentThroughput<DispatchQueue>("current", blockCount, threadCount);
+    
+    benchmarkManySerialQueues<LegacyDispatchQueue>("legacy", blockCount, 16);
+    benchmarkManySerialQueues<DispatchQueue>("current", blockCount, 16);
+    
+    benchmarkLatency<LegacyDispatchQueue>("legacy", 2000, 1);
+    benchmarkLatency<DispatchQueue>("current", 2000, 1);
+    benchmarkLatency<LegacyDispatchQueue>("legacy", 2000, threadCount);
+    benchmarkLatency<DispatchQueue>("current", 2000, threadCount);
+    
+    return 0;
+}
@@ -0,0 +1,84 @@
+//
+//  LegacyDispatchQueue.hpp
+//  remote_core_dispatch_benchmark
+//
+//  Created by David Moore on 10/19/26.
+//  Copyright © 2026 David Moore. All rights reserved.
+//
+
+#ifndef LegacyDispatchQueue_hpp
+#define LegacyDispatchQueue_hpp
+
+#include <functional>
+#include <thread>
+#include <queue>
+#include <atomic>
+#include <mutex>
+#include <vector>
+#include <string>
+#include <condition_variable>
+
+namespace RemoteCore {
+    /**
+     The original DispatchQueue implementation (a single mutex guarding a std::queue of std::function, with every thread woken on each execution), kept as a baseline for the dispatch benchmark.
+     */
+    class LegacyDispatchQueue {
+    public:
+        typedef std::function<void (void)> Block;
+    
+    private:
+        std::string name;
+        std::mutex queueMutex;
+        std::queue<Block> blockQueue;
+        std::vector<std::thread> threads;
+        std::condition_variable threadCondition;
+        std::atomic_bool shouldQuit;
+        
+        void threadHandler(void) {
+            std::unique_lock<std::mutex> lock(queueMutex);
+            
+            do {
+                threadCondition.wait(lock, [this]() {
+                    return blockQueue.size() || shouldQuit;
+                });
+                
+                if (blockQueue.size()) {
+                    auto block = std::move(blockQueue.front());
+                    blockQueue.pop();
+                    
+                    lock.unlock();
+                    block();
+                    lock.lock();
+                }
+            } while (!shouldQuit);
+        }
+    
+    public:
+        LegacyDispatchQueue(std::string name, size_t threadCount = 1) : name(name), threads(threadCount), shouldQuit(false) {
+            for (size_t i = 0; i < threads.size(); i++) {
+                threads[i] = std::thread(std::bind(&LegacyDispatchQueue::threadHandler, this));
+            }
+        }
+        
+        ~LegacyDispatchQueue() {
+            shouldQuit = true;
+            threadCondition.notify_all();
+            
+            for (auto &thread : threads) {
+                if (thread.joinable()) {
+                    thread.join();
+                }
+            }
+        }
+        
+        void execute(Block block) {
+            std::unique_lock<std::mutex> lock(queueMutex);
+            blockQueue.push(block);
+            
+            lock.unlock();
+            threadCondition.notify_all();
+        }
+    };
+}
+
+#endif /* LegacyDispatchQueue_hpp */
@@ -0,0 +1,204 @@
+//
+//  TlsHandshakeBenchmark.cpp
+//  remote_core_tls_handshake_benchmark
+//
+//  Created by David Moore on 10/19/26.
+//  Copyright © 2026 David Moore. All rights reserved.
+//
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <openssl/ssl.h>
+#include "StreamTransport.hpp"
+#include "TlsCipherPolicy.hpp"
+#include "TlsCredentialCache.hpp"
+#include "TestSupport.hpp"
+#include "TlsTestSupport.hpp"
+
+using namespace RemoteCore;
+
+typedef std::chrono::steady_clock Clock;
+
+#define SERVER_NAME "localhost"
+#define CHUNK_LENGTH (16 * 1024)
+
+namespace {
+    /**
+     Accepts connections until it is stopped. Each connection's bytes are read until 'bulkLength' have arrived, which is acknowledged with one byte, or until the client hangs up.
+     */
+    class Server {
+        int listenFD;
+        std::shared_ptr<SSL_CTX> context;
+        TlsConfiguration configuration;
+        size_t bulkLength;
+        std::atomic<bool> isStopped;
+        std::thread thread;
+        
+        void serve(int fd) {
+            TlsTransport transport(fd, context, configuration);
+            if (TestSupport::waitForCompletion(fd, [&]() { return transport.handshake(); }).status != TransportStatus::Complete) {
+                return;
+            }
+            
+            std::unique_ptr<char[]> buffer(new char[CHUNK_LENGTH]);
+            size_t totalLength = 0;
+            while (totalLength < bulkLength) {
+                auto result = TestSupport::waitForCompletion(fd, [&]() { return transport.read(buffer.get(), CHUNK_LENGTH); });
+                if (result.status != TransportStatus::Complete) {
+                    return;
+                }
+                
+                totalLength += result.byteCount;
+            }
+            
+            TestSupport::waitForCompletion(fd, [&]() { return transport.write("k", 1); });
+            TestSupport::waitForCompletion(fd, [&]() { return transport.read(buffer.get(), CHUNK_LENGTH); });
+        }
+        
+        void run(void) {
+            while (!isStopped) {
+                struct pollfd descriptor = {listenFD, POLLIN, 0};
+                if (poll(&descriptor, 1, 100) != 1) {
+                    continue;
+                }
+                
+                int fd = accept(listenFD, nullptr, nullptr);
+                if (fd >= 0) {
+                    serve(fd);
+                }
+            }
+        }
+    
+    public:
+        Server(const std::string &certificatePath, const std::string &privateKeyPath, size_t bulkLength) : bulkLength(bulkLength), isStopped(false) {
+            configuration.certificatePath = certificatePath;
+            configuration.privateKeyPath = privateKeyPath;
+            configuration.isServer = true;
+            configuration.verifiesPeer = false;
+            context = TlsTransport::makeContext(configuration);
+            
+            listenFD = StreamTransport::listenOnLoopback(0);
+            thread = std::thread(&Server::run, this);
+        }
+        
+        ~Server() {
+            isStopped = true;
+            thread.join();
+            close(listenFD);
+        }
+        
+        uint16_t getPort(void) const {
+            return StreamTransport::getLocalPort(listenFD);
+        }
+    };
+    
+    std::unique_ptr<TlsTransport> connect(uint16_t port, std::shared_ptr<SSL_CTX> context, const TlsConfiguration &configuration) {
+        SocketAddress address;
+        SocketAddress::parse("127.0.0.1", port, address);
+        
+        std::unique_ptr<TlsTransport> transport(new TlsTransport(StreamTransport::startConnecting(address), context, configuration));
+        if (TestSupport::waitForCompletion(transport->getDescriptor(), [&]() { return transport->handshake(); }).status != TransportStatus::Complete) {
+            throw std::runtime_error("Expected the handshake to succeed.");
+        }
+        
+        return transport;
+    }
+    
+    /**
+     Performs full handshakes, and then sends 'bulkLength' bytes over one more connection, offering only the suite and group given (or the preferred policy if both are empty).
+     */
+    void benchmarkPolicy(const std::string &keyType, const std::string &cipherSuite, const std::string &group, const std::string &certificatePath, const std::string &privateKeyPath, size_t handshakeCount, size_t bulkLength) {
+        TlsConfiguration configuration;
+        configuration.rootCAPath = certificatePath;
+        configuration.serverName = SERVER_NAME;
+        if (!cipherSuite.empty()) {
+            configuration.cipherPolicy.cipherSuites = cipherSuite;
+            configuration.cipherPolicy.groups = group;
+        }
+        
+        auto context = TlsTransport::makeContext(configuration);
+        std::string negotiatedCipher;
+        std::vector<Clock::duration> latencies;
+        double megabytesPerSecond;
+        {
+            Server server(certificatePath, privateKeyPath, bulkLength);
+            for (size_t i = 0; i < handshakeCount; i++) {
+                auto startTime = Clock::now();
+                auto transport = connect(server.getPort(), context, configuration);
+                latencies.push_back(Clock::now() - startTime);
+                negotiatedCipher = transport->getCipherName();
+            }
+            
+            auto transport = connect(server.getPort(), context, configuration);
+            int fd = transport->getDescriptor();
+            std::string chunk(CHUNK_LENGTH, 'b');
+            
+            auto startTime = Clock::now();
+            for (size_t totalLength = 0; totalLength < bulkLength;) {
+                auto result = TestSupport::waitForCompletion(fd, [&]() { return transport->write(chunk.data(), std::min(chunk.size(), bulkLength - totalLength)); });
+                if (result.status != TransportStatus::Complete) {
+                    throw std::runtime_error("Expected the bytes to be sent.");
+                }
+                
+                totalLength += result.byteCount;
+            }
+            
+            char acknowledgement;
+            if (TestSupport::waitForCompletion(fd, [&]() { return transport->read(&acknowledgement, 1); }).status != TransportStatus::Complete) {
+                throw std::runtime_error("Expected the bytes to be acknowledged.");
+            }
+            
+            megabytesPerSecond = bulkLength / std::chrono::duration<double>(Clock::now() - startTime).count() / (1024 * 1024);
+        }
+        
+        std::sort(latencies.begin(), latencies.end());
+        std::string scenario = keyType + ", " + (cipherSuite.empty() ? "preferred" : group) + ", " + negotiatedCipher;
+        printf("%-52s handshake p50 %8.1f us, p99 %8.1f us, bulk %8.1f MiB/s\n", scenario.c_str(), TestSupport::percentile(latencies, 0.5), TestSupport::percentile(latencies, 0.99), megabytesPerSecond);
+    }
+}
+
+int main(int argc, const char *argv[]) {
+    size_t handshakeCount = argc > 1 ? (size_t)std::atol(argv[1]) : 200;
+    size_t bulkLength = (argc > 2 ? (size_t)std::atol(argv[2]) : 64) * 1024 * 1024;
+    
+    char directoryTemplate[] = "/tmp/remote_core_tls_handshake_benchmark_XXXXXX";
+    if (mkdtemp(directoryTemplate) == nullptr) {
+        perror("mkdtemp");
+        return 1;
+    }
+    
+    printf("AES instructions: %s\n", TlsCipherPolicy::hasAESAcceleration() ? "yes" : "no");
+    
+    std::string directory(directoryTemplate);
+    std::string certificatePath = directory + "/certificate.pem";
+    std::string privateKeyPath = directory + "/key.pem";
+    for (std::string keyType : {"P-256", "RSA"}) {
+        TestSupport::writeSelfSignedCertificate(certificatePath, privateKeyPath, keyType, SERVER_NAME);
+        TlsCredentialCache::removeAll();
+        
+        for (const char *cipherSuite : {"TLS_AES_128_GCM_SHA256", "TLS_AES_256_GCM_SHA384", "TLS_CHACHA20_POLY1305_SHA256"}) {
+            for (const char *group : {"X25519", "P-256"}) {
+                benchmarkPolicy(keyType, cipherSuite, group, certificatePath, privateKeyPath, handshakeCount, bulkLength);
+            }
+        }
+        
+        benchmarkPolicy(keyType, "", "", certificatePath, privateKeyPath, handshakeCount, bulkLength);
+    }
+    
+    TlsCredentialCache::removeAll();
+    unlink(certificatePath.c_str());
+    unlink(privateKeyPath.c_str());
+    rmdir(directory.c_str());
+    return 0;
+}
@@ -0,0 +1,249 @@
+//
+//  TlsReadBenchmark.cpp
+//  remote_core_tls_read_benchmark
+//
+//  Created by David Moore on 10/19/26.
+//  Copyright © 2026 David Moore. All rights reserved.
+//
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <poll.h>
+#include <sys/select.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <openssl/bio.h>
+#include <openssl/ssl.h>
+#include "BufferedTlsStream.hpp"
+#include "StreamTransport.hpp"
+#include "TlsCredentialCache.hpp"
+#include "TlsTestSupport.hpp"
+
+using namespace RemoteCore;
+
+typedef std::chrono::steady_clock Clock;
+
+#define PAYLOAD_LENGTH 32
+#define READ_TIMEOUT std::chrono::seconds(5)
+
+namespace {
+    // MARK: - Counting System Calls
+    
+    /**
+     Calls that reached the socket, each of which is one 'recv' or 'send'.
+     */
+    struct SocketCallCounts {
+        uint64_t readCount = 0;
+        uint64_t writeCount = 0;
+    };
+    
+    int countingRead(BIO *bio, char *bytes, int length) {
+        static_cast<SocketCallCounts *>(BIO_get_data(bio))->readCount++;
+        int result = BIO_read(BIO_next(bio), bytes, length);
+        BIO_clear_retry_flags(bio);
+        BIO_copy_next_retry(bio);
+        return result;
+    }
+    
+    int countingWrite(BIO *bio, const char *bytes, int length) {
+        static_cast<SocketCallCounts *>(BIO_get_data(bio))->writeCount++;
+        int result = BIO_write(BIO_next(bio), bytes, length);
+        BIO_clear_retry_flags(bio);
+        BIO_copy_next_retry(bio);
+        return result;
+    }
+    
+    long countingControl(BIO *bio, int command, long number, void *pointer) {
+        return BIO_ctrl(BIO_next(bio), command, number, pointer);
+    }
+    
+    /**
+     Filter that counts the calls passed to the socket BIO beneath it.
+     */
+    BIO_METHOD *getCountingMethod(void) {
+        static BIO_METHOD *method = []() {
+            BIO_METHOD *method = BIO_meth_new(BIO_get_new_index() | BIO_TYPE_FILTER, "socket call counter");
+            BIO_meth_set_read(method, countingRead);
+            BIO_meth_set_write(method, countingWrite);
+            BIO_meth_set_ctrl(method, countingControl);
+            BIO_meth_set_create(method, [](BIO *bio) {
+                BIO_set_init(bio, 1);
+                return 1;
+            });
+            
+            return method;
+        }();
+        
+        return method;
+    }
+    
+    // MARK: - Reading
+    
+    enum class ReadMode {
+        /// One 'SSL_read' for each field, and 'select' whenever OpenSSL wants to read, as 'OpenSSLConnection' did originally.
+        Original,
+        
+        /// One 'SSL_read' for each field, and epoll.
+        BufferedTlsStreamWithoutReadAhead,
+        
+        BufferedTlsStream
+    };
+    
+    bool readOriginal(SSL *ssl, int fd, char *bytes, size_t length, uint64_t &waitCount) {
+        size_t totalLength = 0;
+        while (totalLength < length) {
+            int result = SSL_read(ssl, bytes + totalLength, (int)(length - totalLength));
+            if (result > 0) {
+                totalLength += (size_t)result;
+                continue;
+            }
+            
+            if (SSL_get_error(ssl, result) != SSL_ERROR_WANT_READ) {
+                return false;
+            }
+            
+            fd_set descriptors;
+            FD_ZERO(&descriptors);
+            FD_SET(fd, &descriptors);
+            struct timeval timeout = {5, 0};
+            waitCount++;
+            if (select(fd + 1, &descriptors, nullptr, nullptr, &timeout) <= 0) {
+                return false;
+            }
+        }
+        
+        return true;
+    }
+    
+    /**
+     Sends the messages as separate records, as a broker sends publishes, and then waits for the client to hang up.
+     */
+    void serveMessages(int listenFD, std::shared_ptr<SSL_CTX> context, const TlsConfiguration &configuration, size_t messageCount) {
+        struct pollfd descriptor = {listenFD, POLLIN, 0};
+        poll(&descriptor, 1, -1);
+        
+        int fd = accept(listenFD, nullptr, nullptr);
+        TlsTransport transport(fd, context, configuration);
+        if (TestSupport::waitForCompletion(fd, [&]() { return transport.handshake(); }).status != TransportStatus::Complete) {
+            return;
+        }
+        
+        std::string message(2 + PAYLOAD_LENGTH, 'm');
+        message[0] = (char)0x30;
+        message[1] = (char)PAYLOAD_LENGTH;
+        for (size_t i = 0; i < messageCount; i++) {
+            TestSupport::waitForCompletion(fd, [&]() { return transport.write(message.data(), message.size()); });
+        }
+        
+        char buffer[16];
+        TestSupport::waitForCompletion(fd, [&]() { return transport.read(buffer, sizeof(buffer)); });
+    }
+    
+    /**
+     Reads the messages a field at a time, as the MQTT client does, and reports the system calls made for each.
+     */
+    void benchmarkReads(const char *scenario, ReadMode mode, const std::string &certificatePath, const std::string &privateKeyPath, size_t messageCount) {
+        TlsConfiguration serverConfiguration;
+        serverConfiguration.certificatePath = certificatePath;
+        serverConfiguration.privateKeyPath = privateKeyPath;
+        serverConfiguration.isServer = true;
+        serverConfiguration.verifiesPeer = false;
+        auto serverContext = TlsTransport::makeContext(serverConfiguration);
+        
+        TlsConfiguration clientConfiguration;
+        clientConfiguration.rootCAPath = certificatePath;
+        auto clientContext = TlsTransport::makeContext(clientConfiguration);
+        
+        int listenFD = StreamTransport::listenOnLoopback(0);
+        std::thread serverThread(serveMessages, listenFD, serverContext, serverConfiguration, messageCount);
+        
+        SocketAddress address;
+        SocketAddress::parse("127.0.0.1", StreamTransport::getLocalPort(listenFD), address);
+        int fd = StreamTransport::startConnecting(address);
+        
+        SocketCallCounts counts;
+        BIO *countingBIO = BIO_new(getCountingMethod());
+        BIO_set_data(countingBIO, &counts);
+        BIO_push(countingBIO, BIO_new_socket(fd, BIO_NOCLOSE));
+        
+        SSL *ssl = SSL_new(clientContext.get());
+        SSL_set_bio(ssl, countingBIO, countingBIO);
+        
+        uint64_t waitCount = 0;
+        bool isComplete = false;
+        Clock::duration duration;
+        {
+            BufferedTlsStream stream(ssl, fd, mode == ReadMode::BufferedTlsStream);
+            if (stream.connect(Clock::now() + READ_TIMEOUT) == TlsStreamStatus::Complete) {
+                counts = SocketCallCounts();
+                auto handshakeStatistics = stream.getStatistics();
+                
+                auto startTime = Clock::now();
+                size_t readCount = 0;
+                for (; readCount < messageCount; readCount++) {
+                    char header[2];
+                    char payload[PAYLOAD_LENGTH];
+                    if (mode == ReadMode::Original) {
+                        if (!readOriginal(ssl, fd, header, 1, waitCount) || !readOriginal(ssl, fd, header + 1, 1, waitCount) || !readOriginal(ssl, fd, payload, (size_t)header[1], waitCount)) {
+                            break;
+                        }
+                    } else {
+                        auto deadline = Clock::now() + READ_TIMEOUT;
+                        if (stream.read(header, 1, deadline).status != TlsStreamStatus::Complete || stream.read(header + 1, 1, deadline).status != TlsStreamStatus::Complete || stream.read(payload, (size_t)header[1], deadline).status != TlsStreamStatus::Complete) {
+                            break;
+                        }
+                    }
+                }
+                
+                duration = Clock::now() - startTime;
+                isComplete = readCount == messageCount;
+                if (mode != ReadMode::Original) {
+                    waitCount = stream.getStatistics().readWaitCount - handshakeStatistics.readWaitCount;
+                }
+            }
+        }
+        
+        SSL_free(ssl);
+        close(fd);
+        serverThread.join();
+        close(listenFD);
+        
+        if (!isComplete) {
+            throw std::runtime_error("Expected every message to be read.");
+        }
+        
+        double seconds = std::chrono::duration<double>(duration).count();
+        double callCount = (double)(counts.readCount + counts.writeCount + waitCount);
+        printf("%-40s %6.3f recv/msg, %6.3f waits/msg, %6.3f syscalls/msg, %10.0f msg/s\n", scenario, counts.readCount / (double)messageCount, waitCount / (double)messageCount, callCount / messageCount, messageCount / seconds);
+    }
+}
+
+int main(int argc, const char *argv[]) {
+    size_t messageCount = argc > 1 ? (size_t)std::atol(argv[1]) : 100000;
+    
+    char directoryTemplate[] = "/tmp/remote_core_tls_read_benchmark_XXXXXX";
+    if (mkdtemp(directoryTemplate) == nullptr) {
+        perror("mkdtemp");
+        return 1;
+    }
+    
+    std::string directory(directoryTemplate);
+    std::string certificatePath = directory + "/certificate.pem";
+    std::string privateKeyPath = directory + "/key.pem";
+    TestSupport::writeSelfSignedCertificate(certificatePath, privateKeyPath);
+    
+    benchmarkReads("select, SSL_read for each field", ReadMode::Original, certificatePath, privateKeyPath, messageCount);
+    benchmarkReads("epoll, SSL_read for each field", ReadMode::BufferedTlsStreamWithoutReadAhead, certificatePath, privateKeyPath, messageCount);
+    benchmarkReads("epoll, read-ahead buffer", ReadMode::BufferedTlsStream, certificatePath, privateKeyPath, messageCount);
+    
+    TlsCredentialCache::removeAll();
+    unlink(certificatePath.c_str());
+    unlink(privateKeyPath.c_str());
+    rmdir(directory.c_str());
+    return 0;
+}
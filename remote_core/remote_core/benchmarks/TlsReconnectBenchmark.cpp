@@ -0,0 +1,170 @@
+//
+//  TlsReconnectBenchmark.cpp
+//  remote_core_tls_reconnect_benchmark
+//
+//  Created by David Moore on 10/19/26.
+//  Copyright © 2026 David Moore. All rights reserved.
+//
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include "StreamTransport.hpp"
+#include "TlsCredentialCache.hpp"
+#include "TlsSessionCache.hpp"
+#include "TestSupport.hpp"
+#include "TlsTestSupport.hpp"
+
+using namespace RemoteCore;
+
+typedef std::chrono::steady_clock Clock;
+
+#define SERVER_NAME "localhost"
+
+namespace {
+    /**
+     Accepts connections until it is stopped, completing each handshake and sending one message, as a broker would send CONNACK.
+     */
+    class Server {
+        int listenFD;
+        std::shared_ptr<SSL_CTX> context;
+        TlsConfiguration configuration;
+        std::atomic<bool> isStopped;
+        std::thread thread;
+        
+        void run(void) {
+            while (!isStopped) {
+                struct pollfd descriptor = {listenFD, POLLIN, 0};
+                if (poll(&descriptor, 1, 100) != 1) {
+                    continue;
+                }
+                
+                int fd = accept(listenFD, nullptr, nullptr);
+                if (fd < 0) {
+                    continue;
+                }
+                
+                TlsTransport transport(fd, context, configuration);
+                if (TestSupport::waitForCompletion(fd, [&]() { return transport.handshake(); }).status == TransportStatus::Complete) {
+                    TestSupport::waitForCompletion(fd, [&]() { return transport.write("ping", 4); });
+                    
+                    // Wait for the client to hang up.
+                    char buffer[16];
+                    TestSupport::waitForCompletion(fd, [&]() { return transport.read(buffer, sizeof(buffer)); });
+                }
+            }
+        }
+    
+    public:
+        Server(const std::string &certificatePath, const std::string &privateKeyPath) : isStopped(false) {
+            configuration.certificatePath = certificatePath;
+            configuration.privateKeyPath = privateKeyPath;
+            configuration.isServer = true;
+            configuration.verifiesPeer = false;
+            context = TlsTransport::makeContext(configuration);
+            
+            listenFD = StreamTransport::listenOnLoopback(0);
+            thread = std::thread(&Server::run, this);
+        }
+        
+        ~Server() {
+            isStopped = true;
+            thread.join();
+            close(listenFD);
+        }
+        
+        uint16_t getPort(void) const {
+            return StreamTransport::getLocalPort(listenFD);
+        }
+    };
+    
+    /**
+     Time from starting to connect until the first message from the server is read.
+     */
+    Clock::duration reconnect(uint16_t port, std::shared_ptr<SSL_CTX> context, const TlsConfiguration &configuration, bool &isResumed) {
+        SocketAddress address;
+        SocketAddress::parse("127.0.0.1", port, address);
+        
+        auto startTime = Clock::now();
+        TlsTransport transport(StreamTransport::startConnecting(address), context, configuration);
+        int fd = transport.getDescriptor();
+        
+        char buffer[4];
+        if (TestSupport::waitForCompletion(fd, [&]() { return transport.handshake(); }).status != TransportStatus::Complete || TestSupport::waitForCompletion(fd, [&]() { return transport.read(buffer, sizeof(buffer)); }).status != TransportStatus::Complete) {
+            throw std::runtime_error("Expected the connection to succeed.");
+        }
+        
+        auto duration = Clock::now() - startTime;
+        isResumed = transport.isSessionResumed();
+        return duration;
+    }
+    
+    /**
+     Reconnects repeatedly, either as connections did originally, with a new context whose credentials are read from disk every time, or with a shared context and, optionally, a session cache.
+     */
+    void benchmarkReconnects(const char *scenario, uint16_t port, TlsConfiguration configuration, bool reloadsCredentials, size_t sampleCount) {
+        std::vector<Clock::duration> latencies;
+        size_t resumedCount = 0;
+        auto context = TlsTransport::makeContext(configuration);
+        
+        for (size_t i = 0; i < sampleCount; i++) {
+            auto startTime = Clock::now();
+            if (reloadsCredentials) {
+                TlsCredentialCache::removeAll();
+                context = TlsTransport::makeContext(configuration);
+            }
+            
+            bool isResumed = false;
+            auto duration = reconnect(port, context, configuration, isResumed);
+            latencies.push_back(reloadsCredentials ? Clock::now() - startTime : duration);
+            resumedCount += isResumed ? 1 : 0;
+        }
+        
+        std::sort(latencies.begin(), latencies.end());
+        printf("%-36s p50 %8.1f us, p99 %8.1f us, %zu/%zu resumed\n", scenario, TestSupport::percentile(latencies, 0.5), TestSupport::percentile(latencies, 0.99), resumedCount, sampleCount);
+    }
+}
+
+int main(int argc, const char *argv[]) {
+    size_t sampleCount = argc > 1 ? (size_t)std::atol(argv[1]) : 200;
+    
+    char directoryTemplate[] = "/tmp/remote_core_tls_benchmark_XXXXXX";
+    if (mkdtemp(directoryTemplate) == nullptr) {
+        perror("mkdtemp");
+        return 1;
+    }
+    
+    std::string directory(directoryTemplate);
+    std::string certificatePath = directory + "/certificate.pem";
+    std::string privateKeyPath = directory + "/key.pem";
+    // An RSA certificate, like those the IoT Core issues.
+    TestSupport::writeSelfSignedCertificate(certificatePath, privateKeyPath, "RSA", SERVER_NAME);
+    
+    {
+        Server server(certificatePath, privateKeyPath);
+        
+        TlsConfiguration configuration;
+        configuration.rootCAPath = certificatePath;
+        configuration.serverName = SERVER_NAME;
+        benchmarkReconnects("full handshake, credentials reloaded", server.getPort(), configuration, true, sampleCount);
+        benchmarkReconnects("full handshake, credentials cached", server.getPort(), configuration, false, sampleCount);
+        
+        configuration.sessionCache = std::make_shared<TlsSessionCache>();
+        benchmarkReconnects("resumed session", server.getPort(), configuration, false, sampleCount);
+    }
+    
+    unlink(certificatePath.c_str());
+    unlink(privateKeyPath.c_str());
+    rmdir(directory.c_str());
+    return 0;
+}
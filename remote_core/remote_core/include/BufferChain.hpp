@@ -0,0 +1,162 @@
+//
+//  BufferChain.hpp
+//  remote_core
+//
+//  Created by David Moore on 10/19/26.
+//  Copyright © 2026 David Moore. All rights reserved.
+//
+
+#ifndef BufferChain_hpp
+#define BufferChain_hpp
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+#include <sys/uio.h>
+
+namespace RemoteCore {
+    struct SharedBufferStatistics {
+        /// Buffers whose bytes were given storage of their own, rather than sharing another buffer's.
+        uint64_t allocationCount = 0;
+        
+        /// Bytes copied into or out of buffers (e.g., to flatten a payload into a string).
+        uint64_t copiedByteCount = 0;
+    };
+    
+    /**
+     Immutable, reference-counted bytes (e.g., an encoded payload). Copying or slicing a buffer shares its bytes, so a payload can be passed from its encoder to the transport, and to every subscriber, without being copied. Every method may be called from any thread.
+     */
+    class SharedBuffer {
+        std::shared_ptr<const std::string> storage;
+        size_t offset;
+        size_t length;
+    
+    public:
+        SharedBuffer() : offset(0), length(0) {}
+        
+        /**
+         Takes the bytes, without copying them.
+         */
+        SharedBuffer(std::string &&bytes);
+        
+        /**
+         Copies the bytes, which is counted by 'getStatistics'. Moving a string in avoids the copy.
+         */
+        SharedBuffer(const std::string &bytes);
+        SharedBuffer(const char *bytes);
+        
+        const char *data(void) const {
+            return storage != nullptr ? storage->data() + offset : "";
+        }
+        
+        size_t size(void) const {
+            return length;
+        }
+        
+        bool empty(void) const {
+            return length == 0;
+        }
+        
+        /**
+         Returns 'length' bytes starting at 'offset', which share this buffer's bytes. Throws 'std::out_of_range' if the range is not within the buffer.
+         */
+        SharedBuffer slice(size_t offset, size_t length) const;
+        
+        /**
+         Returns a copy of the bytes.
+         */
+        std::string toString(void) const;
+        
+        /**
+         Appends a copy of the bytes to the string.
+         */
+        void appendTo(std::string &bytes) const;
+        
+        bool operator==(const SharedBuffer &other) const;
+        
+        bool operator!=(const SharedBuffer &other) const {
+            return !(*this == other);
+        }
+        
+        /**
+         Returns the allocations and copies made by every buffer in the process so far.
+         */
+        static SharedBufferStatistics getStatistics(void);
+    };
+    
+    /**
+     Sequence of bytes to be written together, made of shared buffers (e.g., payloads) and small bytes that the chain keeps itself (e.g., packet headers). The chain is written with a single gathered write, without being flattened into one buffer first.
+     
+     The chain's own storage is reused once everything has been consumed, so steady traffic does not allocate. Not thread safe.
+     */
+    class BufferChain {
+        struct Segment {
+            /// Bytes of the segment, unless the segment is in the chain's own storage.
+            SharedBuffer buffer;
+            bool isOwned;
+            
+            /// Position in 'buffer', or in the chain's own storage.
+            size_t offset;
+            size_t length;
+        };
+        
+        std::vector<Segment> segments;
+        size_t firstSegmentIndex;
+        std::string ownedBytes;
+        size_t byteCount;
+        
+        void addOwnedSegment(size_t offset, size_t length);
+    
+    public:
+        BufferChain();
+        
+        size_t getByteCount(void) const {
+            return byteCount;
+        }
+        
+        bool isEmpty(void) const {
+            return byteCount == 0;
+        }
+        
+        /**
+         Appends the buffer, which is shared rather than copied.
+         */
+        void append(SharedBuffer buffer);
+        
+        /**
+         Appends a copy of the bytes to the chain's own storage. Meant for the few bytes that frame a shared buffer.
+         */
+        void appendBytes(const char *bytes, size_t length);
+        
+        /**
+         Calls the writer with the chain's own storage, and appends whatever it appended to the storage. Lets bytes be encoded directly into the chain.
+         */
+        template <typename Writer>
+        void appendBytes(Writer writer) {
+            size_t offset = ownedBytes.size();
+            writer(ownedBytes);
+            addOwnedSegment(offset, ownedBytes.size() - offset);
+        }
+        
+        /**
+         Fills in up to 'maximumCount' vectors for the first bytes of the chain, for a gathered write, and returns the number filled in. The vectors are valid until the chain is next changed.
+         */
+        size_t getIOVectors(struct iovec *vectors, size_t maximumCount) const;
+        
+        /**
+         Removes the first 'length' bytes, such as those that a write consumed. Throws 'std::logic_error' if the chain is shorter.
+         */
+        void consume(size_t length);
+        
+        void clear(void);
+        
+        /**
+         Returns a copy of every byte in the chain.
+         */
+        std::string toString(void) const;
+    };
+}
+
+#endif /* BufferChain_hpp */
@@ -0,0 +1,125 @@
+//
+//  BufferedTlsStream.hpp
+//  remote_core
+//
+//  Created by David Moore on 10/19/26.
+//  Copyright © 2026 David Moore. All rights reserved.
+//
+
+#ifndef BufferedTlsStream_hpp
+#define BufferedTlsStream_hpp
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include "ReadAheadBuffer.hpp"
+
+typedef struct ssl_st SSL;
+
+namespace RemoteCore {
+    enum class TlsStreamStatus {
+        Complete,
+        
+        /// The deadline passed before the operation finished.
+        TimedOut,
+        
+        /// The peer closed the connection.
+        Closed,
+        
+        Failed
+    };
+    
+    struct TlsStreamResult {
+        TlsStreamStatus status;
+        
+        /// Bytes transferred, which may be fewer than requested if the operation did not complete.
+        size_t byteCount;
+        
+        TlsStreamResult(TlsStreamStatus status, size_t byteCount = 0) : status(status), byteCount(byteCount) {}
+    };
+    
+    struct BufferedTlsStreamStatistics {
+        /// Calls to 'SSL_read', each of which is at most one 'recv'.
+        uint64_t sslReadCount = 0;
+        
+        /// Reads that were served entirely from the read-ahead buffer.
+        uint64_t bufferedReadCount = 0;
+        
+        /// Waits for readiness, each of which is one 'epoll_wait'. Waits for the handshake and shutdown are counted by the direction they wait for.
+        uint64_t readWaitCount = 0;
+        uint64_t writeWaitCount = 0;
+    };
+    
+    /**
+     Blocking TLS stream over a non-blocking socket, for callers that transfer data on their own thread with a deadline for each operation (e.g., 'OpenSSLConnection').
+     
+     Reads are served from a 'ReadAheadBuffer', which is refilled with as much as one 'SSL_read' returns, so reading a packet a few bytes at a time costs one system call rather than one for each field. Readiness is waited for with edge-triggered epoll instances that the socket is registered with once, so each wait is a single system call. Reading and writing wait on separate instances, so that a thread waiting to read never takes the edge that a thread waiting to write is waiting for.
+     
+     Does not own the socket or the SSL object, which must outlive the stream. A read and a write may be in progress on different threads, as 'OpenSSLConnection' does, but not two of either.
+     */
+    class BufferedTlsStream {
+    public:
+        typedef std::chrono::steady_clock Clock;
+    
+    private:
+        SSL *ssl;
+        int fd;
+        int readPollFD;
+        int writePollFD;
+        bool usesReadAhead;
+        ReadAheadBuffer readAheadBuffer;
+        BufferedTlsStreamStatistics statistics;
+        
+        /**
+         Waits for the readiness that OpenSSL asked for with the error, until the deadline.
+         */
+        TlsStreamStatus waitForError(int error, Clock::time_point deadline);
+        
+        TlsStreamStatus waitForReadiness(bool isReading, Clock::time_point deadline);
+    
+    public:
+        /**
+         Creates a stream for the SSL object and its socket, which must be non-blocking. Throws 'std::system_error' if the epoll instances cannot be created.
+         
+         Without read-ahead, each read is passed straight to 'SSL_read', which is only useful for comparison.
+         */
+        BufferedTlsStream(SSL *ssl, int fd, bool usesReadAhead = true);
+        ~BufferedTlsStream();
+        
+        BufferedTlsStream(const BufferedTlsStream &) = delete;
+        BufferedTlsStream &operator=(const BufferedTlsStream &) = delete;
+        
+        /**
+         Performs the client handshake.
+         */
+        TlsStreamStatus connect(Clock::time_point deadline);
+        
+        /**
+         Reads exactly 'length' bytes, unless the deadline passes or the connection fails first.
+         */
+        TlsStreamResult read(char *bytes, size_t length, Clock::time_point deadline);
+        
+        /**
+         Writes all of the bytes, unless the deadline passes or the connection fails first.
+         */
+        TlsStreamResult write(const char *bytes, size_t length, Clock::time_point deadline);
+        
+        /**
+         Sends a close notification, and waits for the peer's.
+         */
+        TlsStreamStatus shutdown(Clock::time_point deadline);
+        
+        /**
+         Returns the number of bytes that have been read ahead, and are waiting to be read.
+         */
+        size_t getBufferedByteCount(void) const {
+            return readAheadBuffer.getByteCount();
+        }
+        
+        const BufferedTlsStreamStatistics &getStatistics(void) const {
+            return statistics;
+        }
+    };
+}
+
+#endif /* BufferedTlsStream_hpp */
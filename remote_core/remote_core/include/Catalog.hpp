@@ -0,0 +1,75 @@
+//
+//  Catalog.hpp
+//  remote_core
+//
+//  Created by David Moore on 10/19/26.
+//  Copyright © 2026 David Moore. All rights reserved.
+//
+
+#ifndef Catalog_hpp
+#define Catalog_hpp
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace RemoteCore {
+    /**
+     Hashes a key for a catalog (FNV-1a, followed by a finalizer so that nearby seeds produce unrelated hashes). The catalog generator uses the same function, so it must never change without regenerating the catalogs.
+     */
+    constexpr uint32_t catalogHash(const char *key, size_t length, uint32_t seed) {
+        uint32_t hash = 2166136261u ^ (seed * 0x9E3779B9u);
+        for (size_t i = 0; i < length; i++) {
+            hash ^= (uint8_t)key[i];
+            hash *= 16777619u;
+        }
+        
+        hash ^= hash >> 16;
+        hash *= 0x85EBCA6Bu;
+        hash ^= hash >> 13;
+        hash *= 0xC2B2AE35u;
+        hash ^= hash >> 16;
+        
+        return hash;
+    }
+    
+    /**
+     Perfect hash table over a fixed set of keys, generated at build time by 'remote_core_catalog_generator'.
+     
+     Keys are first hashed into a bucket, and each bucket stores the seed that places all of its keys into distinct slots (i.e., hash and displace). A lookup is therefore two hashes and a single string comparison.
+     */
+    struct CatalogTable {
+        const char *const *keys;
+        size_t keyCount;
+        const uint32_t *seeds;
+        size_t bucketCount;
+        const uint16_t *slots;
+        size_t slotCount;
+        
+        /**
+         Returns the index of the key within 'keys', or -1 if the key is not part of the catalog.
+         */
+        constexpr long indexOfKey(const char *key, size_t length) const {
+            uint32_t seed = seeds[catalogHash(key, length, 0) % bucketCount];
+            uint16_t slot = slots[catalogHash(key, length, seed) % slotCount];
+            if (slot >= keyCount) {
+                return -1;
+            }
+            
+            const char *candidate = keys[slot];
+            for (size_t i = 0; i < length; i++) {
+                if (candidate[i] != key[i] || candidate[i] == '\0') {
+                    return -1;
+                }
+            }
+            
+            return candidate[length] == '\0' ? (long)slot : -1;
+        }
+        
+        long indexOfKey(const std::string &key) const {
+            return indexOfKey(key.data(), key.size());
+        }
+    };
+}
+
+#endif /* Catalog_hpp */
@@ -30,7 +30,9 @@ namespace RemoteCore {
         static std::shared_ptr<CommandLine> sharedCommandLine();
         
         /**
-         Executes a command within the current directory in the system.
+         Executes a command within the current directory in the system. (Asynchronous)
+         
+         Commands run one at a time on the command line's own thread, which the result handler is called on as well.
 
          @param command Command that will be executed.
          @param std::string Current result of the command execution.
@@ -26,6 +26,7 @@
 
 #include "util/memory/stl/String.hpp"
 #include "util/JsonParser.hpp"
+#include "TlsCipherPolicy.hpp"
 
 namespace awsiotsdk {
     class ConfigCommon {
@@ -62,6 +63,25 @@ namespace awsiotsdk {
         static size_t max_pending_acks_;
         static size_t maximum_outgoing_action_queue_length_;
         static uint32_t action_processing_rate_hz_;
+        static bool use_builtin_mqtt_client_;
+        static util::String outbox_path_;
+        static size_t outbox_segment_size_bytes_;
+        static size_t outbox_segment_count_;
+        static size_t outbox_replay_batch_size_;
+        static util::String tls_session_cache_path_;
+        static bool tls_kernel_offload_;
+        static RemoteCore::TlsCipherPolicy tls_cipher_policy_;
+        static uint16_t local_endpoint_port_;
+        static util::String local_endpoint_cert_path_;
+        static util::String local_endpoint_key_path_;
+        static util::String local_endpoint_client_root_ca_path_;
+        static bool local_endpoint_advertises_;
+        static bool use_mqtt_5_;
+        static uint16_t mqtt_topic_alias_maximum_;
+        static std::chrono::seconds mqtt_message_expiry_interval_;
+        static util::String metrics_path_;
+        static std::chrono::seconds metrics_export_interval_;
+        static bool metrics_publishes_stats_;
         
         static util::String serial_number_;
 
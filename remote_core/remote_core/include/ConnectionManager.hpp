@@ -16,9 +16,29 @@
 
 #include "mqtt/Client.hpp"
 #include "NetworkConnection.hpp"
+#include "DispatchFuture.hpp"
+#include "TopicRouter.hpp"
+#include "PublishPipeline.hpp"
+#include "MqttConnection.hpp"
+#include "TlsSessionCache.hpp"
+#include "MetricsRegistry.hpp"
+
+/// Maximum number of topic filters in a single SUBSCRIBE or UNSUBSCRIBE packet, which is the limit imposed by the IoT Core.
+#define CONNECTION_MANAGER_MAX_TOPICS_PER_PACKET 8
+
+/// Maximum number of messages that may wait for room in the publish window before publishing is refused.
+#define CONNECTION_MANAGER_PUBLISH_BACKLOG_CAPACITY 256
 
 namespace RemoteCore {
-    /// Manages connections with the IoT Core.
+    /**
+     Manages connections with the IoT Core.
+     
+     Unless 'use_builtin_mqtt_client' is disabled in the configuration, the connection is made by the built-in 'MqttConnection', which sends every packet as soon as it is submitted. Otherwise, the AWS SDK's client is used, which sends queued actions at 'action_processing_rate_hz'.
+     
+     Publishes, received messages and changes to the connection are recorded in the shared 'MetricsRegistry'.
+     
+     The built-in client uses MQTT 5 if 'use_mqtt_5' is enabled, so that topic names are replaced by topic aliases after the first message on each topic, and messages carry their properties. The SDK's client only supports MQTT 3.1.1, and ignores the properties.
+     */
     class ConnectionManager {
     public:
         /**
@@ -27,9 +47,14 @@ namespace RemoteCore {
         typedef std::function<void (awsiotsdk::ResponseCode responseCode)> CompletionHandler;
         
         /**
-         Asynchronous callback that is used when a message is received for a particular topic.
+         Asynchronous callback that is used when a message is received for a particular topic. The properties, such as the response topic and correlation data, are empty unless the message was received with MQTT 5.
+         */
+        typedef std::function<awsiotsdk::ResponseCode (std::string topicName, std::string payload, const MqttProperties &properties)> MessageHandler;
+        
+        /**
+         Asynchronous callback that is used when the connection is established, re-established or lost.
          */
-        typedef std::function<awsiotsdk::ResponseCode (std::string topicName, std::string payload)> MessageHandler;
+        typedef std::function<void (bool isConnected)> ConnectionHandler;
         
     protected:
         std::shared_ptr<awsiotsdk::NetworkConnection> networkConnection;
@@ -39,10 +64,45 @@ namespace RemoteCore {
         std::shared_ptr<awsiotsdk::MqttClient> client;
         std::unique_ptr<awsiotsdk::Utf8String> clientID;
         std::vector<std::string> subscribedTopicNames;
-        std::map<std::string, MessageHandler> messageHandlersByTopicName;
         std::mutex subscribedTopicNamesMutex;
-        std::mutex messageHandlersByTopicNameMutex;
+        TopicRouter topicRouter;
         const awsiotsdk::mqtt::QoS qualityOfService;
+        ConnectionHandler connectionHandler;
+        std::mutex connectionHandlerMutex;
+        
+        /// Lets reconnects resume the previous TLS session, which skips most of the handshake.
+        std::shared_ptr<TlsSessionCache> sessionCache;
+        
+        struct BatchCompletion;
+        
+        struct OutboundPublish {
+            std::string topicName;
+            SharedBuffer message;
+            CompletionHandler completionHandler;
+            MqttProperties properties;
+            
+            /// When the message was submitted, so that the time until it is acknowledged can be recorded.
+            std::chrono::steady_clock::time_point submissionTime;
+        };
+        
+        /// Bounds the number of unacknowledged publishes, so that the client's action queue never overflows.
+        std::unique_ptr<PublishPipeline<OutboundPublish>> publishPipeline;
+        
+        /// Built-in client, used instead of 'client' when configured. Declared last, so that it is destroyed, and completes its pending operations, before anything its handlers use.
+        std::unique_ptr<MqttConnection> mqttConnection;
+        
+        void createMqttConnection(void);
+        void createSDKClient(void);
+        
+        void notifyConnectionHandler(bool isConnected);
+        
+        /**
+         Hands a batch of publishes from the pipeline to the client.
+         */
+        void sendPublishes(std::vector<OutboundPublish> batch);
+        
+        void addSubscribedTopicNames(const std::vector<std::string> &topicNames, MessageHandler messageHandler);
+        void removeSubscribedTopicNames(const std::vector<std::string> &topicNames);
         
         awsiotsdk::ResponseCode subscribeCallback(awsiotsdk::util::String topicName,
                                                   awsiotsdk::util::String payload,
@@ -74,6 +134,16 @@ namespace RemoteCore {
          */
         awsiotsdk::ResponseCode suspendConnection(void);
         
+        /**
+         Returns true if the connection with the endpoint is currently established.
+         */
+        bool isConnected(void) const;
+        
+        /**
+         Sets the handler that is called whenever the connection is established, re-established or lost. The handler is called on the client's thread, so it should not block.
+         */
+        void setConnectionHandler(ConnectionHandler connectionHandler);
+        
         /**
          Subscribes to a topic, given the name of a particular topic. (Asynchronous)
 
@@ -83,6 +153,25 @@ namespace RemoteCore {
         void subscribeToTopic(const std::string &topicName, MessageHandler messageHandler,
                               CompletionHandler completionHandler);
         
+        /**
+         Subscribes to a topic, given the name of a particular topic. (Asynchronous)
+         
+         @return Future response code, available once the subscription has been completed, or has failed.
+         */
+        DispatchFuture<awsiotsdk::ResponseCode> subscribeToTopic(const std::string &topicName, MessageHandler messageHandler);
+        
+        /**
+         Subscribes to every topic, sending as few packets as possible. The packets are sent without waiting for each other, so the subscriptions take a single round trip. (Asynchronous)
+         
+         @param topicNames The names of the topics, or topic filters, that will be subscribed to.
+         @param messageHandler Called for messages received on any of the topics.
+         @param completionHandler Called once every subscription has been completed, with the first failure if any of them failed.
+         */
+        void subscribeToTopics(const std::vector<std::string> &topicNames, MessageHandler messageHandler,
+                               CompletionHandler completionHandler);
+        
+        DispatchFuture<awsiotsdk::ResponseCode> subscribeToTopics(const std::vector<std::string> &topicNames, MessageHandler messageHandler);
+        
         /**
          Ubsubscribes from a topic, given the name of the topic to unsubscribe from. (Asynchronous)
 
@@ -91,16 +180,87 @@ namespace RemoteCore {
          */
         void unsubscribeFromTopic(const std::string &topicName, CompletionHandler completionHandler);
         
+        /**
+         Ubsubscribes from a topic, given the name of the topic to unsubscribe from. (Asynchronous)
+         
+         @return Future response code, available once the unsubscribing is completed, or an error occurred.
+         */
+        DispatchFuture<awsiotsdk::ResponseCode> unsubscribeFromTopic(const std::string &topicName);
+        
+        /**
+         Unsubscribes from every topic, sending as few packets as possible. (Asynchronous)
+         
+         @param topicNames Topics that will be unsubscribed from.
+         @param completionHandler Called once every topic has been unsubscribed from, with the first failure if any of them failed.
+         */
+        void unsubscribeFromTopics(const std::vector<std::string> &topicNames, CompletionHandler completionHandler);
+        
+        DispatchFuture<awsiotsdk::ResponseCode> unsubscribeFromTopics(const std::vector<std::string> &topicNames);
+        
+        /**
+         Subscribes to every topic in 'getSubscribedTopicNames' again, keeping the existing message handlers. Called automatically after reconnecting. (Asynchronous)
+         */
+        void resubscribeToAllTopics(CompletionHandler completionHandler);
+        
         /**
          Publish a message to a topic, which is specified. (Asynchronous)
 
-         @param message JSON string that will be published.
+         Messages are published once fewer than 'getPublishWindowSize' messages are awaiting acknowledgement. When the backlog of waiting messages is full as well, the completion handler is called immediately with 'ResponseCode::ACTION_QUEUE_FULL'.
+
+         @param message JSON string that will be published, which is shared with the packet rather than copied if it is moved in.
          @param topicName Name of the topic that the message will be published to.
          @param completionHandler Called when the message has been published, or an error occurred.
          */
-        void publishMessageToTopic(const std::string &message, const std::string &topicName,
+        void publishMessageToTopic(SharedBuffer message, const std::string &topicName,
                                    CompletionHandler completionHandler);
         
+        /**
+         Publish a message to a topic, which is specified. (Asynchronous)
+         
+         @return Future response code, available once the message has been published, or an error occurred.
+         */
+        DispatchFuture<awsiotsdk::ResponseCode> publishMessageToTopic(SharedBuffer message, const std::string &topicName);
+        
+        /**
+         Publish a message to a topic, with MQTT 5 properties such as its response topic and correlation data, which are ignored by MQTT 3.1.1 connections. (Asynchronous)
+         
+         The message expires after 'mqtt_message_expiry_interval_secs' unless the properties give it an expiry interval of their own.
+         */
+        void publishMessageToTopic(SharedBuffer message, const std::string &topicName, MqttProperties properties,
+                                   CompletionHandler completionHandler);
+        
+        /**
+         Blocks the current thread until a message can be published without being refused, or the timeout elapses. Returns false if the timeout elapsed first.
+         */
+        bool waitForPublishCapacity(std::chrono::milliseconds timeout) {
+            return publishPipeline->waitForCapacity(timeout);
+        }
+        
+        /**
+         Maximum number of messages that may be awaiting acknowledgement at once.
+         */
+        size_t getPublishWindowSize(void) const {
+            return publishPipeline->getWindowSize();
+        }
+        
+        PublishPipelineStatistics getPublishStatistics(void) {
+            return publishPipeline->getStatistics();
+        }
+        
+        /**
+         Returns the number of messages that have been sent, but not acknowledged yet.
+         */
+        int getPendingMessageCount(void) const {
+            return currentPendingMessages;
+        }
+        
+        /**
+         Returns the number of messages that have been published successfully.
+         */
+        int getPublishedMessageCount(void) const {
+            return totalPublishedMessages;
+        }
+        
         /**
          Returns a vector of topic names that are currently subscribed to.
          */
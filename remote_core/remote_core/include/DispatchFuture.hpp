@@ -0,0 +1,319 @@
+//
+//  DispatchFuture.hpp
+//  remote_core
+//
+//  Created by David Moore on 10/19/26.
+//  Copyright © 2026 David Moore. All rights reserved.
+//
+
+#ifndef DispatchFuture_hpp
+#define DispatchFuture_hpp
+
+#include <chrono>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include "DispatchQueue.hpp"
+
+#if defined(__cpp_impl_coroutine) && defined(__has_include)
+#if __has_include(<coroutine>)
+#include <coroutine>
+#include <exception>
+
+/// Defined when futures may be awaited from C++20 coroutines.
+#define DISPATCH_FUTURE_HAS_COROUTINES 1
+#endif
+#endif
+
+namespace RemoteCore {
+    template <typename T>
+    class DispatchFuture;
+    
+    template <typename T>
+    class DispatchPromise;
+    
+    namespace DispatchFutureDetail {
+        template <typename T>
+        struct State {
+            std::mutex mutex;
+            std::condition_variable condition;
+            std::unique_ptr<T> value;
+            std::vector<std::pair<DispatchQueue *, DispatchTask>> continuations;
+        };
+        
+        template <typename Result>
+        struct Chain;
+    }
+    
+    /**
+     Value that will become available later, such as the response code of a publish. Continuations are executed on a dispatch queue once the value is available, so completion code never runs on whichever thread happened to produce the value.
+     
+     Futures are lightweight handles: copies refer to the same value, which makes it safe to capture a future by value. Continuations capture their state by value too, rather than referencing the stack of the caller.
+     */
+    template <typename T>
+    class DispatchFuture {
+    private:
+        template <typename>
+        friend class DispatchFuture;
+        
+        template <typename>
+        friend class DispatchPromise;
+        
+        template <typename>
+        friend struct DispatchFutureDetail::Chain;
+        
+        std::shared_ptr<DispatchFutureDetail::State<T>> state;
+        
+        explicit DispatchFuture(std::shared_ptr<DispatchFutureDetail::State<T>> state) : state(std::move(state)) {}
+        
+        void validate(void) const {
+            if (state == nullptr) {
+                throw std::logic_error("Expected 'DispatchFuture' to be obtained from a promise.");
+            }
+        }
+        
+        /**
+         Executes the task on the queue once the value is available. The task may read the value without holding the lock, since it never changes once set.
+         */
+        void enqueueContinuation(DispatchQueue &queue, DispatchTask task) const {
+            validate();
+            {
+                std::lock_guard<std::mutex> lock(state->mutex);
+                if (state->value == nullptr) {
+                    state->continuations.emplace_back(&queue, std::move(task));
+                    return;
+                }
+            }
+            
+            queue.execute(std::move(task));
+        }
+    
+    public:
+        typedef T ValueType;
+        
+        /**
+         Creates an invalid future, that must be assigned before it is used.
+         */
+        DispatchFuture() {}
+        
+        /**
+         Returns a future whose value is already available.
+         */
+        static DispatchFuture<T> resolved(T value) {
+            DispatchPromise<T> promise;
+            promise.resolve(std::move(value));
+            return promise.getFuture();
+        }
+        
+        bool isValid(void) const {
+            return state != nullptr;
+        }
+        
+        bool isReady(void) const {
+            validate();
+            std::lock_guard<std::mutex> lock(state->mutex);
+            return state->value != nullptr;
+        }
+        
+        /**
+         Blocks the current thread until the value is available, or the timeout elapses. Returns false if the timeout elapsed first.
+         */
+        bool waitFor(std::chrono::milliseconds timeout) const {
+            validate();
+            std::unique_lock<std::mutex> lock(state->mutex);
+            return state->condition.wait_for(lock, timeout, [this]() {
+                return state->value != nullptr;
+            });
+        }
+        
+        /**
+         Blocks the current thread until the value is available, and returns it. Must not be called on a queue the value depends on.
+         */
+        const T &get(void) const {
+            validate();
+            std::unique_lock<std::mutex> lock(state->mutex);
+            state->condition.wait(lock, [this]() {
+                return state->value != nullptr;
+            });
+            
+            return *state->value;
+        }
+        
+        /**
+         Executes the block on the queue with the value, once it is available. The queue must outlive the future's pending work, as with 'DispatchGroup::notify'.
+         
+         The block may return nothing, a value or another future; the returned future resolves with the block's result once it is available, so asynchronous steps can be chained without nesting completion handlers.
+         */
+        template <typename Function>
+        typename DispatchFutureDetail::Chain<typename std::result_of<typename std::decay<Function>::type &(const T &)>::type>::Future
+        then(DispatchQueue &queue, Function &&block) const {
+            typedef typename std::result_of<typename std::decay<Function>::type &(const T &)>::type Result;
+            return DispatchFutureDetail::Chain<Result>::attach(*this, queue, std::forward<Function>(block));
+        }
+
+#ifdef DISPATCH_FUTURE_HAS_COROUTINES
+        class Awaiter {
+        private:
+            DispatchFuture<T> future;
+            DispatchQueue *queue;
+        
+        public:
+            Awaiter(DispatchFuture<T> future, DispatchQueue &queue) : future(std::move(future)), queue(&queue) {}
+            
+            // Always suspends, so that the coroutine resumes on the queue even when the value is already available.
+            bool await_ready(void) const noexcept {
+                return false;
+            }
+            
+            void await_suspend(std::coroutine_handle<> handle) {
+                future.enqueueContinuation(*queue, DispatchTask([handle]() {
+                    handle.resume();
+                }));
+            }
+            
+            T await_resume(void) {
+                return future.get();
+            }
+        };
+        
+        /**
+         Returns an awaitable that suspends the coroutine until the value is available, and resumes it on the queue.
+         */
+        Awaiter resumeOn(DispatchQueue &queue) const {
+            validate();
+            return Awaiter(*this, queue);
+        }
+#endif
+    };
+    
+    /**
+     Producer side of a 'DispatchFuture'. Copies refer to the same value, so a promise can be captured by value in a completion handler.
+     */
+    template <typename T>
+    class DispatchPromise {
+    private:
+        std::shared_ptr<DispatchFutureDetail::State<T>> state;
+    
+    public:
+        DispatchPromise() : state(std::make_shared<DispatchFutureDetail::State<T>>()) {}
+        
+        DispatchFuture<T> getFuture(void) const {
+            return DispatchFuture<T>(state);
+        }
+        
+        /**
+         Makes the value available, and executes any pending continuations. Must be called exactly once.
+         */
+        void resolve(T value) {
+            std::vector<std::pair<DispatchQueue *, DispatchTask>> continuations;
+            {
+                std::lock_guard<std::mutex> lock(state->mutex);
+                if (state->value != nullptr) {
+                    throw std::logic_error("Expected 'resolve' to be called once.");
+                }
+                
+                state->value = std::unique_ptr<T>(new T(std::move(value)));
+                continuations.swap(state->continuations);
+                state->condition.notify_all();
+            }
+            
+            // Executed outside of the lock, since a continuation may add another continuation.
+            for (auto &continuation : continuations) {
+                continuation.first->execute(std::move(continuation.second));
+            }
+        }
+    };
+    
+    namespace DispatchFutureDetail {
+        /**
+         Block returning a plain value; the chained future resolves with it.
+         */
+        template <typename Result>
+        struct Chain {
+            typedef DispatchFuture<Result> Future;
+            
+            template <typename T, typename Function>
+            static Future attach(const DispatchFuture<T> &future, DispatchQueue &queue, Function &&block) {
+                DispatchPromise<Result> promise;
+                auto state = future.state;
+                future.enqueueContinuation(queue, DispatchTask([state, promise, block = std::forward<Function>(block)]() mutable {
+                    promise.resolve(block(*state->value));
+                }));
+                
+                return promise.getFuture();
+            }
+        };
+        
+        /**
+         Block returning another future; the chained future resolves once the returned future does.
+         */
+        template <typename Result>
+        struct Chain<DispatchFuture<Result>> {
+            typedef DispatchFuture<Result> Future;
+            
+            template <typename T, typename Function>
+            static Future attach(const DispatchFuture<T> &future, DispatchQueue &queue, Function &&block) {
+                DispatchPromise<Result> promise;
+                auto state = future.state;
+                auto queuePointer = &queue;
+                future.enqueueContinuation(queue, DispatchTask([state, promise, queuePointer, block = std::forward<Function>(block)]() mutable {
+                    block(*state->value).then(*queuePointer, [promise](const Result &result) mutable {
+                        promise.resolve(result);
+                    });
+                }));
+                
+                return promise.getFuture();
+            }
+        };
+        
+        /**
+         Block returning nothing; the end of a chain.
+         */
+        template <>
+        struct Chain<void> {
+            typedef void Future;
+            
+            template <typename T, typename Function>
+            static void attach(const DispatchFuture<T> &future, DispatchQueue &queue, Function &&block) {
+                auto state = future.state;
+                future.enqueueContinuation(queue, DispatchTask([state, block = std::forward<Function>(block)]() mutable {
+                    block(*state->value);
+                }));
+            }
+        };
+    }
+
+#ifdef DISPATCH_FUTURE_HAS_COROUTINES
+    /**
+     Return type of fire-and-forget coroutines, which run until their first suspension point on the calling thread, and on whichever queue they resume on afterwards.
+     */
+    struct DispatchCoroutine {
+        struct promise_type {
+            DispatchCoroutine get_return_object(void) noexcept {
+                return DispatchCoroutine();
+            }
+            
+            std::suspend_never initial_suspend(void) noexcept {
+                return std::suspend_never();
+            }
+            
+            std::suspend_never final_suspend(void) noexcept {
+                return std::suspend_never();
+            }
+            
+            void return_void(void) noexcept {
+            }
+            
+            void unhandled_exception(void) noexcept {
+                std::terminate();
+            }
+        };
+    };
+#endif
+}
+
+#endif /* DispatchFuture_hpp */
@@ -0,0 +1,74 @@
+//
+//  DispatchGroup.hpp
+//  remote_core
+//
+//  Created by David Moore on 10/19/26.
+//  Copyright © 2026 David Moore. All rights reserved.
+//
+
+#ifndef DispatchGroup_hpp
+#define DispatchGroup_hpp
+
+#include <chrono>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <utility>
+#include <vector>
+#include "DispatchTask.hpp"
+
+namespace RemoteCore {
+    class DispatchQueue;
+    
+    /**
+     Tracks a set of outstanding work items, so that the caller can wait for, or be notified of, the completion of all of them.
+     
+     Groups are lightweight handles: copies refer to the same group, which makes it safe to capture a group by value in a completion handler.
+     */
+    class DispatchGroup {
+    private:
+        struct State {
+            std::mutex mutex;
+            std::condition_variable condition;
+            size_t pendingCount = 0;
+            std::vector<std::pair<DispatchQueue *, DispatchTask>> notifications;
+        };
+        
+        std::shared_ptr<State> state;
+        
+        void enqueueNotification(DispatchQueue &queue, DispatchTask task);
+    
+    public:
+        DispatchGroup();
+        
+        /**
+         Indicates that a work item has entered the group. Every call must be balanced with a call to 'leave'.
+         */
+        void enter(void);
+        
+        /**
+         Indicates that a work item in the group has completed. Notification blocks are executed once the last work item leaves.
+         */
+        void leave(void);
+        
+        /**
+         Blocks the current thread until every work item in the group has completed.
+         */
+        void wait(void);
+        
+        /**
+         Blocks the current thread until every work item in the group has completed, or the timeout elapses. Returns false if the timeout elapsed first.
+         */
+        bool waitFor(std::chrono::milliseconds timeout);
+        
+        /**
+         Executes the block on the queue once every work item in the group has completed. If the group is already empty, the block is executed immediately. The queue must outlive the group's pending work items.
+         */
+        template <typename Function>
+        void notify(DispatchQueue &queue, Function &&block) {
+            enqueueNotification(queue, DispatchTask(std::forward<Function>(block)));
+        }
+    };
+}
+
+#endif /* DispatchGroup_hpp */
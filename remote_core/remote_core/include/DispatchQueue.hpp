@@ -10,17 +10,32 @@
 #define DispatchQueue_hpp
 
 #include <functional>
-#include <thread>
-#include <queue>
-#include <atomic>
+#include <deque>
+#include <memory>
 #include <mutex>
-#include <vector>
 #include <string>
 #include <condition_variable>
+#include <vector>
+#include "DispatchGroup.hpp"
+#include "DispatchQueueStatistics.hpp"
+#include "DispatchTask.hpp"
+#include "TimerWheel.hpp"
+#include "WorkStealingPool.hpp"
+
+/// Blocks that run for longer than this are counted as long-running.
+#define DISPATCH_QUEUE_DEFAULT_LONG_RUNNING_THRESHOLD std::chrono::milliseconds(100)
 
 namespace RemoteCore {
     /**
-     Enables asynchronous execution by using a std::thread backed queue.
+     Enables asynchronous execution on a pool of threads.
+     
+     Serial queues (i.e., a thread count of one) are lightweight strands over the shared pool: blocks run one at a time and in order, but no thread is dedicated to the queue. Queues with more threads own a work-stealing pool of that size, and run blocks concurrently.
+     
+     Blocks are started in the order they were executed. A barrier block waits for every block before it to complete, and no block after it starts until the barrier completes.
+     
+     Every queue records how long its blocks wait and run. Samples are recorded into per-thread shards without locking, and merged when the statistics are read.
+     
+     Blocks on the shared pool must not block (e.g., on a device, a socket or a child process), since every blocked block holds one of the few threads that all serial queues share. Work that blocks belongs on a queue that is created with 'mayBlock', which owns its threads.
      */
     class DispatchQueue {
     public:
@@ -28,25 +43,157 @@ namespace RemoteCore {
          Void function that can be executed by the receiver.
          */
         typedef std::function<void (void)> Block;
-        
+    
     private:
+        struct QueuedBlock {
+            DispatchTask task;
+            bool isBarrier;
+            TimerWheel::Clock::time_point enqueueTime;
+        };
+        
+        /// Statistics recorded by the threads that map to the shard. Padded, so that shards never share a cache line.
+        struct StatisticsShard {
+            AtomicLatencyHistogram waitTime;
+            AtomicLatencyHistogram executionTime;
+            std::atomic<uint64_t> completedBlockCount;
+            std::atomic<uint64_t> longRunningBlockCount;
+            char padding[64];
+            
+            StatisticsShard() : completedBlockCount(0), longRunningBlockCount(0) {}
+        };
+        
+        /// Reference to the queue that is shared with its timers, and cleared when the queue is destroyed.
+        struct TimerTarget {
+            std::mutex mutex;
+            DispatchQueue *queue;
+        };
+        
         std::string name;
+        size_t threadCount;
+        std::unique_ptr<WorkStealingPool> privatePool;
+        WorkStealingPool *pool;
+        
         std::mutex queueMutex;
-        std::queue<Block> blockQueue;
-        std::vector<std::thread> threads;
-        std::condition_variable threadCondition;
-        std::atomic_bool shouldQuit;
+        std::deque<QueuedBlock> blockQueue;
+        std::condition_variable drainCondition;
+        size_t drainerCount;
+        size_t runningBlockCount;
+        bool isBarrierRunning;
+        std::shared_ptr<TimerTarget> timerTarget;
+        
+        TimerWheel::Clock::time_point creationTime;
+        uint64_t enqueuedBlockCount;
+        size_t maximumDepth;
+        std::unique_ptr<StatisticsShard[]> statisticsShards;
+        std::atomic<TimerWheel::Clock::rep> longRunningBlockThreshold;
         
-        void threadHandler(void);
+        void enqueue(DispatchTask task, bool isBarrier);
+        bool canStartNextBlock(void) const;
+        size_t reserveDrainers(void);
         
+        /**
+         Submits drainers to the pool. Yielding drainers are placed behind the work of other queues, rather than taken next by the current worker.
+         */
+        void startDrainers(size_t count, bool isYielding = false);
+        void drain(void);
+        void recordBlock(TimerWheel::Clock::duration waitTime, TimerWheel::Clock::duration executionTime);
+        DispatchTimer scheduleTimer(TimerWheel::Clock::time_point deadline, DispatchTask task);
+    
     public:
-        DispatchQueue(std::string name, size_t threadCount = 1);
+        /**
+         Creates a queue that runs at most 'threadCount' blocks at the same time. Serial queues that 'mayBlock' run on a thread of their own, rather than on the shared pool.
+         */
+        DispatchQueue(std::string name, size_t threadCount = 1, bool mayBlock = false);
+        
+        /**
+         Waits for every block that has been executed on the receiver to complete. Timers that have not fired are discarded.
+         */
         ~DispatchQueue();
         
+        DispatchQueue(const DispatchQueue &) = delete;
+        DispatchQueue &operator=(const DispatchQueue &) = delete;
+        
+        std::string getName(void) const {
+            return name;
+        }
+        
+        /**
+         Returns the maximum number of blocks that may run at the same time.
+         */
+        size_t getThreadCount(void) const {
+            return threadCount;
+        }
+        
+        /**
+         Blocks that run for longer than the threshold are counted as long-running. Defaults to 'DISPATCH_QUEUE_DEFAULT_LONG_RUNNING_THRESHOLD'.
+         */
+        std::chrono::microseconds getLongRunningBlockThreshold(void) const {
+            return std::chrono::duration_cast<std::chrono::microseconds>(TimerWheel::Clock::duration(longRunningBlockThreshold.load()));
+        }
+        
+        void setLongRunningBlockThreshold(std::chrono::microseconds threshold) {
+            longRunningBlockThreshold = std::chrono::duration_cast<TimerWheel::Clock::duration>(threshold).count();
+        }
+        
+        /**
+         Returns a snapshot of the receiver's statistics.
+         */
+        DispatchQueueStatistics getStatistics(void);
+        
+        /**
+         Returns a snapshot of the statistics of every queue that currently exists.
+         */
+        static std::vector<DispatchQueueStatistics> statisticsForAllQueues(void);
+        
+        /**
+         Executes the provided block on the queue. Blocks may be any callable, including move-only ones.
+         */
+        template <typename Function>
+        void execute(Function &&block) {
+            enqueue(DispatchTask(std::forward<Function>(block)), false);
+        }
+        
+        /**
+         Executes the provided block on the queue as a member of the group. The group is entered immediately, and left once the block completes.
+         */
+        template <typename Function>
+        void execute(DispatchGroup group, Function &&block) {
+            group.enter();
+            enqueue(DispatchTask([group, block = std::forward<Function>(block)]() mutable {
+                block();
+                group.leave();
+            }), false);
+        }
+        
+        /**
+         Executes the provided block on the queue as a barrier: the block runs by itself, after every previously executed block has completed. On serial queues this is equivalent to 'execute'.
+         */
+        template <typename Function>
+        void executeBarrier(Function &&block) {
+            enqueue(DispatchTask(std::forward<Function>(block)), true);
+        }
+        
+        /**
+         Executes the block once for each iteration, spreading the iterations across the queue's threads, and returns once every iteration has completed. The calling thread takes part in the loop, so this may be called from one of the queue's own blocks.
+         */
+        void apply(size_t iterationCount, std::function<void (size_t iteration)> block);
+        
+        /**
+         Executes the provided block on the queue once the deadline has passed. The returned timer may be used to cancel the block before it is executed.
+         */
+        template <typename Function>
+        DispatchTimer executeAt(TimerWheel::Clock::time_point deadline, Function &&block) {
+            return scheduleTimer(deadline, DispatchTask(std::forward<Function>(block)));
+        }
+        
         /**
-         Executes the provided block on the queue.
+         Executes the provided block on the queue once the delay has elapsed. The returned timer may be used to cancel the block before it is executed.
          */
-        void execute(Block block);
+        template <typename Rep, typename Period, typename Function>
+        DispatchTimer executeAfter(std::chrono::duration<Rep, Period> delay, Function &&block) {
+            auto deadline = TimerWheel::Clock::now() + std::chrono::duration_cast<TimerWheel::Clock::duration>(delay);
+            return scheduleTimer(deadline, DispatchTask(std::forward<Function>(block)));
+        }
     };
 }
 
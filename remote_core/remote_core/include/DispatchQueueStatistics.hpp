@@ -0,0 +1,101 @@
+//
+//  DispatchQueueStatistics.hpp
+//  remote_core
+//
+//  Created by David Moore on 10/19/26.
+//  Copyright © 2026 David Moore. All rights reserved.
+//
+
+#ifndef DispatchQueueStatistics_hpp
+#define DispatchQueueStatistics_hpp
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <ostream>
+#include <string>
+
+namespace RemoteCore {
+    /**
+     Histogram of durations with power of two buckets: bucket zero counts durations below one microsecond, and bucket 'i' counts durations in [2^(i - 1), 2^i) microseconds.
+     */
+    struct LatencyHistogram {
+        static constexpr size_t bucketCount = 32;
+        
+        std::array<uint64_t, bucketCount> buckets = {};
+        uint64_t count = 0;
+        uint64_t totalMicroseconds = 0;
+        uint64_t maximumMicroseconds = 0;
+        
+        static size_t bucketForDuration(uint64_t microseconds);
+        
+        void record(uint64_t microseconds);
+        void merge(const LatencyHistogram &histogram);
+        
+        std::chrono::microseconds getMean(void) const;
+        
+        /**
+         Returns an upper bound for the duration at the given percentile (e.g., 0.99), accurate to within a factor of two.
+         */
+        std::chrono::microseconds getPercentile(double percentile) const;
+    };
+    
+    /**
+     Lock-free counterpart of 'LatencyHistogram' that may be recorded into from any thread.
+     */
+    class AtomicLatencyHistogram {
+    private:
+        std::atomic<uint64_t> buckets[LatencyHistogram::bucketCount];
+        std::atomic<uint64_t> totalMicroseconds;
+        std::atomic<uint64_t> maximumMicroseconds;
+    
+    public:
+        AtomicLatencyHistogram();
+        
+        void record(uint64_t microseconds);
+        
+        /**
+         Adds the samples recorded so far to the histogram.
+         */
+        void mergeInto(LatencyHistogram &histogram) const;
+    };
+    
+    /**
+     Snapshot of the statistics of a single dispatch queue.
+     */
+    struct DispatchQueueStatistics {
+        std::string name;
+        
+        /// Amount of time since the queue was created.
+        std::chrono::microseconds uptime = std::chrono::microseconds(0);
+        
+        uint64_t enqueuedBlockCount = 0;
+        uint64_t completedBlockCount = 0;
+        
+        /// Number of blocks that are waiting to start.
+        size_t currentDepth = 0;
+        size_t maximumDepth = 0;
+        
+        /// Time from a block being executed on the queue until it started.
+        LatencyHistogram waitTime;
+        
+        /// Time each block took to run.
+        LatencyHistogram executionTime;
+        
+        /// Number of blocks that ran for longer than the queue's long-running threshold.
+        uint64_t longRunningBlockCount = 0;
+        
+        /**
+         Average number of blocks executed on the queue per second, since it was created.
+         */
+        double getEnqueueRate(void) const;
+    };
+    
+    /**
+     Writes a single line summary of the statistics.
+     */
+    std::ostream &operator<<(std::ostream &stream, const DispatchQueueStatistics &statistics);
+}
+
+#endif /* DispatchQueueStatistics_hpp */
@@ -0,0 +1,57 @@
+//
+//  DispatchStatisticsMonitor.hpp
+//  remote_core
+//
+//  Created by David Moore on 10/19/26.
+//  Copyright © 2026 David Moore. All rights reserved.
+//
+
+#ifndef DispatchStatisticsMonitor_hpp
+#define DispatchStatisticsMonitor_hpp
+
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include "DispatchQueue.hpp"
+
+namespace RemoteCore {
+    /**
+     Periodically writes the statistics of every dispatch queue to a stream, one line per queue.
+     */
+    class DispatchStatisticsMonitor {
+    private:
+        std::ostream &stream;
+        std::chrono::milliseconds interval;
+        std::mutex mutex;
+        bool isRunning;
+        DispatchTimer timer;
+        
+        // Declared last, so that an in-progress dump completes before the rest of the monitor is torn down.
+        std::unique_ptr<DispatchQueue> queue;
+        
+        void scheduleDump(void);
+    
+    public:
+        DispatchStatisticsMonitor(std::ostream &stream, std::chrono::milliseconds interval);
+        
+        /**
+         Stops the monitor, waiting for an in-progress dump to complete.
+         */
+        ~DispatchStatisticsMonitor();
+        
+        /**
+         Starts writing the statistics once every interval.
+         */
+        void start(void);
+        
+        void stop(void);
+        
+        /**
+         Writes the statistics immediately. (Asynchronous)
+         */
+        void dump(void);
+    };
+}
+
+#endif /* DispatchStatisticsMonitor_hpp */
@@ -0,0 +1,155 @@
+//
+//  DispatchTask.hpp
+//  remote_core
+//
+//  Created by David Moore on 10/19/26.
+//  Copyright © 2026 David Moore. All rights reserved.
+//
+
+#ifndef DispatchTask_hpp
+#define DispatchTask_hpp
+
+#include <cstddef>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+namespace RemoteCore {
+    /**
+     Move-only, type-erased 'void (void)' callable. Callables that fit within the inline buffer (most lambdas) are stored without allocating.
+     */
+    class DispatchTask {
+    public:
+        static constexpr size_t inlineCapacity = 48;
+    
+    private:
+        struct Operations {
+            void (*invoke)(void *storage);
+            void (*relocate)(void *source, void *destination);
+            void (*destroy)(void *storage);
+        };
+        
+        template <typename Function>
+        struct InlineOperations {
+            static void invoke(void *storage) {
+                (*static_cast<Function *>(storage))();
+            }
+            
+            static void relocate(void *source, void *destination) {
+                new (destination) Function(std::move(*static_cast<Function *>(source)));
+                static_cast<Function *>(source)->~Function();
+            }
+            
+            static void destroy(void *storage) {
+                static_cast<Function *>(storage)->~Function();
+            }
+            
+            static const Operations operations;
+        };
+        
+        template <typename Function>
+        struct HeapOperations {
+            static void invoke(void *storage) {
+                (**static_cast<Function **>(storage))();
+            }
+            
+            static void relocate(void *source, void *destination) {
+                *static_cast<Function **>(destination) = *static_cast<Function **>(source);
+            }
+            
+            static void destroy(void *storage) {
+                delete *static_cast<Function **>(storage);
+            }
+            
+            static const Operations operations;
+        };
+        
+        typename std::aligned_storage<inlineCapacity, alignof(std::max_align_t)>::type storage;
+        const Operations *operations;
+    
+    public:
+        DispatchTask() : operations(nullptr) {}
+        
+        template <typename Callable, typename Function = typename std::decay<Callable>::type, typename = typename std::enable_if<!std::is_same<Function, DispatchTask>::value>::type>
+        DispatchTask(Callable &&callable) {
+            // Only callables that can be moved without throwing are stored inline, so that relocating never fails part way.
+            using IsInline = std::integral_constant<bool, sizeof(Function) <= inlineCapacity && alignof(Function) <= alignof(std::max_align_t) && std::is_nothrow_move_constructible<Function>::value>;
+            construct<Function>(std::forward<Callable>(callable), IsInline());
+        }
+        
+        DispatchTask(DispatchTask &&task) noexcept : operations(task.operations) {
+            if (operations != nullptr) {
+                operations->relocate(&task.storage, &storage);
+                task.operations = nullptr;
+            }
+        }
+        
+        DispatchTask &operator=(DispatchTask &&task) noexcept {
+            if (this != &task) {
+                reset();
+                
+                operations = task.operations;
+                if (operations != nullptr) {
+                    operations->relocate(&task.storage, &storage);
+                    task.operations = nullptr;
+                }
+            }
+            
+            return *this;
+        }
+        
+        DispatchTask(const DispatchTask &) = delete;
+        DispatchTask &operator=(const DispatchTask &) = delete;
+        
+        ~DispatchTask() {
+            reset();
+        }
+        
+        explicit operator bool() const {
+            return operations != nullptr;
+        }
+        
+        void operator()(void) {
+            operations->invoke(&storage);
+        }
+        
+        /**
+         Destroys the stored callable, leaving the receiver empty.
+         */
+        void reset(void) {
+            if (operations != nullptr) {
+                operations->destroy(&storage);
+                operations = nullptr;
+            }
+        }
+    
+    private:
+        template <typename Function, typename Callable>
+        void construct(Callable &&callable, std::true_type) {
+            new (&storage) Function(std::forward<Callable>(callable));
+            operations = &InlineOperations<Function>::operations;
+        }
+        
+        template <typename Function, typename Callable>
+        void construct(Callable &&callable, std::false_type) {
+            *reinterpret_cast<Function **>(&storage) = new Function(std::forward<Callable>(callable));
+            operations = &HeapOperations<Function>::operations;
+        }
+    };
+    
+    template <typename Function>
+    const DispatchTask::Operations DispatchTask::InlineOperations<Function>::operations = {
+        &DispatchTask::InlineOperations<Function>::invoke,
+        &DispatchTask::InlineOperations<Function>::relocate,
+        &DispatchTask::InlineOperations<Function>::destroy
+    };
+    
+    template <typename Function>
+    const DispatchTask::Operations DispatchTask::HeapOperations<Function>::operations = {
+        &DispatchTask::HeapOperations<Function>::invoke,
+        &DispatchTask::HeapOperations<Function>::relocate,
+        &DispatchTask::HeapOperations<Function>::destroy
+    };
+}
+
+#endif /* DispatchTask_hpp */
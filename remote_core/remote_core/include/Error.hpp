@@ -17,7 +17,10 @@ namespace RemoteCore {
         TrainingAlreadyInSession    = -3,
         InvalidDirective            = -4,
         InvalidParameters           = -5,
-        NoTrainingSession           = -6
+        NoTrainingSession           = -6,
+        TrainingCancelled           = -7,
+        NoMatchingRemote            = -8,
+        TrainingTimedOut            = -9
     };
 }
 
@@ -0,0 +1,152 @@
+//
+//  EventLoop.hpp
+//  remote_core
+//
+//  Created by David Moore on 10/19/26.
+//  Copyright © 2026 David Moore. All rights reserved.
+//
+
+#ifndef EventLoop_hpp
+#define EventLoop_hpp
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <signal.h>
+
+namespace RemoteCore {
+    /**
+     Reactor that waits for signals, timers, posted handlers and file descriptor readiness on a single thread, and blocks completely while there is nothing to do.
+     
+     On Linux the loop is built on epoll, with signalfd, timerfd and eventfd. Other platforms use poll and a self-pipe.
+     
+     Each loop is independent, and there is no process-wide loop. The loop in 'main' only handles signals. Every other component drives its own events:
+     - 'MqttConnection', 'MqttBroker' and 'MulticastDNSAdvertiser' each run a private loop on their own thread.
+     - 'StreamConnector' creates a temporary loop for each synchronous connection.
+     - Dispatch queues wake their pool threads with condition variables, and their timers run on 'TimerWheel's thread.
+     */
+    class EventLoop {
+    public:
+        typedef std::function<void (void)> Handler;
+        typedef std::function<void (int signal)> SignalHandler;
+        typedef std::function<void (uint32_t events)> DescriptorHandler;
+        typedef uint64_t TimerIdentifier;
+        typedef std::chrono::steady_clock Clock;
+        
+        /**
+         Events a file descriptor may be monitored for.
+         */
+        enum DescriptorEvent : uint32_t {
+            Readable    = 1 << 0,
+            Writable    = 1 << 1,
+            
+            /// Always reported, and never needs to be requested.
+            Hangup      = 1 << 2
+        };
+    
+    private:
+        struct Timer {
+            Clock::time_point deadline;
+            std::chrono::milliseconds interval;
+            bool repeats;
+            std::shared_ptr<Handler> handler;
+        };
+        
+        std::mutex mutex;
+        bool shouldStop;
+        std::thread::id loopThread;
+        
+        int pollFD;
+        int wakeFD;
+        int wakeWriteFD;
+        int timerFD;
+        int signalFD;
+        sigset_t signalMask;
+        
+        std::vector<Handler> postedHandlers;
+        std::map<int, std::shared_ptr<SignalHandler>> signalHandlers;
+        std::map<int, std::pair<uint32_t, std::shared_ptr<DescriptorHandler>>> descriptorHandlers;
+        
+        TimerIdentifier nextTimerIdentifier;
+        std::map<TimerIdentifier, Timer> timers;
+        std::multimap<Clock::time_point, TimerIdentifier> timerDeadlines;
+        
+        void wake(void);
+        void drainWakeups(void);
+        void runPostedHandlers(void);
+        void runExpiredTimers(void);
+        void handleSignals(void);
+        void updateDescriptor(int fd, uint32_t events, bool isNew);
+        
+        /**
+         Removes the timer's entry from 'timerDeadlines'. Must be called with 'mutex' held.
+         */
+        void removeDeadline(TimerIdentifier identifier, Clock::time_point deadline);
+        
+        /**
+         Returns the earliest timer deadline, or 'Clock::time_point::max()' when there are no timers. Must be called with 'mutex' held.
+         */
+        Clock::time_point nextDeadline(void) const;
+        
+        /**
+         Arms the timer descriptor for the earliest deadline. Must be called with 'mutex' held.
+         */
+        void armTimer(void);
+        
+        /**
+         Waits for events, and runs their handlers. Returns once at least one event has been handled.
+         */
+        void waitForEvents(void);
+    
+    public:
+        EventLoop();
+        ~EventLoop();
+        
+        EventLoop(const EventLoop &) = delete;
+        EventLoop &operator=(const EventLoop &) = delete;
+        
+        /**
+         Handles the signal on the loop, rather than asynchronously. The signal is blocked on the calling thread, and on every thread it creates afterwards, so signals should be added before any other thread is started.
+         */
+        void addSignalHandler(int signal, SignalHandler handler);
+        
+        /**
+         Calls the handler on the loop once the interval has elapsed, and then once every interval if it repeats.
+         */
+        TimerIdentifier addTimer(std::chrono::milliseconds interval, bool repeats, Handler handler);
+        
+        /**
+         Prevents the timer from firing again. Has no effect if the timer has already fired and does not repeat.
+         */
+        void removeTimer(TimerIdentifier identifier);
+        
+        /**
+         Calls the handler on the loop whenever the file descriptor is ready for any of the events.
+         */
+        void addDescriptor(int fd, uint32_t events, DescriptorHandler handler);
+        
+        void removeDescriptor(int fd);
+        
+        /**
+         Runs the handler on the loop's thread. May be called from any thread.
+         */
+        void execute(Handler handler);
+        
+        /**
+         Runs the loop on the calling thread until 'stop' is called.
+         */
+        void run(void);
+        
+        /**
+         Causes 'run' to return once the current handler completes. May be called from any thread.
+         */
+        void stop(void);
+    };
+}
+
+#endif /* EventLoop_hpp */
@@ -0,0 +1,91 @@
+//
+//  FlightRecorder.hpp
+//  remote_core
+//
+//  Created by David Moore on 10/19/26.
+//  Copyright © 2026 David Moore. All rights reserved.
+//
+
+#ifndef FlightRecorder_hpp
+#define FlightRecorder_hpp
+
+#include <cstdint>
+#include <string>
+
+/// Number of events each thread keeps; older events are overwritten. Must be a power of two.
+#define FLIGHT_RECORDER_EVENTS_PER_THREAD 1024
+
+/*
+ Trace points are only compiled in when 'REMOTE_CORE_TRACING' is defined (i.e., with the 'ENABLE_TRACING' CMake option). Otherwise they expand to nothing, and their arguments are not evaluated.
+ 
+ The category and name must be string literals, since only their addresses are recorded.
+ */
+#ifdef REMOTE_CORE_TRACING
+#define REMOTE_CORE_TRACE_CONCATENATE_(a, b) a##b
+#define REMOTE_CORE_TRACE_CONCATENATE(a, b) REMOTE_CORE_TRACE_CONCATENATE_(a, b)
+
+/// Records the time from this point until the end of the enclosing scope.
+#define REMOTE_CORE_TRACE_SCOPE(category, name) RemoteCore::TraceScope REMOTE_CORE_TRACE_CONCATENATE(traceScope, __LINE__)(category, name)
+
+/// Records a single point in time, with a value such as a byte count.
+#define REMOTE_CORE_TRACE_INSTANT(category, name, value) RemoteCore::FlightRecorder::recordInstant(category, name, (uint64_t)(value))
+#else
+#define REMOTE_CORE_TRACE_SCOPE(category, name) ((void)0)
+#define REMOTE_CORE_TRACE_INSTANT(category, name, value) ((void)0)
+#endif
+
+namespace RemoteCore {
+    /**
+     Keeps the most recent trace events of every thread, so that the sequence of events leading up to a problem can be reconstructed, and writes them as Chrome trace JSON (i.e., for chrome://tracing or Perfetto).
+     
+     Each thread records into a ring buffer of its own without locking. Buffers are never freed; the buffer of a thread that exits is reused by the next thread that records, so its events continue on the same timeline row.
+     */
+    class FlightRecorder {
+    public:
+        /**
+         Returns the current time, in nanoseconds, on the clock that events are recorded with.
+         */
+        static uint64_t now(void);
+        
+        static void recordInstant(const char *category, const char *name, uint64_t value = 0);
+        
+        /**
+         Records an event that started at the given time, and ends now.
+         */
+        static void recordComplete(const char *category, const char *name, uint64_t startTime);
+        
+        /**
+         Writes the events of every thread as Chrome trace JSON. Only async-signal-safe functions are used, so this may be called from a signal handler. Returns false if writing failed.
+         */
+        static bool writeChromeTrace(int fd);
+        
+        static bool writeChromeTraceToFile(const std::string &path);
+        
+        /**
+         Writes the trace to the path if the process crashes (i.e., on SIGSEGV, SIGBUS, SIGILL, SIGFPE or SIGABRT), then lets the signal terminate the process as it otherwise would.
+         */
+        static void installCrashHandler(const std::string &path);
+    };
+    
+    /**
+     Records a complete event for its lifetime. Used through 'REMOTE_CORE_TRACE_SCOPE'.
+     */
+    class TraceScope {
+    private:
+        const char *category;
+        const char *name;
+        uint64_t startTime;
+    
+    public:
+        TraceScope(const char *category, const char *name) : category(category), name(name), startTime(FlightRecorder::now()) {}
+        
+        ~TraceScope() {
+            FlightRecorder::recordComplete(category, name, startTime);
+        }
+        
+        TraceScope(const TraceScope &) = delete;
+        TraceScope &operator=(const TraceScope &) = delete;
+    };
+}
+
+#endif /* FlightRecorder_hpp */
@@ -11,13 +11,16 @@
 
 #include <vector>
 #include "TrainingSession.hpp"
+#include "RemoteLibrary.hpp"
 #include "Remote.hpp"
+#include "DispatchFuture.hpp"
 
 namespace RemoteCore {
     class HardwareController {
     private:
         std::vector<std::string> sessionIDs;
         std::shared_ptr<TrainingSession> currentTrainingSession;
+        std::shared_ptr<RemoteLibrary> remoteLibrary;
         
         /**
          Determines if a configuration file exists for remoteID.
@@ -44,8 +47,22 @@ namespace RemoteCore {
         void sendCommandForRemoteWithCompletionHandler(Command command, Remote remote,
                                                        CompletionHandler completionHandler);
         
+        /**
+         Sends a command to an external device (i.e., controlled by the remote) through infrared.
+         
+         @return Future error, available once the command has been sent, or an error occurred.
+         */
+        DispatchFuture<Error> sendCommandForRemote(Command command, Remote remote);
+        
         // MARK: - Training
         
+        /**
+         Returns the library of known remotes, loaded from 'remotes/library/'. Training sessions use it to identify remotes.
+         */
+        std::shared_ptr<RemoteLibrary> getRemoteLibrary(void) const {
+            return remoteLibrary;
+        }
+        
         /**
          Returns a new training session that can be started when appropriate.
          */
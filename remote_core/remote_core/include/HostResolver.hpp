@@ -0,0 +1,152 @@
+//
+//  HostResolver.hpp
+//  remote_core
+//
+//  Created by David Moore on 10/19/26.
+//  Copyright © 2026 David Moore. All rights reserved.
+//
+
+#ifndef HostResolver_hpp
+#define HostResolver_hpp
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "DispatchQueue.hpp"
+#include "SocketAddress.hpp"
+
+/// Time to cache addresses for when their records' time to live is unknown (e.g., for names in the hosts file).
+#define HOST_RESOLVER_DEFAULT_TIME_TO_LIVE std::chrono::seconds(60)
+
+/// Bounds on the time addresses are cached for, whatever the records say.
+#define HOST_RESOLVER_MINIMUM_TIME_TO_LIVE std::chrono::seconds(5)
+#define HOST_RESOLVER_MAXIMUM_TIME_TO_LIVE std::chrono::seconds(3600)
+
+/// Time to cache a failure for, so that a missing name does not cause a lookup on every reconnect attempt.
+#define HOST_RESOLVER_NEGATIVE_TIME_TO_LIVE std::chrono::seconds(5)
+
+namespace RemoteCore {
+    /**
+     Result of looking up a name, with the time its addresses may be cached for.
+     */
+    struct HostLookup {
+        std::vector<SocketAddress> addresses;
+        
+        /// Zero on success, or an 'errno' value (e.g., 'EHOSTUNREACH' if the name does not exist).
+        int error = 0;
+        std::chrono::seconds timeToLive = HOST_RESOLVER_DEFAULT_TIME_TO_LIVE;
+    };
+    
+    struct HostResolverStatistics {
+        /// Lookups performed, which is fewer than the requests if requests were answered by the cache, or joined a lookup in progress.
+        uint64_t lookupCount = 0;
+        uint64_t cacheHitCount = 0;
+        uint64_t failedLookupCount = 0;
+    };
+    
+    /**
+     Resolves host names without blocking the caller, and caches the addresses for as long as their DNS records allow. Concurrent requests for a name share a single lookup.
+     
+     Addresses are ordered for connecting with 'StreamConnector', alternating between IPv6 and IPv4 (as described by RFC 8305), so that a broken path for one family does not delay connecting over the other.
+     
+     Every method may be called from any thread.
+     */
+    class HostResolver {
+    public:
+        /**
+         Called with the addresses for the host, or with an 'errno' value if there are none.
+         */
+        typedef std::function<void (const std::vector<SocketAddress> &addresses, int error)> CompletionHandler;
+        
+        /**
+         Looks up the name, blocking until its addresses are known. Ports are ignored.
+         */
+        typedef std::function<HostLookup (const std::string &host)> LookupFunction;
+        
+        typedef uint64_t RequestIdentifier;
+    
+    private:
+        struct CacheEntry {
+            std::vector<SocketAddress> addresses;
+            int error;
+            std::chrono::steady_clock::time_point expirationTime;
+        };
+        
+        struct Request {
+            std::string host;
+            uint16_t port;
+            CompletionHandler completionHandler;
+        };
+        
+        const LookupFunction lookUp;
+        std::mutex mutex;
+        std::map<std::string, CacheEntry> cache;
+        std::map<RequestIdentifier, Request> requests;
+        
+        /// Requests waiting for the lookup in progress for each host.
+        std::map<std::string, std::vector<RequestIdentifier>> pendingLookups;
+        RequestIdentifier lastRequestIdentifier;
+        HostResolverStatistics statistics;
+        
+        /// Held while completion handlers are called, so that 'cancel' can wait for a handler that is running.
+        std::recursive_mutex completionMutex;
+        
+        /// Declared last, so that lookups in progress finish before anything they use is destroyed.
+        DispatchQueue lookupQueue;
+        
+        void completeLookup(const std::string &host, HostLookup lookup);
+    
+    public:
+        /**
+         Creates a resolver that performs lookups with the function on its own threads, which bounds the number of lookups in progress.
+         */
+        explicit HostResolver(LookupFunction lookUp = lookUpWithSystemResolver, size_t threadCount = 2);
+        
+        HostResolver(const HostResolver &) = delete;
+        HostResolver &operator=(const HostResolver &) = delete;
+        
+        /**
+         Resolver that is shared by every connection.
+         */
+        static HostResolver *sharedResolver(void);
+        
+        /**
+         Calls the completion handler with the addresses for the host and port. Numeric addresses, and cached names, are completed before returning; otherwise the handler is called on one of the resolver's threads.
+         */
+        RequestIdentifier resolve(const std::string &host, uint16_t port, CompletionHandler completionHandler);
+        
+        /**
+         Resolves the host, and waits for up to the timeout. Returns the addresses, or none with 'error' set to 'ETIMEDOUT' if the lookup took too long.
+         */
+        std::vector<SocketAddress> resolve(const std::string &host, uint16_t port, std::chrono::milliseconds timeout, int &error);
+        
+        /**
+         Prevents the request's completion handler from being called. If the handler is running on another thread, waits for it to return.
+         */
+        void cancel(RequestIdentifier identifier);
+        
+        /**
+         Discards the cached addresses for the host, e.g., once none of them could be connected to.
+         */
+        void removeCachedAddresses(const std::string &host);
+        
+        HostResolverStatistics getStatistics(void);
+        
+        /**
+         Looks up the name with DNS, which reports the records' time to live, and falls back to 'getaddrinfo' for names DNS does not know (e.g., 'localhost' and names in the hosts file).
+         */
+        static HostLookup lookUpWithSystemResolver(const std::string &host);
+        
+        /**
+         Reorders the addresses to alternate between address families, starting with the family of the first address.
+         */
+        static std::vector<SocketAddress> interleaveFamilies(const std::vector<SocketAddress> &addresses);
+    };
+}
+
+#endif /* HostResolver_hpp */
@@ -0,0 +1,179 @@
+//
+//  LearningEngine.hpp
+//  remote_core
+//
+//  Created by David Moore on 10/19/26.
+//  Copyright © 2026 David Moore. All rights reserved.
+//
+
+#ifndef LearningEngine_hpp
+#define LearningEngine_hpp
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <vector>
+#include "DispatchQueue.hpp"
+#include "PulseStream.hpp"
+#include "Error.hpp"
+
+namespace RemoteCore {
+    /**
+     Durations of a single frame (i.e., one transmission of a button press), alternating between pulses and spaces and always starting with a pulse.
+     */
+    typedef std::vector<unsigned int> PulseFrame;
+    
+    /**
+     Encoding schemes that the learning engine is able to recognize.
+     */
+    enum class PulseProtocol {
+        /// Undecodable signal that is represented by the raw durations only.
+        Raw             = 0,
+        /// Constant pulses with the bit value carried in the space length (e.g., NEC).
+        PulseDistance   = 1,
+        /// Constant spaces with the bit value carried in the pulse length (e.g., Sony SIRC).
+        PulseWidth      = 2,
+        /// Bi-phase (Manchester) coding with a fixed half-bit period (e.g., RC5).
+        Biphase         = 3
+    };
+    
+    /**
+     Pulse and space pair that describes a symbol in the signal, in microseconds.
+     */
+    struct PulsePair {
+        unsigned int pulse = 0;
+        unsigned int space = 0;
+        
+        bool operator ==(const PulsePair &rhs) const {
+            return pulse == rhs.pulse && space == rhs.space;
+        }
+    };
+    
+    /**
+     Description of a decoded command, using the same terminology as lircd.conf.
+     */
+    struct LearnedCode {
+        PulseProtocol protocol = PulseProtocol::Raw;
+        PulsePair header;
+        PulsePair one;
+        PulsePair zero;
+        unsigned int trailingPulse = 0;
+        unsigned int gap = 0;
+        unsigned int bitCount = 0;
+        uint64_t code = 0;
+        
+        /// Frame with each duration snapped to the center of its cluster.
+        PulseFrame rawFrame;
+        
+        bool isValid(void) const {
+            return !rawFrame.empty();
+        }
+        
+        /**
+         Codes are considered equal when they represent the same button, regardless of small variations in the raw timing.
+         */
+        bool isEquivalentTo(const LearnedCode &code) const;
+    };
+    
+    /**
+     Outcome of a learning attempt.
+     */
+    struct LearningResult {
+        Error error = Error::Unknown;
+        LearnedCode code;
+        
+        /// Time taken from the start of the learning request until the result was produced.
+        std::chrono::microseconds latency = std::chrono::microseconds(0);
+        
+        /// Time spent segmenting, clustering and decoding once the signal was captured.
+        std::chrono::microseconds decodeDuration = std::chrono::microseconds(0);
+        
+        /// Number of complete frames that were captured.
+        size_t frameCount = 0;
+    };
+    
+    /**
+     Parameters that control how signals are segmented and decoded.
+     */
+    struct LearningConfiguration {
+        /// Spaces at least this long (in microseconds) separate frames.
+        unsigned int frameGap = 10000;
+        
+        /// Relative difference between durations that still places them in the same cluster.
+        double tolerance = 0.35;
+        
+        /// Number of identical decodes required before learning completes early.
+        size_t requiredMatchingFrames = 2;
+        
+        /// Frames shorter than this are treated as repeat codes and ignored.
+        size_t minimumFrameLength = 8;
+        
+        /// Maximum amount of time to wait for a signal.
+        std::chrono::milliseconds timeout = std::chrono::seconds(10);
+    };
+    
+    /**
+     Turns a captured pulse stream into a decoded command. Learning happens asynchronously on a queue that is owned by the receiver.
+     */
+    class LearningEngine {
+    public:
+        typedef std::function<void (LearningResult result)> CompletionHandler;
+    
+    private:
+        LearningConfiguration configuration;
+        std::atomic_bool isCancelled;
+        std::unique_ptr<DispatchQueue> queue;
+        
+        LearningResult learnFromStream(PulseStream *stream, std::chrono::steady_clock::time_point startTime);
+        unsigned int snapDuration(unsigned int duration, const std::vector<unsigned int> &centers) const;
+        bool decodePulseDistance(const PulseFrame &frame, size_t offset, LearnedCode &code) const;
+        bool decodePulseWidth(const PulseFrame &frame, size_t offset, LearnedCode &code) const;
+        bool decodeBiphase(const PulseFrame &frame, LearnedCode &code) const;
+    
+    public:
+        LearningEngine(LearningConfiguration configuration = LearningConfiguration());
+        
+        /**
+         Cancels any learning that is in progress, and waits for the queue to finish.
+         */
+        ~LearningEngine();
+        
+        LearningConfiguration getConfiguration(void) const {
+            return configuration;
+        }
+        
+        /**
+         Learns a command from the provided stream. (Asynchronous)
+         
+         @param stream Stream of samples that will be read until a command is learnt, the stream ends, or the timeout elapses.
+         @param completionHandler Called on the receiver's queue with the result.
+         */
+        void learnFromStreamWithCompletionHandler(std::unique_ptr<PulseStream> stream, CompletionHandler completionHandler);
+        
+        /**
+         Stops learning as soon as possible. The completion handler of an in-progress request is still called.
+         */
+        void cancel(void);
+        
+        // MARK: - Decoding
+        
+        /**
+         Splits samples into frames, separated by long spaces or timeouts.
+         */
+        std::vector<PulseFrame> segmentFrames(const std::vector<PulseSample> &samples) const;
+        
+        /**
+         Groups durations that are within the tolerance of one another and returns the center of each group in ascending order.
+         */
+        std::vector<unsigned int> clusterDurations(std::vector<unsigned int> durations) const;
+        
+        /**
+         Decodes a single frame. Frames that match no supported protocol are returned as 'PulseProtocol::Raw'.
+         */
+        LearnedCode decodeFrame(const PulseFrame &frame) const;
+    };
+}
+
+#endif /* LearningEngine_hpp */
@@ -0,0 +1,87 @@
+//
+//  LocalEndpoint.hpp
+//  remote_core
+//
+//  Created by David Moore on 10/19/26.
+//  Copyright © 2026 David Moore. All rights reserved.
+//
+
+#ifndef LocalEndpoint_hpp
+#define LocalEndpoint_hpp
+
+#include <functional>
+#include <memory>
+#include <string>
+#include "BufferChain.hpp"
+#include "MqttBroker.hpp"
+#include "MulticastDNSAdvertiser.hpp"
+#include "StreamTransport.hpp"
+
+/// Type of service the local endpoint is advertised as.
+#define LOCAL_ENDPOINT_SERVICE_TYPE "_remote-core._tcp"
+
+namespace RemoteCore {
+    struct LocalEndpointOptions {
+        /// Port that is listened on, on every interface, or an ephemeral port if zero.
+        uint16_t port = 0;
+        
+        /// The device's certificate and private key, and the root certificate that clients' certificates are verified against, unless 'verifiesPeer' is false.
+        TlsConfiguration tlsConfiguration;
+        
+        /// Topic that messages are accepted on, and published to.
+        std::string topicName;
+        
+        /// Advertised with multicast DNS, with the endpoint's port, unless the instance name is empty.
+        ServiceDescription advertisement;
+        
+        /// Port that multicast DNS is answered on, which is only changed by tests.
+        uint16_t advertisementPort = MULTICAST_DNS_PORT;
+    };
+    
+    /**
+     MQTT endpoint over TLS on the local network, which lets phones on the same network send messages to the device, and receive its messages, without the round trip through the IoT Core. The cloud remains the fallback, so the endpoint does not keep messages for phones that are not connected.
+     
+     Messages use the same topic and format as they do through the IoT Core. The device does not connect to the endpoint itself; messages that phones publish are passed to the handler instead.
+     */
+    class LocalEndpoint {
+    public:
+        /// Called on the endpoint's thread for every message that a phone publishes on the topic.
+        typedef std::function<void (const SharedBuffer &message)> MessageHandler;
+    
+    private:
+        std::string topicName;
+        MqttBroker broker;
+        std::unique_ptr<MulticastDNSAdvertiser> advertiser;
+    
+    public:
+        /**
+         Starts listening, and advertising the endpoint if it has an instance name. Throws 'std::runtime_error' if the certificate or key cannot be loaded, and 'std::system_error' if the port cannot be listened on.
+         */
+        LocalEndpoint(const LocalEndpointOptions &options, MessageHandler messageHandler);
+        
+        LocalEndpoint(const LocalEndpoint &) = delete;
+        LocalEndpoint &operator=(const LocalEndpoint &) = delete;
+        
+        uint16_t getPort(void) const {
+            return broker.getPort();
+        }
+        
+        /**
+         Returns the advertiser, or null if the endpoint is not advertised.
+         */
+        const MulticastDNSAdvertiser *getAdvertiser(void) const {
+            return advertiser.get();
+        }
+        
+        /**
+         Delivers the message to every phone that is connected, and subscribes to the topic. May be called from any thread.
+         */
+        void publishMessage(SharedBuffer message);
+        
+        MqttBrokerStatistics getStatistics(void) const {
+            return broker.getStatistics();
+        }
+    };
+}
+
+#endif /* LocalEndpoint_hpp */
@@ -41,6 +41,12 @@ namespace RemoteCore {
         /// A loosely typed way to indicate what the intention of the message is.
         std::string directive;
         
+        /// Topic that the sender asked for the response to be published to, which is carried by the MQTT 5 properties rather than encoded.
+        std::string responseTopic;
+        
+        /// Returned to the sender with the response, so that it can match the response to its request. Carried by the MQTT 5 properties rather than encoded.
+        std::string correlationData;
+        
         /// Initializes a new message.
         Message(MessageType type = MessageType::Default);
         
@@ -0,0 +1,145 @@
+//
+//  MessageOutbox.hpp
+//  remote_core
+//
+//  Created by David Moore on 10/19/26.
+//  Copyright © 2026 David Moore. All rights reserved.
+//
+
+#ifndef MessageOutbox_hpp
+#define MessageOutbox_hpp
+
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "BufferChain.hpp"
+
+#define MESSAGE_OUTBOX_DEFAULT_SEGMENT_SIZE (64 * 1024)
+#define MESSAGE_OUTBOX_DEFAULT_SEGMENT_COUNT 16
+
+namespace RemoteCore {
+    struct OutboxMessage {
+        std::string topicName;
+        std::string payload;
+        
+        /// Position just past the message, which is passed to 'MessageOutbox::remove' once the message has been sent.
+        uint64_t endOffset;
+    };
+    
+    struct MessageOutboxStatistics {
+        uint64_t appendedCount = 0;
+        uint64_t removedCount = 0;
+        
+        /// Messages that were discarded, oldest segment first, to make room for newer ones.
+        uint64_t droppedCount = 0;
+        
+        /// Messages that were refused because they are larger than a segment.
+        uint64_t rejectedCount = 0;
+    };
+    
+    /**
+     Durable first-in, first-out queue of outgoing messages, stored in a memory-mapped file so that messages survive a restart of the process.
+     
+     The file is a ring of fixed-size segments, and a message never spans two segments. Once the ring is full, the oldest segment is discarded as a whole, so the file never grows, and a long outage costs the oldest messages rather than the newest ones.
+     
+     Writes reach the file through the shared mapping, so they survive the process crashing; 'synchronize' flushes them to the storage device as well. A message that was only partially written when the process stopped is detected by its checksum, and discarded along with everything after it.
+     
+     Every method may be called from any thread.
+     */
+    class MessageOutbox {
+        struct FileHeader;
+        
+        enum class RecordKind {
+            Message,
+            Padding,
+            Invalid
+        };
+        
+        std::mutex mutex;
+        int fd;
+        uint8_t *mapping;
+        size_t mappingSize;
+        const size_t segmentSize;
+        const size_t segmentCount;
+        size_t messageCount;
+        MessageOutboxStatistics statistics;
+        
+        FileHeader &getHeader(void) const;
+        uint8_t *dataAtOffset(uint64_t offset) const;
+        
+        /**
+         Reads the record at the offset, setting 'nextOffset' to the start of the following record. The message is only decoded if it is non-null.
+         */
+        RecordKind readRecord(uint64_t offset, uint64_t &nextOffset, OutboxMessage *message) const;
+        
+        void initializeFile(void);
+        
+        /**
+         Validates every record between the head and the tail, moving the tail back to the first invalid record. Must be called with 'mutex' held.
+         */
+        void recoverRecords(void);
+        
+        /**
+         Advances the head past every message before 'endOffset', and returns the number of messages removed. Must be called with 'mutex' held.
+         */
+        size_t advanceHead(uint64_t endOffset);
+        
+        bool appendRecord(const std::string &topicName, const char *payload, size_t payloadLength, uint64_t &endOffset);
+    
+    public:
+        /**
+         Opens the outbox at the path, creating it if it does not exist. An existing file that is damaged, or that was created with a different number or size of segments, is discarded.
+         
+         Throws 'std::system_error' if the file cannot be opened or mapped.
+         */
+        MessageOutbox(const std::string &path, size_t segmentSize = MESSAGE_OUTBOX_DEFAULT_SEGMENT_SIZE, size_t segmentCount = MESSAGE_OUTBOX_DEFAULT_SEGMENT_COUNT);
+        ~MessageOutbox();
+        
+        MessageOutbox(const MessageOutbox &) = delete;
+        MessageOutbox &operator=(const MessageOutbox &) = delete;
+        
+        /**
+         Appends the message, discarding the oldest segments if there is not enough room. Returns false if the message can never fit in a segment.
+         */
+        bool append(const std::string &topicName, const std::string &payload);
+        
+        /**
+         Appends the message, as above, and sets 'endOffset' to the position just past it, which may be passed to 'remove' once the message has been sent.
+         */
+        bool append(const std::string &topicName, const SharedBuffer &payload, uint64_t &endOffset);
+        
+        /**
+         Returns up to 'maximumCount' of the oldest messages, without removing them.
+         */
+        std::vector<OutboxMessage> peek(size_t maximumCount);
+        
+        /**
+         Removes every message up to 'endOffset', which is the 'endOffset' of a message returned by 'peek'. Messages that have been discarded since are skipped.
+         */
+        void remove(uint64_t endOffset);
+        
+        /**
+         Blocks until every message has been written to the storage device.
+         */
+        void synchronize(void);
+        
+        size_t getCount(void);
+        
+        bool isEmpty(void) {
+            return getCount() == 0;
+        }
+        
+        /**
+         Returns the number of bytes available to messages, including the space lost to segment boundaries.
+         */
+        size_t getCapacity(void) const {
+            return segmentSize * segmentCount;
+        }
+        
+        MessageOutboxStatistics getStatistics(void);
+    };
+}
+
+#endif /* MessageOutbox_hpp */
@@ -0,0 +1,69 @@
+//
+//  MetricsExporter.hpp
+//  remote_core
+//
+//  Created by David Moore on 10/19/26.
+//  Copyright © 2026 David Moore. All rights reserved.
+//
+
+#ifndef MetricsExporter_hpp
+#define MetricsExporter_hpp
+
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include "DispatchQueue.hpp"
+#include "MetricsRegistry.hpp"
+
+namespace RemoteCore {
+    /**
+     Periodically exports the metrics of a registry to a Prometheus text file, e.g. for the node exporter's textfile collector, and to a handler as JSON, e.g. to publish them to a stats topic.
+     */
+    class MetricsExporter {
+    public:
+        typedef std::function<void (std::string json)> PublishHandler;
+    
+    private:
+        MetricsRegistry &registry;
+        std::string path;
+        std::chrono::milliseconds interval;
+        PublishHandler publishHandler;
+        std::mutex mutex;
+        bool isRunning;
+        DispatchTimer timer;
+        
+        // Declared last, so that an in-progress export completes before the rest of the exporter is torn down.
+        std::unique_ptr<DispatchQueue> queue;
+        
+        void scheduleExport(void);
+    
+    public:
+        /**
+         @param path Path of the Prometheus text file, or an empty string to not write one.
+         @param publishHandler Called with the metrics as JSON after each export, or null.
+         */
+        MetricsExporter(MetricsRegistry &registry, const std::string &path, std::chrono::milliseconds interval,
+                        PublishHandler publishHandler);
+        
+        /**
+         Stops the exporter, waiting for an in-progress export to complete.
+         */
+        ~MetricsExporter();
+        
+        /**
+         Starts exporting the metrics once every interval.
+         */
+        void start(void);
+        
+        void stop(void);
+        
+        /**
+         Exports the metrics immediately. (Asynchronous)
+         */
+        void exportMetrics(void);
+    };
+}
+
+#endif /* MetricsExporter_hpp */
@@ -0,0 +1,197 @@
+//
+//  MetricsRegistry.hpp
+//  remote_core
+//
+//  Created by David Moore on 10/19/26.
+//  Copyright © 2026 David Moore. All rights reserved.
+//
+
+#ifndef MetricsRegistry_hpp
+#define MetricsRegistry_hpp
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+#include "DispatchQueueStatistics.hpp"
+
+namespace RemoteCore {
+    /**
+     Label names and values that distinguish the series of a metric, e.g. {{"result", "success"}}.
+     */
+    typedef std::vector<std::pair<std::string, std::string>> MetricLabels;
+    
+    enum class MetricType {
+        Counter,
+        Gauge,
+        Histogram
+    };
+    
+    /**
+     Value that only ever increases, such as the number of messages published.
+     */
+    class MetricCounter {
+    private:
+        std::atomic<uint64_t> value;
+    
+    public:
+        MetricCounter() : value(0) {}
+        
+        void increment(uint64_t amount = 1) {
+            value.fetch_add(amount, std::memory_order_relaxed);
+        }
+        
+        uint64_t getValue(void) const {
+            return value.load(std::memory_order_relaxed);
+        }
+    };
+    
+    /**
+     Value that may increase and decrease, such as the number of messages awaiting acknowledgement.
+     */
+    class MetricGauge {
+    private:
+        std::atomic<int64_t> value;
+    
+    public:
+        MetricGauge() : value(0) {}
+        
+        void set(int64_t newValue) {
+            value.store(newValue, std::memory_order_relaxed);
+        }
+        
+        void add(int64_t amount) {
+            value.fetch_add(amount, std::memory_order_relaxed);
+        }
+        
+        int64_t getValue(void) const {
+            return value.load(std::memory_order_relaxed);
+        }
+    };
+    
+    /**
+     Distribution of durations, with the power of two buckets of 'LatencyHistogram'.
+     */
+    class MetricHistogram {
+    private:
+        AtomicLatencyHistogram histogram;
+    
+    public:
+        void record(std::chrono::microseconds duration) {
+            histogram.record((uint64_t)std::max<std::chrono::microseconds::rep>(duration.count(), 0));
+        }
+        
+        /**
+         Records the time that has elapsed since the start time.
+         */
+        void recordSince(std::chrono::steady_clock::time_point startTime) {
+            record(std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - startTime));
+        }
+        
+        LatencyHistogram getSnapshot(void) const {
+            LatencyHistogram snapshot;
+            histogram.mergeInto(snapshot);
+            return snapshot;
+        }
+    };
+    
+    /**
+     Value of a single series at the time the metrics were collected.
+     */
+    struct MetricSample {
+        MetricLabels labels;
+        
+        /// Value of a counter or gauge.
+        double value = 0;
+        
+        /// Distribution of a histogram, in microseconds.
+        LatencyHistogram histogram;
+    };
+    
+    /**
+     Every series of a metric, at the time the metrics were collected.
+     */
+    struct MetricFamily {
+        std::string name;
+        std::string help;
+        MetricType type = MetricType::Counter;
+        std::vector<MetricSample> samples;
+    };
+    
+    /**
+     Named counters, gauges and histograms that are exported together.
+     
+     Registering a metric takes a lock, and returns a reference that remains valid for the lifetime of the registry, so call sites should look their metrics up once and keep the references. Updating a metric never locks.
+     */
+    class MetricsRegistry {
+    public:
+        /**
+         Called while collecting, to add metrics that are kept elsewhere, such as the statistics of the dispatch queues.
+         */
+        typedef std::function<void (std::vector<MetricFamily> &families)> Collector;
+    
+    private:
+        struct Series {
+            MetricLabels labels;
+            std::unique_ptr<MetricCounter> counter;
+            std::unique_ptr<MetricGauge> gauge;
+            std::unique_ptr<MetricHistogram> histogram;
+        };
+        
+        struct Family {
+            std::string help;
+            MetricType type;
+            std::vector<std::unique_ptr<Series>> series;
+        };
+        
+        mutable std::mutex mutex;
+        std::map<std::string, Family> families;
+        std::vector<Collector> collectors;
+        
+        Series &seriesForMetric(const std::string &name, const std::string &help, MetricType type, const MetricLabels &labels);
+    
+    public:
+        /**
+         Returns the registry that the rest of remote_core records into. It includes the statistics of every dispatch queue.
+         */
+        static MetricsRegistry &sharedRegistry(void);
+        
+        /**
+         Returns the counter with the name and labels, registering it if needed. Throws 'std::logic_error' if the name is already registered as another type of metric.
+         */
+        MetricCounter &counter(const std::string &name, const std::string &help, const MetricLabels &labels = {});
+        MetricGauge &gauge(const std::string &name, const std::string &help, const MetricLabels &labels = {});
+        MetricHistogram &histogram(const std::string &name, const std::string &help, const MetricLabels &labels = {});
+        
+        void addCollector(Collector collector);
+        
+        /**
+         Returns a snapshot of every metric, sorted by name.
+         */
+        std::vector<MetricFamily> collect(void) const;
+        
+        /**
+         Formats the metrics in the Prometheus text exposition format. Histograms are exported in seconds.
+         */
+        static std::string formatPrometheusText(const std::vector<MetricFamily> &families);
+        
+        /**
+         Formats the metrics as a compact JSON object, keyed by series, which summarizes each histogram by its count, mean, 50th and 99th percentile and maximum, in microseconds.
+         */
+        static std::string formatJSON(const std::vector<MetricFamily> &families);
+        
+        /**
+         Writes the metrics in the Prometheus text format to a temporary file, then renames it over the path, so that a collector never reads a partially written file. Returns false if the file could not be written.
+         */
+        static bool writePrometheusTextToFile(const std::vector<MetricFamily> &families, const std::string &path);
+    };
+}
+
+#endif /* MetricsRegistry_hpp */
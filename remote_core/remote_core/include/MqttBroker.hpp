@@ -0,0 +1,143 @@
+//
+//  MqttBroker.hpp
+//  remote_core
+//
+//  Created by David Moore on 10/19/26.
+//  Copyright © 2026 David Moore. All rights reserved.
+//
+
+#ifndef MqttBroker_hpp
+#define MqttBroker_hpp
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+#include "EventLoop.hpp"
+#include "MqttPacket.hpp"
+#include "StreamTransport.hpp"
+
+namespace RemoteCore {
+    struct MqttBrokerStatistics {
+        uint64_t acceptedConnectionCount = 0;
+        uint64_t receivedPublishCount = 0;
+        uint64_t deliveredPublishCount = 0;
+    };
+    
+    /**
+     Minimal MQTT 3.1.1 and MQTT 5 broker on the loopback interface, which lets the client be tested, and its latency measured, without the IoT Core. Connections are plain TCP, or TLS if the broker is given a server's configuration (e.g., so that 'ConnectionManager', which always uses TLS, can connect to it). A TLS broker may also listen on every interface, so that the device can be reached directly on the local network.
+     
+     The process that owns the broker takes part without connecting to it: every message that clients publish is passed to the message handler, and 'publish' delivers a message to the clients.
+     
+     Sessions are never kept, retained messages and wills are not supported, and messages are delivered with the lower of the publisher's and the subscriber's quality of service, without waiting for subscribers to acknowledge them.
+     
+     MQTT 5 clients may publish with topic aliases, and receive the properties of every message, since messages are delivered at once and never expire in the broker. The broker does not assign topic aliases itself.
+     */
+    class MqttBroker {
+    public:
+        /// Called on the broker's thread for every message that a client publishes.
+        typedef std::function<void (const std::string &topicName, const SharedBuffer &payload)> MessageHandler;
+    
+    private:
+        struct Session {
+            std::unique_ptr<StreamTransport> transport;
+            MqttPacketParser parser;
+            BufferChain outboundChain;
+            uint32_t descriptorEvents = 0;
+            
+            /// True until the TLS handshake has finished, for brokers that use TLS.
+            bool isHandshaking = false;
+            bool isConnected = false;
+            uint8_t protocolLevel = MQTT_PROTOCOL_LEVEL;
+            std::string clientID;
+            
+            /// Topic names that the client assigned aliases to.
+            std::map<uint16_t, std::string> topicAliases;
+            std::map<std::string, uint8_t> subscriptions;
+            uint16_t lastPacketIdentifier = 0;
+        };
+        
+        EventLoop loop;
+        std::thread loopThread;
+        int listenFD;
+        uint16_t port;
+        TlsConfiguration tlsConfiguration;
+        
+        /// Context of every session's TLS transport, or null if connections are plain TCP.
+        std::shared_ptr<SSL_CTX> tlsContext;
+        
+        // These members are only accessed on the loop's thread.
+        std::map<int, std::unique_ptr<Session>> sessions;
+        MessageHandler messageHandler;
+        
+        /// Sessions with bytes waiting to be written once the current readiness event has been handled.
+        std::set<int> pendingFlushDescriptors;
+        
+        std::atomic<uint64_t> acceptedConnectionCount;
+        std::atomic<uint64_t> receivedPublishCount;
+        std::atomic<uint64_t> deliveredPublishCount;
+        
+        void start(uint16_t port, bool listensOnAnyInterface);
+        void acceptConnections(void);
+        void handshake(int fd, Session &session);
+        void handleSessionEvents(int fd, uint32_t events);
+        void handlePacket(int fd, Session &session, MqttPacket &packet);
+        
+        /**
+         Replaces the topic alias of a PUBLISH packet with the topic name it stands for. Returns false if the alias is invalid, or unknown.
+         */
+        static bool resolveTopicAlias(Session &session, MqttPacket &packet);
+        void deliverMessage(const MqttPacket &packet);
+        void enqueuePacket(int fd, Session &session, const MqttPacket &packet);
+        void flushSessions(void);
+        void setSessionEvents(int fd, Session &session, uint32_t events);
+        void closeSession(int fd);
+    
+    public:
+        /**
+         Starts listening on the loopback interface, on an ephemeral port if the port is zero.
+         */
+        explicit MqttBroker(uint16_t port = 0);
+        
+        /**
+         Starts listening for TLS connections, which are accepted with the configuration, on the loopback interface, or on every interface if 'listensOnAnyInterface' is true. Throws 'std::runtime_error' if the configuration's certificate or key cannot be loaded, and 'std::system_error' if the port cannot be listened on.
+         */
+        MqttBroker(uint16_t port, const TlsConfiguration &tlsConfiguration, bool listensOnAnyInterface = false);
+        ~MqttBroker();
+        
+        MqttBroker(const MqttBroker &) = delete;
+        MqttBroker &operator=(const MqttBroker &) = delete;
+        
+        uint16_t getPort(void) const {
+            return port;
+        }
+        
+        /**
+         Closes every client's connection without sending anything, as if the network had failed.
+         */
+        void dropConnections(void);
+        
+        /**
+         Sets the handler that is passed every message that clients publish, replacing the previous handler. May be called from any thread, although messages published before the handler is set are not passed to it.
+         */
+        void setMessageHandler(MessageHandler messageHandler);
+        
+        /**
+         Delivers the message to every client that subscribes to the topic, as if a client had published it, except that it is not passed to the message handler. May be called from any thread.
+         */
+        void publish(const std::string &topicName, SharedBuffer payload, uint8_t qualityOfService);
+        
+        bool usesTLS(void) const {
+            return tlsContext != nullptr;
+        }
+        
+        MqttBrokerStatistics getStatistics(void) const;
+    };
+}
+
+#endif /* MqttBroker_hpp */
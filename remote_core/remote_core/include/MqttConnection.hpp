@@ -0,0 +1,338 @@
+//
+//  MqttConnection.hpp
+//  remote_core
+//
+//  Created by David Moore on 10/19/26.
+//  Copyright © 2026 David Moore. All rights reserved.
+//
+
+#ifndef MqttConnection_hpp
+#define MqttConnection_hpp
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <map>
+#include <memory>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+#include "EventLoop.hpp"
+#include "MqttPacket.hpp"
+#include "StreamConnector.hpp"
+#include "StreamTransport.hpp"
+
+namespace RemoteCore {
+    enum class MqttStatus {
+        Success,
+        
+        /// The connection is not established, and is not being re-established.
+        NotConnected,
+        
+        /// The TCP connection or the TLS handshake failed.
+        ConnectFailed,
+        
+        /// The broker refused the connection in its CONNACK packet.
+        ConnectionRefused,
+        
+        ConnectionLost,
+        
+        /// The broker did not respond within the command timeout.
+        Timeout,
+        
+        /// The broker refused at least one of the subscriptions in a SUBSCRIBE packet.
+        SubscriptionRefused,
+        
+        ProtocolError,
+        
+        /// The packet is larger than the broker accepts, so it was not sent.
+        PacketTooLarge,
+        
+        /// The connection was closed by 'disconnect', or destroyed, before the operation completed.
+        Cancelled
+    };
+    
+    struct MqttConnectionOptions {
+        std::string host;
+        uint16_t port = 1883;
+        std::string clientID;
+        
+        /// Maximum time between packets sent to the broker, or zero to disable keep alive. An MQTT 5 broker may replace it.
+        std::chrono::seconds keepAliveInterval = std::chrono::seconds(60);
+        bool isCleanSession = true;
+        
+        /// Maximum time to wait for connecting, and for every acknowledgement.
+        std::chrono::milliseconds commandTimeout = std::chrono::milliseconds(20000);
+        
+        /// Maximum time to resolve the host and establish the TCP connection, which is also bounded by 'commandTimeout'.
+        std::chrono::milliseconds connectTimeout = std::chrono::milliseconds(10000);
+        
+        /// Time to wait for a connection attempt to one of the host's addresses before also trying the next.
+        std::chrono::milliseconds connectionAttemptDelay = STREAM_CONNECTOR_DEFAULT_ATTEMPT_DELAY;
+        
+        /// Whether the connection is re-established automatically once it has been lost, waiting twice as long after every failed attempt.
+        bool reconnectsAutomatically = true;
+        std::chrono::milliseconds minimumReconnectInterval = std::chrono::milliseconds(1000);
+        std::chrono::milliseconds maximumReconnectInterval = std::chrono::milliseconds(128000);
+        
+        bool usesTLS = false;
+        TlsConfiguration tlsConfiguration;
+        
+        size_t maximumPacketSize = MQTT_DEFAULT_MAXIMUM_PACKET_SIZE;
+        
+        /// 'MQTT_PROTOCOL_LEVEL' for MQTT 3.1.1, or 'MQTT_5_PROTOCOL_LEVEL' for MQTT 5, which sends message properties, and replaces repeated topic names with topic aliases.
+        uint8_t protocolLevel = MQTT_PROTOCOL_LEVEL;
+        
+        /// Number of topic aliases the broker may use for messages sent to the client, or zero to refuse them. Only used with MQTT 5.
+        uint16_t topicAliasMaximum = 0;
+        
+        /// Creates the transport for every connected socket, taking ownership of it, in place of the TCP or TLS transport that 'usesTLS' chooses (e.g., to test how the connection handles the transport).
+        std::function<std::unique_ptr<StreamTransport> (int fd)> transportFactory;
+    };
+    
+    struct MqttConnectionStatistics {
+        uint64_t sentPacketCount = 0;
+        uint64_t receivedPacketCount = 0;
+        
+        /// Number of writes to the transport; fewer writes than sent packets means packets were coalesced.
+        uint64_t writeCount = 0;
+        uint64_t reconnectCount = 0;
+    };
+    
+    /**
+     MQTT 3.1.1, or MQTT 5, client that is driven entirely by socket readiness, timers and posted work on its own event loop, so that packets are written as soon as they are submitted. Packets submitted together, or while a write is in progress, are coalesced into a single write.
+     
+     Every method may be called from any thread. Handlers are called on the connection's thread, and must not wait for the connection (e.g., by blocking on a future that it resolves).
+     
+     Quality of service levels zero and one are supported for publishing. Unacknowledged packets are sent again once a lost connection has been re-established.
+     
+     With MQTT 5, every topic that is published to is given a topic alias, as long as the broker accepts more of them, so that later messages on the topic leave out its name. Aliases only last for a single network connection, and are assigned again after reconnecting.
+     
+     An MQTT 5 broker's CONNACK packet may also limit the connection: its keep alive interval replaces the client's, publishes beyond its receive maximum wait until earlier ones are acknowledged, and packets larger than its maximum packet size complete with 'MqttStatus::PacketTooLarge' rather than being sent.
+     */
+    class MqttConnection {
+    public:
+        typedef std::function<void (MqttStatus status)> CompletionHandler;
+        typedef std::function<void (const std::string &topicName, const std::string &payload)> MessageHandler;
+        
+        /**
+         Called for every message, with its properties, which are empty unless the connection uses MQTT 5. Topic aliases have already been replaced by the topic names they stand for.
+         */
+        typedef std::function<void (const std::string &topicName, const SharedBuffer &payload, const MqttProperties &properties)> PublishHandler;
+        
+        /**
+         Called whenever the connection is established or lost. Subscriptions must be restored after connecting if the broker did not keep the session.
+         */
+        typedef std::function<void (bool isConnected, bool isSessionPresent)> ConnectionHandler;
+        
+        struct OutboundMessage {
+            std::string topicName;
+            SharedBuffer payload;
+            uint8_t qualityOfService;
+            CompletionHandler completionHandler;
+            
+            /// Only sent with MQTT 5. The topic alias is assigned by the connection, and is ignored.
+            MqttProperties properties;
+        };
+    
+    private:
+        enum class State {
+            Disconnected,
+            Connecting,
+            Handshaking,
+            AwaitingAcknowledgement,
+            Connected,
+            WaitingToReconnect
+        };
+        
+        struct PendingAcknowledgement {
+            /// Sent again after reconnecting, with the duplicate flag set if it is a PUBLISH packet.
+            MqttPacket packet;
+            CompletionHandler completionHandler;
+            EventLoop::Clock::time_point deadline;
+            bool isSent;
+        };
+        
+        const MqttConnectionOptions options;
+        std::shared_ptr<SSL_CTX> tlsContext;
+        EventLoop loop;
+        std::thread loopThread;
+        
+        // MARK: Loop State
+        
+        // These members are only accessed on the loop's thread.
+        State state;
+        StreamConnector connector;
+        std::unique_ptr<StreamTransport> transport;
+        uint32_t descriptorEvents;
+        MqttPacketParser parser;
+        BufferChain outboundChain;
+        bool isFlushScheduled;
+        
+        /// Whether the last write asked for the transport to read first (e.g., for a TLS key update), so that the write is retried after reading.
+        bool isWriteWaitingForRead;
+        bool shouldReconnect;
+        bool hasConnected;
+        std::chrono::milliseconds reconnectInterval;
+        uint16_t lastPacketIdentifier;
+        std::map<uint16_t, PendingAcknowledgement> pendingAcknowledgements;
+        std::vector<CompletionHandler> connectCompletionHandlers;
+        MessageHandler messageHandler;
+        PublishHandler publishHandler;
+        ConnectionHandler connectionHandler;
+        
+        /// Aliases that were sent to the broker on the current network connection, of which there may be at most 'outboundTopicAliasMaximum'.
+        std::map<std::string, uint16_t> outboundTopicAliases;
+        uint16_t outboundTopicAliasMaximum;
+        
+        /// Topic names that the broker assigned aliases to on the current network connection.
+        std::map<uint16_t, std::string> inboundTopicAliases;
+        
+        /// Keep alive interval of the current network connection, which is the broker's if it replaced the client's.
+        std::chrono::seconds keepAliveInterval;
+        
+        /// Largest packet that the broker accepts on the current network connection, or zero if the size is unlimited.
+        size_t outboundMaximumPacketSize;
+        
+        /// Publishes that were sent on the current network connection, and not yet acknowledged, of which there may be at most 'inFlightPublishMaximum'.
+        size_t inFlightPublishCount;
+        size_t inFlightPublishMaximum;
+        
+        /// Packet identifiers of publishes that wait to be sent until fewer are in flight, oldest first.
+        std::deque<uint16_t> waitingPublishIdentifiers;
+        
+        /// Publishes that timed out after they were sent, which are still in flight until the broker acknowledges them, so their identifiers are not reused until then.
+        std::set<uint16_t> expiredPublishIdentifiers;
+        
+        EventLoop::TimerIdentifier connectTimer;
+        EventLoop::TimerIdentifier keepAliveTimer;
+        EventLoop::TimerIdentifier acknowledgementTimer;
+        EventLoop::TimerIdentifier reconnectTimer;
+        EventLoop::Clock::time_point lastOutboundTime;
+        bool isAwaitingPingResponse;
+        
+        std::atomic<bool> isConnectedValue;
+        std::atomic<uint64_t> sentPacketCount;
+        std::atomic<uint64_t> receivedPacketCount;
+        std::atomic<uint64_t> writeCount;
+        std::atomic<uint64_t> reconnectCount;
+        
+        // MARK: Connecting
+        
+        void beginConnecting(void);
+        void finishConnecting(int fd);
+        void continueHandshake(void);
+        void handleConnectAcknowledgement(const MqttPacket &packet);
+        void handleConnectionFailure(MqttStatus status);
+        void completeConnecting(MqttStatus status);
+        void scheduleReconnect(void);
+        
+        /**
+         Closes the transport, and discards anything that was waiting to be written. Pending acknowledgements are kept, so they can be sent again.
+         */
+        void closeTransport(void);
+        
+        // MARK: Transferring
+        
+        void setDescriptorEvents(uint32_t events);
+        void handleDescriptorEvents(uint32_t events);
+        void readAvailable(void);
+        void handlePacket(const MqttPacket &packet);
+        
+        /**
+         Returns the topic name of a received PUBLISH packet, which may have been replaced by its alias. Throws 'MqttProtocolError' if the alias is unknown.
+         */
+        const std::string &resolveTopicName(const MqttPacket &packet);
+        
+        /**
+         Replaces the topic name of the PUBLISH packet with its alias, once an alias has been sent for it, or assigns it an alias if the broker accepts more.
+         */
+        void applyTopicAlias(MqttPacket &packet);
+        
+        /**
+         Appends the packet to the outbound chain, encoded with the connection's protocol level, and schedules the chain to be written once the work currently queued on the loop has run. Returns false, without appending it, if the packet is larger than the broker accepts.
+         */
+        bool enqueuePacket(const MqttPacket &packet);
+        void flush(void);
+        
+        // MARK: Acknowledgements
+        
+        uint16_t nextPacketIdentifier(void);
+        void addPendingAcknowledgement(MqttPacket packet, CompletionHandler completionHandler);
+        void completePendingAcknowledgement(uint16_t packetIdentifier, MqttStatus status);
+        
+        /**
+         Sends the publishes that are waiting, oldest first, until as many are in flight as the broker accepts.
+         */
+        void sendWaitingPublishes(void);
+        void failPendingAcknowledgements(MqttStatus status);
+        void armAcknowledgementTimer(void);
+        void handleAcknowledgementTimeout(void);
+        
+        void scheduleKeepAlive(std::chrono::milliseconds delay);
+        void handleKeepAlive(void);
+        
+        void publishMessages(std::vector<OutboundMessage> &messages);
+    
+    public:
+        explicit MqttConnection(MqttConnectionOptions options);
+        
+        /**
+         Closes the connection, completing every pending operation with 'MqttStatus::Cancelled'.
+         */
+        ~MqttConnection();
+        
+        MqttConnection(const MqttConnection &) = delete;
+        MqttConnection &operator=(const MqttConnection &) = delete;
+        
+        /**
+         Called for every message received on a subscribed topic.
+         */
+        void setMessageHandler(MessageHandler messageHandler);
+        
+        /**
+         Called for every message received on a subscribed topic, with its properties, after the message handler. The payload is not copied for this handler.
+         */
+        void setPublishHandler(PublishHandler publishHandler);
+        
+        void setConnectionHandler(ConnectionHandler connectionHandler);
+        
+        /**
+         Establishes the connection, or completes immediately if it is already established. A failed attempt is not retried; the connection is only re-established automatically once it has been lost.
+         */
+        void connect(CompletionHandler completionHandler);
+        
+        /**
+         Sends a DISCONNECT packet, and closes the connection without re-establishing it.
+         */
+        void disconnect(CompletionHandler completionHandler);
+        
+        /**
+         Sends the topic filters in a single SUBSCRIBE packet. Completes with 'MqttStatus::SubscriptionRefused' if the broker refused any of them.
+         */
+        void subscribe(const std::vector<std::string> &topicFilters, uint8_t qualityOfService, CompletionHandler completionHandler);
+        
+        void unsubscribe(const std::vector<std::string> &topicFilters, CompletionHandler completionHandler);
+        
+        /**
+         Publishes the message. Messages with a quality of service of one complete once acknowledged, and those with zero once queued for writing.
+         */
+        void publish(OutboundMessage message);
+        
+        /**
+         Publishes every message, writing them to the transport at once.
+         */
+        void publish(std::vector<OutboundMessage> messages);
+        
+        bool isConnected(void) const {
+            return isConnectedValue;
+        }
+        
+        MqttConnectionStatistics getStatistics(void) const;
+    };
+}
+
+#endif /* MqttConnection_hpp */
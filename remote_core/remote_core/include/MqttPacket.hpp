@@ -0,0 +1,228 @@
+//
+//  MqttPacket.hpp
+//  remote_core
+//
+//  Created by David Moore on 10/19/26.
+//  Copyright © 2026 David Moore. All rights reserved.
+//
+
+#ifndef MqttPacket_hpp
+#define MqttPacket_hpp
+
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include "BufferChain.hpp"
+
+/// Protocol level of MQTT 3.1.1, as sent in the CONNECT packet.
+#define MQTT_PROTOCOL_LEVEL 4
+
+/// Protocol level of MQTT 5, which adds properties and reason codes to most packets.
+#define MQTT_5_PROTOCOL_LEVEL 5
+
+/// Largest remaining length that can be encoded in the fixed header.
+#define MQTT_MAXIMUM_REMAINING_LENGTH 268435455
+
+/// Largest packet accepted by default, which keeps a misbehaving peer from exhausting memory.
+#define MQTT_DEFAULT_MAXIMUM_PACKET_SIZE (1024 * 1024)
+
+/// CONNACK return code of an accepted connection.
+#define MQTT_CONNECTION_ACCEPTED 0x00
+
+/// SUBACK return code of a refused subscription. With MQTT 5, every reason code from this value upward is a failure.
+#define MQTT_SUBSCRIPTION_FAILURE 0x80
+
+namespace RemoteCore {
+    enum class MqttPacketType : uint8_t {
+        Connect                     = 1,
+        ConnectAcknowledgement      = 2,
+        Publish                     = 3,
+        PublishAcknowledgement      = 4,
+        PublishReceived             = 5,
+        PublishRelease              = 6,
+        PublishComplete             = 7,
+        Subscribe                   = 8,
+        SubscribeAcknowledgement    = 9,
+        Unsubscribe                 = 10,
+        UnsubscribeAcknowledgement  = 11,
+        PingRequest                 = 12,
+        PingResponse                = 13,
+        Disconnect                  = 14
+    };
+    
+    /**
+     Thrown when a peer sends a packet that violates the protocol, after which the connection must be closed.
+     */
+    class MqttProtocolError : public std::runtime_error {
+    public:
+        explicit MqttProtocolError(const std::string &what) : std::runtime_error(what) {}
+    };
+    
+    /**
+     Properties of an MQTT 5 packet. Only the properties that are used are kept, and the others are skipped when decoding. Properties that are zero or empty are not encoded.
+     */
+    struct MqttProperties {
+        // PUBLISH
+        
+        /// Whether the message expires. Without an expiry interval, the message is kept until it is delivered.
+        bool hasMessageExpiryInterval = false;
+        
+        /// Seconds after which the message is discarded if it has not been delivered. Only sent if 'hasMessageExpiryInterval' is set.
+        uint32_t messageExpiryInterval = 0;
+        
+        /// Topic that the receiver publishes its response to.
+        std::string responseTopic;
+        
+        /// Returned with the response, so that the requester can tell which request it answers without decoding the payload.
+        std::string correlationData;
+        
+        /// Stands for the topic name for the rest of the connection, once it has been sent together with it, or zero if no alias is used.
+        uint16_t topicAlias = 0;
+        
+        // CONNECT and CONNACK
+        
+        /// Highest topic alias that the sender accepts, or zero if it does not accept topic aliases.
+        uint16_t topicAliasMaximum = 0;
+        
+        /// Seconds that the session is kept after the connection is closed.
+        uint32_t sessionExpiryInterval = 0;
+        
+        /// Highest number of PUBLISH packets with a quality of service above zero that the sender accepts before acknowledging them, or zero if it did not say, which allows 65535.
+        uint16_t receiveMaximum = 0;
+        
+        /// Largest packet, in bytes, that the sender accepts, or zero if it did not say, which leaves the size unlimited.
+        uint32_t maximumPacketSize = 0;
+        
+        // CONNACK
+        
+        /// Whether the broker replaced the keep alive interval that the client asked for.
+        bool hasServerKeepAlive = false;
+        
+        /// Keep alive interval, in seconds, that the client must use instead of its own, where zero disables keep alive. Only sent if 'hasServerKeepAlive' is set.
+        uint16_t serverKeepAlive = 0;
+        
+        // Acknowledgements and DISCONNECT
+        std::string reasonString;
+        
+        bool isEmpty(void) const {
+            return !hasMessageExpiryInterval && responseTopic.empty() && correlationData.empty() && topicAlias == 0 && topicAliasMaximum == 0 && sessionExpiryInterval == 0 && receiveMaximum == 0 && maximumPacketSize == 0 && !hasServerKeepAlive && reasonString.empty();
+        }
+    };
+    
+    /**
+     An MQTT 3.1.1 or MQTT 5 control packet. Only the fields of the packet's type are meaningful.
+     */
+    struct MqttPacket {
+        MqttPacketType type = MqttPacketType::PingRequest;
+        
+        /// Level the packet is encoded with. A CONNECT packet requests its level for the whole connection.
+        uint8_t protocolLevel = MQTT_PROTOCOL_LEVEL;
+        
+        /// Used by every acknowledged packet, and by PUBLISH packets with a quality of service above zero.
+        uint16_t packetIdentifier = 0;
+        
+        /// Only encoded with MQTT 5.
+        MqttProperties properties;
+        
+        // CONNECT
+        std::string clientID;
+        std::string username;
+        std::string password;
+        uint16_t keepAliveInterval = 0;
+        bool isCleanSession = true;
+        
+        // CONNACK
+        bool isSessionPresent = false;
+        
+        /// Also the reason code of MQTT 5 acknowledgements and DISCONNECT packets, which is omitted when it is zero.
+        uint8_t returnCode = MQTT_CONNECTION_ACCEPTED;
+        
+        // PUBLISH
+        std::string topicName;
+        
+        /// Shared with every packet the payload is forwarded in, rather than copied.
+        SharedBuffer payload;
+        uint8_t qualityOfService = 0;
+        bool isRetained = false;
+        bool isDuplicate = false;
+        
+        // SUBSCRIBE, SUBACK and UNSUBSCRIBE
+        std::vector<std::string> topicFilters;
+        
+        /// Requested for SUBSCRIBE packets; granted, or 'MQTT_SUBSCRIPTION_FAILURE', for SUBACK packets; and the reason code of every topic filter for MQTT 5 UNSUBACK packets.
+        std::vector<uint8_t> qualityOfServices;
+        
+        static MqttPacket connect(const std::string &clientID, uint16_t keepAliveInterval, bool isCleanSession);
+        static MqttPacket connectAcknowledgement(bool isSessionPresent, uint8_t returnCode);
+        static MqttPacket publish(const std::string &topicName, SharedBuffer payload, uint8_t qualityOfService, uint16_t packetIdentifier);
+        static MqttPacket subscribe(uint16_t packetIdentifier, const std::vector<std::string> &topicFilters, uint8_t qualityOfService);
+        static MqttPacket unsubscribe(uint16_t packetIdentifier, const std::vector<std::string> &topicFilters);
+        
+        /**
+         Creates a packet with no fields other than its packet identifier (e.g., PUBACK or UNSUBACK), or with no fields at all (e.g., PINGREQ).
+         */
+        static MqttPacket withType(MqttPacketType type, uint16_t packetIdentifier = 0);
+        
+        /**
+         Returns the size of the encoded packet, including its fixed header, without encoding it.
+         */
+        size_t encodedLength(void) const;
+        
+        /**
+         Appends the encoded packet to the buffer, so that several packets can be written at once. Throws 'std::length_error' if the packet is too large to encode.
+         */
+        void encode(std::string &buffer) const;
+        
+        /**
+         Appends the encoded packet to the chain, which shares the payload of a PUBLISH packet rather than copying it. Throws 'std::length_error' if the packet is too large to encode.
+         */
+        void encode(BufferChain &chain) const;
+    
+    private:
+        /**
+         Appends everything but the payload of a PUBLISH packet, which is the whole of any other packet.
+         */
+        void encodeWithoutPayload(std::string &buffer) const;
+    };
+    
+    /**
+     Incrementally decodes packets from a byte stream, regardless of how the stream is split into reads.
+     */
+    class MqttPacketParser {
+        std::string buffer;
+        size_t offset;
+        size_t maximumPacketSize;
+        uint8_t protocolLevel;
+        
+        static MqttPacket decode(uint8_t header, const char *bytes, size_t length, uint8_t protocolLevel);
+    
+    public:
+        explicit MqttPacketParser(size_t maximumPacketSize = MQTT_DEFAULT_MAXIMUM_PACKET_SIZE);
+        
+        void append(const char *bytes, size_t length);
+        
+        /**
+         Sets the level that every packet but CONNECT, which states its own level, is decoded with. Defaults to 'MQTT_PROTOCOL_LEVEL'.
+         */
+        void setProtocolLevel(uint8_t protocolLevel) {
+            this->protocolLevel = protocolLevel;
+        }
+        
+        /**
+         Decodes the next complete packet. Returns false if more bytes are needed, and throws 'MqttProtocolError' if the stream is malformed.
+         */
+        bool nextPacket(MqttPacket &packet);
+        
+        /**
+         Discards any partially received packet, such as when the connection is replaced.
+         */
+        void reset(void);
+        
+        size_t getBufferedSize(void) const {
+            return buffer.size() - offset;
+        }
+    };
+}
+
+#endif /* MqttPacket_hpp */
@@ -0,0 +1,98 @@
+//
+//  MulticastDNSAdvertiser.hpp
+//  remote_core
+//
+//  Created by David Moore on 10/19/26.
+//  Copyright © 2026 David Moore. All rights reserved.
+//
+
+#ifndef MulticastDNSAdvertiser_hpp
+#define MulticastDNSAdvertiser_hpp
+
+#include <cstdint>
+#include <map>
+#include <string>
+#include <thread>
+#include <vector>
+#include <netinet/in.h>
+#include "EventLoop.hpp"
+
+/// Port that multicast DNS is queried and answered on.
+#define MULTICAST_DNS_PORT 5353
+
+/// Group that multicast DNS queries and responses are sent to.
+#define MULTICAST_DNS_GROUP "224.0.0.251"
+
+namespace RemoteCore {
+    /**
+     Service that is advertised with DNS service discovery, i.e., as '<instance name>.<service type>.local' on '<host name>.local'.
+     */
+    struct ServiceDescription {
+        /// Name that is shown to people, which may contain spaces and dots (e.g., 'Remote Core LE2RDNFR44').
+        std::string instanceName;
+        
+        /// Protocol and transport, e.g., '_remote-core._tcp'.
+        std::string serviceType;
+        
+        /// Name of the host, without the '.local' domain.
+        std::string hostName;
+        
+        uint16_t port = 0;
+        
+        /// Keys and values of the TXT record.
+        std::map<std::string, std::string> attributes;
+    };
+    
+    /**
+     Responder that advertises a single service with multicast DNS, so that phones on the local network can discover the device without a DNS server. The service is announced when the advertiser starts, and withdrawn when it is destroyed.
+     
+     Names are not probed for conflicts, and every answer is sent, even those the querier already knows. Queries from a port other than 5353 (i.e., one-shot queries) are answered directly, as RFC 6762 requires.
+     */
+    class MulticastDNSAdvertiser {
+        ServiceDescription service;
+        
+        // Labels of each name the service answers to, and their presentation form, which questions are compared with.
+        std::vector<std::string> serviceLabels;
+        std::vector<std::string> instanceLabels;
+        std::vector<std::string> hostLabels;
+        std::string serviceName;
+        std::string instanceName;
+        std::string hostName;
+        
+        EventLoop loop;
+        std::thread loopThread;
+        int fd;
+        uint16_t port;
+        
+        void handleQueries(void);
+        void handleQuery(const uint8_t *bytes, size_t length, const struct sockaddr_in &sender);
+        void announce(bool isGoodbye);
+        
+        /**
+         Returns the response that answers with the records, or an empty string if there are none. The questions of one-shot queries are repeated in the response.
+         */
+        std::string makeResponse(uint16_t identifier, uint32_t answerRecords, uint32_t additionalRecords, bool isOneShot, const std::string &questions, uint16_t questionCount, bool isGoodbye) const;
+        
+        void send(const std::string &response, const struct sockaddr_in &address);
+    
+    public:
+        /**
+         Starts answering queries for the service on the port, or on an ephemeral port if the port is zero. Throws 'std::system_error' if the socket cannot be created or bound. Failing to join the multicast group is not an error, although only one-shot queries are answered until the device has a route for multicast.
+         */
+        explicit MulticastDNSAdvertiser(const ServiceDescription &service, uint16_t port = MULTICAST_DNS_PORT);
+        ~MulticastDNSAdvertiser();
+        
+        MulticastDNSAdvertiser(const MulticastDNSAdvertiser &) = delete;
+        MulticastDNSAdvertiser &operator=(const MulticastDNSAdvertiser &) = delete;
+        
+        uint16_t getPort(void) const {
+            return port;
+        }
+        
+        const ServiceDescription &getService(void) const {
+            return service;
+        }
+    };
+}
+
+#endif /* MulticastDNSAdvertiser_hpp */
@@ -27,7 +27,6 @@
 #else
 #include <fcntl.h>
 #include <errno.h>
-#include <sys/select.h>
 #include <arpa/inet.h>
 #include <netinet/in.h>
 #include <netdb.h>
@@ -36,7 +35,9 @@
 #endif
 
 #include <atomic>
-#include <condition_variable>
+#include <chrono>
+#include <memory>
+#include <mutex>
 #include <openssl/ssl.h>
 #include <openssl/conf.h>
 #include <openssl/err.h>
@@ -46,8 +47,11 @@
 #include <openssl/x509_vfy.h>
 #include <string.h>
 
+#include "BufferedTlsStream.hpp"
 #include "NetworkConnection.hpp"
 #include "ResponseCode.hpp"
+#include "TlsCipherPolicy.hpp"
+#include "TlsSessionCache.hpp"
 
 namespace awsiotsdk {
     namespace network {
@@ -91,9 +95,9 @@ namespace awsiotsdk {
             util::String device_private_key_location_;  ///< Pointer to string containing the filename (including path) of the device private key file.
             bool server_verification_flag_;             ///< Boolean.  True = perform server certificate hostname validation.  False = skip validation \b NOT recommended.
             std::atomic_bool is_connected_;             ///< Boolean indicating connection status
-            struct timeval tls_handshake_timeout_;      ///< Timeout for TLS handshake command
-            struct timeval tls_read_timeout_;           ///< Timeout for the TLS Read command
-            struct timeval tls_write_timeout_;          ///< Timeout for the TLS Write command
+            std::chrono::milliseconds tls_handshake_timeout_;   ///< Timeout for TLS handshake command
+            std::chrono::milliseconds tls_read_timeout_;        ///< Timeout for the TLS Read command, and for the shutdown
+            std::chrono::milliseconds tls_write_timeout_;       ///< Timeout for the TLS Write command
 
             // Endpoint information
             uint16_t endpoint_port_;                    ///< Endpoint port
@@ -106,18 +110,15 @@ namespace awsiotsdk {
             bool certificates_read_flag_;
             bool enable_alpn_;
 
-            std::mutex clean_shutdown_action_lock_;
-            std::condition_variable shutdown_timeout_condition_;
+            std::shared_ptr<RemoteCore::TlsSessionCache> session_cache_;    ///< Sessions resumed on reconnect, if not null
+            bool kernel_tls_enabled_;                   ///< Records are handed to the kernel after the handshake, if supported
+            RemoteCore::TlsCipherPolicy cipher_policy_; ///< Cipher suites and groups offered in the handshake
 
-            /**
-             * @brief Wait for socket FDs to become ready for read or write operations
-             *
-             * It is assumed that this function will be called only on SSL_ERROR_WANT_READ or SSL_ERROR_WANT_WRITE
-             *
-             * @param error_code - error generated by preceding socket operation
-             * @return int - return code of the select operation
-             */
-            int WaitForSelect(int error_code);
+            /// Performs the handshake, reads and writes, with a read-ahead buffer and epoll readiness. Exists from the
+            /// time the socket is connected until the connection is closed.
+            std::unique_ptr<RemoteCore::BufferedTlsStream> stream_;
+
+            std::mutex clean_shutdown_action_lock_;
 
             /**
              * @brief Set TLS socket to non-blocking mode
@@ -129,7 +130,8 @@ namespace awsiotsdk {
             /**
              * @brief Create a TCP socket and open the connection
              *
-             * Creates an open socket connection
+             * Resolves the endpoint without the blocking resolver, and connects to whichever of its IPv6 and IPv4
+             * addresses responds first, within the TLS handshake timeout
              *
              * @return ResponseCode - successful connection or TCP error
              */
@@ -183,6 +185,10 @@ namespace awsiotsdk {
             /**
              * @brief Read bytes from the network socket
              *
+             * Small reads, like those for packet headers, are served from the read-ahead buffer. A read that times out
+             * after some bytes have arrived is reported as an error, since the rest of the packet would otherwise be
+             * taken for the start of the next one
+             *
              * @param util::String - reference to buffer where read bytes should be copied
              * @param size_t - number of bytes to read
              * @param size_t - reference to store number of bytes read
@@ -270,6 +276,41 @@ namespace awsiotsdk {
                 endpoint_port_ = endpoint_port;
             }
 
+            /**
+             * @brief sets the cache of TLS sessions
+             *
+             * Called before connecting, so that reconnects resume the previous session with the endpoint instead of performing a full handshake.
+             *
+             * @param session_cache - may be shared by several connections, or null to always perform a full handshake
+             */
+            void SetSessionCache(std::shared_ptr<RemoteCore::TlsSessionCache> session_cache) {
+                session_cache_ = session_cache;
+            }
+
+            /**
+             * @brief enables kernel TLS offload
+             *
+             * Called before connecting. Once the handshake finishes, records are encrypted and decrypted by the kernel if it
+             * supports the negotiated cipher, and by OpenSSL otherwise.
+             *
+             * @param enabled - whether the keys are handed to the kernel
+             */
+            void SetKernelTlsEnabled(bool enabled) {
+                kernel_tls_enabled_ = enabled;
+            }
+
+            /**
+             * @brief sets the cipher suites and groups offered
+             *
+             * Called before Initialize. Defaults to RemoteCore::TlsCipherPolicy::getPreferred, which prefers
+             * ChaCha20-Poly1305 when the processor lacks AES instructions.
+             *
+             * @param cipher_policy - lists in OpenSSL's syntax, where an empty list keeps OpenSSL's default
+             */
+            void SetCipherPolicy(const RemoteCore::TlsCipherPolicy &cipher_policy) {
+                cipher_policy_ = cipher_policy;
+            }
+
             /**
              * @brief Check if TLS layer is still connected
              *
@@ -0,0 +1,128 @@
+//
+//  OutboxPublisher.hpp
+//  remote_core
+//
+//  Created by David Moore on 10/19/26.
+//  Copyright © 2026 David Moore. All rights reserved.
+//
+
+#ifndef OutboxPublisher_hpp
+#define OutboxPublisher_hpp
+
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include "BufferChain.hpp"
+#include "DispatchQueue.hpp"
+#include "MessageOutbox.hpp"
+
+namespace RemoteCore {
+    /**
+     Publishes outgoing messages in order, keeping each one in a 'MessageOutbox' until it has been published, so that messages survive losing the connection, or restarting.
+     
+     While connected, and once the outbox has been replayed, a message is published straight from the buffer it was encoded into; the outbox is only written, never read. Messages are read back from the outbox, and published again, only after a publish failed, after reconnecting, or after restarting with messages left in the outbox.
+     
+     Every method may be called from any thread.
+     */
+    class OutboxPublisher {
+    public:
+        typedef std::function<void (bool didSucceed)> CompletionHandler;
+        
+        /**
+         Publishes the payload to the topic, and calls the completion handler, from any thread, once it has been published or has failed.
+         */
+        typedef std::function<void (SharedBuffer payload, const std::string &topicName, CompletionHandler completionHandler)> PublishFunction;
+    
+    private:
+        enum class PublishState {
+            Pending,
+            Succeeded,
+            Failed
+        };
+        
+        struct LivePublish {
+            uint64_t endOffset;
+            PublishState state;
+        };
+        
+        /**
+         Shared with the completion handlers given to the publish function, which may be called after the publisher has been destroyed.
+         */
+        struct Liveness {
+            std::mutex mutex;
+            bool isAlive = true;
+        };
+        
+        std::unique_ptr<MessageOutbox> outbox;
+        PublishFunction publishFunction;
+        std::shared_ptr<Liveness> liveness;
+        const size_t replayBatchSize;
+        const std::chrono::milliseconds retryInterval;
+        
+        /// Keeps the order of the messages in the outbox and on 'queue' the same.
+        std::mutex appendMutex;
+        
+        // The remaining state is only used on 'queue'.
+        bool isConnected;
+        
+        /// Whether messages in the outbox may not have been published, so that new messages must wait for them to be replayed.
+        bool needsReplay;
+        bool isReplaying;
+        
+        /// End offset of the last message replayed, so that a message which was replayed before it was handled is not published twice.
+        uint64_t replayedEndOffset;
+        
+        /// Messages published from their buffers, oldest first, which are removed from the outbox once they, and every message before them, have succeeded.
+        std::deque<LivePublish> livePublishes;
+        
+        /// Declared last, so that it is drained before the rest of the publisher is destroyed.
+        std::unique_ptr<DispatchQueue> queue;
+        
+        void handlePublish(const std::string &topicName, SharedBuffer payload, bool isDurable, uint64_t endOffset);
+        void completeLivePublish(uint64_t endOffset, bool didSucceed);
+        
+        /**
+         Starts replaying the outbox, if it needs to be replayed, once no live publish is pending.
+         */
+        void replayIfNeeded(void);
+        
+        /**
+         Publishes the oldest messages in the outbox, at most 'replayBatchSize' at a time, and removes them once every message in the batch has been published. A batch that fails is published again after 'retryInterval'.
+         */
+        void replayBatch(void);
+    
+    public:
+        /**
+         Creates a publisher that keeps messages in the outbox, and publishes them with the function. The publisher starts out disconnected.
+         */
+        OutboxPublisher(std::unique_ptr<MessageOutbox> outbox, PublishFunction publishFunction, size_t replayBatchSize, std::chrono::milliseconds retryInterval);
+        
+        /**
+         Detaches the publisher from the completion handlers that have not been called yet, so that they are ignored. Their messages are still in the outbox.
+         */
+        ~OutboxPublisher();
+        
+        OutboxPublisher(const OutboxPublisher &) = delete;
+        OutboxPublisher &operator=(const OutboxPublisher &) = delete;
+        
+        /**
+         Appends the message to the outbox, and publishes it. A message that is too large for the outbox is published without being kept.
+         */
+        void publish(const std::string &topicName, SharedBuffer payload);
+        
+        /**
+         Called whenever the connection is established or lost. Establishing the connection replays the outbox.
+         */
+        void setConnected(bool isConnected);
+        
+        MessageOutbox &getOutbox(void) {
+            return *outbox;
+        }
+    };
+}
+
+#endif /* OutboxPublisher_hpp */
@@ -0,0 +1,167 @@
+//
+//  PublishPipeline.hpp
+//  remote_core
+//
+//  Created by David Moore on 10/19/26.
+//  Copyright © 2026 David Moore. All rights reserved.
+//
+
+#ifndef PublishPipeline_hpp
+#define PublishPipeline_hpp
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+namespace RemoteCore {
+    /**
+     Snapshot of the counters of a publish pipeline.
+     */
+    struct PublishPipelineStatistics {
+        /// Messages that have been sent, but not acknowledged yet.
+        size_t inFlightCount = 0;
+        
+        /// Messages waiting for room in the window.
+        size_t backlogCount = 0;
+        
+        uint64_t submittedCount = 0;
+        uint64_t completedCount = 0;
+        
+        /// Messages that were refused because the backlog was full.
+        uint64_t rejectedCount = 0;
+        
+        /// Number of times the sender was called; fewer batches than messages means writes were coalesced.
+        uint64_t batchCount = 0;
+    };
+    
+    /**
+     Bounded outbound pipeline: at most 'windowSize' messages are in flight (i.e., sent and not yet acknowledged), and at most 'backlogCapacity' messages wait behind them. Once both are full, 'submit' refuses messages rather than letting a lower layer drop them silently.
+     
+     Messages are handed to the sender in batches, on one thread at a time and in submission order. Messages submitted while a batch is being sent are coalesced into the next batch, so that a sender that can write a batch at once does so in a single write.
+     */
+    template <typename Message>
+    class PublishPipeline {
+    public:
+        typedef std::function<void (std::vector<Message> batch)> Sender;
+    
+    private:
+        std::mutex mutex;
+        std::condition_variable capacityCondition;
+        std::deque<Message> backlog;
+        size_t windowSize;
+        size_t backlogCapacity;
+        bool isSending;
+        PublishPipelineStatistics statistics;
+        Sender sender;
+        
+        /**
+         Sends batches until the window or the backlog is exhausted, unless another thread is already doing so.
+         */
+        void drain(std::unique_lock<std::mutex> &lock) {
+            if (isSending) {
+                return;
+            }
+            
+            isSending = true;
+            while (!backlog.empty() && statistics.inFlightCount < windowSize) {
+                std::vector<Message> batch;
+                while (!backlog.empty() && statistics.inFlightCount < windowSize) {
+                    batch.push_back(std::move(backlog.front()));
+                    backlog.pop_front();
+                    statistics.inFlightCount++;
+                }
+                
+                statistics.backlogCount = backlog.size();
+                statistics.batchCount++;
+                capacityCondition.notify_all();
+                
+                // The sender may complete messages synchronously, which re-enters the pipeline.
+                lock.unlock();
+                try {
+                    sender(std::move(batch));
+                } catch (...) {
+                    lock.lock();
+                    isSending = false;
+                    throw;
+                }
+                lock.lock();
+            }
+            
+            isSending = false;
+        }
+    
+    public:
+        PublishPipeline(size_t windowSize, size_t backlogCapacity, Sender sender) : windowSize(windowSize), backlogCapacity(backlogCapacity), isSending(false), sender(std::move(sender)) {
+            if (windowSize == 0) {
+                throw std::logic_error("Expected 'windowSize' to be greater than zero.");
+            }
+        }
+        
+        PublishPipeline(const PublishPipeline &) = delete;
+        PublishPipeline &operator=(const PublishPipeline &) = delete;
+        
+        /**
+         Queues the message to be sent once there is room in the window. Returns false, without taking the message, if the backlog is full.
+         */
+        bool submit(Message &message) {
+            std::unique_lock<std::mutex> lock(mutex);
+            if (backlog.size() >= backlogCapacity && statistics.inFlightCount >= windowSize) {
+                statistics.rejectedCount++;
+                return false;
+            }
+            
+            backlog.push_back(std::move(message));
+            statistics.backlogCount = backlog.size();
+            statistics.submittedCount++;
+            drain(lock);
+            
+            return true;
+        }
+        
+        /**
+         Releases the window slots of messages that were acknowledged, or that failed to send, and sends any waiting messages.
+         */
+        void complete(size_t count = 1) {
+            std::unique_lock<std::mutex> lock(mutex);
+            if (count > statistics.inFlightCount) {
+                throw std::logic_error("Expected 'complete' to be balanced with sent messages.");
+            }
+            
+            statistics.inFlightCount -= count;
+            statistics.completedCount += count;
+            capacityCondition.notify_all();
+            drain(lock);
+        }
+        
+        /**
+         Blocks the current thread until a message can be submitted without being refused, or the timeout elapses. Returns false if the timeout elapsed first. Producers that are able to block use this to slow down, rather than having messages refused.
+         */
+        bool waitForCapacity(std::chrono::milliseconds timeout) {
+            std::unique_lock<std::mutex> lock(mutex);
+            return capacityCondition.wait_for(lock, timeout, [this]() {
+                return backlog.size() < backlogCapacity || statistics.inFlightCount < windowSize;
+            });
+        }
+        
+        size_t getWindowSize(void) const {
+            return windowSize;
+        }
+        
+        size_t getBacklogCapacity(void) const {
+            return backlogCapacity;
+        }
+        
+        PublishPipelineStatistics getStatistics(void) {
+            std::lock_guard<std::mutex> lock(mutex);
+            return statistics;
+        }
+    };
+}
+
+#endif /* PublishPipeline_hpp */
@@ -0,0 +1,94 @@
+//
+//  PulseStream.hpp
+//  remote_core
+//
+//  Created by David Moore on 10/19/26.
+//  Copyright © 2026 David Moore. All rights reserved.
+//
+
+#ifndef PulseStream_hpp
+#define PulseStream_hpp
+
+#include <chrono>
+#include <iostream>
+#include <memory>
+#include <string>
+
+#define PULSE_STREAM_DEFAULT_DEVICE_PATH "/dev/lirc0"
+
+namespace RemoteCore {
+    /**
+     A single mark (pulse) or gap (space) in an infrared signal, measured in microseconds.
+     */
+    struct PulseSample {
+        enum class Type {
+            Pulse,
+            Space,
+            Timeout
+        };
+        
+        Type type;
+        unsigned int duration;
+        
+        PulseSample(Type type = Type::Space, unsigned int duration = 0) : type(type), duration(duration) {};
+        
+        bool isPulse(void) const {
+            return type == Type::Pulse;
+        }
+    };
+    
+    /**
+     Sequential reader for a mode2-style pulse stream. Streams are backed by either a LIRC receiver device (binary mode2 samples) or a recorded capture in the textual format produced by `mode2` (e.g., "pulse 9024", "space 4512").
+     */
+    class PulseStream {
+    public:
+        enum class ReadResult {
+            Success,
+            TimedOut,
+            EndOfStream,
+            Failure
+        };
+    
+    private:
+        std::unique_ptr<std::istream> captureStream;
+        int deviceFileDescriptor;
+        
+        ReadResult readCaptureSample(PulseSample &sample);
+        ReadResult readDeviceSample(PulseSample &sample, std::chrono::milliseconds timeout);
+    
+    public:
+        /**
+         Creates a stream that parses a recorded capture in the textual mode2 format.
+         */
+        PulseStream(std::unique_ptr<std::istream> captureStream);
+        
+        /**
+         Creates a stream that reads binary mode2 samples from an open LIRC device. The receiver takes ownership of the file descriptor.
+         */
+        PulseStream(int deviceFileDescriptor);
+        
+        ~PulseStream();
+        
+        PulseStream(const PulseStream &) = delete;
+        PulseStream &operator=(const PulseStream &) = delete;
+        
+        /**
+         Opens a pulse stream for the provided path. Character devices are opened as LIRC receivers in mode2, while any other file is treated as a recorded capture.
+         
+         @param path Path of a receiver device (e.g., '/dev/lirc0') or a capture file.
+         @return A pulse stream, or nullptr if the path could not be opened.
+         */
+        static std::unique_ptr<PulseStream> openPath(const std::string &path);
+        
+        /**
+         Reads the next sample from the stream.
+         
+         @param sample Updated with the sample that was read when the result is 'ReadResult::Success'.
+         @param timeout Maximum amount of time to wait for a sample to arrive. Recorded captures never wait.
+         @return Result indicating if a sample was read.
+         */
+        ReadResult readSample(PulseSample &sample, std::chrono::milliseconds timeout);
+    };
+}
+
+#endif /* PulseStream_hpp */
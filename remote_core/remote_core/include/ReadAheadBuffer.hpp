@@ -0,0 +1,100 @@
+//
+//  ReadAheadBuffer.hpp
+//  remote_core
+//
+//  Created by David Moore on 10/19/26.
+//  Copyright © 2026 David Moore. All rights reserved.
+//
+
+#ifndef ReadAheadBuffer_hpp
+#define ReadAheadBuffer_hpp
+
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+/// Room for two TLS records of the largest size (16 KiB of plaintext each).
+#define READ_AHEAD_BUFFER_CAPACITY (32 * 1024)
+
+/// Blocks kept by a pool for reuse; any others are freed when they are returned.
+#define READ_AHEAD_BUFFER_POOL_DEFAULT_MAXIMUM_BLOCK_COUNT 16
+
+namespace RemoteCore {
+    /**
+     Free list of the blocks used by 'ReadAheadBuffer', so that reconnecting does not allocate them again. Every method may be called from any thread.
+     */
+    class ReadAheadBufferPool {
+        std::mutex mutex;
+        std::vector<std::unique_ptr<char[]>> blocks;
+        const size_t maximumBlockCount;
+    
+    public:
+        explicit ReadAheadBufferPool(size_t maximumBlockCount = READ_AHEAD_BUFFER_POOL_DEFAULT_MAXIMUM_BLOCK_COUNT);
+        
+        ReadAheadBufferPool(const ReadAheadBufferPool &) = delete;
+        ReadAheadBufferPool &operator=(const ReadAheadBufferPool &) = delete;
+        
+        /**
+         Pool that is shared by every connection.
+         */
+        static ReadAheadBufferPool *sharedPool(void);
+        
+        /**
+         Returns a block of 'READ_AHEAD_BUFFER_CAPACITY' bytes, which is allocated if the pool is empty.
+         */
+        std::unique_ptr<char[]> takeBlock(void);
+        void returnBlock(std::unique_ptr<char[]> block);
+        
+        size_t getFreeBlockCount(void);
+    };
+    
+    /**
+     Ring buffer that bytes are read ahead into, in large spans, so that small reads can be served without a system call. The block is taken from the pool when bytes are first read into the buffer, and returned by 'release'.
+     
+     Not thread safe.
+     */
+    class ReadAheadBuffer {
+        ReadAheadBufferPool *pool;
+        std::unique_ptr<char[]> block;
+        size_t start;
+        size_t byteCount;
+    
+    public:
+        explicit ReadAheadBuffer(ReadAheadBufferPool *pool = ReadAheadBufferPool::sharedPool());
+        ~ReadAheadBuffer();
+        
+        ReadAheadBuffer(const ReadAheadBuffer &) = delete;
+        ReadAheadBuffer &operator=(const ReadAheadBuffer &) = delete;
+        
+        size_t getByteCount(void) const {
+            return byteCount;
+        }
+        
+        bool isEmpty(void) const {
+            return byteCount == 0;
+        }
+        
+        /**
+         Moves up to 'length' buffered bytes into 'bytes', and returns the number moved.
+         */
+        size_t read(char *bytes, size_t length);
+        
+        /**
+         Returns the largest contiguous span of free space, for bytes to be read into before calling 'commit'. The span is empty if the buffer is full.
+         */
+        char *getFreeSpace(size_t &length);
+        
+        /**
+         Appends 'length' bytes that were read into the free space.
+         */
+        void commit(size_t length);
+        
+        /**
+         Discards the buffered bytes, and returns the block to the pool.
+         */
+        void release(void);
+    };
+}
+
+#endif /* ReadAheadBuffer_hpp */
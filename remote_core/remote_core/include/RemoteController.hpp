@@ -11,7 +11,11 @@
 
 #include "ConnectionManager.hpp"
 #include "HardwareController.hpp"
+#include "LocalEndpoint.hpp"
+#include "MetricsExporter.hpp"
 #include "Message.hpp"
+#include "OutboxPublisher.hpp"
+#include "DirectiveCatalog.hpp"
 
 namespace RemoteCore {
     /// The base class for remote_core that should be used for remote-related functionality.
@@ -20,15 +24,31 @@ namespace RemoteCore {
         std::string userID;
         
     protected:
+        // Runs the completion of asynchronous requests, and is declared first so that it outlives everything that may still complete.
+        std::unique_ptr<DispatchQueue> queue;
         std::unique_ptr<ConnectionManager> connectionManager;
         std::unique_ptr<HardwareController> hardwareController;
         std::shared_ptr<TrainingSession> trainingSession;
+        
+        /// Keeps outgoing messages until they have been published, so that they survive losing the connection, or restarting. Null if no outbox is configured.
+        std::unique_ptr<OutboxPublisher> outboxPublisher;
+        
+        /// Lets phones on the same network exchange messages with the device directly, while the controller is started. Null if no port is configured for it, or it could not be started. Accessed atomically, since messages may be sent while the controller stops.
+        std::shared_ptr<LocalEndpoint> localEndpoint;
+        
+        /// Exports the shared metrics every 'metrics_export_interval_secs' while the controller is started, publishing them to '<device topic>/stats' as well if 'metrics_publishes_stats' is enabled. Null if the interval is zero. Declared after the connection manager, so that it is destroyed first.
+        std::unique_ptr<MetricsExporter> metricsExporter;
     
         /**
          Subscribes to the default device topic. The topic format is 'remote_core/account/<user id>/<serial number>'.
          */
         void subscribeToDefaultTopic(void);
         
+        /**
+         Starts the local endpoint, and advertises it, if 'local_endpoint_port' is configured. Messages that phones publish to it are handled on the controller's queue, as if they had arrived through the cloud.
+         */
+        void startLocalEndpoint(void);
+        
         /**
          Handles the message that was received.
          */
@@ -50,7 +70,7 @@ namespace RemoteCore {
         void handleResponseMessage(std::unique_ptr<Message> message);
         
         /**
-         Attempts to send a message on the default topic.
+         Attempts to send a message on the default topic, or on its response topic if it is a response to a message received with MQTT 5.
 
          @param message The message that will be sent.
          */
@@ -63,7 +83,7 @@ namespace RemoteCore {
          @param command Command that is associated with the message.
          @param directive Directive to be sent with the message.
          */
-        void sendTrainingMessageForSession(TrainingSession *session, Command *command, std::string directive);
+        void sendTrainingMessageForSession(TrainingSession *session, Command *command, Directive directive);
         
     public:
         RemoteController(const std::string &configFileRelativePath);
@@ -88,6 +108,9 @@ namespace RemoteCore {
         void trainingSessionWillLearnCommand(TrainingSession *session, Command command) override;
         void trainingSessionDidLearnCommand(TrainingSession *session, Command command) override;
         
+        // The remote was identified, so the message carries the complete remote.
+        void trainingSessionDidIdentifyRemote(TrainingSession *session, Remote remote) override;
+        
         // Inclusive arbitrary input indicates all buttons should be pressed – in no specific order (i.e., arbitrary).
         void trainingSessionDidRequestInclusiveArbitraryInput(TrainingSession *session) override;
         
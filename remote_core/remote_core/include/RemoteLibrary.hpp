@@ -0,0 +1,121 @@
+//
+//  RemoteLibrary.hpp
+//  remote_core
+//
+//  Created by David Moore on 10/19/26.
+//  Copyright © 2026 David Moore. All rights reserved.
+//
+
+#ifndef RemoteLibrary_hpp
+#define RemoteLibrary_hpp
+
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "LearningEngine.hpp"
+
+namespace RemoteCore {
+    /**
+     A single button of a known remote.
+     */
+    struct RemoteButton {
+        std::string name;
+        
+        /// Complete code, including any pre- and post-data. Unused by raw remotes.
+        uint64_t code = 0;
+        
+        /// Timings of the button. Only present for raw remotes.
+        PulseFrame rawFrame;
+    };
+    
+    /**
+     A remote described by a lircd.conf file. Timings are normalized so that 'one' always carries the longer duration, matching the codes produced by the learning engine.
+     */
+    struct RemoteCodebook {
+        std::string name;
+        PulseProtocol protocol = PulseProtocol::Raw;
+        PulsePair header;
+        PulsePair one;
+        PulsePair zero;
+        unsigned int trailingPulse = 0;
+        unsigned int gap = 0;
+        unsigned int bitCount = 0;
+        
+        /// Bits that change between presses of the same button (e.g., the RC5 toggle bit).
+        uint64_t toggleBitMask = 0;
+        
+        std::vector<RemoteButton> buttons;
+        
+        /**
+         Describes a button as if it had been learnt, including its raw timings.
+         */
+        LearnedCode learnedCodeForButton(const RemoteButton &button) const;
+    };
+    
+    /**
+     A codebook that contains a button matching a learnt code.
+     */
+    struct RemoteMatch {
+        size_t codebookIndex = 0;
+        size_t buttonIndex = 0;
+        
+        /// Similarity of the timings, between 0 and 1 (identical).
+        double score = 0.0;
+    };
+    
+    /**
+     Index over a library of lircd.conf codebooks, allowing a remote to be identified from a single button press.
+     
+     Encoded buttons are indexed by a hash of their protocol, length and code, and raw buttons are bucketed by the number of durations, so identification only compares timings for a handful of candidates regardless of the size of the library.
+     */
+    class RemoteLibrary {
+    private:
+        double tolerance;
+        std::vector<RemoteCodebook> codebooks;
+        std::unordered_multimap<uint64_t, std::pair<size_t, size_t>> codeIndex;
+        std::unordered_map<size_t, std::vector<std::pair<size_t, size_t>>> rawCodeIndex;
+        
+        void addCodebook(RemoteCodebook codebook);
+        double timingScore(const LearnedCode &code, const RemoteCodebook &codebook) const;
+        double rawFrameScore(const PulseFrame &frame, const PulseFrame &otherFrame) const;
+    
+    public:
+        RemoteLibrary(double tolerance = LearningConfiguration().tolerance);
+        
+        /**
+         Loads every lircd.conf file within a directory (recursively).
+         
+         @param path Path of the directory.
+         @return Number of codebooks that were loaded.
+         */
+        size_t loadDirectory(const std::string &path);
+        
+        /**
+         Loads every remote that is defined within a lircd.conf stream. Remotes using an unsupported encoding are skipped.
+         
+         @return Number of codebooks that were loaded.
+         */
+        size_t loadConfiguration(std::istream &stream);
+        
+        size_t getCodebookCount(void) const {
+            return codebooks.size();
+        }
+        
+        const RemoteCodebook &getCodebook(size_t index) const {
+            return codebooks.at(index);
+        }
+        
+        /**
+         Finds the codebooks that contain a button matching the code.
+         
+         @param code Code that was learnt from a single button press.
+         @param maximumCount Maximum number of matches to return.
+         @return Matches ordered from the most to least similar, with at most one match per codebook.
+         */
+        std::vector<RemoteMatch> identifyCode(const LearnedCode &code, size_t maximumCount = 5) const;
+    };
+}
+
+#endif /* RemoteLibrary_hpp */
@@ -0,0 +1,43 @@
+//
+//  SocketAddress.hpp
+//  remote_core
+//
+//  Created by David Moore on 10/19/26.
+//  Copyright © 2026 David Moore. All rights reserved.
+//
+
+#ifndef SocketAddress_hpp
+#define SocketAddress_hpp
+
+#include <cstdint>
+#include <string>
+#include <sys/socket.h>
+
+namespace RemoteCore {
+    /**
+     IPv4 or IPv6 address and port.
+     */
+    struct SocketAddress {
+        struct sockaddr_storage storage = {};
+        socklen_t length = 0;
+        
+        int getFamily(void) const {
+            return storage.ss_family;
+        }
+        
+        uint16_t getPort(void) const;
+        void setPort(uint16_t port);
+        
+        /**
+         Returns the numeric form of the address, e.g., '192.0.2.1' or '2001:db8::1'.
+         */
+        std::string getDescription(void) const;
+        
+        /**
+         Parses a numeric IPv4 or IPv6 address, and returns false if the string is not one.
+         */
+        static bool parse(const std::string &string, uint16_t port, SocketAddress &address);
+    };
+}
+
+#endif /* SocketAddress_hpp */
@@ -0,0 +1,103 @@
+//
+//  StreamConnector.hpp
+//  remote_core
+//
+//  Created by David Moore on 10/19/26.
+//  Copyright © 2026 David Moore. All rights reserved.
+//
+
+#ifndef StreamConnector_hpp
+#define StreamConnector_hpp
+
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+#include "EventLoop.hpp"
+#include "HostResolver.hpp"
+
+/// Time to wait for an attempt before also trying the next address, as recommended by RFC 8305.
+#define STREAM_CONNECTOR_DEFAULT_ATTEMPT_DELAY std::chrono::milliseconds(250)
+
+namespace RemoteCore {
+    /**
+     Connects a TCP socket to a host with "Happy Eyeballs" (RFC 8305): the host is resolved without blocking, and its addresses are tried in turn, starting the next attempt whenever the previous one fails or has not succeeded within the attempt delay. The first attempt to succeed is used, and the others are abandoned, so an unreachable address or family only delays connecting by the attempt delay.
+     
+     Must only be used on its loop's thread, and destroyed there or once the loop has stopped.
+     */
+    class StreamConnector {
+    public:
+        /**
+         Called with a connected, non-blocking socket that the handler takes ownership of, or with -1 and the error that caused the last attempt to fail ('ETIMEDOUT' if the timeout elapsed first).
+         */
+        typedef std::function<void (int fd, int error)> CompletionHandler;
+    
+    private:
+        struct Attempt {
+            int fd;
+            SocketAddress address;
+        };
+        
+        EventLoop &loop;
+        HostResolver *resolver;
+        const std::chrono::milliseconds attemptDelay;
+        
+        std::string host;
+        std::vector<SocketAddress> addresses;
+        size_t nextAddressIndex;
+        std::vector<Attempt> attempts;
+        int lastError;
+        CompletionHandler completionHandler;
+        
+        HostResolver::RequestIdentifier resolveRequest;
+        EventLoop::TimerIdentifier attemptTimer;
+        EventLoop::TimerIdentifier timeoutTimer;
+        
+        /// Lets handlers posted to the loop tell whether the connector, and the connection they belong to, still exist.
+        std::shared_ptr<uint64_t> generation;
+        
+        void startAttempts(void);
+        void startNextAttempt(void);
+        void handleAttemptEvents(int fd);
+        void complete(int fd, int error);
+        
+        /**
+         Stops every attempt, and the timers, without calling the completion handler.
+         */
+        void reset(void);
+    
+    public:
+        explicit StreamConnector(EventLoop &loop, std::chrono::milliseconds attemptDelay = STREAM_CONNECTOR_DEFAULT_ATTEMPT_DELAY, HostResolver *resolver = HostResolver::sharedResolver());
+        ~StreamConnector();
+        
+        StreamConnector(const StreamConnector &) = delete;
+        StreamConnector &operator=(const StreamConnector &) = delete;
+        
+        /**
+         Resolves the host, and connects to one of its addresses within the timeout, which includes the time taken to resolve the host. Cancels any connection in progress. If every attempt fails, the host's cached addresses are discarded, so that the next connection resolves it again.
+         */
+        void connect(const std::string &host, uint16_t port, std::chrono::milliseconds timeout, CompletionHandler completionHandler);
+        
+        /**
+         Connects to one of the addresses, which are tried in order.
+         */
+        void connect(const std::vector<SocketAddress> &addresses, std::chrono::milliseconds timeout, CompletionHandler completionHandler);
+        
+        /**
+         Abandons the connection in progress, without calling its completion handler.
+         */
+        void cancel(void);
+        
+        bool isConnecting(void) const {
+            return completionHandler != nullptr;
+        }
+        
+        /**
+         Connects to the host on a loop of its own, and blocks until the connection succeeds or fails. Returns a connected, non-blocking socket, or -1 with 'error' set.
+         */
+        static int connect(const std::string &host, uint16_t port, std::chrono::milliseconds attemptDelay, std::chrono::milliseconds timeout, int &error);
+    };
+}
+
+#endif /* StreamConnector_hpp */
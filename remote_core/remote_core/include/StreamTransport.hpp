@@ -0,0 +1,232 @@
+//
+//  StreamTransport.hpp
+//  remote_core
+//
+//  Created by David Moore on 10/19/26.
+//  Copyright © 2026 David Moore. All rights reserved.
+//
+
+#ifndef StreamTransport_hpp
+#define StreamTransport_hpp
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <sys/types.h>
+#include <sys/uio.h>
+#include "BufferChain.hpp"
+#include "SocketAddress.hpp"
+#include "TlsCipherPolicy.hpp"
+#include "TlsSessionCache.hpp"
+
+typedef struct ssl_st SSL;
+typedef struct ssl_ctx_st SSL_CTX;
+
+namespace RemoteCore {
+    enum class TransportStatus {
+        /// The operation transferred 'byteCount' bytes, or the handshake finished.
+        Complete,
+        
+        /// The operation must be retried once the descriptor is readable.
+        WantRead,
+        
+        /// The operation must be retried once the descriptor is writable.
+        WantWrite,
+        
+        /// The peer closed the connection.
+        Closed,
+        
+        Failed
+    };
+    
+    struct TransportResult {
+        TransportStatus status;
+        size_t byteCount;
+        
+        TransportResult(TransportStatus status, size_t byteCount = 0) : status(status), byteCount(byteCount) {}
+    };
+    
+    /**
+     Byte stream over a non-blocking socket, which is never waited on by the transport itself. Callers wait for the readiness that an operation asks for (e.g., on an 'EventLoop'), and then retry the operation.
+     */
+    class StreamTransport {
+    public:
+        virtual ~StreamTransport() = default;
+        
+        virtual int getDescriptor(void) const = 0;
+        
+        /**
+         Performs the next step of any handshake that must finish before data can be transferred.
+         */
+        virtual TransportResult handshake(void) = 0;
+        
+        virtual TransportResult read(char *buffer, size_t length) = 0;
+        virtual TransportResult write(const char *bytes, size_t length) = 0;
+        
+        /**
+         Writes the bytes of the vectors in order, as one write where possible. A result of 'WantWrite' is retried with the same bytes first, as with 'write'.
+         
+         By default, only the first vector is written.
+         */
+        virtual TransportResult writeVector(const struct iovec *vectors, size_t count);
+        
+        /**
+         Writes as much of the chain as the socket accepts with 'writeVector', and consumes what was written from the chain.
+         */
+        TransportResult writeChain(BufferChain &chain);
+        
+        /**
+         Writes up to 'length' bytes of the file, starting at 'offset', for bulk payloads (e.g., codebooks) that need not be read into memory first. A result of 'WantWrite' is retried with the same offset, as a write is retried with the same bytes.
+         
+         By default, the file is read in chunks that are passed to 'write'.
+         */
+        virtual TransportResult sendFile(int fileFD, off_t offset, size_t length);
+        
+        /**
+         Starts connecting a non-blocking TCP socket to the address, without waiting for the connection. The socket becomes writable once the connection succeeds or fails, and 'finishConnecting' tells which. Throws 'std::system_error' if the connection could not be started. Names are connected to with 'StreamConnector'.
+         */
+        static int startConnecting(const SocketAddress &address);
+        
+        /**
+         Returns zero if the connection started by 'startConnecting' succeeded, 'EINPROGRESS' if it has not finished yet, or the error that caused it to fail.
+         */
+        static int finishConnecting(int fd);
+        
+        /**
+         Returns a non-blocking socket listening on the port of the loopback interface, or on an ephemeral port if the port is zero.
+         */
+        static int listenOnLoopback(uint16_t port);
+        
+        /**
+         Returns a non-blocking socket listening on the port of every IPv4 interface, so that other hosts on the network may connect, or on an ephemeral port if the port is zero.
+         */
+        static int listenOnAnyInterface(uint16_t port);
+        
+        static uint16_t getLocalPort(int fd);
+    };
+    
+    /**
+     Plain TCP transport, which takes ownership of the socket.
+     */
+    class TcpTransport : public StreamTransport {
+        int fd;
+    
+    public:
+        explicit TcpTransport(int fd);
+        ~TcpTransport() override;
+        
+        TcpTransport(const TcpTransport &) = delete;
+        TcpTransport &operator=(const TcpTransport &) = delete;
+        
+        int getDescriptor(void) const override {
+            return fd;
+        }
+        
+        TransportResult handshake(void) override;
+        TransportResult read(char *buffer, size_t length) override;
+        TransportResult write(const char *bytes, size_t length) override;
+        
+        /**
+         Writes every vector with one 'sendmsg'.
+         */
+        TransportResult writeVector(const struct iovec *vectors, size_t count) override;
+        
+        /**
+         Copies the file to the socket within the kernel where 'sendfile' is available.
+         */
+        TransportResult sendFile(int fileFD, off_t offset, size_t length) override;
+    };
+    
+    struct TlsConfiguration {
+        std::string rootCAPath;
+        std::string certificatePath;
+        std::string privateKeyPath;
+        
+        /// Name the server's certificate is verified against, and sent with SNI. Unused by servers.
+        std::string serverName;
+        
+        /// Protocol negotiated with ALPN, if not empty (e.g., 'x-amzn-mqtt-ca' when connecting to the IoT Core on port 443).
+        std::string applicationProtocol;
+        
+        bool isServer = false;
+        
+        /// Clients verify the server's certificate against 'rootCAPath', and servers require every client to present a certificate that verifies against it.
+        bool verifiesPeer = true;
+        
+        /// Sessions are resumed from, and stored in, the cache if it is not null, keyed by 'serverName'. Unused by servers.
+        std::shared_ptr<TlsSessionCache> sessionCache;
+        
+        /// Cipher suites and groups offered, or chosen from by servers.
+        TlsCipherPolicy cipherPolicy = TlsCipherPolicy::getPreferred();
+        
+        /// Records are encrypted and decrypted by the kernel once the handshake finishes, if the kernel supports the negotiated cipher; otherwise OpenSSL continues to, without any error.
+        bool usesKernelTls = false;
+    };
+    
+    /**
+     TLS transport over OpenSSL, which takes ownership of the socket. The handshake, reads and writes never block; OpenSSL's need for readiness is reported through 'TransportStatus'.
+     */
+    class TlsTransport : public StreamTransport {
+        int fd;
+        std::shared_ptr<SSL_CTX> context;
+        SSL *ssl;
+        std::shared_ptr<TlsSessionCache> sessionCache;
+        
+        /// Small vectors gathered into one record, allocated by the first write that needs it.
+        std::unique_ptr<char[]> stagingBuffer;
+        
+        TransportResult resultForError(int result);
+    
+    public:
+        /**
+         Creates a context for the configuration, with certificates from 'TlsCredentialCache'. Contexts are expensive, and should be shared by every transport with the same configuration. Throws 'std::runtime_error' if a certificate or key cannot be loaded, or the cipher policy names nothing OpenSSL supports.
+         */
+        static std::shared_ptr<SSL_CTX> makeContext(const TlsConfiguration &configuration);
+        
+        TlsTransport(int fd, std::shared_ptr<SSL_CTX> context, const TlsConfiguration &configuration);
+        ~TlsTransport() override;
+        
+        TlsTransport(const TlsTransport &) = delete;
+        TlsTransport &operator=(const TlsTransport &) = delete;
+        
+        int getDescriptor(void) const override {
+            return fd;
+        }
+        
+        TransportResult handshake(void) override;
+        TransportResult read(char *buffer, size_t length) override;
+        TransportResult write(const char *bytes, size_t length) override;
+        
+        /**
+         Writes a large first vector directly. Otherwise, the small vectors that lead the list (e.g., a packet header, topic and payload) are copied into one record, rather than each being sent in a record of its own, since OpenSSL only encrypts contiguous bytes.
+         */
+        TransportResult writeVector(const struct iovec *vectors, size_t count) override;
+        
+        /**
+         Copies the file to the socket within the kernel if records are sent by the kernel, and reads it in chunks otherwise.
+         */
+        TransportResult sendFile(int fileFD, off_t offset, size_t length) override;
+        
+        /**
+         Returns true if the completed handshake resumed a cached session.
+         */
+        bool isSessionResumed(void) const;
+        
+        /**
+         Returns the name of the negotiated cipher suite (e.g., 'TLS_CHACHA20_POLY1305_SHA256'), or an empty string before the handshake has finished.
+         */
+        std::string getCipherName(void) const;
+        
+        /**
+         Returns true if records are encrypted by the kernel, which is only the case once the handshake has finished with 'usesKernelTls'.
+         */
+        bool isKernelTlsSending(void) const;
+        
+        /**
+         Returns true if records are decrypted by the kernel. OpenSSL may only hand over sending, depending on its version and the protocol version.
+         */
+        bool isKernelTlsReceiving(void) const;
+    };
+}
+
+#endif /* StreamTransport_hpp */
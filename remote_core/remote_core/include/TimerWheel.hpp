@@ -0,0 +1,129 @@
+//
+//  TimerWheel.hpp
+//  remote_core
+//
+//  Created by David Moore on 10/19/26.
+//  Copyright © 2026 David Moore. All rights reserved.
+//
+
+#ifndef TimerWheel_hpp
+#define TimerWheel_hpp
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "DispatchTask.hpp"
+
+namespace RemoteCore {
+    class DispatchTimer;
+    
+    /**
+     Hierarchical timing wheel that runs timer handlers on a single thread.
+     
+     Deadlines are rounded up to the wheel's resolution, so timers that expire within the same tick are fired by a single wakeup. Each level has 64 slots, and each level's slots span 64 times as many ticks as the level below; timers are moved down a level once their slot comes around (i.e., cascaded). Scheduling and cancelling are constant time, and the thread only wakes for ticks that have work, rather than for every tick.
+     
+     Handlers run on the timer thread, so they must be short. Use 'DispatchQueue::executeAfter' to run a block on a queue.
+     */
+    class TimerWheel {
+    public:
+        typedef std::chrono::steady_clock Clock;
+        
+        static constexpr size_t levelCount = 4;
+        static constexpr size_t slotCount = 64;
+    
+    private:
+        friend class DispatchTimer;
+        
+        struct Timer;
+        typedef std::list<std::shared_ptr<Timer>> Slot;
+        
+        struct Timer {
+            uint64_t expiryTick = 0;
+            DispatchTask handler;
+            size_t level = 0;
+            size_t slot = 0;
+            Slot::iterator position;
+            bool isScheduled = false;
+        };
+        
+        std::string name;
+        Clock::duration resolution;
+        Clock::time_point origin;
+        
+        std::mutex mutex;
+        std::condition_variable condition;
+        Slot slots[levelCount][slotCount];
+        uint64_t occupiedSlots[levelCount];
+        uint64_t currentTick;
+        uint64_t plannedWakeTick;
+        size_t pendingTimerCount;
+        bool shouldQuit;
+        std::thread thread;
+        
+        void timerHandler(void);
+        void insert(const std::shared_ptr<Timer> &timer);
+        void advance(uint64_t targetTick, std::vector<DispatchTask> &handlers);
+        void processTick(std::vector<DispatchTask> &handlers);
+        uint64_t nextEventTick(void) const;
+        bool cancel(const std::shared_ptr<Timer> &timer);
+    
+    public:
+        TimerWheel(std::string name, Clock::duration resolution = std::chrono::milliseconds(1));
+        
+        /**
+         Stops the timer thread. Timers that have not fired are discarded.
+         */
+        ~TimerWheel();
+        
+        TimerWheel(const TimerWheel &) = delete;
+        TimerWheel &operator=(const TimerWheel &) = delete;
+        
+        /**
+         Wheel that is shared by every dispatch queue.
+         */
+        static TimerWheel *sharedTimerWheel(void);
+        
+        Clock::duration getResolution(void) const {
+            return resolution;
+        }
+        
+        /**
+         Returns the number of timers that have neither fired nor been cancelled.
+         */
+        size_t getPendingTimerCount(void);
+        
+        /**
+         Schedules the handler to run on the timer thread once the deadline has passed. Deadlines in the past fire on the next tick.
+         */
+        DispatchTimer schedule(Clock::time_point deadline, DispatchTask handler);
+    };
+    
+    /**
+     Handle to a scheduled timer, which may be used to cancel it. Handles are copyable, and an empty handle refers to no timer.
+     */
+    class DispatchTimer {
+    private:
+        friend class TimerWheel;
+        
+        TimerWheel *wheel;
+        std::weak_ptr<TimerWheel::Timer> timer;
+        
+        DispatchTimer(TimerWheel *wheel, std::weak_ptr<TimerWheel::Timer> timer) : wheel(wheel), timer(timer) {}
+    
+    public:
+        DispatchTimer() : wheel(nullptr) {}
+        
+        /**
+         Prevents the timer from firing. Returns false if the timer has already fired, or was already cancelled.
+         */
+        bool cancel(void);
+    };
+}
+
+#endif /* TimerWheel_hpp */
@@ -0,0 +1,52 @@
+//
+//  TlsCipherPolicy.hpp
+//  remote_core
+//
+//  Created by David Moore on 10/19/26.
+//  Copyright © 2026 David Moore. All rights reserved.
+//
+
+#ifndef TlsCipherPolicy_hpp
+#define TlsCipherPolicy_hpp
+
+#include <string>
+
+typedef struct ssl_ctx_st SSL_CTX;
+
+namespace RemoteCore {
+    /**
+     Cipher suites and key exchange groups offered in a handshake, in order of preference. Each list is in OpenSSL's colon-separated syntax, and an empty list leaves OpenSSL's default in place.
+     */
+    struct TlsCipherPolicy {
+        /// Cipher suites for TLS 1.2 (e.g., 'ECDHE-ECDSA-CHACHA20-POLY1305').
+        std::string cipherList;
+        
+        /// Cipher suites for TLS 1.3 (e.g., 'TLS_CHACHA20_POLY1305_SHA256').
+        std::string cipherSuites;
+        
+        /// Groups for the key exchange (e.g., 'X25519:P-256').
+        std::string groups;
+        
+        /**
+         Returns true if the processor has AES instructions, which makes AES-GCM faster than ChaCha20-Poly1305. Detected once, at runtime.
+         */
+        static bool hasAESAcceleration(void);
+        
+        /**
+         Returns a policy that prefers AES-GCM if it is accelerated, and ChaCha20-Poly1305 otherwise (e.g., on ARM boards without the cryptography extensions). X25519 is preferred to P-256 either way, since it is faster without assembly for the curve.
+         */
+        static TlsCipherPolicy makePreferred(bool hasAESAcceleration);
+        
+        /**
+         Returns the preferred policy for this processor.
+         */
+        static TlsCipherPolicy getPreferred(void);
+        
+        /**
+         Configures the context with the policy. Servers also choose the suite by their own preference, except that ChaCha20-Poly1305 is chosen whenever a client prefers it, since the client is then likely to lack AES instructions. Returns false if a list names nothing OpenSSL supports.
+         */
+        bool apply(SSL_CTX *context, bool isServer) const;
+    };
+}
+
+#endif /* TlsCipherPolicy_hpp */
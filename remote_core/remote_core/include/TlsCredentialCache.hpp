@@ -0,0 +1,52 @@
+//
+//  TlsCredentialCache.hpp
+//  remote_core
+//
+//  Created by David Moore on 10/19/26.
+//  Copyright © 2026 David Moore. All rights reserved.
+//
+
+#ifndef TlsCredentialCache_hpp
+#define TlsCredentialCache_hpp
+
+#include <cstdint>
+#include <string>
+
+typedef struct ssl_ctx_st SSL_CTX;
+
+namespace RemoteCore {
+    enum class TlsCredentialStatus {
+        Success,
+        RootCertificateError,
+        CertificateError,
+        PrivateKeyError
+    };
+    
+    struct TlsCredentialCacheStatistics {
+        /// Number of times the files were read and parsed.
+        uint64_t loadCount = 0;
+        
+        /// Number of times previously parsed credentials were used instead.
+        uint64_t hitCount = 0;
+    };
+    
+    /**
+     Process-wide cache of parsed root certificates, certificate chains and private keys, so that creating a context, or reconnecting, does not read and parse the same files again. The files are parsed again once any of them has been modified.
+     */
+    class TlsCredentialCache {
+    public:
+        /**
+         Configures the context with the credentials in the files. The root certificate store is shared by every context that uses the same file. An empty path skips the corresponding credential, and the private key is only used with a certificate.
+         */
+        static TlsCredentialStatus configureContext(SSL_CTX *context, const std::string &rootCAPath, const std::string &certificatePath, const std::string &privateKeyPath);
+        
+        /**
+         Discards every cached credential.
+         */
+        static void removeAll(void);
+        
+        static TlsCredentialCacheStatistics getStatistics(void);
+    };
+}
+
+#endif /* TlsCredentialCache_hpp */
@@ -0,0 +1,87 @@
+//
+//  TlsSessionCache.hpp
+//  remote_core
+//
+//  Created by David Moore on 10/19/26.
+//  Copyright © 2026 David Moore. All rights reserved.
+//
+
+#ifndef TlsSessionCache_hpp
+#define TlsSessionCache_hpp
+
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+
+typedef struct ssl_st SSL;
+typedef struct ssl_ctx_st SSL_CTX;
+typedef struct ssl_session_st SSL_SESSION;
+
+namespace RemoteCore {
+    struct TlsSessionCacheStatistics {
+        /// Handshakes that resumed a cached session, skipping the certificate exchange.
+        uint64_t resumedHandshakeCount = 0;
+        uint64_t fullHandshakeCount = 0;
+        
+        /// Sessions (or TLS 1.3 tickets) received from servers.
+        uint64_t storedSessionCount = 0;
+    };
+    
+    /**
+     Client-side cache of TLS sessions, keyed by server name, which lets a reconnect resume the previous session instead of performing a full handshake. Works with both session IDs and session tickets, including the tickets TLS 1.3 servers send after the handshake.
+     
+     Sessions are kept in memory, and also written to a file if the cache has a path, so that they survive a restart. The file holds secrets that allow a session to be resumed, so it is only readable by its owner.
+     
+     Must be created with 'std::make_shared', since every connection that uses the cache keeps it alive. Every method may be called from any thread.
+     */
+    class TlsSessionCache : public std::enable_shared_from_this<TlsSessionCache> {
+        std::mutex mutex;
+        std::map<std::string, std::shared_ptr<SSL_SESSION>> sessions;
+        const std::string path;
+        TlsSessionCacheStatistics statistics;
+        
+        static int handleNewSession(SSL *ssl, SSL_SESSION *session);
+        
+        void storeSession(const std::string &key, SSL_SESSION *session);
+        
+        /**
+         Must be called with 'mutex' held.
+         */
+        void readFile(void);
+        void writeFile(void);
+    
+    public:
+        /**
+         Creates an empty cache, which is only kept in memory if the path is empty. Otherwise, the sessions in the file are loaded.
+         */
+        explicit TlsSessionCache(const std::string &path = "");
+        
+        /**
+         Enables client-side session caching for the context, which is required before 'attach' is used with any of its handles. May be called more than once.
+         */
+        static void enableForContext(SSL_CTX *context);
+        
+        /**
+         Offers the cached session for the key, if there is one that has not expired, and stores the sessions the server issues for the handle under the key. Must be called before the handshake begins.
+         */
+        void attach(SSL *ssl, const std::string &key);
+        
+        /**
+         Records whether the handle's completed handshake resumed a session.
+         */
+        void recordHandshake(SSL *ssl);
+        
+        /**
+         Discards the session for the key, e.g., after the server refused it.
+         */
+        void removeSession(const std::string &key);
+        
+        bool containsSession(const std::string &key);
+        
+        TlsSessionCacheStatistics getStatistics(void);
+    };
+}
+
+#endif /* TlsSessionCache_hpp */
@@ -0,0 +1,98 @@
+//
+//  TopicRouter.hpp
+//  remote_core
+//
+//  Created by David Moore on 10/19/26.
+//  Copyright © 2026 David Moore. All rights reserved.
+//
+
+#ifndef TopicRouter_hpp
+#define TopicRouter_hpp
+
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "MqttPacket.hpp"
+
+namespace RemoteCore {
+    /**
+     Routes inbound messages to the handlers of every matching MQTT topic filter, including the single level ('+') and multi-level ('#') wildcards.
+     
+     Routes are stored in an immutable trie that is replaced as a whole whenever a route changes (i.e., copy-on-write), so routing only needs to take a snapshot of the current trie. Handlers are always called without any lock held, which allows them to add or remove routes.
+     */
+    class TopicRouter {
+    public:
+        typedef std::function<void (const std::string &topicName, const std::string &payload, const MqttProperties &properties)> Handler;
+    
+    private:
+        struct Node {
+            std::map<std::string, std::shared_ptr<const Node>> children;
+            std::shared_ptr<const Handler> handler;
+        };
+        
+        /// Current trie, which must only be accessed atomically.
+        std::shared_ptr<const Node> root;
+        
+        /// Serializes writers, so that concurrent changes are never lost.
+        std::mutex writerMutex;
+        
+        static std::vector<std::string> splitLevels(const std::string &name);
+        
+        /**
+         Returns a copy of the node with the handler of the filter replaced, or removed when 'handler' is null. Only nodes along the path of the filter are copied; the rest are shared with the previous trie. Returns null when the resulting node would be empty.
+         */
+        static std::shared_ptr<const Node> replacingHandler(const std::shared_ptr<const Node> &node, const std::vector<std::string> &levels, size_t index, std::shared_ptr<const Handler> handler);
+        
+        static void collectHandlers(const Node &node, const std::vector<std::string> &levels, size_t index, std::vector<std::shared_ptr<const Handler>> &handlers);
+        
+        static size_t countRoutes(const Node &node);
+        
+        std::shared_ptr<const Node> loadRoot(void) const;
+        void storeRoot(std::shared_ptr<const Node> node);
+    
+    public:
+        TopicRouter();
+        
+        TopicRouter(const TopicRouter &) = delete;
+        TopicRouter &operator=(const TopicRouter &) = delete;
+        
+        /**
+         Returns whether the topic filter is well formed: wildcards must occupy an entire level, and '#' may only be the last level.
+         */
+        static bool isValidFilter(const std::string &filter);
+        
+        /**
+         Returns whether the topic name matches the topic filter. Wildcards at the first level never match topic names beginning with '$'.
+         */
+        static bool filterMatchesTopic(const std::string &filter, const std::string &topicName);
+        
+        /**
+         Calls the handler for every message whose topic matches the filter, replacing any handler previously added for the same filter. Throws 'std::invalid_argument' if the filter is not valid.
+         */
+        void addRoute(const std::string &filter, Handler handler);
+        
+        /**
+         Removes the handler for the filter. Returns false if no handler was added for the filter.
+         */
+        bool removeRoute(const std::string &filter);
+        
+        void removeAllRoutes(void);
+        
+        /**
+         Returns the handlers of every filter that matches the topic name.
+         */
+        std::vector<std::shared_ptr<const Handler>> handlersForTopic(const std::string &topicName) const;
+        
+        /**
+         Calls the handler of every filter that matches the topic name, with the message's properties, outside of any lock. Returns the number of handlers that were called.
+         */
+        size_t route(const std::string &topicName, const std::string &payload, const MqttProperties &properties = MqttProperties()) const;
+        
+        size_t getRouteCount(void) const;
+    };
+}
+
+#endif /* TopicRouter_hpp */
@@ -11,21 +11,16 @@
 
 #include <iostream>
 #include <memory>
+#include <map>
+#include <mutex>
 #include "Remote.hpp"
 #include "Error.hpp"
+#include "DispatchFuture.hpp"
+#include "LearningEngine.hpp"
+#include "RemoteLibrary.hpp"
 
-#define START_TRAINING_SESSION_DIRECTIVE "startTrainingSession"
-#define SUSPEND_TRAINING_SESSION_DIRECTIVE "suspendTrainingSession"
-#define CREATE_COMMAND_DIRECTIVE "createCommandWithLocalizedTitle"
-#define LEARN_COMMAND_DIRECTIVE "learnCommand"
-
-#define TRAINING_SESSION_DID_BEGIN_DIRECTIVE "trainingSessionDidBegin"
-#define TRAINING_SESSION_DID_FAIL_WITH_ERROR_DIRECTIVE "trainingSessionDidFailWithError"
-#define TRAINING_SESSION_WILL_LEARN_COMMAND_DIRECTIVE "trainingSessionWillLearnCommand"
-#define TRAINING_SESSION_DID_LEARN_COMMAND_DIRECTIVE "trainingSessionDidLearnCommand"
-#define TRAINING_SESSION_DID_REQUEST_INCLUSIVE_ARBITRARY_INPUT_DIRECTIVE "trainingSessionDidRequestInclusiveArbitraryInput"
-#define TRAINING_SESSION_DID_REQUEST_INPUT_FOR_COMMAND_DIRECTIVE "trainingSessionDidRequestInputForCommand"
-#define TRAINING_SESSION_DID_REQUEST_EXCLUSIVE_ARBITRARY_INPUT_DIRECTIVE "trainingSessionDidRequestExclusiveArbitraryInput"
+/// Amount of time a training session may go without a request before it times out.
+#define TRAINING_SESSION_DEFAULT_IDLE_TIMEOUT std::chrono::minutes(5)
 
 namespace RemoteCore {
     class HardwareController;
@@ -38,6 +33,51 @@ namespace RemoteCore {
         std::weak_ptr<TrainingSessionDelegate> delegate;
         Command currentCommand;
         std::vector<std::string> availableCommandIDs;
+        std::string captureSourcePath;
+        std::map<std::string, LearnedCode> learnedCodesByCommandID;
+        std::chrono::microseconds lastLearningLatency;
+        std::shared_ptr<RemoteLibrary> remoteLibrary;
+        bool isIdentifyingRemote;
+        std::chrono::milliseconds idleTimeout;
+        DispatchTimer idleTimer;
+        std::chrono::steady_clock::time_point idleDeadline;
+        std::mutex stateMutex;
+        
+        // Runs the idle timer, and must outlive the learning engine since learning results re-arm the timer.
+        std::unique_ptr<DispatchQueue> queue;
+        
+        // Declared last so that learning is cancelled before the rest of the session is torn down.
+        std::unique_ptr<LearningEngine> learningEngine;
+        
+        /**
+         Handles the result of learning a particular command, and returns the error the delegate was informed with. Called on the learning engine's queue.
+         */
+        Error handleLearningResult(Command command, LearningResult result);
+        
+        /**
+         Handles the result of learning an arbitrary command for identifying the remote, and returns the error the delegate was informed with. Called on the learning engine's queue.
+         */
+        Error handleIdentificationResult(LearningResult result);
+        
+        /**
+         (Re)starts the idle timer. Must be called with 'stateMutex' held.
+         */
+        void scheduleIdleTimeout(void);
+        
+        /**
+         Informs the delegate that the session timed out, unless a request arrived in the meantime. Called on the receiver's queue.
+         */
+        void handleIdleTimeout(void);
+        
+        /**
+         Replaces the commands of the associated remote, and their learnt codes, with the buttons of a codebook. Returns false, leaving the remote as it was, if none of the buttons correspond to a command ID that is available or already used by the remote.
+         */
+        bool adoptCodebook(const RemoteCodebook &codebook);
+        
+        /**
+         Writes the configuration of the associated remote to 'remotes/<remote id>.lircd.conf'.
+         */
+        void writeRemoteConfiguration(void);
         
     public:
         TrainingSession(Remote associatedRemote);
@@ -46,7 +86,8 @@ namespace RemoteCore {
             return sessionID;
         }
         
-        Remote getAssociatedRemote(void) const {
+        Remote getAssociatedRemote(void) {
+            std::lock_guard<std::mutex> lock(stateMutex);
             return associatedRemote;
         }
         
@@ -57,6 +98,59 @@ namespace RemoteCore {
         void setDelegate(std::weak_ptr<TrainingSessionDelegate> delegate) {
             this->delegate = delegate;
         }
+        
+        /**
+         Path of the receiver device, or recorded capture file, that commands are learnt from. Defaults to 'PULSE_STREAM_DEFAULT_DEVICE_PATH'.
+         */
+        std::string getCaptureSourcePath(void) const {
+            return captureSourcePath;
+        }
+        
+        void setCaptureSourcePath(std::string captureSourcePath) {
+            this->captureSourcePath = captureSourcePath;
+        }
+        
+        /**
+         Library of known remotes that is used to identify the associated remote.
+         */
+        std::shared_ptr<RemoteLibrary> getRemoteLibrary(void) const {
+            return remoteLibrary;
+        }
+        
+        void setRemoteLibrary(std::shared_ptr<RemoteLibrary> remoteLibrary) {
+            this->remoteLibrary = remoteLibrary;
+        }
+        
+        /**
+         Amount of time the session may go without a learning request before the delegate is informed with 'Error::TrainingTimedOut'. Defaults to 'TRAINING_SESSION_DEFAULT_IDLE_TIMEOUT'.
+         */
+        std::chrono::milliseconds getIdleTimeout(void) {
+            std::lock_guard<std::mutex> lock(stateMutex);
+            return idleTimeout;
+        }
+        
+        void setIdleTimeout(std::chrono::milliseconds idleTimeout) {
+            std::lock_guard<std::mutex> lock(stateMutex);
+            this->idleTimeout = idleTimeout;
+        }
+        
+        /**
+         Time it took to learn the most recent command, from the start of the request until the command was decoded.
+         */
+        std::chrono::microseconds getLastLearningLatency(void) {
+            std::lock_guard<std::mutex> lock(stateMutex);
+            return lastLearningLatency;
+        }
+        
+        /**
+         Returns the code that was learnt for a command, or an invalid code if the command has not been learnt.
+         */
+        LearnedCode learnedCodeForCommand(const Command &command);
+        
+        /**
+         Generates a lircd.conf representation of the associated remote, containing every command that has been learnt.
+         */
+        std::string generateRemoteConfiguration(void);
 
         /**
          Adds the config content of new remote to default config
@@ -66,6 +160,8 @@ namespace RemoteCore {
 
         /**
          Initializes the training session. This will require user input (e.g., inclusive arbitrary input).
+         
+         If no learning request is made within the idle timeout, the delegate is informed with 'Error::TrainingTimedOut'.
          */
         void start(void);
         
@@ -82,9 +178,21 @@ namespace RemoteCore {
         /**
          Starts the training process for a specific command. Note that the receiver does not determine if the command is a repeat or not. (Asynchronous)
          
+         Once the command is learnt, the remote's configuration is written to 'remotes/<remote id>.lircd.conf'. If no signal is received the delegate is informed with 'Error::NoSignalWhileTraining'.
+         
          @param command The command that will be learnt. The localized title is persisted when reporting the status of this call, but it will not be modified.
+         @return Future error, available once the delegate has been informed of the outcome.
          */
-        void learnCommand(Command command);
+        DispatchFuture<Error> learnCommand(Command command);
+        
+        /**
+         Identifies the associated remote from a single arbitrary button press, by matching the learnt code against the remote library. (Asynchronous)
+         
+         When a matching remote is found the commands of the associated remote are replaced with every button of the matching remote that has a standard command ID, the configuration is written and the delegate is informed with the complete remote. Otherwise, the delegate is informed with 'Error::NoMatchingRemote'.
+         
+         @return Future error, available once the delegate has been informed of the outcome.
+         */
+        DispatchFuture<Error> identifyRemote(void);
 
         /**
          * Trains remote through initiating irrecord in command line.
@@ -107,6 +215,9 @@ namespace RemoteCore {
         virtual void trainingSessionWillLearnCommand(TrainingSession *session, Command command) {};
         virtual void trainingSessionDidLearnCommand(TrainingSession *session, Command command) {};
         
+        // The remote was identified from the library, and now includes every known command.
+        virtual void trainingSessionDidIdentifyRemote(TrainingSession *session, Remote remote) {};
+        
         // Inclusive arbitrary input indicates all buttons should be pressed – in no specific order (i.e., arbitrary).
         virtual void trainingSessionDidRequestInclusiveArbitraryInput(TrainingSession *session) {};
         
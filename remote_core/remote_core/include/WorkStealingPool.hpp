@@ -0,0 +1,92 @@
+//
+//  WorkStealingPool.hpp
+//  remote_core
+//
+//  Created by David Moore on 10/19/26.
+//  Copyright © 2026 David Moore. All rights reserved.
+//
+
+#ifndef WorkStealingPool_hpp
+#define WorkStealingPool_hpp
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "DispatchTask.hpp"
+
+namespace RemoteCore {
+    /**
+     Fixed set of worker threads, each with its own deque of tasks. Workers take their own work from the back of their deque and steal from the front of other workers' deques once they run out, so contention is limited to the deque that is being stolen from.
+     
+     Tasks submitted from outside of the pool are placed on a shared injection queue. Idle workers park on a condition variable and are woken one at a time, only when there are parked workers and new work arrives.
+     */
+    class WorkStealingPool {
+    private:
+        struct Worker {
+            std::mutex mutex;
+            std::deque<DispatchTask> tasks;
+            std::thread thread;
+        };
+        
+        std::string name;
+        std::vector<std::unique_ptr<Worker>> workers;
+        
+        std::mutex injectionMutex;
+        std::deque<DispatchTask> injectionQueue;
+        
+        std::mutex parkingMutex;
+        std::condition_variable parkingCondition;
+        std::atomic<size_t> queuedTaskCount;
+        std::atomic<size_t> parkedWorkerCount;
+        std::atomic_bool shouldQuit;
+        
+        void workerHandler(size_t workerIndex);
+        bool takeTask(size_t workerIndex, DispatchTask &task);
+        void wakeWorker(void);
+    
+    public:
+        /**
+         Creates a pool with the given number of worker threads. A thread count of zero uses the number of hardware threads.
+         */
+        WorkStealingPool(std::string name, size_t threadCount = 0);
+        
+        /**
+         Completes every task that has been submitted, then joins the worker threads.
+         */
+        ~WorkStealingPool();
+        
+        WorkStealingPool(const WorkStealingPool &) = delete;
+        WorkStealingPool &operator=(const WorkStealingPool &) = delete;
+        
+        /**
+         Pool that is shared by every serial dispatch queue.
+         */
+        static WorkStealingPool *sharedPool(void);
+        
+        size_t getThreadCount(void) const {
+            return workers.size();
+        }
+        
+        /**
+         Returns true when called from one of the receiver's worker threads.
+         */
+        bool isCurrentThreadInPool(void) const;
+        
+        /**
+         Submits a task for execution on any of the worker threads. Tasks submitted from a worker are placed on that worker's deque.
+         */
+        void submit(DispatchTask task);
+        
+        /**
+         Submits a task behind every task that is waiting on the injection queue, even when called from a worker, so that the worker takes other work before it. Used to give up a worker thread without giving up the work.
+         */
+        void yield(DispatchTask task);
+    };
+}
+
+#endif /* WorkStealingPool_hpp */
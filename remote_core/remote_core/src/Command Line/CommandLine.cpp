@@ -14,7 +14,8 @@
 using namespace RemoteCore;
 
 CommandLine::CommandLine() {
-    queue = std::make_unique<DispatchQueue>("ca.mooredev.remote_core.CommandLine.serial_dispatch_queue", 1);
+    // Commands block until they exit.
+    queue = std::make_unique<DispatchQueue>("ca.mooredev.remote_core.CommandLine.serial_dispatch_queue", 1, true);
 }
 
 std::shared_ptr<CommandLine> CommandLine::sharedCommandLine() {
@@ -30,18 +31,17 @@ std::shared_ptr<CommandLine> CommandLine::sharedCommandLine() {
 }
 
 void CommandLine::executeCommandWithResultHandler(const char *command, std::function<void (std::string, bool)> resultHandler) {
-    system(command);
-    
-    /*execl("/bin/sh", "sh", "-c", command);*/
-    resultHandler("", true);
-    
-    //queue->execute([command, resultHandler]() {
+    // The command is copied, since the caller's string may not outlive the call.
+    queue->execute([command = std::string(command), resultHandler]() {
+        system(command.c_str());
         
+        /*execl("/bin/sh", "sh", "-c", command);*/
+        resultHandler("", true);
         
         /*
         std::array<char, 128> buffer;
         std::string result;
-        std::shared_ptr<FILE> pipe(popen(command, "r"), pclose);
+        std::shared_ptr<FILE> pipe(popen(command.c_str(), "r"), pclose);
         
         if (pipe == nullptr) {
             resultHandler(result, true);
@@ -60,5 +60,5 @@ void CommandLine::executeCommandWithResultHandler(const char *command, std::func
         }
         
         resultHandler(result, true);*/
-    /*});*/
+    });
 }
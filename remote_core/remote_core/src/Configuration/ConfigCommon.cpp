@@ -31,6 +31,7 @@
 
 #include "util/logging/LogMacros.hpp"
 #include "ConfigCommon.hpp"
+#include "MessageOutbox.hpp"
 
 #define LOG_TAG_SAMPLE_CONFIG_COMMON "[Sample Config]"
 
@@ -68,6 +69,27 @@
 // Core settings
 #define SDK_CONFIG_MAX_TX_ACTION_QUEUE_LENGTH_KEY "maximum_outgoing_action_queue_length"
 #define SDK_CONFIG_ACTION_PROCESSING_RATE_KEY "action_processing_rate_hz"
+#define REMOTE_CORE_CONFIG_USE_BUILTIN_MQTT_CLIENT_KEY "use_builtin_mqtt_client"
+#define REMOTE_CORE_CONFIG_OUTBOX_RELATIVE_PATH_KEY "outbox_relative_path"
+#define REMOTE_CORE_CONFIG_OUTBOX_SEGMENT_SIZE_KEY "outbox_segment_size_bytes"
+#define REMOTE_CORE_CONFIG_OUTBOX_SEGMENT_COUNT_KEY "outbox_segment_count"
+#define REMOTE_CORE_CONFIG_OUTBOX_REPLAY_BATCH_SIZE_KEY "outbox_replay_batch_size"
+#define REMOTE_CORE_CONFIG_TLS_SESSION_CACHE_RELATIVE_PATH_KEY "tls_session_cache_relative_path"
+#define REMOTE_CORE_CONFIG_TLS_KERNEL_OFFLOAD_KEY "tls_kernel_offload"
+#define REMOTE_CORE_CONFIG_TLS_CIPHER_LIST_KEY "tls_cipher_list"
+#define REMOTE_CORE_CONFIG_TLS_CIPHER_SUITES_KEY "tls_cipher_suites"
+#define REMOTE_CORE_CONFIG_TLS_GROUPS_KEY "tls_groups"
+#define REMOTE_CORE_CONFIG_LOCAL_ENDPOINT_PORT_KEY "local_endpoint_port"
+#define REMOTE_CORE_CONFIG_LOCAL_ENDPOINT_CERT_RELATIVE_KEY "local_endpoint_certificate_relative_path"
+#define REMOTE_CORE_CONFIG_LOCAL_ENDPOINT_PRIVATE_KEY_RELATIVE_KEY "local_endpoint_private_key_relative_path"
+#define REMOTE_CORE_CONFIG_LOCAL_ENDPOINT_CLIENT_ROOT_CA_RELATIVE_KEY "local_endpoint_client_root_ca_relative_path"
+#define REMOTE_CORE_CONFIG_LOCAL_ENDPOINT_ADVERTISES_KEY "local_endpoint_advertises"
+#define REMOTE_CORE_CONFIG_USE_MQTT_5_KEY "use_mqtt_5"
+#define REMOTE_CORE_CONFIG_MQTT_TOPIC_ALIAS_MAXIMUM_KEY "mqtt_topic_alias_maximum"
+#define REMOTE_CORE_CONFIG_MQTT_MESSAGE_EXPIRY_INTERVAL_SECS_KEY "mqtt_message_expiry_interval_secs"
+#define REMOTE_CORE_CONFIG_METRICS_RELATIVE_PATH_KEY "metrics_relative_path"
+#define REMOTE_CORE_CONFIG_METRICS_EXPORT_INTERVAL_SECS_KEY "metrics_export_interval_secs"
+#define REMOTE_CORE_CONFIG_METRICS_PUBLISHES_STATS_KEY "metrics_publishes_stats"
 
 // Pertinent Information
 #define REMOTE_CORE_CONFIG_SERIAL_NUMBER_KEY "remote_core_serial_number"
@@ -106,6 +128,25 @@ namespace awsiotsdk {
     size_t ConfigCommon::max_pending_acks_;
     size_t ConfigCommon::maximum_outgoing_action_queue_length_;
     uint32_t ConfigCommon::action_processing_rate_hz_;
+    bool ConfigCommon::use_builtin_mqtt_client_;
+    util::String ConfigCommon::outbox_path_;
+    size_t ConfigCommon::outbox_segment_size_bytes_;
+    size_t ConfigCommon::outbox_segment_count_;
+    size_t ConfigCommon::outbox_replay_batch_size_;
+    util::String ConfigCommon::tls_session_cache_path_;
+    bool ConfigCommon::tls_kernel_offload_;
+    RemoteCore::TlsCipherPolicy ConfigCommon::tls_cipher_policy_;
+    uint16_t ConfigCommon::local_endpoint_port_;
+    util::String ConfigCommon::local_endpoint_cert_path_;
+    util::String ConfigCommon::local_endpoint_key_path_;
+    util::String ConfigCommon::local_endpoint_client_root_ca_path_;
+    bool ConfigCommon::local_endpoint_advertises_;
+    bool ConfigCommon::use_mqtt_5_;
+    uint16_t ConfigCommon::mqtt_topic_alias_maximum_;
+    std::chrono::seconds ConfigCommon::mqtt_message_expiry_interval_;
+    util::String ConfigCommon::metrics_path_;
+    std::chrono::seconds ConfigCommon::metrics_export_interval_;
+    bool ConfigCommon::metrics_publishes_stats_;
     
     util::String ConfigCommon::serial_number_;
 
@@ -327,6 +368,152 @@ namespace awsiotsdk {
             return rc;
         }
         
+        // Optional, since older configurations predate the built-in client.
+        rc = util::JsonParser::GetBoolValue(sdk_config_json_, REMOTE_CORE_CONFIG_USE_BUILTIN_MQTT_CLIENT_KEY,
+                                            use_builtin_mqtt_client_);
+        if (ResponseCode::SUCCESS != rc) {
+            use_builtin_mqtt_client_ = true;
+        }
+        
+        // Optional as well; without a path, messages are not kept while disconnected.
+        rc = util::JsonParser::GetStringValue(sdk_config_json_, REMOTE_CORE_CONFIG_OUTBOX_RELATIVE_PATH_KEY, temp_str);
+        if (ResponseCode::SUCCESS == rc && 0 != temp_str.length()) {
+            outbox_path_ = GetCurrentPath();
+            outbox_path_.append("/");
+            outbox_path_.append(temp_str);
+        } else {
+            outbox_path_.clear();
+        }
+        
+        rc = util::JsonParser::GetSizeTValue(sdk_config_json_, REMOTE_CORE_CONFIG_OUTBOX_SEGMENT_SIZE_KEY,
+                                             outbox_segment_size_bytes_);
+        if (ResponseCode::SUCCESS != rc) {
+            outbox_segment_size_bytes_ = MESSAGE_OUTBOX_DEFAULT_SEGMENT_SIZE;
+        }
+        
+        rc = util::JsonParser::GetSizeTValue(sdk_config_json_, REMOTE_CORE_CONFIG_OUTBOX_SEGMENT_COUNT_KEY,
+                                             outbox_segment_count_);
+        if (ResponseCode::SUCCESS != rc) {
+            outbox_segment_count_ = MESSAGE_OUTBOX_DEFAULT_SEGMENT_COUNT;
+        }
+        
+        rc = util::JsonParser::GetSizeTValue(sdk_config_json_, REMOTE_CORE_CONFIG_OUTBOX_REPLAY_BATCH_SIZE_KEY,
+                                             outbox_replay_batch_size_);
+        if (ResponseCode::SUCCESS != rc || 0 == outbox_replay_batch_size_) {
+            outbox_replay_batch_size_ = 16;
+        }
+        
+        // Optional; without a path, TLS sessions are only resumed until the process exits.
+        rc = util::JsonParser::GetStringValue(sdk_config_json_, REMOTE_CORE_CONFIG_TLS_SESSION_CACHE_RELATIVE_PATH_KEY, temp_str);
+        if (ResponseCode::SUCCESS == rc && 0 != temp_str.length()) {
+            tls_session_cache_path_ = GetCurrentPath();
+            tls_session_cache_path_.append("/");
+            tls_session_cache_path_.append(temp_str);
+        } else {
+            tls_session_cache_path_.clear();
+        }
+        
+        // Optional; records are encrypted by OpenSSL unless the kernel is asked to take over once connected.
+        rc = util::JsonParser::GetBoolValue(sdk_config_json_, REMOTE_CORE_CONFIG_TLS_KERNEL_OFFLOAD_KEY,
+                                            tls_kernel_offload_);
+        if (ResponseCode::SUCCESS != rc) {
+            tls_kernel_offload_ = false;
+        }
+        
+        // Optional; each list that is given replaces the one preferred for this processor.
+        tls_cipher_policy_ = RemoteCore::TlsCipherPolicy::getPreferred();
+        rc = util::JsonParser::GetStringValue(sdk_config_json_, REMOTE_CORE_CONFIG_TLS_CIPHER_LIST_KEY, temp_str);
+        if (ResponseCode::SUCCESS == rc && 0 != temp_str.length()) {
+            tls_cipher_policy_.cipherList = temp_str;
+        }
+        
+        rc = util::JsonParser::GetStringValue(sdk_config_json_, REMOTE_CORE_CONFIG_TLS_CIPHER_SUITES_KEY, temp_str);
+        if (ResponseCode::SUCCESS == rc && 0 != temp_str.length()) {
+            tls_cipher_policy_.cipherSuites = temp_str;
+        }
+        
+        rc = util::JsonParser::GetStringValue(sdk_config_json_, REMOTE_CORE_CONFIG_TLS_GROUPS_KEY, temp_str);
+        if (ResponseCode::SUCCESS == rc && 0 != temp_str.length()) {
+            tls_cipher_policy_.groups = temp_str;
+        }
+        
+        // Optional; without a port, phones only reach the device through the cloud.
+        rc = util::JsonParser::GetUint16Value(sdk_config_json_, REMOTE_CORE_CONFIG_LOCAL_ENDPOINT_PORT_KEY,
+                                              local_endpoint_port_);
+        if (ResponseCode::SUCCESS != rc) {
+            local_endpoint_port_ = 0;
+        }
+        
+        rc = util::JsonParser::GetStringValue(sdk_config_json_, REMOTE_CORE_CONFIG_LOCAL_ENDPOINT_CERT_RELATIVE_KEY, temp_str);
+        if (ResponseCode::SUCCESS == rc && 0 != temp_str.length()) {
+            local_endpoint_cert_path_ = GetCurrentPath();
+            local_endpoint_cert_path_.append("/");
+            local_endpoint_cert_path_.append(temp_str);
+        } else {
+            local_endpoint_cert_path_.clear();
+        }
+        
+        rc = util::JsonParser::GetStringValue(sdk_config_json_, REMOTE_CORE_CONFIG_LOCAL_ENDPOINT_PRIVATE_KEY_RELATIVE_KEY, temp_str);
+        if (ResponseCode::SUCCESS == rc && 0 != temp_str.length()) {
+            local_endpoint_key_path_ = GetCurrentPath();
+            local_endpoint_key_path_.append("/");
+            local_endpoint_key_path_.append(temp_str);
+        } else {
+            local_endpoint_key_path_.clear();
+        }
+        
+        // Without a root certificate to verify clients against, the local endpoint is not started.
+        rc = util::JsonParser::GetStringValue(sdk_config_json_, REMOTE_CORE_CONFIG_LOCAL_ENDPOINT_CLIENT_ROOT_CA_RELATIVE_KEY, temp_str);
+        if (ResponseCode::SUCCESS == rc && 0 != temp_str.length()) {
+            local_endpoint_client_root_ca_path_ = GetCurrentPath();
+            local_endpoint_client_root_ca_path_.append("/");
+            local_endpoint_client_root_ca_path_.append(temp_str);
+        } else {
+            local_endpoint_client_root_ca_path_.clear();
+        }
+        
+        rc = util::JsonParser::GetBoolValue(sdk_config_json_, REMOTE_CORE_CONFIG_LOCAL_ENDPOINT_ADVERTISES_KEY,
+                                            local_endpoint_advertises_);
+        if (ResponseCode::SUCCESS != rc) {
+            local_endpoint_advertises_ = true;
+        }
+        
+        // Optional; MQTT 5 is only used by the built-in client, and only when asked for.
+        rc = util::JsonParser::GetBoolValue(sdk_config_json_, REMOTE_CORE_CONFIG_USE_MQTT_5_KEY, use_mqtt_5_);
+        if (ResponseCode::SUCCESS != rc) {
+            use_mqtt_5_ = false;
+        }
+        
+        rc = util::JsonParser::GetUint16Value(sdk_config_json_, REMOTE_CORE_CONFIG_MQTT_TOPIC_ALIAS_MAXIMUM_KEY,
+                                              mqtt_topic_alias_maximum_);
+        if (ResponseCode::SUCCESS != rc) {
+            mqtt_topic_alias_maximum_ = 8;
+        }
+        
+        // Zero keeps messages until they are delivered, however long that takes.
+        rc = util::JsonParser::GetUint32Value(sdk_config_json_, REMOTE_CORE_CONFIG_MQTT_MESSAGE_EXPIRY_INTERVAL_SECS_KEY, temp);
+        mqtt_message_expiry_interval_ = std::chrono::seconds(ResponseCode::SUCCESS == rc ? temp : 0);
+        
+        // Optional; without a path, the metrics are only published to the stats topic.
+        rc = util::JsonParser::GetStringValue(sdk_config_json_, REMOTE_CORE_CONFIG_METRICS_RELATIVE_PATH_KEY, temp_str);
+        if (ResponseCode::SUCCESS == rc && 0 != temp_str.length()) {
+            metrics_path_ = GetCurrentPath();
+            metrics_path_.append("/");
+            metrics_path_.append(temp_str);
+        } else {
+            metrics_path_.clear();
+        }
+        
+        // Zero disables exporting the metrics altogether.
+        rc = util::JsonParser::GetUint32Value(sdk_config_json_, REMOTE_CORE_CONFIG_METRICS_EXPORT_INTERVAL_SECS_KEY, temp);
+        metrics_export_interval_ = std::chrono::seconds(ResponseCode::SUCCESS == rc ? temp : 60);
+        
+        rc = util::JsonParser::GetBoolValue(sdk_config_json_, REMOTE_CORE_CONFIG_METRICS_PUBLISHES_STATS_KEY,
+                                            metrics_publishes_stats_);
+        if (ResponseCode::SUCCESS != rc) {
+            metrics_publishes_stats_ = true;
+        }
+        
         rc = util::JsonParser::GetStringValue(sdk_config_json_, REMOTE_CORE_CONFIG_SERIAL_NUMBER_KEY,
                                               serial_number_);
         if (ResponseCode::SUCCESS != rc) {
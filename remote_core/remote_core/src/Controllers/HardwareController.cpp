@@ -11,13 +11,18 @@
 #include <sys/stat.h>
 #include "HardwareController.hpp"
 #include "CommandLine.hpp"
+#include "MetricsRegistry.hpp"
+#include "FlightRecorder.hpp"
 
 #define REMOTE_CONFIGURATION_FILE_DIRECTORY "."
+#define REMOTE_LIBRARY_DIRECTORY "remotes/library"
 
 using namespace RemoteCore;
 
 HardwareController::HardwareController() {
-    
+    // Index the known remotes up front, so that identification only needs a lookup.
+    remoteLibrary = std::make_shared<RemoteLibrary>();
+    remoteLibrary->loadDirectory(REMOTE_LIBRARY_DIRECTORY);
 }
 
 bool HardwareController::doesRemoteExist(Remote &remote) {
@@ -31,9 +36,18 @@ void HardwareController::sendCommandForRemoteWithCompletionHandler(Command comma
                                                                    CompletionHandler completionHandler) {
     /* ***************** Send the command. ***************** */
     
+    auto &registry = MetricsRegistry::sharedRegistry();
+    static auto &sentCommands = registry.counter("remote_core_ir_sent_commands_total", "Commands that were sent through infrared.");
+    static auto &sendLatency = registry.histogram("remote_core_ir_send_latency_seconds", "Time taken to send a command through infrared.");
+    
+    REMOTE_CORE_TRACE_INSTANT("ir", "transmit", 0);
+    auto startTime = std::chrono::steady_clock::now();
     auto commandString = "irsend SEND_ONCE " + remote.getRemoteID() + " " + command.getCommandID();
     CommandLine::sharedCommandLine()->executeCommandWithResultHandler(commandString.c_str(), [=](std::string result, bool isComplete) {
         if (isComplete) {
+            REMOTE_CORE_TRACE_INSTANT("ir", "transmitted", 0);
+            sentCommands.increment();
+            sendLatency.recordSince(startTime);
             completionHandler(Error::None);
         }
     });
@@ -68,9 +82,19 @@ void HardwareController::sendCommandForRemoteWithCompletionHandler(Command comma
     // lircThread.detach();
 }
 
+DispatchFuture<Error> HardwareController::sendCommandForRemote(Command command, Remote remote) {
+    DispatchPromise<Error> promise;
+    sendCommandForRemoteWithCompletionHandler(command, remote, [promise](Error error) mutable {
+        promise.resolve(error);
+    });
+    
+    return promise.getFuture();
+}
+
 std::shared_ptr<TrainingSession> HardwareController::newTrainingSessionForRemote(Remote remote) {
     // Create a new training session.
     auto trainingSession = std::make_shared<TrainingSession>(remote);
+    trainingSession->setRemoteLibrary(remoteLibrary);
     
     // Keep the session identifier stored.
     sessionIDs.push_back(trainingSession->getSessionID());
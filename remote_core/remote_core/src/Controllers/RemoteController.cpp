@@ -12,51 +12,149 @@
 #include "Coder.hpp"
 #include "ConfigCommon.hpp"
 #include "CommandLine.hpp"
+#include "MetricsRegistry.hpp"
+#include "FlightRecorder.hpp"
 
 #define TOPIC_PREFIX "remote_core/account/"
 
 using namespace RemoteCore;
 using namespace awsiotsdk;
 
-RemoteController::RemoteController(const std::string &configFileRelativePath) {    
+std::string topicForDeviceWithUserID(Device device, std::string userID) {
+    return "remote_core/account/" + userID + "/" + device.getSerialNumber();
+}
+
+RemoteController::RemoteController(const std::string &configFileRelativePath) {
+    queue = std::make_unique<DispatchQueue>("ca.mooredev.remote_core.RemoteController.serial_dispatch_queue");
+    
     // Create a new connection manager.
     connectionManager = std::make_unique<ConnectionManager>(configFileRelativePath);
     
+    // Open the outbox, which is replayed whenever the connection is established.
+    if (ConfigCommon::outbox_path_.length() > 0) {
+        try {
+            auto outbox = std::make_unique<MessageOutbox>(ConfigCommon::outbox_path_, ConfigCommon::outbox_segment_size_bytes_, ConfigCommon::outbox_segment_count_);
+            auto publishFunction = [this](SharedBuffer payload, const std::string &topicName, OutboxPublisher::CompletionHandler completionHandler) {
+                connectionManager->publishMessageToTopic(std::move(payload), topicName, [completionHandler](awsiotsdk::ResponseCode responseCode) {
+                    completionHandler(responseCode == awsiotsdk::ResponseCode::SUCCESS);
+                });
+            };
+            
+            // Waiting for the reconnect interval keeps a flaky connection from causing a storm of retries.
+            outboxPublisher = std::make_unique<OutboxPublisher>(std::move(outbox), publishFunction, ConfigCommon::outbox_replay_batch_size_, ConfigCommon::minimum_reconnect_interval_);
+        } catch (const std::exception &exception) {
+            // Messages are still sent without an outbox, but are lost while disconnected.
+            std::cerr << "Unable to open the outbox: " << exception.what() << std::endl;
+        }
+    }
+    
+    connectionManager->setConnectionHandler([this](bool isConnected) {
+        if (outboxPublisher != nullptr) {
+            outboxPublisher->setConnected(isConnected);
+        }
+    });
+    
     // Create a new hardware controller.
     hardwareController = std::make_unique<HardwareController>();
     
     userID = "us-east-1:b75c8125-eebe-4b20-8454-67a5edda2359";
+    
+    if (ConfigCommon::metrics_export_interval_.count() > 0) {
+        MetricsExporter::PublishHandler publishHandler;
+        if (ConfigCommon::metrics_publishes_stats_) {
+            publishHandler = [this](std::string json) {
+                // Stats are not worth keeping while disconnected, since newer ones follow.
+                if (connectionManager->isConnected()) {
+                    auto topic = topicForDeviceWithUserID(Device::currentDevice(), userID) + "/stats";
+                    connectionManager->publishMessageToTopic(SharedBuffer(std::move(json)), topic, nullptr);
+                }
+            };
+        }
+        
+        metricsExporter = std::make_unique<MetricsExporter>(MetricsRegistry::sharedRegistry(), ConfigCommon::metrics_path_, ConfigCommon::metrics_export_interval_, publishHandler);
+    }
 }
 
-std::string topicForDeviceWithUserID(Device device, std::string userID) {
-    return "remote_core/account/" + userID + "/" + device.getSerialNumber();
+/**
+ Decodes the message, and returns null if it cannot be decoded, or if this device sent it.
+ */
+static std::unique_ptr<Message> decodeMessageFromOtherSender(const std::string &payload) {
+    auto &registry = MetricsRegistry::sharedRegistry();
+    static auto &decodedMessages = registry.counter("remote_core_coder_decoded_messages_total", "Messages that were decoded.");
+    static auto &decodeLatency = registry.histogram("remote_core_coder_decode_latency_seconds", "Time taken to parse and decode a message.");
+    
+    REMOTE_CORE_TRACE_SCOPE("message", "decode");
+    auto startTime = std::chrono::steady_clock::now();
+    auto container = std::make_unique<JSONContainer>(payload);
+    auto aCoder = std::make_unique<Coder>(std::move(container));
+    auto message = aCoder->decodeRootObject<Message>();
+    decodedMessages.increment();
+    decodeLatency.recordSince(startTime);
+    
+    // Filter out messages originating from this sender.
+    if (message == nullptr || message->getSenderID() == Device::currentDevice().getSerialNumber()) {
+        return nullptr;
+    }
+    
+    return message;
+}
+
+/**
+ Creates a response to the message, which is published to the topic the sender asked for, with the sender's correlation data, if the message was received with MQTT 5.
+ */
+static std::unique_ptr<Message> newResponseToMessage(const Message &message, MessageType type) {
+    auto responseMessage = std::make_unique<Message>(type);
+    responseMessage->responseTopic = message.responseTopic;
+    responseMessage->correlationData = message.correlationData;
+    return responseMessage;
 }
 
 void RemoteController::startController() {
     awsiotsdk::ResponseCode responseCode = connectionManager->resumeConnection();
     
-    // TODO: Remove after debug build.
-    std::cout << "Response code: " << responseCode << std::endl;
+    // The SDK's client reports an accepted connection rather than success.
+    bool isSuccessful = responseCode == awsiotsdk::ResponseCode::SUCCESS || responseCode == awsiotsdk::ResponseCode::MQTT_CONNACK_CONNECTION_ACCEPTED;
+    MetricsRegistry::sharedRegistry().counter("remote_core_connection_attempts_total", "Times the controller was started, by whether it connected.",
+                                              {{"result", isSuccessful ? "success" : "failure"}}).increment();
+    if (!isSuccessful) {
+        std::cerr << "Unable to connect: " << responseCode << std::endl;
+    }
     
     subscribeToDefaultTopic();
+    startLocalEndpoint();
+    
+    if (metricsExporter != nullptr) {
+        metricsExporter->start();
+    }
 }
 
 void RemoteController::stopController() {
+    if (metricsExporter != nullptr) {
+        metricsExporter->stop();
+    }
+    
     awsiotsdk::ResponseCode responseCode = connectionManager->suspendConnection();
     
-    // TODO: Remove from debug build.
-    std::cout << "Response code: " << responseCode << std::endl;
+    // Destroying the endpoint withdraws its advertisement.
+    std::atomic_store(&localEndpoint, std::shared_ptr<LocalEndpoint>());
+    
+    // Messages that were not sent are kept for the next start, even if the device loses power.
+    if (outboxPublisher != nullptr) {
+        outboxPublisher->getOutbox().synchronize();
+    }
+    
+    if (responseCode != awsiotsdk::ResponseCode::SUCCESS) {
+        std::cerr << "Unable to disconnect: " << responseCode << std::endl;
+    }
 }
 
 void RemoteController::subscribeToDefaultTopic(void) {
     auto topic = topicForDeviceWithUserID(Device::currentDevice(), userID);
-    connectionManager->subscribeToTopic(topic, [&](std::string topicName, std::string payload) {
-        auto container = std::make_unique<JSONContainer>(payload);
-        auto aCoder = std::make_unique<Coder>(std::move(container));
-        auto message = aCoder->decodeRootObject<Message>();
-        
-        // Filter out messages originating from this sender.
-        if (message != nullptr && message->getSenderID() != Device::currentDevice().getSerialNumber()) {
+    connectionManager->subscribeToTopic(topic, [this](std::string topicName, std::string payload, const MqttProperties &properties) {
+        auto message = decodeMessageFromOtherSender(payload);
+        if (message != nullptr) {
+            message->responseTopic = properties.responseTopic;
+            message->correlationData = properties.correlationData;
             this->handleMessage(std::move(message));
             return awsiotsdk::ResponseCode::SUCCESS;
         } else {
@@ -67,7 +165,56 @@ void RemoteController::subscribeToDefaultTopic(void) {
     });
 }
 
+void RemoteController::startLocalEndpoint(void) {
+    if (ConfigCommon::local_endpoint_port_ == 0 || std::atomic_load(&localEndpoint) != nullptr) {
+        return;
+    }
+    
+    // Any client on the network could otherwise connect, so the endpoint is neither started nor advertised.
+    if (ConfigCommon::local_endpoint_client_root_ca_path_.length() == 0) {
+        std::cerr << "Unable to start the local endpoint: no root certificate is configured to verify clients against." << std::endl;
+        return;
+    }
+    
+    auto device = Device::currentDevice();
+    
+    LocalEndpointOptions options;
+    options.port = ConfigCommon::local_endpoint_port_;
+    options.tlsConfiguration.certificatePath = ConfigCommon::local_endpoint_cert_path_;
+    options.tlsConfiguration.privateKeyPath = ConfigCommon::local_endpoint_key_path_;
+    options.tlsConfiguration.rootCAPath = ConfigCommon::local_endpoint_client_root_ca_path_;
+    options.tlsConfiguration.verifiesPeer = true;
+    options.tlsConfiguration.cipherPolicy = ConfigCommon::tls_cipher_policy_;
+    options.topicName = topicForDeviceWithUserID(device, userID);
+    
+    if (ConfigCommon::local_endpoint_advertises_) {
+        options.advertisement.instanceName = "Remote Core " + device.getSerialNumber();
+        options.advertisement.serviceType = LOCAL_ENDPOINT_SERVICE_TYPE;
+        options.advertisement.hostName = "remote-core-" + device.getSerialNumber();
+        options.advertisement.attributes["txtvers"] = "1";
+        options.advertisement.attributes["serial"] = device.getSerialNumber();
+    }
+    
+    try {
+        auto endpoint = std::make_shared<LocalEndpoint>(options, [this](const SharedBuffer &payload) {
+            auto data = payload.toString();
+            queue->execute([this, data]() {
+                auto message = decodeMessageFromOtherSender(data);
+                if (message != nullptr) {
+                    this->handleMessage(std::move(message));
+                }
+            });
+        });
+        
+        std::atomic_store(&localEndpoint, endpoint);
+    } catch (const std::exception &exception) {
+        // Phones still reach the device through the cloud.
+        std::cerr << "Unable to start the local endpoint: " << exception.what() << std::endl;
+    }
+}
+
 void RemoteController::handleMessage(std::unique_ptr<Message> message) {
+    REMOTE_CORE_TRACE_SCOPE("message", "dispatch");
     switch (message->getMessageType()) {
         case MessageType::Default:
             break;
@@ -89,7 +236,7 @@ void RemoteController::handleMessage(std::unique_ptr<Message> message) {
 void RemoteController::handleCommandMessage(std::unique_ptr<Message> message) {
     if (message->remote == nullptr || message->command == nullptr) {
         // Send a response message indicating the issue.
-        auto responseMessage = std::make_unique<Message>(MessageType::CommandResponse);
+        auto responseMessage = newResponseToMessage(*message, MessageType::CommandResponse);
         responseMessage->error = Error::InvalidParameters;
         this->sendMessage(std::move(responseMessage));
         
@@ -100,10 +247,12 @@ void RemoteController::handleCommandMessage(std::unique_ptr<Message> message) {
     Remote remote(*message->remote.get());
     Command command(*message->command.get());
     
-    // Send the command.
-    hardwareController->sendCommandForRemoteWithCompletionHandler(command, remote, [&, remote, command](Error error) {
+    // Send the command, and respond on the receiver's queue.
+    hardwareController->sendCommandForRemote(command, remote).then(*queue, [this, remote, command, responseTopic = message->responseTopic, correlationData = message->correlationData](Error error) {
         // Create a response message.
         auto responseMessage = std::make_unique<Message>(MessageType::CommandResponse);
+        responseMessage->responseTopic = responseTopic;
+        responseMessage->correlationData = correlationData;
         responseMessage->remote = std::make_unique<Remote>(remote);
         responseMessage->command = std::make_unique<Command>(command);
         responseMessage->error = error;
@@ -115,7 +264,7 @@ void RemoteController::handleCommandMessage(std::unique_ptr<Message> message) {
 
 void RemoteController::handleTrainingMessage(std::unique_ptr<Message> message) {
     // Create a response.
-    auto responseMessage = std::make_unique<Message>(MessageType::TrainingResponse);
+    auto responseMessage = newResponseToMessage(*message, MessageType::TrainingResponse);
     responseMessage->directive = message->directive;
     
     // Handle the message and the directives.
@@ -124,40 +273,54 @@ void RemoteController::handleTrainingMessage(std::unique_ptr<Message> message) {
     } else {
         responseMessage->remote = std::make_unique<Remote>(*message->remote.get());
         
-        if (message->directive == START_TRAINING_SESSION_DIRECTIVE) {
-            if (trainingSession == nullptr) {
-                trainingSession = hardwareController->newTrainingSessionForRemote(Remote(*message->remote.get()));
-                
-                trainingSession->setDelegate(shared_from_this());
-                hardwareController->startTrainingSession(trainingSession);
-            } else {
-                responseMessage->error = Error::TrainingAlreadyInSession;
-            }
-        } else if (message->directive == SUSPEND_TRAINING_SESSION_DIRECTIVE) {
-            if (trainingSession != nullptr) {
-                hardwareController->suspendTrainingSession(trainingSession);
-                trainingSession = nullptr;
-            }
-        } else if (message->directive == CREATE_COMMAND_DIRECTIVE) {
-            if (trainingSession != nullptr) {
-                auto localizedTitle = message->command == nullptr ? "" : message->command->getLocalizedTitle();
-                auto command = trainingSession->createCommandWithLocalizedTitle(localizedTitle);
-                responseMessage->command = std::make_unique<Command>(command);
-            } else {
-                responseMessage->error = Error::NoTrainingSession;
-            }
-        } else if (message->directive == LEARN_COMMAND_DIRECTIVE) {
-            if (trainingSession != nullptr) {
-                if (message->command != nullptr) {
-                    trainingSession->learnCommand(Command(*message->command.get()));
+        switch (directiveForName(message->directive)) {
+            case Directive::StartTrainingSession:
+                if (trainingSession == nullptr) {
+                    trainingSession = hardwareController->newTrainingSessionForRemote(Remote(*message->remote.get()));
+                    
+                    trainingSession->setDelegate(shared_from_this());
+                    hardwareController->startTrainingSession(trainingSession);
                 } else {
-                    responseMessage->error = Error::InvalidParameters;
+                    responseMessage->error = Error::TrainingAlreadyInSession;
                 }
-            } else {
-                responseMessage->error = Error::NoTrainingSession;
-            }
-        } else {
-            responseMessage->error = Error::InvalidDirective;
+                break;
+            case Directive::SuspendTrainingSession:
+                if (trainingSession != nullptr) {
+                    hardwareController->suspendTrainingSession(trainingSession);
+                    trainingSession = nullptr;
+                }
+                break;
+            case Directive::CreateCommandWithLocalizedTitle:
+                if (trainingSession != nullptr) {
+                    auto localizedTitle = message->command == nullptr ? "" : message->command->getLocalizedTitle();
+                    auto command = trainingSession->createCommandWithLocalizedTitle(localizedTitle);
+                    responseMessage->command = std::make_unique<Command>(command);
+                } else {
+                    responseMessage->error = Error::NoTrainingSession;
+                }
+                break;
+            case Directive::LearnCommand:
+                if (trainingSession != nullptr) {
+                    if (message->command != nullptr) {
+                        trainingSession->learnCommand(Command(*message->command.get()));
+                    } else {
+                        responseMessage->error = Error::InvalidParameters;
+                    }
+                } else {
+                    responseMessage->error = Error::NoTrainingSession;
+                }
+                break;
+            case Directive::IdentifyRemote:
+                if (trainingSession != nullptr) {
+                    trainingSession->identifyRemote();
+                } else {
+                    responseMessage->error = Error::NoTrainingSession;
+                }
+                break;
+            default:
+                // Unknown directives, and those that are only sent by the training session.
+                responseMessage->error = Error::InvalidDirective;
+                break;
         }
     }
     
@@ -170,58 +333,95 @@ void RemoteController::handleResponseMessage(std::unique_ptr<Message> message) {
 }
 
 void RemoteController::sendMessage(std::unique_ptr<Message> message) {
+    auto &registry = MetricsRegistry::sharedRegistry();
+    static auto &encodedMessages = registry.counter("remote_core_coder_encoded_messages_total", "Messages that were encoded.");
+    static auto &encodeLatency = registry.histogram("remote_core_coder_encode_latency_seconds", "Time taken to encode and serialize a message.");
+    
+    REMOTE_CORE_TRACE_SCOPE("message", "send");
+    auto startTime = std::chrono::steady_clock::now();
     auto container = std::make_unique<JSONContainer>();
     auto aCoder = std::make_unique<Coder>(std::move(container));
     aCoder->encodeRootObject(message.get());
     
     auto codedContainer = aCoder->invalidateCoder();
     
-    auto data = codedContainer->generateData();
+    SharedBuffer data(codedContainer->generateData());
+    encodedMessages.increment();
+    encodeLatency.recordSince(startTime);
+    
+    // A response the sender asked for is only published to its response topic. It is not kept in the outbox, since the sender gives up waiting for it once the connection is lost.
+    if (!message->responseTopic.empty()) {
+        MqttProperties properties;
+        properties.correlationData = message->correlationData;
+        connectionManager->publishMessageToTopic(std::move(data), message->responseTopic, properties, [](awsiotsdk::ResponseCode responseCode) {
+            
+        });
+        
+        return;
+    }
+    
     auto topic = topicForDeviceWithUserID(Device::currentDevice(), userID);
-    connectionManager->publishMessageToTopic(data, topic, [](awsiotsdk::ResponseCode responseCode) {
+    
+    // Phones on the same network receive the message directly, and again through the cloud, which they recognize by its message ID.
+    auto endpoint = std::atomic_load(&localEndpoint);
+    if (endpoint != nullptr) {
+        endpoint->publishMessage(SharedBuffer(data));
+    }
+    
+    // Every message passes through the outbox, so that messages are published in order, even after being kept while disconnected.
+    if (outboxPublisher != nullptr) {
+        outboxPublisher->publish(topic, std::move(data));
+        return;
+    }
+    
+    connectionManager->publishMessageToTopic(std::move(data), topic, [](awsiotsdk::ResponseCode responseCode) {
         
     });
 }
 
 // MARK: - Training Session Delegate
 
-void RemoteController::sendTrainingMessageForSession(TrainingSession *session, Command *command, std::string directive) {
+void RemoteController::sendTrainingMessageForSession(TrainingSession *session, Command *command, Directive directive) {
     auto message = std::make_unique<Message>(MessageType::Training);
     auto remote = session->getAssociatedRemote();
     message->remote = std::make_unique<Remote>(remote);
     if (command != nullptr) {
         message->command = std::make_unique<Command>(*command);
     }
-    message->directive = directive;
+    message->directive = nameForDirective(directive);
     
     sendMessage(std::move(message));
 }
 
 void RemoteController::trainingSessionDidBegin(TrainingSession *session) {
-    sendTrainingMessageForSession(session, nullptr, TRAINING_SESSION_DID_BEGIN_DIRECTIVE);
+    sendTrainingMessageForSession(session, nullptr, Directive::TrainingSessionDidBegin);
 }
 
 void RemoteController::trainingSessionDidFailWithError(TrainingSession *session, Error error) {
-    sendTrainingMessageForSession(session, nullptr, TRAINING_SESSION_DID_FAIL_WITH_ERROR_DIRECTIVE);
+    sendTrainingMessageForSession(session, nullptr, Directive::TrainingSessionDidFailWithError);
 }
 
 void RemoteController::trainingSessionWillLearnCommand(TrainingSession *session, Command command) {
-    sendTrainingMessageForSession(session, &command, TRAINING_SESSION_WILL_LEARN_COMMAND_DIRECTIVE);
+    sendTrainingMessageForSession(session, &command, Directive::TrainingSessionWillLearnCommand);
 }
 
 void RemoteController::trainingSessionDidLearnCommand(TrainingSession *session, Command command) {
-    sendTrainingMessageForSession(session, &command, TRAINING_SESSION_DID_LEARN_COMMAND_DIRECTIVE);
+    sendTrainingMessageForSession(session, &command, Directive::TrainingSessionDidLearnCommand);
+}
+
+void RemoteController::trainingSessionDidIdentifyRemote(TrainingSession *session, Remote remote) {
+    sendTrainingMessageForSession(session, nullptr, Directive::TrainingSessionDidIdentifyRemote);
 }
 
 void RemoteController::trainingSessionDidRequestInclusiveArbitraryInput(TrainingSession *session) {
-    sendTrainingMessageForSession(session, nullptr, TRAINING_SESSION_DID_REQUEST_INCLUSIVE_ARBITRARY_INPUT_DIRECTIVE);
+    sendTrainingMessageForSession(session, nullptr, Directive::TrainingSessionDidRequestInclusiveArbitraryInput);
 }
 
 void RemoteController::trainingSessionDidRequestInputForCommand(TrainingSession *session, Command command) {
-    sendTrainingMessageForSession(session, &command, TRAINING_SESSION_DID_REQUEST_INPUT_FOR_COMMAND_DIRECTIVE);
+    sendTrainingMessageForSession(session, &command, Directive::TrainingSessionDidRequestInputForCommand);
 }
 
 void RemoteController::trainingSessionDidRequestExclusiveArbitraryInput(TrainingSession *session) {
-    sendTrainingMessageForSession(session, nullptr, TRAINING_SESSION_DID_REQUEST_EXCLUSIVE_ARBITRARY_INPUT_DIRECTIVE);
+    sendTrainingMessageForSession(session, nullptr, Directive::TrainingSessionDidRequestExclusiveArbitraryInput);
 }
 
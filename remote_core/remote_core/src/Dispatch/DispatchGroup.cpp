@@ -0,0 +1,69 @@
+//
+//  DispatchGroup.cpp
+//  remote_core
+//
+//  Created by David Moore on 10/19/26.
+//  Copyright © 2026 David Moore. All rights reserved.
+//
+
+#include "DispatchGroup.hpp"
+#include "DispatchQueue.hpp"
+#include <stdexcept>
+
+using namespace RemoteCore;
+
+DispatchGroup::DispatchGroup() : state(std::make_shared<State>()) {
+}
+
+void DispatchGroup::enter(void) {
+    std::lock_guard<std::mutex> lock(state->mutex);
+    state->pendingCount++;
+}
+
+void DispatchGroup::leave(void) {
+    std::vector<std::pair<DispatchQueue *, DispatchTask>> notifications;
+    {
+        std::lock_guard<std::mutex> lock(state->mutex);
+        if (state->pendingCount == 0) {
+            throw std::logic_error("Expected 'leave' to be balanced with a call to 'enter'.");
+        }
+        
+        if (--state->pendingCount > 0) {
+            return;
+        }
+        
+        notifications.swap(state->notifications);
+        state->condition.notify_all();
+    }
+    
+    // Executed outside of the lock, since a notification may enter the group again.
+    for (auto &notification : notifications) {
+        notification.first->execute(std::move(notification.second));
+    }
+}
+
+void DispatchGroup::wait(void) {
+    std::unique_lock<std::mutex> lock(state->mutex);
+    state->condition.wait(lock, [this]() {
+        return state->pendingCount == 0;
+    });
+}
+
+bool DispatchGroup::waitFor(std::chrono::milliseconds timeout) {
+    std::unique_lock<std::mutex> lock(state->mutex);
+    return state->condition.wait_for(lock, timeout, [this]() {
+        return state->pendingCount == 0;
+    });
+}
+
+void DispatchGroup::enqueueNotification(DispatchQueue &queue, DispatchTask task) {
+    {
+        std::lock_guard<std::mutex> lock(state->mutex);
+        if (state->pendingCount > 0) {
+            state->notifications.emplace_back(&queue, std::move(task));
+            return;
+        }
+    }
+    
+    queue.execute(std::move(task));
+}
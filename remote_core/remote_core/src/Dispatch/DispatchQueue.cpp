@@ -7,62 +7,278 @@
 //
 
 #include "DispatchQueue.hpp"
+#include <algorithm>
+#include <atomic>
+
+/// Number of blocks a serial queue runs before yielding its pool thread to other queues.
+#define DISPATCH_QUEUE_DRAIN_BATCH_SIZE 16
+
+/// Number of statistics shards per queue. Threads are spread across the shards, so that they rarely record into the same one.
+#define DISPATCH_QUEUE_STATISTICS_SHARD_COUNT 8
 
 using namespace RemoteCore;
 
-DispatchQueue::DispatchQueue(std::string name, size_t threadCount) : name(name), threads(threadCount) {
-    // Initialize the threads.
-    for (size_t i = 0; i < threads.size(); i++) {
-        threads[i] = std::thread(std::bind(&DispatchQueue::threadHandler, this));
+namespace {
+    /// Every queue that currently exists, so that their statistics can be read together.
+    struct QueueRegistry {
+        std::mutex mutex;
+        std::vector<DispatchQueue *> queues;
+    };
+    
+    /// Never destroyed, since queues with static storage duration may outlive any other static.
+    QueueRegistry &queueRegistry(void) {
+        static QueueRegistry *registry = new QueueRegistry();
+        return *registry;
+    }
+    
+    std::atomic<size_t> nextShardIndex(0);
+    
+    size_t currentShardIndex(void) {
+        thread_local size_t shardIndex = nextShardIndex++ % DISPATCH_QUEUE_STATISTICS_SHARD_COUNT;
+        return shardIndex;
+    }
+    
+    inline uint64_t microsecondsForDuration(TimerWheel::Clock::duration duration) {
+        return (uint64_t)std::max<TimerWheel::Clock::rep>(std::chrono::duration_cast<std::chrono::microseconds>(duration).count(), 0);
+    }
+}
+
+DispatchQueue::DispatchQueue(std::string name, size_t threadCount, bool mayBlock) : name(name), threadCount(std::max<size_t>(threadCount, 1)), drainerCount(0), runningBlockCount(0), isBarrierRunning(false), creationTime(TimerWheel::Clock::now()), enqueuedBlockCount(0), maximumDepth(0), statisticsShards(new StatisticsShard[DISPATCH_QUEUE_STATISTICS_SHARD_COUNT]) {
+    timerTarget = std::make_shared<TimerTarget>();
+    timerTarget->queue = this;
+    setLongRunningBlockThreshold(DISPATCH_QUEUE_DEFAULT_LONG_RUNNING_THRESHOLD);
+    
+    if (this->threadCount > 1 || mayBlock) {
+        privatePool = std::make_unique<WorkStealingPool>(name, this->threadCount);
+        pool = privatePool.get();
+    } else {
+        pool = WorkStealingPool::sharedPool();
     }
+    
+    auto &registry = queueRegistry();
+    std::lock_guard<std::mutex> lock(registry.mutex);
+    registry.queues.push_back(this);
 }
 
 DispatchQueue::~DispatchQueue() {
-    // Signal the dispatch threads to finish.
-    shouldQuit = true;
-    threadCondition.notify_all();
-    
-    // Join threads to allow for work to be completed.
-    for (size_t i = 0; i < threads.size(); i++) {
-        auto &thread = threads[i];
-        if (thread.joinable()) {
-            thread.join();
+    {
+        auto &registry = queueRegistry();
+        std::lock_guard<std::mutex> lock(registry.mutex);
+        registry.queues.erase(std::remove(registry.queues.begin(), registry.queues.end(), this), registry.queues.end());
+    }
+    
+    // Detach from the timers first, so that none of them can execute a block once the queue has drained.
+    {
+        std::lock_guard<std::mutex> lock(timerTarget->mutex);
+        timerTarget->queue = nullptr;
+    }
+    
+    std::unique_lock<std::mutex> lock(queueMutex);
+    drainCondition.wait(lock, [this]() {
+        return drainerCount == 0 && blockQueue.empty();
+    });
+}
+
+void DispatchQueue::enqueue(DispatchTask task, bool isBarrier) {
+    auto enqueueTime = TimerWheel::Clock::now();
+    
+    size_t newDrainerCount;
+    {
+        std::lock_guard<std::mutex> lock(queueMutex);
+        blockQueue.push_back({std::move(task), isBarrier, enqueueTime});
+        enqueuedBlockCount++;
+        maximumDepth = std::max(maximumDepth, blockQueue.size());
+        newDrainerCount = reserveDrainers();
+    }
+    
+    startDrainers(newDrainerCount);
+}
+
+bool DispatchQueue::canStartNextBlock(void) const {
+    if (blockQueue.empty() || isBarrierRunning) {
+        return false;
+    }
+    
+    // Barriers wait for every block ahead of them to complete.
+    return !blockQueue.front().isBarrier || runningBlockCount == 0;
+}
+
+size_t DispatchQueue::reserveDrainers(void) {
+    if (!canStartNextBlock()) {
+        return 0;
+    }
+    
+    // Each drainer runs one block at a time, so the queue's width is bounded by the number of drainers (i.e., one for serial queues).
+    size_t wantedDrainerCount = std::min(threadCount, runningBlockCount + blockQueue.size());
+    if (wantedDrainerCount <= drainerCount) {
+        return 0;
+    }
+    
+    size_t newDrainerCount = wantedDrainerCount - drainerCount;
+    drainerCount = wantedDrainerCount;
+    
+    return newDrainerCount;
+}
+
+void DispatchQueue::startDrainers(size_t count, bool isYielding) {
+    for (size_t i = 0; i < count; i++) {
+        if (isYielding) {
+            pool->yield([this]() {
+                this->drain();
+            });
+        } else {
+            pool->submit([this]() {
+                this->drain();
+            });
         }
     }
 }
 
-void DispatchQueue::threadHandler() {
-    // Aquire the lock.
+void DispatchQueue::drain(void) {
     std::unique_lock<std::mutex> lock(queueMutex);
-    
-    do {
-        // Wait until we have the data.
-        threadCondition.wait(lock, [this]() {
-            return blockQueue.size() || shouldQuit;
-        });
+    for (size_t i = 0; i < DISPATCH_QUEUE_DRAIN_BATCH_SIZE && canStartNextBlock(); i++) {
+        QueuedBlock block = std::move(blockQueue.front());
+        blockQueue.pop_front();
+        
+        runningBlockCount++;
+        isBarrierRunning = block.isBarrier;
+        lock.unlock();
+        
+        auto startTime = TimerWheel::Clock::now();
+        block.task();
+        block.task.reset();
+        recordBlock(startTime - block.enqueueTime, TimerWheel::Clock::now() - startTime);
         
-        // After waiting, we now own the lock.
-        if (blockQueue.size()) {
-            auto block = std::move(blockQueue.front());
-            blockQueue.pop();
+        lock.lock();
+        runningBlockCount--;
+        if (block.isBarrier) {
+            isBarrierRunning = false;
             
-            // Unlock, since we're finished with the block queue.
+            // Blocks that were held back by the barrier may now run alongside this drainer.
+            size_t newDrainerCount = reserveDrainers();
             lock.unlock();
-            
-            // Execute the block.
-            block();
-            
-            // Aquire a lock again.
+            startDrainers(newDrainerCount);
             lock.lock();
         }
-    } while (!shouldQuit);
+    }
+    
+    // Yield, so that a busy queue does not starve the others sharing the pool. A replacement drainer is started behind the other queues' work if there is still work to do.
+    drainerCount--;
+    size_t newDrainerCount = reserveDrainers();
+    if (drainerCount == 0) {
+        drainCondition.notify_all();
+    }
+    
+    lock.unlock();
+    startDrainers(newDrainerCount, true);
 }
 
-void DispatchQueue::execute(Block block) {
-    std::unique_lock<std::mutex> lock(queueMutex);
-    blockQueue.push(block);
+void DispatchQueue::recordBlock(TimerWheel::Clock::duration waitTime, TimerWheel::Clock::duration executionTime) {
+    auto &shard = statisticsShards[currentShardIndex()];
+    shard.waitTime.record(microsecondsForDuration(waitTime));
+    shard.executionTime.record(microsecondsForDuration(executionTime));
+    shard.completedBlockCount.fetch_add(1, std::memory_order_relaxed);
     
-    // Unlock before notifying the threads.
-    lock.unlock();
-    threadCondition.notify_all();
+    if (executionTime.count() > longRunningBlockThreshold.load(std::memory_order_relaxed)) {
+        shard.longRunningBlockCount.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+DispatchQueueStatistics DispatchQueue::getStatistics(void) {
+    DispatchQueueStatistics statistics;
+    statistics.name = name;
+    statistics.uptime = std::chrono::duration_cast<std::chrono::microseconds>(TimerWheel::Clock::now() - creationTime);
+    
+    {
+        std::lock_guard<std::mutex> lock(queueMutex);
+        statistics.enqueuedBlockCount = enqueuedBlockCount;
+        statistics.currentDepth = blockQueue.size();
+        statistics.maximumDepth = maximumDepth;
+    }
+    
+    for (size_t i = 0; i < DISPATCH_QUEUE_STATISTICS_SHARD_COUNT; i++) {
+        auto &shard = statisticsShards[i];
+        shard.waitTime.mergeInto(statistics.waitTime);
+        shard.executionTime.mergeInto(statistics.executionTime);
+        statistics.completedBlockCount += shard.completedBlockCount.load(std::memory_order_relaxed);
+        statistics.longRunningBlockCount += shard.longRunningBlockCount.load(std::memory_order_relaxed);
+    }
+    
+    return statistics;
+}
+
+std::vector<DispatchQueueStatistics> DispatchQueue::statisticsForAllQueues(void) {
+    auto &registry = queueRegistry();
+    std::lock_guard<std::mutex> lock(registry.mutex);
+    
+    std::vector<DispatchQueueStatistics> statistics;
+    for (auto queue : registry.queues) {
+        statistics.push_back(queue->getStatistics());
+    }
+    
+    return statistics;
+}
+
+DispatchTimer DispatchQueue::scheduleTimer(TimerWheel::Clock::time_point deadline, DispatchTask task) {
+    std::weak_ptr<TimerTarget> weakTarget = timerTarget;
+    
+    return TimerWheel::sharedTimerWheel()->schedule(deadline, [weakTarget, task = std::move(task)]() mutable {
+        auto target = weakTarget.lock();
+        if (target == nullptr) {
+            return;
+        }
+        
+        std::lock_guard<std::mutex> lock(target->mutex);
+        if (target->queue != nullptr) {
+            target->queue->enqueue(std::move(task), false);
+        }
+    });
+}
+
+void DispatchQueue::apply(size_t iterationCount, std::function<void (size_t iteration)> block) {
+    struct ApplyState {
+        std::function<void (size_t)> block;
+        size_t iterationCount;
+        std::atomic<size_t> nextIteration;
+        std::atomic<size_t> completedIterationCount;
+        std::mutex mutex;
+        std::condition_variable condition;
+        
+        void run(void) {
+            size_t iteration;
+            while ((iteration = nextIteration++) < iterationCount) {
+                block(iteration);
+                
+                if (++completedIterationCount == iterationCount) {
+                    std::lock_guard<std::mutex> lock(mutex);
+                    condition.notify_all();
+                }
+            }
+        }
+    };
+    
+    if (iterationCount == 0) {
+        return;
+    }
+    
+    // Helpers that start after the loop has finished find no iterations left, so they share ownership of the state.
+    auto state = std::make_shared<ApplyState>();
+    state->block = std::move(block);
+    state->iterationCount = iterationCount;
+    state->nextIteration = 0;
+    state->completedIterationCount = 0;
+    
+    size_t helperCount = std::min(threadCount, iterationCount) - 1;
+    for (size_t i = 0; i < helperCount; i++) {
+        execute([state]() {
+            state->run();
+        });
+    }
+    
+    state->run();
+    
+    std::unique_lock<std::mutex> lock(state->mutex);
+    state->condition.wait(lock, [&state]() {
+        return state->completedIterationCount.load() == state->iterationCount;
+    });
 }
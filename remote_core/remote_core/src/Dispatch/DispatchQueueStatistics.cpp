@@ -0,0 +1,118 @@
+//
+//  DispatchQueueStatistics.cpp
+//  remote_core
+//
+//  Created by David Moore on 10/19/26.
+//  Copyright © 2026 David Moore. All rights reserved.
+//
+
+#include "DispatchQueueStatistics.hpp"
+#include <algorithm>
+#include <cmath>
+
+using namespace RemoteCore;
+
+constexpr size_t LatencyHistogram::bucketCount;
+
+// MARK: - Latency Histogram
+
+size_t LatencyHistogram::bucketForDuration(uint64_t microseconds) {
+    if (microseconds == 0) {
+        return 0;
+    }
+    
+    size_t bucket = 64 - __builtin_clzll(microseconds);
+    return std::min(bucket, bucketCount - 1);
+}
+
+void LatencyHistogram::record(uint64_t microseconds) {
+    buckets[bucketForDuration(microseconds)]++;
+    count++;
+    totalMicroseconds += microseconds;
+    maximumMicroseconds = std::max(maximumMicroseconds, microseconds);
+}
+
+void LatencyHistogram::merge(const LatencyHistogram &histogram) {
+    for (size_t i = 0; i < bucketCount; i++) {
+        buckets[i] += histogram.buckets[i];
+    }
+    
+    count += histogram.count;
+    totalMicroseconds += histogram.totalMicroseconds;
+    maximumMicroseconds = std::max(maximumMicroseconds, histogram.maximumMicroseconds);
+}
+
+std::chrono::microseconds LatencyHistogram::getMean(void) const {
+    return std::chrono::microseconds(count == 0 ? 0 : totalMicroseconds / count);
+}
+
+std::chrono::microseconds LatencyHistogram::getPercentile(double percentile) const {
+    if (count == 0) {
+        return std::chrono::microseconds(0);
+    }
+    
+    uint64_t rank = (uint64_t)std::ceil(std::min(std::max(percentile, 0.0), 1.0) * count);
+    uint64_t cumulativeCount = 0;
+    for (size_t i = 0; i < bucketCount; i++) {
+        cumulativeCount += buckets[i];
+        if (cumulativeCount >= rank && buckets[i] > 0) {
+            // The upper bound of the bucket, which never exceeds the largest recorded duration.
+            uint64_t upperBound = i == 0 ? 0 : ((uint64_t)1 << i) - 1;
+            return std::chrono::microseconds(std::min(upperBound, maximumMicroseconds));
+        }
+    }
+    
+    return std::chrono::microseconds(maximumMicroseconds);
+}
+
+// MARK: - Atomic Latency Histogram
+
+AtomicLatencyHistogram::AtomicLatencyHistogram() : totalMicroseconds(0), maximumMicroseconds(0) {
+    for (auto &bucket : buckets) {
+        bucket.store(0, std::memory_order_relaxed);
+    }
+}
+
+void AtomicLatencyHistogram::record(uint64_t microseconds) {
+    // Samples are only ever summed, so no ordering is required.
+    buckets[LatencyHistogram::bucketForDuration(microseconds)].fetch_add(1, std::memory_order_relaxed);
+    totalMicroseconds.fetch_add(microseconds, std::memory_order_relaxed);
+    
+    uint64_t maximum = maximumMicroseconds.load(std::memory_order_relaxed);
+    while (microseconds > maximum && !maximumMicroseconds.compare_exchange_weak(maximum, microseconds, std::memory_order_relaxed)) {
+    }
+}
+
+void AtomicLatencyHistogram::mergeInto(LatencyHistogram &histogram) const {
+    for (size_t i = 0; i < LatencyHistogram::bucketCount; i++) {
+        uint64_t bucketCount = buckets[i].load(std::memory_order_relaxed);
+        histogram.buckets[i] += bucketCount;
+        histogram.count += bucketCount;
+    }
+    
+    histogram.totalMicroseconds += totalMicroseconds.load(std::memory_order_relaxed);
+    histogram.maximumMicroseconds = std::max(histogram.maximumMicroseconds, maximumMicroseconds.load(std::memory_order_relaxed));
+}
+
+// MARK: - Dispatch Queue Statistics
+
+double DispatchQueueStatistics::getEnqueueRate(void) const {
+    return uptime.count() == 0 ? 0 : enqueuedBlockCount / (uptime.count() / 1e6);
+}
+
+std::ostream &RemoteCore::operator<<(std::ostream &stream, const DispatchQueueStatistics &statistics) {
+    stream << statistics.name
+           << " enqueued=" << statistics.enqueuedBlockCount
+           << " completed=" << statistics.completedBlockCount
+           << " rate=" << statistics.getEnqueueRate() << "/s"
+           << " depth=" << statistics.currentDepth << "/" << statistics.maximumDepth
+           << " wait_p50=" << statistics.waitTime.getPercentile(0.5).count() << "us"
+           << " wait_p99=" << statistics.waitTime.getPercentile(0.99).count() << "us"
+           << " wait_max=" << statistics.waitTime.maximumMicroseconds << "us"
+           << " exec_p50=" << statistics.executionTime.getPercentile(0.5).count() << "us"
+           << " exec_p99=" << statistics.executionTime.getPercentile(0.99).count() << "us"
+           << " exec_max=" << statistics.executionTime.maximumMicroseconds << "us"
+           << " long_running=" << statistics.longRunningBlockCount;
+    
+    return stream;
+}
@@ -0,0 +1,59 @@
+//
+//  DispatchStatisticsMonitor.cpp
+//  remote_core
+//
+//  Created by David Moore on 10/19/26.
+//  Copyright © 2026 David Moore. All rights reserved.
+//
+
+#include "DispatchStatisticsMonitor.hpp"
+
+using namespace RemoteCore;
+
+DispatchStatisticsMonitor::DispatchStatisticsMonitor(std::ostream &stream, std::chrono::milliseconds interval) : stream(stream), interval(interval), isRunning(false) {
+    queue = std::make_unique<DispatchQueue>("ca.mooredev.remote_core.DispatchStatisticsMonitor.serial_dispatch_queue");
+}
+
+DispatchStatisticsMonitor::~DispatchStatisticsMonitor() {
+    stop();
+    
+    // Destroying the queue waits for an in-progress dump.
+    queue = nullptr;
+}
+
+void DispatchStatisticsMonitor::start(void) {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (isRunning) {
+        return;
+    }
+    
+    isRunning = true;
+    scheduleDump();
+}
+
+void DispatchStatisticsMonitor::stop(void) {
+    std::lock_guard<std::mutex> lock(mutex);
+    isRunning = false;
+    timer.cancel();
+}
+
+void DispatchStatisticsMonitor::scheduleDump(void) {
+    timer = queue->executeAfter(interval, [this]() {
+        this->dump();
+        
+        std::lock_guard<std::mutex> lock(mutex);
+        if (isRunning) {
+            scheduleDump();
+        }
+    });
+}
+
+void DispatchStatisticsMonitor::dump(void) {
+    queue->execute([this]() {
+        for (auto &statistics : DispatchQueue::statisticsForAllQueues()) {
+            stream << "[dispatch] " << statistics << "\n";
+        }
+        
+        stream.flush();
+    });
+}
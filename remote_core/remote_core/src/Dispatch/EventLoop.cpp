@@ -0,0 +1,483 @@
+//
+//  EventLoop.cpp
+//  remote_core
+//
+//  Created by David Moore on 10/19/26.
+//  Copyright © 2026 David Moore. All rights reserved.
+//
+
+#include "EventLoop.hpp"
+#include <cerrno>
+#include <system_error>
+#include <fcntl.h>
+#include <poll.h>
+#include <pthread.h>
+#include <unistd.h>
+
+#ifdef __linux__
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/signalfd.h>
+#include <sys/timerfd.h>
+#endif
+
+/// Maximum number of events that are handled for each wait.
+#define EVENT_LOOP_MAXIMUM_EVENT_COUNT 16
+
+using namespace RemoteCore;
+
+namespace {
+    void throwSystemError(const char *operation) {
+        throw std::system_error(errno, std::system_category(), operation);
+    }
+
+#ifndef __linux__
+    /// Write end of the pipe that signals are forwarded to. Signal handlers can only reach globals.
+    volatile sig_atomic_t signalPipeWriteFD = -1;
+    
+    void forwardSignal(int signal) {
+        int savedErrno = errno;
+        unsigned char value = (unsigned char)signal;
+        if (write(signalPipeWriteFD, &value, sizeof(value)) < 0) {
+            // Nothing can be done from a signal handler; the signal is lost.
+        }
+        
+        errno = savedErrno;
+    }
+    
+    void createPipe(int &readFD, int &writeFD) {
+        int fds[2];
+        if (pipe(fds) != 0) {
+            throwSystemError("pipe");
+        }
+        
+        for (int fd : fds) {
+            fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+            fcntl(fd, F_SETFD, FD_CLOEXEC);
+        }
+        
+        readFD = fds[0];
+        writeFD = fds[1];
+    }
+#endif
+}
+
+EventLoop::EventLoop() : shouldStop(false), pollFD(-1), wakeFD(-1), wakeWriteFD(-1), timerFD(-1), signalFD(-1), nextTimerIdentifier(1) {
+    sigemptyset(&signalMask);
+
+#ifdef __linux__
+    pollFD = epoll_create1(EPOLL_CLOEXEC);
+    if (pollFD < 0) {
+        throwSystemError("epoll_create1");
+    }
+    
+    wakeFD = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    wakeWriteFD = wakeFD;
+    if (wakeFD < 0) {
+        throwSystemError("eventfd");
+    }
+    
+    timerFD = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+    if (timerFD < 0) {
+        throwSystemError("timerfd_create");
+    }
+    
+    updateDescriptor(wakeFD, Readable, true);
+    updateDescriptor(timerFD, Readable, true);
+#else
+    createPipe(wakeFD, wakeWriteFD);
+#endif
+}
+
+EventLoop::~EventLoop() {
+    for (int fd : {pollFD, wakeFD, timerFD, signalFD}) {
+        if (fd >= 0) {
+            close(fd);
+        }
+    }
+
+#ifndef __linux__
+    close(wakeWriteFD);
+#endif
+}
+
+// MARK: - Registration
+
+void EventLoop::addSignalHandler(int signal, SignalHandler handler) {
+    std::lock_guard<std::mutex> lock(mutex);
+    signalHandlers[signal] = std::make_shared<SignalHandler>(handler);
+
+#ifdef __linux__
+    // Blocked signals are only delivered through the signal descriptor.
+    sigset_t blockedSignals;
+    sigemptyset(&blockedSignals);
+    sigaddset(&blockedSignals, signal);
+    pthread_sigmask(SIG_BLOCK, &blockedSignals, nullptr);
+    
+    sigaddset(&signalMask, signal);
+    bool isNew = signalFD < 0;
+    signalFD = signalfd(signalFD, &signalMask, SFD_NONBLOCK | SFD_CLOEXEC);
+    if (signalFD < 0) {
+        throwSystemError("signalfd");
+    }
+    
+    if (isNew) {
+        updateDescriptor(signalFD, Readable, true);
+    }
+#else
+    if (signalFD < 0) {
+        int writeFD;
+        createPipe(signalFD, writeFD);
+        signalPipeWriteFD = writeFD;
+    }
+    
+    struct sigaction action = {};
+    action.sa_handler = &forwardSignal;
+    sigemptyset(&action.sa_mask);
+    action.sa_flags = SA_RESTART;
+    sigaction(signal, &action, nullptr);
+    
+    wake();
+#endif
+}
+
+EventLoop::TimerIdentifier EventLoop::addTimer(std::chrono::milliseconds interval, bool repeats, Handler handler) {
+    std::lock_guard<std::mutex> lock(mutex);
+    
+    TimerIdentifier identifier = nextTimerIdentifier++;
+    auto deadline = Clock::now() + interval;
+    bool isEarliest = deadline < nextDeadline();
+    
+    timers[identifier] = {deadline, interval, repeats, std::make_shared<Handler>(handler)};
+    timerDeadlines.emplace(deadline, identifier);
+    
+    if (isEarliest) {
+        armTimer();
+    }
+    
+    return identifier;
+}
+
+void EventLoop::removeTimer(TimerIdentifier identifier) {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto position = timers.find(identifier);
+    if (position == timers.end()) {
+        return;
+    }
+    
+    removeDeadline(identifier, position->second.deadline);
+    
+    // The timer descriptor is left armed; waking up early is harmless.
+    timers.erase(position);
+}
+
+void EventLoop::addDescriptor(int fd, uint32_t events, DescriptorHandler handler) {
+    std::lock_guard<std::mutex> lock(mutex);
+    bool isNew = descriptorHandlers.find(fd) == descriptorHandlers.end();
+    descriptorHandlers[fd] = std::make_pair(events, std::make_shared<DescriptorHandler>(handler));
+    
+    updateDescriptor(fd, events, isNew);
+}
+
+void EventLoop::removeDescriptor(int fd) {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (descriptorHandlers.erase(fd) == 0) {
+        return;
+    }
+
+#ifdef __linux__
+    epoll_ctl(pollFD, EPOLL_CTL_DEL, fd, nullptr);
+#else
+    wake();
+#endif
+}
+
+void EventLoop::updateDescriptor(int fd, uint32_t events, bool isNew) {
+#ifdef __linux__
+    struct epoll_event event = {};
+    event.events = ((events & Readable) ? EPOLLIN : 0) | ((events & Writable) ? EPOLLOUT : 0);
+    event.data.fd = fd;
+    
+    if (epoll_ctl(pollFD, isNew ? EPOLL_CTL_ADD : EPOLL_CTL_MOD, fd, &event) != 0) {
+        throwSystemError("epoll_ctl");
+    }
+#else
+    // The descriptors are gathered again for every poll.
+    wake();
+#endif
+}
+
+void EventLoop::execute(Handler handler) {
+    bool shouldWake;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        
+        // The loop drains every posted handler for each wakeup, so only the first one needs to wake it.
+        shouldWake = postedHandlers.empty();
+        postedHandlers.push_back(std::move(handler));
+    }
+    
+    if (shouldWake) {
+        wake();
+    }
+}
+
+void EventLoop::stop(void) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        shouldStop = true;
+    }
+    
+    wake();
+}
+
+// MARK: - Running
+
+void EventLoop::run(void) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        loopThread = std::this_thread::get_id();
+    }
+    
+    while (true) {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (shouldStop) {
+                shouldStop = false;
+                loopThread = std::thread::id();
+                break;
+            }
+        }
+        
+        waitForEvents();
+    }
+}
+
+void EventLoop::wake(void) {
+#ifdef __linux__
+    uint64_t value = 1;
+#else
+    unsigned char value = 0;
+#endif
+
+    // A full pipe (or counter) already guarantees a wakeup.
+    if (write(wakeWriteFD, &value, sizeof(value)) < 0 && errno != EAGAIN) {
+        throwSystemError("write");
+    }
+}
+
+void EventLoop::drainWakeups(void) {
+    uint64_t buffer[8];
+    while (read(wakeFD, buffer, sizeof(buffer)) > 0) {
+    }
+}
+
+void EventLoop::runPostedHandlers(void) {
+    std::vector<Handler> handlers;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        handlers.swap(postedHandlers);
+    }
+    
+    for (auto &handler : handlers) {
+        handler();
+    }
+}
+
+EventLoop::Clock::time_point EventLoop::nextDeadline(void) const {
+    return timerDeadlines.empty() ? Clock::time_point::max() : timerDeadlines.begin()->first;
+}
+
+void EventLoop::armTimer(void) {
+#ifdef __linux__
+    struct itimerspec specification = {};
+    auto deadline = nextDeadline();
+    if (deadline != Clock::time_point::max()) {
+        // The steady clock is the monotonic clock, and a zero value would disarm the timer.
+        auto nanoseconds = std::max<int64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(deadline.time_since_epoch()).count(), 1);
+        specification.it_value.tv_sec = (time_t)(nanoseconds / 1000000000);
+        specification.it_value.tv_nsec = (long)(nanoseconds % 1000000000);
+    }
+    
+    timerfd_settime(timerFD, TFD_TIMER_ABSTIME, &specification, nullptr);
+#else
+    // The poll timeout is derived from the next deadline after every wakeup, so only other threads need to wake the loop.
+    if (std::this_thread::get_id() != loopThread) {
+        wake();
+    }
+#endif
+}
+
+void EventLoop::removeDeadline(TimerIdentifier identifier, Clock::time_point deadline) {
+    auto range = timerDeadlines.equal_range(deadline);
+    for (auto position = range.first; position != range.second; position++) {
+        if (position->second == identifier) {
+            timerDeadlines.erase(position);
+            break;
+        }
+    }
+}
+
+void EventLoop::runExpiredTimers(void) {
+#ifdef __linux__
+    uint64_t expirationCount;
+    while (read(timerFD, &expirationCount, sizeof(expirationCount)) > 0) {
+    }
+#endif
+
+    std::vector<TimerIdentifier> expiredTimers;
+    auto now = Clock::now();
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        for (auto deadline = timerDeadlines.begin(); deadline != timerDeadlines.end() && deadline->first <= now; deadline++) {
+            expiredTimers.push_back(deadline->second);
+        }
+    }
+    
+    for (auto identifier : expiredTimers) {
+        std::shared_ptr<Handler> handler;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            
+            // A handler that ran earlier in this pass may have removed the timer.
+            auto position = timers.find(identifier);
+            if (position == timers.end()) {
+                continue;
+            }
+            
+            auto &timer = position->second;
+            handler = timer.handler;
+            removeDeadline(identifier, timer.deadline);
+            
+            if (timer.repeats) {
+                // Missed intervals are skipped rather than fired in a burst.
+                timer.deadline = std::max(timer.deadline + timer.interval, now + timer.interval);
+                timerDeadlines.emplace(timer.deadline, identifier);
+            } else {
+                timers.erase(position);
+            }
+        }
+        
+        (*handler)();
+    }
+    
+    std::lock_guard<std::mutex> lock(mutex);
+    armTimer();
+}
+
+void EventLoop::handleSignals(void) {
+    std::vector<int> signals;
+
+#ifdef __linux__
+    struct signalfd_siginfo information;
+    while (read(signalFD, &information, sizeof(information)) == sizeof(information)) {
+        signals.push_back((int)information.ssi_signo);
+    }
+#else
+    unsigned char value;
+    while (read(signalFD, &value, sizeof(value)) == sizeof(value)) {
+        signals.push_back((int)value);
+    }
+#endif
+
+    for (int signal : signals) {
+        std::shared_ptr<SignalHandler> handler;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            auto position = signalHandlers.find(signal);
+            if (position != signalHandlers.end()) {
+                handler = position->second;
+            }
+        }
+        
+        if (handler != nullptr) {
+            (*handler)(signal);
+        }
+    }
+}
+
+void EventLoop::waitForEvents(void) {
+    std::vector<std::pair<int, uint32_t>> readyDescriptors;
+
+#ifdef __linux__
+    struct epoll_event events[EVENT_LOOP_MAXIMUM_EVENT_COUNT];
+    int eventCount = epoll_wait(pollFD, events, EVENT_LOOP_MAXIMUM_EVENT_COUNT, -1);
+    if (eventCount < 0) {
+        if (errno == EINTR) {
+            return;
+        }
+        
+        throwSystemError("epoll_wait");
+    }
+    
+    for (int i = 0; i < eventCount; i++) {
+        uint32_t readyEvents = ((events[i].events & EPOLLIN) ? Readable : 0) | ((events[i].events & EPOLLOUT) ? Writable : 0) | ((events[i].events & (EPOLLHUP | EPOLLERR)) ? Hangup : 0);
+        readyDescriptors.push_back(std::make_pair((int)events[i].data.fd, readyEvents));
+    }
+#else
+    std::vector<struct pollfd> descriptors;
+    int timeout = -1;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        descriptors.push_back({wakeFD, POLLIN, 0});
+        if (signalFD >= 0) {
+            descriptors.push_back({signalFD, POLLIN, 0});
+        }
+        
+        for (auto &pair : descriptorHandlers) {
+            short events = ((pair.second.first & Readable) ? POLLIN : 0) | ((pair.second.first & Writable) ? POLLOUT : 0);
+            descriptors.push_back({pair.first, events, 0});
+        }
+        
+        auto deadline = nextDeadline();
+        if (deadline != Clock::time_point::max()) {
+            auto remaining = std::chrono::duration_cast<std::chrono::milliseconds>(deadline - Clock::now() + std::chrono::microseconds(999));
+            timeout = (int)std::max<int64_t>(remaining.count(), 0);
+        }
+    }
+    
+    if (poll(descriptors.data(), (nfds_t)descriptors.size(), timeout) < 0) {
+        if (errno == EINTR) {
+            return;
+        }
+        
+        throwSystemError("poll");
+    }
+    
+    for (auto &descriptor : descriptors) {
+        if (descriptor.revents != 0) {
+            uint32_t readyEvents = ((descriptor.revents & POLLIN) ? Readable : 0) | ((descriptor.revents & POLLOUT) ? Writable : 0) | ((descriptor.revents & (POLLHUP | POLLERR)) ? Hangup : 0);
+            readyDescriptors.push_back(std::make_pair(descriptor.fd, readyEvents));
+        }
+    }
+    
+    // There is no timer descriptor, so check for expired timers after every wakeup.
+    runExpiredTimers();
+#endif
+
+    for (auto &readyDescriptor : readyDescriptors) {
+        int fd = readyDescriptor.first;
+        if (fd == wakeFD) {
+            drainWakeups();
+            runPostedHandlers();
+        } else if (fd == timerFD) {
+            runExpiredTimers();
+        } else if (fd == signalFD) {
+            handleSignals();
+        } else {
+            std::shared_ptr<DescriptorHandler> handler;
+            {
+                // The descriptor may have been removed by an earlier handler.
+                std::lock_guard<std::mutex> lock(mutex);
+                auto position = descriptorHandlers.find(fd);
+                if (position != descriptorHandlers.end()) {
+                    handler = position->second.second;
+                }
+            }
+            
+            if (handler != nullptr) {
+                (*handler)(readyDescriptor.second);
+            }
+        }
+    }
+}
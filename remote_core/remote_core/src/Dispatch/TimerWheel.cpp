@@ -0,0 +1,226 @@
+//
+//  TimerWheel.cpp
+//  remote_core
+//
+//  Created by David Moore on 10/19/26.
+//  Copyright © 2026 David Moore. All rights reserved.
+//
+
+#include "TimerWheel.hpp"
+#include <algorithm>
+#include <limits>
+
+/// Number of bits of a tick that index the slots of a single level.
+#define TIMER_WHEEL_SLOT_BITS 6
+
+using namespace RemoteCore;
+
+constexpr size_t TimerWheel::levelCount;
+constexpr size_t TimerWheel::slotCount;
+
+namespace {
+    const uint64_t noTick = std::numeric_limits<uint64_t>::max();
+    
+    /// Number of ticks spanned by a single slot of the level.
+    inline uint64_t ticksPerSlot(size_t level) {
+        return (uint64_t)1 << (TIMER_WHEEL_SLOT_BITS * level);
+    }
+}
+
+TimerWheel::TimerWheel(std::string name, Clock::duration resolution) : name(name), resolution(std::max(resolution, Clock::duration(1))), origin(Clock::now()), currentTick(0), plannedWakeTick(noTick), pendingTimerCount(0), shouldQuit(false) {
+    std::fill(std::begin(occupiedSlots), std::end(occupiedSlots), 0);
+    thread = std::thread(&TimerWheel::timerHandler, this);
+}
+
+TimerWheel::~TimerWheel() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        shouldQuit = true;
+    }
+    
+    condition.notify_all();
+    if (thread.joinable()) {
+        thread.join();
+    }
+}
+
+TimerWheel *TimerWheel::sharedTimerWheel(void) {
+    static TimerWheel wheel("ca.mooredev.remote_core.TimerWheel.shared_timer_wheel");
+    
+    return &wheel;
+}
+
+size_t TimerWheel::getPendingTimerCount(void) {
+    std::lock_guard<std::mutex> lock(mutex);
+    return pendingTimerCount;
+}
+
+DispatchTimer TimerWheel::schedule(Clock::time_point deadline, DispatchTask handler) {
+    auto timer = std::make_shared<Timer>();
+    timer->handler = std::move(handler);
+    
+    bool shouldWake;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        
+        // Round up, so that a timer never fires early.
+        auto elapsed = (deadline - origin).count();
+        uint64_t expiryTick = elapsed <= 0 ? 0 : (uint64_t)((elapsed + resolution.count() - 1) / resolution.count());
+        
+        timer->expiryTick = std::max(expiryTick, currentTick + 1);
+        timer->isScheduled = true;
+        insert(timer);
+        pendingTimerCount++;
+        
+        shouldWake = timer->expiryTick < plannedWakeTick;
+    }
+    
+    // The timer thread only needs to wake if it is sleeping past the new deadline.
+    if (shouldWake) {
+        condition.notify_one();
+    }
+    
+    return DispatchTimer(this, timer);
+}
+
+bool TimerWheel::cancel(const std::shared_ptr<Timer> &timer) {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (!timer->isScheduled) {
+        return false;
+    }
+    
+    auto &slot = slots[timer->level][timer->slot];
+    slot.erase(timer->position);
+    if (slot.empty()) {
+        occupiedSlots[timer->level] &= ~((uint64_t)1 << timer->slot);
+    }
+    
+    timer->isScheduled = false;
+    pendingTimerCount--;
+    
+    return true;
+}
+
+void TimerWheel::insert(const std::shared_ptr<Timer> &timer) {
+    uint64_t delta = timer->expiryTick - currentTick;
+    uint64_t placementTick = timer->expiryTick;
+    
+    size_t level = 0;
+    while (level + 1 < levelCount && delta >= ticksPerSlot(level + 1)) {
+        level++;
+    }
+    
+    // Timers beyond the range of the wheel are parked in the furthest slot, and placed again when it is cascaded.
+    if (delta >= ticksPerSlot(levelCount)) {
+        placementTick = currentTick + ticksPerSlot(levelCount) - 1;
+    }
+    
+    size_t slot = (placementTick >> (TIMER_WHEEL_SLOT_BITS * level)) & (slotCount - 1);
+    
+    timer->level = level;
+    timer->slot = slot;
+    timer->position = slots[level][slot].insert(slots[level][slot].end(), timer);
+    occupiedSlots[level] |= (uint64_t)1 << slot;
+}
+
+uint64_t TimerWheel::nextEventTick(void) const {
+    uint64_t nextTick = noTick;
+    
+    // Timers on the first level fire on the tick of their slot, so the nearest occupied slot is the next expiry.
+    if (occupiedSlots[0] != 0) {
+        unsigned int shift = (unsigned int)((currentTick + 1) & (slotCount - 1));
+        uint64_t rotatedSlots = shift == 0 ? occupiedSlots[0] : (occupiedSlots[0] >> shift) | (occupiedSlots[0] << (64 - shift));
+        nextTick = currentTick + 1 + __builtin_ctzll(rotatedSlots);
+    }
+    
+    // Higher levels only need attention when one of their slots is cascaded.
+    for (size_t level = 1; level < levelCount; level++) {
+        if (occupiedSlots[level] != 0) {
+            uint64_t boundaryTick = ((currentTick >> (TIMER_WHEEL_SLOT_BITS * level)) + 1) << (TIMER_WHEEL_SLOT_BITS * level);
+            nextTick = std::min(nextTick, boundaryTick);
+        }
+    }
+    
+    return nextTick;
+}
+
+void TimerWheel::advance(uint64_t targetTick, std::vector<DispatchTask> &handlers) {
+    // Ticks without work are skipped entirely.
+    while (currentTick < targetTick) {
+        uint64_t nextTick = nextEventTick();
+        if (nextTick > targetTick) {
+            currentTick = targetTick;
+            break;
+        }
+        
+        currentTick = nextTick;
+        processTick(handlers);
+    }
+}
+
+void TimerWheel::processTick(std::vector<DispatchTask> &handlers) {
+    // Cascade from the top, since a timer may move down more than one level in a single tick.
+    for (size_t level = levelCount - 1; level > 0; level--) {
+        if ((currentTick & (ticksPerSlot(level) - 1)) != 0) {
+            continue;
+        }
+        
+        size_t slot = (currentTick >> (TIMER_WHEEL_SLOT_BITS * level)) & (slotCount - 1);
+        Slot cascadedTimers;
+        cascadedTimers.swap(slots[level][slot]);
+        occupiedSlots[level] &= ~((uint64_t)1 << slot);
+        
+        for (auto &timer : cascadedTimers) {
+            insert(timer);
+        }
+    }
+    
+    size_t slot = currentTick & (slotCount - 1);
+    for (auto &timer : slots[0][slot]) {
+        timer->isScheduled = false;
+        handlers.push_back(std::move(timer->handler));
+        pendingTimerCount--;
+    }
+    
+    slots[0][slot].clear();
+    occupiedSlots[0] &= ~((uint64_t)1 << slot);
+}
+
+void TimerWheel::timerHandler(void) {
+    std::unique_lock<std::mutex> lock(mutex);
+    std::vector<DispatchTask> handlers;
+    
+    while (!shouldQuit) {
+        auto elapsed = (Clock::now() - origin).count();
+        advance((uint64_t)(elapsed / resolution.count()), handlers);
+        
+        if (!handlers.empty()) {
+            lock.unlock();
+            for (auto &handler : handlers) {
+                handler();
+            }
+            
+            handlers.clear();
+            lock.lock();
+            continue;
+        }
+        
+        plannedWakeTick = nextEventTick();
+        if (plannedWakeTick == noTick) {
+            condition.wait(lock);
+        } else {
+            condition.wait_until(lock, origin + resolution * (Clock::rep)plannedWakeTick);
+        }
+        
+        plannedWakeTick = noTick;
+    }
+}
+
+bool DispatchTimer::cancel(void) {
+    auto timer = this->timer.lock();
+    if (timer == nullptr) {
+        return false;
+    }
+    
+    return wheel->cancel(timer);
+}
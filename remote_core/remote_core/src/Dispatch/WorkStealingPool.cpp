@@ -0,0 +1,173 @@
+//
+//  WorkStealingPool.cpp
+//  remote_core
+//
+//  Created by David Moore on 10/19/26.
+//  Copyright © 2026 David Moore. All rights reserved.
+//
+
+#include "WorkStealingPool.hpp"
+#include <algorithm>
+
+#define WORK_STEALING_POOL_MINIMUM_SHARED_THREAD_COUNT 4
+
+using namespace RemoteCore;
+
+namespace {
+    /// Pool and worker index of the current thread, if it belongs to a pool.
+    thread_local const WorkStealingPool *currentPool = nullptr;
+    thread_local size_t currentWorkerIndex = 0;
+}
+
+WorkStealingPool::WorkStealingPool(std::string name, size_t threadCount) : name(name), queuedTaskCount(0), parkedWorkerCount(0), shouldQuit(false) {
+    if (threadCount == 0) {
+        threadCount = std::max(1u, std::thread::hardware_concurrency());
+    }
+    
+    for (size_t i = 0; i < threadCount; i++) {
+        workers.push_back(std::make_unique<Worker>());
+    }
+    
+    // Start the threads once every worker exists, since any of them may be stolen from.
+    for (size_t i = 0; i < threadCount; i++) {
+        workers[i]->thread = std::thread(&WorkStealingPool::workerHandler, this, i);
+    }
+}
+
+WorkStealingPool::~WorkStealingPool() {
+    {
+        std::lock_guard<std::mutex> lock(parkingMutex);
+        shouldQuit = true;
+    }
+    
+    parkingCondition.notify_all();
+    
+    for (auto &worker : workers) {
+        if (worker->thread.joinable()) {
+            worker->thread.join();
+        }
+    }
+}
+
+WorkStealingPool *WorkStealingPool::sharedPool(void) {
+    // Blocking work has threads of its own, but a slow block still holds a thread, so leave room on small machines.
+    static WorkStealingPool pool("ca.mooredev.remote_core.WorkStealingPool.shared_pool", std::max<size_t>(WORK_STEALING_POOL_MINIMUM_SHARED_THREAD_COUNT, std::thread::hardware_concurrency()));
+    
+    return &pool;
+}
+
+bool WorkStealingPool::isCurrentThreadInPool(void) const {
+    return currentPool == this;
+}
+
+void WorkStealingPool::submit(DispatchTask task) {
+    if (currentPool == this) {
+        auto &worker = workers[currentWorkerIndex];
+        std::lock_guard<std::mutex> lock(worker->mutex);
+        worker->tasks.push_back(std::move(task));
+    } else {
+        std::lock_guard<std::mutex> lock(injectionMutex);
+        injectionQueue.push_back(std::move(task));
+    }
+    
+    queuedTaskCount++;
+    wakeWorker();
+}
+
+void WorkStealingPool::yield(DispatchTask task) {
+    {
+        std::lock_guard<std::mutex> lock(injectionMutex);
+        injectionQueue.push_back(std::move(task));
+    }
+    
+    queuedTaskCount++;
+    wakeWorker();
+}
+
+void WorkStealingPool::wakeWorker(void) {
+    // Only touch the parking lot when a worker is actually parked.
+    if (parkedWorkerCount.load() == 0) {
+        return;
+    }
+    
+    {
+        std::lock_guard<std::mutex> lock(parkingMutex);
+    }
+    
+    parkingCondition.notify_one();
+}
+
+bool WorkStealingPool::takeTask(size_t workerIndex, DispatchTask &task) {
+    if (queuedTaskCount.load() == 0) {
+        return false;
+    }
+    
+    // Newest work from our own deque first, since it is the most likely to be in the cache.
+    {
+        auto &worker = workers[workerIndex];
+        std::lock_guard<std::mutex> lock(worker->mutex);
+        if (!worker->tasks.empty()) {
+            task = std::move(worker->tasks.back());
+            worker->tasks.pop_back();
+            queuedTaskCount--;
+            
+            return true;
+        }
+    }
+    
+    {
+        std::lock_guard<std::mutex> lock(injectionMutex);
+        if (!injectionQueue.empty()) {
+            task = std::move(injectionQueue.front());
+            injectionQueue.pop_front();
+            queuedTaskCount--;
+            
+            return true;
+        }
+    }
+    
+    // Steal the oldest work from the other workers, starting with our neighbour.
+    for (size_t offset = 1; offset < workers.size(); offset++) {
+        auto &victim = workers[(workerIndex + offset) % workers.size()];
+        std::unique_lock<std::mutex> lock(victim->mutex, std::try_to_lock);
+        if (lock.owns_lock() && !victim->tasks.empty()) {
+            task = std::move(victim->tasks.front());
+            victim->tasks.pop_front();
+            queuedTaskCount--;
+            
+            return true;
+        }
+    }
+    
+    return false;
+}
+
+void WorkStealingPool::workerHandler(size_t workerIndex) {
+    currentPool = this;
+    currentWorkerIndex = workerIndex;
+    
+    DispatchTask task;
+    while (true) {
+        if (takeTask(workerIndex, task)) {
+            task();
+            task.reset();
+            continue;
+        }
+        
+        std::unique_lock<std::mutex> lock(parkingMutex);
+        
+        // Submitters increment the task count before checking for parked workers, so one of the two always observes the other.
+        parkedWorkerCount++;
+        parkingCondition.wait(lock, [this]() {
+            return queuedTaskCount.load() > 0 || shouldQuit;
+        });
+        parkedWorkerCount--;
+        
+        // Remaining work is completed before quitting.
+        if (shouldQuit && queuedTaskCount.load() == 0) {
+            break;
+        }
+    }
+    
+    currentPool = nullptr;
+}
@@ -0,0 +1,165 @@
+//
+//  BufferChain.cpp
+//  remote_core
+//
+//  Created by David Moore on 10/19/26.
+//  Copyright © 2026 David Moore. All rights reserved.
+//
+
+#include "BufferChain.hpp"
+#include <atomic>
+#include <cstring>
+#include <stdexcept>
+
+using namespace RemoteCore;
+
+static std::atomic<uint64_t> allocationCount(0);
+static std::atomic<uint64_t> copiedByteCount(0);
+
+// MARK: - Shared Buffer
+
+SharedBuffer::SharedBuffer(std::string &&bytes) : offset(0), length(bytes.size()) {
+    if (length > 0) {
+        storage = std::make_shared<const std::string>(std::move(bytes));
+        allocationCount++;
+    }
+}
+
+SharedBuffer::SharedBuffer(const std::string &bytes) : SharedBuffer(std::string(bytes)) {
+    copiedByteCount += bytes.size();
+}
+
+SharedBuffer::SharedBuffer(const char *bytes) : SharedBuffer(std::string(bytes)) {
+    copiedByteCount += length;
+}
+
+SharedBuffer SharedBuffer::slice(size_t offset, size_t length) const {
+    if (offset > this->length || length > this->length - offset) {
+        throw std::out_of_range("Expected the slice to be within the buffer.");
+    }
+    
+    SharedBuffer buffer;
+    if (length > 0) {
+        buffer.storage = storage;
+        buffer.offset = this->offset + offset;
+        buffer.length = length;
+    }
+    
+    return buffer;
+}
+
+std::string SharedBuffer::toString(void) const {
+    copiedByteCount += length;
+    return std::string(data(), length);
+}
+
+void SharedBuffer::appendTo(std::string &bytes) const {
+    copiedByteCount += length;
+    bytes.append(data(), length);
+}
+
+bool SharedBuffer::operator==(const SharedBuffer &other) const {
+    return length == other.length && memcmp(data(), other.data(), length) == 0;
+}
+
+SharedBufferStatistics SharedBuffer::getStatistics(void) {
+    SharedBufferStatistics statistics;
+    statistics.allocationCount = allocationCount;
+    statistics.copiedByteCount = copiedByteCount;
+    return statistics;
+}
+
+// MARK: - Buffer Chain
+
+BufferChain::BufferChain() : firstSegmentIndex(0), byteCount(0) {}
+
+void BufferChain::addOwnedSegment(size_t offset, size_t length) {
+    if (length == 0) {
+        return;
+    }
+    
+    byteCount += length;
+    
+    // Bytes that directly follow the last segment's own bytes extend it.
+    if (segments.size() > firstSegmentIndex) {
+        auto &lastSegment = segments.back();
+        if (lastSegment.isOwned && lastSegment.offset + lastSegment.length == offset) {
+            lastSegment.length += length;
+            return;
+        }
+    }
+    
+    segments.push_back({SharedBuffer(), true, offset, length});
+}
+
+void BufferChain::append(SharedBuffer buffer) {
+    if (buffer.empty()) {
+        return;
+    }
+    
+    size_t length = buffer.size();
+    byteCount += length;
+    segments.push_back({std::move(buffer), false, 0, length});
+}
+
+void BufferChain::appendBytes(const char *bytes, size_t length) {
+    size_t offset = ownedBytes.size();
+    ownedBytes.append(bytes, length);
+    addOwnedSegment(offset, length);
+}
+
+size_t BufferChain::getIOVectors(struct iovec *vectors, size_t maximumCount) const {
+    size_t count = 0;
+    for (size_t i = firstSegmentIndex; i < segments.size() && count < maximumCount; i++) {
+        auto &segment = segments[i];
+        const char *bytes = segment.isOwned ? ownedBytes.data() : segment.buffer.data();
+        vectors[count].iov_base = (void *)(bytes + segment.offset);
+        vectors[count].iov_len = segment.length;
+        count++;
+    }
+    
+    return count;
+}
+
+void BufferChain::consume(size_t length) {
+    if (length > byteCount) {
+        throw std::logic_error("Expected the chain to have at least as many bytes as are consumed.");
+    }
+    
+    byteCount -= length;
+    while (length > 0) {
+        auto &segment = segments[firstSegmentIndex];
+        if (length < segment.length) {
+            segment.offset += length;
+            segment.length -= length;
+            break;
+        }
+        
+        length -= segment.length;
+        segment.buffer = SharedBuffer();
+        firstSegmentIndex++;
+    }
+    
+    if (byteCount == 0) {
+        clear();
+    }
+}
+
+void BufferChain::clear(void) {
+    // Clearing keeps the capacity of both, so that the next bytes do not allocate.
+    segments.clear();
+    ownedBytes.clear();
+    firstSegmentIndex = 0;
+    byteCount = 0;
+}
+
+std::string BufferChain::toString(void) const {
+    std::string bytes;
+    bytes.reserve(byteCount);
+    for (size_t i = firstSegmentIndex; i < segments.size(); i++) {
+        auto &segment = segments[i];
+        bytes.append((segment.isOwned ? ownedBytes.data() : segment.buffer.data()) + segment.offset, segment.length);
+    }
+    
+    return bytes;
+}
@@ -0,0 +1,377 @@
+//
+//  MessageOutbox.cpp
+//  remote_core
+//
+//  Created by David Moore on 10/19/26.
+//  Copyright © 2026 David Moore. All rights reserved.
+//
+
+#include "MessageOutbox.hpp"
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+#include <system_error>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+using namespace RemoteCore;
+
+#define MESSAGE_OUTBOX_FILE_MAGIC 0x584F4252
+#define MESSAGE_OUTBOX_FILE_VERSION 1
+#define MESSAGE_OUTBOX_RECORD_MAGIC 0x4D534752
+#define MESSAGE_OUTBOX_PADDING_MAGIC 0x50414444
+
+/// Size of the file header, which keeps the segments page aligned.
+#define MESSAGE_OUTBOX_HEADER_SIZE 4096
+#define MESSAGE_OUTBOX_RECORD_ALIGNMENT 8
+#define MESSAGE_OUTBOX_MINIMUM_SEGMENT_SIZE 64
+
+/**
+ Offsets grow without wrapping; the position of an offset in the ring is its remainder after dividing by the capacity.
+ */
+struct MessageOutbox::FileHeader {
+    uint32_t magic;
+    uint32_t version;
+    uint64_t segmentSize;
+    uint64_t segmentCount;
+    uint64_t headOffset;
+    uint64_t tailOffset;
+};
+
+struct OutboxRecordHeader {
+    uint32_t magic;
+    uint32_t checksum;
+    uint32_t topicLength;
+    uint32_t payloadLength;
+};
+
+static uint64_t alignedRecordSize(uint64_t bodyLength) {
+    uint64_t size = sizeof(OutboxRecordHeader) + bodyLength;
+    return (size + MESSAGE_OUTBOX_RECORD_ALIGNMENT - 1) / MESSAGE_OUTBOX_RECORD_ALIGNMENT * MESSAGE_OUTBOX_RECORD_ALIGNMENT;
+}
+
+/**
+ FNV-1a hash of the record's lengths and body.
+ */
+static uint32_t checksumForRecord(const OutboxRecordHeader &header, const char *body) {
+    uint32_t hash = 2166136261u;
+    auto combine = [&hash](const void *bytes, size_t length) {
+        auto data = static_cast<const uint8_t *>(bytes);
+        for (size_t i = 0; i < length; i++) {
+            hash = (hash ^ data[i]) * 16777619u;
+        }
+    };
+    
+    combine(&header.topicLength, sizeof(header.topicLength));
+    combine(&header.payloadLength, sizeof(header.payloadLength));
+    combine(body, (size_t)header.topicLength + header.payloadLength);
+    return hash;
+}
+
+/**
+ Allocates the blocks between 'currentLength' and 'length', returning an 'errno' value, or zero on success.
+ */
+static int reserveFileBlocks(int fd, off_t currentLength, off_t length) {
+    if (length <= currentLength) {
+        return 0;
+    }
+    
+#if defined(__linux__)
+    return posix_fallocate(fd, currentLength, length - currentLength);
+#elif defined(__APPLE__)
+    fstore_t store = {F_ALLOCATECONTIG | F_ALLOCATEALL, F_PEOFPOSMODE, 0, length - currentLength, 0};
+    if (fcntl(fd, F_PREALLOCATE, &store) != 0) {
+        store.fst_flags = F_ALLOCATEALL;
+        if (fcntl(fd, F_PREALLOCATE, &store) != 0) {
+            return errno;
+        }
+    }
+    
+    return ftruncate(fd, length) == 0 ? 0 : errno;
+#else
+    // Without a way to reserve blocks, writing zeros makes the file system allocate them.
+    char zeros[4096] = {};
+    for (off_t offset = currentLength; offset < length;) {
+        size_t chunkLength = (size_t)std::min<off_t>(length - offset, (off_t)sizeof(zeros));
+        ssize_t written = pwrite(fd, zeros, chunkLength, offset);
+        if (written < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            
+            return errno;
+        }
+        
+        offset += written;
+    }
+    
+    return 0;
+#endif
+}
+
+MessageOutbox::MessageOutbox(const std::string &path, size_t segmentSize, size_t segmentCount) : fd(-1), mapping(nullptr), mappingSize(0), segmentSize(segmentSize), segmentCount(segmentCount), messageCount(0) {
+    if (segmentSize < MESSAGE_OUTBOX_MINIMUM_SEGMENT_SIZE || segmentSize % MESSAGE_OUTBOX_RECORD_ALIGNMENT != 0) {
+        throw std::logic_error("Expected 'segmentSize' to be a multiple of 8, and at least 64 bytes.");
+    }
+    
+    // A segment can only be discarded while another one is being written.
+    if (segmentCount < 2) {
+        throw std::logic_error("Expected 'segmentCount' to be at least 2.");
+    }
+    
+    auto fail = [this](const char *operation) {
+        int error = errno;
+        if (mapping != nullptr) {
+            munmap(mapping, mappingSize);
+        }
+        
+        if (fd >= 0) {
+            close(fd);
+        }
+        
+        throw std::system_error(error, std::generic_category(), operation);
+    };
+    
+    fd = open(path.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0600);
+    if (fd < 0) {
+        fail("open");
+    }
+    
+    struct stat status;
+    if (fstat(fd, &status) != 0) {
+        fail("fstat");
+    }
+    
+    mappingSize = MESSAGE_OUTBOX_HEADER_SIZE + segmentSize * segmentCount;
+    bool hasExpectedSize = (size_t)status.st_size == mappingSize;
+    if (!hasExpectedSize && ftruncate(fd, 0) != 0) {
+        fail("ftruncate");
+    }
+    
+    // Reserve every block now, so that a full disk is reported here rather than as a crash when writing to the mapping.
+    int error = reserveFileBlocks(fd, hasExpectedSize ? (off_t)mappingSize : 0, (off_t)mappingSize);
+    if (error != 0) {
+        errno = error;
+        fail("reserveFileBlocks");
+    }
+    
+    void *address = mmap(nullptr, mappingSize, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (address == MAP_FAILED) {
+        fail("mmap");
+    }
+    
+    mapping = static_cast<uint8_t *>(address);
+    
+    std::lock_guard<std::mutex> lock(mutex);
+    auto &header = getHeader();
+    bool isValid = hasExpectedSize && header.magic == MESSAGE_OUTBOX_FILE_MAGIC && header.version == MESSAGE_OUTBOX_FILE_VERSION &&
+                   header.segmentSize == segmentSize && header.segmentCount == segmentCount &&
+                   header.headOffset <= header.tailOffset && header.tailOffset - header.headOffset <= getCapacity() &&
+                   header.headOffset % MESSAGE_OUTBOX_RECORD_ALIGNMENT == 0 && header.tailOffset % MESSAGE_OUTBOX_RECORD_ALIGNMENT == 0;
+    
+    if (isValid) {
+        recoverRecords();
+    } else {
+        initializeFile();
+    }
+}
+
+MessageOutbox::~MessageOutbox() {
+    munmap(mapping, mappingSize);
+    close(fd);
+}
+
+MessageOutbox::FileHeader &MessageOutbox::getHeader(void) const {
+    return *reinterpret_cast<FileHeader *>(mapping);
+}
+
+uint8_t *MessageOutbox::dataAtOffset(uint64_t offset) const {
+    return mapping + MESSAGE_OUTBOX_HEADER_SIZE + offset % getCapacity();
+}
+
+void MessageOutbox::initializeFile(void) {
+    auto &header = getHeader();
+    header.magic = MESSAGE_OUTBOX_FILE_MAGIC;
+    header.version = MESSAGE_OUTBOX_FILE_VERSION;
+    header.segmentSize = segmentSize;
+    header.segmentCount = segmentCount;
+    header.headOffset = 0;
+    header.tailOffset = 0;
+    messageCount = 0;
+}
+
+// MARK: - Records
+
+MessageOutbox::RecordKind MessageOutbox::readRecord(uint64_t offset, uint64_t &nextOffset, OutboxMessage *message) const {
+    uint64_t segmentEnd = (offset / segmentSize + 1) * segmentSize;
+    nextOffset = segmentEnd;
+    
+    // The rest of a segment that is too short for a record is padding, even without a marker.
+    if (segmentEnd - offset < sizeof(OutboxRecordHeader)) {
+        return RecordKind::Padding;
+    }
+    
+    OutboxRecordHeader recordHeader;
+    std::memcpy(&recordHeader, dataAtOffset(offset), sizeof(recordHeader));
+    if (recordHeader.magic == MESSAGE_OUTBOX_PADDING_MAGIC) {
+        return RecordKind::Padding;
+    } else if (recordHeader.magic != MESSAGE_OUTBOX_RECORD_MAGIC) {
+        return RecordKind::Invalid;
+    }
+    
+    uint64_t bodyLength = (uint64_t)recordHeader.topicLength + recordHeader.payloadLength;
+    if (sizeof(recordHeader) + bodyLength > segmentEnd - offset) {
+        return RecordKind::Invalid;
+    }
+    
+    auto body = reinterpret_cast<const char *>(dataAtOffset(offset) + sizeof(recordHeader));
+    if (checksumForRecord(recordHeader, body) != recordHeader.checksum) {
+        return RecordKind::Invalid;
+    }
+    
+    nextOffset = offset + alignedRecordSize(bodyLength);
+    if (message != nullptr) {
+        message->topicName.assign(body, recordHeader.topicLength);
+        message->payload.assign(body + recordHeader.topicLength, recordHeader.payloadLength);
+    }
+    
+    return RecordKind::Message;
+}
+
+void MessageOutbox::recoverRecords(void) {
+    auto &header = getHeader();
+    uint64_t offset = header.headOffset;
+    size_t count = 0;
+    
+    while (offset < header.tailOffset) {
+        uint64_t nextOffset;
+        auto kind = readRecord(offset, nextOffset, nullptr);
+        if (kind == RecordKind::Invalid || nextOffset > header.tailOffset) {
+            header.tailOffset = offset;
+            break;
+        }
+        
+        if (kind == RecordKind::Message) {
+            count++;
+        }
+        
+        offset = nextOffset;
+    }
+    
+    messageCount = count;
+}
+
+size_t MessageOutbox::advanceHead(uint64_t endOffset) {
+    auto &header = getHeader();
+    size_t removedCount = 0;
+    
+    while (header.headOffset < endOffset && header.headOffset < header.tailOffset) {
+        uint64_t nextOffset;
+        if (readRecord(header.headOffset, nextOffset, nullptr) == RecordKind::Message) {
+            removedCount++;
+        }
+        
+        header.headOffset = std::min(nextOffset, header.tailOffset);
+    }
+    
+    messageCount -= removedCount;
+    return removedCount;
+}
+
+// MARK: - Messages
+
+bool MessageOutbox::append(const std::string &topicName, const std::string &payload) {
+    uint64_t endOffset;
+    return appendRecord(topicName, payload.data(), payload.size(), endOffset);
+}
+
+bool MessageOutbox::append(const std::string &topicName, const SharedBuffer &payload, uint64_t &endOffset) {
+    return appendRecord(topicName, payload.data(), payload.size(), endOffset);
+}
+
+bool MessageOutbox::appendRecord(const std::string &topicName, const char *payload, size_t payloadLength, uint64_t &endOffset) {
+    uint64_t recordSize = alignedRecordSize((uint64_t)topicName.size() + payloadLength);
+    
+    std::lock_guard<std::mutex> lock(mutex);
+    if (recordSize > segmentSize) {
+        statistics.rejectedCount++;
+        return false;
+    }
+    
+    // A record that does not fit in the rest of the current segment starts the next one.
+    auto &header = getHeader();
+    uint64_t offset = header.tailOffset;
+    uint64_t segmentEnd = (offset / segmentSize + 1) * segmentSize;
+    if (segmentEnd - offset < recordSize) {
+        offset = segmentEnd;
+    }
+    
+    // Make room by discarding the oldest segment, one at a time.
+    while (offset + recordSize - header.headOffset > getCapacity()) {
+        uint64_t headSegmentEnd = (header.headOffset / segmentSize + 1) * segmentSize;
+        statistics.droppedCount += advanceHead(headSegmentEnd);
+    }
+    
+    if (offset != header.tailOffset && segmentEnd - header.tailOffset >= sizeof(OutboxRecordHeader)) {
+        OutboxRecordHeader paddingHeader = {MESSAGE_OUTBOX_PADDING_MAGIC, 0, 0, 0};
+        std::memcpy(dataAtOffset(header.tailOffset), &paddingHeader, sizeof(paddingHeader));
+    }
+    
+    OutboxRecordHeader recordHeader = {MESSAGE_OUTBOX_RECORD_MAGIC, 0, (uint32_t)topicName.size(), (uint32_t)payloadLength};
+    auto body = reinterpret_cast<char *>(dataAtOffset(offset) + sizeof(recordHeader));
+    std::memcpy(body, topicName.data(), topicName.size());
+    std::memcpy(body + topicName.size(), payload, payloadLength);
+    recordHeader.checksum = checksumForRecord(recordHeader, body);
+    std::memcpy(dataAtOffset(offset), &recordHeader, sizeof(recordHeader));
+    
+    // The tail is only moved once the record is complete, so a partially written record is never read.
+    header.tailOffset = offset + recordSize;
+    endOffset = header.tailOffset;
+    messageCount++;
+    statistics.appendedCount++;
+    return true;
+}
+
+std::vector<OutboxMessage> MessageOutbox::peek(size_t maximumCount) {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto &header = getHeader();
+    std::vector<OutboxMessage> messages;
+    
+    uint64_t offset = header.headOffset;
+    while (offset < header.tailOffset && messages.size() < maximumCount) {
+        OutboxMessage message;
+        uint64_t nextOffset;
+        if (readRecord(offset, nextOffset, &message) == RecordKind::Message) {
+            message.endOffset = nextOffset;
+            messages.push_back(std::move(message));
+        }
+        
+        offset = nextOffset;
+    }
+    
+    return messages;
+}
+
+void MessageOutbox::remove(uint64_t endOffset) {
+    std::lock_guard<std::mutex> lock(mutex);
+    statistics.removedCount += advanceHead(endOffset);
+}
+
+void MessageOutbox::synchronize(void) {
+    if (msync(mapping, mappingSize, MS_SYNC) != 0) {
+        throw std::system_error(errno, std::generic_category(), "msync");
+    }
+}
+
+size_t MessageOutbox::getCount(void) {
+    std::lock_guard<std::mutex> lock(mutex);
+    return messageCount;
+}
+
+MessageOutboxStatistics MessageOutbox::getStatistics(void) {
+    std::lock_guard<std::mutex> lock(mutex);
+    return statistics;
+}
@@ -0,0 +1,174 @@
+//
+//  OutboxPublisher.cpp
+//  remote_core
+//
+//  Created by David Moore on 10/19/26.
+//  Copyright © 2026 David Moore. All rights reserved.
+//
+
+#include "OutboxPublisher.hpp"
+#include <algorithm>
+#include <atomic>
+#include <stdexcept>
+#include "DispatchGroup.hpp"
+
+using namespace RemoteCore;
+
+OutboxPublisher::OutboxPublisher(std::unique_ptr<MessageOutbox> outbox, PublishFunction publishFunction, size_t replayBatchSize, std::chrono::milliseconds retryInterval) : outbox(std::move(outbox)), publishFunction(publishFunction), liveness(std::make_shared<Liveness>()), replayBatchSize(std::max(replayBatchSize, (size_t)1)), retryInterval(retryInterval), isConnected(false), isReplaying(false), replayedEndOffset(0) {
+    if (this->outbox == nullptr) {
+        throw std::logic_error("Expected an outbox.");
+    }
+    
+    // Messages left from before a restart are published first.
+    needsReplay = !this->outbox->isEmpty();
+    queue = std::make_unique<DispatchQueue>("ca.mooredev.remote_core.OutboxPublisher.serial_dispatch_queue");
+}
+
+OutboxPublisher::~OutboxPublisher() {
+    std::lock_guard<std::mutex> lock(liveness->mutex);
+    liveness->isAlive = false;
+}
+
+void OutboxPublisher::publish(const std::string &topicName, SharedBuffer payload) {
+    std::lock_guard<std::mutex> lock(appendMutex);
+    uint64_t endOffset = 0;
+    bool isDurable = outbox->append(topicName, payload, endOffset);
+    
+    queue->execute([this, topicName, payload = std::move(payload), isDurable, endOffset]() {
+        handlePublish(topicName, payload, isDurable, endOffset);
+    });
+}
+
+void OutboxPublisher::setConnected(bool isConnected) {
+    queue->execute([this, isConnected]() {
+        this->isConnected = isConnected;
+        replayIfNeeded();
+    });
+}
+
+void OutboxPublisher::handlePublish(const std::string &topicName, SharedBuffer payload, bool isDurable, uint64_t endOffset) {
+    if (!isDurable) {
+        // The message can never fit in the outbox, so it is only sent once.
+        publishFunction(std::move(payload), topicName, [](bool didSucceed) {
+            
+        });
+        
+        return;
+    }
+    
+    if (endOffset <= replayedEndOffset) {
+        return;
+    }
+    
+    if (!isConnected || needsReplay) {
+        // Older messages have to be published first, so this one waits in the outbox to be replayed.
+        needsReplay = true;
+        replayIfNeeded();
+        return;
+    }
+    
+    livePublishes.push_back({endOffset, PublishState::Pending});
+    publishFunction(std::move(payload), topicName, [this, liveness = liveness, endOffset](bool didSucceed) {
+        std::lock_guard<std::mutex> lock(liveness->mutex);
+        if (!liveness->isAlive) {
+            return;
+        }
+        
+        queue->execute([this, endOffset, didSucceed]() {
+            completeLivePublish(endOffset, didSucceed);
+        });
+    });
+}
+
+void OutboxPublisher::completeLivePublish(uint64_t endOffset, bool didSucceed) {
+    auto position = std::find_if(livePublishes.begin(), livePublishes.end(), [endOffset](const LivePublish &livePublish) {
+        return livePublish.endOffset == endOffset;
+    });
+    
+    if (position == livePublishes.end()) {
+        return;
+    }
+    
+    position->state = didSucceed ? PublishState::Succeeded : PublishState::Failed;
+    needsReplay = needsReplay || !didSucceed;
+    
+    // The outbox can only be removed from the front, so a message is removed once every message before it has succeeded.
+    uint64_t removedEndOffset = 0;
+    while (!livePublishes.empty() && livePublishes.front().state == PublishState::Succeeded) {
+        removedEndOffset = livePublishes.front().endOffset;
+        livePublishes.pop_front();
+    }
+    
+    if (removedEndOffset != 0) {
+        outbox->remove(removedEndOffset);
+    }
+    
+    replayIfNeeded();
+}
+
+void OutboxPublisher::replayIfNeeded(void) {
+    if (!isConnected || !needsReplay || isReplaying) {
+        return;
+    }
+    
+    bool hasPendingPublish = std::any_of(livePublishes.begin(), livePublishes.end(), [](const LivePublish &livePublish) {
+        return livePublish.state == PublishState::Pending;
+    });
+    
+    if (hasPendingPublish) {
+        return;
+    }
+    
+    // Every message that was published live, but is still in the outbox, is replayed, which may duplicate those that did succeed after one that failed.
+    livePublishes.clear();
+    isReplaying = true;
+    replayBatch();
+}
+
+void OutboxPublisher::replayBatch(void) {
+    if (!isConnected) {
+        isReplaying = false;
+        return;
+    }
+    
+    auto messages = outbox->peek(replayBatchSize);
+    if (messages.empty()) {
+        // Messages appended from here on are handled after this, so they can be published live.
+        isReplaying = false;
+        needsReplay = false;
+        return;
+    }
+    
+    DispatchGroup group;
+    auto failureCount = std::make_shared<std::atomic<size_t>>(0);
+    for (auto &message : messages) {
+        group.enter();
+        publishFunction(SharedBuffer(std::move(message.payload)), message.topicName, [group, failureCount, liveness = liveness](bool didSucceed) mutable {
+            // Leaving the group executes its notification on the publisher's queue.
+            std::lock_guard<std::mutex> lock(liveness->mutex);
+            if (!liveness->isAlive) {
+                return;
+            }
+            
+            if (!didSucceed) {
+                (*failureCount)++;
+            }
+            
+            group.leave();
+        });
+    }
+    
+    auto endOffset = messages.back().endOffset;
+    replayedEndOffset = std::max(replayedEndOffset, endOffset);
+    group.notify(*queue, [this, endOffset, failureCount]() {
+        if (*failureCount == 0) {
+            outbox->remove(endOffset);
+            replayBatch();
+        } else {
+            // The whole batch is sent again, which may duplicate the messages that did succeed. Waiting keeps a flaky connection from causing a storm of retries.
+            queue->executeAfter(retryInterval, [this]() {
+                replayBatch();
+            });
+        }
+    });
+}
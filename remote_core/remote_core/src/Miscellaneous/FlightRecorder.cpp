@@ -0,0 +1,313 @@
+//
+//  FlightRecorder.cpp
+//  remote_core
+//
+//  Created by David Moore on 10/19/26.
+//  Copyright © 2026 David Moore. All rights reserved.
+//
+
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <climits>
+#include <cstring>
+#include <stdexcept>
+#include <fcntl.h>
+#include <signal.h>
+#include <unistd.h>
+#include "FlightRecorder.hpp"
+
+using namespace RemoteCore;
+
+static_assert((FLIGHT_RECORDER_EVENTS_PER_THREAD & (FLIGHT_RECORDER_EVENTS_PER_THREAD - 1)) == 0,
+              "expected FLIGHT_RECORDER_EVENTS_PER_THREAD to be a power of two");
+
+namespace {
+    struct TraceEvent {
+        const char *category;
+        const char *name;
+        uint64_t timestamp;
+        uint64_t duration;
+        uint64_t value;
+        char phase;
+    };
+    
+    /**
+     Ring buffer that is written by a single thread at a time, and may be read by any thread, or a signal handler, while it is written.
+     
+     Each slot is guarded by a sequence number, which is odd while the slot is being written, and '2 * (index + 1)' once event 'index' has been written to it. A reader only keeps an event if the sequence number was the one it expected both before and after copying it.
+     */
+    struct TraceBuffer {
+        struct Slot {
+            std::atomic<uint64_t> sequence;
+            TraceEvent event;
+        };
+        
+        Slot slots[FLIGHT_RECORDER_EVENTS_PER_THREAD];
+        std::atomic<uint64_t> head;
+        std::atomic<bool> isOwned;
+        uint64_t threadIndex;
+        
+        /// Next buffer in the list of every buffer, which is only ever prepended to, so that it can be walked without locking.
+        TraceBuffer *next;
+        
+        TraceBuffer() : head(0), isOwned(true), threadIndex(0), next(nullptr) {
+            for (auto &slot : slots) {
+                slot.sequence.store(0, std::memory_order_relaxed);
+            }
+        }
+        
+        void record(const TraceEvent &event) {
+            uint64_t index = head.load(std::memory_order_relaxed);
+            auto &slot = slots[index & (FLIGHT_RECORDER_EVENTS_PER_THREAD - 1)];
+            
+            slot.sequence.store(2 * index + 1, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_release);
+            slot.event = event;
+            slot.sequence.store(2 * (index + 1), std::memory_order_release);
+            head.store(index + 1, std::memory_order_release);
+        }
+    };
+    
+    std::atomic<TraceBuffer *> firstBuffer(nullptr);
+    std::atomic<uint64_t> nextThreadIndex(1);
+    
+    /**
+     Claims a buffer that no thread owns, or creates one.
+     */
+    TraceBuffer *claimBuffer(void) {
+        for (auto buffer = firstBuffer.load(std::memory_order_acquire); buffer != nullptr; buffer = buffer->next) {
+            bool isOwned = false;
+            if (!buffer->isOwned.load(std::memory_order_relaxed) && buffer->isOwned.compare_exchange_strong(isOwned, true, std::memory_order_acquire)) {
+                return buffer;
+            }
+        }
+        
+        auto buffer = new TraceBuffer();
+        buffer->threadIndex = nextThreadIndex++;
+        buffer->next = firstBuffer.load(std::memory_order_relaxed);
+        while (!firstBuffer.compare_exchange_weak(buffer->next, buffer, std::memory_order_release, std::memory_order_relaxed)) {
+        }
+        
+        return buffer;
+    }
+    
+    /// Gives the thread's buffer up when the thread exits.
+    struct BufferOwner {
+        TraceBuffer *buffer = nullptr;
+        
+        ~BufferOwner() {
+            if (buffer != nullptr) {
+                buffer->isOwned.store(false, std::memory_order_release);
+            }
+        }
+    };
+    
+    thread_local BufferOwner bufferOwner;
+    
+    inline TraceBuffer &currentBuffer(void) {
+        if (bufferOwner.buffer == nullptr) {
+            bufferOwner.buffer = claimBuffer();
+        }
+        
+        return *bufferOwner.buffer;
+    }
+    
+    /**
+     Buffered writer for the trace, which neither allocates nor locks, so that it may be used from a signal handler.
+     */
+    class TraceWriter {
+    private:
+        int fd;
+        char buffer[4096];
+        size_t length;
+        bool isFailed;
+    
+    public:
+        TraceWriter(int fd) : fd(fd), length(0), isFailed(false) {}
+        
+        bool flush(void) {
+            size_t offset = 0;
+            while (offset < length && !isFailed) {
+                auto result = ::write(fd, buffer + offset, length - offset);
+                if (result > 0) {
+                    offset += (size_t)result;
+                } else if (result < 0 && errno == EINTR) {
+                    continue;
+                } else {
+                    isFailed = true;
+                }
+            }
+            
+            length = 0;
+            return !isFailed;
+        }
+        
+        void appendCharacter(char character) {
+            if (length == sizeof(buffer)) {
+                flush();
+            }
+            
+            buffer[length++] = character;
+        }
+        
+        void append(const char *text) {
+            while (*text != '\0') {
+                appendCharacter(*text++);
+            }
+        }
+        
+        void appendString(const char *text) {
+            appendCharacter('"');
+            for (; *text != '\0'; text++) {
+                if (*text == '"' || *text == '\\') {
+                    appendCharacter('\\');
+                    appendCharacter(*text);
+                } else if ((unsigned char)*text >= 0x20) {
+                    appendCharacter(*text);
+                }
+            }
+            appendCharacter('"');
+        }
+        
+        void appendUnsigned(uint64_t value) {
+            char digits[20];
+            size_t count = 0;
+            do {
+                digits[count++] = (char)('0' + value % 10);
+                value /= 10;
+            } while (value > 0);
+            
+            while (count > 0) {
+                appendCharacter(digits[--count]);
+            }
+        }
+        
+        /**
+         Appends a duration in nanoseconds as microseconds, which is the unit of Chrome traces.
+         */
+        void appendMicroseconds(uint64_t nanoseconds) {
+            appendUnsigned(nanoseconds / 1000);
+            appendCharacter('.');
+            appendCharacter((char)('0' + nanoseconds / 100 % 10));
+            appendCharacter((char)('0' + nanoseconds / 10 % 10));
+            appendCharacter((char)('0' + nanoseconds % 10));
+        }
+    };
+    
+    char crashTracePath[PATH_MAX];
+    std::atomic<bool> isHandlingCrash(false);
+    
+    void handleCrash(int signalNumber) {
+        if (!isHandlingCrash.exchange(true)) {
+            int fd = ::open(crashTracePath, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+            if (fd >= 0) {
+                FlightRecorder::writeChromeTrace(fd);
+                ::close(fd);
+            }
+        }
+        
+        // The handler was reset to the default action, which terminates the process once the signal is delivered again.
+        ::raise(signalNumber);
+    }
+}
+
+// MARK: - Recording
+
+uint64_t FlightRecorder::now(void) {
+    return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+void FlightRecorder::recordInstant(const char *category, const char *name, uint64_t value) {
+    currentBuffer().record({category, name, now(), 0, value, 'i'});
+}
+
+void FlightRecorder::recordComplete(const char *category, const char *name, uint64_t startTime) {
+    uint64_t endTime = now();
+    currentBuffer().record({category, name, startTime, endTime - startTime, 0, 'X'});
+}
+
+// MARK: - Writing
+
+bool FlightRecorder::writeChromeTrace(int fd) {
+    TraceWriter writer(fd);
+    auto processID = (uint64_t)::getpid();
+    bool isFirstEvent = true;
+    
+    writer.append("{\"traceEvents\":[");
+    for (auto buffer = firstBuffer.load(std::memory_order_acquire); buffer != nullptr; buffer = buffer->next) {
+        uint64_t head = buffer->head.load(std::memory_order_acquire);
+        uint64_t start = head > FLIGHT_RECORDER_EVENTS_PER_THREAD ? head - FLIGHT_RECORDER_EVENTS_PER_THREAD : 0;
+        
+        for (uint64_t index = start; index < head; index++) {
+            auto &slot = buffer->slots[index & (FLIGHT_RECORDER_EVENTS_PER_THREAD - 1)];
+            uint64_t sequence = slot.sequence.load(std::memory_order_acquire);
+            if (sequence != 2 * (index + 1)) {
+                continue;
+            }
+            
+            TraceEvent event = slot.event;
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (slot.sequence.load(std::memory_order_relaxed) != sequence) {
+                // Overwritten while it was being copied.
+                continue;
+            }
+            
+            writer.append(isFirstEvent ? "\n{\"name\":" : ",\n{\"name\":");
+            writer.appendString(event.name);
+            writer.append(",\"cat\":");
+            writer.appendString(event.category);
+            writer.append(",\"ph\":\"");
+            writer.appendCharacter(event.phase);
+            writer.append("\",\"ts\":");
+            writer.appendMicroseconds(event.timestamp);
+            if (event.phase == 'X') {
+                writer.append(",\"dur\":");
+                writer.appendMicroseconds(event.duration);
+            } else {
+                writer.append(",\"s\":\"t\",\"args\":{\"value\":");
+                writer.appendUnsigned(event.value);
+                writer.appendCharacter('}');
+            }
+            writer.append(",\"pid\":");
+            writer.appendUnsigned(processID);
+            writer.append(",\"tid\":");
+            writer.appendUnsigned(buffer->threadIndex);
+            writer.appendCharacter('}');
+            
+            isFirstEvent = false;
+        }
+    }
+    writer.append("\n],\"displayTimeUnit\":\"ms\"}\n");
+    
+    return writer.flush();
+}
+
+bool FlightRecorder::writeChromeTraceToFile(const std::string &path) {
+    int fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd < 0) {
+        return false;
+    }
+    
+    bool isWritten = writeChromeTrace(fd);
+    return ::close(fd) == 0 && isWritten;
+}
+
+void FlightRecorder::installCrashHandler(const std::string &path) {
+    if (path.size() >= sizeof(crashTracePath)) {
+        throw std::logic_error("Expected the crash trace path to be shorter than PATH_MAX.");
+    }
+    
+    // Copied up front, since the handler may not allocate.
+    std::memcpy(crashTracePath, path.c_str(), path.size() + 1);
+    
+    struct sigaction action;
+    std::memset(&action, 0, sizeof(action));
+    action.sa_handler = handleCrash;
+    action.sa_flags = SA_RESETHAND;
+    sigemptyset(&action.sa_mask);
+    
+    for (int signalNumber : {SIGSEGV, SIGBUS, SIGILL, SIGFPE, SIGABRT}) {
+        sigaction(signalNumber, &action, nullptr);
+    }
+}
@@ -0,0 +1,65 @@
+//
+//  MetricsExporter.cpp
+//  remote_core
+//
+//  Created by David Moore on 10/19/26.
+//  Copyright © 2026 David Moore. All rights reserved.
+//
+
+#include <iostream>
+#include "MetricsExporter.hpp"
+
+using namespace RemoteCore;
+
+MetricsExporter::MetricsExporter(MetricsRegistry &registry, const std::string &path, std::chrono::milliseconds interval,
+                                 PublishHandler publishHandler) : registry(registry), path(path), interval(interval), publishHandler(publishHandler), isRunning(false) {
+    queue = std::make_unique<DispatchQueue>("ca.mooredev.remote_core.MetricsExporter.serial_dispatch_queue");
+}
+
+MetricsExporter::~MetricsExporter() {
+    stop();
+    
+    // Destroying the queue waits for an in-progress export.
+    queue = nullptr;
+}
+
+void MetricsExporter::start(void) {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (isRunning) {
+        return;
+    }
+    
+    isRunning = true;
+    scheduleExport();
+}
+
+void MetricsExporter::stop(void) {
+    std::lock_guard<std::mutex> lock(mutex);
+    isRunning = false;
+    timer.cancel();
+}
+
+void MetricsExporter::scheduleExport(void) {
+    timer = queue->executeAfter(interval, [this]() {
+        this->exportMetrics();
+        
+        std::lock_guard<std::mutex> lock(mutex);
+        if (isRunning) {
+            scheduleExport();
+        }
+    });
+}
+
+void MetricsExporter::exportMetrics(void) {
+    queue->execute([this]() {
+        auto families = registry.collect();
+        
+        if (!path.empty() && !MetricsRegistry::writePrometheusTextToFile(families, path)) {
+            std::cerr << "Unable to write the metrics to '" << path << "'." << std::endl;
+        }
+        
+        if (publishHandler) {
+            publishHandler(MetricsRegistry::formatJSON(families));
+        }
+    });
+}
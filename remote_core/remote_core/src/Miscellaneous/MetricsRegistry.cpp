@@ -0,0 +1,311 @@
+//
+//  MetricsRegistry.cpp
+//  remote_core
+//
+//  Created by David Moore on 10/19/26.
+//  Copyright © 2026 David Moore. All rights reserved.
+//
+
+#include <cctype>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+#include <stdexcept>
+#include "MetricsRegistry.hpp"
+#include "DispatchQueue.hpp"
+#include "nlohmann/json.hpp"
+
+using namespace RemoteCore;
+
+namespace {
+    bool isValidMetricName(const std::string &name) {
+        if (name.empty() || std::isdigit((unsigned char)name[0])) {
+            return false;
+        }
+        
+        return std::all_of(name.begin(), name.end(), [](char character) {
+            return std::isalnum((unsigned char)character) || character == '_' || character == ':';
+        });
+    }
+    
+    std::string escapeText(const std::string &text, bool escapesQuotes) {
+        std::string escapedText;
+        for (char character : text) {
+            if (character == '\\') {
+                escapedText += "\\\\";
+            } else if (character == '\n') {
+                escapedText += "\\n";
+            } else if (character == '"' && escapesQuotes) {
+                escapedText += "\\\"";
+            } else {
+                escapedText += character;
+            }
+        }
+        
+        return escapedText;
+    }
+    
+    /**
+     Formats the labels as '{name="value",...}', with an extra label appended if given, or returns an empty string if there are no labels.
+     */
+    std::string formatLabels(const MetricLabels &labels, const std::string &extraName = "", const std::string &extraValue = "") {
+        MetricLabels allLabels = labels;
+        if (!extraName.empty()) {
+            allLabels.emplace_back(extraName, extraValue);
+        }
+        
+        if (allLabels.empty()) {
+            return "";
+        }
+        
+        std::string text = "{";
+        for (size_t i = 0; i < allLabels.size(); i++) {
+            text += (i == 0 ? "" : ",") + allLabels[i].first + "=\"" + escapeText(allLabels[i].second, true) + "\"";
+        }
+        
+        return text + "}";
+    }
+    
+    std::string formatValue(double value) {
+        std::ostringstream stream;
+        if (std::floor(value) == value && std::fabs(value) < 1e15) {
+            stream << (int64_t)value;
+        } else {
+            stream << std::setprecision(15) << value;
+        }
+        
+        return stream.str();
+    }
+    
+    /**
+     Adds the statistics of every dispatch queue, merging queues with the same name into a single series.
+     */
+    void collectDispatchStatistics(std::vector<MetricFamily> &families) {
+        std::map<std::string, DispatchQueueStatistics> statisticsByName;
+        for (auto &statistics : DispatchQueue::statisticsForAllQueues()) {
+            auto &mergedStatistics = statisticsByName[statistics.name];
+            mergedStatistics.enqueuedBlockCount += statistics.enqueuedBlockCount;
+            mergedStatistics.completedBlockCount += statistics.completedBlockCount;
+            mergedStatistics.longRunningBlockCount += statistics.longRunningBlockCount;
+            mergedStatistics.currentDepth += statistics.currentDepth;
+            mergedStatistics.waitTime.merge(statistics.waitTime);
+            mergedStatistics.executionTime.merge(statistics.executionTime);
+        }
+        
+        MetricFamily enqueued = {"remote_core_dispatch_enqueued_blocks_total", "Blocks executed on each dispatch queue.", MetricType::Counter};
+        MetricFamily completed = {"remote_core_dispatch_completed_blocks_total", "Blocks that finished running on each dispatch queue.", MetricType::Counter};
+        MetricFamily longRunning = {"remote_core_dispatch_long_running_blocks_total", "Blocks that ran for longer than the long-running threshold of their queue.", MetricType::Counter};
+        MetricFamily depth = {"remote_core_dispatch_queue_depth", "Blocks waiting to start on each dispatch queue.", MetricType::Gauge};
+        MetricFamily waitTime = {"remote_core_dispatch_wait_seconds", "Time from a block being executed on a dispatch queue until it started.", MetricType::Histogram};
+        MetricFamily executionTime = {"remote_core_dispatch_execution_seconds", "Time each block took to run on a dispatch queue.", MetricType::Histogram};
+        
+        for (auto &entry : statisticsByName) {
+            MetricLabels labels = {{"queue", entry.first}};
+            auto &statistics = entry.second;
+            
+            enqueued.samples.push_back({labels, (double)statistics.enqueuedBlockCount});
+            completed.samples.push_back({labels, (double)statistics.completedBlockCount});
+            longRunning.samples.push_back({labels, (double)statistics.longRunningBlockCount});
+            depth.samples.push_back({labels, (double)statistics.currentDepth});
+            waitTime.samples.push_back({labels, 0, statistics.waitTime});
+            executionTime.samples.push_back({labels, 0, statistics.executionTime});
+        }
+        
+        for (auto family : {&enqueued, &completed, &longRunning, &depth, &waitTime, &executionTime}) {
+            families.push_back(std::move(*family));
+        }
+    }
+}
+
+// MARK: - Registration
+
+MetricsRegistry &MetricsRegistry::sharedRegistry(void) {
+    // Never destroyed, since metrics may be recorded by objects with static storage duration.
+    static MetricsRegistry *registry = []() {
+        auto registry = new MetricsRegistry();
+        registry->addCollector(collectDispatchStatistics);
+        return registry;
+    }();
+    
+    return *registry;
+}
+
+MetricsRegistry::Series &MetricsRegistry::seriesForMetric(const std::string &name, const std::string &help, MetricType type, const MetricLabels &labels) {
+    if (!isValidMetricName(name)) {
+        throw std::logic_error("Expected a valid metric name.");
+    }
+    
+    std::lock_guard<std::mutex> lock(mutex);
+    auto position = families.find(name);
+    if (position == families.end()) {
+        position = families.emplace(name, Family{help, type, {}}).first;
+    } else if (position->second.type != type) {
+        throw std::logic_error("Expected '" + name + "' to be registered as a single type of metric.");
+    }
+    
+    auto &family = position->second;
+    for (auto &series : family.series) {
+        if (series->labels == labels) {
+            return *series;
+        }
+    }
+    
+    auto series = std::make_unique<Series>();
+    series->labels = labels;
+    switch (type) {
+        case MetricType::Counter:
+            series->counter = std::make_unique<MetricCounter>();
+            break;
+        case MetricType::Gauge:
+            series->gauge = std::make_unique<MetricGauge>();
+            break;
+        case MetricType::Histogram:
+            series->histogram = std::make_unique<MetricHistogram>();
+            break;
+    }
+    
+    family.series.push_back(std::move(series));
+    return *family.series.back();
+}
+
+MetricCounter &MetricsRegistry::counter(const std::string &name, const std::string &help, const MetricLabels &labels) {
+    return *seriesForMetric(name, help, MetricType::Counter, labels).counter;
+}
+
+MetricGauge &MetricsRegistry::gauge(const std::string &name, const std::string &help, const MetricLabels &labels) {
+    return *seriesForMetric(name, help, MetricType::Gauge, labels).gauge;
+}
+
+MetricHistogram &MetricsRegistry::histogram(const std::string &name, const std::string &help, const MetricLabels &labels) {
+    return *seriesForMetric(name, help, MetricType::Histogram, labels).histogram;
+}
+
+void MetricsRegistry::addCollector(Collector collector) {
+    std::lock_guard<std::mutex> lock(mutex);
+    collectors.push_back(collector);
+}
+
+// MARK: - Collection
+
+std::vector<MetricFamily> MetricsRegistry::collect(void) const {
+    std::vector<MetricFamily> snapshot;
+    std::vector<Collector> currentCollectors;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        for (auto &entry : families) {
+            MetricFamily family = {entry.first, entry.second.help, entry.second.type};
+            for (auto &series : entry.second.series) {
+                MetricSample sample;
+                sample.labels = series->labels;
+                if (series->counter != nullptr) {
+                    sample.value = (double)series->counter->getValue();
+                } else if (series->gauge != nullptr) {
+                    sample.value = (double)series->gauge->getValue();
+                } else {
+                    sample.histogram = series->histogram->getSnapshot();
+                }
+                
+                family.samples.push_back(std::move(sample));
+            }
+            
+            snapshot.push_back(std::move(family));
+        }
+        
+        currentCollectors = collectors;
+    }
+    
+    // Collectors are called outside of the lock, so that they may record metrics of their own.
+    for (auto &collector : currentCollectors) {
+        collector(snapshot);
+    }
+    
+    std::sort(snapshot.begin(), snapshot.end(), [](const MetricFamily &a, const MetricFamily &b) {
+        return a.name < b.name;
+    });
+    
+    return snapshot;
+}
+
+// MARK: - Exporting
+
+std::string MetricsRegistry::formatPrometheusText(const std::vector<MetricFamily> &families) {
+    static const char *typeNames[] = {"counter", "gauge", "histogram"};
+    
+    std::string text;
+    for (auto &family : families) {
+        text += "# HELP " + family.name + " " + escapeText(family.help, false) + "\n";
+        text += "# TYPE " + family.name + " " + typeNames[(int)family.type] + "\n";
+        
+        for (auto &sample : family.samples) {
+            if (family.type != MetricType::Histogram) {
+                text += family.name + formatLabels(sample.labels) + " " + formatValue(sample.value) + "\n";
+                continue;
+            }
+            
+            // The last bucket also counts every longer duration, so it is only represented by '+Inf'.
+            auto &histogram = sample.histogram;
+            uint64_t cumulativeCount = 0;
+            for (size_t i = 0; i + 1 < LatencyHistogram::bucketCount; i++) {
+                cumulativeCount += histogram.buckets[i];
+                
+                // Bucket 'i' holds durations below 2^i microseconds, which is exact in ten significant digits.
+                std::ostringstream upperBound;
+                upperBound << std::setprecision(10) << std::ldexp(1.0, (int)i) / 1e6;
+                text += family.name + "_bucket" + formatLabels(sample.labels, "le", upperBound.str()) + " " + std::to_string(cumulativeCount) + "\n";
+            }
+            
+            text += family.name + "_bucket" + formatLabels(sample.labels, "le", "+Inf") + " " + std::to_string(histogram.count) + "\n";
+            text += family.name + "_sum" + formatLabels(sample.labels) + " " + formatValue(histogram.totalMicroseconds / 1e6) + "\n";
+            text += family.name + "_count" + formatLabels(sample.labels) + " " + std::to_string(histogram.count) + "\n";
+        }
+    }
+    
+    return text;
+}
+
+std::string MetricsRegistry::formatJSON(const std::vector<MetricFamily> &families) {
+    auto object = nlohmann::json::object();
+    for (auto &family : families) {
+        for (auto &sample : family.samples) {
+            auto key = family.name + formatLabels(sample.labels);
+            if (family.type != MetricType::Histogram) {
+                object[key] = sample.value;
+                continue;
+            }
+            
+            auto &histogram = sample.histogram;
+            object[key] = {
+                {"count", histogram.count},
+                {"mean_us", histogram.getMean().count()},
+                {"p50_us", histogram.getPercentile(0.5).count()},
+                {"p99_us", histogram.getPercentile(0.99).count()},
+                {"max_us", histogram.maximumMicroseconds}
+            };
+        }
+    }
+    
+    return object.dump();
+}
+
+bool MetricsRegistry::writePrometheusTextToFile(const std::vector<MetricFamily> &families, const std::string &path) {
+    auto temporaryPath = path + ".tmp";
+    {
+        std::ofstream stream(temporaryPath, std::ios::out | std::ios::trunc);
+        stream << formatPrometheusText(families);
+        stream.close();
+        
+        if (!stream) {
+            std::remove(temporaryPath.c_str());
+            return false;
+        }
+    }
+    
+    if (std::rename(temporaryPath.c_str(), path.c_str()) != 0) {
+        std::remove(temporaryPath.c_str());
+        return false;
+    }
+    
+    return true;
+}
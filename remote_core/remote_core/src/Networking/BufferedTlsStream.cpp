@@ -0,0 +1,223 @@
+//
+//  BufferedTlsStream.cpp
+//  remote_core
+//
+//  Created by David Moore on 10/19/26.
+//  Copyright © 2026 David Moore. All rights reserved.
+//
+
+#include "BufferedTlsStream.hpp"
+#include "FlightRecorder.hpp"
+#include <algorithm>
+#include <cerrno>
+#include <climits>
+#include <system_error>
+#include <poll.h>
+#include <unistd.h>
+#include <openssl/err.h>
+#include <openssl/ssl.h>
+
+#ifdef __linux__
+#include <sys/epoll.h>
+#endif
+
+using namespace RemoteCore;
+
+#ifdef __linux__
+static int makePollDescriptor(int fd, uint32_t events) {
+    int pollFD = epoll_create1(EPOLL_CLOEXEC);
+    if (pollFD < 0) {
+        throw std::system_error(errno, std::system_category(), "epoll_create1");
+    }
+    
+    // Edge-triggered, so that the socket never has to be modified between waits. Waits only follow an operation that stopped for lack of readiness, so the edge that ends them is never missed.
+    struct epoll_event event = {};
+    event.events = events | EPOLLET;
+    event.data.fd = fd;
+    if (epoll_ctl(pollFD, EPOLL_CTL_ADD, fd, &event) != 0) {
+        int error = errno;
+        close(pollFD);
+        throw std::system_error(error, std::system_category(), "epoll_ctl");
+    }
+    
+    return pollFD;
+}
+#endif
+
+BufferedTlsStream::BufferedTlsStream(SSL *ssl, int fd, bool usesReadAhead) : ssl(ssl), fd(fd), readPollFD(-1), writePollFD(-1), usesReadAhead(usesReadAhead) {
+#ifdef __linux__
+    readPollFD = makePollDescriptor(fd, EPOLLIN | EPOLLRDHUP);
+    try {
+        writePollFD = makePollDescriptor(fd, EPOLLOUT);
+    } catch (...) {
+        close(readPollFD);
+        throw;
+    }
+#endif
+
+    // Lets one 'recv' fetch several records, which OpenSSL then decrypts without further system calls.
+    bool isOpenSSLReadingAhead = usesReadAhead;
+#ifdef SSL_OP_ENABLE_KTLS
+    // Records that OpenSSL has already read when the keys change cannot always be handed to the kernel, which would then keep receiving in userspace. Without OpenSSL's read-ahead, the buffer still serves small reads.
+    if ((SSL_get_options(ssl) & SSL_OP_ENABLE_KTLS) != 0) {
+        isOpenSSLReadingAhead = false;
+    }
+#endif
+    
+    if (isOpenSSLReadingAhead) {
+        SSL_set_read_ahead(ssl, 1);
+    }
+}
+
+BufferedTlsStream::~BufferedTlsStream() {
+    for (int pollFD : {readPollFD, writePollFD}) {
+        if (pollFD >= 0) {
+            close(pollFD);
+        }
+    }
+}
+
+// MARK: - Waiting
+
+TlsStreamStatus BufferedTlsStream::waitForReadiness(bool isReading, Clock::time_point deadline) {
+    while (true) {
+        auto now = Clock::now();
+        if (now >= deadline) {
+            return TlsStreamStatus::TimedOut;
+        }
+        
+        // Rounded up, so that the wait does not end just before the deadline.
+        auto remaining = std::chrono::duration_cast<std::chrono::milliseconds>(deadline - now + std::chrono::microseconds(999));
+        int timeout = (int)std::min<int64_t>(remaining.count(), INT_MAX);
+        (isReading ? statistics.readWaitCount : statistics.writeWaitCount)++;
+
+#ifdef __linux__
+        struct epoll_event event;
+        int eventCount = epoll_wait(isReading ? readPollFD : writePollFD, &event, 1, timeout);
+#else
+        struct pollfd descriptor = {fd, (short)(isReading ? POLLIN : POLLOUT), 0};
+        int eventCount = poll(&descriptor, 1, timeout);
+#endif
+
+        if (eventCount < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            
+            return TlsStreamStatus::Failed;
+        }
+        
+        // Errors end the wait as well, so that the next operation reports them.
+        if (eventCount > 0) {
+            return TlsStreamStatus::Complete;
+        }
+    }
+}
+
+TlsStreamStatus BufferedTlsStream::waitForError(int error, Clock::time_point deadline) {
+    switch (error) {
+        case SSL_ERROR_WANT_READ:
+            return waitForReadiness(true, deadline);
+        case SSL_ERROR_WANT_WRITE:
+            return waitForReadiness(false, deadline);
+        case SSL_ERROR_ZERO_RETURN:
+            return TlsStreamStatus::Closed;
+        default:
+            return TlsStreamStatus::Failed;
+    }
+}
+
+// MARK: - Operations
+
+TlsStreamStatus BufferedTlsStream::connect(Clock::time_point deadline) {
+    REMOTE_CORE_TRACE_SCOPE("tls", "handshake");
+    while (true) {
+        ERR_clear_error();
+        int result = SSL_connect(ssl);
+        if (result == 1) {
+            return TlsStreamStatus::Complete;
+        }
+        
+        auto status = waitForError(SSL_get_error(ssl, result), deadline);
+        if (status != TlsStreamStatus::Complete) {
+            return status;
+        }
+    }
+}
+
+TlsStreamResult BufferedTlsStream::read(char *bytes, size_t length, Clock::time_point deadline) {
+    size_t totalLength = readAheadBuffer.read(bytes, length);
+    if (totalLength == length) {
+        statistics.bufferedReadCount++;
+        return TlsStreamResult(TlsStreamStatus::Complete, totalLength);
+    }
+    
+    REMOTE_CORE_TRACE_SCOPE("tls", "read");
+    while (totalLength < length) {
+        // Reads too large for the buffer go straight to the caller's bytes, rather than being copied.
+        size_t remainingLength = length - totalLength;
+        bool isDirect = !usesReadAhead || remainingLength >= READ_AHEAD_BUFFER_CAPACITY;
+        size_t spanLength = remainingLength;
+        char *span = isDirect ? bytes + totalLength : readAheadBuffer.getFreeSpace(spanLength);
+        
+        ERR_clear_error();
+        int result = SSL_read(ssl, span, (int)std::min<size_t>(spanLength, INT_MAX));
+        statistics.sslReadCount++;
+        if (result > 0) {
+            if (isDirect) {
+                totalLength += (size_t)result;
+            } else {
+                readAheadBuffer.commit((size_t)result);
+                totalLength += readAheadBuffer.read(bytes + totalLength, remainingLength);
+            }
+            
+            continue;
+        }
+        
+        auto status = waitForError(SSL_get_error(ssl, result), deadline);
+        if (status != TlsStreamStatus::Complete) {
+            return TlsStreamResult(status, totalLength);
+        }
+    }
+    
+    return TlsStreamResult(TlsStreamStatus::Complete, totalLength);
+}
+
+TlsStreamResult BufferedTlsStream::write(const char *bytes, size_t length, Clock::time_point deadline) {
+    REMOTE_CORE_TRACE_SCOPE("tls", "write");
+    size_t totalLength = 0;
+    while (totalLength < length) {
+        ERR_clear_error();
+        int result = SSL_write(ssl, bytes + totalLength, (int)std::min<size_t>(length - totalLength, INT_MAX));
+        if (result > 0) {
+            totalLength += (size_t)result;
+            continue;
+        }
+        
+        auto status = waitForError(SSL_get_error(ssl, result), deadline);
+        if (status != TlsStreamStatus::Complete) {
+            return TlsStreamResult(status, totalLength);
+        }
+    }
+    
+    return TlsStreamResult(TlsStreamStatus::Complete, totalLength);
+}
+
+TlsStreamStatus BufferedTlsStream::shutdown(Clock::time_point deadline) {
+    readAheadBuffer.release();
+    
+    while (true) {
+        ERR_clear_error();
+        int result = SSL_shutdown(ssl);
+        if (result == 1) {
+            return TlsStreamStatus::Complete;
+        }
+        
+        // Zero means the close notification was sent, and the peer's has not arrived yet.
+        int error = result == 0 ? SSL_ERROR_WANT_READ : SSL_get_error(ssl, result);
+        auto status = waitForError(error, deadline);
+        if (status != TlsStreamStatus::Complete) {
+            return status;
+        }
+    }
+}
@@ -12,6 +12,7 @@
 #include "ConnectionManager.hpp"
 #include "OpenSSLConnection.hpp"
 #include "ConfigCommon.hpp"
+#include "FlightRecorder.hpp"
 #include "util/logging/Logging.hpp"
 #include "util/logging/LogMacros.hpp"
 #include "util/logging/ConsoleLogSystem.hpp"
@@ -19,12 +20,137 @@
 using namespace RemoteCore;
 using namespace awsiotsdk;
 
+namespace {
+    /// Metrics shared by every connection manager, which are looked up once.
+    struct ConnectionMetrics {
+        MetricCounter &publishedMessages;
+        MetricCounter &failedPublishes;
+        MetricCounter &refusedPublishes;
+        MetricGauge &pendingMessages;
+        MetricHistogram &publishLatency;
+        MetricCounter &receivedMessages;
+        MetricGauge &isConnected;
+        MetricCounter &connectionLosses;
+    };
+    
+    ConnectionMetrics &connectionMetrics(void) {
+        auto &registry = MetricsRegistry::sharedRegistry();
+        static ConnectionMetrics metrics = {
+            registry.counter("remote_core_mqtt_published_messages_total", "Messages that were published.", {{"result", "success"}}),
+            registry.counter("remote_core_mqtt_published_messages_total", "Messages that were published.", {{"result", "failure"}}),
+            registry.counter("remote_core_mqtt_refused_messages_total", "Messages that were refused because the publish backlog was full."),
+            registry.gauge("remote_core_mqtt_pending_messages", "Messages that have been sent, but not acknowledged yet."),
+            registry.histogram("remote_core_mqtt_publish_latency_seconds", "Time from a message being submitted until it was acknowledged."),
+            registry.counter("remote_core_mqtt_received_messages_total", "Messages that were received on subscribed topics."),
+            registry.gauge("remote_core_mqtt_connected", "Whether the connection with the endpoint is established."),
+            registry.counter("remote_core_mqtt_connection_losses_total", "Times the connection with the endpoint was lost.")
+        };
+        
+        return metrics;
+    }
+}
+
 // MARK: - Connection Manager Implementation
 
 ConnectionManager::ConnectionManager(const std::string &configFileRelativePath,
                                      const awsiotsdk::mqtt::QoS qualityOfService) : currentPendingMessages(0), totalPublishedMessages(0), qualityOfService(qualityOfService) {
-    // Initialize the common configuration then create an SSL connection.
+    // Initialize the common configuration then create the client.
     ConfigCommon::InitializeCommon(configFileRelativePath);
+    sessionCache = std::make_shared<TlsSessionCache>(ConfigCommon::tls_session_cache_path_);
+    if (ConfigCommon::use_builtin_mqtt_client_) {
+        createMqttConnection();
+    } else {
+        createSDKClient();
+    }
+    
+    // Keep within both the number of acknowledgements the client waits for and the length of its action queue.
+    size_t publishWindowSize = std::max<size_t>(1, std::min(ConfigCommon::max_pending_acks_, ConfigCommon::maximum_outgoing_action_queue_length_));
+    publishPipeline = std::make_unique<PublishPipeline<OutboundPublish>>(publishWindowSize, CONNECTION_MANAGER_PUBLISH_BACKLOG_CAPACITY, [this](std::vector<OutboundPublish> batch) {
+        this->sendPublishes(std::move(batch));
+    });
+    
+    // Process the client ID.
+    auto clientIDTagged = ConfigCommon::base_client_id_;
+    //clientIDTagged.append("");
+    clientID = Utf8String::Create(clientIDTagged);
+}
+
+/**
+ Converts the status of the built-in client into the response code the SDK's client would have used.
+ */
+static ResponseCode responseCodeForStatus(MqttStatus status) {
+    switch (status) {
+        case MqttStatus::Success:
+            return ResponseCode::SUCCESS;
+        case MqttStatus::ConnectFailed:
+            return ResponseCode::NETWORK_TCP_CONNECT_ERROR;
+        case MqttStatus::ConnectionRefused:
+            return ResponseCode::MQTT_CONNACK_UNKNOWN_ERROR;
+        case MqttStatus::Timeout:
+            return ResponseCode::MQTT_REQUEST_TIMEOUT_ERROR;
+        case MqttStatus::SubscriptionRefused:
+            return ResponseCode::MQTT_SUBSCRIBE_FAILED;
+        case MqttStatus::ProtocolError:
+            return ResponseCode::MQTT_UNEXPECTED_PACKET_FORMAT_ERROR;
+        case MqttStatus::PacketTooLarge:
+            // The SDK's client has no equivalent, since it never learns the broker's limit.
+            return ResponseCode::FAILURE;
+        case MqttStatus::NotConnected:
+        case MqttStatus::ConnectionLost:
+        case MqttStatus::Cancelled:
+            return ResponseCode::NETWORK_DISCONNECTED_ERROR;
+    }
+    
+    return ResponseCode::FAILURE;
+}
+
+void ConnectionManager::createMqttConnection(void) {
+    MqttConnectionOptions options;
+    options.host = ConfigCommon::endpoint_;
+    options.port = ConfigCommon::endpoint_mqtt_port_;
+    options.clientID = ConfigCommon::base_client_id_;
+    options.keepAliveInterval = ConfigCommon::keep_alive_timeout_secs_;
+    options.isCleanSession = ConfigCommon::is_clean_session_;
+    options.commandTimeout = ConfigCommon::mqtt_command_timeout_;
+    options.minimumReconnectInterval = ConfigCommon::minimum_reconnect_interval_;
+    options.maximumReconnectInterval = ConfigCommon::maximum_reconnect_interval_;
+    
+    options.usesTLS = true;
+    options.tlsConfiguration.rootCAPath = ConfigCommon::root_ca_path_;
+    options.tlsConfiguration.certificatePath = ConfigCommon::client_cert_path_;
+    options.tlsConfiguration.privateKeyPath = ConfigCommon::client_key_path_;
+    options.tlsConfiguration.serverName = ConfigCommon::endpoint_;
+    options.tlsConfiguration.sessionCache = sessionCache;
+    options.tlsConfiguration.usesKernelTls = ConfigCommon::tls_kernel_offload_;
+    options.tlsConfiguration.cipherPolicy = ConfigCommon::tls_cipher_policy_;
+    if (ConfigCommon::endpoint_mqtt_port_ == 443) {
+        // The IoT Core only accepts MQTT on the HTTPS port when it is negotiated with ALPN.
+        options.tlsConfiguration.applicationProtocol = "x-amzn-mqtt-ca";
+    }
+    
+    if (ConfigCommon::use_mqtt_5_) {
+        options.protocolLevel = MQTT_5_PROTOCOL_LEVEL;
+        options.topicAliasMaximum = ConfigCommon::mqtt_topic_alias_maximum_;
+    }
+    
+    mqttConnection = std::make_unique<MqttConnection>(options);
+    mqttConnection->setPublishHandler([this](const std::string &topicName, const SharedBuffer &payload, const MqttProperties &properties) {
+        connectionMetrics().receivedMessages.increment();
+        topicRouter.route(topicName, payload.toString(), properties);
+    });
+    
+    mqttConnection->setConnectionHandler([this](bool isConnected, bool isSessionPresent) {
+        // Without a session, the broker has forgotten every subscription.
+        if (isConnected && !isSessionPresent) {
+            resubscribeToAllTopics(nullptr);
+        }
+        
+        notifyConnectionHandler(isConnected);
+    });
+}
+
+void ConnectionManager::createSDKClient(void) {
+    // Create an SSL connection.
     auto tlsConnection = std::make_shared<network::OpenSSLConnection>(ConfigCommon::endpoint_,
                                                                       ConfigCommon::endpoint_mqtt_port_,
                                                                       ConfigCommon::root_ca_path_,
@@ -34,6 +160,9 @@ ConnectionManager::ConnectionManager(const std::string &configFileRelativePath,
                                                                       ConfigCommon::tls_read_timeout_,
                                                                       ConfigCommon::tls_write_timeout_,
                                                                       true);
+    tlsConnection->SetSessionCache(sessionCache);
+    tlsConnection->SetKernelTlsEnabled(ConfigCommon::tls_kernel_offload_);
+    tlsConnection->SetCipherPolicy(ConfigCommon::tls_cipher_policy_);
     
     // Initialize the TLS connection.
     ResponseCode responseCode = tlsConnection->Initialize();
@@ -74,14 +203,20 @@ ConnectionManager::ConnectionManager(const std::string &configFileRelativePath,
     
     // Configure the client.
     client->SetAutoReconnectEnabled(true);
-    
-    // Process the client ID.
-    auto clientIDTagged = ConfigCommon::base_client_id_;
-    //clientIDTagged.append("");
-    clientID = Utf8String::Create(clientIDTagged);
 }
 
 ResponseCode ConnectionManager::resumeConnection() {
+    if (mqttConnection != nullptr) {
+        DispatchPromise<MqttStatus> promise;
+        mqttConnection->connect([promise](MqttStatus status) mutable {
+            promise.resolve(status);
+        });
+        
+        // Connecting is bounded by the command timeout, so the future is always resolved.
+        auto status = promise.getFuture().get();
+        return status == MqttStatus::Success ? ResponseCode::MQTT_CONNACK_CONNECTION_ACCEPTED : responseCodeForStatus(status);
+    }
+    
     // Prevent connecting multiple times.
     if (client->IsConnected()) {
         return ResponseCode::SUCCESS;
@@ -95,122 +230,410 @@ ResponseCode ConnectionManager::resumeConnection() {
                                                 std::move(clientID),
                                                 nullptr, nullptr, nullptr);
     
+    if (responseCode == ResponseCode::MQTT_CONNACK_CONNECTION_ACCEPTED) {
+        notifyConnectionHandler(true);
+    }
+    
     return responseCode;
 }
 
 ResponseCode ConnectionManager::suspendConnection(void) {
+    if (mqttConnection != nullptr) {
+        DispatchPromise<MqttStatus> promise;
+        mqttConnection->disconnect([promise](MqttStatus status) mutable {
+            promise.resolve(status);
+        });
+        
+        return responseCodeForStatus(promise.getFuture().get());
+    }
+    
     // Prevent disconnecting if already disconnected.
     if (!client->IsConnected()) {
         return ResponseCode::SUCCESS;
     }
     
     // Disconnect from the MQTT connection.
-    return client->Disconnect(ConfigCommon::mqtt_command_timeout_);
+    ResponseCode responseCode = client->Disconnect(ConfigCommon::mqtt_command_timeout_);
+    notifyConnectionHandler(false);
+    
+    return responseCode;
 }
 
+bool ConnectionManager::isConnected(void) const {
+    if (mqttConnection != nullptr) {
+        return mqttConnection->isConnected();
+    }
+    
+    return client->IsConnected();
+}
+
+void ConnectionManager::setConnectionHandler(ConnectionHandler connectionHandler) {
+    std::lock_guard<std::mutex> lock(connectionHandlerMutex);
+    this->connectionHandler = connectionHandler;
+}
+
+void ConnectionManager::notifyConnectionHandler(bool isConnected) {
+    auto &metrics = connectionMetrics();
+    if (!isConnected && metrics.isConnected.getValue() != 0) {
+        metrics.connectionLosses.increment();
+    }
+    
+    metrics.isConnected.set(isConnected ? 1 : 0);
+    
+    ConnectionHandler handler;
+    {
+        std::lock_guard<std::mutex> lock(connectionHandlerMutex);
+        handler = connectionHandler;
+    }
+    
+    if (handler) {
+        handler(isConnected);
+    }
+}
+
+/**
+ Combines the response codes of the packets that make up a batch, and calls the completion handler once with the first failure, or success.
+ */
+struct ConnectionManager::BatchCompletion {
+    std::mutex mutex;
+    size_t pendingPacketCount;
+    ResponseCode responseCode;
+    CompletionHandler completionHandler;
+    
+    BatchCompletion(size_t packetCount, CompletionHandler completionHandler) : pendingPacketCount(packetCount), responseCode(ResponseCode::SUCCESS), completionHandler(completionHandler) {}
+    
+    void completePacket(ResponseCode packetResponseCode) {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (packetResponseCode != ResponseCode::SUCCESS && responseCode == ResponseCode::SUCCESS) {
+                responseCode = packetResponseCode;
+            }
+            
+            if (--pendingPacketCount > 0) {
+                return;
+            }
+        }
+        
+        if (completionHandler) {
+            completionHandler(responseCode);
+        }
+    }
+};
+
 void ConnectionManager::subscribeToTopic(const std::string &topicName, MessageHandler messageHandler,
                                          CompletionHandler completionHandler) {
-    auto topicNamePtr = Utf8String::Create(topicName);
+    subscribeToTopics(std::vector<std::string>({topicName}), messageHandler, completionHandler);
+}
+
+void ConnectionManager::subscribeToTopics(const std::vector<std::string> &topicNames, MessageHandler messageHandler,
+                                          CompletionHandler completionHandler) {
+    if (topicNames.empty()) {
+        if (completionHandler) {
+            completionHandler(ResponseCode::SUCCESS);
+        }
+        
+        return;
+    }
+    
     mqtt::Subscription::ApplicationCallbackHandlerPtr subscriptionHandler =
     std::bind(&ConnectionManager::subscribeCallback,
               this, std::placeholders::_1,
               std::placeholders::_2,
               std::placeholders::_3);
     
-    auto subscription = mqtt::Subscription::Create(std::move(topicNamePtr), qualityOfService, subscriptionHandler, nullptr);
-    util::Vector<std::shared_ptr<mqtt::Subscription>> subscriptionVector;
-    subscriptionVector.push_back(subscription);
+    // Every packet is sent without waiting for the previous acknowledgement, so the batch takes a single round trip.
+    size_t packetCount = (topicNames.size() + CONNECTION_MANAGER_MAX_TOPICS_PER_PACKET - 1) / CONNECTION_MANAGER_MAX_TOPICS_PER_PACKET;
+    auto batchCompletion = std::make_shared<BatchCompletion>(packetCount, completionHandler);
     
-    uint16_t packet_id_out;
-    client->SubscribeAsync(subscriptionVector, [&, messageHandler, completionHandler, topicName](uint16_t actionID, ResponseCode responseCode) {
-        if (responseCode == ResponseCode::SUCCESS) {
-            {
-                std::lock_guard<std::mutex> lock(subscribedTopicNamesMutex);
-                subscribedTopicNames.push_back(topicName);
+    for (size_t start = 0; start < topicNames.size(); start += CONNECTION_MANAGER_MAX_TOPICS_PER_PACKET) {
+        auto end = std::min(start + CONNECTION_MANAGER_MAX_TOPICS_PER_PACKET, topicNames.size());
+        std::vector<std::string> packetTopicNames(topicNames.begin() + start, topicNames.begin() + end);
+        auto handleResponse = [this, messageHandler, batchCompletion, packetTopicNames](ResponseCode responseCode) {
+            if (responseCode == ResponseCode::SUCCESS) {
+                this->addSubscribedTopicNames(packetTopicNames, messageHandler);
             }
             
-            if (messageHandler) {
-                std::lock_guard<std::mutex> lock(messageHandlersByTopicNameMutex);
-                messageHandlersByTopicName.emplace(std::make_pair(topicName, messageHandler));
-            }
+            batchCompletion->completePacket(responseCode);
+        };
+        
+        if (mqttConnection != nullptr) {
+            mqttConnection->subscribe(packetTopicNames, (uint8_t)qualityOfService, [handleResponse](MqttStatus status) {
+                handleResponse(responseCodeForStatus(status));
+            });
+            
+            continue;
         }
         
-        if (completionHandler) {
-            completionHandler(responseCode);
+        util::Vector<std::shared_ptr<mqtt::Subscription>> subscriptionVector;
+        for (auto &topicName : packetTopicNames) {
+            subscriptionVector.push_back(mqtt::Subscription::Create(Utf8String::Create(topicName), qualityOfService, subscriptionHandler, nullptr));
+        }
+        
+        uint16_t packetIDOut;
+        auto responseCode = client->SubscribeAsync(subscriptionVector, [handleResponse](uint16_t actionID, ResponseCode responseCode) {
+            handleResponse(responseCode);
+        }, packetIDOut);
+        
+        // The acknowledgement handler is never called for packets that could not be sent.
+        if (responseCode != ResponseCode::SUCCESS) {
+            handleResponse(responseCode);
         }
-    }, packet_id_out);
+    }
+}
+
+void ConnectionManager::addSubscribedTopicNames(const std::vector<std::string> &topicNames, MessageHandler messageHandler) {
+    {
+        // Resubscribing must not duplicate the topic names.
+        std::lock_guard<std::mutex> lock(subscribedTopicNamesMutex);
+        for (auto &topicName : topicNames) {
+            if (std::find(subscribedTopicNames.begin(), subscribedTopicNames.end(), topicName) == subscribedTopicNames.end()) {
+                subscribedTopicNames.push_back(topicName);
+            }
+        }
+    }
+    
+    if (messageHandler) {
+        for (auto &topicName : topicNames) {
+            if (TopicRouter::isValidFilter(topicName)) {
+                topicRouter.addRoute(topicName, [messageHandler](const std::string &topicName, const std::string &payload, const MqttProperties &properties) {
+                    messageHandler(topicName, payload, properties);
+                });
+            }
+        }
+    }
 }
 
 void ConnectionManager::unsubscribeFromTopic(const std::string &topicName,
                                              CompletionHandler completionHandler) {
-    auto topicNamePtr = Utf8String::Create(topicName);
-    util::Vector<std::unique_ptr<Utf8String>> topicVector;
-    topicVector.push_back(std::move(topicNamePtr));
-    
-    uint16_t packetIDOut;
-    client->UnsubscribeAsync(std::move(topicVector), [&, completionHandler, topicName](uint16_t actionID, ResponseCode responseCode) {
-        if (responseCode == ResponseCode::SUCCESS) {
-            {
-                std::lock_guard<std::mutex> lock(subscribedTopicNamesMutex);
-                auto position = std::find(subscribedTopicNames.begin(), subscribedTopicNames.end(), topicName);
-                
-                if (position != subscribedTopicNames.end()) {
-                    auto index = subscribedTopicNames.begin() + std::distance(subscribedTopicNames.begin(),
-                                                                              position);
-                    subscribedTopicNames.erase(index);
-                }
+    unsubscribeFromTopics(std::vector<std::string>({topicName}), completionHandler);
+}
+
+void ConnectionManager::unsubscribeFromTopics(const std::vector<std::string> &topicNames,
+                                              CompletionHandler completionHandler) {
+    if (topicNames.empty()) {
+        if (completionHandler) {
+            completionHandler(ResponseCode::SUCCESS);
+        }
+        
+        return;
+    }
+    
+    size_t packetCount = (topicNames.size() + CONNECTION_MANAGER_MAX_TOPICS_PER_PACKET - 1) / CONNECTION_MANAGER_MAX_TOPICS_PER_PACKET;
+    auto batchCompletion = std::make_shared<BatchCompletion>(packetCount, completionHandler);
+    
+    for (size_t start = 0; start < topicNames.size(); start += CONNECTION_MANAGER_MAX_TOPICS_PER_PACKET) {
+        auto end = std::min(start + CONNECTION_MANAGER_MAX_TOPICS_PER_PACKET, topicNames.size());
+        std::vector<std::string> packetTopicNames(topicNames.begin() + start, topicNames.begin() + end);
+        auto handleResponse = [this, batchCompletion, packetTopicNames](ResponseCode responseCode) {
+            if (responseCode == ResponseCode::SUCCESS) {
+                this->removeSubscribedTopicNames(packetTopicNames);
             }
             
-            // Attempt to erase the message handler associated with the topic.
-            std::lock_guard<std::mutex> lock(messageHandlersByTopicNameMutex);
-            messageHandlersByTopicName.erase(topicName);
+            batchCompletion->completePacket(responseCode);
+        };
+        
+        if (mqttConnection != nullptr) {
+            mqttConnection->unsubscribe(packetTopicNames, [handleResponse](MqttStatus status) {
+                handleResponse(responseCodeForStatus(status));
+            });
+            
+            continue;
         }
         
-        if (completionHandler) {
-            completionHandler(responseCode);
+        util::Vector<std::unique_ptr<Utf8String>> topicVector;
+        for (auto &topicName : packetTopicNames) {
+            topicVector.push_back(Utf8String::Create(topicName));
+        }
+        
+        uint16_t packetIDOut;
+        auto responseCode = client->UnsubscribeAsync(std::move(topicVector), [handleResponse](uint16_t actionID, ResponseCode responseCode) {
+            handleResponse(responseCode);
+        }, packetIDOut);
+        
+        if (responseCode != ResponseCode::SUCCESS) {
+            handleResponse(responseCode);
         }
-    }, packetIDOut);
+    }
+}
+
+void ConnectionManager::removeSubscribedTopicNames(const std::vector<std::string> &topicNames) {
+    {
+        std::lock_guard<std::mutex> lock(subscribedTopicNamesMutex);
+        for (auto &topicName : topicNames) {
+            auto position = std::find(subscribedTopicNames.begin(), subscribedTopicNames.end(), topicName);
+            if (position != subscribedTopicNames.end()) {
+                subscribedTopicNames.erase(position);
+            }
+        }
+    }
+    
+    // Attempt to remove the message handlers associated with the topics.
+    for (auto &topicName : topicNames) {
+        topicRouter.removeRoute(topicName);
+    }
+}
+
+void ConnectionManager::resubscribeToAllTopics(CompletionHandler completionHandler) {
+    // The message handlers are still routed, so only the subscriptions themselves need to be restored.
+    subscribeToTopics(getSubscribedTopicNames(), nullptr, completionHandler);
 }
 
-void ConnectionManager::publishMessageToTopic(const std::string &message, const std::string &topicName,
+void ConnectionManager::publishMessageToTopic(SharedBuffer message, const std::string &topicName,
                                               CompletionHandler completionHandler) {
-    auto topicNamePtr = Utf8String::Create(topicName);
-    uint16_t packetIDOut;
+    publishMessageToTopic(std::move(message), topicName, MqttProperties(), completionHandler);
+}
+
+void ConnectionManager::publishMessageToTopic(SharedBuffer message, const std::string &topicName, MqttProperties properties,
+                                              CompletionHandler completionHandler) {
+    if (!properties.hasMessageExpiryInterval && ConfigCommon::mqtt_message_expiry_interval_.count() > 0) {
+        properties.hasMessageExpiryInterval = true;
+        properties.messageExpiryInterval = (uint32_t)ConfigCommon::mqtt_message_expiry_interval_.count();
+    }
     
-    client->PublishAsync(std::move(topicNamePtr), false, false, qualityOfService, message, [&, completionHandler](uint16_t actionID, ResponseCode responseCode) {
+    OutboundPublish publish = {topicName, std::move(message), completionHandler, std::move(properties), std::chrono::steady_clock::now()};
+    if (!publishPipeline->submit(publish)) {
+        // Refuse the message, rather than letting the client's action queue drop it.
+        connectionMetrics().refusedPublishes.increment();
         if (completionHandler) {
-            completionHandler(responseCode);
+            completionHandler(ResponseCode::ACTION_QUEUE_FULL);
         }
-    }, packetIDOut);
+    }
+}
+
+void ConnectionManager::sendPublishes(std::vector<OutboundPublish> batch) {
+    REMOTE_CORE_TRACE_INSTANT("mqtt", "send_publishes", batch.size());
+    std::vector<MqttConnection::OutboundMessage> messages;
+    for (auto &publish : batch) {
+        auto completionHandler = publish.completionHandler;
+        auto submissionTime = publish.submissionTime;
+        auto handleResponse = [this, completionHandler, submissionTime](ResponseCode responseCode) {
+            REMOTE_CORE_TRACE_INSTANT("mqtt", "publish_complete", (int)responseCode);
+            auto &metrics = connectionMetrics();
+            currentPendingMessages--;
+            metrics.pendingMessages.add(-1);
+            if (responseCode == ResponseCode::SUCCESS) {
+                totalPublishedMessages++;
+                metrics.publishedMessages.increment();
+                metrics.publishLatency.recordSince(submissionTime);
+            } else {
+                metrics.failedPublishes.increment();
+            }
+            
+            publishPipeline->complete();
+            if (completionHandler) {
+                completionHandler(responseCode);
+            }
+        };
+        
+        currentPendingMessages++;
+        connectionMetrics().pendingMessages.add(1);
+        
+        if (mqttConnection != nullptr) {
+            messages.push_back({publish.topicName, std::move(publish.message), (uint8_t)qualityOfService, [handleResponse](MqttStatus status) {
+                handleResponse(responseCodeForStatus(status));
+            }, std::move(publish.properties)});
+            
+            continue;
+        }
+        
+        uint16_t packetIDOut;
+        auto responseCode = client->PublishAsync(Utf8String::Create(publish.topicName), false, false, qualityOfService, publish.message.toString(), [handleResponse](uint16_t actionID, ResponseCode responseCode) {
+            handleResponse(responseCode);
+        }, packetIDOut);
+        
+        // The acknowledgement handler is never called for messages that could not be queued.
+        if (responseCode != ResponseCode::SUCCESS) {
+            handleResponse(responseCode);
+        }
+    }
+    
+    // The built-in client writes the whole batch at once.
+    if (!messages.empty()) {
+        mqttConnection->publish(std::move(messages));
+    }
+}
+
+DispatchFuture<ResponseCode> ConnectionManager::subscribeToTopic(const std::string &topicName, MessageHandler messageHandler) {
+    DispatchPromise<ResponseCode> promise;
+    subscribeToTopic(topicName, messageHandler, [promise](ResponseCode responseCode) mutable {
+        promise.resolve(responseCode);
+    });
+    
+    return promise.getFuture();
+}
+
+DispatchFuture<ResponseCode> ConnectionManager::unsubscribeFromTopic(const std::string &topicName) {
+    DispatchPromise<ResponseCode> promise;
+    unsubscribeFromTopic(topicName, [promise](ResponseCode responseCode) mutable {
+        promise.resolve(responseCode);
+    });
+    
+    return promise.getFuture();
+}
+
+DispatchFuture<ResponseCode> ConnectionManager::subscribeToTopics(const std::vector<std::string> &topicNames, MessageHandler messageHandler) {
+    DispatchPromise<ResponseCode> promise;
+    subscribeToTopics(topicNames, messageHandler, [promise](ResponseCode responseCode) mutable {
+        promise.resolve(responseCode);
+    });
+    
+    return promise.getFuture();
+}
+
+DispatchFuture<ResponseCode> ConnectionManager::unsubscribeFromTopics(const std::vector<std::string> &topicNames) {
+    DispatchPromise<ResponseCode> promise;
+    unsubscribeFromTopics(topicNames, [promise](ResponseCode responseCode) mutable {
+        promise.resolve(responseCode);
+    });
+    
+    return promise.getFuture();
+}
+
+DispatchFuture<ResponseCode> ConnectionManager::publishMessageToTopic(SharedBuffer message, const std::string &topicName) {
+    DispatchPromise<ResponseCode> promise;
+    publishMessageToTopic(std::move(message), topicName, [promise](ResponseCode responseCode) mutable {
+        promise.resolve(responseCode);
+    });
+    
+    return promise.getFuture();
 }
 
 // TODO: Implement subscribedTopicNames management for these callbacks.
 ResponseCode ConnectionManager::subscribeCallback(util::String topicName, util::String payload,
                                                   std::shared_ptr<mqtt::SubscriptionHandlerContextData> handlerData) {
-    // Call the message handler, if applicable.
-    std::lock_guard<std::mutex> lock(messageHandlersByTopicNameMutex);
-    auto messageHandlerIt = messageHandlersByTopicName.find(topicName);
-    if (messageHandlerIt != messageHandlersByTopicName.end()) {
-        messageHandlerIt->second(topicName, payload);
-    }
+    // Call the handler of every matching subscription, outside of any lock so that handlers may subscribe.
+    connectionMetrics().receivedMessages.increment();
+    topicRouter.route(topicName, payload);
     
     return ResponseCode::SUCCESS;
 }
 
 ResponseCode ConnectionManager::disconnectCallback(util::String topicName,
                                                    std::shared_ptr<DisconnectCallbackContextData> handlerData) {
+    notifyConnectionHandler(false);
     return ResponseCode::SUCCESS;
 }
 
 ResponseCode ConnectionManager::reconnectCallback(util::String clientID,
                                                   std::shared_ptr<ReconnectCallbackContextData> handlerData,
                                                   ResponseCode reconnectResult) {
+    // Restore every subscription in a single round trip, rather than one packet per topic.
+    if (reconnectResult == ResponseCode::SUCCESS || reconnectResult == ResponseCode::MQTT_CONNACK_CONNECTION_ACCEPTED) {
+        resubscribeToAllTopics(nullptr);
+        notifyConnectionHandler(true);
+    }
+    
     return ResponseCode::SUCCESS;
 }
 
 ResponseCode ConnectionManager::resubscribeCallback(util::String clientID,
                                                     std::shared_ptr<ResubscribeCallbackContextData> handlerData,
                                                     ResponseCode resubscribeResult) {
+    // Subscribing to a filter again only replaces the existing subscription, so retrying is always safe.
+    if (resubscribeResult != ResponseCode::SUCCESS) {
+        resubscribeToAllTopics(nullptr);
+    }
+    
     return ResponseCode::SUCCESS;
 }
 
@@ -0,0 +1,278 @@
+//
+//  HostResolver.cpp
+//  remote_core
+//
+//  Created by David Moore on 10/19/26.
+//  Copyright © 2026 David Moore. All rights reserved.
+//
+
+#include "HostResolver.hpp"
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <arpa/nameser.h>
+#include <resolv.h>
+#include "DispatchFuture.hpp"
+
+using namespace RemoteCore;
+
+/// Large enough for the answers to an A or AAAA query for any reasonable name, which are sent over TCP if they do not fit in a datagram.
+#define HOST_RESOLVER_ANSWER_BUFFER_SIZE (8 * 1024)
+
+static SocketAddress addressWithBytes(int family, const void *bytes) {
+    SocketAddress address;
+    if (family == AF_INET6) {
+        auto internetAddress = (struct sockaddr_in6 *)&address.storage;
+        internetAddress->sin6_family = AF_INET6;
+        memcpy(&internetAddress->sin6_addr, bytes, sizeof(internetAddress->sin6_addr));
+        address.length = sizeof(struct sockaddr_in6);
+    } else {
+        auto internetAddress = (struct sockaddr_in *)&address.storage;
+        internetAddress->sin_family = AF_INET;
+        memcpy(&internetAddress->sin_addr, bytes, sizeof(internetAddress->sin_addr));
+        address.length = sizeof(struct sockaddr_in);
+    }
+    
+    return address;
+}
+
+// MARK: - Host Resolver
+
+HostResolver::HostResolver(LookupFunction lookUp, size_t threadCount) : lookUp(lookUp), lastRequestIdentifier(0), lookupQueue("ca.mooredev.remote_core.HostResolver.lookup_queue", threadCount) {
+}
+
+HostResolver *HostResolver::sharedResolver(void) {
+    static HostResolver resolver;
+    
+    return &resolver;
+}
+
+static std::vector<SocketAddress> addressesWithPort(std::vector<SocketAddress> addresses, uint16_t port) {
+    for (auto &address : addresses) {
+        address.setPort(port);
+    }
+    
+    return addresses;
+}
+
+HostResolver::RequestIdentifier HostResolver::resolve(const std::string &host, uint16_t port, CompletionHandler completionHandler) {
+    SocketAddress address;
+    if (SocketAddress::parse(host, port, address)) {
+        completionHandler({address}, 0);
+        return 0;
+    }
+    
+    std::unique_lock<std::mutex> lock(mutex);
+    auto position = cache.find(host);
+    if (position != cache.end() && position->second.expirationTime > std::chrono::steady_clock::now()) {
+        statistics.cacheHitCount++;
+        auto addresses = addressesWithPort(position->second.addresses, port);
+        int error = position->second.error;
+        lock.unlock();
+        
+        completionHandler(addresses, error);
+        return 0;
+    }
+    
+    RequestIdentifier identifier = ++lastRequestIdentifier;
+    requests[identifier] = {host, port, std::move(completionHandler)};
+    
+    // Only the first request for the host starts a lookup; the others wait for its result.
+    auto &pendingRequests = pendingLookups[host];
+    pendingRequests.push_back(identifier);
+    if (pendingRequests.size() == 1) {
+        statistics.lookupCount++;
+        lookupQueue.execute([this, host]() {
+            completeLookup(host, lookUp(host));
+        });
+    }
+    
+    return identifier;
+}
+
+std::vector<SocketAddress> HostResolver::resolve(const std::string &host, uint16_t port, std::chrono::milliseconds timeout, int &error) {
+    DispatchPromise<HostLookup> promise;
+    auto identifier = resolve(host, port, [promise](const std::vector<SocketAddress> &addresses, int error) mutable {
+        HostLookup lookup;
+        lookup.addresses = addresses;
+        lookup.error = error;
+        promise.resolve(lookup);
+    });
+    
+    auto future = promise.getFuture();
+    if (!future.waitFor(timeout)) {
+        cancel(identifier);
+        error = ETIMEDOUT;
+        return {};
+    }
+    
+    error = future.get().error;
+    return future.get().addresses;
+}
+
+void HostResolver::completeLookup(const std::string &host, HostLookup lookup) {
+    if (lookup.error == 0 && lookup.addresses.empty()) {
+        lookup.error = EHOSTUNREACH;
+    }
+    
+    auto addresses = interleaveFamilies(lookup.addresses);
+    auto timeToLive = lookup.error != 0 ? HOST_RESOLVER_NEGATIVE_TIME_TO_LIVE : std::min(std::max(lookup.timeToLive, HOST_RESOLVER_MINIMUM_TIME_TO_LIVE), HOST_RESOLVER_MAXIMUM_TIME_TO_LIVE);
+    
+    // Taken before the requests are removed, so that 'cancel' waits for their handlers to return.
+    std::lock_guard<std::recursive_mutex> completionLock(completionMutex);
+    
+    std::vector<Request> completedRequests;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        cache[host] = {addresses, lookup.error, std::chrono::steady_clock::now() + timeToLive};
+        if (lookup.error != 0) {
+            statistics.failedLookupCount++;
+        }
+        
+        for (auto identifier : pendingLookups[host]) {
+            auto position = requests.find(identifier);
+            if (position != requests.end()) {
+                completedRequests.push_back(std::move(position->second));
+                requests.erase(position);
+            }
+        }
+        
+        pendingLookups.erase(host);
+    }
+    
+    for (auto &request : completedRequests) {
+        request.completionHandler(addressesWithPort(addresses, request.port), lookup.error);
+    }
+}
+
+void HostResolver::cancel(RequestIdentifier identifier) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        requests.erase(identifier);
+    }
+    
+    // Wait for any handler that is being called.
+    std::lock_guard<std::recursive_mutex> completionLock(completionMutex);
+}
+
+void HostResolver::removeCachedAddresses(const std::string &host) {
+    std::lock_guard<std::mutex> lock(mutex);
+    cache.erase(host);
+}
+
+HostResolverStatistics HostResolver::getStatistics(void) {
+    std::lock_guard<std::mutex> lock(mutex);
+    return statistics;
+}
+
+// MARK: - Looking Up Names
+
+/**
+ Appends the addresses in the answer to a query of the type, and lowers the time to live to that of the shortest-lived record (including any aliases leading to the addresses).
+ */
+static void queryRecords(res_state state, const std::string &host, int type, HostLookup &lookup, uint32_t &timeToLive) {
+    unsigned char answer[HOST_RESOLVER_ANSWER_BUFFER_SIZE];
+    int length = res_nquery(state, host.c_str(), ns_c_in, type, answer, sizeof(answer));
+    
+    ns_msg message;
+    if (length <= 0 || ns_initparse(answer, std::min(length, (int)sizeof(answer)), &message) != 0) {
+        return;
+    }
+    
+    for (int i = 0; i < ns_msg_count(message, ns_s_an); i++) {
+        ns_rr record;
+        if (ns_parserr(&message, ns_s_an, i, &record) != 0) {
+            break;
+        }
+        
+        int recordType = ns_rr_type(record);
+        if (recordType == ns_t_a && ns_rr_rdlen(record) == sizeof(struct in_addr)) {
+            lookup.addresses.push_back(addressWithBytes(AF_INET, ns_rr_rdata(record)));
+        } else if (recordType == ns_t_aaaa && ns_rr_rdlen(record) == sizeof(struct in6_addr)) {
+            lookup.addresses.push_back(addressWithBytes(AF_INET6, ns_rr_rdata(record)));
+        } else if (recordType != ns_t_cname) {
+            continue;
+        }
+        
+        timeToLive = std::min(timeToLive, (uint32_t)ns_rr_ttl(record));
+    }
+}
+
+static bool hasSuffix(const std::string &string, const std::string &suffix) {
+    return string.size() >= suffix.size() && string.compare(string.size() - suffix.size(), suffix.size(), suffix) == 0;
+}
+
+HostLookup HostResolver::lookUpWithSystemResolver(const std::string &host) {
+    HostLookup lookup;
+    
+    // Loopback and multicast DNS names are never answered by DNS servers.
+    bool usesDNS = host != "localhost" && !hasSuffix(host, ".localhost") && !hasSuffix(host, ".local");
+    if (usesDNS) {
+        struct __res_state state;
+        memset(&state, 0, sizeof(state));
+        if (res_ninit(&state) == 0) {
+            uint32_t timeToLive = UINT32_MAX;
+            queryRecords(&state, host, ns_t_aaaa, lookup, timeToLive);
+            queryRecords(&state, host, ns_t_a, lookup, timeToLive);
+            res_nclose(&state);
+            
+            if (!lookup.addresses.empty()) {
+                lookup.timeToLive = std::chrono::seconds(timeToLive);
+                return lookup;
+            }
+        }
+    }
+    
+    // The hosts file, search domains and other name services are only consulted by 'getaddrinfo', which does not report a time to live.
+    struct addrinfo hints = {};
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    hints.ai_flags = AI_ADDRCONFIG;
+    
+    struct addrinfo *addresses = nullptr;
+    int status = getaddrinfo(host.c_str(), nullptr, &hints, &addresses);
+    if (status != 0) {
+        lookup.error = status == EAI_SYSTEM ? errno : EHOSTUNREACH;
+        return lookup;
+    }
+    
+    for (auto address = addresses; address != nullptr; address = address->ai_next) {
+        SocketAddress socketAddress;
+        memcpy(&socketAddress.storage, address->ai_addr, address->ai_addrlen);
+        socketAddress.length = address->ai_addrlen;
+        lookup.addresses.push_back(socketAddress);
+    }
+    
+    freeaddrinfo(addresses);
+    lookup.timeToLive = HOST_RESOLVER_DEFAULT_TIME_TO_LIVE;
+    return lookup;
+}
+
+std::vector<SocketAddress> HostResolver::interleaveFamilies(const std::vector<SocketAddress> &addresses) {
+    if (addresses.empty()) {
+        return addresses;
+    }
+    
+    int firstFamily = addresses.front().getFamily();
+    std::vector<SocketAddress> firstFamilyAddresses;
+    std::vector<SocketAddress> otherAddresses;
+    for (auto &address : addresses) {
+        (address.getFamily() == firstFamily ? firstFamilyAddresses : otherAddresses).push_back(address);
+    }
+    
+    std::vector<SocketAddress> interleavedAddresses;
+    for (size_t i = 0; i < std::max(firstFamilyAddresses.size(), otherAddresses.size()); i++) {
+        if (i < firstFamilyAddresses.size()) {
+            interleavedAddresses.push_back(firstFamilyAddresses[i]);
+        }
+        
+        if (i < otherAddresses.size()) {
+            interleavedAddresses.push_back(otherAddresses[i]);
+        }
+    }
+    
+    return interleavedAddresses;
+}
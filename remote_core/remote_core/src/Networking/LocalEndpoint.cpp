@@ -0,0 +1,31 @@
+//
+//  LocalEndpoint.cpp
+//  remote_core
+//
+//  Created by David Moore on 10/19/26.
+//  Copyright © 2026 David Moore. All rights reserved.
+//
+
+#include "LocalEndpoint.hpp"
+
+using namespace RemoteCore;
+
+LocalEndpoint::LocalEndpoint(const LocalEndpointOptions &options, MessageHandler messageHandler) : topicName(options.topicName), broker(options.port, options.tlsConfiguration, true) {
+    std::string topicName = options.topicName;
+    broker.setMessageHandler([topicName, messageHandler](const std::string &messageTopicName, const SharedBuffer &payload) {
+        if (messageTopicName == topicName) {
+            messageHandler(payload);
+        }
+    });
+    
+    if (!options.advertisement.instanceName.empty()) {
+        ServiceDescription advertisement = options.advertisement;
+        advertisement.port = broker.getPort();
+        advertiser = std::make_unique<MulticastDNSAdvertiser>(advertisement, options.advertisementPort);
+    }
+}
+
+void LocalEndpoint::publishMessage(SharedBuffer message) {
+    // Phones that miss a message receive it through the cloud, so it is not acknowledged.
+    broker.publish(topicName, std::move(message), 0);
+}
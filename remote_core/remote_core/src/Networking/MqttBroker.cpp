@@ -0,0 +1,422 @@
+//
+//  MqttBroker.cpp
+//  remote_core
+//
+//  Created by David Moore on 10/19/26.
+//  Copyright © 2026 David Moore. All rights reserved.
+//
+
+#include "MqttBroker.hpp"
+#include "TopicRouter.hpp"
+#include <algorithm>
+#include <cerrno>
+#include <future>
+#include <unistd.h>
+#include <sys/socket.h>
+
+using namespace RemoteCore;
+
+#define MQTT_BROKER_READ_BUFFER_SIZE (16 * 1024)
+
+/// Number of topic aliases that every MQTT 5 client may assign.
+#define MQTT_BROKER_TOPIC_ALIAS_MAXIMUM 16
+
+MqttBroker::MqttBroker(uint16_t port) : listenFD(-1), port(0), acceptedConnectionCount(0), receivedPublishCount(0), deliveredPublishCount(0) {
+    start(port, false);
+}
+
+MqttBroker::MqttBroker(uint16_t port, const TlsConfiguration &tlsConfiguration, bool listensOnAnyInterface) : listenFD(-1), port(0), tlsConfiguration(tlsConfiguration), acceptedConnectionCount(0), receivedPublishCount(0), deliveredPublishCount(0) {
+    this->tlsConfiguration.isServer = true;
+    tlsContext = TlsTransport::makeContext(this->tlsConfiguration);
+    start(port, listensOnAnyInterface);
+}
+
+void MqttBroker::start(uint16_t port, bool listensOnAnyInterface) {
+    listenFD = listensOnAnyInterface ? StreamTransport::listenOnAnyInterface(port) : StreamTransport::listenOnLoopback(port);
+    this->port = StreamTransport::getLocalPort(listenFD);
+    
+    loop.addDescriptor(listenFD, EventLoop::Readable, [this](uint32_t events) {
+        acceptConnections();
+    });
+    
+    loopThread = std::thread([this]() {
+        loop.run();
+    });
+}
+
+MqttBroker::~MqttBroker() {
+    loop.execute([this]() {
+        for (auto &pair : sessions) {
+            loop.removeDescriptor(pair.first);
+        }
+        
+        sessions.clear();
+        loop.removeDescriptor(listenFD);
+        close(listenFD);
+        loop.stop();
+    });
+    
+    loopThread.join();
+}
+
+void MqttBroker::dropConnections(void) {
+    std::promise<void> didDrop;
+    loop.execute([this, &didDrop]() {
+        std::vector<int> descriptors;
+        for (auto &pair : sessions) {
+            descriptors.push_back(pair.first);
+        }
+        
+        for (int fd : descriptors) {
+            closeSession(fd);
+        }
+        
+        didDrop.set_value();
+    });
+    
+    didDrop.get_future().wait();
+}
+
+void MqttBroker::setMessageHandler(MessageHandler messageHandler) {
+    loop.execute([this, messageHandler]() {
+        this->messageHandler = messageHandler;
+    });
+}
+
+void MqttBroker::publish(const std::string &topicName, SharedBuffer payload, uint8_t qualityOfService) {
+    auto packet = std::make_shared<MqttPacket>(MqttPacket::publish(topicName, std::move(payload), qualityOfService, 0));
+    loop.execute([this, packet]() {
+        deliverMessage(*packet);
+        flushSessions();
+    });
+}
+
+MqttBrokerStatistics MqttBroker::getStatistics(void) const {
+    MqttBrokerStatistics statistics;
+    statistics.acceptedConnectionCount = acceptedConnectionCount;
+    statistics.receivedPublishCount = receivedPublishCount;
+    statistics.deliveredPublishCount = deliveredPublishCount;
+    return statistics;
+}
+
+// MARK: - Sessions
+
+void MqttBroker::acceptConnections(void) {
+    while (true) {
+        int fd = accept(listenFD, nullptr, nullptr);
+        if (fd < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            
+            return;
+        }
+        
+        auto session = std::make_unique<Session>();
+        if (tlsContext != nullptr) {
+            session->transport = std::make_unique<TlsTransport>(fd, tlsContext, tlsConfiguration);
+            session->isHandshaking = true;
+        } else {
+            session->transport = std::make_unique<TcpTransport>(fd);
+        }
+        
+        setSessionEvents(fd, *session, EventLoop::Readable);
+        sessions[fd] = std::move(session);
+        acceptedConnectionCount++;
+    }
+}
+
+void MqttBroker::setSessionEvents(int fd, Session &session, uint32_t events) {
+    if (events == session.descriptorEvents) {
+        return;
+    }
+    
+    loop.addDescriptor(fd, events, [this, fd](uint32_t readyEvents) {
+        handleSessionEvents(fd, readyEvents);
+    });
+    
+    session.descriptorEvents = events;
+}
+
+void MqttBroker::handleSessionEvents(int fd, uint32_t events) {
+    auto position = sessions.find(fd);
+    if (position == sessions.end()) {
+        return;
+    }
+    
+    Session &session = *position->second;
+    if (session.isHandshaking) {
+        handshake(fd, session);
+        
+        // Packets may have arrived with the last flight of the handshake, and are read below.
+        if (sessions.count(fd) == 0 || session.isHandshaking) {
+            return;
+        }
+        
+        events |= EventLoop::Readable;
+    }
+    
+    if (events & EventLoop::Writable) {
+        pendingFlushDescriptors.insert(fd);
+    }
+    
+    if (events & (EventLoop::Readable | EventLoop::Hangup)) {
+        char buffer[MQTT_BROKER_READ_BUFFER_SIZE];
+        bool isOpen = true;
+        
+        while (isOpen) {
+            auto result = session.transport->read(buffer, sizeof(buffer));
+            if (result.status == TransportStatus::WantRead) {
+                break;
+            } else if (result.status != TransportStatus::Complete) {
+                closeSession(fd);
+                break;
+            }
+            
+            session.parser.append(buffer, result.byteCount);
+            try {
+                MqttPacket packet;
+                while (isOpen && session.parser.nextPacket(packet)) {
+                    handlePacket(fd, session, packet);
+                    isOpen = sessions.count(fd) > 0;
+                }
+            } catch (const MqttProtocolError &) {
+                closeSession(fd);
+                isOpen = false;
+            }
+        }
+    }
+    
+    // Everything produced by this read, for every session, is written once.
+    flushSessions();
+}
+
+void MqttBroker::handshake(int fd, Session &session) {
+    auto result = session.transport->handshake();
+    switch (result.status) {
+        case TransportStatus::Complete:
+            session.isHandshaking = false;
+            setSessionEvents(fd, session, EventLoop::Readable);
+            break;
+        case TransportStatus::WantRead:
+            setSessionEvents(fd, session, EventLoop::Readable);
+            break;
+        case TransportStatus::WantWrite:
+            setSessionEvents(fd, session, EventLoop::Readable | EventLoop::Writable);
+            break;
+        default:
+            closeSession(fd);
+            break;
+    }
+}
+
+void MqttBroker::handlePacket(int fd, Session &session, MqttPacket &packet) {
+    if (!session.isConnected && packet.type != MqttPacketType::Connect) {
+        closeSession(fd);
+        return;
+    }
+    
+    switch (packet.type) {
+        case MqttPacketType::Connect: {
+            if (session.isConnected) {
+                closeSession(fd);
+                return;
+            }
+            
+            // A client that connects again takes over from its previous connection.
+            std::vector<int> previousDescriptors;
+            for (auto &pair : sessions) {
+                if (pair.first != fd && pair.second->isConnected && pair.second->clientID == packet.clientID) {
+                    previousDescriptors.push_back(pair.first);
+                }
+            }
+            
+            for (int previousFD : previousDescriptors) {
+                closeSession(previousFD);
+            }
+            
+            session.isConnected = true;
+            session.clientID = packet.clientID;
+            session.protocolLevel = packet.protocolLevel;
+            session.parser.setProtocolLevel(packet.protocolLevel);
+            
+            auto acknowledgement = MqttPacket::connectAcknowledgement(false, MQTT_CONNECTION_ACCEPTED);
+            acknowledgement.properties.topicAliasMaximum = MQTT_BROKER_TOPIC_ALIAS_MAXIMUM;
+            enqueuePacket(fd, session, acknowledgement);
+            break;
+        }
+        case MqttPacketType::Publish:
+            if (!resolveTopicAlias(session, packet)) {
+                closeSession(fd);
+                return;
+            }
+            
+            receivedPublishCount++;
+            if (packet.qualityOfService == 1) {
+                enqueuePacket(fd, session, MqttPacket::withType(MqttPacketType::PublishAcknowledgement, packet.packetIdentifier));
+            } else if (packet.qualityOfService == 2) {
+                enqueuePacket(fd, session, MqttPacket::withType(MqttPacketType::PublishReceived, packet.packetIdentifier));
+            }
+            
+            deliverMessage(packet);
+            if (messageHandler) {
+                messageHandler(packet.topicName, packet.payload);
+            }
+            break;
+        case MqttPacketType::PublishRelease:
+            enqueuePacket(fd, session, MqttPacket::withType(MqttPacketType::PublishComplete, packet.packetIdentifier));
+            break;
+        case MqttPacketType::Subscribe: {
+            auto acknowledgement = MqttPacket::withType(MqttPacketType::SubscribeAcknowledgement, packet.packetIdentifier);
+            for (size_t i = 0; i < packet.topicFilters.size(); i++) {
+                auto &topicFilter = packet.topicFilters[i];
+                if (TopicRouter::isValidFilter(topicFilter)) {
+                    uint8_t qualityOfService = std::min<uint8_t>(packet.qualityOfServices[i], 1);
+                    session.subscriptions[topicFilter] = qualityOfService;
+                    acknowledgement.qualityOfServices.push_back(qualityOfService);
+                } else {
+                    acknowledgement.qualityOfServices.push_back(MQTT_SUBSCRIPTION_FAILURE);
+                }
+            }
+            
+            enqueuePacket(fd, session, acknowledgement);
+            break;
+        }
+        case MqttPacketType::Unsubscribe: {
+            // MQTT 5 clients receive a reason code for every topic filter, which is always a success.
+            auto acknowledgement = MqttPacket::withType(MqttPacketType::UnsubscribeAcknowledgement, packet.packetIdentifier);
+            for (auto &topicFilter : packet.topicFilters) {
+                session.subscriptions.erase(topicFilter);
+                acknowledgement.qualityOfServices.push_back(0);
+            }
+            
+            enqueuePacket(fd, session, acknowledgement);
+            break;
+        }
+        case MqttPacketType::PingRequest:
+            enqueuePacket(fd, session, MqttPacket::withType(MqttPacketType::PingResponse));
+            break;
+        case MqttPacketType::Disconnect:
+            closeSession(fd);
+            break;
+        case MqttPacketType::PublishAcknowledgement:
+        case MqttPacketType::PublishReceived:
+        case MqttPacketType::PublishComplete:
+            // Deliveries are not tracked, so their acknowledgements are ignored.
+            break;
+        default:
+            closeSession(fd);
+            break;
+    }
+}
+
+void MqttBroker::deliverMessage(const MqttPacket &packet) {
+    for (auto &pair : sessions) {
+        Session &session = *pair.second;
+        if (!session.isConnected) {
+            continue;
+        }
+        
+        // A message is delivered once per session, even if several of its subscriptions match.
+        int grantedQualityOfService = -1;
+        for (auto &subscription : session.subscriptions) {
+            if (TopicRouter::filterMatchesTopic(subscription.first, packet.topicName)) {
+                grantedQualityOfService = std::max<int>(grantedQualityOfService, subscription.second);
+            }
+        }
+        
+        if (grantedQualityOfService < 0) {
+            continue;
+        }
+        
+        uint8_t qualityOfService = std::min<uint8_t>(packet.qualityOfService, (uint8_t)grantedQualityOfService);
+        uint16_t packetIdentifier = 0;
+        if (qualityOfService > 0) {
+            session.lastPacketIdentifier = session.lastPacketIdentifier == UINT16_MAX ? 1 : session.lastPacketIdentifier + 1;
+            packetIdentifier = session.lastPacketIdentifier;
+        }
+        
+        auto delivery = MqttPacket::publish(packet.topicName, packet.payload, qualityOfService, packetIdentifier);
+        delivery.protocolLevel = session.protocolLevel;
+        if (session.protocolLevel >= MQTT_5_PROTOCOL_LEVEL) {
+            delivery.properties = packet.properties;
+        }
+        
+        enqueuePacket(pair.first, session, delivery);
+        deliveredPublishCount++;
+    }
+}
+
+bool MqttBroker::resolveTopicAlias(Session &session, MqttPacket &packet) {
+    uint16_t topicAlias = packet.properties.topicAlias;
+    if (topicAlias == 0) {
+        return true;
+    } else if (topicAlias > MQTT_BROKER_TOPIC_ALIAS_MAXIMUM) {
+        return false;
+    }
+    
+    if (packet.topicName.empty()) {
+        auto position = session.topicAliases.find(topicAlias);
+        if (position == session.topicAliases.end()) {
+            return false;
+        }
+        
+        packet.topicName = position->second;
+    } else {
+        session.topicAliases[topicAlias] = packet.topicName;
+    }
+    
+    // The alias only applies to the publisher's connection.
+    packet.properties.topicAlias = 0;
+    return true;
+}
+
+void MqttBroker::enqueuePacket(int fd, Session &session, const MqttPacket &packet) {
+    if (packet.protocolLevel == session.protocolLevel) {
+        packet.encode(session.outboundChain);
+    } else {
+        MqttPacket versionedPacket = packet;
+        versionedPacket.protocolLevel = session.protocolLevel;
+        versionedPacket.encode(session.outboundChain);
+    }
+    
+    pendingFlushDescriptors.insert(fd);
+}
+
+void MqttBroker::flushSessions(void) {
+    std::set<int> descriptors;
+    descriptors.swap(pendingFlushDescriptors);
+    
+    for (int fd : descriptors) {
+        auto position = sessions.find(fd);
+        if (position == sessions.end()) {
+            continue;
+        }
+        
+        Session &session = *position->second;
+        bool isOpen = true;
+        while (!session.outboundChain.isEmpty()) {
+            auto result = session.transport->writeChain(session.outboundChain);
+            if (result.status == TransportStatus::WantWrite) {
+                break;
+            } else if (result.status != TransportStatus::Complete) {
+                isOpen = false;
+                break;
+            }
+        }
+        
+        if (!isOpen) {
+            closeSession(fd);
+        } else if (!session.outboundChain.isEmpty()) {
+            setSessionEvents(fd, session, EventLoop::Readable | EventLoop::Writable);
+        } else {
+            setSessionEvents(fd, session, EventLoop::Readable);
+        }
+    }
+}
+
+void MqttBroker::closeSession(int fd) {
+    loop.removeDescriptor(fd);
+    sessions.erase(fd);
+    pendingFlushDescriptors.erase(fd);
+}
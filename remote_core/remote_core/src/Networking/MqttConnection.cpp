@@ -0,0 +1,815 @@
+//
+//  MqttConnection.cpp
+//  remote_core
+//
+//  Created by David Moore on 10/19/26.
+//  Copyright © 2026 David Moore. All rights reserved.
+//
+
+#include "MqttConnection.hpp"
+#include "FlightRecorder.hpp"
+#include <algorithm>
+#include <cerrno>
+#include <stdexcept>
+
+using namespace RemoteCore;
+
+/// Size of the buffer that is read into, which bounds the bytes read per call rather than per readiness event.
+#define MQTT_CONNECTION_READ_BUFFER_SIZE (16 * 1024)
+
+/// Session expiry interval that MQTT 5 treats as never expiring, which matches an MQTT 3.1.1 session that is not clean.
+#define MQTT_CONNECTION_SESSION_NEVER_EXPIRES UINT32_MAX
+
+/// Receive maximum of a broker that does not state one, which MQTT 3.1.1 brokers never do.
+#define MQTT_CONNECTION_DEFAULT_RECEIVE_MAXIMUM 65535
+
+MqttConnection::MqttConnection(MqttConnectionOptions options) : options(std::move(options)), state(State::Disconnected), connector(loop, this->options.connectionAttemptDelay), descriptorEvents(0), parser(this->options.maximumPacketSize), isFlushScheduled(false), isWriteWaitingForRead(false), shouldReconnect(false), hasConnected(false), reconnectInterval(this->options.minimumReconnectInterval), lastPacketIdentifier(0), outboundTopicAliasMaximum(0), keepAliveInterval(this->options.keepAliveInterval), outboundMaximumPacketSize(0), inFlightPublishCount(0), inFlightPublishMaximum(MQTT_CONNECTION_DEFAULT_RECEIVE_MAXIMUM), connectTimer(0), keepAliveTimer(0), acknowledgementTimer(0), reconnectTimer(0), isAwaitingPingResponse(false), isConnectedValue(false), sentPacketCount(0), receivedPacketCount(0), writeCount(0), reconnectCount(0) {
+    if (this->options.usesTLS) {
+        tlsContext = TlsTransport::makeContext(this->options.tlsConfiguration);
+    }
+    
+    parser.setProtocolLevel(this->options.protocolLevel);
+    loopThread = std::thread([this]() {
+        loop.run();
+    });
+}
+
+MqttConnection::~MqttConnection() {
+    loop.execute([this]() {
+        shouldReconnect = false;
+        loop.removeTimer(reconnectTimer);
+        loop.removeTimer(acknowledgementTimer);
+        
+        closeTransport();
+        state = State::Disconnected;
+        completeConnecting(MqttStatus::Cancelled);
+        failPendingAcknowledgements(MqttStatus::Cancelled);
+        
+        loop.stop();
+    });
+    
+    loopThread.join();
+}
+
+// MARK: - Public Interface
+
+void MqttConnection::setMessageHandler(MessageHandler messageHandler) {
+    loop.execute([this, messageHandler]() {
+        this->messageHandler = messageHandler;
+    });
+}
+
+void MqttConnection::setPublishHandler(PublishHandler publishHandler) {
+    loop.execute([this, publishHandler]() {
+        this->publishHandler = publishHandler;
+    });
+}
+
+void MqttConnection::setConnectionHandler(ConnectionHandler connectionHandler) {
+    loop.execute([this, connectionHandler]() {
+        this->connectionHandler = connectionHandler;
+    });
+}
+
+void MqttConnection::connect(CompletionHandler completionHandler) {
+    loop.execute([this, completionHandler]() {
+        if (state == State::Connected) {
+            if (completionHandler) {
+                completionHandler(MqttStatus::Success);
+            }
+            
+            return;
+        }
+        
+        if (completionHandler) {
+            connectCompletionHandlers.push_back(completionHandler);
+        }
+        
+        if (state == State::WaitingToReconnect) {
+            // Connecting explicitly should not wait out the reconnect interval.
+            loop.removeTimer(reconnectTimer);
+            reconnectTimer = 0;
+            beginConnecting();
+        } else if (state == State::Disconnected) {
+            beginConnecting();
+        }
+    });
+}
+
+void MqttConnection::disconnect(CompletionHandler completionHandler) {
+    loop.execute([this, completionHandler]() {
+        bool wasConnected = state == State::Connected;
+        shouldReconnect = false;
+        loop.removeTimer(reconnectTimer);
+        reconnectTimer = 0;
+        
+        if (wasConnected) {
+            enqueuePacket(MqttPacket::withType(MqttPacketType::Disconnect));
+            flush();
+        }
+        
+        closeTransport();
+        state = State::Disconnected;
+        completeConnecting(MqttStatus::Cancelled);
+        failPendingAcknowledgements(MqttStatus::Cancelled);
+        
+        if (wasConnected && connectionHandler) {
+            connectionHandler(false, false);
+        }
+        
+        if (completionHandler) {
+            completionHandler(MqttStatus::Success);
+        }
+    });
+}
+
+void MqttConnection::subscribe(const std::vector<std::string> &topicFilters, uint8_t qualityOfService, CompletionHandler completionHandler) {
+    if (topicFilters.empty()) {
+        throw std::logic_error("Expected 'topicFilters' to contain at least one topic filter.");
+    }
+    
+    loop.execute([this, topicFilters, qualityOfService, completionHandler]() {
+        if (state == State::Disconnected) {
+            if (completionHandler) {
+                completionHandler(MqttStatus::NotConnected);
+            }
+            
+            return;
+        }
+        
+        addPendingAcknowledgement(MqttPacket::subscribe(nextPacketIdentifier(), topicFilters, qualityOfService), completionHandler);
+    });
+}
+
+void MqttConnection::unsubscribe(const std::vector<std::string> &topicFilters, CompletionHandler completionHandler) {
+    if (topicFilters.empty()) {
+        throw std::logic_error("Expected 'topicFilters' to contain at least one topic filter.");
+    }
+    
+    loop.execute([this, topicFilters, completionHandler]() {
+        if (state == State::Disconnected) {
+            if (completionHandler) {
+                completionHandler(MqttStatus::NotConnected);
+            }
+            
+            return;
+        }
+        
+        addPendingAcknowledgement(MqttPacket::unsubscribe(nextPacketIdentifier(), topicFilters), completionHandler);
+    });
+}
+
+void MqttConnection::publish(OutboundMessage message) {
+    std::vector<OutboundMessage> messages;
+    messages.push_back(std::move(message));
+    publish(std::move(messages));
+}
+
+void MqttConnection::publish(std::vector<OutboundMessage> messages) {
+    for (auto &message : messages) {
+        if (message.qualityOfService > 1) {
+            throw std::logic_error("Expected 'qualityOfService' to be zero or one.");
+        }
+    }
+    
+    // The batch is posted as a whole, so that it is encoded into the outbound buffer, and written, at once.
+    auto sharedMessages = std::make_shared<std::vector<OutboundMessage>>(std::move(messages));
+    loop.execute([this, sharedMessages]() {
+        publishMessages(*sharedMessages);
+    });
+}
+
+void MqttConnection::publishMessages(std::vector<OutboundMessage> &messages) {
+    REMOTE_CORE_TRACE_SCOPE("mqtt", "publish");
+    for (auto &message : messages) {
+        if (message.qualityOfService == 0) {
+            // Nothing is acknowledged, so messages can only be sent while connected.
+            auto status = MqttStatus::NotConnected;
+            if (state == State::Connected) {
+                auto packet = MqttPacket::publish(message.topicName, std::move(message.payload), 0, 0);
+                packet.properties = std::move(message.properties);
+                status = enqueuePacket(packet) ? MqttStatus::Success : MqttStatus::PacketTooLarge;
+            }
+            
+            if (message.completionHandler) {
+                message.completionHandler(status);
+            }
+        } else if (state == State::Disconnected) {
+            if (message.completionHandler) {
+                message.completionHandler(MqttStatus::NotConnected);
+            }
+        } else {
+            // Messages published while reconnecting are sent once the connection is re-established.
+            auto packet = MqttPacket::publish(message.topicName, std::move(message.payload), message.qualityOfService, nextPacketIdentifier());
+            packet.properties = std::move(message.properties);
+            addPendingAcknowledgement(std::move(packet), std::move(message.completionHandler));
+        }
+    }
+}
+
+MqttConnectionStatistics MqttConnection::getStatistics(void) const {
+    MqttConnectionStatistics statistics;
+    statistics.sentPacketCount = sentPacketCount;
+    statistics.receivedPacketCount = receivedPacketCount;
+    statistics.writeCount = writeCount;
+    statistics.reconnectCount = reconnectCount;
+    return statistics;
+}
+
+// MARK: - Connecting
+
+void MqttConnection::beginConnecting(void) {
+    state = State::Connecting;
+    connectTimer = loop.addTimer(options.commandTimeout, false, [this]() {
+        connectTimer = 0;
+        handleConnectionFailure(MqttStatus::Timeout);
+    });
+    
+    // The host is resolved without blocking the loop, and its addresses are raced.
+    connector.connect(options.host, options.port, std::min(options.connectTimeout, options.commandTimeout), [this](int fd, int error) {
+        if (fd < 0) {
+            handleConnectionFailure(error == ETIMEDOUT ? MqttStatus::Timeout : MqttStatus::ConnectFailed);
+        } else {
+            finishConnecting(fd);
+        }
+    });
+}
+
+void MqttConnection::finishConnecting(int fd) {
+    // The transport takes ownership of the socket.
+    try {
+        if (options.transportFactory) {
+            transport = options.transportFactory(fd);
+        } else if (options.usesTLS) {
+            transport = std::make_unique<TlsTransport>(fd, tlsContext, options.tlsConfiguration);
+        } else {
+            transport = std::make_unique<TcpTransport>(fd);
+        }
+    } catch (const std::exception &) {
+        handleConnectionFailure(MqttStatus::ConnectFailed);
+        return;
+    }
+    
+    state = State::Handshaking;
+    continueHandshake();
+}
+
+void MqttConnection::continueHandshake(void) {
+    auto result = transport->handshake();
+    switch (result.status) {
+        case TransportStatus::Complete:
+            break;
+        case TransportStatus::WantRead:
+            setDescriptorEvents(EventLoop::Readable);
+            return;
+        case TransportStatus::WantWrite:
+            setDescriptorEvents(EventLoop::Readable | EventLoop::Writable);
+            return;
+        default:
+            handleConnectionFailure(MqttStatus::ConnectFailed);
+            return;
+    }
+    
+    state = State::AwaitingAcknowledgement;
+    setDescriptorEvents(EventLoop::Readable);
+    auto packet = MqttPacket::connect(options.clientID, (uint16_t)options.keepAliveInterval.count(), options.isCleanSession);
+    packet.properties.topicAliasMaximum = options.topicAliasMaximum;
+    if (!options.isCleanSession) {
+        packet.properties.sessionExpiryInterval = MQTT_CONNECTION_SESSION_NEVER_EXPIRES;
+    }
+    
+    enqueuePacket(packet);
+    flush();
+}
+
+void MqttConnection::handleConnectAcknowledgement(const MqttPacket &packet) {
+    loop.removeTimer(connectTimer);
+    connectTimer = 0;
+    
+    if (packet.returnCode != MQTT_CONNECTION_ACCEPTED) {
+        handleConnectionFailure(MqttStatus::ConnectionRefused);
+        return;
+    }
+    
+    state = State::Connected;
+    isConnectedValue = true;
+    if (hasConnected) {
+        reconnectCount++;
+    }
+    
+    hasConnected = true;
+    shouldReconnect = options.reconnectsAutomatically;
+    reconnectInterval = options.minimumReconnectInterval;
+    outboundTopicAliasMaximum = options.protocolLevel >= MQTT_5_PROTOCOL_LEVEL ? packet.properties.topicAliasMaximum : 0;
+    
+    // Only MQTT 5 brokers send properties, so an MQTT 3.1.1 connection keeps the defaults.
+    auto &properties = packet.properties;
+    keepAliveInterval = properties.hasServerKeepAlive ? std::chrono::seconds(properties.serverKeepAlive) : options.keepAliveInterval;
+    outboundMaximumPacketSize = properties.maximumPacketSize;
+    inFlightPublishMaximum = properties.receiveMaximum != 0 ? properties.receiveMaximum : MQTT_CONNECTION_DEFAULT_RECEIVE_MAXIMUM;
+    inFlightPublishCount = 0;
+    expiredPublishIdentifiers.clear();
+    waitingPublishIdentifiers.clear();
+    
+    // Everything that is still unacknowledged is sent again, in a single write, other than publishes beyond the broker's receive maximum.
+    auto deadline = EventLoop::Clock::now() + options.commandTimeout;
+    std::vector<uint16_t> refusedIdentifiers;
+    for (auto &pair : pendingAcknowledgements) {
+        auto &pending = pair.second;
+        pending.deadline = deadline;
+        if (pending.packet.type == MqttPacketType::Publish) {
+            pending.packet.isDuplicate = pending.packet.isDuplicate || pending.isSent;
+            pending.isSent = false;
+            waitingPublishIdentifiers.push_back(pair.first);
+        } else if (enqueuePacket(pending.packet)) {
+            pending.isSent = true;
+        } else {
+            refusedIdentifiers.push_back(pair.first);
+        }
+    }
+    
+    for (auto packetIdentifier : refusedIdentifiers) {
+        completePendingAcknowledgement(packetIdentifier, MqttStatus::PacketTooLarge);
+    }
+    
+    sendWaitingPublishes();
+    armAcknowledgementTimer();
+    if (keepAliveInterval.count() > 0) {
+        scheduleKeepAlive(keepAliveInterval);
+    }
+    
+    completeConnecting(MqttStatus::Success);
+    if (connectionHandler) {
+        connectionHandler(true, packet.isSessionPresent);
+    }
+}
+
+void MqttConnection::handleConnectionFailure(MqttStatus status) {
+    bool wasConnected = state == State::Connected;
+    closeTransport();
+    completeConnecting(status);
+    
+    if (shouldReconnect) {
+        state = State::WaitingToReconnect;
+        scheduleReconnect();
+    } else {
+        state = State::Disconnected;
+        failPendingAcknowledgements(wasConnected ? MqttStatus::ConnectionLost : status);
+    }
+    
+    if (wasConnected && connectionHandler) {
+        connectionHandler(false, false);
+    }
+}
+
+void MqttConnection::completeConnecting(MqttStatus status) {
+    std::vector<CompletionHandler> completionHandlers;
+    completionHandlers.swap(connectCompletionHandlers);
+    
+    for (auto &completionHandler : completionHandlers) {
+        completionHandler(status);
+    }
+}
+
+void MqttConnection::scheduleReconnect(void) {
+    reconnectTimer = loop.addTimer(reconnectInterval, false, [this]() {
+        reconnectTimer = 0;
+        if (state == State::WaitingToReconnect) {
+            beginConnecting();
+        }
+    });
+    
+    reconnectInterval = std::min(reconnectInterval * 2, options.maximumReconnectInterval);
+}
+
+void MqttConnection::closeTransport(void) {
+    connector.cancel();
+    
+    if (transport != nullptr) {
+        loop.removeDescriptor(transport->getDescriptor());
+        transport.reset();
+    }
+    
+    descriptorEvents = 0;
+    isWriteWaitingForRead = false;
+    parser.reset();
+    outboundChain.clear();
+    
+    loop.removeTimer(connectTimer);
+    loop.removeTimer(keepAliveTimer);
+    connectTimer = 0;
+    keepAliveTimer = 0;
+    isAwaitingPingResponse = false;
+    isConnectedValue = false;
+    
+    outboundTopicAliases.clear();
+    outboundTopicAliasMaximum = 0;
+    inboundTopicAliases.clear();
+}
+
+// MARK: - Transferring
+
+void MqttConnection::setDescriptorEvents(uint32_t events) {
+    if (events == descriptorEvents) {
+        return;
+    }
+    
+    loop.addDescriptor(transport->getDescriptor(), events, [this](uint32_t readyEvents) {
+        handleDescriptorEvents(readyEvents);
+    });
+    
+    descriptorEvents = events;
+}
+
+void MqttConnection::handleDescriptorEvents(uint32_t events) {
+    switch (state) {
+        case State::Handshaking:
+            continueHandshake();
+            break;
+        case State::AwaitingAcknowledgement:
+        case State::Connected:
+            if (events & (EventLoop::Readable | EventLoop::Hangup)) {
+                readAvailable();
+            }
+            
+            if (transport != nullptr && (events & EventLoop::Writable)) {
+                flush();
+            }
+            break;
+        default:
+            break;
+    }
+}
+
+void MqttConnection::readAvailable(void) {
+    char buffer[MQTT_CONNECTION_READ_BUFFER_SIZE];
+    
+    // Read until the transport would block, since TLS may hold decrypted bytes the socket no longer reports.
+    while (transport != nullptr) {
+        auto result = transport->read(buffer, sizeof(buffer));
+        if (result.status == TransportStatus::WantRead) {
+            break;
+        } else if (result.status == TransportStatus::WantWrite) {
+            setDescriptorEvents(EventLoop::Readable | EventLoop::Writable);
+            break;
+        } else if (result.status != TransportStatus::Complete) {
+            handleConnectionFailure(MqttStatus::ConnectionLost);
+            return;
+        }
+        
+        parser.append(buffer, result.byteCount);
+        try {
+            MqttPacket packet;
+            while (transport != nullptr && parser.nextPacket(packet)) {
+                receivedPacketCount++;
+                handlePacket(packet);
+            }
+        } catch (const MqttProtocolError &) {
+            handleConnectionFailure(MqttStatus::ProtocolError);
+            return;
+        }
+    }
+    
+    if (transport != nullptr && isWriteWaitingForRead && !outboundChain.isEmpty()) {
+        flush();
+    }
+}
+
+void MqttConnection::handlePacket(const MqttPacket &packet) {
+    switch (packet.type) {
+        case MqttPacketType::ConnectAcknowledgement:
+            if (state != State::AwaitingAcknowledgement) {
+                throw MqttProtocolError("Expected a single CONNACK packet.");
+            }
+            
+            handleConnectAcknowledgement(packet);
+            break;
+        case MqttPacketType::Publish: {
+            REMOTE_CORE_TRACE_SCOPE("mqtt", "receive");
+            const std::string &topicName = resolveTopicName(packet);
+            
+            // Acknowledgements are coalesced with everything else written after this read.
+            if (packet.qualityOfService == 1) {
+                enqueuePacket(MqttPacket::withType(MqttPacketType::PublishAcknowledgement, packet.packetIdentifier));
+            } else if (packet.qualityOfService == 2) {
+                enqueuePacket(MqttPacket::withType(MqttPacketType::PublishReceived, packet.packetIdentifier));
+            }
+            
+            if (messageHandler) {
+                messageHandler(topicName, packet.payload.toString());
+            }
+            if (publishHandler) {
+                publishHandler(topicName, packet.payload, packet.properties);
+            }
+            break;
+        }
+        case MqttPacketType::PublishRelease:
+            enqueuePacket(MqttPacket::withType(MqttPacketType::PublishComplete, packet.packetIdentifier));
+            break;
+        case MqttPacketType::PublishAcknowledgement:
+        case MqttPacketType::UnsubscribeAcknowledgement:
+            completePendingAcknowledgement(packet.packetIdentifier, MqttStatus::Success);
+            break;
+        case MqttPacketType::SubscribeAcknowledgement: {
+            bool isRefused = std::any_of(packet.qualityOfServices.begin(), packet.qualityOfServices.end(), [](uint8_t returnCode) {
+                return returnCode >= MQTT_SUBSCRIPTION_FAILURE;
+            });
+            
+            completePendingAcknowledgement(packet.packetIdentifier, isRefused ? MqttStatus::SubscriptionRefused : MqttStatus::Success);
+            break;
+        }
+        case MqttPacketType::PingResponse:
+            isAwaitingPingResponse = false;
+            break;
+        case MqttPacketType::Disconnect:
+            // Only MQTT 5 brokers announce closing the connection, and their reason is not reported.
+            handleConnectionFailure(MqttStatus::ConnectionLost);
+            break;
+        default:
+            throw MqttProtocolError("Expected a packet that brokers send, instead of type " + std::to_string((int)packet.type) + ".");
+    }
+}
+
+const std::string &MqttConnection::resolveTopicName(const MqttPacket &packet) {
+    uint16_t topicAlias = packet.properties.topicAlias;
+    if (topicAlias == 0) {
+        return packet.topicName;
+    }
+    
+    if (topicAlias > options.topicAliasMaximum) {
+        throw MqttProtocolError("Expected a topic alias of at most " + std::to_string(options.topicAliasMaximum) + ".");
+    }
+    
+    if (!packet.topicName.empty()) {
+        return inboundTopicAliases[topicAlias] = packet.topicName;
+    }
+    
+    auto position = inboundTopicAliases.find(topicAlias);
+    if (position == inboundTopicAliases.end()) {
+        throw MqttProtocolError("Expected topic alias " + std::to_string(topicAlias) + " to have been assigned.");
+    }
+    
+    return position->second;
+}
+
+void MqttConnection::applyTopicAlias(MqttPacket &packet) {
+    packet.properties.topicAlias = 0;
+    if (outboundTopicAliasMaximum == 0) {
+        return;
+    }
+    
+    auto position = outboundTopicAliases.find(packet.topicName);
+    if (position != outboundTopicAliases.end()) {
+        packet.properties.topicAlias = position->second;
+        packet.topicName.clear();
+    } else if (outboundTopicAliases.size() < outboundTopicAliasMaximum) {
+        // The first message on the topic carries both its name and its alias, which stands for the name from then on.
+        packet.properties.topicAlias = (uint16_t)(outboundTopicAliases.size() + 1);
+        outboundTopicAliases.emplace(packet.topicName, packet.properties.topicAlias);
+    }
+}
+
+bool MqttConnection::enqueuePacket(const MqttPacket &packet) {
+    if (options.protocolLevel == MQTT_PROTOCOL_LEVEL) {
+        packet.encode(outboundChain);
+    } else {
+        // The packet is copied, sharing its payload, so that pending packets keep their topic names for the next connection.
+        MqttPacket versionedPacket = packet;
+        versionedPacket.protocolLevel = options.protocolLevel;
+        size_t topicAliasCount = outboundTopicAliases.size();
+        if (versionedPacket.type == MqttPacketType::Publish) {
+            applyTopicAlias(versionedPacket);
+        }
+        
+        // Only MQTT 5 brokers limit the packet size.
+        if (outboundMaximumPacketSize != 0 && versionedPacket.encodedLength() > outboundMaximumPacketSize) {
+            // The broker would not know an alias that was assigned to a packet it never received.
+            if (outboundTopicAliases.size() > topicAliasCount) {
+                outboundTopicAliases.erase(packet.topicName);
+            }
+            
+            return false;
+        }
+        
+        versionedPacket.encode(outboundChain);
+    }
+    
+    sentPacketCount++;
+    lastOutboundTime = EventLoop::Clock::now();
+    
+    // Flushing after the work that is already queued lets every packet it produces share one write.
+    if (!isFlushScheduled) {
+        isFlushScheduled = true;
+        loop.execute([this]() {
+            isFlushScheduled = false;
+            flush();
+        });
+    }
+    
+    return true;
+}
+
+void MqttConnection::flush(void) {
+    if (transport == nullptr) {
+        return;
+    }
+    
+    REMOTE_CORE_TRACE_SCOPE("mqtt", "flush");
+    isWriteWaitingForRead = false;
+    while (!outboundChain.isEmpty()) {
+        auto result = transport->writeChain(outboundChain);
+        if (result.status == TransportStatus::Complete) {
+            writeCount++;
+        } else if (result.status == TransportStatus::WantWrite) {
+            setDescriptorEvents(EventLoop::Readable | EventLoop::Writable);
+            return;
+        } else if (result.status == TransportStatus::WantRead) {
+            // Retried by 'readAvailable' once the transport has read what it is waiting for.
+            isWriteWaitingForRead = true;
+            return;
+        } else {
+            handleConnectionFailure(MqttStatus::ConnectionLost);
+            return;
+        }
+    }
+    
+    setDescriptorEvents(EventLoop::Readable);
+}
+
+// MARK: - Acknowledgements
+
+uint16_t MqttConnection::nextPacketIdentifier(void) {
+    // Zero is not a valid packet identifier, and identifiers still awaiting acknowledgement must not be reused.
+    do {
+        lastPacketIdentifier = lastPacketIdentifier == UINT16_MAX ? 1 : lastPacketIdentifier + 1;
+    } while (pendingAcknowledgements.count(lastPacketIdentifier) > 0 || expiredPublishIdentifiers.count(lastPacketIdentifier) > 0);
+    
+    return lastPacketIdentifier;
+}
+
+void MqttConnection::addPendingAcknowledgement(MqttPacket packet, CompletionHandler completionHandler) {
+    uint16_t packetIdentifier = packet.packetIdentifier;
+    auto deadline = EventLoop::Clock::now() + options.commandTimeout;
+    auto &pending = pendingAcknowledgements.emplace(packetIdentifier, PendingAcknowledgement{std::move(packet), std::move(completionHandler), deadline, false}).first->second;
+    armAcknowledgementTimer();
+    
+    if (state != State::Connected) {
+        return;
+    }
+    
+    if (pending.packet.type == MqttPacketType::Publish) {
+        waitingPublishIdentifiers.push_back(packetIdentifier);
+        sendWaitingPublishes();
+    } else if (enqueuePacket(pending.packet)) {
+        pending.isSent = true;
+    } else {
+        completePendingAcknowledgement(packetIdentifier, MqttStatus::PacketTooLarge);
+    }
+}
+
+void MqttConnection::completePendingAcknowledgement(uint16_t packetIdentifier, MqttStatus status) {
+    auto position = pendingAcknowledgements.find(packetIdentifier);
+    if (position == pendingAcknowledgements.end()) {
+        // The publish timed out, but only leaves the broker's receive maximum once acknowledged.
+        if (expiredPublishIdentifiers.erase(packetIdentifier) > 0) {
+            inFlightPublishCount--;
+            sendWaitingPublishes();
+        }
+        
+        return;
+    }
+    
+    auto completionHandler = std::move(position->second.completionHandler);
+    bool wasInFlight = position->second.isSent && position->second.packet.type == MqttPacketType::Publish;
+    pendingAcknowledgements.erase(position);
+    
+    if (wasInFlight) {
+        inFlightPublishCount--;
+        sendWaitingPublishes();
+    }
+    
+    if (completionHandler) {
+        completionHandler(status);
+    }
+}
+
+void MqttConnection::sendWaitingPublishes(void) {
+    std::vector<CompletionHandler> refusedHandlers;
+    while (state == State::Connected && inFlightPublishCount < inFlightPublishMaximum && !waitingPublishIdentifiers.empty()) {
+        auto position = pendingAcknowledgements.find(waitingPublishIdentifiers.front());
+        waitingPublishIdentifiers.pop_front();
+        if (position == pendingAcknowledgements.end()) {
+            continue;
+        }
+        
+        auto &pending = position->second;
+        if (enqueuePacket(pending.packet)) {
+            // The wait for the acknowledgement starts once the packet is sent.
+            pending.isSent = true;
+            pending.deadline = EventLoop::Clock::now() + options.commandTimeout;
+            inFlightPublishCount++;
+        } else {
+            refusedHandlers.push_back(std::move(pending.completionHandler));
+            pendingAcknowledgements.erase(position);
+        }
+    }
+    
+    for (auto &completionHandler : refusedHandlers) {
+        if (completionHandler) {
+            completionHandler(MqttStatus::PacketTooLarge);
+        }
+    }
+}
+
+void MqttConnection::failPendingAcknowledgements(MqttStatus status) {
+    std::map<uint16_t, PendingAcknowledgement> failedAcknowledgements;
+    failedAcknowledgements.swap(pendingAcknowledgements);
+    waitingPublishIdentifiers.clear();
+    expiredPublishIdentifiers.clear();
+    inFlightPublishCount = 0;
+    
+    for (auto &pair : failedAcknowledgements) {
+        if (pair.second.completionHandler) {
+            pair.second.completionHandler(status);
+        }
+    }
+}
+
+void MqttConnection::armAcknowledgementTimer(void) {
+    // A single timer covers every acknowledgement, armed for the earliest deadline.
+    if (acknowledgementTimer != 0 || pendingAcknowledgements.empty()) {
+        return;
+    }
+    
+    auto earliestDeadline = EventLoop::Clock::time_point::max();
+    for (auto &pair : pendingAcknowledgements) {
+        earliestDeadline = std::min(earliestDeadline, pair.second.deadline);
+    }
+    
+    auto delay = std::chrono::duration_cast<std::chrono::milliseconds>(earliestDeadline - EventLoop::Clock::now()) + std::chrono::milliseconds(1);
+    acknowledgementTimer = loop.addTimer(std::max(delay, std::chrono::milliseconds(0)), false, [this]() {
+        acknowledgementTimer = 0;
+        handleAcknowledgementTimeout();
+    });
+}
+
+void MqttConnection::handleAcknowledgementTimeout(void) {
+    auto now = EventLoop::Clock::now();
+    std::vector<CompletionHandler> expiredHandlers;
+    
+    for (auto position = pendingAcknowledgements.begin(); position != pendingAcknowledgements.end();) {
+        auto &pending = position->second;
+        if (pending.deadline <= now) {
+            if (pending.isSent && pending.packet.type == MqttPacketType::Publish) {
+                expiredPublishIdentifiers.insert(position->first);
+            }
+            
+            expiredHandlers.push_back(std::move(pending.completionHandler));
+            position = pendingAcknowledgements.erase(position);
+        } else {
+            position++;
+        }
+    }
+    
+    // Identifiers of publishes that timed out while waiting may be reused, so they must not be sent in place of a newer publish.
+    waitingPublishIdentifiers.erase(std::remove_if(waitingPublishIdentifiers.begin(), waitingPublishIdentifiers.end(), [this](uint16_t packetIdentifier) {
+        return pendingAcknowledgements.count(packetIdentifier) == 0;
+    }), waitingPublishIdentifiers.end());
+    
+    armAcknowledgementTimer();
+    for (auto &completionHandler : expiredHandlers) {
+        if (completionHandler) {
+            completionHandler(MqttStatus::Timeout);
+        }
+    }
+}
+
+void MqttConnection::scheduleKeepAlive(std::chrono::milliseconds delay) {
+    keepAliveTimer = loop.addTimer(delay, false, [this]() {
+        keepAliveTimer = 0;
+        handleKeepAlive();
+    });
+}
+
+void MqttConnection::handleKeepAlive(void) {
+    if (state != State::Connected) {
+        return;
+    }
+    
+    // The broker did not answer the previous ping, so the connection is presumed dead.
+    if (isAwaitingPingResponse) {
+        handleConnectionFailure(MqttStatus::ConnectionLost);
+        return;
+    }
+    
+    // Any packet resets the broker's keep alive timer, so a ping is only needed after a quiet interval.
+    auto interval = std::chrono::duration_cast<std::chrono::milliseconds>(keepAliveInterval);
+    auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(EventLoop::Clock::now() - lastOutboundTime);
+    if (elapsed >= interval) {
+        enqueuePacket(MqttPacket::withType(MqttPacketType::PingRequest));
+        isAwaitingPingResponse = true;
+        scheduleKeepAlive(std::min(options.commandTimeout, interval));
+    } else {
+        scheduleKeepAlive(interval - elapsed);
+    }
+}
@@ -0,0 +1,825 @@
+//
+//  MqttPacket.cpp
+//  remote_core
+//
+//  Created by David Moore on 10/19/26.
+//  Copyright © 2026 David Moore. All rights reserved.
+//
+
+#include "MqttPacket.hpp"
+
+using namespace RemoteCore;
+
+/// Fixed header flags that are required for PUBREL, SUBSCRIBE and UNSUBSCRIBE packets.
+#define MQTT_RESERVED_FLAGS 0x02
+
+#define MQTT_CONNECT_FLAG_USERNAME 0x80
+#define MQTT_CONNECT_FLAG_PASSWORD 0x40
+#define MQTT_CONNECT_FLAG_CLEAN_SESSION 0x02
+#define MQTT_CONNECT_FLAG_WILL 0x04
+
+#define MQTT_PROPERTY_MESSAGE_EXPIRY_INTERVAL 0x02
+#define MQTT_PROPERTY_RESPONSE_TOPIC 0x08
+#define MQTT_PROPERTY_CORRELATION_DATA 0x09
+#define MQTT_PROPERTY_SESSION_EXPIRY_INTERVAL 0x11
+#define MQTT_PROPERTY_SERVER_KEEP_ALIVE 0x13
+#define MQTT_PROPERTY_REASON_STRING 0x1F
+#define MQTT_PROPERTY_RECEIVE_MAXIMUM 0x21
+#define MQTT_PROPERTY_TOPIC_ALIAS_MAXIMUM 0x22
+#define MQTT_PROPERTY_TOPIC_ALIAS 0x23
+#define MQTT_PROPERTY_MAXIMUM_PACKET_SIZE 0x27
+
+// MARK: - Factories
+
+MqttPacket MqttPacket::connect(const std::string &clientID, uint16_t keepAliveInterval, bool isCleanSession) {
+    MqttPacket packet;
+    packet.type = MqttPacketType::Connect;
+    packet.clientID = clientID;
+    packet.keepAliveInterval = keepAliveInterval;
+    packet.isCleanSession = isCleanSession;
+    return packet;
+}
+
+MqttPacket MqttPacket::connectAcknowledgement(bool isSessionPresent, uint8_t returnCode) {
+    MqttPacket packet;
+    packet.type = MqttPacketType::ConnectAcknowledgement;
+    packet.isSessionPresent = isSessionPresent;
+    packet.returnCode = returnCode;
+    return packet;
+}
+
+MqttPacket MqttPacket::publish(const std::string &topicName, SharedBuffer payload, uint8_t qualityOfService, uint16_t packetIdentifier) {
+    MqttPacket packet;
+    packet.type = MqttPacketType::Publish;
+    packet.topicName = topicName;
+    packet.payload = std::move(payload);
+    packet.qualityOfService = qualityOfService;
+    packet.packetIdentifier = packetIdentifier;
+    return packet;
+}
+
+MqttPacket MqttPacket::subscribe(uint16_t packetIdentifier, const std::vector<std::string> &topicFilters, uint8_t qualityOfService) {
+    MqttPacket packet;
+    packet.type = MqttPacketType::Subscribe;
+    packet.packetIdentifier = packetIdentifier;
+    packet.topicFilters = topicFilters;
+    packet.qualityOfServices.assign(topicFilters.size(), qualityOfService);
+    return packet;
+}
+
+MqttPacket MqttPacket::unsubscribe(uint16_t packetIdentifier, const std::vector<std::string> &topicFilters) {
+    MqttPacket packet;
+    packet.type = MqttPacketType::Unsubscribe;
+    packet.packetIdentifier = packetIdentifier;
+    packet.topicFilters = topicFilters;
+    return packet;
+}
+
+MqttPacket MqttPacket::withType(MqttPacketType type, uint16_t packetIdentifier) {
+    MqttPacket packet;
+    packet.type = type;
+    packet.packetIdentifier = packetIdentifier;
+    return packet;
+}
+
+// MARK: - Encoding
+
+static void appendUInt16(std::string &buffer, uint16_t value) {
+    buffer.push_back((char)(value >> 8));
+    buffer.push_back((char)(value & 0xFF));
+}
+
+static void appendString(std::string &buffer, const std::string &value) {
+    if (value.size() > UINT16_MAX) {
+        throw std::length_error("Expected '" + value.substr(0, 32) + "...' to be at most 65535 bytes.");
+    }
+    
+    appendUInt16(buffer, (uint16_t)value.size());
+    buffer.append(value);
+}
+
+static void appendUInt32(std::string &buffer, uint32_t value) {
+    appendUInt16(buffer, (uint16_t)(value >> 16));
+    appendUInt16(buffer, (uint16_t)(value & 0xFFFF));
+}
+
+/**
+ Appends a variable length integer, with seven bits per byte, as used by the remaining length and by properties.
+ */
+static void appendVariableInteger(std::string &buffer, size_t value) {
+    do {
+        uint8_t byte = value % 128;
+        value /= 128;
+        buffer.push_back((char)(value > 0 ? (byte | 0x80) : byte));
+    } while (value > 0);
+}
+
+static size_t encodedStringLength(const std::string &value) {
+    return 2 + value.size();
+}
+
+static size_t encodedVariableIntegerLength(size_t value) {
+    size_t length = 1;
+    while (value >= 128) {
+        value /= 128;
+        length++;
+    }
+    
+    return length;
+}
+
+/**
+ Returns the length of the properties, without the length that precedes them.
+ */
+static size_t propertiesLength(const MqttProperties &properties) {
+    size_t length = 0;
+    length += properties.hasMessageExpiryInterval ? 1 + 4 : 0;
+    length += properties.responseTopic.empty() ? 0 : 1 + encodedStringLength(properties.responseTopic);
+    length += properties.correlationData.empty() ? 0 : 1 + encodedStringLength(properties.correlationData);
+    length += properties.sessionExpiryInterval != 0 ? 1 + 4 : 0;
+    length += properties.reasonString.empty() ? 0 : 1 + encodedStringLength(properties.reasonString);
+    length += properties.topicAliasMaximum != 0 ? 1 + 2 : 0;
+    length += properties.topicAlias != 0 ? 1 + 2 : 0;
+    length += properties.hasServerKeepAlive ? 1 + 2 : 0;
+    length += properties.receiveMaximum != 0 ? 1 + 2 : 0;
+    length += properties.maximumPacketSize != 0 ? 1 + 4 : 0;
+    return length;
+}
+
+static size_t encodedPropertiesLength(const MqttProperties &properties) {
+    size_t length = propertiesLength(properties);
+    return encodedVariableIntegerLength(length) + length;
+}
+
+static void appendProperties(std::string &buffer, const MqttProperties &properties) {
+    appendVariableInteger(buffer, propertiesLength(properties));
+    if (properties.hasMessageExpiryInterval) {
+        buffer.push_back((char)MQTT_PROPERTY_MESSAGE_EXPIRY_INTERVAL);
+        appendUInt32(buffer, properties.messageExpiryInterval);
+    }
+    if (!properties.responseTopic.empty()) {
+        buffer.push_back((char)MQTT_PROPERTY_RESPONSE_TOPIC);
+        appendString(buffer, properties.responseTopic);
+    }
+    if (!properties.correlationData.empty()) {
+        buffer.push_back((char)MQTT_PROPERTY_CORRELATION_DATA);
+        appendString(buffer, properties.correlationData);
+    }
+    if (properties.sessionExpiryInterval != 0) {
+        buffer.push_back((char)MQTT_PROPERTY_SESSION_EXPIRY_INTERVAL);
+        appendUInt32(buffer, properties.sessionExpiryInterval);
+    }
+    if (!properties.reasonString.empty()) {
+        buffer.push_back((char)MQTT_PROPERTY_REASON_STRING);
+        appendString(buffer, properties.reasonString);
+    }
+    if (properties.topicAliasMaximum != 0) {
+        buffer.push_back((char)MQTT_PROPERTY_TOPIC_ALIAS_MAXIMUM);
+        appendUInt16(buffer, properties.topicAliasMaximum);
+    }
+    if (properties.topicAlias != 0) {
+        buffer.push_back((char)MQTT_PROPERTY_TOPIC_ALIAS);
+        appendUInt16(buffer, properties.topicAlias);
+    }
+    if (properties.hasServerKeepAlive) {
+        buffer.push_back((char)MQTT_PROPERTY_SERVER_KEEP_ALIVE);
+        appendUInt16(buffer, properties.serverKeepAlive);
+    }
+    if (properties.receiveMaximum != 0) {
+        buffer.push_back((char)MQTT_PROPERTY_RECEIVE_MAXIMUM);
+        appendUInt16(buffer, properties.receiveMaximum);
+    }
+    if (properties.maximumPacketSize != 0) {
+        buffer.push_back((char)MQTT_PROPERTY_MAXIMUM_PACKET_SIZE);
+        appendUInt32(buffer, properties.maximumPacketSize);
+    }
+}
+
+/**
+ Returns true if an MQTT 5 acknowledgement or DISCONNECT packet needs more than its packet identifier, which is only the case when it is not a plain success.
+ */
+static bool hasReasonCode(const MqttPacket &packet) {
+    return packet.returnCode != 0 || !packet.properties.isEmpty();
+}
+
+static size_t encodedReasonCodeLength(const MqttPacket &packet) {
+    if (!hasReasonCode(packet)) {
+        return 0;
+    }
+    
+    return 1 + (packet.properties.isEmpty() ? 0 : encodedPropertiesLength(packet.properties));
+}
+
+/**
+ Appends the reason code of an MQTT 5 acknowledgement or DISCONNECT packet, followed by its properties if it has any.
+ */
+static void appendReasonCode(std::string &buffer, const MqttPacket &packet) {
+    if (!hasReasonCode(packet)) {
+        return;
+    }
+    
+    buffer.push_back((char)packet.returnCode);
+    if (!packet.properties.isEmpty()) {
+        appendProperties(buffer, packet.properties);
+    }
+}
+
+/**
+ Returns the length of everything after the fixed header, which must be known before the packet is written.
+ */
+static size_t remainingLength(const MqttPacket &packet) {
+    bool hasProperties = packet.protocolLevel >= MQTT_5_PROTOCOL_LEVEL;
+    size_t propertySectionLength = hasProperties ? encodedPropertiesLength(packet.properties) : 0;
+    
+    size_t length = 0;
+    switch (packet.type) {
+        case MqttPacketType::Connect:
+            length = encodedStringLength("MQTT") + 1 + 1 + 2 + propertySectionLength + encodedStringLength(packet.clientID);
+            if (!packet.username.empty()) {
+                length += encodedStringLength(packet.username);
+            }
+            if (!packet.password.empty()) {
+                length += encodedStringLength(packet.password);
+            }
+            break;
+        case MqttPacketType::ConnectAcknowledgement:
+            length = 2 + propertySectionLength;
+            break;
+        case MqttPacketType::Publish:
+            length = encodedStringLength(packet.topicName) + (packet.qualityOfService > 0 ? 2 : 0) + propertySectionLength + packet.payload.size();
+            break;
+        case MqttPacketType::Subscribe:
+            length = 2 + propertySectionLength;
+            for (auto &topicFilter : packet.topicFilters) {
+                length += encodedStringLength(topicFilter) + 1;
+            }
+            break;
+        case MqttPacketType::SubscribeAcknowledgement:
+            length = 2 + propertySectionLength + packet.qualityOfServices.size();
+            break;
+        case MqttPacketType::Unsubscribe:
+            length = 2 + propertySectionLength;
+            for (auto &topicFilter : packet.topicFilters) {
+                length += encodedStringLength(topicFilter);
+            }
+            break;
+        case MqttPacketType::UnsubscribeAcknowledgement:
+            length = 2 + (hasProperties ? propertySectionLength + packet.qualityOfServices.size() : 0);
+            break;
+        case MqttPacketType::PublishAcknowledgement:
+        case MqttPacketType::PublishReceived:
+        case MqttPacketType::PublishRelease:
+        case MqttPacketType::PublishComplete:
+            length = 2 + (hasProperties ? encodedReasonCodeLength(packet) : 0);
+            break;
+        case MqttPacketType::Disconnect:
+            length = hasProperties ? encodedReasonCodeLength(packet) : 0;
+            break;
+        case MqttPacketType::PingRequest:
+        case MqttPacketType::PingResponse:
+            break;
+    }
+    
+    return length;
+}
+
+size_t MqttPacket::encodedLength(void) const {
+    size_t length = remainingLength(*this);
+    return 1 + encodedVariableIntegerLength(length) + length;
+}
+
+void MqttPacket::encode(std::string &buffer) const {
+    buffer.reserve(buffer.size() + 5 + remainingLength(*this));
+    encodeWithoutPayload(buffer);
+    
+    if (type == MqttPacketType::Publish) {
+        payload.appendTo(buffer);
+    }
+}
+
+void MqttPacket::encode(BufferChain &chain) const {
+    chain.appendBytes([this](std::string &buffer) {
+        encodeWithoutPayload(buffer);
+    });
+    
+    if (type == MqttPacketType::Publish) {
+        chain.append(payload);
+    }
+}
+
+void MqttPacket::encodeWithoutPayload(std::string &buffer) const {
+    size_t length = remainingLength(*this);
+    if (length > MQTT_MAXIMUM_REMAINING_LENGTH) {
+        throw std::length_error("Expected the packet to be at most 256 MiB.");
+    }
+    
+    uint8_t flags = 0;
+    if (type == MqttPacketType::Publish) {
+        flags = (uint8_t)((isDuplicate ? 0x08 : 0) | ((qualityOfService & 0x03) << 1) | (isRetained ? 0x01 : 0));
+    } else if (type == MqttPacketType::PublishRelease || type == MqttPacketType::Subscribe || type == MqttPacketType::Unsubscribe) {
+        flags = MQTT_RESERVED_FLAGS;
+    }
+    
+    buffer.reserve(buffer.size() + 5 + length - (type == MqttPacketType::Publish ? payload.size() : 0));
+    buffer.push_back((char)(((uint8_t)type << 4) | flags));
+    appendVariableInteger(buffer, length);
+    
+    bool hasProperties = protocolLevel >= MQTT_5_PROTOCOL_LEVEL;
+    switch (type) {
+        case MqttPacketType::Connect: {
+            appendString(buffer, "MQTT");
+            buffer.push_back((char)protocolLevel);
+            
+            uint8_t connectFlags = isCleanSession ? MQTT_CONNECT_FLAG_CLEAN_SESSION : 0;
+            connectFlags |= username.empty() ? 0 : MQTT_CONNECT_FLAG_USERNAME;
+            connectFlags |= password.empty() ? 0 : MQTT_CONNECT_FLAG_PASSWORD;
+            buffer.push_back((char)connectFlags);
+            appendUInt16(buffer, keepAliveInterval);
+            if (hasProperties) {
+                appendProperties(buffer, properties);
+            }
+            
+            appendString(buffer, clientID);
+            if (!username.empty()) {
+                appendString(buffer, username);
+            }
+            if (!password.empty()) {
+                appendString(buffer, password);
+            }
+            break;
+        }
+        case MqttPacketType::ConnectAcknowledgement:
+            buffer.push_back(isSessionPresent ? 0x01 : 0x00);
+            buffer.push_back((char)returnCode);
+            if (hasProperties) {
+                appendProperties(buffer, properties);
+            }
+            break;
+        case MqttPacketType::Publish:
+            appendString(buffer, topicName);
+            if (qualityOfService > 0) {
+                appendUInt16(buffer, packetIdentifier);
+            }
+            if (hasProperties) {
+                appendProperties(buffer, properties);
+            }
+            break;
+        case MqttPacketType::Subscribe:
+            appendUInt16(buffer, packetIdentifier);
+            if (hasProperties) {
+                appendProperties(buffer, properties);
+            }
+            for (size_t i = 0; i < topicFilters.size(); i++) {
+                appendString(buffer, topicFilters[i]);
+                buffer.push_back((char)(i < qualityOfServices.size() ? qualityOfServices[i] : 0));
+            }
+            break;
+        case MqttPacketType::SubscribeAcknowledgement:
+            appendUInt16(buffer, packetIdentifier);
+            if (hasProperties) {
+                appendProperties(buffer, properties);
+            }
+            for (auto qualityOfService : qualityOfServices) {
+                buffer.push_back((char)qualityOfService);
+            }
+            break;
+        case MqttPacketType::Unsubscribe:
+            appendUInt16(buffer, packetIdentifier);
+            if (hasProperties) {
+                appendProperties(buffer, properties);
+            }
+            for (auto &topicFilter : topicFilters) {
+                appendString(buffer, topicFilter);
+            }
+            break;
+        case MqttPacketType::UnsubscribeAcknowledgement:
+            appendUInt16(buffer, packetIdentifier);
+            if (hasProperties) {
+                appendProperties(buffer, properties);
+                for (auto reasonCode : qualityOfServices) {
+                    buffer.push_back((char)reasonCode);
+                }
+            }
+            break;
+        case MqttPacketType::PublishAcknowledgement:
+        case MqttPacketType::PublishReceived:
+        case MqttPacketType::PublishRelease:
+        case MqttPacketType::PublishComplete:
+            appendUInt16(buffer, packetIdentifier);
+            if (hasProperties) {
+                appendReasonCode(buffer, *this);
+            }
+            break;
+        case MqttPacketType::Disconnect:
+            if (hasProperties) {
+                appendReasonCode(buffer, *this);
+            }
+            break;
+        case MqttPacketType::PingRequest:
+        case MqttPacketType::PingResponse:
+            break;
+    }
+}
+
+// MARK: - Decoding
+
+namespace {
+    /**
+     Reads the fields of a packet body, throwing if the body ends early.
+     */
+    class PacketReader {
+        const char *bytes;
+        size_t length;
+        size_t offset;
+    
+    public:
+        PacketReader(const char *bytes, size_t length) : bytes(bytes), length(length), offset(0) {}
+        
+        size_t getRemainingLength(void) const {
+            return length - offset;
+        }
+        
+        uint8_t readUInt8(void) {
+            if (getRemainingLength() < 1) {
+                throw MqttProtocolError("Expected the packet to contain another byte.");
+            }
+            
+            return (uint8_t)bytes[offset++];
+        }
+        
+        uint16_t readUInt16(void) {
+            uint16_t high = readUInt8();
+            return (uint16_t)((high << 8) | readUInt8());
+        }
+        
+        uint32_t readUInt32(void) {
+            uint32_t high = readUInt16();
+            return (high << 16) | readUInt16();
+        }
+        
+        size_t readVariableInteger(void) {
+            size_t value = 0;
+            for (size_t i = 0; i < 4; i++) {
+                uint8_t byte = readUInt8();
+                value |= (size_t)(byte & 0x7F) << (7 * i);
+                if ((byte & 0x80) == 0) {
+                    return value;
+                }
+            }
+            
+            throw MqttProtocolError("Expected a variable length integer to be at most four bytes.");
+        }
+        
+        std::string readString(void) {
+            size_t stringLength = readUInt16();
+            return readBytes(stringLength);
+        }
+        
+        std::string readBytes(size_t count) {
+            if (getRemainingLength() < count) {
+                throw MqttProtocolError("Expected the packet to contain " + std::to_string(count) + " more bytes.");
+            }
+            
+            std::string value(bytes + offset, count);
+            offset += count;
+            return value;
+        }
+        
+        /**
+         Returns a reader of the next bytes, which are skipped by this reader.
+         */
+        PacketReader readSection(size_t count) {
+            if (getRemainingLength() < count) {
+                throw MqttProtocolError("Expected the packet to contain " + std::to_string(count) + " more bytes.");
+            }
+            
+            PacketReader section(bytes + offset, count);
+            offset += count;
+            return section;
+        }
+        
+        void expectEnd(void) const {
+            if (getRemainingLength() != 0) {
+                throw MqttProtocolError("Expected the packet to end after its last field.");
+            }
+        }
+    };
+    
+    /**
+     Reads the properties of an MQTT 5 packet, skipping those that are not kept.
+     */
+    MqttProperties readProperties(PacketReader &reader) {
+        MqttProperties properties;
+        PacketReader section = reader.readSection(reader.readVariableInteger());
+        
+        while (section.getRemainingLength() > 0) {
+            size_t identifier = section.readVariableInteger();
+            switch (identifier) {
+                case MQTT_PROPERTY_MESSAGE_EXPIRY_INTERVAL:
+                    properties.hasMessageExpiryInterval = true;
+                    properties.messageExpiryInterval = section.readUInt32();
+                    break;
+                case MQTT_PROPERTY_RESPONSE_TOPIC:
+                    properties.responseTopic = section.readString();
+                    break;
+                case MQTT_PROPERTY_CORRELATION_DATA:
+                    properties.correlationData = section.readString();
+                    break;
+                case MQTT_PROPERTY_SESSION_EXPIRY_INTERVAL:
+                    properties.sessionExpiryInterval = section.readUInt32();
+                    break;
+                case MQTT_PROPERTY_REASON_STRING:
+                    properties.reasonString = section.readString();
+                    break;
+                case MQTT_PROPERTY_TOPIC_ALIAS_MAXIMUM:
+                    properties.topicAliasMaximum = section.readUInt16();
+                    break;
+                case MQTT_PROPERTY_TOPIC_ALIAS:
+                    properties.topicAlias = section.readUInt16();
+                    if (properties.topicAlias == 0) {
+                        throw MqttProtocolError("Expected a topic alias above zero.");
+                    }
+                    break;
+                case MQTT_PROPERTY_SERVER_KEEP_ALIVE:
+                    properties.hasServerKeepAlive = true;
+                    properties.serverKeepAlive = section.readUInt16();
+                    break;
+                case MQTT_PROPERTY_RECEIVE_MAXIMUM:
+                    properties.receiveMaximum = section.readUInt16();
+                    if (properties.receiveMaximum == 0) {
+                        throw MqttProtocolError("Expected a receive maximum above zero.");
+                    }
+                    break;
+                case MQTT_PROPERTY_MAXIMUM_PACKET_SIZE:
+                    properties.maximumPacketSize = section.readUInt32();
+                    if (properties.maximumPacketSize == 0) {
+                        throw MqttProtocolError("Expected a maximum packet size above zero.");
+                    }
+                    break;
+                    
+                // Payload format, request problem and response information, maximum quality of service, and retained, wildcard, subscription identifier and shared subscription availability.
+                case 0x01: case 0x17: case 0x19: case 0x24: case 0x25: case 0x28: case 0x29: case 0x2A:
+                    section.readUInt8();
+                    break;
+                    
+                // Will delay interval.
+                case 0x18:
+                    section.readUInt32();
+                    break;
+                    
+                // Subscription identifier.
+                case 0x0B:
+                    section.readVariableInteger();
+                    break;
+                    
+                // Content type, assigned client identifier, authentication method and data, response information, and server reference.
+                case 0x03: case 0x12: case 0x15: case 0x16: case 0x1A: case 0x1C:
+                    section.readString();
+                    break;
+                    
+                // User property, which is a pair of strings.
+                case 0x26:
+                    section.readString();
+                    section.readString();
+                    break;
+                default:
+                    throw MqttProtocolError("Expected a known property, instead of " + std::to_string(identifier) + ".");
+            }
+        }
+        
+        return properties;
+    }
+    
+    /**
+     Reads the optional reason code, and properties, that end MQTT 5 acknowledgements and DISCONNECT packets.
+     */
+    void readReasonCode(PacketReader &reader, MqttPacket &packet) {
+        if (reader.getRemainingLength() > 0) {
+            packet.returnCode = reader.readUInt8();
+        }
+        if (reader.getRemainingLength() > 0) {
+            packet.properties = readProperties(reader);
+        }
+    }
+}
+
+MqttPacket MqttPacketParser::decode(uint8_t header, const char *bytes, size_t length, uint8_t protocolLevel) {
+    uint8_t typeValue = header >> 4;
+    uint8_t flags = header & 0x0F;
+    if (typeValue < (uint8_t)MqttPacketType::Connect || typeValue > (uint8_t)MqttPacketType::Disconnect) {
+        throw MqttProtocolError("Expected a known packet type, instead of " + std::to_string(typeValue) + ".");
+    }
+    
+    MqttPacket packet;
+    packet.type = (MqttPacketType)typeValue;
+    packet.protocolLevel = protocolLevel;
+    
+    bool requiresReservedFlags = packet.type == MqttPacketType::PublishRelease || packet.type == MqttPacketType::Subscribe || packet.type == MqttPacketType::Unsubscribe;
+    if (packet.type != MqttPacketType::Publish && flags != (requiresReservedFlags ? MQTT_RESERVED_FLAGS : 0)) {
+        throw MqttProtocolError("Expected the reserved flags of the packet to be set correctly.");
+    }
+    
+    PacketReader reader(bytes, length);
+    bool hasProperties = protocolLevel >= MQTT_5_PROTOCOL_LEVEL;
+    switch (packet.type) {
+        case MqttPacketType::Connect: {
+            if (reader.readString() != "MQTT") {
+                throw MqttProtocolError("Expected an MQTT connection.");
+            }
+            
+            packet.protocolLevel = reader.readUInt8();
+            if (packet.protocolLevel != MQTT_PROTOCOL_LEVEL && packet.protocolLevel != MQTT_5_PROTOCOL_LEVEL) {
+                throw MqttProtocolError("Expected an MQTT 3.1.1 or MQTT 5 connection.");
+            }
+            
+            hasProperties = packet.protocolLevel >= MQTT_5_PROTOCOL_LEVEL;
+            uint8_t connectFlags = reader.readUInt8();
+            packet.isCleanSession = (connectFlags & MQTT_CONNECT_FLAG_CLEAN_SESSION) != 0;
+            packet.keepAliveInterval = reader.readUInt16();
+            if (hasProperties) {
+                packet.properties = readProperties(reader);
+            }
+            
+            packet.clientID = reader.readString();
+            
+            // Wills are not supported, so their fields are skipped.
+            if (connectFlags & MQTT_CONNECT_FLAG_WILL) {
+                if (hasProperties) {
+                    readProperties(reader);
+                }
+                
+                reader.readString();
+                reader.readString();
+            }
+            if (connectFlags & MQTT_CONNECT_FLAG_USERNAME) {
+                packet.username = reader.readString();
+            }
+            if (connectFlags & MQTT_CONNECT_FLAG_PASSWORD) {
+                packet.password = reader.readString();
+            }
+            break;
+        }
+        case MqttPacketType::ConnectAcknowledgement:
+            packet.isSessionPresent = (reader.readUInt8() & 0x01) != 0;
+            packet.returnCode = reader.readUInt8();
+            if (hasProperties) {
+                packet.properties = readProperties(reader);
+            }
+            break;
+        case MqttPacketType::Publish:
+            packet.isDuplicate = (flags & 0x08) != 0;
+            packet.qualityOfService = (flags >> 1) & 0x03;
+            packet.isRetained = (flags & 0x01) != 0;
+            if (packet.qualityOfService > 2) {
+                throw MqttProtocolError("Expected a quality of service of at most two.");
+            }
+            
+            packet.topicName = reader.readString();
+            if (packet.topicName.find_first_of("+#") != std::string::npos) {
+                throw MqttProtocolError("Expected the topic name of a PUBLISH packet not to contain wildcards.");
+            }
+            
+            if (packet.qualityOfService > 0) {
+                packet.packetIdentifier = reader.readUInt16();
+            }
+            
+            if (hasProperties) {
+                packet.properties = readProperties(reader);
+                
+                // The topic name may only be left out in favour of its alias.
+                if (packet.topicName.empty() && packet.properties.topicAlias == 0) {
+                    throw MqttProtocolError("Expected a PUBLISH packet to have a topic name or a topic alias.");
+                }
+            }
+            
+            packet.payload = SharedBuffer(reader.readBytes(reader.getRemainingLength()));
+            break;
+        case MqttPacketType::Subscribe:
+            packet.packetIdentifier = reader.readUInt16();
+            if (hasProperties) {
+                packet.properties = readProperties(reader);
+            }
+            
+            // The subscription options of MQTT 5 keep the quality of service in their lowest bits, and the other options are not supported.
+            while (reader.getRemainingLength() > 0) {
+                packet.topicFilters.push_back(reader.readString());
+                packet.qualityOfServices.push_back(reader.readUInt8() & 0x03);
+            }
+            
+            if (packet.topicFilters.empty()) {
+                throw MqttProtocolError("Expected a SUBSCRIBE packet to contain at least one topic filter.");
+            }
+            break;
+        case MqttPacketType::SubscribeAcknowledgement:
+        case MqttPacketType::UnsubscribeAcknowledgement:
+            packet.packetIdentifier = reader.readUInt16();
+            if (hasProperties) {
+                packet.properties = readProperties(reader);
+            }
+            
+            // MQTT 3.1.1 UNSUBACK packets end after their packet identifier.
+            while (reader.getRemainingLength() > 0) {
+                packet.qualityOfServices.push_back(reader.readUInt8());
+            }
+            break;
+        case MqttPacketType::Unsubscribe:
+            packet.packetIdentifier = reader.readUInt16();
+            if (hasProperties) {
+                packet.properties = readProperties(reader);
+            }
+            
+            while (reader.getRemainingLength() > 0) {
+                packet.topicFilters.push_back(reader.readString());
+            }
+            
+            if (packet.topicFilters.empty()) {
+                throw MqttProtocolError("Expected an UNSUBSCRIBE packet to contain at least one topic filter.");
+            }
+            break;
+        case MqttPacketType::PublishAcknowledgement:
+        case MqttPacketType::PublishReceived:
+        case MqttPacketType::PublishRelease:
+        case MqttPacketType::PublishComplete:
+            packet.packetIdentifier = reader.readUInt16();
+            if (hasProperties) {
+                readReasonCode(reader, packet);
+            }
+            break;
+        case MqttPacketType::Disconnect:
+            if (hasProperties) {
+                readReasonCode(reader, packet);
+            }
+            break;
+        case MqttPacketType::PingRequest:
+        case MqttPacketType::PingResponse:
+            break;
+    }
+    
+    reader.expectEnd();
+    return packet;
+}
+
+// MARK: - Parser
+
+MqttPacketParser::MqttPacketParser(size_t maximumPacketSize) : offset(0), maximumPacketSize(maximumPacketSize), protocolLevel(MQTT_PROTOCOL_LEVEL) {
+}
+
+void MqttPacketParser::append(const char *bytes, size_t length) {
+    // Compact the buffer only once the consumed prefix is large, so that most reads do not move any bytes.
+    if (offset == buffer.size()) {
+        buffer.clear();
+        offset = 0;
+    } else if (offset > 64 * 1024 && offset > buffer.size() / 2) {
+        buffer.erase(0, offset);
+        offset = 0;
+    }
+    
+    buffer.append(bytes, length);
+}
+
+bool MqttPacketParser::nextPacket(MqttPacket &packet) {
+    size_t availableLength = buffer.size() - offset;
+    if (availableLength < 2) {
+        return false;
+    }
+    
+    const char *bytes = buffer.data() + offset;
+    size_t remainingLength = 0;
+    size_t multiplier = 1;
+    size_t headerLength = 1;
+    
+    while (true) {
+        if (headerLength >= availableLength) {
+            return false;
+        }
+        
+        uint8_t byte = (uint8_t)bytes[headerLength++];
+        remainingLength += (byte & 0x7F) * multiplier;
+        if ((byte & 0x80) == 0) {
+            break;
+        }
+        
+        multiplier *= 128;
+        if (headerLength > 4) {
+            throw MqttProtocolError("Expected the remaining length to be at most four bytes.");
+        }
+    }
+    
+    if (headerLength + remainingLength > maximumPacketSize) {
+        throw MqttProtocolError("Expected packets to be at most " + std::to_string(maximumPacketSize) + " bytes.");
+    }
+    
+    if (availableLength < headerLength + remainingLength) {
+        return false;
+    }
+    
+    packet = decode((uint8_t)bytes[0], bytes + headerLength, remainingLength, protocolLevel);
+    offset += headerLength + remainingLength;
+    
+    return true;
+}
+
+void MqttPacketParser::reset(void) {
+    buffer.clear();
+    offset = 0;
+}
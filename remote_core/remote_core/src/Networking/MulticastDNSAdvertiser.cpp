@@ -0,0 +1,445 @@
+//
+//  MulticastDNSAdvertiser.cpp
+//  remote_core
+//
+//  Created by David Moore on 10/19/26.
+//  Copyright © 2026 David Moore. All rights reserved.
+//
+
+#include "MulticastDNSAdvertiser.hpp"
+#include "StreamTransport.hpp"
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <system_error>
+#include <fcntl.h>
+#include <ifaddrs.h>
+#include <net/if.h>
+#include <strings.h>
+#include <unistd.h>
+#include <arpa/inet.h>
+#include <arpa/nameser.h>
+#include <sys/socket.h>
+
+using namespace RemoteCore;
+
+/// Time to live of records that name the host or its addresses, which change if the device moves.
+#define MULTICAST_DNS_HOST_TIME_TO_LIVE 120
+
+/// Time to live of every other record.
+#define MULTICAST_DNS_SERVICE_TIME_TO_LIVE 4500
+
+/// Longest time to live that one-shot queriers may cache an answer for.
+#define MULTICAST_DNS_ONE_SHOT_TIME_TO_LIVE 10
+
+/// Set in the class of records that replace whatever the querier cached for their name, and in the class of questions that ask for a direct response.
+#define MULTICAST_DNS_CACHE_FLUSH 0x8000
+
+#define MULTICAST_DNS_HEADER_LENGTH 12
+#define MULTICAST_DNS_MAXIMUM_MESSAGE_LENGTH 9000
+#define MULTICAST_DNS_MAXIMUM_LABEL_LENGTH 63
+
+/// Name that lists the types of every service on the network.
+#define MULTICAST_DNS_SERVICE_ENUMERATION_NAME "_services._dns-sd._udp.local"
+
+enum MulticastDNSRecord : uint32_t {
+    ServiceTypePointerRecord = 1 << 0,
+    InstancePointerRecord = 1 << 1,
+    ServiceLocationRecord = 1 << 2,
+    TextRecord = 1 << 3,
+    AddressRecord = 1 << 4
+};
+
+static void throwSystemError(const char *operation, int error = errno) {
+    throw std::system_error(error, std::generic_category(), operation);
+}
+
+static void appendUInt16(std::string &bytes, uint16_t value) {
+    bytes.push_back((char)(value >> 8));
+    bytes.push_back((char)value);
+}
+
+static void appendUInt32(std::string &bytes, uint32_t value) {
+    appendUInt16(bytes, (uint16_t)(value >> 16));
+    appendUInt16(bytes, (uint16_t)value);
+}
+
+static std::vector<std::string> labelsForName(const std::string &name) {
+    std::vector<std::string> labels;
+    size_t start = 0;
+    while (start <= name.size()) {
+        size_t end = name.find('.', start);
+        if (end == std::string::npos) {
+            end = name.size();
+        }
+        
+        if (end > start) {
+            labels.push_back(name.substr(start, end - start));
+        }
+        
+        start = end + 1;
+    }
+    
+    return labels;
+}
+
+/**
+ Appends the labels without compression. Labels are truncated to the longest a label may be.
+ */
+static void appendLabels(std::string &bytes, const std::vector<std::string> &labels) {
+    for (auto &label : labels) {
+        size_t length = std::min<size_t>(label.size(), MULTICAST_DNS_MAXIMUM_LABEL_LENGTH);
+        bytes.push_back((char)length);
+        bytes.append(label, 0, length);
+    }
+    
+    bytes.push_back(0);
+}
+
+/**
+ Returns the name in the presentation form that 'ns_name_uncompress' produces, so that names can be compared without regard to how their labels are escaped.
+ */
+static std::string presentationNameForLabels(const std::vector<std::string> &labels) {
+    std::string wireName;
+    appendLabels(wireName, labels);
+    
+    char name[NS_MAXDNAME];
+    if (ns_name_ntop((const u_char *)wireName.data(), name, sizeof(name)) < 0) {
+        return std::string();
+    }
+    
+    return name;
+}
+
+static void appendRecord(std::string &bytes, const std::vector<std::string> &labels, uint16_t type, uint16_t recordClass, uint32_t timeToLive, const std::string &data) {
+    appendLabels(bytes, labels);
+    appendUInt16(bytes, type);
+    appendUInt16(bytes, recordClass);
+    appendUInt32(bytes, timeToLive);
+    appendUInt16(bytes, (uint16_t)data.size());
+    bytes.append(data);
+}
+
+/**
+ Returns the IPv4 address of every interface that is up, other than the loopback interface.
+ */
+static std::vector<struct in_addr> getInterfaceAddresses(void) {
+    std::vector<struct in_addr> addresses;
+    struct ifaddrs *interfaces = nullptr;
+    if (getifaddrs(&interfaces) != 0) {
+        return addresses;
+    }
+    
+    for (auto interface = interfaces; interface != nullptr; interface = interface->ifa_next) {
+        if (interface->ifa_addr == nullptr || interface->ifa_addr->sa_family != AF_INET) {
+            continue;
+        }
+        
+        if (!(interface->ifa_flags & IFF_UP) || (interface->ifa_flags & IFF_LOOPBACK)) {
+            continue;
+        }
+        
+        addresses.push_back(((struct sockaddr_in *)interface->ifa_addr)->sin_addr);
+    }
+    
+    freeifaddrs(interfaces);
+    return addresses;
+}
+
+MulticastDNSAdvertiser::MulticastDNSAdvertiser(const ServiceDescription &service, uint16_t port) : service(service), fd(-1), port(0) {
+    serviceLabels = labelsForName(service.serviceType + ".local");
+    instanceLabels = serviceLabels;
+    instanceLabels.insert(instanceLabels.begin(), service.instanceName);
+    hostLabels = {service.hostName, "local"};
+    
+    serviceName = presentationNameForLabels(serviceLabels);
+    instanceName = presentationNameForLabels(instanceLabels);
+    hostName = presentationNameForLabels(hostLabels);
+    
+    fd = socket(AF_INET, SOCK_DGRAM, 0);
+    if (fd < 0) {
+        throwSystemError("socket");
+    }
+    
+    int flags = fcntl(fd, F_GETFL, 0);
+    fcntl(fd, F_SETFL, flags | O_NONBLOCK);
+    fcntl(fd, F_SETFD, FD_CLOEXEC);
+    
+    // Other responders on the device (e.g., Avahi) share the port.
+    int isEnabled = 1;
+    setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &isEnabled, sizeof(isEnabled));
+#ifdef SO_REUSEPORT
+    setsockopt(fd, SOL_SOCKET, SO_REUSEPORT, &isEnabled, sizeof(isEnabled));
+#endif
+
+    struct sockaddr_in address = {};
+    address.sin_family = AF_INET;
+    address.sin_port = htons(port);
+    address.sin_addr.s_addr = htonl(INADDR_ANY);
+    if (bind(fd, (struct sockaddr *)&address, sizeof(address)) != 0) {
+        int error = errno;
+        close(fd);
+        throwSystemError("bind", error);
+    }
+    
+    this->port = StreamTransport::getLocalPort(fd);
+    
+    struct ip_mreq membership = {};
+    inet_pton(AF_INET, MULTICAST_DNS_GROUP, &membership.imr_multiaddr);
+    membership.imr_interface.s_addr = htonl(INADDR_ANY);
+    setsockopt(fd, IPPROTO_IP, IP_ADD_MEMBERSHIP, &membership, sizeof(membership));
+    
+    unsigned char timeToLive = 255;
+    setsockopt(fd, IPPROTO_IP, IP_MULTICAST_TTL, &timeToLive, sizeof(timeToLive));
+    
+    loop.addDescriptor(fd, EventLoop::Readable, [this](uint32_t events) {
+        handleQueries();
+    });
+    
+    // The service is announced twice, a second apart, in case the first is lost.
+    loop.execute([this]() {
+        announce(false);
+    });
+    
+    loop.addTimer(std::chrono::seconds(1), false, [this]() {
+        announce(false);
+    });
+    
+    loopThread = std::thread([this]() {
+        loop.run();
+    });
+}
+
+MulticastDNSAdvertiser::~MulticastDNSAdvertiser() {
+    loop.execute([this]() {
+        // Records with no time to live tell every querier to forget the service.
+        announce(true);
+        
+        loop.removeDescriptor(fd);
+        close(fd);
+        loop.stop();
+    });
+    
+    loopThread.join();
+}
+
+// MARK: - Queries
+
+void MulticastDNSAdvertiser::handleQueries(void) {
+    uint8_t bytes[MULTICAST_DNS_MAXIMUM_MESSAGE_LENGTH];
+    while (true) {
+        struct sockaddr_in sender = {};
+        socklen_t senderLength = sizeof(sender);
+        ssize_t length = recvfrom(fd, bytes, sizeof(bytes), 0, (struct sockaddr *)&sender, &senderLength);
+        if (length < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            
+            return;
+        }
+        
+        if (sender.sin_family == AF_INET) {
+            handleQuery(bytes, (size_t)length, sender);
+        }
+    }
+}
+
+void MulticastDNSAdvertiser::handleQuery(const uint8_t *bytes, size_t length, const struct sockaddr_in &sender) {
+    if (length < MULTICAST_DNS_HEADER_LENGTH) {
+        return;
+    }
+    
+    // Responses, including this advertiser's own, and anything other than a standard query are ignored.
+    uint16_t flags = ns_get16(bytes + 2);
+    if ((flags & 0x8000) != 0 || ((flags >> 11) & 0xF) != ns_o_query) {
+        return;
+    }
+    
+    uint16_t identifier = ns_get16(bytes);
+    uint16_t questionCount = ns_get16(bytes + 4);
+    const uint8_t *position = bytes + MULTICAST_DNS_HEADER_LENGTH;
+    const uint8_t *end = bytes + length;
+    
+    uint32_t answerRecords = 0;
+    uint32_t additionalRecords = 0;
+    bool asksForDirectResponse = false;
+    for (uint16_t i = 0; i < questionCount; i++) {
+        char name[NS_MAXDNAME];
+        int nameLength = ns_name_uncompress(bytes, end, position, name, sizeof(name));
+        if (nameLength < 0 || position + nameLength + 2 * NS_INT16SZ > end) {
+            return;
+        }
+        
+        position += nameLength;
+        uint16_t type = ns_get16(position);
+        uint16_t questionClass = ns_get16(position + NS_INT16SZ);
+        position += 2 * NS_INT16SZ;
+        
+        asksForDirectResponse |= (questionClass & MULTICAST_DNS_CACHE_FLUSH) != 0;
+        questionClass &= ~MULTICAST_DNS_CACHE_FLUSH;
+        if (questionClass != ns_c_in && questionClass != ns_c_any) {
+            continue;
+        }
+        
+        bool isAnyType = type == ns_t_any;
+        if (strcasecmp(name, MULTICAST_DNS_SERVICE_ENUMERATION_NAME) == 0 && (type == ns_t_ptr || isAnyType)) {
+            answerRecords |= ServiceTypePointerRecord;
+        } else if (strcasecmp(name, serviceName.c_str()) == 0 && (type == ns_t_ptr || isAnyType)) {
+            // Browsing for the service is answered with everything needed to connect to it.
+            answerRecords |= InstancePointerRecord;
+            additionalRecords |= ServiceLocationRecord | TextRecord | AddressRecord;
+        } else if (strcasecmp(name, instanceName.c_str()) == 0) {
+            if (type == ns_t_srv || isAnyType) {
+                answerRecords |= ServiceLocationRecord;
+                additionalRecords |= AddressRecord;
+            }
+            
+            if (type == ns_t_txt || isAnyType) {
+                answerRecords |= TextRecord;
+            }
+        } else if (strcasecmp(name, hostName.c_str()) == 0 && (type == ns_t_a || isAnyType)) {
+            answerRecords |= AddressRecord;
+        }
+    }
+    
+    if (answerRecords == 0) {
+        return;
+    }
+    
+    additionalRecords &= ~answerRecords;
+    
+    bool isOneShot = ntohs(sender.sin_port) != MULTICAST_DNS_PORT;
+    std::string questions;
+    if (isOneShot) {
+        questions.assign((const char *)bytes + MULTICAST_DNS_HEADER_LENGTH, position - (bytes + MULTICAST_DNS_HEADER_LENGTH));
+    }
+    
+    auto response = makeResponse(isOneShot ? identifier : 0, answerRecords, additionalRecords, isOneShot, questions, isOneShot ? questionCount : 0, false);
+    if (response.empty()) {
+        return;
+    }
+    
+    if (isOneShot || asksForDirectResponse) {
+        send(response, sender);
+    } else {
+        struct sockaddr_in group = {};
+        group.sin_family = AF_INET;
+        group.sin_port = htons(port);
+        inet_pton(AF_INET, MULTICAST_DNS_GROUP, &group.sin_addr);
+        send(response, group);
+    }
+}
+
+void MulticastDNSAdvertiser::announce(bool isGoodbye) {
+    auto response = makeResponse(0, InstancePointerRecord | ServiceLocationRecord | TextRecord | AddressRecord, 0, false, std::string(), 0, isGoodbye);
+    
+    struct sockaddr_in group = {};
+    group.sin_family = AF_INET;
+    group.sin_port = htons(port);
+    inet_pton(AF_INET, MULTICAST_DNS_GROUP, &group.sin_addr);
+    send(response, group);
+}
+
+// MARK: - Responses
+
+std::string MulticastDNSAdvertiser::makeResponse(uint16_t identifier, uint32_t answerRecords, uint32_t additionalRecords, bool isOneShot, const std::string &questions, uint16_t questionCount, bool isGoodbye) const {
+    auto addresses = getInterfaceAddresses();
+    
+    // One-shot queriers do not understand the cache flush bit, and must not cache answers for long.
+    uint16_t uniqueClass = isOneShot ? ns_c_in : ns_c_in | MULTICAST_DNS_CACHE_FLUSH;
+    auto timeToLive = [isOneShot, isGoodbye](uint32_t timeToLive) -> uint32_t {
+        if (isGoodbye) {
+            return 0;
+        }
+        
+        return isOneShot ? std::min<uint32_t>(timeToLive, MULTICAST_DNS_ONE_SHOT_TIME_TO_LIVE) : timeToLive;
+    };
+    
+    std::string records;
+    auto appendRecords = [&](uint32_t kinds) {
+        uint16_t count = 0;
+        if (kinds & ServiceTypePointerRecord) {
+            std::string data;
+            appendLabels(data, serviceLabels);
+            appendRecord(records, labelsForName(MULTICAST_DNS_SERVICE_ENUMERATION_NAME), ns_t_ptr, ns_c_in, timeToLive(MULTICAST_DNS_SERVICE_TIME_TO_LIVE), data);
+            count++;
+        }
+        
+        if (kinds & InstancePointerRecord) {
+            std::string data;
+            appendLabels(data, instanceLabels);
+            appendRecord(records, serviceLabels, ns_t_ptr, ns_c_in, timeToLive(MULTICAST_DNS_SERVICE_TIME_TO_LIVE), data);
+            count++;
+        }
+        
+        if (kinds & ServiceLocationRecord) {
+            // Priority and weight, which only matter to services with several hosts.
+            std::string data;
+            appendUInt16(data, 0);
+            appendUInt16(data, 0);
+            appendUInt16(data, service.port);
+            appendLabels(data, hostLabels);
+            appendRecord(records, instanceLabels, ns_t_srv, uniqueClass, timeToLive(MULTICAST_DNS_HOST_TIME_TO_LIVE), data);
+            count++;
+        }
+        
+        if (kinds & TextRecord) {
+            std::string data;
+            for (auto &attribute : service.attributes) {
+                std::string string = attribute.first + "=" + attribute.second;
+                if (string.size() <= UINT8_MAX) {
+                    data.push_back((char)string.size());
+                    data.append(string);
+                }
+            }
+            
+            // A record without attributes still holds one empty string.
+            if (data.empty()) {
+                data.push_back(0);
+            }
+            
+            appendRecord(records, instanceLabels, ns_t_txt, uniqueClass, timeToLive(MULTICAST_DNS_SERVICE_TIME_TO_LIVE), data);
+            count++;
+        }
+        
+        if (kinds & AddressRecord) {
+            for (auto &address : addresses) {
+                std::string data((const char *)&address.s_addr, sizeof(address.s_addr));
+                appendRecord(records, hostLabels, ns_t_a, uniqueClass, timeToLive(MULTICAST_DNS_HOST_TIME_TO_LIVE), data);
+                count++;
+            }
+        }
+        
+        return count;
+    };
+    
+    uint16_t answerCount = appendRecords(answerRecords);
+    if (answerCount == 0) {
+        return std::string();
+    }
+    
+    uint16_t additionalCount = appendRecords(additionalRecords);
+    
+    // Responses are authoritative, and hold the questions, answers and additional records.
+    std::string response;
+    response.reserve(MULTICAST_DNS_HEADER_LENGTH + questions.size() + records.size());
+    appendUInt16(response, identifier);
+    appendUInt16(response, 0x8400);
+    appendUInt16(response, questionCount);
+    appendUInt16(response, answerCount);
+    appendUInt16(response, 0);
+    appendUInt16(response, additionalCount);
+    response.append(questions);
+    response.append(records);
+    return response;
+}
+
+void MulticastDNSAdvertiser::send(const std::string &response, const struct sockaddr_in &address) {
+    if (response.empty()) {
+        return;
+    }
+    
+    // Responses that cannot be sent (e.g., without a route for multicast) are dropped, as they would be by the network.
+    sendto(fd, response.data(), response.size(), 0, (const struct sockaddr *)&address, sizeof(address));
+}
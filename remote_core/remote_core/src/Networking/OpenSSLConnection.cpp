@@ -20,9 +20,12 @@
  */
 
 #include <iostream>
+#include <system_error>
 #include <util/memory/stl/Vector.hpp>
 
 #include "OpenSSLConnection.hpp"
+#include "StreamConnector.hpp"
+#include "TlsCredentialCache.hpp"
 #include "util/logging/LogMacros.hpp"
 
 #ifdef WIN32
@@ -67,18 +70,17 @@ namespace awsiotsdk {
             endpoint_ = endpoint;
             endpoint_port_ = endpoint_port;
             server_verification_flag_ = server_verification_flag;
-            int timeout_ms = static_cast<int>(tls_handshake_timeout.count());
-            tls_handshake_timeout_ = {timeout_ms / 1000, (timeout_ms % 1000) * 1000};
-            timeout_ms = static_cast<int>(tls_read_timeout.count());
-            tls_read_timeout_ = {timeout_ms / 1000, (timeout_ms % 1000) * 1000};
-            timeout_ms = static_cast<int>(tls_write_timeout.count());
-            tls_write_timeout_ = {timeout_ms / 1000, (timeout_ms % 1000) * 1000};
+            tls_handshake_timeout_ = tls_handshake_timeout;
+            tls_read_timeout_ = tls_read_timeout;
+            tls_write_timeout_ = tls_write_timeout;
 
             is_connected_ = false;
             certificates_read_flag_ = false;
             initializer = OpenSSLInitializer::getInstance();
             p_ssl_handle_ = nullptr;
             enable_alpn_ = false;
+            kernel_tls_enabled_ = false;
+            cipher_policy_ = RemoteCore::TlsCipherPolicy::getPreferred();
         }
 
         OpenSSLConnection::OpenSSLConnection(util::String endpoint,
@@ -126,20 +128,6 @@ namespace awsiotsdk {
             device_private_key_location_.clear();
         }
 
-        int OpenSSLConnection::WaitForSelect(int error_code) {
-            fd_set socketFds;
-            struct timeval timeout = {tls_write_timeout_.tv_sec, tls_write_timeout_.tv_usec};
-            FD_ZERO(&socketFds);
-            FD_SET(server_tcp_socket_fd_, &socketFds);
-            if (SSL_ERROR_WANT_READ == error_code) {
-                return select(server_tcp_socket_fd_ + 1, &socketFds, NULL, NULL, &timeout);
-            } else if (SSL_ERROR_WANT_WRITE == error_code) {
-                return select(server_tcp_socket_fd_ + 1, NULL, &socketFds, NULL, &timeout);
-            } else {
-                return 0;
-            }
-        }
-
         ResponseCode OpenSSLConnection::Initialize() {
 #ifdef WIN32
             // TODO : Check if it is possible to replace this with std::call_once
@@ -192,6 +180,14 @@ namespace awsiotsdk {
                 return ResponseCode::NETWORK_SSL_INIT_ERROR;
             }
 
+            // OpenSSL's defaults put AES-GCM and P-256 first, which are slow on boards without AES instructions.
+            if (!cipher_policy_.apply(p_ssl_context_, false)) {
+                AWS_LOG_ERROR(OPENSSL_WRAPPER_LOG_TAG, " SSL INIT Failed - Unable to set the cipher policy");
+                SSL_CTX_free(p_ssl_context_);
+                p_ssl_context_ = nullptr;
+                return ResponseCode::NETWORK_SSL_INIT_ERROR;
+            }
+
             return ResponseCode::SUCCESS;
         }
 
@@ -205,40 +201,25 @@ namespace awsiotsdk {
         }
 
         ResponseCode OpenSSLConnection::ConnectTCPSocket() {
-            const char *endpoint_char = endpoint_.c_str();
-            if (nullptr == endpoint_char) {
+            if (0 == endpoint_.length()) {
                 return ResponseCode::NETWORK_TCP_NO_ENDPOINT_SPECIFIED;
             }
 
-/*#ifndef WIN32
-            if (res_init() == -1) {
-                AWS_LOG_ERROR(OPENSSL_WRAPPER_LOG_TAG, "DNS initialize error");
+            // Resolves the endpoint through the shared, caching resolver, and races its IPv6 and IPv4 addresses.
+            int error = 0;
+            server_tcp_socket_fd_ = RemoteCore::StreamConnector::connect(endpoint_, endpoint_port_,
+                                                                         STREAM_CONNECTOR_DEFAULT_ATTEMPT_DELAY,
+                                                                         tls_handshake_timeout_, error);
+            if (-1 != server_tcp_socket_fd_) {
+                AWS_LOG_INFO(OPENSSL_WRAPPER_LOG_TAG, "connected to %s", endpoint_.c_str());
+                return ResponseCode::SUCCESS;
             }
-#endif*/
 
-            hostent *host = gethostbyname(endpoint_char);
-            if (nullptr == host) {
+            AWS_LOG_ERROR(OPENSSL_WRAPPER_LOG_TAG, "connect - %s", strerror(error));
+            if (EHOSTUNREACH == error) {
                 return ResponseCode::NETWORK_TCP_NO_ENDPOINT_SPECIFIED;
             }
 
-            sockaddr_in dest_addr;
-
-            dest_addr.sin_family = AF_INET;
-            dest_addr.sin_port = htons(endpoint_port_);
-            dest_addr.sin_addr.s_addr = *(uint32_t *) (host->h_addr);
-            memset(&(dest_addr.sin_zero), '\0', 8);
-
-            AWS_LOG_INFO(OPENSSL_WRAPPER_LOG_TAG,
-                         "resolved %s to %s",
-                         endpoint_.c_str(),
-                         inet_ntoa(dest_addr.sin_addr));
-
-            int connect_status = connect(server_tcp_socket_fd_, (sockaddr *) &dest_addr, sizeof(sockaddr));
-            if (-1 != connect_status) {
-                return ResponseCode::SUCCESS;
-            }
-
-            AWS_LOG_ERROR(OPENSSL_WRAPPER_LOG_TAG, "connect - %s", strerror(errno));
             return ResponseCode::NETWORK_TCP_CONNECT_ERROR;
         }
 
@@ -270,73 +251,47 @@ namespace awsiotsdk {
         }
 
         ResponseCode OpenSSLConnection::AttemptConnect() {
-            ResponseCode ret_val = ResponseCode::FAILURE;
-            int rc = 0;
-            int errorCode = 0;
-            int select_retCode = 0;
-
-            do {
-                ERR_clear_error();
-                rc = SSL_connect(p_ssl_handle_);
-
-                if (1 == rc) { //1 = SSL_CONNECTED, <= 0 is Error
-                    ret_val = ResponseCode::SUCCESS;
-                    break;
-                }
-
-                errorCode = SSL_get_error(p_ssl_handle_, rc);
-
-                if (SSL_ERROR_WANT_READ == errorCode) {
-                    select_retCode = WaitForSelect(errorCode);
-                    if (0 == select_retCode) { // 0 == SELECT_TIMEOUT
-                        AWS_LOG_ERROR(OPENSSL_WRAPPER_LOG_TAG, " SSL Connect time out while waiting for read");
-                        ret_val = ResponseCode::NETWORK_SSL_CONNECT_TIMEOUT_ERROR;
-                    } else if (-1 == select_retCode) { // -1 == SELECT_ERROR
-                        AWS_LOG_ERROR(OPENSSL_WRAPPER_LOG_TAG, " SSL Connect Select error for read %d", select_retCode);
-                        ret_val = ResponseCode::NETWORK_SSL_CONNECT_ERROR;
-                    }
-                } else if (SSL_ERROR_WANT_WRITE == errorCode) {
-                    select_retCode = WaitForSelect(errorCode);
-                    if (0 == select_retCode) { // 0 == SELECT_TIMEOUT
-                        AWS_LOG_ERROR(OPENSSL_WRAPPER_LOG_TAG, " SSL Connect time out while waiting for write");
-                        ret_val = ResponseCode::NETWORK_SSL_CONNECT_TIMEOUT_ERROR;
-                    } else if (-1 == select_retCode) { // -1 == SELECT_ERROR
-                        AWS_LOG_ERROR(OPENSSL_WRAPPER_LOG_TAG,
-                                      " SSL Connect Select error for write %d",
-                                      select_retCode);
-                        ret_val = ResponseCode::NETWORK_SSL_CONNECT_ERROR;
-                    }
-                } else {
-                    ret_val = ResponseCode::NETWORK_SSL_CONNECT_ERROR;
-                }
-
-            } while (ResponseCode::NETWORK_SSL_CONNECT_ERROR != ret_val &&
-                ResponseCode::NETWORK_SSL_CONNECT_TIMEOUT_ERROR != ret_val);
-
-            return ret_val;
+            auto deadline = RemoteCore::BufferedTlsStream::Clock::now() + tls_handshake_timeout_;
+            switch (stream_->connect(deadline)) {
+                case RemoteCore::TlsStreamStatus::Complete:
+                    return ResponseCode::SUCCESS;
+                case RemoteCore::TlsStreamStatus::TimedOut:
+                    AWS_LOG_ERROR(OPENSSL_WRAPPER_LOG_TAG, " SSL Connect time out");
+                    return ResponseCode::NETWORK_SSL_CONNECT_TIMEOUT_ERROR;
+                default:
+                    AWS_LOG_ERROR(OPENSSL_WRAPPER_LOG_TAG, " SSL Connect error");
+                    return ResponseCode::NETWORK_SSL_CONNECT_ERROR;
+            }
         }
 
         ResponseCode OpenSSLConnection::LoadCerts() {
             AWS_LOG_DEBUG(OPENSSL_WRAPPER_LOG_TAG, "Root CA : %s", root_ca_location_.c_str());
-            if (!SSL_CTX_load_verify_locations(p_ssl_context_, root_ca_location_.c_str(), NULL)) {
-                AWS_LOG_ERROR(OPENSSL_WRAPPER_LOG_TAG, " Root CA Loading error");
-                return ResponseCode::NETWORK_SSL_ROOT_CRT_PARSE_ERROR;
-            }
 
-            // TODO: streamline error codes for TLS
+            // The device credentials are only used together.
+            util::String device_cert_location;
+            util::String device_private_key_location;
             if (0 < device_cert_location_.length() && 0 < device_private_key_location_.length()) {
                 AWS_LOG_DEBUG(OPENSSL_WRAPPER_LOG_TAG, "Device crt : %s", device_cert_location_.c_str());
-                if (!SSL_CTX_use_certificate_chain_file(p_ssl_context_, device_cert_location_.c_str())) {
+                AWS_LOG_DEBUG(OPENSSL_WRAPPER_LOG_TAG, "Device privkey : %s", device_private_key_location_.c_str());
+                device_cert_location = device_cert_location_;
+                device_private_key_location = device_private_key_location_;
+            }
+
+            // Parsed credentials are cached, so files are only read again once they change.
+            // TODO: streamline error codes for TLS
+            switch (RemoteCore::TlsCredentialCache::configureContext(p_ssl_context_, root_ca_location_, device_cert_location,
+                                                                     device_private_key_location)) {
+                case RemoteCore::TlsCredentialStatus::Success:
+                    break;
+                case RemoteCore::TlsCredentialStatus::RootCertificateError:
+                    AWS_LOG_ERROR(OPENSSL_WRAPPER_LOG_TAG, " Root CA Loading error");
+                    return ResponseCode::NETWORK_SSL_ROOT_CRT_PARSE_ERROR;
+                case RemoteCore::TlsCredentialStatus::CertificateError:
                     AWS_LOG_ERROR(OPENSSL_WRAPPER_LOG_TAG, " Device Certificate Loading error");
                     return ResponseCode::NETWORK_SSL_DEVICE_CRT_PARSE_ERROR;
-                }
-                AWS_LOG_DEBUG(OPENSSL_WRAPPER_LOG_TAG, "Device privkey : %s", device_private_key_location_.c_str());
-                if (1 != SSL_CTX_use_PrivateKey_file(p_ssl_context_,
-                                                     device_private_key_location_.c_str(),
-                                                     SSL_FILETYPE_PEM)) {
+                case RemoteCore::TlsCredentialStatus::PrivateKeyError:
                     AWS_LOG_ERROR(OPENSSL_WRAPPER_LOG_TAG, " Device Private Key Loading error");
                     return ResponseCode::NETWORK_SSL_KEY_PARSE_ERROR;
-                }
             }
 
             certificates_read_flag_ = true;
@@ -349,19 +304,9 @@ namespace awsiotsdk {
             // Configure a non-zero callback if desired
             SSL_set_verify(p_ssl_handle_, SSL_VERIFY_PEER, nullptr);
 
-            server_tcp_socket_fd_ = (int)socket(AF_INET, SOCK_STREAM, 0);
-            if (-1 == server_tcp_socket_fd_) {
-                return ResponseCode::NETWORK_TCP_SETUP_ERROR;
-            }
-
             networkResponse = ConnectTCPSocket();
             if (ResponseCode::SUCCESS != networkResponse) {
                 AWS_LOG_ERROR(OPENSSL_WRAPPER_LOG_TAG, "TCP Connection error");
-#ifdef WIN32
-                closesocket(server_tcp_socket_fd_);
-#else
-                close(server_tcp_socket_fd_);
-#endif
                 return networkResponse;
             }
 
@@ -371,6 +316,15 @@ namespace awsiotsdk {
             if (ResponseCode::SUCCESS != networkResponse) {
                 AWS_LOG_ERROR(OPENSSL_WRAPPER_LOG_TAG, " Unable to set the socket to Non-Blocking");
             } else {
+                try {
+                    stream_.reset(new RemoteCore::BufferedTlsStream(p_ssl_handle_, server_tcp_socket_fd_));
+                } catch (const std::system_error &error) {
+                    AWS_LOG_ERROR(OPENSSL_WRAPPER_LOG_TAG, " Unable to create the TLS stream - %s", error.what());
+                    networkResponse = ResponseCode::NETWORK_SSL_INIT_ERROR;
+                }
+            }
+
+            if (ResponseCode::SUCCESS == networkResponse) {
                 networkResponse = AttemptConnect();
                 if (X509_V_OK != SSL_get_verify_result(p_ssl_handle_)) {
                     AWS_LOG_ERROR(OPENSSL_WRAPPER_LOG_TAG, " Server Certificate Verification failed.");
@@ -390,6 +344,7 @@ namespace awsiotsdk {
             }
 
             if (ResponseCode::SUCCESS != networkResponse) {
+                stream_.reset();
 #ifdef WIN32
                 closesocket(server_tcp_socket_fd_);
 #else
@@ -420,6 +375,12 @@ namespace awsiotsdk {
                 p_ssl_handle_ = SSL_new(p_ssl_context_);
             }
 
+            // Offer the session from the previous connection, which skips the certificate exchange if the server accepts it.
+            if (nullptr != session_cache_) {
+                RemoteCore::TlsSessionCache::enableForContext(p_ssl_context_);
+                session_cache_->attach(p_ssl_handle_, endpoint_);
+            }
+
             // Requires OpenSSL v1.0.2 and above
             if (server_verification_flag_) {
                 param = SSL_get0_param(p_ssl_handle_);
@@ -444,6 +405,13 @@ namespace awsiotsdk {
                 }
             }
 
+#ifdef SSL_OP_ENABLE_KTLS
+            // OpenSSL hands the negotiated keys to the kernel after the handshake, if the kernel supports the cipher.
+            if (kernel_tls_enabled_) {
+                SSL_set_options(p_ssl_handle_, SSL_OP_ENABLE_KTLS);
+            }
+#endif
+
             networkResponse = PerformSSLConnect();
             if (ResponseCode::SUCCESS != networkResponse) {
                 SSL_free(p_ssl_handle_);
@@ -451,6 +419,16 @@ namespace awsiotsdk {
             }
 
             if (ResponseCode::SUCCESS == networkResponse) {
+                if (nullptr != session_cache_) {
+                    session_cache_->recordHandshake(p_ssl_handle_);
+                }
+#ifdef SSL_OP_ENABLE_KTLS
+                if (kernel_tls_enabled_) {
+                    AWS_LOG_INFO(OPENSSL_WRAPPER_LOG_TAG, "kernel TLS - send %s, receive %s",
+                                 BIO_get_ktls_send(SSL_get_wbio(p_ssl_handle_)) ? "offloaded" : "in userspace",
+                                 BIO_get_ktls_recv(SSL_get_rbio(p_ssl_handle_)) ? "offloaded" : "in userspace");
+                }
+#endif
                 is_connected_ = true;
             }
 
@@ -458,95 +436,43 @@ namespace awsiotsdk {
         }
 
         ResponseCode OpenSSLConnection::WriteInternal(const util::String &buf, size_t &size_written_bytes_out) {
-            int error_code = 0;
-            int select_retCode = -1;
-            int cur_written_length = 0;
-            size_t total_written_length = 0;
-            ResponseCode rc = ResponseCode::SUCCESS;
-            size_t bytes_to_write = buf.length();
-
-            do {
-                ERR_clear_error();
-                if (nullptr == p_ssl_handle_) {
-                    return ResponseCode::NETWORK_SSL_WRITE_ERROR;
-                }
-                cur_written_length = SSL_write(p_ssl_handle_, buf.c_str(), (int)bytes_to_write);
-                error_code = SSL_get_error(p_ssl_handle_, cur_written_length);
-                if (0 < cur_written_length) {
-                    total_written_length += (size_t) cur_written_length;
-                } else if (SSL_ERROR_WANT_WRITE == error_code) {
-                    select_retCode = WaitForSelect(error_code);
-                    if (0 == select_retCode) { //0 == SELECT_TIMEOUT
-                        rc = ResponseCode::NETWORK_SSL_WRITE_TIMEOUT_ERROR;
-                    } else if (-1 == select_retCode) { //-1 == SELECT_TIMEOUT
-                        rc = ResponseCode::NETWORK_SSL_WRITE_ERROR;
-                    }
-                } else {
-                    rc = ResponseCode::NETWORK_SSL_WRITE_ERROR;
-                }
-
-            } while (is_connected_ && ResponseCode::NETWORK_SSL_WRITE_ERROR != rc &&
-                ResponseCode::NETWORK_SSL_WRITE_TIMEOUT_ERROR != rc &&
-                total_written_length < bytes_to_write);
-
-            if (ResponseCode::SUCCESS == rc) {
-                size_written_bytes_out = total_written_length;
+            if (nullptr == stream_) {
+                return ResponseCode::NETWORK_SSL_WRITE_ERROR;
             }
 
-            return rc;
+            auto deadline = RemoteCore::BufferedTlsStream::Clock::now() + tls_write_timeout_;
+            auto result = stream_->write(buf.c_str(), buf.length(), deadline);
+            switch (result.status) {
+                case RemoteCore::TlsStreamStatus::Complete:
+                    size_written_bytes_out = result.byteCount;
+                    return ResponseCode::SUCCESS;
+                case RemoteCore::TlsStreamStatus::TimedOut:
+                    return ResponseCode::NETWORK_SSL_WRITE_TIMEOUT_ERROR;
+                default:
+                    return ResponseCode::NETWORK_SSL_WRITE_ERROR;
+            }
         }
 
         ResponseCode OpenSSLConnection::ReadInternal(util::Vector<unsigned char> &buf, size_t buf_read_offset,
                                                      size_t size_bytes_to_read, size_t &size_read_bytes_out) {
-            int ssl_retcode;
-            int select_retCode;
-            size_t total_read_length = buf_read_offset;
-            size_t remaining_bytes_to_read = size_bytes_to_read;
-            int cur_read_len = 0;
-            ResponseCode errorStatus = ResponseCode::SUCCESS;
-
-            do {
-                ERR_clear_error();
-                if (nullptr == p_ssl_handle_) {
-                    return ResponseCode::NETWORK_SSL_READ_ERROR;
-                }
-                cur_read_len = SSL_read(p_ssl_handle_, &buf[total_read_length], (int) remaining_bytes_to_read);
-                if (0 < cur_read_len) {
-                    total_read_length += (size_t) cur_read_len;
-                    remaining_bytes_to_read -= cur_read_len;
-                } else {
-                    ssl_retcode = SSL_get_error(p_ssl_handle_, cur_read_len);
-                    switch (ssl_retcode) {
-                        case SSL_ERROR_WANT_READ:
-                            select_retCode = WaitForSelect(SSL_ERROR_WANT_READ);
-                            if (0 < select_retCode) {
-                                continue;
-                            } else if (0 == select_retCode) { //0 == SELECT_TIMEOUT
-                                errorStatus = ResponseCode::NETWORK_SSL_NOTHING_TO_READ;
-                            } else { // SELECT_ERROR
-                                errorStatus = ResponseCode::NETWORK_SSL_READ_ERROR;
-                            }
-                            break;
-                        case SSL_ERROR_ZERO_RETURN:
-                            errorStatus = ResponseCode::NETWORK_SSL_CONNECTION_CLOSED_ERROR;
-                            break;
-                        default:
-                            errorStatus = ResponseCode::NETWORK_SSL_READ_ERROR;
-                            break;
-                    }
-                }
-                if (ResponseCode::NETWORK_SSL_NOTHING_TO_READ == errorStatus ||
-                    ResponseCode::NETWORK_SSL_READ_ERROR == errorStatus ||
-                    ResponseCode::NETWORK_SSL_CONNECTION_CLOSED_ERROR == errorStatus) {
-                    break;
-                }
-            } while (is_connected_ && total_read_length < size_bytes_to_read);
-
-            if (ResponseCode::SUCCESS == errorStatus) {
-                size_read_bytes_out = total_read_length;
+            if (nullptr == stream_) {
+                return ResponseCode::NETWORK_SSL_READ_ERROR;
             }
 
-            return errorStatus;
+            auto deadline = RemoteCore::BufferedTlsStream::Clock::now() + tls_read_timeout_;
+            auto result = stream_->read(reinterpret_cast<char *>(&buf[buf_read_offset]), size_bytes_to_read, deadline);
+            switch (result.status) {
+                case RemoteCore::TlsStreamStatus::Complete:
+                    size_read_bytes_out = buf_read_offset + result.byteCount;
+                    return ResponseCode::SUCCESS;
+                case RemoteCore::TlsStreamStatus::TimedOut:
+                    return 0 == result.byteCount ? ResponseCode::NETWORK_SSL_NOTHING_TO_READ
+                                                 : ResponseCode::NETWORK_SSL_READ_ERROR;
+                case RemoteCore::TlsStreamStatus::Closed:
+                    return ResponseCode::NETWORK_SSL_CONNECTION_CLOSED_ERROR;
+                default:
+                    return ResponseCode::NETWORK_SSL_READ_ERROR;
+            }
         }
 
         ResponseCode OpenSSLConnection::DisconnectInternal() {
@@ -555,22 +481,14 @@ namespace awsiotsdk {
             }
             is_connected_ = false;
 
-            std::chrono::milliseconds timeout = std::chrono::milliseconds(tls_read_timeout_.tv_sec * 1000 +
-                tls_read_timeout_.tv_usec / 1000);
-
             std::unique_lock<std::mutex> shutdown_lock(clean_shutdown_action_lock_);
 
             // TODO: add config for disconnect timeout
-            // wait for tls_read_timeout and then exit the shutdown loop if it is not successful
-            this->shutdown_timeout_condition_.wait_for(shutdown_lock, std::chrono::milliseconds(timeout), [this] {
-                int rc = SSL_shutdown(p_ssl_handle_);
-                if (1 == rc) {
-                    return true;
-                }
-                int errorCode = SSL_get_error(p_ssl_handle_, rc);
-                WaitForSelect(errorCode);
-                return false;
-            });
+            // wait for tls_read_timeout and then give up on a clean shutdown
+            if (nullptr != stream_) {
+                stream_->shutdown(RemoteCore::BufferedTlsStream::Clock::now() + tls_read_timeout_);
+                stream_.reset();
+            }
 
             SSL_free(p_ssl_handle_);
             p_ssl_handle_ = nullptr;
@@ -579,7 +497,7 @@ namespace awsiotsdk {
             ERR_remove_thread_state(NULL);
 #endif
 
-            certificates_read_flag_ = false;
+            // The context keeps its certificates, so they are not loaded again on reconnect.
 #ifdef WIN32
             closesocket(server_tcp_socket_fd_);
 #else
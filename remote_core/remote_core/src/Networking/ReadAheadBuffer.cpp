@@ -0,0 +1,114 @@
+//
+//  ReadAheadBuffer.cpp
+//  remote_core
+//
+//  Created by David Moore on 10/19/26.
+//  Copyright © 2026 David Moore. All rights reserved.
+//
+
+#include "ReadAheadBuffer.hpp"
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+using namespace RemoteCore;
+
+// MARK: - Read Ahead Buffer Pool
+
+ReadAheadBufferPool::ReadAheadBufferPool(size_t maximumBlockCount) : maximumBlockCount(maximumBlockCount) {
+}
+
+ReadAheadBufferPool *ReadAheadBufferPool::sharedPool(void) {
+    static ReadAheadBufferPool pool;
+    
+    return &pool;
+}
+
+std::unique_ptr<char[]> ReadAheadBufferPool::takeBlock(void) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (!blocks.empty()) {
+            auto block = std::move(blocks.back());
+            blocks.pop_back();
+            return block;
+        }
+    }
+    
+    return std::unique_ptr<char[]>(new char[READ_AHEAD_BUFFER_CAPACITY]);
+}
+
+void ReadAheadBufferPool::returnBlock(std::unique_ptr<char[]> block) {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (block != nullptr && blocks.size() < maximumBlockCount) {
+        blocks.push_back(std::move(block));
+    }
+}
+
+size_t ReadAheadBufferPool::getFreeBlockCount(void) {
+    std::lock_guard<std::mutex> lock(mutex);
+    return blocks.size();
+}
+
+// MARK: - Read Ahead Buffer
+
+ReadAheadBuffer::ReadAheadBuffer(ReadAheadBufferPool *pool) : pool(pool), start(0), byteCount(0) {
+}
+
+ReadAheadBuffer::~ReadAheadBuffer() {
+    release();
+}
+
+size_t ReadAheadBuffer::read(char *bytes, size_t length) {
+    size_t totalLength = std::min(length, byteCount);
+    size_t copiedLength = 0;
+    while (copiedLength < totalLength) {
+        // At most two copies, if the bytes wrap around the end of the block.
+        size_t spanLength = std::min(totalLength - copiedLength, READ_AHEAD_BUFFER_CAPACITY - start);
+        memcpy(bytes + copiedLength, block.get() + start, spanLength);
+        copiedLength += spanLength;
+        start = (start + spanLength) % READ_AHEAD_BUFFER_CAPACITY;
+    }
+    
+    byteCount -= totalLength;
+    
+    // Starting over once empty leaves the whole block free for the next read.
+    if (byteCount == 0) {
+        start = 0;
+    }
+    
+    return totalLength;
+}
+
+char *ReadAheadBuffer::getFreeSpace(size_t &length) {
+    if (block == nullptr) {
+        block = pool->takeBlock();
+    }
+    
+    size_t end = (start + byteCount) % READ_AHEAD_BUFFER_CAPACITY;
+    if (byteCount == READ_AHEAD_BUFFER_CAPACITY) {
+        length = 0;
+    } else if (end >= start) {
+        length = READ_AHEAD_BUFFER_CAPACITY - end;
+    } else {
+        length = start - end;
+    }
+    
+    return block.get() + end;
+}
+
+void ReadAheadBuffer::commit(size_t length) {
+    if (byteCount + length > READ_AHEAD_BUFFER_CAPACITY) {
+        throw std::logic_error("Expected no more bytes than the free space.");
+    }
+    
+    byteCount += length;
+}
+
+void ReadAheadBuffer::release(void) {
+    if (block != nullptr) {
+        pool->returnBlock(std::move(block));
+    }
+    
+    start = 0;
+    byteCount = 0;
+}
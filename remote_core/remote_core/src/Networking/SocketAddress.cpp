@@ -0,0 +1,61 @@
+//
+//  SocketAddress.cpp
+//  remote_core
+//
+//  Created by David Moore on 10/19/26.
+//  Copyright © 2026 David Moore. All rights reserved.
+//
+
+#include "SocketAddress.hpp"
+#include <cstring>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+
+using namespace RemoteCore;
+
+uint16_t SocketAddress::getPort(void) const {
+    if (getFamily() == AF_INET6) {
+        return ntohs(((const struct sockaddr_in6 *)&storage)->sin6_port);
+    }
+    
+    return ntohs(((const struct sockaddr_in *)&storage)->sin_port);
+}
+
+void SocketAddress::setPort(uint16_t port) {
+    if (getFamily() == AF_INET6) {
+        ((struct sockaddr_in6 *)&storage)->sin6_port = htons(port);
+    } else {
+        ((struct sockaddr_in *)&storage)->sin_port = htons(port);
+    }
+}
+
+std::string SocketAddress::getDescription(void) const {
+    char description[INET6_ADDRSTRLEN] = {};
+    if (getFamily() == AF_INET6) {
+        inet_ntop(AF_INET6, &((const struct sockaddr_in6 *)&storage)->sin6_addr, description, sizeof(description));
+    } else {
+        inet_ntop(AF_INET, &((const struct sockaddr_in *)&storage)->sin_addr, description, sizeof(description));
+    }
+    
+    return description;
+}
+
+bool SocketAddress::parse(const std::string &string, uint16_t port, SocketAddress &address) {
+    // Numeric lookups never block, and also handle IPv6 scopes (e.g., 'fe80::1%eth0').
+    struct addrinfo hints = {};
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    hints.ai_flags = AI_NUMERICHOST | AI_NUMERICSERV;
+    
+    struct addrinfo *result = nullptr;
+    if (string.empty() || getaddrinfo(string.c_str(), std::to_string(port).c_str(), &hints, &result) != 0) {
+        return false;
+    }
+    
+    address = SocketAddress();
+    memcpy(&address.storage, result->ai_addr, result->ai_addrlen);
+    address.length = result->ai_addrlen;
+    freeaddrinfo(result);
+    return true;
+}
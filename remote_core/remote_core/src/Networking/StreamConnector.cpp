@@ -0,0 +1,207 @@
+//
+//  StreamConnector.cpp
+//  remote_core
+//
+//  Created by David Moore on 10/19/26.
+//  Copyright © 2026 David Moore. All rights reserved.
+//
+
+#include "StreamConnector.hpp"
+#include <algorithm>
+#include <cerrno>
+#include <stdexcept>
+#include <system_error>
+#include <unistd.h>
+#include "StreamTransport.hpp"
+
+using namespace RemoteCore;
+
+StreamConnector::StreamConnector(EventLoop &loop, std::chrono::milliseconds attemptDelay, HostResolver *resolver) : loop(loop), resolver(resolver), attemptDelay(attemptDelay), nextAddressIndex(0), lastError(0), resolveRequest(0), attemptTimer(0), timeoutTimer(0), generation(std::make_shared<uint64_t>(0)) {
+}
+
+StreamConnector::~StreamConnector() {
+    reset();
+}
+
+void StreamConnector::connect(const std::string &host, uint16_t port, std::chrono::milliseconds timeout, CompletionHandler completionHandler) {
+    connect(std::vector<SocketAddress>(), timeout, completionHandler);
+    this->host = host;
+    
+    // Addresses are delivered on one of the resolver's threads, or right away if they are cached.
+    auto &loop = this->loop;
+    std::weak_ptr<uint64_t> weakGeneration = generation;
+    uint64_t currentGeneration = *generation;
+    resolveRequest = resolver->resolve(host, port, [this, &loop, weakGeneration, currentGeneration](const std::vector<SocketAddress> &addresses, int error) {
+        loop.execute([this, weakGeneration, currentGeneration, addresses, error]() {
+            auto generation = weakGeneration.lock();
+            if (generation == nullptr || *generation != currentGeneration) {
+                return;
+            }
+            
+            resolveRequest = 0;
+            if (error != 0) {
+                complete(-1, error);
+                return;
+            }
+            
+            this->addresses = addresses;
+            startAttempts();
+        });
+    });
+}
+
+void StreamConnector::connect(const std::vector<SocketAddress> &addresses, std::chrono::milliseconds timeout, CompletionHandler completionHandler) {
+    if (completionHandler == nullptr) {
+        throw std::logic_error("Expected a completion handler.");
+    }
+    
+    reset();
+    this->addresses = addresses;
+    this->completionHandler = completionHandler;
+    
+    timeoutTimer = loop.addTimer(timeout, false, [this]() {
+        timeoutTimer = 0;
+        complete(-1, ETIMEDOUT);
+    });
+    
+    if (!addresses.empty()) {
+        startAttempts();
+    }
+}
+
+void StreamConnector::cancel(void) {
+    reset();
+}
+
+void StreamConnector::reset(void) {
+    // Handlers that are already posted to the loop are ignored from now on.
+    (*generation)++;
+    
+    if (resolveRequest != 0) {
+        resolver->cancel(resolveRequest);
+        resolveRequest = 0;
+    }
+    
+    for (auto &attempt : attempts) {
+        loop.removeDescriptor(attempt.fd);
+        close(attempt.fd);
+    }
+    
+    loop.removeTimer(attemptTimer);
+    loop.removeTimer(timeoutTimer);
+    attemptTimer = 0;
+    timeoutTimer = 0;
+    
+    host.clear();
+    addresses.clear();
+    attempts.clear();
+    nextAddressIndex = 0;
+    lastError = 0;
+    completionHandler = nullptr;
+}
+
+void StreamConnector::startAttempts(void) {
+    if (addresses.empty()) {
+        complete(-1, EHOSTUNREACH);
+        return;
+    }
+    
+    startNextAttempt();
+}
+
+void StreamConnector::startNextAttempt(void) {
+    loop.removeTimer(attemptTimer);
+    attemptTimer = 0;
+    
+    // Addresses that fail right away (e.g., an IPv6 address without an IPv6 route) are skipped without waiting.
+    while (nextAddressIndex < addresses.size()) {
+        auto &address = addresses[nextAddressIndex++];
+        int fd;
+        try {
+            fd = StreamTransport::startConnecting(address);
+        } catch (const std::system_error &error) {
+            lastError = error.code().value();
+            continue;
+        }
+        
+        attempts.push_back({fd, address});
+        loop.addDescriptor(fd, EventLoop::Writable, [this, fd](uint32_t events) {
+            handleAttemptEvents(fd);
+        });
+        
+        if (nextAddressIndex < addresses.size()) {
+            attemptTimer = loop.addTimer(attemptDelay, false, [this]() {
+                attemptTimer = 0;
+                startNextAttempt();
+            });
+        }
+        
+        return;
+    }
+    
+    if (attempts.empty()) {
+        complete(-1, lastError != 0 ? lastError : EHOSTUNREACH);
+    }
+}
+
+void StreamConnector::handleAttemptEvents(int fd) {
+    int error = StreamTransport::finishConnecting(fd);
+    if (error == EINPROGRESS) {
+        return;
+    }
+    
+    auto position = std::find_if(attempts.begin(), attempts.end(), [fd](const Attempt &attempt) {
+        return attempt.fd == fd;
+    });
+    
+    if (position == attempts.end()) {
+        return;
+    }
+    
+    loop.removeDescriptor(fd);
+    attempts.erase(position);
+    
+    if (error == 0) {
+        complete(fd, 0);
+        return;
+    }
+    
+    // A failed attempt starts the next one right away, rather than after the attempt delay.
+    close(fd);
+    lastError = error;
+    startNextAttempt();
+}
+
+void StreamConnector::complete(int fd, int error) {
+    // Every address failed, so they may no longer be current.
+    if (fd < 0 && !host.empty()) {
+        resolver->removeCachedAddresses(host);
+    }
+    
+    auto completionHandler = std::move(this->completionHandler);
+    reset();
+    
+    if (completionHandler) {
+        completionHandler(fd, error);
+    } else if (fd >= 0) {
+        close(fd);
+    }
+}
+
+int StreamConnector::connect(const std::string &host, uint16_t port, std::chrono::milliseconds attemptDelay, std::chrono::milliseconds timeout, int &error) {
+    EventLoop loop;
+    StreamConnector connector(loop, attemptDelay);
+    int connectedFD = -1;
+    error = ETIMEDOUT;
+    
+    loop.execute([&]() {
+        connector.connect(host, port, timeout, [&](int fd, int connectError) {
+            connectedFD = fd;
+            error = connectError;
+            loop.stop();
+        });
+    });
+    
+    loop.run();
+    return connectedFD;
+}
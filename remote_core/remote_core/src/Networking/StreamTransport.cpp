@@ -0,0 +1,526 @@
+//
+//  StreamTransport.cpp
+//  remote_core
+//
+//  Created by David Moore on 10/19/26.
+//  Copyright © 2026 David Moore. All rights reserved.
+//
+
+#include "StreamTransport.hpp"
+#include "TlsCredentialCache.hpp"
+#include "FlightRecorder.hpp"
+#include <algorithm>
+#include <cerrno>
+#include <climits>
+#include <cstring>
+#include <stdexcept>
+#include <system_error>
+#include <fcntl.h>
+#include <netdb.h>
+#include <signal.h>
+#include <unistd.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <openssl/err.h>
+#include <openssl/ssl.h>
+#include <openssl/x509v3.h>
+
+#ifdef __linux__
+#include <sys/sendfile.h>
+#endif
+
+using namespace RemoteCore;
+
+#ifndef MSG_NOSIGNAL
+#define MSG_NOSIGNAL 0
+#endif
+
+/// Bytes of a file read for each write when it cannot be copied within the kernel, which is one TLS record.
+#define STREAM_TRANSPORT_FILE_CHUNK_LENGTH (16 * 1024)
+
+/// Vectors of a chain passed to each gathered write.
+#define STREAM_TRANSPORT_MAXIMUM_VECTOR_COUNT 64
+
+/// Bytes gathered into each TLS write, which is one record.
+#define TLS_TRANSPORT_STAGING_LENGTH (16 * 1024)
+
+/// Vectors at least this long are written by TLS directly, since the cost of a record of their own is small next to copying them.
+#define TLS_TRANSPORT_DIRECT_WRITE_LENGTH (4 * 1024)
+
+static void throwSystemError(const char *operation, int error = errno) {
+    throw std::system_error(error, std::generic_category(), operation);
+}
+
+static void configureSocket(int fd) {
+    int flags = fcntl(fd, F_GETFL, 0);
+    if (flags < 0 || fcntl(fd, F_SETFL, flags | O_NONBLOCK) < 0) {
+        throwSystemError("fcntl");
+    }
+    
+    fcntl(fd, F_SETFD, FD_CLOEXEC);
+    
+    // Small packets (e.g., acknowledgements) must not wait for more data to be coalesced with.
+    int isEnabled = 1;
+    setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &isEnabled, sizeof(isEnabled));
+
+#ifdef SO_NOSIGPIPE
+    setsockopt(fd, SOL_SOCKET, SO_NOSIGPIPE, &isEnabled, sizeof(isEnabled));
+#endif
+}
+
+// MARK: - Sockets
+
+int StreamTransport::startConnecting(const SocketAddress &address) {
+    int fd = socket(address.getFamily(), SOCK_STREAM, 0);
+    if (fd < 0) {
+        throwSystemError("socket");
+    }
+    
+    configureSocket(fd);
+    if (connect(fd, (const struct sockaddr *)&address.storage, address.length) != 0 && errno != EINPROGRESS) {
+        int error = errno;
+        close(fd);
+        throwSystemError("connect", error);
+    }
+    
+    return fd;
+}
+
+int StreamTransport::finishConnecting(int fd) {
+    int error = 0;
+    socklen_t length = sizeof(error);
+    if (getsockopt(fd, SOL_SOCKET, SO_ERROR, &error, &length) != 0) {
+        return errno;
+    }
+    
+    // A socket may be reported as writable before it has connected (e.g., after its descriptor was reused), which the peer's address tells apart.
+    struct sockaddr_storage address;
+    socklen_t addressLength = sizeof(address);
+    if (error == 0 && getpeername(fd, (struct sockaddr *)&address, &addressLength) != 0) {
+        return errno == ENOTCONN ? EINPROGRESS : errno;
+    }
+    
+    return error;
+}
+
+static int listenOnAddress(uint32_t hostAddress, uint16_t port) {
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+    if (fd < 0) {
+        throwSystemError("socket");
+    }
+    
+    int isEnabled = 1;
+    setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &isEnabled, sizeof(isEnabled));
+    
+    struct sockaddr_in address = {};
+    address.sin_family = AF_INET;
+    address.sin_port = htons(port);
+    address.sin_addr.s_addr = htonl(hostAddress);
+    
+    if (bind(fd, (struct sockaddr *)&address, sizeof(address)) != 0 || listen(fd, SOMAXCONN) != 0) {
+        int error = errno;
+        close(fd);
+        throwSystemError("bind", error);
+    }
+    
+    configureSocket(fd);
+    return fd;
+}
+
+int StreamTransport::listenOnLoopback(uint16_t port) {
+    return listenOnAddress(INADDR_LOOPBACK, port);
+}
+
+int StreamTransport::listenOnAnyInterface(uint16_t port) {
+    return listenOnAddress(INADDR_ANY, port);
+}
+
+uint16_t StreamTransport::getLocalPort(int fd) {
+    struct sockaddr_storage address = {};
+    socklen_t length = sizeof(address);
+    if (getsockname(fd, (struct sockaddr *)&address, &length) != 0) {
+        throwSystemError("getsockname");
+    }
+    
+    if (address.ss_family == AF_INET6) {
+        return ntohs(((struct sockaddr_in6 *)&address)->sin6_port);
+    }
+    
+    return ntohs(((struct sockaddr_in *)&address)->sin_port);
+}
+
+// MARK: - Vectors
+
+TransportResult StreamTransport::writeVector(const struct iovec *vectors, size_t count) {
+    if (count == 0) {
+        return TransportResult(TransportStatus::Complete);
+    }
+    
+    return write((const char *)vectors[0].iov_base, vectors[0].iov_len);
+}
+
+TransportResult StreamTransport::writeChain(BufferChain &chain) {
+    struct iovec vectors[STREAM_TRANSPORT_MAXIMUM_VECTOR_COUNT];
+    size_t count = chain.getIOVectors(vectors, STREAM_TRANSPORT_MAXIMUM_VECTOR_COUNT);
+    
+    auto result = writeVector(vectors, count);
+    if (result.status == TransportStatus::Complete) {
+        chain.consume(result.byteCount);
+    }
+    
+    return result;
+}
+
+// MARK: - Files
+
+TransportResult StreamTransport::sendFile(int fileFD, off_t offset, size_t length) {
+    char chunk[STREAM_TRANSPORT_FILE_CHUNK_LENGTH];
+    ssize_t count;
+    do {
+        count = pread(fileFD, chunk, std::min(length, sizeof(chunk)), offset);
+    } while (count < 0 && errno == EINTR);
+    
+    if (count <= 0) {
+        // A file that ends before 'length' bytes could never be sent in full.
+        return TransportResult(count == 0 && length == 0 ? TransportStatus::Complete : TransportStatus::Failed);
+    }
+    
+    return write(chunk, (size_t)count);
+}
+
+// MARK: - TCP Transport
+
+TcpTransport::TcpTransport(int fd) : fd(fd) {
+    configureSocket(fd);
+}
+
+TcpTransport::~TcpTransport() {
+    close(fd);
+}
+
+TransportResult TcpTransport::handshake(void) {
+    return TransportResult(TransportStatus::Complete);
+}
+
+TransportResult TcpTransport::read(char *buffer, size_t length) {
+    while (true) {
+        ssize_t count = recv(fd, buffer, length, 0);
+        if (count > 0) {
+            return TransportResult(TransportStatus::Complete, (size_t)count);
+        } else if (count == 0) {
+            return TransportResult(TransportStatus::Closed);
+        } else if (errno == EAGAIN || errno == EWOULDBLOCK) {
+            return TransportResult(TransportStatus::WantRead);
+        } else if (errno != EINTR) {
+            return TransportResult(errno == ECONNRESET ? TransportStatus::Closed : TransportStatus::Failed);
+        }
+    }
+}
+
+TransportResult TcpTransport::write(const char *bytes, size_t length) {
+    while (true) {
+        ssize_t count = send(fd, bytes, length, MSG_NOSIGNAL);
+        if (count >= 0) {
+            return TransportResult(TransportStatus::Complete, (size_t)count);
+        } else if (errno == EAGAIN || errno == EWOULDBLOCK) {
+            return TransportResult(TransportStatus::WantWrite);
+        } else if (errno != EINTR) {
+            return TransportResult(errno == EPIPE || errno == ECONNRESET ? TransportStatus::Closed : TransportStatus::Failed);
+        }
+    }
+}
+
+TransportResult TcpTransport::writeVector(const struct iovec *vectors, size_t count) {
+    struct msghdr message = {};
+    message.msg_iov = (struct iovec *)vectors;
+    message.msg_iovlen = std::min<size_t>(count, IOV_MAX);
+    
+    while (true) {
+        ssize_t sentCount = sendmsg(fd, &message, MSG_NOSIGNAL);
+        if (sentCount >= 0) {
+            return TransportResult(TransportStatus::Complete, (size_t)sentCount);
+        } else if (errno == EAGAIN || errno == EWOULDBLOCK) {
+            return TransportResult(TransportStatus::WantWrite);
+        } else if (errno != EINTR) {
+            return TransportResult(errno == EPIPE || errno == ECONNRESET ? TransportStatus::Closed : TransportStatus::Failed);
+        }
+    }
+}
+
+TransportResult TcpTransport::sendFile(int fileFD, off_t offset, size_t length) {
+#ifdef __linux__
+    // Unlike 'send', 'sendfile' cannot be asked not to raise the signal.
+    signal(SIGPIPE, SIG_IGN);
+    
+    while (true) {
+        ssize_t count = ::sendfile(fd, fileFD, &offset, length);
+        if (count > 0 || length == 0) {
+            return TransportResult(TransportStatus::Complete, (size_t)std::max<ssize_t>(count, 0));
+        } else if (count == 0) {
+            return TransportResult(TransportStatus::Failed);
+        } else if (errno == EAGAIN || errno == EWOULDBLOCK) {
+            return TransportResult(TransportStatus::WantWrite);
+        } else if (errno == EINVAL || errno == ENOSYS) {
+            // The file cannot be mapped (e.g., it is a pipe), so it is read instead.
+            return StreamTransport::sendFile(fileFD, offset, length);
+        } else if (errno != EINTR) {
+            return TransportResult(errno == EPIPE || errno == ECONNRESET ? TransportStatus::Closed : TransportStatus::Failed);
+        }
+    }
+#else
+    return StreamTransport::sendFile(fileFD, offset, length);
+#endif
+}
+
+// MARK: - TLS Transport
+
+static std::string lastTlsError(void) {
+    unsigned long error = ERR_get_error();
+    if (error == 0) {
+        return "unknown error";
+    }
+    
+    char description[256];
+    ERR_error_string_n(error, description, sizeof(description));
+    return description;
+}
+
+std::shared_ptr<SSL_CTX> TlsTransport::makeContext(const TlsConfiguration &configuration) {
+#ifndef WIN32
+    // OpenSSL writes to the socket directly, so a closed connection must not terminate the process.
+    signal(SIGPIPE, SIG_IGN);
+#endif
+
+    SSL_CTX *context = SSL_CTX_new(configuration.isServer ? TLS_server_method() : TLS_client_method());
+    if (context == nullptr) {
+        throw std::runtime_error("Expected an SSL context to be created: " + lastTlsError());
+    }
+    
+    std::shared_ptr<SSL_CTX> sharedContext(context, SSL_CTX_free);
+    SSL_CTX_set_min_proto_version(context, TLS1_2_VERSION);
+    
+    switch (TlsCredentialCache::configureContext(context, configuration.rootCAPath, configuration.certificatePath, configuration.privateKeyPath)) {
+        case TlsCredentialStatus::Success:
+            break;
+        case TlsCredentialStatus::RootCertificateError:
+            throw std::runtime_error("Expected '" + configuration.rootCAPath + "' to contain a root certificate: " + lastTlsError());
+        case TlsCredentialStatus::CertificateError:
+            throw std::runtime_error("Expected '" + configuration.certificatePath + "' to contain a certificate: " + lastTlsError());
+        case TlsCredentialStatus::PrivateKeyError:
+            throw std::runtime_error("Expected '" + configuration.privateKeyPath + "' to contain a private key: " + lastTlsError());
+    }
+    
+    if (!configuration.isServer && configuration.sessionCache != nullptr) {
+        TlsSessionCache::enableForContext(context);
+    }
+    
+    if (!configuration.cipherPolicy.apply(context, configuration.isServer)) {
+        throw std::runtime_error("Expected the cipher policy to name supported ciphers and groups: " + lastTlsError());
+    }
+    
+    // Servers that verify their peers refuse clients without a certificate, rather than only verifying those that send one.
+    int verifyMode = SSL_VERIFY_NONE;
+    if (configuration.verifiesPeer) {
+        verifyMode = configuration.isServer ? SSL_VERIFY_PEER | SSL_VERIFY_FAIL_IF_NO_PEER_CERT : SSL_VERIFY_PEER;
+    }
+    
+    SSL_CTX_set_verify(context, verifyMode, nullptr);
+    
+#ifdef SSL_OP_ENABLE_KTLS
+    // OpenSSL installs the keys with 'TLS_TX' and 'TLS_RX' once they are negotiated, and keeps encrypting records itself if the kernel lacks the cipher or the 'tls' module.
+    if (configuration.usesKernelTls) {
+        SSL_CTX_set_options(context, SSL_OP_ENABLE_KTLS);
+    }
+#endif
+    
+    // The outbound buffer may be appended to, and so reallocated, while a write is waiting to be retried.
+    SSL_CTX_set_mode(context, SSL_MODE_ENABLE_PARTIAL_WRITE | SSL_MODE_ACCEPT_MOVING_WRITE_BUFFER);
+    
+    return sharedContext;
+}
+
+TlsTransport::TlsTransport(int fd, std::shared_ptr<SSL_CTX> context, const TlsConfiguration &configuration) : fd(fd), context(context), ssl(nullptr) {
+    configureSocket(fd);
+    
+    ssl = SSL_new(context.get());
+    if (ssl == nullptr || SSL_set_fd(ssl, fd) != 1) {
+        SSL_free(ssl);
+        close(fd);
+        throw std::runtime_error("Expected an SSL handle to be created: " + lastTlsError());
+    }
+    
+    if (configuration.isServer) {
+        SSL_set_accept_state(ssl);
+        return;
+    }
+    
+    SSL_set_connect_state(ssl);
+    if (configuration.sessionCache != nullptr) {
+        sessionCache = configuration.sessionCache;
+        sessionCache->attach(ssl, configuration.serverName);
+    }
+    
+    if (!configuration.serverName.empty()) {
+        struct in6_addr address;
+        bool isAddress = inet_pton(AF_INET, configuration.serverName.c_str(), &address) == 1 || inet_pton(AF_INET6, configuration.serverName.c_str(), &address) == 1;
+        
+        X509_VERIFY_PARAM *parameters = SSL_get0_param(ssl);
+        X509_VERIFY_PARAM_set_hostflags(parameters, X509_CHECK_FLAG_NO_PARTIAL_WILDCARDS);
+        if (isAddress) {
+            X509_VERIFY_PARAM_set1_ip_asc(parameters, configuration.serverName.c_str());
+        } else {
+            X509_VERIFY_PARAM_set1_host(parameters, configuration.serverName.c_str(), 0);
+            SSL_set_tlsext_host_name(ssl, configuration.serverName.c_str());
+        }
+    }
+    
+    if (!configuration.applicationProtocol.empty()) {
+        std::string protocols(1, (char)configuration.applicationProtocol.size());
+        protocols.append(configuration.applicationProtocol);
+        SSL_set_alpn_protos(ssl, (const unsigned char *)protocols.data(), (unsigned int)protocols.size());
+    }
+}
+
+TlsTransport::~TlsTransport() {
+    // Sending 'close_notify' is best effort, since the socket is closed regardless.
+    if (SSL_is_init_finished(ssl)) {
+        SSL_shutdown(ssl);
+    }
+    
+    SSL_free(ssl);
+    close(fd);
+}
+
+TransportResult TlsTransport::resultForError(int result) {
+    int error = SSL_get_error(ssl, result);
+    switch (error) {
+        case SSL_ERROR_WANT_READ:
+            return TransportResult(TransportStatus::WantRead);
+        case SSL_ERROR_WANT_WRITE:
+            return TransportResult(TransportStatus::WantWrite);
+        case SSL_ERROR_ZERO_RETURN:
+            return TransportResult(TransportStatus::Closed);
+        case SSL_ERROR_SYSCALL:
+            // An unexpected end of file is reported without an error in the queue.
+            ERR_clear_error();
+            return TransportResult(errno == 0 || errno == EPIPE || errno == ECONNRESET ? TransportStatus::Closed : TransportStatus::Failed);
+        default:
+            ERR_clear_error();
+            return TransportResult(TransportStatus::Failed);
+    }
+}
+
+TransportResult TlsTransport::handshake(void) {
+    REMOTE_CORE_TRACE_SCOPE("tls", "handshake");
+    ERR_clear_error();
+    errno = 0;
+    int result = SSL_do_handshake(ssl);
+    if (result == 1) {
+        if (sessionCache != nullptr) {
+            sessionCache->recordHandshake(ssl);
+        }
+        
+        return TransportResult(TransportStatus::Complete);
+    }
+    
+    auto transportResult = resultForError(result);
+    return transportResult.status == TransportStatus::Closed ? TransportResult(TransportStatus::Failed) : transportResult;
+}
+
+bool TlsTransport::isSessionResumed(void) const {
+    return SSL_session_reused(ssl) == 1;
+}
+
+TransportResult TlsTransport::read(char *buffer, size_t length) {
+    REMOTE_CORE_TRACE_SCOPE("tls", "read");
+    ERR_clear_error();
+    errno = 0;
+    int result = SSL_read(ssl, buffer, (int)std::min<size_t>(length, INT_MAX));
+    if (result > 0) {
+        return TransportResult(TransportStatus::Complete, (size_t)result);
+    }
+    
+    return resultForError(result);
+}
+
+TransportResult TlsTransport::write(const char *bytes, size_t length) {
+    if (length == 0) {
+        return TransportResult(TransportStatus::Complete);
+    }
+    
+    REMOTE_CORE_TRACE_SCOPE("tls", "write");
+    ERR_clear_error();
+    errno = 0;
+    int result = SSL_write(ssl, bytes, (int)std::min<size_t>(length, INT_MAX));
+    if (result > 0) {
+        return TransportResult(TransportStatus::Complete, (size_t)result);
+    }
+    
+    return resultForError(result);
+}
+
+TransportResult TlsTransport::writeVector(const struct iovec *vectors, size_t count) {
+    if (count == 0) {
+        return TransportResult(TransportStatus::Complete);
+    } else if (count == 1 || vectors[0].iov_len >= TLS_TRANSPORT_DIRECT_WRITE_LENGTH) {
+        return write((const char *)vectors[0].iov_base, vectors[0].iov_len);
+    }
+    
+    if (stagingBuffer == nullptr) {
+        stagingBuffer.reset(new char[TLS_TRANSPORT_STAGING_LENGTH]);
+    }
+    
+    // A retry gathers the same leading bytes again, and possibly more, which 'SSL_MODE_ACCEPT_MOVING_WRITE_BUFFER' and partial writes allow.
+    size_t length = 0;
+    for (size_t i = 0; i < count && length < TLS_TRANSPORT_STAGING_LENGTH; i++) {
+        if (i > 0 && vectors[i].iov_len >= TLS_TRANSPORT_DIRECT_WRITE_LENGTH) {
+            break;
+        }
+        
+        size_t vectorLength = std::min(vectors[i].iov_len, TLS_TRANSPORT_STAGING_LENGTH - length);
+        memcpy(stagingBuffer.get() + length, vectors[i].iov_base, vectorLength);
+        length += vectorLength;
+    }
+    
+    return write(stagingBuffer.get(), length);
+}
+
+TransportResult TlsTransport::sendFile(int fileFD, off_t offset, size_t length) {
+#ifdef SSL_OP_ENABLE_KTLS
+    if (length > 0 && isKernelTlsSending()) {
+        ERR_clear_error();
+        errno = 0;
+        ossl_ssize_t result = SSL_sendfile(ssl, fileFD, offset, length, 0);
+        if (result > 0) {
+            return TransportResult(TransportStatus::Complete, (size_t)result);
+        }
+        
+        return resultForError((int)result);
+    }
+#endif
+    
+    return StreamTransport::sendFile(fileFD, offset, length);
+}
+
+std::string TlsTransport::getCipherName(void) const {
+    const SSL_CIPHER *cipher = SSL_get_current_cipher(ssl);
+    return cipher != nullptr ? SSL_CIPHER_get_name(cipher) : "";
+}
+
+bool TlsTransport::isKernelTlsSending(void) const {
+#ifdef SSL_OP_ENABLE_KTLS
+    return BIO_get_ktls_send(SSL_get_wbio(ssl)) != 0;
+#else
+    return false;
+#endif
+}
+
+bool TlsTransport::isKernelTlsReceiving(void) const {
+#ifdef SSL_OP_ENABLE_KTLS
+    return BIO_get_ktls_recv(SSL_get_rbio(ssl)) != 0;
+#else
+    return false;
+#endif
+}
@@ -0,0 +1,88 @@
+//
+//  TlsCipherPolicy.cpp
+//  remote_core
+//
+//  Created by David Moore on 10/19/26.
+//  Copyright © 2026 David Moore. All rights reserved.
+//
+
+#include "TlsCipherPolicy.hpp"
+#include <openssl/ssl.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <cpuid.h>
+#elif defined(__linux__) && (defined(__aarch64__) || defined(__arm__))
+#include <sys/auxv.h>
+#include <asm/hwcap.h>
+#endif
+
+using namespace RemoteCore;
+
+#define TLS_CIPHER_POLICY_AES_CIPHER_LIST "ECDHE-ECDSA-AES128-GCM-SHA256:ECDHE-RSA-AES128-GCM-SHA256:ECDHE-ECDSA-AES256-GCM-SHA384:ECDHE-RSA-AES256-GCM-SHA384"
+#define TLS_CIPHER_POLICY_CHACHA_CIPHER_LIST "ECDHE-ECDSA-CHACHA20-POLY1305:ECDHE-RSA-CHACHA20-POLY1305"
+#define TLS_CIPHER_POLICY_AES_CIPHER_SUITES "TLS_AES_128_GCM_SHA256:TLS_AES_256_GCM_SHA384"
+#define TLS_CIPHER_POLICY_CHACHA_CIPHER_SUITES "TLS_CHACHA20_POLY1305_SHA256"
+#define TLS_CIPHER_POLICY_GROUPS "X25519:P-256:P-384"
+
+static bool detectAESAcceleration(void) {
+#if defined(__x86_64__) || defined(__i386__)
+    unsigned int eax, ebx, ecx, edx;
+    return __get_cpuid(1, &eax, &ebx, &ecx, &edx) != 0 && (ecx & bit_AES) != 0;
+#elif defined(__linux__) && defined(__aarch64__)
+    return (getauxval(AT_HWCAP) & HWCAP_AES) != 0;
+#elif defined(__linux__) && defined(__arm__)
+    return (getauxval(AT_HWCAP2) & HWCAP2_AES) != 0;
+#else
+    // Other processors are assumed to be ones that OpenSSL's defaults already suit (e.g., Apple silicon).
+    return true;
+#endif
+}
+
+bool TlsCipherPolicy::hasAESAcceleration(void) {
+    static const bool hasAESAcceleration = detectAESAcceleration();
+    
+    return hasAESAcceleration;
+}
+
+TlsCipherPolicy TlsCipherPolicy::makePreferred(bool hasAESAcceleration) {
+    TlsCipherPolicy policy;
+    if (hasAESAcceleration) {
+        policy.cipherList = TLS_CIPHER_POLICY_AES_CIPHER_LIST ":" TLS_CIPHER_POLICY_CHACHA_CIPHER_LIST;
+        policy.cipherSuites = TLS_CIPHER_POLICY_AES_CIPHER_SUITES ":" TLS_CIPHER_POLICY_CHACHA_CIPHER_SUITES;
+    } else {
+        policy.cipherList = TLS_CIPHER_POLICY_CHACHA_CIPHER_LIST ":" TLS_CIPHER_POLICY_AES_CIPHER_LIST;
+        policy.cipherSuites = TLS_CIPHER_POLICY_CHACHA_CIPHER_SUITES ":" TLS_CIPHER_POLICY_AES_CIPHER_SUITES;
+    }
+    
+    policy.groups = TLS_CIPHER_POLICY_GROUPS;
+    return policy;
+}
+
+TlsCipherPolicy TlsCipherPolicy::getPreferred(void) {
+    return makePreferred(hasAESAcceleration());
+}
+
+bool TlsCipherPolicy::apply(SSL_CTX *context, bool isServer) const {
+    if (!cipherList.empty() && SSL_CTX_set_cipher_list(context, cipherList.c_str()) != 1) {
+        return false;
+    }
+
+#ifdef TLS1_3_VERSION
+    if (!cipherSuites.empty() && SSL_CTX_set_ciphersuites(context, cipherSuites.c_str()) != 1) {
+        return false;
+    }
+#endif
+
+    if (isServer) {
+        SSL_CTX_set_options(context, SSL_OP_CIPHER_SERVER_PREFERENCE);
+#ifdef SSL_OP_PRIORITIZE_CHACHA
+        SSL_CTX_set_options(context, SSL_OP_PRIORITIZE_CHACHA);
+#endif
+    }
+    
+    if (!groups.empty() && SSL_CTX_set1_groups_list(context, groups.c_str()) != 1) {
+        return false;
+    }
+    
+    return true;
+}
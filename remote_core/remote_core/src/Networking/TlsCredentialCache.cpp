@@ -0,0 +1,222 @@
+//
+//  TlsCredentialCache.cpp
+//  remote_core
+//
+//  Created by David Moore on 10/19/26.
+//  Copyright © 2026 David Moore. All rights reserved.
+//
+
+#include "TlsCredentialCache.hpp"
+#include <map>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include <sys/stat.h>
+#include <openssl/err.h>
+#include <openssl/pem.h>
+#include <openssl/ssl.h>
+#include <openssl/x509.h>
+
+using namespace RemoteCore;
+
+/**
+ Identifies the contents of a file well enough to notice that it has been replaced.
+ */
+struct FileVersion {
+    dev_t device;
+    ino_t inode;
+    off_t size;
+    struct timespec modificationTime;
+    
+    bool operator==(const FileVersion &other) const {
+        return device == other.device && inode == other.inode && size == other.size &&
+               modificationTime.tv_sec == other.modificationTime.tv_sec && modificationTime.tv_nsec == other.modificationTime.tv_nsec;
+    }
+};
+
+template <typename Value>
+struct CachedFile {
+    FileVersion version;
+    Value value;
+};
+
+typedef std::vector<std::shared_ptr<X509>> CertificateChain;
+
+struct CredentialCacheState {
+    std::mutex mutex;
+    std::map<std::string, CachedFile<std::shared_ptr<X509_STORE>>> rootCertificateStores;
+    std::map<std::string, CachedFile<CertificateChain>> certificateChains;
+    std::map<std::string, CachedFile<std::shared_ptr<EVP_PKEY>>> privateKeys;
+    TlsCredentialCacheStatistics statistics;
+};
+
+static CredentialCacheState &getState(void) {
+    static CredentialCacheState state;
+    return state;
+}
+
+static bool versionOfFile(const std::string &path, FileVersion &version) {
+    struct stat status;
+    if (stat(path.c_str(), &status) != 0) {
+        return false;
+    }
+    
+    version.device = status.st_dev;
+    version.inode = status.st_ino;
+    version.size = status.st_size;
+#ifdef __APPLE__
+    version.modificationTime = status.st_mtimespec;
+#else
+    version.modificationTime = status.st_mtim;
+#endif
+    return true;
+}
+
+/**
+ Returns the cached value for the file if it has not changed, or loads it again. Must be called with the state's mutex held.
+ */
+template <typename Value, typename Loader>
+static bool lookUpFile(std::map<std::string, CachedFile<Value>> &cache, const std::string &path, Value &value, Loader load) {
+    auto &state = getState();
+    FileVersion version;
+    if (!versionOfFile(path, version)) {
+        cache.erase(path);
+        return false;
+    }
+    
+    auto position = cache.find(path);
+    if (position != cache.end() && position->second.version == version) {
+        state.statistics.hitCount++;
+        value = position->second.value;
+        return true;
+    }
+    
+    if (!load(path, value)) {
+        cache.erase(path);
+        return false;
+    }
+    
+    state.statistics.loadCount++;
+    cache[path] = {version, value};
+    return true;
+}
+
+// MARK: - Loading
+
+static bool loadRootCertificates(const std::string &path, std::shared_ptr<X509_STORE> &store) {
+    std::unique_ptr<BIO, decltype(&BIO_free)> file(BIO_new_file(path.c_str(), "r"), BIO_free);
+    if (file == nullptr) {
+        return false;
+    }
+    
+    store = std::shared_ptr<X509_STORE>(X509_STORE_new(), X509_STORE_free);
+    size_t certificateCount = 0;
+    while (X509 *certificate = PEM_read_bio_X509(file.get(), nullptr, nullptr, nullptr)) {
+        bool isAdded = X509_STORE_add_cert(store.get(), certificate) == 1;
+        X509_free(certificate);
+        if (!isAdded) {
+            return false;
+        }
+        
+        certificateCount++;
+    }
+    
+    // Reading stops with an error once the end of the file is reached.
+    ERR_clear_error();
+    return certificateCount > 0;
+}
+
+static bool loadCertificateChain(const std::string &path, CertificateChain &chain) {
+    std::unique_ptr<BIO, decltype(&BIO_free)> file(BIO_new_file(path.c_str(), "r"), BIO_free);
+    if (file == nullptr) {
+        return false;
+    }
+    
+    chain.clear();
+    X509 *certificate = PEM_read_bio_X509_AUX(file.get(), nullptr, nullptr, nullptr);
+    while (certificate != nullptr) {
+        chain.emplace_back(certificate, X509_free);
+        certificate = PEM_read_bio_X509(file.get(), nullptr, nullptr, nullptr);
+    }
+    
+    ERR_clear_error();
+    return !chain.empty();
+}
+
+static bool loadPrivateKey(const std::string &path, std::shared_ptr<EVP_PKEY> &privateKey) {
+    std::unique_ptr<BIO, decltype(&BIO_free)> file(BIO_new_file(path.c_str(), "r"), BIO_free);
+    if (file == nullptr) {
+        return false;
+    }
+    
+    EVP_PKEY *key = PEM_read_bio_PrivateKey(file.get(), nullptr, nullptr, nullptr);
+    if (key == nullptr) {
+        return false;
+    }
+    
+    privateKey = std::shared_ptr<EVP_PKEY>(key, EVP_PKEY_free);
+    return true;
+}
+
+// MARK: - Configuring Contexts
+
+TlsCredentialStatus TlsCredentialCache::configureContext(SSL_CTX *context, const std::string &rootCAPath, const std::string &certificatePath, const std::string &privateKeyPath) {
+    auto &state = getState();
+    std::shared_ptr<X509_STORE> rootCertificates;
+    CertificateChain chain;
+    std::shared_ptr<EVP_PKEY> privateKey;
+    
+    {
+        std::lock_guard<std::mutex> lock(state.mutex);
+        if (!rootCAPath.empty() && !lookUpFile(state.rootCertificateStores, rootCAPath, rootCertificates, loadRootCertificates)) {
+            return TlsCredentialStatus::RootCertificateError;
+        }
+        
+        if (!certificatePath.empty()) {
+            if (!lookUpFile(state.certificateChains, certificatePath, chain, loadCertificateChain)) {
+                return TlsCredentialStatus::CertificateError;
+            }
+            
+            if (!lookUpFile(state.privateKeys, privateKeyPath, privateKey, loadPrivateKey)) {
+                return TlsCredentialStatus::PrivateKeyError;
+            }
+        }
+    }
+    
+    if (rootCertificates != nullptr) {
+        SSL_CTX_set1_cert_store(context, rootCertificates.get());
+    }
+    
+    if (!chain.empty()) {
+        if (SSL_CTX_use_certificate(context, chain.front().get()) != 1) {
+            return TlsCredentialStatus::CertificateError;
+        }
+        
+        SSL_CTX_clear_chain_certs(context);
+        for (size_t i = 1; i < chain.size(); i++) {
+            if (SSL_CTX_add1_chain_cert(context, chain[i].get()) != 1) {
+                return TlsCredentialStatus::CertificateError;
+            }
+        }
+        
+        if (SSL_CTX_use_PrivateKey(context, privateKey.get()) != 1 || SSL_CTX_check_private_key(context) != 1) {
+            return TlsCredentialStatus::PrivateKeyError;
+        }
+    }
+    
+    return TlsCredentialStatus::Success;
+}
+
+void TlsCredentialCache::removeAll(void) {
+    auto &state = getState();
+    std::lock_guard<std::mutex> lock(state.mutex);
+    state.rootCertificateStores.clear();
+    state.certificateChains.clear();
+    state.privateKeys.clear();
+}
+
+TlsCredentialCacheStatistics TlsCredentialCache::getStatistics(void) {
+    auto &state = getState();
+    std::lock_guard<std::mutex> lock(state.mutex);
+    return state.statistics;
+}
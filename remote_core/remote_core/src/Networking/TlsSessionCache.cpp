@@ -0,0 +1,215 @@
+//
+//  TlsSessionCache.cpp
+//  remote_core
+//
+//  Created by David Moore on 10/19/26.
+//  Copyright © 2026 David Moore. All rights reserved.
+//
+
+#include "TlsSessionCache.hpp"
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+#include <fstream>
+#include <vector>
+#include <fcntl.h>
+#include <unistd.h>
+#include <openssl/ssl.h>
+
+using namespace RemoteCore;
+
+#define TLS_SESSION_CACHE_FILE_MAGIC "RCTS1"
+
+/// Bounds the lengths read from the file, so that a damaged file cannot cause a huge allocation.
+#define TLS_SESSION_CACHE_MAXIMUM_FIELD_LENGTH (64 * 1024)
+
+/**
+ Stored on every handle the cache is attached to, so that sessions issued by the server can be stored under the right key.
+ */
+struct TlsSessionAttachment {
+    std::shared_ptr<TlsSessionCache> cache;
+    std::string key;
+};
+
+static void freeAttachment(void *parent, void *pointer, CRYPTO_EX_DATA *data, int index, long argument, void *argumentPointer) {
+    delete static_cast<TlsSessionAttachment *>(pointer);
+}
+
+static int getAttachmentIndex(void) {
+    static int index = SSL_get_ex_new_index(0, nullptr, nullptr, nullptr, freeAttachment);
+    return index;
+}
+
+static bool isSessionResumable(SSL_SESSION *session) {
+    return SSL_SESSION_is_resumable(session) == 1 && SSL_SESSION_get_time(session) + SSL_SESSION_get_timeout(session) > (long)time(nullptr);
+}
+
+TlsSessionCache::TlsSessionCache(const std::string &path) : path(path) {
+    if (!path.empty()) {
+        std::lock_guard<std::mutex> lock(mutex);
+        readFile();
+    }
+}
+
+void TlsSessionCache::enableForContext(SSL_CTX *context) {
+    // Sessions are only kept by this cache, rather than by the context as well.
+    SSL_CTX_set_session_cache_mode(context, SSL_SESS_CACHE_CLIENT | SSL_SESS_CACHE_NO_INTERNAL_STORE);
+    SSL_CTX_sess_set_new_cb(context, handleNewSession);
+}
+
+int TlsSessionCache::handleNewSession(SSL *ssl, SSL_SESSION *session) {
+    auto attachment = static_cast<TlsSessionAttachment *>(SSL_get_ex_data(ssl, getAttachmentIndex()));
+    if (attachment != nullptr) {
+        attachment->cache->storeSession(attachment->key, session);
+    }
+    
+    // The cache keeps a copy, so OpenSSL keeps its reference.
+    return 0;
+}
+
+void TlsSessionCache::storeSession(const std::string &key, SSL_SESSION *session) {
+    // OpenSSL marks the session a handle used as unresumable if the handle is freed without a clean shutdown, which is exactly what happens when the network drops, so a copy is kept instead.
+    SSL_SESSION *sessionCopy = SSL_SESSION_dup(session);
+    if (sessionCopy == nullptr) {
+        return;
+    }
+    
+    std::lock_guard<std::mutex> lock(mutex);
+    sessions[key] = std::shared_ptr<SSL_SESSION>(sessionCopy, SSL_SESSION_free);
+    statistics.storedSessionCount++;
+    
+    if (!path.empty()) {
+        writeFile();
+    }
+}
+
+void TlsSessionCache::attach(SSL *ssl, const std::string &key) {
+    int index = getAttachmentIndex();
+    delete static_cast<TlsSessionAttachment *>(SSL_get_ex_data(ssl, index));
+    SSL_set_ex_data(ssl, index, new TlsSessionAttachment{shared_from_this(), key});
+    
+    std::shared_ptr<SSL_SESSION> session;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto position = sessions.find(key);
+        if (position != sessions.end()) {
+            if (isSessionResumable(position->second.get())) {
+                session = position->second;
+            } else {
+                sessions.erase(position);
+            }
+        }
+    }
+    
+    if (session != nullptr) {
+        SSL_set_session(ssl, session.get());
+    }
+}
+
+void TlsSessionCache::recordHandshake(SSL *ssl) {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (SSL_session_reused(ssl)) {
+        statistics.resumedHandshakeCount++;
+    } else {
+        statistics.fullHandshakeCount++;
+    }
+}
+
+void TlsSessionCache::removeSession(const std::string &key) {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (sessions.erase(key) > 0 && !path.empty()) {
+        writeFile();
+    }
+}
+
+bool TlsSessionCache::containsSession(const std::string &key) {
+    std::lock_guard<std::mutex> lock(mutex);
+    return sessions.count(key) > 0;
+}
+
+TlsSessionCacheStatistics TlsSessionCache::getStatistics(void) {
+    std::lock_guard<std::mutex> lock(mutex);
+    return statistics;
+}
+
+// MARK: - Persistence
+
+static bool readField(std::ifstream &file, std::vector<unsigned char> &field) {
+    uint32_t length = 0;
+    if (!file.read(reinterpret_cast<char *>(&length), sizeof(length)) || length > TLS_SESSION_CACHE_MAXIMUM_FIELD_LENGTH) {
+        return false;
+    }
+    
+    field.resize(length);
+    return length == 0 || (bool)file.read(reinterpret_cast<char *>(field.data()), length);
+}
+
+static void appendField(std::string &buffer, const void *bytes, uint32_t length) {
+    buffer.append(reinterpret_cast<const char *>(&length), sizeof(length));
+    buffer.append(static_cast<const char *>(bytes), length);
+}
+
+void TlsSessionCache::readFile(void) {
+    std::ifstream file(path, std::ios::binary);
+    char magic[sizeof(TLS_SESSION_CACHE_FILE_MAGIC) - 1];
+    if (!file.read(magic, sizeof(magic)) || std::memcmp(magic, TLS_SESSION_CACHE_FILE_MAGIC, sizeof(magic)) != 0) {
+        return;
+    }
+    
+    // Entries are read until the end of the file, or the first damaged entry.
+    std::vector<unsigned char> key;
+    std::vector<unsigned char> encodedSession;
+    while (readField(file, key) && readField(file, encodedSession)) {
+        const unsigned char *bytes = encodedSession.data();
+        SSL_SESSION *session = d2i_SSL_SESSION(nullptr, &bytes, (long)encodedSession.size());
+        if (session == nullptr) {
+            break;
+        }
+        
+        std::shared_ptr<SSL_SESSION> sharedSession(session, SSL_SESSION_free);
+        if (isSessionResumable(session)) {
+            sessions[std::string(key.begin(), key.end())] = sharedSession;
+        }
+    }
+}
+
+void TlsSessionCache::writeFile(void) {
+    std::string buffer(TLS_SESSION_CACHE_FILE_MAGIC);
+    for (auto &pair : sessions) {
+        int length = i2d_SSL_SESSION(pair.second.get(), nullptr);
+        if (length <= 0) {
+            continue;
+        }
+        
+        std::vector<unsigned char> encodedSession(length);
+        unsigned char *bytes = encodedSession.data();
+        i2d_SSL_SESSION(pair.second.get(), &bytes);
+        
+        appendField(buffer, pair.first.data(), (uint32_t)pair.first.size());
+        appendField(buffer, encodedSession.data(), (uint32_t)encodedSession.size());
+    }
+    
+    // Replace the file at once, so that it is never read while partially written.
+    std::string temporaryPath = path + ".tmp";
+    int fd = open(temporaryPath.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0600);
+    if (fd < 0) {
+        return;
+    }
+    
+    size_t offset = 0;
+    while (offset < buffer.size()) {
+        ssize_t writtenCount = write(fd, buffer.data() + offset, buffer.size() - offset);
+        if (writtenCount <= 0) {
+            break;
+        }
+        
+        offset += (size_t)writtenCount;
+    }
+    
+    close(fd);
+    if (offset == buffer.size()) {
+        rename(temporaryPath.c_str(), path.c_str());
+    } else {
+        unlink(temporaryPath.c_str());
+    }
+}
@@ -0,0 +1,224 @@
+//
+//  TopicRouter.cpp
+//  remote_core
+//
+//  Created by David Moore on 10/19/26.
+//  Copyright © 2026 David Moore. All rights reserved.
+//
+
+#include "TopicRouter.hpp"
+#include <atomic>
+#include <stdexcept>
+
+using namespace RemoteCore;
+
+#define SINGLE_LEVEL_WILDCARD "+"
+#define MULTI_LEVEL_WILDCARD "#"
+
+TopicRouter::TopicRouter() : root(nullptr) {
+}
+
+// MARK: - Topic Filters
+
+std::vector<std::string> TopicRouter::splitLevels(const std::string &name) {
+    // Empty levels are significant (e.g., 'a//b' has three levels).
+    std::vector<std::string> levels;
+    size_t start = 0;
+    while (true) {
+        size_t end = name.find('/', start);
+        if (end == std::string::npos) {
+            levels.push_back(name.substr(start));
+            return levels;
+        }
+        
+        levels.push_back(name.substr(start, end - start));
+        start = end + 1;
+    }
+}
+
+bool TopicRouter::isValidFilter(const std::string &filter) {
+    if (filter.empty()) {
+        return false;
+    }
+    
+    auto levels = splitLevels(filter);
+    for (size_t i = 0; i < levels.size(); i++) {
+        auto &level = levels[i];
+        if (level == MULTI_LEVEL_WILDCARD) {
+            if (i + 1 != levels.size()) {
+                return false;
+            }
+        } else if (level != SINGLE_LEVEL_WILDCARD && level.find_first_of("+#") != std::string::npos) {
+            return false;
+        }
+    }
+    
+    return true;
+}
+
+bool TopicRouter::filterMatchesTopic(const std::string &filter, const std::string &topicName) {
+    auto filterLevels = splitLevels(filter);
+    auto topicLevels = splitLevels(topicName);
+    bool isSystemTopic = !topicName.empty() && topicName[0] == '$';
+    
+    for (size_t i = 0; i < filterLevels.size(); i++) {
+        auto &level = filterLevels[i];
+        bool isWildcard = level == MULTI_LEVEL_WILDCARD || level == SINGLE_LEVEL_WILDCARD;
+        if (isWildcard && i == 0 && isSystemTopic) {
+            return false;
+        }
+        
+        if (level == MULTI_LEVEL_WILDCARD) {
+            return true;
+        }
+        
+        if (i >= topicLevels.size() || (level != SINGLE_LEVEL_WILDCARD && level != topicLevels[i])) {
+            return false;
+        }
+    }
+    
+    return filterLevels.size() == topicLevels.size();
+}
+
+// MARK: - Snapshots
+
+std::shared_ptr<const TopicRouter::Node> TopicRouter::loadRoot(void) const {
+    return std::atomic_load_explicit(&root, std::memory_order_acquire);
+}
+
+void TopicRouter::storeRoot(std::shared_ptr<const Node> node) {
+    std::atomic_store_explicit(&root, std::move(node), std::memory_order_release);
+}
+
+std::shared_ptr<const TopicRouter::Node> TopicRouter::replacingHandler(const std::shared_ptr<const Node> &node, const std::vector<std::string> &levels, size_t index, std::shared_ptr<const Handler> handler) {
+    auto copy = node == nullptr ? std::make_shared<Node>() : std::make_shared<Node>(*node);
+    
+    if (index == levels.size()) {
+        copy->handler = std::move(handler);
+    } else {
+        auto position = copy->children.find(levels[index]);
+        auto child = replacingHandler(position == copy->children.end() ? nullptr : position->second, levels, index + 1, std::move(handler));
+        
+        if (child != nullptr) {
+            copy->children[levels[index]] = std::move(child);
+        } else if (position != copy->children.end()) {
+            copy->children.erase(position);
+        }
+    }
+    
+    // Prune nodes that no longer lead to any handler.
+    if (copy->handler == nullptr && copy->children.empty()) {
+        return nullptr;
+    }
+    
+    return copy;
+}
+
+// MARK: - Routes
+
+void TopicRouter::addRoute(const std::string &filter, Handler handler) {
+    if (!isValidFilter(filter)) {
+        throw std::invalid_argument("Expected '" + filter + "' to be a valid topic filter.");
+    }
+    
+    if (!handler) {
+        throw std::invalid_argument("Expected 'handler' to be callable.");
+    }
+    
+    std::lock_guard<std::mutex> lock(writerMutex);
+    auto sharedHandler = std::make_shared<const Handler>(std::move(handler));
+    storeRoot(replacingHandler(loadRoot(), splitLevels(filter), 0, std::move(sharedHandler)));
+}
+
+bool TopicRouter::removeRoute(const std::string &filter) {
+    auto levels = splitLevels(filter);
+    
+    std::lock_guard<std::mutex> lock(writerMutex);
+    auto currentRoot = loadRoot();
+    
+    // Find the route first, so that removing an unknown filter does not copy the trie.
+    const Node *node = currentRoot.get();
+    for (size_t i = 0; node != nullptr && i < levels.size(); i++) {
+        auto position = node->children.find(levels[i]);
+        node = position == node->children.end() ? nullptr : position->second.get();
+    }
+    
+    if (node == nullptr || node->handler == nullptr) {
+        return false;
+    }
+    
+    storeRoot(replacingHandler(currentRoot, levels, 0, nullptr));
+    return true;
+}
+
+void TopicRouter::removeAllRoutes(void) {
+    std::lock_guard<std::mutex> lock(writerMutex);
+    storeRoot(nullptr);
+}
+
+void TopicRouter::collectHandlers(const Node &node, const std::vector<std::string> &levels, size_t index, std::vector<std::shared_ptr<const Handler>> &handlers) {
+    // Wildcards at the first level do not match system topics (e.g., '$aws/...').
+    bool allowsWildcards = index != 0 || levels[0].empty() || levels[0][0] != '$';
+    
+    if (allowsWildcards) {
+        // The multi-level wildcard also matches the parent level (e.g., 'a/#' matches 'a').
+        auto position = node.children.find(MULTI_LEVEL_WILDCARD);
+        if (position != node.children.end() && position->second->handler != nullptr) {
+            handlers.push_back(position->second->handler);
+        }
+    }
+    
+    if (index == levels.size()) {
+        if (node.handler != nullptr) {
+            handlers.push_back(node.handler);
+        }
+        
+        return;
+    }
+    
+    if (allowsWildcards) {
+        auto position = node.children.find(SINGLE_LEVEL_WILDCARD);
+        if (position != node.children.end()) {
+            collectHandlers(*position->second, levels, index + 1, handlers);
+        }
+    }
+    
+    auto position = node.children.find(levels[index]);
+    if (position != node.children.end()) {
+        collectHandlers(*position->second, levels, index + 1, handlers);
+    }
+}
+
+std::vector<std::shared_ptr<const TopicRouter::Handler>> TopicRouter::handlersForTopic(const std::string &topicName) const {
+    std::vector<std::shared_ptr<const Handler>> handlers;
+    auto snapshot = loadRoot();
+    if (snapshot != nullptr) {
+        collectHandlers(*snapshot, splitLevels(topicName), 0, handlers);
+    }
+    
+    return handlers;
+}
+
+size_t TopicRouter::route(const std::string &topicName, const std::string &payload, const MqttProperties &properties) const {
+    // The handlers are kept alive by the snapshot, even if their routes are removed in the meantime.
+    auto handlers = handlersForTopic(topicName);
+    for (auto &handler : handlers) {
+        (*handler)(topicName, payload, properties);
+    }
+    
+    return handlers.size();
+}
+
+size_t TopicRouter::countRoutes(const Node &node) {
+    size_t count = node.handler == nullptr ? 0 : 1;
+    for (auto &pair : node.children) {
+        count += countRoutes(*pair.second);
+    }
+    
+    return count;
+}
+
+size_t TopicRouter::getRouteCount(void) const {
+    auto snapshot = loadRoot();
+    return snapshot == nullptr ? 0 : countRoutes(*snapshot);
+}
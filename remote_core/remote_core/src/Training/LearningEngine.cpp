@@ -0,0 +1,463 @@
+//
+//  LearningEngine.cpp
+//  remote_core
+//
+//  Created by David Moore on 10/19/26.
+//  Copyright © 2026 David Moore. All rights reserved.
+//
+
+#include "LearningEngine.hpp"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#define LEARNING_ENGINE_POLL_INTERVAL std::chrono::milliseconds(100)
+#define LEARNING_ENGINE_RAW_TOLERANCE 0.25
+
+using namespace RemoteCore;
+
+namespace {
+    /**
+     Incrementally builds frames out of samples, tracking the gap that terminated each frame.
+     */
+    class FrameAccumulator {
+    private:
+        unsigned int frameGap;
+        PulseFrame currentFrame;
+    
+    public:
+        FrameAccumulator(unsigned int frameGap) : frameGap(frameGap) {}
+        
+        /**
+         Adds a sample to the current frame. Returns true when the sample terminated a non-empty frame, in which case 'frame' and 'gap' are updated.
+         */
+        bool addSample(const PulseSample &sample, PulseFrame &frame, unsigned int &gap) {
+            if (sample.type == PulseSample::Type::Timeout || (!sample.isPulse() && sample.duration >= frameGap)) {
+                gap = sample.duration;
+                return finishFrame(frame);
+            }
+            
+            // Frames always begin with a pulse.
+            if (currentFrame.empty() && !sample.isPulse()) {
+                return false;
+            }
+            
+            // Merge consecutive samples of the same kind, which some drivers report when a sample overflows.
+            bool isPulseSlot = currentFrame.size() % 2 == 0;
+            if (!currentFrame.empty() && sample.isPulse() != isPulseSlot) {
+                currentFrame.back() += sample.duration;
+            } else {
+                currentFrame.push_back(sample.duration);
+            }
+            
+            return false;
+        }
+        
+        /**
+         Completes the current frame, if there is one.
+         */
+        bool finishFrame(PulseFrame &frame) {
+            // Drop any space that trails the final pulse.
+            if (!currentFrame.empty() && currentFrame.size() % 2 == 0) {
+                currentFrame.pop_back();
+            }
+            
+            if (currentFrame.empty()) {
+                return false;
+            }
+            
+            frame = std::move(currentFrame);
+            currentFrame = PulseFrame();
+            
+            return true;
+        }
+    };
+    
+    bool isWithinTolerance(unsigned int duration, unsigned int reference, double tolerance) {
+        return std::abs((double)duration - (double)reference) <= (double)reference * tolerance;
+    }
+}
+
+// MARK: - Learned Code
+
+bool LearnedCode::isEquivalentTo(const LearnedCode &code) const {
+    if (protocol != code.protocol) {
+        return false;
+    }
+    
+    if (protocol != PulseProtocol::Raw) {
+        return bitCount == code.bitCount && this->code == code.code;
+    }
+    
+    if (rawFrame.size() != code.rawFrame.size()) {
+        return false;
+    }
+    
+    for (size_t i = 0; i < rawFrame.size(); i++) {
+        if (!isWithinTolerance(code.rawFrame[i], rawFrame[i], LEARNING_ENGINE_RAW_TOLERANCE)) {
+            return false;
+        }
+    }
+    
+    return true;
+}
+
+// MARK: - Learning Engine
+
+LearningEngine::LearningEngine(LearningConfiguration configuration) : configuration(configuration), isCancelled(false) {
+    // Reading the stream blocks until a signal arrives, or the timeout elapses.
+    queue = std::make_unique<DispatchQueue>("ca.mooredev.remote_core.LearningEngine.serial_dispatch_queue", 1, true);
+}
+
+LearningEngine::~LearningEngine() {
+    cancel();
+    
+    // Destroying the queue waits for the current request to observe the cancellation.
+    queue = nullptr;
+}
+
+void LearningEngine::cancel(void) {
+    isCancelled = true;
+}
+
+void LearningEngine::learnFromStreamWithCompletionHandler(std::unique_ptr<PulseStream> stream, CompletionHandler completionHandler) {
+    auto startTime = std::chrono::steady_clock::now();
+    isCancelled = false;
+    
+    // Blocks must be copyable, so the stream is shared with the block.
+    std::shared_ptr<PulseStream> sharedStream(std::move(stream));
+    queue->execute([this, sharedStream, completionHandler, startTime]() {
+        LearningResult result;
+        if (sharedStream == nullptr) {
+            result.error = Error::NoSignalWhileTraining;
+        } else {
+            result = learnFromStream(sharedStream.get(), startTime);
+        }
+        
+        result.latency = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - startTime);
+        
+        if (completionHandler) {
+            completionHandler(result);
+        }
+    });
+}
+
+LearningResult LearningEngine::learnFromStream(PulseStream *stream, std::chrono::steady_clock::time_point startTime) {
+    LearningResult result;
+    auto deadline = startTime + configuration.timeout;
+    
+    FrameAccumulator accumulator(configuration.frameGap);
+    std::vector<std::pair<LearnedCode, size_t>> candidates;
+    bool isComplete = false;
+    
+    // Decodes a captured frame and tallies it against the frames seen so far.
+    auto processFrame = [&](const PulseFrame &frame, unsigned int gap) {
+        result.frameCount++;
+        
+        if (frame.size() < configuration.minimumFrameLength) {
+            return;
+        }
+        
+        auto decodeStartTime = std::chrono::steady_clock::now();
+        auto code = decodeFrame(frame);
+        code.gap = gap;
+        result.decodeDuration += std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - decodeStartTime);
+        
+        auto position = std::find_if(candidates.begin(), candidates.end(), [&](const std::pair<LearnedCode, size_t> &candidate) {
+            return candidate.first.isEquivalentTo(code);
+        });
+        
+        if (position == candidates.end()) {
+            candidates.push_back(std::make_pair(code, 1));
+            position = candidates.end() - 1;
+        } else {
+            position->second++;
+        }
+        
+        if (position->second >= configuration.requiredMatchingFrames) {
+            isComplete = true;
+        }
+    };
+    
+    while (!isComplete && !isCancelled) {
+        auto now = std::chrono::steady_clock::now();
+        if (now >= deadline) {
+            break;
+        }
+        
+        auto remaining = std::chrono::duration_cast<std::chrono::milliseconds>(deadline - now);
+        auto timeout = std::min(remaining, LEARNING_ENGINE_POLL_INTERVAL);
+        
+        PulseSample sample;
+        PulseFrame frame;
+        unsigned int gap = 0;
+        
+        auto readResult = stream->readSample(sample, timeout);
+        if (readResult == PulseStream::ReadResult::Success) {
+            if (accumulator.addSample(sample, frame, gap)) {
+                processFrame(frame, gap);
+            }
+        } else {
+            // Silence (or the end of the stream) completes whatever frame is in progress.
+            if (accumulator.finishFrame(frame)) {
+                processFrame(frame, configuration.frameGap);
+            }
+            
+            if (readResult != PulseStream::ReadResult::TimedOut) {
+                break;
+            }
+        }
+    }
+    
+    if (isCancelled) {
+        result.error = Error::TrainingCancelled;
+        return result;
+    }
+    
+    // Prefer the code that was captured most often.
+    auto best = std::max_element(candidates.begin(), candidates.end(), [](const std::pair<LearnedCode, size_t> &lhs, const std::pair<LearnedCode, size_t> &rhs) {
+        return lhs.second < rhs.second;
+    });
+    
+    if (best == candidates.end()) {
+        result.error = Error::NoSignalWhileTraining;
+    } else {
+        result.error = Error::None;
+        result.code = best->first;
+    }
+    
+    return result;
+}
+
+// MARK: - Decoding
+
+std::vector<PulseFrame> LearningEngine::segmentFrames(const std::vector<PulseSample> &samples) const {
+    std::vector<PulseFrame> frames;
+    FrameAccumulator accumulator(configuration.frameGap);
+    
+    PulseFrame frame;
+    unsigned int gap;
+    for (auto &sample : samples) {
+        if (accumulator.addSample(sample, frame, gap)) {
+            frames.push_back(std::move(frame));
+        }
+    }
+    
+    if (accumulator.finishFrame(frame)) {
+        frames.push_back(std::move(frame));
+    }
+    
+    return frames;
+}
+
+std::vector<unsigned int> LearningEngine::clusterDurations(std::vector<unsigned int> durations) const {
+    std::vector<unsigned int> centers;
+    if (durations.empty()) {
+        return centers;
+    }
+    
+    std::sort(durations.begin(), durations.end());
+    
+    double sum = 0.0;
+    size_t count = 0;
+    for (auto duration : durations) {
+        // Start a new cluster once a duration is too far from the mean of the current one.
+        if (count > 0 && duration > (sum / count) * (1.0 + configuration.tolerance)) {
+            centers.push_back((unsigned int)std::lround(sum / count));
+            sum = 0.0;
+            count = 0;
+        }
+        
+        sum += duration;
+        count++;
+    }
+    
+    centers.push_back((unsigned int)std::lround(sum / count));
+    
+    return centers;
+}
+
+unsigned int LearningEngine::snapDuration(unsigned int duration, const std::vector<unsigned int> &centers) const {
+    unsigned int snapped = duration;
+    double minimumDistance = std::numeric_limits<double>::max();
+    
+    for (auto center : centers) {
+        double distance = std::abs((double)duration - (double)center) / (double)center;
+        if (distance < minimumDistance) {
+            minimumDistance = distance;
+            snapped = center;
+        }
+    }
+    
+    return snapped;
+}
+
+LearnedCode LearningEngine::decodeFrame(const PulseFrame &frame) const {
+    LearnedCode code;
+    if (frame.empty()) {
+        return code;
+    }
+    
+    // Cleaned up timings are useful regardless of whether the protocol is recognized.
+    auto centers = clusterDurations(frame);
+    for (auto duration : frame) {
+        code.rawFrame.push_back(snapDuration(duration, centers));
+    }
+    
+    // A header is a leading pulse that is much longer than any pulse used for bits.
+    size_t offset = 0;
+    if (frame.size() >= 4) {
+        std::vector<unsigned int> bitPulses;
+        for (size_t i = 2; i < frame.size(); i += 2) {
+            bitPulses.push_back(frame[i]);
+        }
+        
+        auto pulseCenters = clusterDurations(bitPulses);
+        if (frame[0] > pulseCenters.back() * (1.0 + 2.0 * configuration.tolerance)) {
+            code.header.pulse = frame[0];
+            code.header.space = frame[1];
+            offset = 2;
+        }
+    }
+    
+    if (decodePulseDistance(frame, offset, code) || decodePulseWidth(frame, offset, code)) {
+        return code;
+    }
+    
+    if (offset == 0 && decodeBiphase(frame, code)) {
+        return code;
+    }
+    
+    // Fall back to the raw representation.
+    code.protocol = PulseProtocol::Raw;
+    code.header = PulsePair();
+    code.bitCount = 0;
+    code.code = 0;
+    
+    return code;
+}
+
+bool LearningEngine::decodePulseDistance(const PulseFrame &frame, size_t offset, LearnedCode &code) const {
+    // Bits are pulse/space pairs followed by a single trailing pulse.
+    if (frame.size() < offset + 3 || (frame.size() - offset) % 2 == 0) {
+        return false;
+    }
+    
+    std::vector<unsigned int> pulses, spaces;
+    for (size_t i = offset; i < frame.size(); i += 2) {
+        pulses.push_back(frame[i]);
+        if (i + 1 < frame.size()) {
+            spaces.push_back(frame[i + 1]);
+        }
+    }
+    
+    auto pulseCenters = clusterDurations(pulses);
+    auto spaceCenters = clusterDurations(spaces);
+    if (pulseCenters.size() != 1 || spaceCenters.size() != 2 || spaces.size() > 64) {
+        return false;
+    }
+    
+    uint64_t value = 0;
+    for (auto space : spaces) {
+        value = (value << 1) | (snapDuration(space, spaceCenters) == spaceCenters[1] ? 1 : 0);
+    }
+    
+    code.protocol = PulseProtocol::PulseDistance;
+    code.zero = {pulseCenters[0], spaceCenters[0]};
+    code.one = {pulseCenters[0], spaceCenters[1]};
+    code.trailingPulse = pulseCenters[0];
+    code.bitCount = (unsigned int)spaces.size();
+    code.code = value;
+    
+    return true;
+}
+
+bool LearningEngine::decodePulseWidth(const PulseFrame &frame, size_t offset, LearnedCode &code) const {
+    // Every pulse is a bit, separated by constant spaces.
+    if (frame.size() < offset + 3 || (frame.size() - offset) % 2 == 0) {
+        return false;
+    }
+    
+    std::vector<unsigned int> pulses, spaces;
+    for (size_t i = offset; i < frame.size(); i += 2) {
+        pulses.push_back(frame[i]);
+        if (i + 1 < frame.size()) {
+            spaces.push_back(frame[i + 1]);
+        }
+    }
+    
+    auto pulseCenters = clusterDurations(pulses);
+    auto spaceCenters = clusterDurations(spaces);
+    if (pulseCenters.size() != 2 || spaceCenters.size() != 1 || pulses.size() > 64) {
+        return false;
+    }
+    
+    uint64_t value = 0;
+    for (auto pulse : pulses) {
+        value = (value << 1) | (snapDuration(pulse, pulseCenters) == pulseCenters[1] ? 1 : 0);
+    }
+    
+    code.protocol = PulseProtocol::PulseWidth;
+    code.zero = {pulseCenters[0], spaceCenters[0]};
+    code.one = {pulseCenters[1], spaceCenters[0]};
+    code.trailingPulse = 0;
+    code.bitCount = (unsigned int)pulses.size();
+    code.code = value;
+    
+    return true;
+}
+
+bool LearningEngine::decodeBiphase(const PulseFrame &frame, LearnedCode &code) const {
+    auto centers = clusterDurations(frame);
+    if (centers.empty() || centers.size() > 2) {
+        return false;
+    }
+    
+    // Every duration must span one or two half-bit periods.
+    unsigned int halfBit = centers[0];
+    std::vector<int> levels;
+    for (size_t i = 0; i < frame.size(); i++) {
+        int level = i % 2 == 0 ? 1 : 0;
+        if (isWithinTolerance(frame[i], halfBit, configuration.tolerance)) {
+            levels.push_back(level);
+        } else if (isWithinTolerance(frame[i], halfBit * 2, configuration.tolerance)) {
+            levels.push_back(level);
+            levels.push_back(level);
+        } else {
+            return false;
+        }
+    }
+    
+    // The first half of the start bit is a space, which is indistinguishable from the preceding gap.
+    if (levels.front() == 1) {
+        levels.insert(levels.begin(), 0);
+    }
+    
+    // Likewise, a final space may be absorbed by the trailing gap.
+    if (levels.size() % 2 != 0) {
+        levels.push_back(0);
+    }
+    
+    if (levels.size() / 2 > 64) {
+        return false;
+    }
+    
+    uint64_t value = 0;
+    for (size_t i = 0; i < levels.size(); i += 2) {
+        if (levels[i] == levels[i + 1]) {
+            return false;
+        }
+        
+        // A rising edge in the middle of the bit is a one.
+        value = (value << 1) | (levels[i + 1] == 1 ? 1 : 0);
+    }
+    
+    code.protocol = PulseProtocol::Biphase;
+    code.zero = {halfBit, halfBit};
+    code.one = {halfBit, halfBit};
+    code.trailingPulse = 0;
+    code.bitCount = (unsigned int)(levels.size() / 2);
+    code.code = value;
+    
+    return true;
+}
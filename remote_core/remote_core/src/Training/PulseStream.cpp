@@ -0,0 +1,148 @@
+//
+//  PulseStream.cpp
+//  remote_core
+//
+//  Created by David Moore on 10/19/26.
+//  Copyright © 2026 David Moore. All rights reserved.
+//
+
+#include "PulseStream.hpp"
+#include <cerrno>
+#include <cstdint>
+#include <limits>
+#include <fstream>
+#include <fcntl.h>
+#include <poll.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+#ifdef __linux__
+#include <sys/ioctl.h>
+#include <linux/lirc.h>
+#endif
+
+using namespace RemoteCore;
+
+PulseStream::PulseStream(std::unique_ptr<std::istream> captureStream) : captureStream(std::move(captureStream)), deviceFileDescriptor(-1) {
+}
+
+PulseStream::PulseStream(int deviceFileDescriptor) : deviceFileDescriptor(deviceFileDescriptor) {
+}
+
+PulseStream::~PulseStream() {
+    if (deviceFileDescriptor >= 0) {
+        close(deviceFileDescriptor);
+    }
+}
+
+std::unique_ptr<PulseStream> PulseStream::openPath(const std::string &path) {
+    struct stat buffer;
+    if (stat(path.c_str(), &buffer) != 0) {
+        return nullptr;
+    }
+    
+    if (S_ISCHR(buffer.st_mode)) {
+#ifdef __linux__
+        int fileDescriptor = open(path.c_str(), O_RDONLY | O_NONBLOCK | O_CLOEXEC);
+        if (fileDescriptor < 0) {
+            return nullptr;
+        }
+        
+        // Receivers must be switched to mode2 so that raw pulse lengths are reported.
+        uint32_t mode = LIRC_MODE_MODE2;
+        if (ioctl(fileDescriptor, LIRC_SET_REC_MODE, &mode) != 0) {
+            close(fileDescriptor);
+            return nullptr;
+        }
+        
+        return std::make_unique<PulseStream>(fileDescriptor);
+#else
+        return nullptr;
+#endif
+    }
+    
+    auto fileStream = std::make_unique<std::ifstream>(path);
+    if (!fileStream->is_open()) {
+        return nullptr;
+    }
+    
+    return std::make_unique<PulseStream>(std::move(fileStream));
+}
+
+PulseStream::ReadResult PulseStream::readSample(PulseSample &sample, std::chrono::milliseconds timeout) {
+    if (captureStream != nullptr) {
+        return readCaptureSample(sample);
+    } else if (deviceFileDescriptor >= 0) {
+        return readDeviceSample(sample, timeout);
+    } else {
+        return ReadResult::Failure;
+    }
+}
+
+PulseStream::ReadResult PulseStream::readCaptureSample(PulseSample &sample) {
+    std::string kind;
+    unsigned long duration;
+    
+    while (*captureStream >> kind) {
+        // Skip the remainder of lines that are not samples (e.g., "Using driver default on device /dev/lirc0").
+        if (kind != "pulse" && kind != "space" && kind != "timeout") {
+            captureStream->ignore(std::numeric_limits<std::streamsize>::max(), '\n');
+            continue;
+        }
+        
+        if (!(*captureStream >> duration)) {
+            return ReadResult::Failure;
+        }
+        
+        if (kind == "pulse") {
+            sample = PulseSample(PulseSample::Type::Pulse, (unsigned int)duration);
+        } else if (kind == "space") {
+            sample = PulseSample(PulseSample::Type::Space, (unsigned int)duration);
+        } else {
+            sample = PulseSample(PulseSample::Type::Timeout, (unsigned int)duration);
+        }
+        
+        return ReadResult::Success;
+    }
+    
+    return captureStream->eof() ? ReadResult::EndOfStream : ReadResult::Failure;
+}
+
+PulseStream::ReadResult PulseStream::readDeviceSample(PulseSample &sample, std::chrono::milliseconds timeout) {
+#ifdef __linux__
+    while (true) {
+        struct pollfd descriptor = {deviceFileDescriptor, POLLIN, 0};
+        int pollResult = poll(&descriptor, 1, (int)timeout.count());
+        if (pollResult == 0) {
+            return ReadResult::TimedOut;
+        } else if (pollResult < 0) {
+            return errno == EINTR ? ReadResult::TimedOut : ReadResult::Failure;
+        }
+        
+        uint32_t value;
+        ssize_t length = read(deviceFileDescriptor, &value, sizeof(value));
+        if (length < 0 && (errno == EAGAIN || errno == EINTR)) {
+            continue;
+        } else if (length != sizeof(value)) {
+            return length == 0 ? ReadResult::EndOfStream : ReadResult::Failure;
+        }
+        
+        switch (LIRC_MODE2(value)) {
+            case LIRC_MODE2_PULSE:
+                sample = PulseSample(PulseSample::Type::Pulse, LIRC_VALUE(value));
+                return ReadResult::Success;
+            case LIRC_MODE2_SPACE:
+                sample = PulseSample(PulseSample::Type::Space, LIRC_VALUE(value));
+                return ReadResult::Success;
+            case LIRC_MODE2_TIMEOUT:
+                sample = PulseSample(PulseSample::Type::Timeout, LIRC_VALUE(value));
+                return ReadResult::Success;
+            default:
+                // Carrier frequency reports and overflow markers carry no timing information.
+                break;
+        }
+    }
+#else
+    return ReadResult::Failure;
+#endif
+}
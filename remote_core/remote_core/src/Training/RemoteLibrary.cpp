@@ -0,0 +1,491 @@
+//
+//  RemoteLibrary.cpp
+//  remote_core
+//
+//  Created by David Moore on 10/19/26.
+//  Copyright © 2026 David Moore. All rights reserved.
+//
+
+#include "RemoteLibrary.hpp"
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <sstream>
+#include <dirent.h>
+#include <sys/stat.h>
+
+using namespace RemoteCore;
+
+namespace {
+    uint64_t bitMask(unsigned int bitCount) {
+        return bitCount >= 64 ? ~(uint64_t)0 : (((uint64_t)1 << bitCount) - 1);
+    }
+    
+    /**
+     Hashes the features that identify an encoded button (FNV-1a).
+     */
+    uint64_t featureKey(PulseProtocol protocol, unsigned int bitCount, uint64_t code) {
+        uint64_t hash = 0xcbf29ce484222325;
+        auto combine = [&hash](uint64_t value) {
+            for (int i = 0; i < 8; i++) {
+                hash ^= (value >> (i * 8)) & 0xFF;
+                hash *= 0x100000001b3;
+            }
+        };
+        
+        combine((uint64_t)protocol);
+        combine(bitCount);
+        combine(code);
+        
+        return hash;
+    }
+    
+    double relativeError(unsigned int duration, unsigned int reference) {
+        return std::abs((double)duration - (double)reference) / (double)std::max(reference, 1u);
+    }
+    
+    /**
+     Appends a duration to a frame, merging it with the previous duration when both are of the same kind.
+     */
+    void appendDuration(PulseFrame &frame, bool isPulse, unsigned int duration) {
+        if (duration == 0 || (frame.empty() && !isPulse)) {
+            return;
+        }
+        
+        bool isPulseSlot = frame.size() % 2 == 0;
+        if (!frame.empty() && isPulse != isPulseSlot) {
+            frame.back() += duration;
+        } else {
+            frame.push_back(duration);
+        }
+    }
+    
+    /**
+     Intermediate representation of a remote while its lircd.conf definition is being parsed.
+     */
+    struct RemoteDefinition {
+        std::string name;
+        std::vector<std::string> flags;
+        PulsePair header;
+        PulsePair one;
+        PulsePair zero;
+        unsigned int trailingPulse = 0;
+        unsigned int leadingPulse = 0;
+        unsigned int gap = 0;
+        unsigned int bits = 0;
+        unsigned int preDataBits = 0;
+        unsigned int postDataBits = 0;
+        uint64_t preData = 0;
+        uint64_t postData = 0;
+        unsigned int toggleBit = 0;
+        uint64_t toggleBitMask = 0;
+        std::vector<RemoteButton> buttons;
+        
+        bool hasFlag(const std::string &flag) const {
+            return std::find(flags.begin(), flags.end(), flag) != flags.end();
+        }
+        
+        /**
+         Converts the definition into a codebook. Returns false if the encoding is not supported.
+         */
+        bool makeCodebook(RemoteCodebook &codebook) const {
+            codebook.name = name;
+            codebook.header = header;
+            codebook.one = one;
+            codebook.zero = zero;
+            codebook.trailingPulse = trailingPulse;
+            codebook.gap = gap;
+            codebook.buttons = buttons;
+            
+            if (hasFlag("RAW_CODES")) {
+                codebook.protocol = PulseProtocol::Raw;
+                return !buttons.empty();
+            }
+            
+            unsigned int totalBits = preDataBits + bits + postDataBits;
+            if (bits == 0 || totalBits > 64) {
+                return false;
+            }
+            
+            bool shouldInvert = false;
+            if (hasFlag("RC5") || hasFlag("SHIFT_ENC")) {
+                codebook.protocol = PulseProtocol::Biphase;
+            } else if (hasFlag("RC6") || hasFlag("RCMM") || hasFlag("XMP") || hasFlag("GRUNDIG") || hasFlag("BO") || hasFlag("SERIAL")) {
+                return false;
+            } else if (one.pulse == zero.pulse) {
+                codebook.protocol = PulseProtocol::PulseDistance;
+                shouldInvert = one.space < zero.space;
+            } else if (one.space == zero.space) {
+                codebook.protocol = PulseProtocol::PulseWidth;
+                shouldInvert = one.pulse < zero.pulse;
+            } else {
+                return false;
+            }
+            
+            // The learning engine treats the longer symbol as a one.
+            if (shouldInvert) {
+                std::swap(codebook.one, codebook.zero);
+            }
+            
+            codebook.bitCount = totalBits;
+            codebook.toggleBitMask = toggleBitMask;
+            if (toggleBit > 0 && toggleBit <= totalBits) {
+                // Toggle bits are numbered from the most significant bit, starting at one.
+                codebook.toggleBitMask |= (uint64_t)1 << (totalBits - toggleBit);
+            }
+            
+            for (auto &button : codebook.buttons) {
+                uint64_t code = (preData & bitMask(preDataBits)) << (bits + postDataBits);
+                code |= (button.code & bitMask(bits)) << postDataBits;
+                code |= postData & bitMask(postDataBits);
+                
+                if (shouldInvert) {
+                    code ^= bitMask(totalBits);
+                }
+                
+                button.code = code;
+            }
+            
+            // The leading pulse of RC5 is the start bit, which the learning engine decodes as a one.
+            if (codebook.protocol == PulseProtocol::Biphase && leadingPulse > 0 && totalBits < 64) {
+                for (auto &button : codebook.buttons) {
+                    button.code |= (uint64_t)1 << totalBits;
+                }
+                
+                codebook.bitCount++;
+            }
+            
+            return !codebook.buttons.empty();
+        }
+    };
+}
+
+// MARK: - Remote Codebook
+
+LearnedCode RemoteCodebook::learnedCodeForButton(const RemoteButton &button) const {
+    LearnedCode code;
+    code.protocol = protocol;
+    code.header = header;
+    code.one = one;
+    code.zero = zero;
+    code.trailingPulse = trailingPulse;
+    code.gap = gap;
+    code.bitCount = bitCount;
+    code.code = button.code;
+    
+    if (protocol == PulseProtocol::Raw) {
+        code.rawFrame = button.rawFrame;
+        return code;
+    }
+    
+    // Render the timings so that the button can be sent as a raw code.
+    PulseFrame &frame = code.rawFrame;
+    appendDuration(frame, true, header.pulse);
+    appendDuration(frame, false, header.space);
+    
+    for (int bit = (int)bitCount - 1; bit >= 0; bit--) {
+        bool isOne = (button.code >> bit) & 1;
+        auto &pair = isOne ? one : zero;
+        
+        if (protocol == PulseProtocol::Biphase) {
+            // A one is a space followed by a pulse, and a zero is the opposite.
+            appendDuration(frame, !isOne, pair.pulse);
+            appendDuration(frame, isOne, pair.space);
+        } else {
+            appendDuration(frame, true, pair.pulse);
+            appendDuration(frame, false, pair.space);
+        }
+    }
+    
+    appendDuration(frame, true, trailingPulse);
+    
+    // The final space is indistinguishable from the gap.
+    if (!frame.empty() && frame.size() % 2 == 0) {
+        frame.pop_back();
+    }
+    
+    return code;
+}
+
+// MARK: - Remote Library
+
+RemoteLibrary::RemoteLibrary(double tolerance) : tolerance(tolerance) {
+}
+
+size_t RemoteLibrary::loadDirectory(const std::string &path) {
+    auto directory = opendir(path.c_str());
+    if (directory == nullptr) {
+        return 0;
+    }
+    
+    size_t count = 0;
+    while (auto entry = readdir(directory)) {
+        std::string name = entry->d_name;
+        if (name.empty() || name[0] == '.') {
+            continue;
+        }
+        
+        auto entryPath = path + "/" + name;
+        struct stat buffer;
+        if (stat(entryPath.c_str(), &buffer) != 0) {
+            continue;
+        }
+        
+        if (S_ISDIR(buffer.st_mode)) {
+            count += loadDirectory(entryPath);
+        } else if (name.size() > 5 && name.compare(name.size() - 5, 5, ".conf") == 0) {
+            std::ifstream stream(entryPath);
+            count += loadConfiguration(stream);
+        }
+    }
+    
+    closedir(directory);
+    
+    return count;
+}
+
+size_t RemoteLibrary::loadConfiguration(std::istream &stream) {
+    enum class Section {
+        None,
+        Remote,
+        Codes,
+        RawCodes
+    };
+    
+    size_t count = 0;
+    Section section = Section::None;
+    RemoteDefinition definition;
+    
+    std::string line;
+    while (std::getline(stream, line)) {
+        // Discard comments.
+        auto commentPosition = line.find('#');
+        if (commentPosition != std::string::npos) {
+            line.erase(commentPosition);
+        }
+        
+        std::istringstream tokens(line);
+        std::string key;
+        if (!(tokens >> key)) {
+            continue;
+        }
+        
+        try {
+            if (key == "begin" || key == "end") {
+                std::string kind;
+                tokens >> kind;
+                
+                if (key == "begin" && kind == "remote") {
+                    definition = RemoteDefinition();
+                    section = Section::Remote;
+                } else if (key == "begin" && kind == "codes") {
+                    section = Section::Codes;
+                } else if (key == "begin" && kind == "raw_codes") {
+                    section = Section::RawCodes;
+                } else if (key == "end" && kind == "remote") {
+                    RemoteCodebook codebook;
+                    if (section != Section::None && definition.makeCodebook(codebook)) {
+                        addCodebook(std::move(codebook));
+                        count++;
+                    }
+                    
+                    section = Section::None;
+                } else if (key == "end") {
+                    section = Section::Remote;
+                }
+            } else if (section == Section::Codes) {
+                RemoteButton button;
+                std::string value;
+                if (tokens >> value) {
+                    button.name = key;
+                    button.code = std::stoull(value, nullptr, 0);
+                    definition.buttons.push_back(button);
+                }
+            } else if (section == Section::RawCodes) {
+                if (key == "name") {
+                    RemoteButton button;
+                    tokens >> button.name;
+                    definition.buttons.push_back(button);
+                } else if (!definition.buttons.empty()) {
+                    // Timings may span several lines.
+                    std::istringstream durations(line);
+                    unsigned int duration;
+                    while (durations >> duration) {
+                        appendDuration(definition.buttons.back().rawFrame, definition.buttons.back().rawFrame.size() % 2 == 0, duration);
+                    }
+                }
+            } else if (section == Section::Remote) {
+                auto readPair = [&tokens](PulsePair &pair) {
+                    tokens >> pair.pulse >> pair.space;
+                };
+                
+                std::string value;
+                if (key == "name") {
+                    tokens >> definition.name;
+                } else if (key == "flags") {
+                    tokens >> value;
+                    std::istringstream flags(value);
+                    std::string flag;
+                    while (std::getline(flags, flag, '|')) {
+                        definition.flags.push_back(flag);
+                    }
+                } else if (key == "bits") {
+                    tokens >> definition.bits;
+                } else if (key == "header") {
+                    readPair(definition.header);
+                } else if (key == "one") {
+                    readPair(definition.one);
+                } else if (key == "zero") {
+                    readPair(definition.zero);
+                } else if (key == "ptrail") {
+                    tokens >> definition.trailingPulse;
+                } else if (key == "plead") {
+                    tokens >> definition.leadingPulse;
+                } else if (key == "gap") {
+                    tokens >> definition.gap;
+                } else if (key == "pre_data_bits") {
+                    tokens >> definition.preDataBits;
+                } else if (key == "post_data_bits") {
+                    tokens >> definition.postDataBits;
+                } else if (key == "pre_data" && tokens >> value) {
+                    definition.preData = std::stoull(value, nullptr, 0);
+                } else if (key == "post_data" && tokens >> value) {
+                    definition.postData = std::stoull(value, nullptr, 0);
+                } else if (key == "toggle_bit") {
+                    tokens >> definition.toggleBit;
+                } else if (key == "toggle_bit_mask" && tokens >> value) {
+                    definition.toggleBitMask = std::stoull(value, nullptr, 0);
+                }
+            }
+        } catch (const std::logic_error &) {
+            // Malformed values invalidate the remote, but not the rest of the file.
+            section = Section::None;
+        }
+    }
+    
+    return count;
+}
+
+void RemoteLibrary::addCodebook(RemoteCodebook codebook) {
+    size_t codebookIndex = codebooks.size();
+    
+    for (size_t buttonIndex = 0; buttonIndex < codebook.buttons.size(); buttonIndex++) {
+        auto &button = codebook.buttons[buttonIndex];
+        auto location = std::make_pair(codebookIndex, buttonIndex);
+        
+        if (codebook.protocol == PulseProtocol::Raw) {
+            rawCodeIndex[button.rawFrame.size()].push_back(location);
+            continue;
+        }
+        
+        // Index both states of the toggle bit, so that any press can be found with a single lookup.
+        codeIndex.emplace(featureKey(codebook.protocol, codebook.bitCount, button.code), location);
+        if (codebook.toggleBitMask != 0) {
+            codeIndex.emplace(featureKey(codebook.protocol, codebook.bitCount, button.code ^ codebook.toggleBitMask), location);
+        }
+    }
+    
+    codebooks.push_back(std::move(codebook));
+}
+
+double RemoteLibrary::timingScore(const LearnedCode &code, const RemoteCodebook &codebook) const {
+    std::vector<std::pair<unsigned int, unsigned int>> timings = {
+        {code.one.pulse, codebook.one.pulse},
+        {code.one.space, codebook.one.space},
+        {code.zero.pulse, codebook.zero.pulse},
+        {code.zero.space, codebook.zero.space}
+    };
+    
+    // A header must be present in both or neither.
+    if ((code.header.pulse == 0) != (codebook.header.pulse == 0)) {
+        return 0.0;
+    } else if (code.header.pulse != 0) {
+        timings.push_back({code.header.pulse, codebook.header.pulse});
+        timings.push_back({code.header.space, codebook.header.space});
+    }
+    
+    double totalError = 0.0;
+    for (auto &timing : timings) {
+        double error = relativeError(timing.first, timing.second);
+        if (error > tolerance) {
+            return 0.0;
+        }
+        
+        totalError += error;
+    }
+    
+    return 1.0 - totalError / timings.size();
+}
+
+double RemoteLibrary::rawFrameScore(const PulseFrame &frame, const PulseFrame &otherFrame) const {
+    if (frame.size() != otherFrame.size() || frame.empty()) {
+        return 0.0;
+    }
+    
+    double totalError = 0.0;
+    for (size_t i = 0; i < frame.size(); i++) {
+        double error = relativeError(frame[i], otherFrame[i]);
+        if (error > tolerance) {
+            return 0.0;
+        }
+        
+        totalError += error;
+    }
+    
+    return 1.0 - totalError / frame.size();
+}
+
+std::vector<RemoteMatch> RemoteLibrary::identifyCode(const LearnedCode &code, size_t maximumCount) const {
+    std::unordered_map<size_t, RemoteMatch> bestMatches;
+    auto addMatch = [&bestMatches](size_t codebookIndex, size_t buttonIndex, double score) {
+        if (score <= 0.0) {
+            return;
+        }
+        
+        auto &match = bestMatches[codebookIndex];
+        if (score > match.score) {
+            match.codebookIndex = codebookIndex;
+            match.buttonIndex = buttonIndex;
+            match.score = score;
+        }
+    };
+    
+    if (code.protocol != PulseProtocol::Raw) {
+        auto range = codeIndex.equal_range(featureKey(code.protocol, code.bitCount, code.code));
+        for (auto position = range.first; position != range.second; position++) {
+            auto &location = position->second;
+            auto &codebook = codebooks[location.first];
+            auto &button = codebook.buttons[location.second];
+            
+            // Different signatures may share a key, so the hash only narrows down the candidates.
+            bool isSameCode = button.code == code.code || (codebook.toggleBitMask != 0 && (button.code ^ codebook.toggleBitMask) == code.code);
+            if (codebook.protocol == code.protocol && codebook.bitCount == code.bitCount && isSameCode) {
+                addMatch(location.first, location.second, timingScore(code, codebook));
+            }
+        }
+    }
+    
+    // Raw remotes may contain any protocol, so compare the timings directly.
+    auto rawPosition = rawCodeIndex.find(code.rawFrame.size());
+    if (rawPosition != rawCodeIndex.end()) {
+        for (auto &location : rawPosition->second) {
+            auto &button = codebooks[location.first].buttons[location.second];
+            addMatch(location.first, location.second, rawFrameScore(code.rawFrame, button.rawFrame));
+        }
+    }
+    
+    std::vector<RemoteMatch> matches;
+    for (auto &pair : bestMatches) {
+        matches.push_back(pair.second);
+    }
+    
+    std::sort(matches.begin(), matches.end(), [](const RemoteMatch &lhs, const RemoteMatch &rhs) {
+        return lhs.score > rhs.score || (lhs.score == rhs.score && lhs.codebookIndex < rhs.codebookIndex);
+    });
+    
+    if (matches.size() > maximumCount) {
+        matches.resize(maximumCount);
+    }
+    
+    return matches;
+}
@@ -8,26 +8,26 @@
 
 #include "TrainingSession.hpp"
 #include "UUID.hpp"
-#include "Coder.hpp"
-#include "JSONContainer.hpp"
+#include "CommandIDCatalog.hpp"
 #include "CommandLine.hpp"
+#include "MetricsRegistry.hpp"
+#include <algorithm>
 #include <exception>
 #include <iostream>
 #include <fstream>
+#include <sstream>
 #include <thread>
 
 using namespace RemoteCore;
 
-TrainingSession::TrainingSession(Remote associatedRemote) : associatedRemote(associatedRemote) {
+#define REMOTE_CONFIGURATION_DIRECTORY "remotes/"
+#define LEARNING_LATENCY_METRIC_NAME "remote_core_training_learning_latency_seconds"
+#define LEARNING_LATENCY_METRIC_HELP "Time taken to learn a code, from the start of the request until it was decoded."
+
+TrainingSession::TrainingSession(Remote associatedRemote) : associatedRemote(associatedRemote), captureSourcePath(PULSE_STREAM_DEFAULT_DEVICE_PATH), lastLearningLatency(0), isIdentifyingRemote(false), idleTimeout(TRAINING_SESSION_DEFAULT_IDLE_TIMEOUT) {
     sessionID = UUID::GenerateUUIDString();
-    
-    // Read the command IDs in.
-    auto container = std::make_unique<JSONContainer>(std::ifstream("config/remote_core_command_ids.json"));
-    auto coder = std::make_unique<Coder>(std::move(container));
-    
-    // Sort a copied version of the available command IDs.
-    auto sortedCommandIDs = coder->decodeRootArray<std::string>();
-    std::sort(sortedCommandIDs.begin(), sortedCommandIDs.end());
+    queue = std::make_unique<DispatchQueue>("ca.mooredev.remote_core.TrainingSession.serial_dispatch_queue");
+    learningEngine = std::make_unique<LearningEngine>();
     
     std::vector<std::string> sortedRemoteCommandIDs;
     for (auto &command : associatedRemote.commands) {
@@ -35,8 +35,9 @@ TrainingSession::TrainingSession(Remote associatedRemote) : associatedRemote(ass
     }
     std::sort(sortedRemoteCommandIDs.begin(), sortedRemoteCommandIDs.end());
     
+    // The command ID catalog is generated at build time, and is already sorted.
     availableCommandIDs = std::vector<std::string>();
-    std::set_difference(sortedCommandIDs.begin(), sortedCommandIDs.end(),
+    std::set_difference(CommandIDCatalog::keys, CommandIDCatalog::keys + CommandIDCatalog::keyCount,
                         sortedRemoteCommandIDs.begin(), sortedRemoteCommandIDs.end(),
                         std::inserter(availableCommandIDs, availableCommandIDs.end()));
 }
@@ -47,11 +48,11 @@ void TrainingSession::addNewRemoteConfigToDefaultConfig(Remote remote) {
     std::ifstream fileReader;
     fileWriter.open("/etc/lirc/lircd.conf", std::ios::app);
     fileReader.open("remotes/" + remote.getRemoteID() + ".lircd.conf");
-
+    
     // Set up for finding remote declaration in new config file
     bool isRemoteNotDeclared = true;
     std::string line;
-
+    
     if (fileReader.is_open() && fileWriter.is_open()) {
         // Set reader to begin of remote declaration
         while (isRemoteNotDeclared) {
@@ -61,7 +62,7 @@ void TrainingSession::addNewRemoteConfigToDefaultConfig(Remote remote) {
                 fileWriter << "\n" << line << "\n";
             }
         }
-
+        
         // Write/Read parallel to config files
         while (std::getline(fileReader, line)) {
             if (line.find("end remote") != std::string::npos) {
@@ -70,7 +71,7 @@ void TrainingSession::addNewRemoteConfigToDefaultConfig(Remote remote) {
             }
             fileWriter << line << "\n";
         }
-
+        
         fileWriter.close();
         fileReader.close();
     } else {
@@ -94,6 +95,11 @@ void TrainingSession::start(void) {
 //        }
 //    });
 
+    {
+        std::lock_guard<std::mutex> lock(stateMutex);
+        scheduleIdleTimeout();
+    }
+    
     // Call the appropriate delegate method.
     if (auto delegate = this->delegate.lock()) {
         delegate->trainingSessionDidBegin(this);
@@ -102,9 +108,19 @@ void TrainingSession::start(void) {
 
 void TrainingSession::suspend(void) {
     /* ***************** Stop the training session. ***************** */
+    
+    {
+        std::lock_guard<std::mutex> lock(stateMutex);
+        idleTimer.cancel();
+        idleDeadline = std::chrono::steady_clock::time_point::max();
+    }
+    
+    // Stop listening for a command; the delegate is told the learning was cancelled.
+    learningEngine->cancel();
 }
 
 Command TrainingSession::createCommandWithLocalizedTitle(std::string localizedTitle) {
+    std::lock_guard<std::mutex> lock(stateMutex);
     if (availableCommandIDs.empty()) {
         throw std::logic_error("Expected 'availableCommandIDs' to be non-empty.");
     }
@@ -118,9 +134,16 @@ Command TrainingSession::createCommandWithLocalizedTitle(std::string localizedTi
     return command;
 }
 
-void TrainingSession::learnCommand(Command command) {
-    if (currentCommand != Command()) {
-        throw std::logic_error("Expected 'currentCommand' to be empty.");
+DispatchFuture<Error> TrainingSession::learnCommand(Command command) {
+    {
+        std::lock_guard<std::mutex> lock(stateMutex);
+        if (currentCommand != Command() || isIdentifyingRemote) {
+            throw std::logic_error("Expected 'currentCommand' to be empty.");
+        }
+        
+        // The learning engine has its own timeout while a request is in progress.
+        currentCommand = command;
+        idleTimer.cancel();
     }
     
     // Call the delegate.
@@ -130,14 +153,233 @@ void TrainingSession::learnCommand(Command command) {
     }
     
     /* ***************** Learn the command. ***************** */
+    
+    DispatchPromise<Error> promise;
+    auto stream = PulseStream::openPath(captureSourcePath);
+    learningEngine->learnFromStreamWithCompletionHandler(std::move(stream), [this, command, promise](LearningResult result) mutable {
+        promise.resolve(this->handleLearningResult(command, result));
+    });
+    
+    return promise.getFuture();
+}
 
-    DispatchQueue queue("ca.mooredev.remote_core.TrainingSession.serial_dispatch_queue");
-    queue.execute([this, command]() {
-        std::this_thread::sleep_for(std::chrono::seconds(5));
+Error TrainingSession::handleLearningResult(Command command, LearningResult result) {
+    static auto &learningLatency = MetricsRegistry::sharedRegistry().histogram(LEARNING_LATENCY_METRIC_NAME, LEARNING_LATENCY_METRIC_HELP, {{"operation", "learn"}});
+    
+    // A cancelled request only measures how long the user waited.
+    if (result.error != Error::TrainingCancelled) {
+        learningLatency.record(result.latency);
+    }
+    
+    {
+        std::lock_guard<std::mutex> lock(stateMutex);
+        currentCommand = Command();
+        lastLearningLatency = result.latency;
         
-        // Call the delegate.
-        if (auto delegate = this->delegate.lock()) {
+        if (result.error == Error::None) {
+            learnedCodesByCommandID[command.getCommandID()] = result.code;
+        }
+        
+        if (result.error != Error::TrainingCancelled) {
+            scheduleIdleTimeout();
+        }
+    }
+    
+    if (result.error == Error::None) {
+        // Persist the configuration so the command can be sent immediately.
+        writeRemoteConfiguration();
+    }
+    
+    // Call the delegate.
+    if (auto delegate = this->delegate.lock()) {
+        if (result.error == Error::None) {
             delegate->trainingSessionDidLearnCommand(this, command);
+        } else {
+            delegate->trainingSessionDidFailWithError(this, result.error);
+        }
+    }
+    
+    return result.error;
+}
+
+DispatchFuture<Error> TrainingSession::identifyRemote(void) {
+    {
+        std::lock_guard<std::mutex> lock(stateMutex);
+        if (currentCommand != Command() || isIdentifyingRemote) {
+            throw std::logic_error("Expected 'currentCommand' to be empty.");
         }
+        
+        isIdentifyingRemote = true;
+        idleTimer.cancel();
+    }
+    
+    // Any button will do.
+    if (auto delegate = this->delegate.lock()) {
+        delegate->trainingSessionDidRequestExclusiveArbitraryInput(this);
+    }
+    
+    DispatchPromise<Error> promise;
+    auto stream = PulseStream::openPath(captureSourcePath);
+    learningEngine->learnFromStreamWithCompletionHandler(std::move(stream), [this, promise](LearningResult result) mutable {
+        promise.resolve(this->handleIdentificationResult(result));
     });
+    
+    return promise.getFuture();
+}
+
+Error TrainingSession::handleIdentificationResult(LearningResult result) {
+    static auto &identificationLatency = MetricsRegistry::sharedRegistry().histogram(LEARNING_LATENCY_METRIC_NAME, LEARNING_LATENCY_METRIC_HELP, {{"operation", "identify"}});
+    
+    if (result.error != Error::TrainingCancelled) {
+        identificationLatency.record(result.latency);
+    }
+    
+    {
+        std::lock_guard<std::mutex> lock(stateMutex);
+        isIdentifyingRemote = false;
+        lastLearningLatency = result.latency;
+        
+        if (result.error != Error::TrainingCancelled) {
+            scheduleIdleTimeout();
+        }
+    }
+    
+    auto error = result.error;
+    if (error == Error::None) {
+        error = Error::NoMatchingRemote;
+        
+        // Prefer the closest match that can be represented with standard command IDs.
+        auto matches = remoteLibrary == nullptr ? std::vector<RemoteMatch>() : remoteLibrary->identifyCode(result.code);
+        for (auto &match : matches) {
+            if (adoptCodebook(remoteLibrary->getCodebook(match.codebookIndex))) {
+                error = Error::None;
+                break;
+            }
+        }
+    }
+    
+    if (error == Error::None) {
+        writeRemoteConfiguration();
+    }
+    
+    // Call the delegate.
+    if (auto delegate = this->delegate.lock()) {
+        if (error == Error::None) {
+            delegate->trainingSessionDidIdentifyRemote(this, getAssociatedRemote());
+        } else {
+            delegate->trainingSessionDidFailWithError(this, error);
+        }
+    }
+    
+    return error;
+}
+
+void TrainingSession::scheduleIdleTimeout(void) {
+    idleTimer.cancel();
+    idleDeadline = std::chrono::steady_clock::now() + idleTimeout;
+    idleTimer = queue->executeAfter(idleTimeout, [this]() {
+        this->handleIdleTimeout();
+    });
+}
+
+void TrainingSession::handleIdleTimeout(void) {
+    {
+        // A timer that was already on its way when the session became busy again is stale.
+        std::lock_guard<std::mutex> lock(stateMutex);
+        if (currentCommand != Command() || isIdentifyingRemote || std::chrono::steady_clock::now() < idleDeadline) {
+            return;
+        }
+    }
+    
+    // Call the delegate.
+    if (auto delegate = this->delegate.lock()) {
+        delegate->trainingSessionDidFailWithError(this, Error::TrainingTimedOut);
+    }
+}
+
+bool TrainingSession::adoptCodebook(const RemoteCodebook &codebook) {
+    std::lock_guard<std::mutex> lock(stateMutex);
+    
+    // The existing commands are replaced, so their command IDs may be adopted as well.
+    auto commandIDs = availableCommandIDs;
+    for (auto &command : associatedRemote.commands) {
+        commandIDs.push_back(command.getCommandID());
+    }
+    std::sort(commandIDs.begin(), commandIDs.end());
+    
+    // Buttons of library remotes are named after the standard command IDs (e.g., 'KEY_POWER').
+    std::vector<std::pair<Command, LearnedCode>> adoptedCommands;
+    for (auto &button : codebook.buttons) {
+        auto position = std::lower_bound(commandIDs.begin(), commandIDs.end(), button.name);
+        if (position == commandIDs.end() || *position != button.name) {
+            continue;
+        }
+        
+        adoptedCommands.push_back(std::make_pair(Command(button.name, button.name), codebook.learnedCodeForButton(button)));
+        commandIDs.erase(position);
+    }
+    
+    if (adoptedCommands.empty()) {
+        return false;
+    }
+    
+    associatedRemote.commands.clear();
+    learnedCodesByCommandID.clear();
+    for (auto &pair : adoptedCommands) {
+        associatedRemote.commands.push_back(pair.first);
+        learnedCodesByCommandID[pair.first.getCommandID()] = pair.second;
+    }
+    
+    availableCommandIDs = commandIDs;
+    
+    return true;
+}
+
+void TrainingSession::writeRemoteConfiguration(void) {
+    std::ofstream configurationStream(REMOTE_CONFIGURATION_DIRECTORY + associatedRemote.getRemoteID() + ".lircd.conf");
+    configurationStream << generateRemoteConfiguration();
+}
+
+LearnedCode TrainingSession::learnedCodeForCommand(const Command &command) {
+    std::lock_guard<std::mutex> lock(stateMutex);
+    auto position = learnedCodesByCommandID.find(command.getCommandID());
+    
+    return position == learnedCodesByCommandID.end() ? LearnedCode() : position->second;
+}
+
+std::string TrainingSession::generateRemoteConfiguration(void) {
+    std::lock_guard<std::mutex> lock(stateMutex);
+    std::ostringstream configuration;
+    
+    // Use the largest captured gap so that repeats are never sent too quickly.
+    unsigned int gap = 0;
+    for (auto &pair : learnedCodesByCommandID) {
+        gap = std::max(gap, pair.second.gap);
+    }
+    
+    // Raw codes are used so that commands of any protocol can coexist within a single remote.
+    configuration << "begin remote\n";
+    configuration << "  name  " << associatedRemote.getRemoteID() << "\n";
+    configuration << "  flags RAW_CODES\n";
+    configuration << "  eps   30\n";
+    configuration << "  aeps  100\n";
+    configuration << "  gap   " << gap << "\n";
+    configuration << "  begin raw_codes\n";
+    
+    for (auto &pair : learnedCodesByCommandID) {
+        configuration << "    name " << pair.first << "\n";
+        
+        auto &rawFrame = pair.second.rawFrame;
+        for (size_t i = 0; i < rawFrame.size(); i++) {
+            configuration << (i % 6 == 0 ? "      " : " ") << rawFrame[i];
+            if (i % 6 == 5 || i + 1 == rawFrame.size()) {
+                configuration << "\n";
+            }
+        }
+    }
+    
+    configuration << "  end raw_codes\n";
+    configuration << "end remote\n";
+    
+    return configuration.str();
 }
@@ -6,53 +6,74 @@
 //  Copyright © 2018 David Moore. All rights reserved.
 //
 
+#include <cstdlib>
 #include <iostream>
 #include <memory>
-#include <thread>
 #include <signal.h>
 #include "RemoteController.hpp"
+#include "DispatchStatisticsMonitor.hpp"
+#include "EventLoop.hpp"
+#include "FlightRecorder.hpp"
 
 #define CONFIG_FILE_RELATIVE_PATH "config/remote_core_config.json"
 
-// MARK: - Signal Interface
+/// Environment variable with the number of seconds between dumps of the dispatch queue statistics. Statistics are only dumped periodically when it is set.
+#define DISPATCH_STATISTICS_INTERVAL_VARIABLE "REMOTE_CORE_DISPATCH_STATISTICS_INTERVAL"
 
-/// Last signal that was received.
-static volatile std::atomic_int lastSignal(0);
-
-/// Updates `lastSignal` with the received signal.
-void handleSignal(int signum) {
-    lastSignal = signum;
-}
+/// Files the flight recorder's trace is written to upon receiving SIGUSR1, and upon crashing. Only written when tracing is compiled in.
+#define TRACE_FILE_RELATIVE_PATH "remote_core_trace.json"
+#define CRASH_TRACE_FILE_RELATIVE_PATH "remote_core_crash_trace.json"
 
 // MARK: - Lifecycle
 
 int main(int argc, const char * argv[]) {
-    // Provide a signal handler for termination and hangup.
-    signal(SIGTERM, &handleSignal);
-    signal(SIGHUP, &handleSignal);
+    // The main thread sleeps in the event loop until a signal arrives. Networking and dispatch queues run their own threads.
+    RemoteCore::EventLoop eventLoop;
     
-    // Create a remote controller, then start it.
-    auto remoteController = std::make_shared<RemoteCore::RemoteController>(CONFIG_FILE_RELATIVE_PATH);
-    remoteController->startController();
+    std::shared_ptr<RemoteCore::RemoteController> remoteController;
+    std::unique_ptr<RemoteCore::DispatchStatisticsMonitor> statisticsMonitor;
     
-    // Maintain a run-loop while the program is ongoing.
-    while (true) {
-        // Wait for an arbitrary amount of time until we check for signals again.
-        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    // Signals are handled before any other thread is started, so that they are only ever delivered to the event loop.
+    eventLoop.addSignalHandler(SIGTERM, [&](int signal) {
+        // Exit cleanly.
+        eventLoop.stop();
+    });
+    
+    eventLoop.addSignalHandler(SIGHUP, [&](int signal) {
+        // Reload the configuration file by restarting the controller.
+        remoteController->stopController();
+        remoteController->startController();
+    });
+    
+    eventLoop.addSignalHandler(SIGUSR1, [&](int signal) {
+        statisticsMonitor->dump();
         
-        if (lastSignal == SIGHUP) {
-            // Reload the configuration file by restarting the controller.
-            remoteController->stopController();
-            remoteController->startController();
-        } else if (lastSignal == SIGTERM) {
-            // Exit cleanly.
-            break;
+#ifdef REMOTE_CORE_TRACING
+        if (!RemoteCore::FlightRecorder::writeChromeTraceToFile(TRACE_FILE_RELATIVE_PATH)) {
+            std::cerr << "Unable to write the trace to '" << TRACE_FILE_RELATIVE_PATH << "'." << std::endl;
         }
-        
-        // Reset the signal.
-        lastSignal = 0;
+#endif
+    });
+    
+#ifdef REMOTE_CORE_TRACING
+    RemoteCore::FlightRecorder::installCrashHandler(CRASH_TRACE_FILE_RELATIVE_PATH);
+#endif
+    
+    // Dispatch queue statistics are dumped upon receiving SIGUSR1, and periodically if requested.
+    auto statisticsIntervalVariable = std::getenv(DISPATCH_STATISTICS_INTERVAL_VARIABLE);
+    auto statisticsInterval = std::chrono::seconds(statisticsIntervalVariable != nullptr ? std::atoi(statisticsIntervalVariable) : 0);
+    statisticsMonitor = std::make_unique<RemoteCore::DispatchStatisticsMonitor>(std::cout, statisticsInterval);
+    if (statisticsInterval.count() > 0) {
+        statisticsMonitor->start();
     }
     
+    // Create a remote controller, then start it.
+    remoteController = std::make_shared<RemoteCore::RemoteController>(CONFIG_FILE_RELATIVE_PATH);
+    remoteController->startController();
+    
+    // Run until SIGTERM is received.
+    eventLoop.run();
+    
     // Disconnect from the connection manager.
     remoteController->stopController();
     
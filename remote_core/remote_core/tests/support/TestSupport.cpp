@@ -0,0 +1,34 @@
+//
+//  TestSupport.cpp
+//  remote_core_tests
+//
+//  Created by David Moore on 10/19/26.
+//  Copyright © 2026 David Moore. All rights reserved.
+//
+
+#include <algorithm>
+#include <future>
+#include <memory>
+#include "TestSupport.hpp"
+
+using namespace RemoteCore;
+
+double TestSupport::percentile(const std::vector<std::chrono::steady_clock::duration> &sortedLatencies, double fraction) {
+    if (sortedLatencies.empty()) {
+        return 0;
+    }
+    
+    auto index = std::min(sortedLatencies.size() - 1, (size_t)(fraction * sortedLatencies.size()));
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(sortedLatencies[index]).count() / 1000.0;
+}
+
+MqttStatus TestSupport::waitForStatus(std::function<void (MqttConnection::CompletionHandler)> operation, std::chrono::milliseconds timeout) {
+    // A standard promise keeps the helper free of the dispatch sources, so that any target can link it.
+    auto promise = std::make_shared<std::promise<MqttStatus>>();
+    auto future = promise->get_future();
+    operation([promise](MqttStatus status) {
+        promise->set_value(status);
+    });
+    
+    return future.wait_for(timeout) == std::future_status::ready ? future.get() : MqttStatus::Timeout;
+}
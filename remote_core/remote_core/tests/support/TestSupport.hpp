@@ -0,0 +1,34 @@
+//
+//  TestSupport.hpp
+//  remote_core_tests
+//
+//  Created by David Moore on 10/19/26.
+//  Copyright © 2026 David Moore. All rights reserved.
+//
+
+#ifndef TestSupport_hpp
+#define TestSupport_hpp
+
+#include <chrono>
+#include <functional>
+#include <vector>
+#include "MqttConnection.hpp"
+
+/**
+ Helpers shared by the unit tests, benchmarks and tools. They do not depend on Google Test, so failures are reported through return values or exceptions.
+ */
+namespace RemoteCore {
+    namespace TestSupport {
+        /**
+         Returns the latency at the given fraction (e.g., 0.99) of the sorted latencies, in microseconds.
+         */
+        double percentile(const std::vector<std::chrono::steady_clock::duration> &sortedLatencies, double fraction);
+        
+        /**
+         Runs the operation, and blocks until its completion handler is called. Returns 'MqttStatus::Timeout' if the timeout elapses first.
+         */
+        MqttStatus waitForStatus(std::function<void (MqttConnection::CompletionHandler)> operation, std::chrono::milliseconds timeout = std::chrono::seconds(5));
+    }
+}
+
+#endif /* TestSupport_hpp */
@@ -0,0 +1,79 @@
+//
+//  TlsTestSupport.cpp
+//  remote_core_tests
+//
+//  Created by David Moore on 10/19/26.
+//  Copyright © 2026 David Moore. All rights reserved.
+//
+
+#include <cstdio>
+#include <memory>
+#include <stdexcept>
+#include <utility>
+#include <poll.h>
+#include <openssl/evp.h>
+#include <openssl/pem.h>
+#include <openssl/x509v3.h>
+#include "TlsTestSupport.hpp"
+
+using namespace RemoteCore;
+
+void TestSupport::writeSelfSignedCertificate(const std::string &certificatePath, const std::string &privateKeyPath, const std::string &keyType, const std::string &serverName) {
+    std::unique_ptr<EVP_PKEY, decltype(&EVP_PKEY_free)> key(keyType == "RSA" ? EVP_RSA_gen(2048) : EVP_EC_gen(keyType.c_str()), EVP_PKEY_free);
+    std::unique_ptr<X509, decltype(&X509_free)> certificate(X509_new(), X509_free);
+    if (key == nullptr || certificate == nullptr) {
+        throw std::runtime_error("Expected a " + keyType + " key to be generated.");
+    }
+    
+    X509_set_version(certificate.get(), 2);
+    ASN1_INTEGER_set(X509_get_serialNumber(certificate.get()), 1);
+    X509_gmtime_adj(X509_getm_notBefore(certificate.get()), -60);
+    X509_gmtime_adj(X509_getm_notAfter(certificate.get()), 60 * 60 * 24);
+    X509_set_pubkey(certificate.get(), key.get());
+    
+    X509_NAME *name = X509_get_subject_name(certificate.get());
+    X509_NAME_add_entry_by_txt(name, "CN", MBSTRING_ASC, (const unsigned char *)serverName.c_str(), -1, -1, 0);
+    X509_set_issuer_name(certificate.get(), name);
+    
+    X509V3_CTX extensionContext;
+    X509V3_set_ctx_nodb(&extensionContext);
+    X509V3_set_ctx(&extensionContext, certificate.get(), certificate.get(), nullptr, nullptr, 0);
+    
+    std::string subjectAlternativeName = "DNS:" + serverName;
+    for (auto extensionDescription : {std::make_pair(NID_subject_alt_name, subjectAlternativeName.c_str()), std::make_pair(NID_basic_constraints, "critical,CA:TRUE")}) {
+        X509_EXTENSION *extension = X509V3_EXT_conf_nid(nullptr, &extensionContext, extensionDescription.first, extensionDescription.second);
+        if (extension == nullptr) {
+            throw std::runtime_error("Expected the certificate's extensions to be valid.");
+        }
+        
+        X509_add_ext(certificate.get(), extension, -1);
+        X509_EXTENSION_free(extension);
+    }
+    
+    if (X509_sign(certificate.get(), key.get(), EVP_sha256()) <= 0) {
+        throw std::runtime_error("Expected the certificate to be signed.");
+    }
+    
+    std::unique_ptr<FILE, decltype(&fclose)> certificateFile(fopen(certificatePath.c_str(), "w"), fclose);
+    std::unique_ptr<FILE, decltype(&fclose)> privateKeyFile(fopen(privateKeyPath.c_str(), "w"), fclose);
+    if (certificateFile == nullptr || privateKeyFile == nullptr) {
+        throw std::runtime_error("Expected the certificate and key to be writable.");
+    }
+    
+    PEM_write_X509(certificateFile.get(), certificate.get());
+    PEM_write_PrivateKey(privateKeyFile.get(), key.get(), nullptr, nullptr, 0, nullptr, nullptr);
+}
+
+TransportResult TestSupport::waitForCompletion(int fd, std::function<TransportResult (void)> operation, int timeoutMilliseconds) {
+    auto result = operation();
+    while (result.status == TransportStatus::WantRead || result.status == TransportStatus::WantWrite) {
+        struct pollfd descriptor = {fd, (short)(result.status == TransportStatus::WantWrite ? POLLOUT : POLLIN), 0};
+        if (poll(&descriptor, 1, timeoutMilliseconds) != 1) {
+            return TransportResult(TransportStatus::Failed);
+        }
+        
+        result = operation();
+    }
+    
+    return result;
+}
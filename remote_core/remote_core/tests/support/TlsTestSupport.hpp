@@ -0,0 +1,33 @@
+//
+//  TlsTestSupport.hpp
+//  remote_core_tests
+//
+//  Created by David Moore on 10/19/26.
+//  Copyright © 2026 David Moore. All rights reserved.
+//
+
+#ifndef TlsTestSupport_hpp
+#define TlsTestSupport_hpp
+
+#include <functional>
+#include <string>
+#include "StreamTransport.hpp"
+
+/**
+ TLS helpers shared by the unit tests, benchmarks and tools, kept apart from 'TestSupport' so that only targets which link OpenSSL need them.
+ */
+namespace RemoteCore {
+    namespace TestSupport {
+        /**
+         Writes a self-signed CA certificate for the server name, and its key, to the files. The key type is an elliptic curve (e.g., 'P-256') or 'RSA', which is 2048 bits. Throws 'std::runtime_error' if either cannot be written.
+         */
+        void writeSelfSignedCertificate(const std::string &certificatePath, const std::string &privateKeyPath, const std::string &keyType = "P-256", const std::string &serverName = "localhost");
+        
+        /**
+         Retries the operation, waiting on the descriptor for the readiness it asks for, until it completes or fails. Returns 'TransportStatus::Failed' if the readiness does not arrive within the timeout, or waits indefinitely if it is negative.
+         */
+        TransportResult waitForCompletion(int fd, std::function<TransportResult (void)> operation, int timeoutMilliseconds = -1);
+    }
+}
+
+#endif /* TlsTestSupport_hpp */
@@ -0,0 +1,163 @@
+//
+//  BufferChainTests.cpp
+//  remote_core_unit_tests
+//
+//  Created by David Moore on 10/19/26.
+//  Copyright © 2026 David Moore. All rights reserved.
+//
+
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include <sys/socket.h>
+#include <gtest/gtest.h>
+#include "BufferChain.hpp"
+#include "MqttPacket.hpp"
+#include "StreamTransport.hpp"
+
+using namespace RemoteCore;
+
+#define DEFAULT_TOPIC_NAME "remote_core/devices/0/messages"
+#define DEFAULT_PUBLISH_COUNT 100
+
+// MARK: - Test Fixture
+
+class BufferChainTests : public testing::Test {
+protected:
+    /**
+     Returns the bytes the vectors refer to, in order.
+     */
+    static std::string joinVectors(const struct iovec *vectors, size_t count) {
+        std::string bytes;
+        for (size_t i = 0; i < count; i++) {
+            bytes.append((const char *)vectors[i].iov_base, vectors[i].iov_len);
+        }
+        
+        return bytes;
+    }
+    
+    /**
+     Reads every byte that is available without waiting.
+     */
+    static std::string readAvailable(StreamTransport &transport) {
+        std::string bytes;
+        char buffer[4096];
+        while (true) {
+            auto result = transport.read(buffer, sizeof(buffer));
+            if (result.status != TransportStatus::Complete) {
+                return bytes;
+            }
+            
+            bytes.append(buffer, result.byteCount);
+        }
+    }
+};
+
+// MARK: - Tests
+
+TEST_F(BufferChainTests, ShareAndSlice) {
+    // Long enough not to be stored inline, so the string's own allocation is kept.
+    std::string bytes = "hello, world, from the remote core";
+    const char *data = bytes.data();
+    
+    auto statistics = SharedBuffer::getStatistics();
+    SharedBuffer buffer(std::move(bytes));
+    SharedBuffer copy = buffer;
+    SharedBuffer slice = buffer.slice(7, 5);
+    
+    // Moving the string in keeps its bytes where they were.
+    EXPECT_EQ(buffer.data(), data);
+    EXPECT_EQ(copy.data(), data);
+    EXPECT_EQ(slice.data(), data + 7);
+    EXPECT_EQ(slice.toString(), "world");
+    EXPECT_EQ(slice, SharedBuffer("world"));
+    EXPECT_NE(slice, buffer);
+    EXPECT_TRUE(buffer.slice(3, 0).empty());
+    EXPECT_THROW(buffer.slice(30, 5), std::out_of_range);
+    
+    auto newStatistics = SharedBuffer::getStatistics();
+    EXPECT_EQ(newStatistics.allocationCount - statistics.allocationCount, 2u);
+    EXPECT_EQ(newStatistics.copiedByteCount - statistics.copiedByteCount, 10u);
+}
+
+TEST_F(BufferChainTests, AppendAndConsume) {
+    BufferChain chain;
+    SharedBuffer payload(std::string("payload"));
+    chain.appendBytes("ab", 2);
+    chain.appendBytes("cd", 2);
+    chain.append(payload);
+    chain.append(SharedBuffer());
+    chain.appendBytes([](std::string &bytes) {
+        bytes.append("ef");
+    });
+    
+    // Adjacent bytes of the chain's own share a vector, and the payload is referred to where it is.
+    struct iovec vectors[8];
+    ASSERT_EQ(chain.getIOVectors(vectors, 8), 3u);
+    EXPECT_EQ(vectors[1].iov_base, payload.data());
+    EXPECT_EQ(joinVectors(vectors, 3), "abcdpayloadef");
+    EXPECT_EQ(chain.getIOVectors(vectors, 2), 2u);
+    EXPECT_EQ(chain.getByteCount(), 13u);
+    
+    chain.consume(6);
+    ASSERT_EQ(chain.getIOVectors(vectors, 8), 2u);
+    EXPECT_EQ(joinVectors(vectors, 2), "yloadef");
+    EXPECT_EQ(chain.toString(), "yloadef");
+    EXPECT_THROW(chain.consume(8), std::logic_error);
+    
+    chain.consume(7);
+    EXPECT_TRUE(chain.isEmpty());
+    EXPECT_EQ(chain.getIOVectors(vectors, 8), 0u);
+    
+    chain.appendBytes("gh", 2);
+    EXPECT_EQ(chain.toString(), "gh");
+}
+
+TEST_F(BufferChainTests, EncodePacketsIntoChain) {
+    std::vector<MqttPacket> packets = {
+        MqttPacket::connect("client", 30, true),
+        MqttPacket::publish(DEFAULT_TOPIC_NAME, std::string(300, 'x'), 1, 7),
+        MqttPacket::publish(DEFAULT_TOPIC_NAME, std::string(), 0, 0),
+        MqttPacket::subscribe(8, {DEFAULT_TOPIC_NAME}, 1),
+        MqttPacket::withType(MqttPacketType::PingRequest)
+    };
+    
+    std::string buffer;
+    BufferChain chain;
+    for (auto &packet : packets) {
+        packet.encode(buffer);
+        packet.encode(chain);
+    }
+    
+    EXPECT_EQ(chain.toString(), buffer);
+}
+
+TEST_F(BufferChainTests, PublishWithoutCopying) {
+    int fds[2];
+    ASSERT_EQ(socketpair(AF_UNIX, SOCK_STREAM, 0, fds), 0);
+    TcpTransport sender(fds[0]);
+    TcpTransport receiver(fds[1]);
+    
+    BufferChain chain;
+    std::string received;
+    std::string expected;
+    for (uint16_t i = 1; i <= DEFAULT_PUBLISH_COUNT; i++) {
+        std::string data = "{\"index\":" + std::to_string(i) + "}";
+        MqttPacket::publish(DEFAULT_TOPIC_NAME, data, 1, i).encode(expected);
+        
+        // Each publish allocates its payload once, as the coder's output is moved in, and copies none of it until it is encrypted or sent.
+        auto statistics = SharedBuffer::getStatistics();
+        MqttPacket::publish(DEFAULT_TOPIC_NAME, std::move(data), 1, i).encode(chain);
+        while (!chain.isEmpty()) {
+            ASSERT_EQ(sender.writeChain(chain).status, TransportStatus::Complete);
+        }
+        
+        auto newStatistics = SharedBuffer::getStatistics();
+        EXPECT_EQ(newStatistics.allocationCount - statistics.allocationCount, 1u);
+        EXPECT_EQ(newStatistics.copiedByteCount - statistics.copiedByteCount, 0u);
+        
+        received += readAvailable(receiver);
+    }
+    
+    EXPECT_EQ(received, expected);
+}
@@ -0,0 +1,260 @@
+//
+//  BufferedTlsStreamTests.cpp
+//  remote_core_unit_tests
+//
+//  Created by David Moore on 10/19/26.
+//  Copyright © 2026 David Moore. All rights reserved.
+//
+
+#include <chrono>
+#include <cstdio>
+#include <functional>
+#include <future>
+#include <memory>
+#include <string>
+#include <thread>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <gtest/gtest.h>
+#include <openssl/ssl.h>
+#include "BufferedTlsStream.hpp"
+#include "StreamTransport.hpp"
+#include "TlsCredentialCache.hpp"
+#include "TlsTestSupport.hpp"
+
+using namespace RemoteCore;
+
+#define DEFAULT_TIMEOUT std::chrono::seconds(5)
+#define DEFAULT_PACKET_COUNT 100
+#define DEFAULT_PAYLOAD_LENGTH 30
+
+/**
+ Returns packets shaped like small MQTT publishes: a type byte, a length byte, and the payload.
+ */
+static std::string makePackets(int count) {
+    std::string packets;
+    for (int i = 0; i < count; i++) {
+        packets.push_back((char)0x30);
+        packets.push_back((char)DEFAULT_PAYLOAD_LENGTH);
+        packets.append(DEFAULT_PAYLOAD_LENGTH, (char)('a' + i % 26));
+    }
+    
+    return packets;
+}
+
+// MARK: - Test Fixture
+
+class BufferedTlsStreamTests : public testing::Test {
+protected:
+    std::string certificatePath;
+    std::string privateKeyPath;
+    TlsConfiguration serverConfiguration;
+    std::shared_ptr<SSL_CTX> serverContext;
+    std::shared_ptr<SSL_CTX> clientContext;
+    int listenFD = -1;
+    
+    std::thread serverThread;
+    int clientFD = -1;
+    SSL *clientSSL = nullptr;
+    std::unique_ptr<BufferedTlsStream> stream;
+    
+    void SetUp() override {
+        std::string prefix = testing::TempDir() + "remote_core_buffered_tls_" + testing::UnitTest::GetInstance()->current_test_info()->name();
+        certificatePath = prefix + "_certificate.pem";
+        privateKeyPath = prefix + "_key.pem";
+        TestSupport::writeSelfSignedCertificate(certificatePath, privateKeyPath);
+        
+        serverConfiguration.certificatePath = certificatePath;
+        serverConfiguration.privateKeyPath = privateKeyPath;
+        serverConfiguration.isServer = true;
+        serverConfiguration.verifiesPeer = false;
+        serverContext = TlsTransport::makeContext(serverConfiguration);
+        
+        TlsConfiguration clientConfiguration;
+        clientConfiguration.rootCAPath = certificatePath;
+        clientContext = TlsTransport::makeContext(clientConfiguration);
+        
+        listenFD = StreamTransport::listenOnLoopback(0);
+    }
+    
+    void TearDown() override {
+        if (serverThread.joinable()) {
+            serverThread.join();
+        }
+        
+        stream.reset();
+        SSL_free(clientSSL);
+        if (clientFD >= 0) {
+            close(clientFD);
+        }
+        
+        close(listenFD);
+        TlsCredentialCache::removeAll();
+        std::remove(certificatePath.c_str());
+        std::remove(privateKeyPath.c_str());
+    }
+    
+    /**
+     Connects a stream to a server, which runs the handler on its own thread once its handshake is complete, and closes the connection when the handler returns.
+     */
+    void connect(bool usesReadAhead, std::function<void (TlsTransport &server)> serverHandler) {
+        serverThread = std::thread([this, serverHandler]() {
+            struct pollfd descriptor = {listenFD, POLLIN, 0};
+            if (poll(&descriptor, 1, (int)std::chrono::milliseconds(DEFAULT_TIMEOUT).count()) != 1) {
+                ADD_FAILURE() << "Timed out waiting for the connection.";
+                return;
+            }
+            
+            TlsTransport server(accept(listenFD, nullptr, nullptr), serverContext, serverConfiguration);
+            auto result = TestSupport::waitForCompletion(server.getDescriptor(), [&server]() {
+                return server.handshake();
+            }, (int)std::chrono::milliseconds(DEFAULT_TIMEOUT).count());
+            
+            if (result.status == TransportStatus::Complete) {
+                serverHandler(server);
+            }
+        });
+        
+        SocketAddress address;
+        SocketAddress::parse("127.0.0.1", StreamTransport::getLocalPort(listenFD), address);
+        clientFD = StreamTransport::startConnecting(address);
+        clientSSL = SSL_new(clientContext.get());
+        SSL_set_fd(clientSSL, clientFD);
+        
+        stream.reset(new BufferedTlsStream(clientSSL, clientFD, usesReadAhead));
+        ASSERT_EQ(stream->connect(BufferedTlsStream::Clock::now() + DEFAULT_TIMEOUT), TlsStreamStatus::Complete);
+    }
+    
+    static void writeAll(TlsTransport &server, const std::string &bytes) {
+        size_t writtenLength = 0;
+        while (writtenLength < bytes.size()) {
+            auto result = TestSupport::waitForCompletion(server.getDescriptor(), [&]() {
+                return server.write(bytes.data() + writtenLength, bytes.size() - writtenLength);
+            }, (int)std::chrono::milliseconds(DEFAULT_TIMEOUT).count());
+            
+            ASSERT_EQ(result.status, TransportStatus::Complete);
+            writtenLength += result.byteCount;
+        }
+    }
+    
+    /**
+     Reads the packets a field at a time, as the MQTT client does, and checks their contents.
+     */
+    void readPackets(int count) {
+        auto deadline = BufferedTlsStream::Clock::now() + DEFAULT_TIMEOUT;
+        for (int i = 0; i < count; i++) {
+            char type;
+            char length;
+            char payload[DEFAULT_PAYLOAD_LENGTH];
+            ASSERT_EQ(stream->read(&type, 1, deadline).status, TlsStreamStatus::Complete);
+            ASSERT_EQ(stream->read(&length, 1, deadline).status, TlsStreamStatus::Complete);
+            ASSERT_EQ(length, DEFAULT_PAYLOAD_LENGTH);
+            ASSERT_EQ(stream->read(payload, sizeof(payload), deadline).status, TlsStreamStatus::Complete);
+            EXPECT_EQ(type, (char)0x30);
+            EXPECT_EQ(std::string(payload, sizeof(payload)), std::string(DEFAULT_PAYLOAD_LENGTH, (char)('a' + i % 26)));
+        }
+    }
+};
+
+// MARK: - Tests
+
+TEST_F(BufferedTlsStreamTests, ServeSmallReadsFromBuffer) {
+    connect(true, [](TlsTransport &server) {
+        writeAll(server, makePackets(DEFAULT_PACKET_COUNT));
+    });
+    
+    readPackets(DEFAULT_PACKET_COUNT);
+    
+    // The packets were written as one record, so a few reads fetch all of them.
+    auto statistics = stream->getStatistics();
+    EXPECT_LE(statistics.sslReadCount, 10u);
+    EXPECT_GE(statistics.bufferedReadCount, DEFAULT_PACKET_COUNT * 3u - 10u);
+    EXPECT_EQ(stream->getBufferedByteCount(), 0u);
+}
+
+TEST_F(BufferedTlsStreamTests, ReadWithoutReadAhead) {
+    connect(false, [](TlsTransport &server) {
+        writeAll(server, makePackets(DEFAULT_PACKET_COUNT));
+    });
+    
+    readPackets(DEFAULT_PACKET_COUNT);
+    
+    auto statistics = stream->getStatistics();
+    EXPECT_GE(statistics.sslReadCount, DEFAULT_PACKET_COUNT * 3u);
+    EXPECT_EQ(statistics.bufferedReadCount, 0u);
+}
+
+TEST_F(BufferedTlsStreamTests, ReadLargeSpan) {
+    std::string bytes(100 * 1024, 0);
+    for (size_t i = 0; i < bytes.size(); i++) {
+        bytes[i] = (char)(i * 7);
+    }
+    
+    connect(true, [&bytes](TlsTransport &server) {
+        writeAll(server, bytes);
+    });
+    
+    // Starts with a small read, which leaves the rest of the first record in the buffer.
+    std::string readBytes(bytes.size(), 0);
+    auto deadline = BufferedTlsStream::Clock::now() + DEFAULT_TIMEOUT;
+    EXPECT_EQ(stream->read(&readBytes[0], 10, deadline).status, TlsStreamStatus::Complete);
+    
+    auto result = stream->read(&readBytes[10], bytes.size() - 10, deadline);
+    EXPECT_EQ(result.status, TlsStreamStatus::Complete);
+    EXPECT_EQ(result.byteCount, bytes.size() - 10);
+    EXPECT_EQ(readBytes, bytes);
+}
+
+TEST_F(BufferedTlsStreamTests, WriteAndReadBack) {
+    connect(true, [](TlsTransport &server) {
+        char bytes[5];
+        auto result = TestSupport::waitForCompletion(server.getDescriptor(), [&]() {
+            return server.read(bytes, sizeof(bytes));
+        }, (int)std::chrono::milliseconds(DEFAULT_TIMEOUT).count());
+        
+        ASSERT_EQ(result.status, TransportStatus::Complete);
+        writeAll(server, std::string(bytes, result.byteCount));
+    });
+    
+    auto deadline = BufferedTlsStream::Clock::now() + DEFAULT_TIMEOUT;
+    auto result = stream->write("hello", 5, deadline);
+    EXPECT_EQ(result.status, TlsStreamStatus::Complete);
+    EXPECT_EQ(result.byteCount, 5u);
+    
+    char bytes[5];
+    EXPECT_EQ(stream->read(bytes, sizeof(bytes), deadline).status, TlsStreamStatus::Complete);
+    EXPECT_EQ(std::string(bytes, sizeof(bytes)), "hello");
+}
+
+TEST_F(BufferedTlsStreamTests, ReadTimesOut) {
+    std::promise<void> isFinished;
+    auto finished = isFinished.get_future().share();
+    connect(true, [finished](TlsTransport &server) {
+        finished.wait();
+    });
+    
+    char byte;
+    auto startTime = BufferedTlsStream::Clock::now();
+    auto result = stream->read(&byte, 1, startTime + std::chrono::milliseconds(50));
+    EXPECT_EQ(result.status, TlsStreamStatus::TimedOut);
+    EXPECT_EQ(result.byteCount, 0u);
+    EXPECT_GE(BufferedTlsStream::Clock::now() - startTime, std::chrono::milliseconds(50));
+    EXPECT_GE(stream->getStatistics().readWaitCount, 1u);
+    
+    isFinished.set_value();
+}
+
+TEST_F(BufferedTlsStreamTests, ReadAfterClose) {
+    connect(true, [](TlsTransport &server) {
+        writeAll(server, "ab");
+    });
+    
+    // The bytes that were sent before the server closed the connection are still read.
+    char bytes[3];
+    auto deadline = BufferedTlsStream::Clock::now() + DEFAULT_TIMEOUT;
+    auto result = stream->read(bytes, sizeof(bytes), deadline);
+    EXPECT_EQ(result.status, TlsStreamStatus::Closed);
+    EXPECT_EQ(result.byteCount, 2u);
+    EXPECT_EQ(std::string(bytes, 2), "ab");
+}
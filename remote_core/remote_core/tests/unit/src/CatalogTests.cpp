@@ -0,0 +1,51 @@
+//
+//  CatalogTests.cpp
+//  remote_core_unit_tests
+//
+//  Created by David Moore on 10/19/26.
+//  Copyright © 2026 David Moore. All rights reserved.
+//
+
+#include <algorithm>
+#include <gtest/gtest.h>
+#include "CommandIDCatalog.hpp"
+#include "DirectiveCatalog.hpp"
+
+using namespace RemoteCore;
+
+// Lookups are usable at compile time.
+static_assert(CommandIDCatalog::table.indexOfKey("KEY_POWER", 9) >= 0, "Expected 'KEY_POWER' to be a command ID.");
+static_assert(DirectiveCatalog::table.indexOfKey("learnCommand", 12) == (long)Directive::LearnCommand, "Expected 'learnCommand' to be a directive.");
+
+TEST(CatalogTests, CommandIDsAreSorted) {
+    ASSERT_GT(CommandIDCatalog::keyCount, 0u);
+    EXPECT_TRUE(std::is_sorted(CommandIDCatalog::keys, CommandIDCatalog::keys + CommandIDCatalog::keyCount, [](const char *lhs, const char *rhs) {
+        return std::string(lhs) < std::string(rhs);
+    }));
+}
+
+TEST(CatalogTests, FindEveryCommandID) {
+    for (size_t i = 0; i < CommandIDCatalog::keyCount; i++) {
+        EXPECT_EQ(CommandIDCatalog::table.indexOfKey(CommandIDCatalog::keys[i]), (long)i);
+    }
+}
+
+TEST(CatalogTests, RejectUnknownKeys) {
+    EXPECT_EQ(CommandIDCatalog::table.indexOfKey("KEY_"), -1);
+    EXPECT_EQ(CommandIDCatalog::table.indexOfKey("KEY_POWERS"), -1);
+    EXPECT_EQ(CommandIDCatalog::table.indexOfKey(""), -1);
+    EXPECT_EQ(directiveForName("startTrainingSessions"), Directive::Unknown);
+    EXPECT_EQ(directiveForName("StartTrainingSession"), Directive::Unknown);
+}
+
+TEST(CatalogTests, DirectiveNames) {
+    EXPECT_EQ(directiveForName("startTrainingSession"), Directive::StartTrainingSession);
+    EXPECT_EQ(nameForDirective(Directive::TrainingSessionDidLearnCommand), "trainingSessionDidLearnCommand");
+    EXPECT_EQ(nameForDirective(Directive::Unknown), "");
+    
+    for (size_t i = 0; i < DirectiveCatalog::keyCount; i++) {
+        auto directive = directiveForName(DirectiveCatalog::keys[i]);
+        EXPECT_EQ((size_t)directive, i);
+        EXPECT_EQ(nameForDirective(directive), DirectiveCatalog::keys[i]);
+    }
+}
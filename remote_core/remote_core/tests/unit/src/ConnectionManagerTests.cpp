@@ -8,8 +8,16 @@
 
 #include <memory>
 #include <future>
+#include <climits>
+#include <fstream>
+#include <stdexcept>
+#include <stdlib.h>
+#include <unistd.h>
 #include <gtest/gtest.h>
 #include "ConnectionManager.hpp"
+#include "DispatchGroup.hpp"
+#include "MqttBroker.hpp"
+#include "TlsTestSupport.hpp"
 
 using namespace awsiotsdk;
 using namespace RemoteCore;
@@ -18,16 +26,98 @@ using namespace testing;
 #define DEFAULT_TIMEOUT std::chrono::seconds(15)
 #define DEFAULT_TOPIC_NAME "remote_core/tests/topic_1"
 #define ALTERNATE_TOPIC_NAME "remote_core/tests/topic_2"
+#define DEFAULT_SERVER_NAME "localhost"
 
 // MARK: - Test Fixture
 
 class ConnectionManagerTests : public testing::Test {
 protected:
+    /// Working directory the tests were started from, which is restored after each test.
+    std::string originalDirectory;
+    
+    /// Local broker that the connection manager's built-in client connects to over TLS.
+    std::unique_ptr<MqttBroker> broker;
+    
     /// Connection manager object that will be setup with the configuration file.
     std::shared_ptr<ConnectionManager> connectionManager;
     
     void SetUp() override {
-        connectionManager = std::make_shared<ConnectionManager>("config/remote_core_config.json");
+        // The configuration's paths are relative to the working directory, so each test runs in its own directory.
+        char currentDirectory[PATH_MAX];
+        ASSERT_NE(getcwd(currentDirectory, sizeof(currentDirectory)), nullptr);
+        originalDirectory = currentDirectory;
+        
+        std::string directoryTemplate = testing::TempDir() + "remote_core_connection_manager_XXXXXX";
+        ASSERT_NE(mkdtemp(&directoryTemplate[0]), nullptr);
+        ASSERT_EQ(chdir(directoryTemplate.c_str()), 0);
+        
+        // The certificate is its own root, and the broker does not ask the client for one, so it doubles as the device certificate.
+        TestSupport::writeSelfSignedCertificate("certificate.pem", "key.pem", "P-256", DEFAULT_SERVER_NAME);
+        TlsConfiguration serverConfiguration;
+        serverConfiguration.certificatePath = "certificate.pem";
+        serverConfiguration.privateKeyPath = "key.pem";
+        serverConfiguration.verifiesPeer = false;
+        broker = std::make_unique<MqttBroker>(0, serverConfiguration);
+        
+        writeConfiguration("remote_core_config.json", broker->getPort());
+        connectionManager = std::make_shared<ConnectionManager>("remote_core_config.json");
+    }
+    
+    void TearDown() override {
+        connectionManager.reset();
+        broker.reset();
+        if (!originalDirectory.empty()) {
+            EXPECT_EQ(chdir(originalDirectory.c_str()), 0);
+        }
+    }
+    
+    /**
+     Writes a configuration that uses the built-in client to connect to the local broker on the port, with MQTT 5 if 'usesMqtt5' is true.
+     */
+    static void writeConfiguration(const std::string &path, uint16_t port, bool usesMqtt5 = false) {
+        std::ofstream file(path);
+        file << R"({
+    "endpoint": ")" DEFAULT_SERVER_NAME R"(",
+    "mqtt_port": )" << port << R"(,
+    "https_port": 443,
+    "greengrass_discovery_port": 8443,
+    "root_ca_relative_path": "certificate.pem",
+    "device_certificate_relative_path": "certificate.pem",
+    "device_private_key_relative_path": "key.pem",
+    "tls_handshake_timeout_msecs": 5000,
+    "tls_read_timeout_msecs": 2000,
+    "tls_write_timeout_msecs": 2000,
+    "aws_region": "",
+    "aws_access_key_id": "",
+    "aws_secret_access_key": "",
+    "aws_session_token": "",
+    "client_id": "ConnectionManagerTests",
+    "thing_name": "ConnectionManagerTests",
+    "is_clean_session": true,
+    "mqtt_command_timeout_msecs": 5000,
+    "keepalive_interval_secs": 600,
+    "minimum_reconnect_interval_secs": 1,
+    "maximum_reconnect_interval_secs": 128,
+    "maximum_acks_to_wait_for": 32,
+    "action_processing_rate_hz": 5,
+    "use_builtin_mqtt_client": true,
+    "use_mqtt_5": )" << (usesMqtt5 ? "true" : "false") << R"(,
+    "outbox_relative_path": "outbox.bin",
+    "outbox_segment_size_bytes": 65536,
+    "outbox_segment_count": 16,
+    "outbox_replay_batch_size": 16,
+    "tls_session_cache_relative_path": "tls_sessions.bin",
+    "tls_kernel_offload": false,
+    "tls_cipher_list": "",
+    "tls_cipher_suites": "",
+    "tls_groups": "",
+    "maximum_outgoing_action_queue_length": 32,
+    "discover_action_timeout_msecs": 300000,
+    "remote_core_serial_number": "ConnectionManagerTests"
+})";
+        if (!file) {
+            throw std::runtime_error("Expected to write the configuration.");
+        }
     }
 };
 
@@ -48,28 +138,29 @@ TEST_F(ConnectionManagerTests, SubscribeToTopic) {
     ResponseCode responseCode = connectionManager->resumeConnection();
     ASSERT_EQ(responseCode, ResponseCode::MQTT_CONNACK_CONNECTION_ACCEPTED);
     
-    std::promise<void> completionHandlerPromise;
-    std::promise<void> alternateCompletionHandlerPromise;
+    // Both subscriptions complete asynchronously, so track them with a group.
+    DispatchGroup subscriptionGroup;
     
     // Subscribe to the default topic.
-    connectionManager->subscribeToTopic(DEFAULT_TOPIC_NAME, [](std::string topicName, std::string payload) {
+    subscriptionGroup.enter();
+    connectionManager->subscribeToTopic(DEFAULT_TOPIC_NAME, [](std::string topicName, std::string payload, const MqttProperties &properties) {
         return ResponseCode::SUCCESS;
-    }, [&](ResponseCode responseCode) {
+    }, [subscriptionGroup](ResponseCode responseCode) mutable {
         EXPECT_EQ(responseCode, ResponseCode::SUCCESS);
-        completionHandlerPromise.set_value();
+        subscriptionGroup.leave();
     });
     
     // Subscribe to the alternate topic.
-    connectionManager->subscribeToTopic(ALTERNATE_TOPIC_NAME, [](std::string topicName, std::string payload) {
+    subscriptionGroup.enter();
+    connectionManager->subscribeToTopic(ALTERNATE_TOPIC_NAME, [](std::string topicName, std::string payload, const MqttProperties &properties) {
         return ResponseCode::SUCCESS;
-    }, [&](ResponseCode responseCode) {
+    }, [subscriptionGroup](ResponseCode responseCode) mutable {
         EXPECT_EQ(responseCode, ResponseCode::SUCCESS);
-        alternateCompletionHandlerPromise.set_value();
+        subscriptionGroup.leave();
     });
     
-    // Wait for the futures.
-    ASSERT_EQ(completionHandlerPromise.get_future().wait_for(DEFAULT_TIMEOUT), std::future_status::ready);
-    ASSERT_EQ(alternateCompletionHandlerPromise.get_future().wait_for(DEFAULT_TIMEOUT), std::future_status::ready);
+    // Wait for both subscriptions.
+    ASSERT_TRUE(subscriptionGroup.waitFor(DEFAULT_TIMEOUT));
     
     // Check the subscribed topic names.
     auto subscribedTopicNames = connectionManager->getSubscribedTopicNames();
@@ -91,7 +182,7 @@ TEST_F(ConnectionManagerTests, UnsubscribeFromTopic) {
     std::promise<void> unsubscribePromise;
     
     // Subscribe to the default topic.
-    connectionManager->subscribeToTopic(DEFAULT_TOPIC_NAME, [](std::string topicName, std::string payload) {
+    connectionManager->subscribeToTopic(DEFAULT_TOPIC_NAME, [](std::string topicName, std::string payload, const MqttProperties &properties) {
         return ResponseCode::SUCCESS;
     }, [&](ResponseCode responseCode) {
         EXPECT_EQ(responseCode, ResponseCode::SUCCESS);
@@ -119,6 +210,46 @@ TEST_F(ConnectionManagerTests, UnsubscribeFromTopic) {
     EXPECT_EQ(responseCode, ResponseCode::SUCCESS);
 }
 
+TEST_F(ConnectionManagerTests, SubscribeToTopics) {
+    // Establish the connection.
+    ResponseCode responseCode = connectionManager->resumeConnection();
+    ASSERT_EQ(responseCode, ResponseCode::MQTT_CONNACK_CONNECTION_ACCEPTED);
+    
+    // More topics than fit in a single packet.
+    std::vector<std::string> topicNames;
+    for (int i = 0; i < CONNECTION_MANAGER_MAX_TOPICS_PER_PACKET + 3; i++) {
+        topicNames.push_back("remote_core/tests/batch/topic_" + std::to_string(i));
+    }
+    
+    // Subscribe to every topic.
+    auto subscribeFuture = connectionManager->subscribeToTopics(topicNames, [](std::string topicName, std::string payload, const MqttProperties &properties) {
+        return ResponseCode::SUCCESS;
+    });
+    ASSERT_TRUE(subscribeFuture.waitFor(DEFAULT_TIMEOUT));
+    EXPECT_EQ(subscribeFuture.get(), ResponseCode::SUCCESS);
+    EXPECT_EQ(connectionManager->getSubscribedTopicNames().size(), topicNames.size());
+    
+    // Resubscribing must not duplicate any of the topic names.
+    std::promise<ResponseCode> resubscribePromise;
+    connectionManager->resubscribeToAllTopics([&](ResponseCode responseCode) {
+        resubscribePromise.set_value(responseCode);
+    });
+    auto resubscribeFuture = resubscribePromise.get_future();
+    ASSERT_EQ(resubscribeFuture.wait_for(DEFAULT_TIMEOUT), std::future_status::ready);
+    EXPECT_EQ(resubscribeFuture.get(), ResponseCode::SUCCESS);
+    EXPECT_EQ(connectionManager->getSubscribedTopicNames(), topicNames);
+    
+    // Unsubscribe from every topic.
+    auto unsubscribeFuture = connectionManager->unsubscribeFromTopics(topicNames);
+    ASSERT_TRUE(unsubscribeFuture.waitFor(DEFAULT_TIMEOUT));
+    EXPECT_EQ(unsubscribeFuture.get(), ResponseCode::SUCCESS);
+    EXPECT_TRUE(connectionManager->getSubscribedTopicNames().empty());
+    
+    // Suspend the connection.
+    responseCode = connectionManager->suspendConnection();
+    EXPECT_EQ(responseCode, ResponseCode::SUCCESS);
+}
+
 TEST_F(ConnectionManagerTests, PublishMessageToTopic) {
     // Establish the connection.
     ResponseCode responseCode = connectionManager->resumeConnection();
@@ -133,7 +264,7 @@ TEST_F(ConnectionManagerTests, PublishMessageToTopic) {
     std::promise<void> unsubscribePromise;
     
     // Subscribe to the default topic.
-    connectionManager->subscribeToTopic(DEFAULT_TOPIC_NAME, [&](std::string topicName, std::string payload) {
+    connectionManager->subscribeToTopic(DEFAULT_TOPIC_NAME, [&](std::string topicName, std::string payload, const MqttProperties &properties) {
         EXPECT_EQ(baselinePayload, payload);
         messageHandlerPromise.set_value();
         
@@ -169,3 +300,37 @@ TEST_F(ConnectionManagerTests, PublishMessageToTopic) {
     responseCode = connectionManager->suspendConnection();
     EXPECT_EQ(responseCode, ResponseCode::SUCCESS);
 }
+
+TEST_F(ConnectionManagerTests, ReceiveMessageProperties) {
+    // Properties are only carried by MQTT 5.
+    writeConfiguration("remote_core_config.json", broker->getPort(), true);
+    connectionManager = std::make_shared<ConnectionManager>("remote_core_config.json");
+    
+    ResponseCode responseCode = connectionManager->resumeConnection();
+    ASSERT_EQ(responseCode, ResponseCode::MQTT_CONNACK_CONNECTION_ACCEPTED);
+    
+    std::promise<MqttProperties> propertiesPromise;
+    auto subscribeFuture = connectionManager->subscribeToTopic(DEFAULT_TOPIC_NAME, [&](std::string topicName, std::string payload, const MqttProperties &properties) {
+        propertiesPromise.set_value(properties);
+        return ResponseCode::SUCCESS;
+    });
+    ASSERT_TRUE(subscribeFuture.waitFor(DEFAULT_TIMEOUT));
+    ASSERT_EQ(subscribeFuture.get(), ResponseCode::SUCCESS);
+    
+    // Publish a request, which names the topic that its response is published to.
+    MqttProperties requestProperties;
+    requestProperties.responseTopic = ALTERNATE_TOPIC_NAME;
+    requestProperties.correlationData = "request-1";
+    connectionManager->publishMessageToTopic(std::string("{}"), DEFAULT_TOPIC_NAME, requestProperties, nullptr);
+    
+    auto propertiesFuture = propertiesPromise.get_future();
+    ASSERT_EQ(propertiesFuture.wait_for(DEFAULT_TIMEOUT), std::future_status::ready);
+    auto properties = propertiesFuture.get();
+    EXPECT_EQ(properties.responseTopic, ALTERNATE_TOPIC_NAME);
+    EXPECT_EQ(properties.correlationData, "request-1");
+    EXPECT_FALSE(properties.hasMessageExpiryInterval);
+    
+    // Suspend the connection.
+    responseCode = connectionManager->suspendConnection();
+    EXPECT_EQ(responseCode, ResponseCode::SUCCESS);
+}
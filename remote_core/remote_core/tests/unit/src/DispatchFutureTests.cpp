@@ -0,0 +1,115 @@
+//
+//  DispatchFutureTests.cpp
+//  remote_core_unit_tests
+//
+//  Created by David Moore on 10/19/26.
+//  Copyright © 2026 David Moore. All rights reserved.
+//
+
+#include <atomic>
+#include <future>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <gtest/gtest.h>
+#include "DispatchFuture.hpp"
+
+using namespace RemoteCore;
+
+#define DEFAULT_TIMEOUT std::chrono::seconds(5)
+
+/// Resolves the future from another thread once the delay elapses, as a completion handler would.
+static DispatchFuture<int> resolveLater(int value, std::chrono::milliseconds delay) {
+    DispatchPromise<int> promise;
+    std::thread([promise, value, delay]() mutable {
+        std::this_thread::sleep_for(delay);
+        promise.resolve(value);
+    }).detach();
+    
+    return promise.getFuture();
+}
+
+TEST(DispatchFutureTests, ResolveAndGet) {
+    DispatchPromise<std::string> promise;
+    auto future = promise.getFuture();
+    EXPECT_TRUE(future.isValid());
+    EXPECT_FALSE(future.isReady());
+    EXPECT_FALSE(future.waitFor(std::chrono::milliseconds(10)));
+    
+    promise.resolve("value");
+    EXPECT_TRUE(future.isReady());
+    EXPECT_EQ(future.get(), "value");
+    
+    EXPECT_THROW(promise.resolve("other value"), std::logic_error);
+    EXPECT_THROW(DispatchFuture<int>().get(), std::logic_error);
+}
+
+TEST(DispatchFutureTests, ThenRunsOnQueue) {
+    DispatchQueue queue("ca.mooredev.remote_core.DispatchFutureTests.serial_dispatch_queue");
+    DispatchPromise<int> promise;
+    std::promise<std::thread::id> threadPromise;
+    
+    promise.getFuture().then(queue, [&threadPromise](int value) {
+        EXPECT_EQ(value, 1);
+        threadPromise.set_value(std::this_thread::get_id());
+    });
+    
+    // The continuation runs on the queue, rather than on the resolving thread.
+    promise.resolve(1);
+    
+    auto threadFuture = threadPromise.get_future();
+    ASSERT_EQ(threadFuture.wait_for(DEFAULT_TIMEOUT), std::future_status::ready);
+    EXPECT_NE(threadFuture.get(), std::this_thread::get_id());
+}
+
+TEST(DispatchFutureTests, ChainValuesAndFutures) {
+    DispatchQueue queue("ca.mooredev.remote_core.DispatchFutureTests.serial_dispatch_queue");
+    
+    auto future = resolveLater(2, std::chrono::milliseconds(5)).then(queue, [](int value) {
+        return value * 10;
+    }).then(queue, [](int value) {
+        // Asynchronous steps are flattened, rather than nested.
+        return resolveLater(value + 1, std::chrono::milliseconds(5));
+    }).then(queue, [](int value) {
+        return std::to_string(value);
+    });
+    
+    ASSERT_TRUE(future.waitFor(DEFAULT_TIMEOUT));
+    EXPECT_EQ(future.get(), "21");
+}
+
+TEST(DispatchFutureTests, ContinuationsAfterResolution) {
+    DispatchQueue queue("ca.mooredev.remote_core.DispatchFutureTests.serial_dispatch_queue");
+    auto future = DispatchFuture<int>::resolved(7);
+    std::atomic<int> total(0);
+    DispatchGroup group;
+    
+    for (int i = 0; i < 3; i++) {
+        group.enter();
+        future.then(queue, [&total, group](int value) mutable {
+            total += value;
+            group.leave();
+        });
+    }
+    
+    ASSERT_TRUE(group.waitFor(std::chrono::milliseconds(5000)));
+    EXPECT_EQ(total, 21);
+}
+
+#ifdef DISPATCH_FUTURE_HAS_COROUTINES
+static DispatchCoroutine addLater(DispatchQueue &queue, std::promise<int> &resultPromise) {
+    int first = co_await resolveLater(1, std::chrono::milliseconds(5)).resumeOn(queue);
+    int second = co_await resolveLater(2, std::chrono::milliseconds(5)).resumeOn(queue);
+    resultPromise.set_value(first + second);
+}
+
+TEST(DispatchFutureTests, AwaitFromCoroutine) {
+    DispatchQueue queue("ca.mooredev.remote_core.DispatchFutureTests.serial_dispatch_queue");
+    std::promise<int> resultPromise;
+    addLater(queue, resultPromise);
+    
+    auto resultFuture = resultPromise.get_future();
+    ASSERT_EQ(resultFuture.wait_for(DEFAULT_TIMEOUT), std::future_status::ready);
+    EXPECT_EQ(resultFuture.get(), 3);
+}
+#endif
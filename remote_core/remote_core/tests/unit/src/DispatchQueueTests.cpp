@@ -0,0 +1,393 @@
+//
+//  DispatchQueueTests.cpp
+//  remote_core_unit_tests
+//
+//  Created by David Moore on 10/19/26.
+//  Copyright © 2026 David Moore. All rights reserved.
+//
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <functional>
+#include <future>
+#include <memory>
+#include <thread>
+#include <vector>
+#include <gtest/gtest.h>
+#include "DispatchQueue.hpp"
+
+using namespace RemoteCore;
+
+#define DEFAULT_TIMEOUT std::chrono::seconds(5)
+
+TEST(DispatchQueueTests, MoveOnlyTask) {
+    auto value = std::make_unique<int>(42);
+    int result = 0;
+    
+    DispatchTask task([value = std::move(value), &result]() {
+        result = *value;
+    });
+    
+    DispatchTask movedTask(std::move(task));
+    EXPECT_FALSE(task);
+    ASSERT_TRUE(movedTask);
+    
+    movedTask();
+    EXPECT_EQ(result, 42);
+}
+
+TEST(DispatchQueueTests, LargeTask) {
+    std::array<char, DispatchTask::inlineCapacity * 2> buffer;
+    buffer.fill('a');
+    
+    char result = 0;
+    DispatchTask task([buffer, &result]() {
+        result = buffer.back();
+    });
+    
+    DispatchTask movedTask;
+    movedTask = std::move(task);
+    movedTask();
+    EXPECT_EQ(result, 'a');
+}
+
+TEST(DispatchQueueTests, SerialExecutionOrder) {
+    DispatchQueue queue("ca.mooredev.remote_core.DispatchQueueTests.serial_dispatch_queue");
+    std::vector<int> values;
+    std::promise<void> completionPromise;
+    
+    for (int i = 0; i < 1000; i++) {
+        queue.execute([&values, i]() {
+            values.push_back(i);
+        });
+    }
+    
+    queue.execute([&completionPromise]() {
+        completionPromise.set_value();
+    });
+    
+    ASSERT_EQ(completionPromise.get_future().wait_for(DEFAULT_TIMEOUT), std::future_status::ready);
+    ASSERT_EQ(values.size(), 1000u);
+    for (int i = 0; i < 1000; i++) {
+        EXPECT_EQ(values[i], i);
+    }
+}
+
+TEST(DispatchQueueTests, SerialQueueRunsOneBlockAtATime) {
+    std::atomic<int> activeCount(0);
+    std::atomic<int> maximumActiveCount(0);
+    
+    {
+        DispatchQueue queue("ca.mooredev.remote_core.DispatchQueueTests.serial_dispatch_queue");
+        for (int i = 0; i < 200; i++) {
+            queue.execute([&]() {
+                int count = ++activeCount;
+                maximumActiveCount = std::max(maximumActiveCount.load(), count);
+                std::this_thread::yield();
+                activeCount--;
+            });
+        }
+    }
+    
+    EXPECT_EQ(maximumActiveCount, 1);
+}
+
+TEST(DispatchQueueTests, ConcurrentQueueFromManyProducers) {
+    std::atomic<int> counter(0);
+    
+    {
+        DispatchQueue queue("ca.mooredev.remote_core.DispatchQueueTests.concurrent_dispatch_queue", 4);
+        EXPECT_EQ(queue.getThreadCount(), 4u);
+        
+        std::vector<std::thread> producers;
+        for (int i = 0; i < 4; i++) {
+            producers.emplace_back([&]() {
+                for (int j = 0; j < 2500; j++) {
+                    queue.execute([&counter]() {
+                        counter++;
+                    });
+                }
+            });
+        }
+        
+        for (auto &producer : producers) {
+            producer.join();
+        }
+    }
+    
+    // Destroying the queue completes every block.
+    EXPECT_EQ(counter, 10000);
+}
+
+TEST(DispatchQueueTests, NestedExecution) {
+    DispatchQueue queue("ca.mooredev.remote_core.DispatchQueueTests.serial_dispatch_queue");
+    DispatchQueue otherQueue("ca.mooredev.remote_core.DispatchQueueTests.concurrent_dispatch_queue", 2);
+    std::promise<int> resultPromise;
+    
+    queue.execute([&]() {
+        otherQueue.execute([&]() {
+            queue.execute([&]() {
+                resultPromise.set_value(7);
+            });
+        });
+    });
+    
+    auto resultFuture = resultPromise.get_future();
+    ASSERT_EQ(resultFuture.wait_for(DEFAULT_TIMEOUT), std::future_status::ready);
+    EXPECT_EQ(resultFuture.get(), 7);
+}
+
+TEST(DispatchQueueTests, BusySerialQueuesYieldToOtherQueues) {
+    // Keep every thread of the shared pool busy with queues that always have another block to run.
+    auto threadCount = WorkStealingPool::sharedPool()->getThreadCount();
+    std::atomic_bool isRunning(true);
+    std::atomic<size_t> startedQueueCount(0);
+    std::vector<std::function<void (void)>> loops(threadCount);
+    std::vector<std::unique_ptr<DispatchQueue>> busyQueues;
+    
+    for (size_t i = 0; i < threadCount; i++) {
+        busyQueues.push_back(std::make_unique<DispatchQueue>("ca.mooredev.remote_core.DispatchQueueTests.busy_dispatch_queue_" + std::to_string(i)));
+        auto queue = busyQueues.back().get();
+        auto loop = &loops[i];
+        auto isStarted = std::make_shared<bool>(false);
+        
+        *loop = [&isRunning, &startedQueueCount, queue, loop, isStarted]() {
+            if (!*isStarted) {
+                *isStarted = true;
+                startedQueueCount++;
+            }
+            
+            if (isRunning) {
+                queue->execute(*loop);
+            }
+        };
+        
+        queue->execute(*loop);
+    }
+    
+    auto deadline = std::chrono::steady_clock::now() + DEFAULT_TIMEOUT;
+    while (startedQueueCount < threadCount && std::chrono::steady_clock::now() < deadline) {
+        std::this_thread::yield();
+    }
+    
+    // Another queue still gets a turn.
+    DispatchQueue queue("ca.mooredev.remote_core.DispatchQueueTests.serial_dispatch_queue");
+    std::promise<void> promise;
+    queue.execute([&promise]() {
+        promise.set_value();
+    });
+    
+    EXPECT_EQ(promise.get_future().wait_for(DEFAULT_TIMEOUT), std::future_status::ready);
+    
+    isRunning = false;
+    busyQueues.clear();
+}
+
+TEST(DispatchQueueTests, BlockingQueuesHaveThreadsOfTheirOwn) {
+    // Block more queues than the shared pool has threads.
+    auto threadCount = WorkStealingPool::sharedPool()->getThreadCount();
+    std::promise<void> releasePromise;
+    auto releaseFuture = releasePromise.get_future().share();
+    std::vector<std::unique_ptr<DispatchQueue>> blockingQueues;
+    
+    for (size_t i = 0; i < threadCount + 1; i++) {
+        blockingQueues.push_back(std::make_unique<DispatchQueue>("ca.mooredev.remote_core.DispatchQueueTests.blocking_dispatch_queue_" + std::to_string(i), 1, true));
+        blockingQueues.back()->execute([releaseFuture]() {
+            releaseFuture.wait();
+        });
+    }
+    
+    // Queues on the shared pool are unaffected.
+    DispatchQueue queue("ca.mooredev.remote_core.DispatchQueueTests.serial_dispatch_queue");
+    std::promise<void> promise;
+    queue.execute([&promise]() {
+        promise.set_value();
+    });
+    
+    EXPECT_EQ(promise.get_future().wait_for(DEFAULT_TIMEOUT), std::future_status::ready);
+    
+    releasePromise.set_value();
+    blockingQueues.clear();
+}
+
+TEST(DispatchQueueTests, GroupWaitAndNotify) {
+    DispatchQueue queue("ca.mooredev.remote_core.DispatchQueueTests.concurrent_dispatch_queue", 4);
+    DispatchQueue notificationQueue("ca.mooredev.remote_core.DispatchQueueTests.serial_dispatch_queue");
+    DispatchGroup group;
+    std::atomic<int> counter(0);
+    std::promise<int> notificationPromise;
+    
+    for (int i = 0; i < 100; i++) {
+        queue.execute(group, [&counter]() {
+            counter++;
+        });
+    }
+    
+    group.notify(notificationQueue, [&]() {
+        notificationPromise.set_value(counter.load());
+    });
+    
+    ASSERT_TRUE(group.waitFor(DEFAULT_TIMEOUT));
+    EXPECT_EQ(counter, 100);
+    
+    auto notificationFuture = notificationPromise.get_future();
+    ASSERT_EQ(notificationFuture.wait_for(DEFAULT_TIMEOUT), std::future_status::ready);
+    EXPECT_EQ(notificationFuture.get(), 100);
+}
+
+TEST(DispatchQueueTests, GroupEnterAndLeave) {
+    DispatchGroup group;
+    
+    // An empty group does not block.
+    group.wait();
+    EXPECT_THROW(group.leave(), std::logic_error);
+    
+    group.enter();
+    EXPECT_FALSE(group.waitFor(std::chrono::milliseconds(10)));
+    
+    std::thread thread([group]() mutable {
+        group.leave();
+    });
+    
+    group.wait();
+    thread.join();
+}
+
+TEST(DispatchQueueTests, BarrierWaitsForPriorBlocks) {
+    std::atomic<int> activeCount(0);
+    std::atomic<int> completedCount(0);
+    std::atomic<bool> didOverlapBarrier(false);
+    int completedCountAtBarrier = -1;
+    
+    {
+        DispatchQueue queue("ca.mooredev.remote_core.DispatchQueueTests.concurrent_dispatch_queue", 4);
+        auto read = [&]() {
+            activeCount++;
+            std::this_thread::sleep_for(std::chrono::microseconds(100));
+            activeCount--;
+            completedCount++;
+        };
+        
+        for (int i = 0; i < 50; i++) {
+            queue.execute(read);
+        }
+        
+        queue.executeBarrier([&]() {
+            if (activeCount.load() != 0) {
+                didOverlapBarrier = true;
+            }
+            
+            completedCountAtBarrier = completedCount.load();
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            
+            if (activeCount.load() != 0) {
+                didOverlapBarrier = true;
+            }
+        });
+        
+        for (int i = 0; i < 50; i++) {
+            queue.execute(read);
+        }
+    }
+    
+    EXPECT_FALSE(didOverlapBarrier);
+    EXPECT_EQ(completedCountAtBarrier, 50);
+    EXPECT_EQ(completedCount, 100);
+}
+
+TEST(DispatchQueueTests, ApplyRunsEveryIteration) {
+    DispatchQueue queue("ca.mooredev.remote_core.DispatchQueueTests.concurrent_dispatch_queue", 4);
+    std::vector<std::atomic<int>> counts(1000);
+    for (auto &count : counts) {
+        count = 0;
+    }
+    
+    queue.apply(counts.size(), [&counts](size_t iteration) {
+        counts[iteration]++;
+    });
+    
+    for (auto &count : counts) {
+        EXPECT_EQ(count.load(), 1);
+    }
+    
+    // Applying from one of the queue's own blocks completes, since the calling thread takes part.
+    std::promise<size_t> resultPromise;
+    queue.execute([&]() {
+        std::atomic<size_t> sum(0);
+        queue.apply(100, [&sum](size_t iteration) {
+            sum += iteration;
+        });
+        
+        resultPromise.set_value(sum.load());
+    });
+    
+    auto resultFuture = resultPromise.get_future();
+    ASSERT_EQ(resultFuture.wait_for(DEFAULT_TIMEOUT), std::future_status::ready);
+    EXPECT_EQ(resultFuture.get(), 4950u);
+}
+
+TEST(DispatchQueueTests, LatencyHistogramPercentiles) {
+    LatencyHistogram histogram;
+    EXPECT_EQ(histogram.getPercentile(0.5).count(), 0);
+    
+    for (uint64_t i = 0; i < 99; i++) {
+        histogram.record(10);
+    }
+    histogram.record(5000);
+    
+    EXPECT_EQ(histogram.count, 100u);
+    EXPECT_EQ(histogram.maximumMicroseconds, 5000u);
+    
+    // Within a factor of two of the recorded durations.
+    EXPECT_GE(histogram.getPercentile(0.5).count(), 10);
+    EXPECT_LT(histogram.getPercentile(0.5).count(), 20);
+    EXPECT_EQ(histogram.getPercentile(1.0).count(), 5000);
+    EXPECT_EQ(histogram.getMean().count(), (99 * 10 + 5000) / 100);
+}
+
+TEST(DispatchQueueTests, QueueStatistics) {
+    const std::string name = "ca.mooredev.remote_core.DispatchQueueTests.statistics_dispatch_queue";
+    DispatchQueue queue(name);
+    queue.setLongRunningBlockThreshold(std::chrono::milliseconds(5));
+    
+    std::promise<void> startPromise;
+    std::promise<void> releasePromise;
+    auto releaseFuture = releasePromise.get_future().share();
+    
+    // Hold the queue, so that the remaining blocks build up behind it.
+    queue.execute([&startPromise, releaseFuture]() {
+        startPromise.set_value();
+        releaseFuture.wait();
+    });
+    
+    ASSERT_EQ(startPromise.get_future().wait_for(DEFAULT_TIMEOUT), std::future_status::ready);
+    for (int i = 0; i < 10; i++) {
+        queue.execute([]() {});
+    }
+    
+    auto statistics = queue.getStatistics();
+    EXPECT_EQ(statistics.name, name);
+    EXPECT_EQ(statistics.enqueuedBlockCount, 11u);
+    EXPECT_EQ(statistics.currentDepth, 10u);
+    
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    releasePromise.set_value();
+    
+    DispatchGroup group;
+    queue.execute(group, []() {});
+    ASSERT_TRUE(group.waitFor(DEFAULT_TIMEOUT));
+    
+    statistics = queue.getStatistics();
+    EXPECT_EQ(statistics.currentDepth, 0u);
+    EXPECT_GE(statistics.maximumDepth, 10u);
+    EXPECT_GE(statistics.completedBlockCount, 11u);
+    EXPECT_EQ(statistics.longRunningBlockCount, 1u);
+    EXPECT_GE(statistics.executionTime.maximumMicroseconds, 10000u);
+    EXPECT_GE(statistics.waitTime.maximumMicroseconds, 10000u);
+    
+    auto allStatistics = DispatchQueue::statisticsForAllQueues();
+    EXPECT_TRUE(std::any_of(allStatistics.begin(), allStatistics.end(), [&name](const DispatchQueueStatistics &statistics) {
+        return statistics.name == name;
+    }));
+}
@@ -0,0 +1,152 @@
+//
+//  EventLoopTests.cpp
+//  remote_core_unit_tests
+//
+//  Created by David Moore on 10/19/26.
+//  Copyright © 2026 David Moore. All rights reserved.
+//
+
+#include <atomic>
+#include <thread>
+#include <gtest/gtest.h>
+#include <signal.h>
+#include <unistd.h>
+#include "EventLoop.hpp"
+
+using namespace RemoteCore;
+
+TEST(EventLoopTests, ExecuteFromAnotherThread) {
+    EventLoop eventLoop;
+    std::atomic<int> counter(0);
+    std::thread::id handlerThread;
+    
+    std::thread producer([&]() {
+        for (int i = 0; i < 100; i++) {
+            eventLoop.execute([&counter]() {
+                counter++;
+            });
+        }
+        
+        eventLoop.execute([&]() {
+            handlerThread = std::this_thread::get_id();
+            eventLoop.stop();
+        });
+    });
+    
+    eventLoop.run();
+    producer.join();
+    
+    EXPECT_EQ(counter, 100);
+    EXPECT_EQ(handlerThread, std::this_thread::get_id());
+}
+
+TEST(EventLoopTests, Timers) {
+    EventLoop eventLoop;
+    int repeatCount = 0;
+    bool didFireRemovedTimer = false;
+    
+    auto startTime = EventLoop::Clock::now();
+    auto removedTimer = eventLoop.addTimer(std::chrono::milliseconds(5), false, [&]() {
+        didFireRemovedTimer = true;
+    });
+    eventLoop.removeTimer(removedTimer);
+    
+    EventLoop::TimerIdentifier repeatingTimer = 0;
+    repeatingTimer = eventLoop.addTimer(std::chrono::milliseconds(5), true, [&]() {
+        if (++repeatCount == 3) {
+            eventLoop.removeTimer(repeatingTimer);
+        }
+    });
+    
+    eventLoop.addTimer(std::chrono::milliseconds(40), false, [&]() {
+        eventLoop.stop();
+    });
+    
+    eventLoop.run();
+    
+    EXPECT_GE(EventLoop::Clock::now() - startTime, std::chrono::milliseconds(40));
+    EXPECT_EQ(repeatCount, 3);
+    EXPECT_FALSE(didFireRemovedTimer);
+}
+
+TEST(EventLoopTests, TimerRemovedByEarlierHandler) {
+    EventLoop eventLoop;
+    bool didFireRemovedTimer = false;
+    
+    EventLoop::TimerIdentifier removedTimer = 0;
+    eventLoop.addTimer(std::chrono::milliseconds(1), false, [&]() {
+        eventLoop.removeTimer(removedTimer);
+    });
+    removedTimer = eventLoop.addTimer(std::chrono::milliseconds(2), false, [&]() {
+        didFireRemovedTimer = true;
+    });
+    eventLoop.addTimer(std::chrono::milliseconds(20), false, [&]() {
+        eventLoop.stop();
+    });
+    
+    // Both timers expire before the loop runs, so they are handled in the same pass.
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    eventLoop.run();
+    
+    EXPECT_FALSE(didFireRemovedTimer);
+}
+
+TEST(EventLoopTests, OverdueRepeatingTimerFiresOnce) {
+    EventLoop eventLoop;
+    int fireCount = 0;
+    
+    eventLoop.addTimer(std::chrono::milliseconds(20), true, [&]() {
+        if (++fireCount == 1) {
+            eventLoop.addTimer(std::chrono::milliseconds(5), false, [&]() {
+                eventLoop.stop();
+            });
+        }
+    });
+    
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    eventLoop.run();
+    
+    EXPECT_EQ(fireCount, 1);
+}
+
+TEST(EventLoopTests, DescriptorReadiness) {
+    int fds[2];
+    ASSERT_EQ(pipe(fds), 0);
+    
+    EventLoop eventLoop;
+    char receivedValue = 0;
+    eventLoop.addDescriptor(fds[0], EventLoop::Readable, [&](uint32_t events) {
+        EXPECT_TRUE(events & EventLoop::Readable);
+        ASSERT_EQ(read(fds[0], &receivedValue, 1), 1);
+        
+        eventLoop.removeDescriptor(fds[0]);
+        eventLoop.stop();
+    });
+    
+    std::thread writer([&]() {
+        char value = 'x';
+        EXPECT_EQ(write(fds[1], &value, 1), 1);
+    });
+    
+    eventLoop.run();
+    writer.join();
+    
+    EXPECT_EQ(receivedValue, 'x');
+    close(fds[0]);
+    close(fds[1]);
+}
+
+TEST(EventLoopTests, SignalHandler) {
+    EventLoop eventLoop;
+    int receivedSignal = 0;
+    
+    eventLoop.addSignalHandler(SIGUSR2, [&](int signal) {
+        receivedSignal = signal;
+        eventLoop.stop();
+    });
+    
+    raise(SIGUSR2);
+    eventLoop.run();
+    
+    EXPECT_EQ(receivedSignal, SIGUSR2);
+}
@@ -0,0 +1,132 @@
+//
+//  FlightRecorderTests.cpp
+//  remote_core_unit_tests
+//
+//  Created by David Moore on 10/19/26.
+//  Copyright © 2026 David Moore. All rights reserved.
+//
+
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <thread>
+#include <vector>
+#include <gtest/gtest.h>
+#include "FlightRecorder.hpp"
+#include "nlohmann/json.hpp"
+
+using namespace RemoteCore;
+
+// MARK: - Test Fixture
+
+class FlightRecorderTests : public ::testing::Test {
+protected:
+    std::string path;
+    
+    virtual void SetUp() {
+        path = testing::TempDir() + "remote_core_trace_" + testing::UnitTest::GetInstance()->current_test_info()->name() + ".json";
+        std::remove(path.c_str());
+    }
+    
+    virtual void TearDown() {
+        std::remove(path.c_str());
+    }
+    
+    /**
+     Writes the trace, and returns the events with the category, in the order they were written.
+     */
+    std::vector<nlohmann::json> eventsWithCategory(const std::string &category) {
+        EXPECT_TRUE(FlightRecorder::writeChromeTraceToFile(path));
+        
+        std::ifstream stream(path);
+        std::stringstream contents;
+        contents << stream.rdbuf();
+        auto trace = nlohmann::json::parse(contents.str());
+        
+        std::vector<nlohmann::json> events;
+        for (auto &event : trace["traceEvents"]) {
+            if (event["cat"] == category) {
+                events.push_back(event);
+            }
+        }
+        
+        return events;
+    }
+};
+
+// MARK: - Tests
+
+TEST_F(FlightRecorderTests, RecordInstantAndCompleteEvents) {
+    auto startTime = FlightRecorder::now();
+    FlightRecorder::recordInstant("FlightRecorderTests.events", "instant", 42);
+    {
+        TraceScope scope("FlightRecorderTests.events", "scope");
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    
+    auto events = eventsWithCategory("FlightRecorderTests.events");
+    ASSERT_EQ(events.size(), 2u);
+    
+    EXPECT_EQ(events[0]["name"], "instant");
+    EXPECT_EQ(events[0]["ph"], "i");
+    EXPECT_EQ(events[0]["args"]["value"], 42);
+    EXPECT_GE(events[0]["ts"].get<double>(), startTime / 1000);
+    
+    EXPECT_EQ(events[1]["name"], "scope");
+    EXPECT_EQ(events[1]["ph"], "X");
+    EXPECT_GE(events[1]["dur"].get<double>(), 1000.0);
+    EXPECT_EQ(events[0]["tid"], events[1]["tid"]);
+}
+
+TEST_F(FlightRecorderTests, KeepMostRecentEventsOfEachThread) {
+    const uint64_t eventCount = FLIGHT_RECORDER_EVENTS_PER_THREAD + 100;
+    std::atomic<int> finishedThreadCount(0);
+    std::vector<std::thread> threads;
+    for (int i = 0; i < 2; i++) {
+        threads.emplace_back([eventCount, &finishedThreadCount]() {
+            for (uint64_t j = 0; j < eventCount; j++) {
+                FlightRecorder::recordInstant("FlightRecorderTests.wrap", "event", j);
+            }
+            
+            // Neither thread exits until both have recorded, since the buffer of an exited thread is reused.
+            finishedThreadCount++;
+            while (finishedThreadCount < 2) {
+                std::this_thread::yield();
+            }
+        });
+    }
+    
+    for (auto &thread : threads) {
+        thread.join();
+    }
+    
+    auto events = eventsWithCategory("FlightRecorderTests.wrap");
+    ASSERT_EQ(events.size(), 2u * FLIGHT_RECORDER_EVENTS_PER_THREAD);
+    
+    // Each thread has its own row, with only its latest events, oldest first.
+    EXPECT_NE(events.front()["tid"], events.back()["tid"]);
+    for (size_t i = 0; i < events.size(); i += FLIGHT_RECORDER_EVENTS_PER_THREAD) {
+        EXPECT_EQ(events[i]["args"]["value"], eventCount - FLIGHT_RECORDER_EVENTS_PER_THREAD);
+        EXPECT_EQ(events[i + FLIGHT_RECORDER_EVENTS_PER_THREAD - 1]["args"]["value"], eventCount - 1);
+    }
+}
+
+TEST_F(FlightRecorderTests, WriteWhileRecording) {
+    std::atomic<bool> isRecording(true);
+    std::thread recorder([&isRecording]() {
+        while (isRecording) {
+            FlightRecorder::recordInstant("FlightRecorderTests.concurrent", "event", 0);
+        }
+    });
+    
+    // Events that are overwritten while being written are skipped, so the trace always parses.
+    for (int i = 0; i < 10; i++) {
+        auto events = eventsWithCategory("FlightRecorderTests.concurrent");
+        EXPECT_LE(events.size(), (size_t)FLIGHT_RECORDER_EVENTS_PER_THREAD);
+    }
+    
+    isRecording = false;
+    recorder.join();
+}
@@ -0,0 +1,229 @@
+//
+//  HostResolverTests.cpp
+//  remote_core_unit_tests
+//
+//  Created by David Moore on 10/19/26.
+//  Copyright © 2026 David Moore. All rights reserved.
+//
+
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <vector>
+#include <gtest/gtest.h>
+#include "DispatchFuture.hpp"
+#include "HostResolver.hpp"
+
+using namespace RemoteCore;
+
+#define DEFAULT_HOST "broker.example.com"
+#define DEFAULT_PORT 8883
+#define DEFAULT_TIMEOUT std::chrono::seconds(5)
+
+static SocketAddress addressWithString(const std::string &string) {
+    SocketAddress address;
+    EXPECT_TRUE(SocketAddress::parse(string, 0, address));
+    return address;
+}
+
+// MARK: - Test Fixture
+
+class HostResolverTests : public testing::Test {
+protected:
+    std::atomic<int> lookupCount;
+    HostLookup nextLookup;
+    
+    /// Lookups wait until the gate is opened.
+    std::mutex gateMutex;
+    std::condition_variable gateCondition;
+    bool isGateOpen;
+    
+    std::unique_ptr<HostResolver> resolver;
+    
+    void SetUp() override {
+        lookupCount = 0;
+        isGateOpen = true;
+        nextLookup.addresses = {addressWithString("192.0.2.1"), addressWithString("2001:db8::1")};
+        nextLookup.timeToLive = std::chrono::seconds(300);
+        
+        resolver = std::make_unique<HostResolver>([this](const std::string &host) {
+            std::unique_lock<std::mutex> lock(gateMutex);
+            gateCondition.wait(lock, [this]() {
+                return isGateOpen;
+            });
+            
+            lookupCount++;
+            return nextLookup;
+        });
+    }
+    
+    void TearDown() override {
+        setGateOpen(true);
+        resolver.reset();
+    }
+    
+    void setGateOpen(bool isOpen) {
+        std::lock_guard<std::mutex> lock(gateMutex);
+        isGateOpen = isOpen;
+        gateCondition.notify_all();
+    }
+    
+    /**
+     Resolves the host, and waits for the completion handler.
+     */
+    std::vector<SocketAddress> resolve(const std::string &host, uint16_t port, int &error) {
+        DispatchPromise<std::pair<std::vector<SocketAddress>, int>> promise;
+        resolver->resolve(host, port, [promise](const std::vector<SocketAddress> &addresses, int error) mutable {
+            promise.resolve(std::make_pair(addresses, error));
+        });
+        
+        auto future = promise.getFuture();
+        if (!future.waitFor(DEFAULT_TIMEOUT)) {
+            ADD_FAILURE() << "Timed out waiting for the host to be resolved.";
+            return {};
+        }
+        
+        error = future.get().second;
+        return future.get().first;
+    }
+};
+
+// MARK: - Tests
+
+TEST_F(HostResolverTests, ResolveNumericAddresses) {
+    int error = -1;
+    auto addresses = resolve("192.0.2.7", DEFAULT_PORT, error);
+    EXPECT_EQ(error, 0);
+    ASSERT_EQ(addresses.size(), 1u);
+    EXPECT_EQ(addresses[0].getFamily(), AF_INET);
+    EXPECT_EQ(addresses[0].getDescription(), "192.0.2.7");
+    EXPECT_EQ(addresses[0].getPort(), DEFAULT_PORT);
+    
+    addresses = resolve("2001:db8::7", DEFAULT_PORT, error);
+    ASSERT_EQ(addresses.size(), 1u);
+    EXPECT_EQ(addresses[0].getFamily(), AF_INET6);
+    EXPECT_EQ(addresses[0].getPort(), DEFAULT_PORT);
+    
+    EXPECT_EQ(lookupCount, 0);
+}
+
+TEST_F(HostResolverTests, CacheAddresses) {
+    int error = -1;
+    auto addresses = resolve(DEFAULT_HOST, DEFAULT_PORT, error);
+    EXPECT_EQ(error, 0);
+    ASSERT_EQ(addresses.size(), 2u);
+    EXPECT_EQ(addresses[0].getDescription(), "192.0.2.1");
+    EXPECT_EQ(addresses[1].getDescription(), "2001:db8::1");
+    EXPECT_EQ(addresses[1].getPort(), DEFAULT_PORT);
+    
+    // Cached addresses are given the port of each request.
+    addresses = resolve(DEFAULT_HOST, 443, error);
+    ASSERT_EQ(addresses.size(), 2u);
+    EXPECT_EQ(addresses[0].getPort(), 443);
+    
+    auto statistics = resolver->getStatistics();
+    EXPECT_EQ(lookupCount, 1);
+    EXPECT_EQ(statistics.lookupCount, 1u);
+    EXPECT_EQ(statistics.cacheHitCount, 1u);
+    
+    resolver->removeCachedAddresses(DEFAULT_HOST);
+    resolve(DEFAULT_HOST, DEFAULT_PORT, error);
+    EXPECT_EQ(lookupCount, 2);
+}
+
+TEST_F(HostResolverTests, ShareLookupInProgress) {
+    setGateOpen(false);
+    
+    std::atomic<int> completedCount(0);
+    DispatchPromise<bool> promise;
+    for (int i = 0; i < 4; i++) {
+        resolver->resolve(DEFAULT_HOST, DEFAULT_PORT, [&completedCount, promise](const std::vector<SocketAddress> &addresses, int error) mutable {
+            EXPECT_EQ(addresses.size(), 2u);
+            if (++completedCount == 4) {
+                promise.resolve(true);
+            }
+        });
+    }
+    
+    setGateOpen(true);
+    ASSERT_TRUE(promise.getFuture().waitFor(DEFAULT_TIMEOUT));
+    EXPECT_EQ(lookupCount, 1);
+}
+
+TEST_F(HostResolverTests, CacheFailures) {
+    nextLookup = HostLookup();
+    nextLookup.error = EHOSTUNREACH;
+    
+    int error = 0;
+    EXPECT_TRUE(resolve(DEFAULT_HOST, DEFAULT_PORT, error).empty());
+    EXPECT_EQ(error, EHOSTUNREACH);
+    
+    // The failure is cached, so the name is not looked up again right away.
+    EXPECT_TRUE(resolve(DEFAULT_HOST, DEFAULT_PORT, error).empty());
+    EXPECT_EQ(error, EHOSTUNREACH);
+    EXPECT_EQ(lookupCount, 1);
+    EXPECT_EQ(resolver->getStatistics().failedLookupCount, 1u);
+}
+
+TEST_F(HostResolverTests, CancelRequest) {
+    setGateOpen(false);
+    
+    std::atomic<bool> isCalled(false);
+    auto identifier = resolver->resolve(DEFAULT_HOST, DEFAULT_PORT, [&isCalled](const std::vector<SocketAddress> &addresses, int error) {
+        isCalled = true;
+    });
+    
+    EXPECT_NE(identifier, 0u);
+    resolver->cancel(identifier);
+    setGateOpen(true);
+    
+    // Requests made after the lookup completes are answered from the cache, so the cancelled handler would have been called by then.
+    int error = -1;
+    resolve(DEFAULT_HOST, DEFAULT_PORT, error);
+    EXPECT_EQ(lookupCount, 1);
+    EXPECT_FALSE(isCalled);
+}
+
+TEST_F(HostResolverTests, WaitWithTimeout) {
+    setGateOpen(false);
+    
+    int error = 0;
+    auto startTime = std::chrono::steady_clock::now();
+    auto addresses = resolver->resolve(DEFAULT_HOST, DEFAULT_PORT, std::chrono::milliseconds(50), error);
+    EXPECT_TRUE(addresses.empty());
+    EXPECT_EQ(error, ETIMEDOUT);
+    EXPECT_LT(std::chrono::steady_clock::now() - startTime, DEFAULT_TIMEOUT);
+    
+    setGateOpen(true);
+    addresses = resolver->resolve(DEFAULT_HOST, DEFAULT_PORT, DEFAULT_TIMEOUT, error);
+    EXPECT_EQ(error, 0);
+    EXPECT_EQ(addresses.size(), 2u);
+}
+
+TEST_F(HostResolverTests, InterleaveFamilies) {
+    std::vector<SocketAddress> addresses;
+    for (auto string : {"2001:db8::1", "2001:db8::2", "2001:db8::3", "192.0.2.1", "192.0.2.2"}) {
+        addresses.push_back(addressWithString(string));
+    }
+    
+    std::vector<std::string> descriptions;
+    for (auto &address : HostResolver::interleaveFamilies(addresses)) {
+        descriptions.push_back(address.getDescription());
+    }
+    
+    EXPECT_EQ(descriptions, std::vector<std::string>({"2001:db8::1", "192.0.2.1", "2001:db8::2", "192.0.2.2", "2001:db8::3"}));
+}
+
+TEST_F(HostResolverTests, LookUpLocalhost) {
+    auto lookup = HostResolver::lookUpWithSystemResolver("localhost");
+    EXPECT_EQ(lookup.error, 0);
+    ASSERT_FALSE(lookup.addresses.empty());
+    
+    for (auto &address : lookup.addresses) {
+        auto description = address.getDescription();
+        EXPECT_TRUE(description == "::1" || description.compare(0, 4, "127.") == 0) << description;
+    }
+}
@@ -0,0 +1,192 @@
+//
+//  LearningEngineTests.cpp
+//  remote_core_unit_tests
+//
+//  Created by David Moore on 10/19/26.
+//  Copyright © 2026 David Moore. All rights reserved.
+//
+
+#include <future>
+#include <sstream>
+#include <gtest/gtest.h>
+#include "LearningEngine.hpp"
+
+using namespace RemoteCore;
+
+#define DEFAULT_TIMEOUT std::chrono::seconds(5)
+
+// MARK: - Capture Generation
+
+/// Produces a recorded mode2 capture of an NEC frame, repeated 'count' times.
+static std::string necCapture(uint32_t code, int count) {
+    std::ostringstream capture;
+    capture << "Using driver default on device /dev/lirc0\n";
+    
+    for (int i = 0; i < count; i++) {
+        capture << "space 40000\n";
+        capture << "pulse 9024\nspace 4488\n";
+        for (int bit = 31; bit >= 0; bit--) {
+            capture << "pulse " << (bit % 3 == 0 ? 571 : 548) << "\n";
+            capture << "space " << (((code >> bit) & 1) ? 1682 : 561) << "\n";
+        }
+        capture << "pulse 560\n";
+    }
+    
+    capture << "timeout 120000\n";
+    
+    return capture.str();
+}
+
+/// Produces a recorded mode2 capture of an RC5 frame, repeated 'count' times.
+static std::string rc5Capture(uint16_t code, int bitCount, int count) {
+    // Convert the bits into half-bit levels, then merge equal adjacent levels.
+    std::vector<int> levels;
+    for (int bit = bitCount - 1; bit >= 0; bit--) {
+        bool isOne = (code >> bit) & 1;
+        levels.push_back(isOne ? 0 : 1);
+        levels.push_back(isOne ? 1 : 0);
+    }
+    
+    std::ostringstream capture;
+    for (int i = 0; i < count; i++) {
+        capture << "space 90000\n";
+        
+        size_t start = levels.front() == 0 ? 1 : 0;
+        for (size_t j = start; j < levels.size();) {
+            size_t k = j;
+            while (k < levels.size() && levels[k] == levels[j]) {
+                k++;
+            }
+            
+            capture << (levels[j] == 1 ? "pulse " : "space ") << (k - j) * 889 << "\n";
+            j = k;
+        }
+    }
+    
+    return capture.str();
+}
+
+static std::unique_ptr<PulseStream> streamForCapture(const std::string &capture) {
+    return std::make_unique<PulseStream>(std::make_unique<std::istringstream>(capture));
+}
+
+// MARK: - Tests
+
+TEST(LearningEngineTests, ReadCapture) {
+    auto stream = streamForCapture("Using driver default\npulse 9000\nspace 4500\ntimeout 30000\n");
+    PulseSample sample;
+    
+    ASSERT_EQ(stream->readSample(sample, std::chrono::milliseconds(0)), PulseStream::ReadResult::Success);
+    EXPECT_TRUE(sample.isPulse());
+    EXPECT_EQ(sample.duration, 9000u);
+    
+    ASSERT_EQ(stream->readSample(sample, std::chrono::milliseconds(0)), PulseStream::ReadResult::Success);
+    EXPECT_EQ(sample.type, PulseSample::Type::Space);
+    EXPECT_EQ(sample.duration, 4500u);
+    
+    ASSERT_EQ(stream->readSample(sample, std::chrono::milliseconds(0)), PulseStream::ReadResult::Success);
+    EXPECT_EQ(sample.type, PulseSample::Type::Timeout);
+    
+    EXPECT_EQ(stream->readSample(sample, std::chrono::milliseconds(0)), PulseStream::ReadResult::EndOfStream);
+}
+
+TEST(LearningEngineTests, ClusterDurations) {
+    LearningEngine engine;
+    auto centers = engine.clusterDurations({548, 1682, 571, 561, 1700, 9024});
+    
+    ASSERT_EQ(centers.size(), 3u);
+    EXPECT_NEAR(centers[0], 560, 10);
+    EXPECT_NEAR(centers[1], 1691, 10);
+    EXPECT_EQ(centers[2], 9024u);
+}
+
+TEST(LearningEngineTests, SegmentFrames) {
+    LearningEngine engine;
+    std::vector<PulseSample> samples;
+    auto stream = streamForCapture(necCapture(0x20DF10EF, 3));
+    
+    PulseSample sample;
+    while (stream->readSample(sample, std::chrono::milliseconds(0)) == PulseStream::ReadResult::Success) {
+        samples.push_back(sample);
+    }
+    
+    auto frames = engine.segmentFrames(samples);
+    ASSERT_EQ(frames.size(), 3u);
+    
+    for (auto &frame : frames) {
+        // Header, 32 bits and a trailing pulse.
+        EXPECT_EQ(frame.size(), 67u);
+    }
+}
+
+TEST(LearningEngineTests, DecodePulseDistance) {
+    LearningEngine engine;
+    std::vector<PulseSample> samples;
+    auto stream = streamForCapture(necCapture(0x20DF10EF, 1));
+    
+    PulseSample sample;
+    while (stream->readSample(sample, std::chrono::milliseconds(0)) == PulseStream::ReadResult::Success) {
+        samples.push_back(sample);
+    }
+    
+    auto frames = engine.segmentFrames(samples);
+    ASSERT_EQ(frames.size(), 1u);
+    
+    auto code = engine.decodeFrame(frames[0]);
+    EXPECT_EQ(code.protocol, PulseProtocol::PulseDistance);
+    EXPECT_EQ(code.bitCount, 32u);
+    EXPECT_EQ(code.code, 0x20DF10EFu);
+    EXPECT_EQ(code.header.pulse, 9024u);
+    EXPECT_NEAR(code.one.space, 1682, 10);
+    EXPECT_NEAR(code.zero.space, 561, 10);
+}
+
+TEST(LearningEngineTests, DecodeBiphase) {
+    LearningEngine engine;
+    std::vector<PulseSample> samples;
+    auto stream = streamForCapture(rc5Capture(0x300C, 14, 1));
+    
+    PulseSample sample;
+    while (stream->readSample(sample, std::chrono::milliseconds(0)) == PulseStream::ReadResult::Success) {
+        samples.push_back(sample);
+    }
+    
+    auto frames = engine.segmentFrames(samples);
+    ASSERT_EQ(frames.size(), 1u);
+    
+    auto code = engine.decodeFrame(frames[0]);
+    EXPECT_EQ(code.protocol, PulseProtocol::Biphase);
+    EXPECT_EQ(code.bitCount, 14u);
+    EXPECT_EQ(code.code, 0x300Cu);
+}
+
+TEST(LearningEngineTests, LearnAsynchronously) {
+    LearningEngine engine;
+    std::promise<LearningResult> resultPromise;
+    
+    engine.learnFromStreamWithCompletionHandler(streamForCapture(necCapture(0x20DF10EF, 3)), [&](LearningResult result) {
+        resultPromise.set_value(result);
+    });
+    
+    auto resultFuture = resultPromise.get_future();
+    ASSERT_EQ(resultFuture.wait_for(DEFAULT_TIMEOUT), std::future_status::ready);
+    
+    auto result = resultFuture.get();
+    EXPECT_EQ(result.error, Error::None);
+    EXPECT_EQ(result.code.code, 0x20DF10EFu);
+    EXPECT_GE(result.frameCount, 2u);
+    EXPECT_GT(result.latency.count(), 0);
+}
+
+TEST(LearningEngineTests, LearnWithoutSignal) {
+    LearningEngine engine;
+    std::promise<LearningResult> resultPromise;
+    
+    engine.learnFromStreamWithCompletionHandler(streamForCapture("timeout 120000\n"), [&](LearningResult result) {
+        resultPromise.set_value(result);
+    });
+    
+    auto resultFuture = resultPromise.get_future();
+    ASSERT_EQ(resultFuture.wait_for(DEFAULT_TIMEOUT), std::future_status::ready);
+    EXPECT_EQ(resultFuture.get().error, Error::NoSignalWhileTraining);
+}
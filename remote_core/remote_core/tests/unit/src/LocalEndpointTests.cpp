@@ -0,0 +1,136 @@
+//
+//  LocalEndpointTests.cpp
+//  remote_core_unit_tests
+//
+//  Created by David Moore on 10/19/26.
+//  Copyright © 2026 David Moore. All rights reserved.
+//
+
+#include <chrono>
+#include <memory>
+#include <unistd.h>
+#include <gtest/gtest.h>
+#include "LocalEndpoint.hpp"
+#include "MqttConnection.hpp"
+#include "TlsCredentialCache.hpp"
+#include "DispatchFuture.hpp"
+#include "TestSupport.hpp"
+#include "TlsTestSupport.hpp"
+
+using namespace RemoteCore;
+
+#define DEFAULT_TIMEOUT std::chrono::seconds(5)
+#define DEFAULT_TOPIC_NAME "remote_core/account/user/LE2RDNFR44"
+#define DEFAULT_SERVER_NAME "localhost"
+
+// MARK: - Test Fixture
+
+class LocalEndpointTests : public testing::Test {
+protected:
+    std::string certificatePath;
+    std::string privateKeyPath;
+    std::unique_ptr<LocalEndpoint> endpoint;
+    DispatchPromise<std::string> receivedMessage;
+    
+    void SetUp() override {
+        std::string prefix = testing::TempDir() + "remote_core_local_endpoint";
+        certificatePath = prefix + "_certificate.pem";
+        privateKeyPath = prefix + "_key.pem";
+        TestSupport::writeSelfSignedCertificate(certificatePath, privateKeyPath, "P-256", DEFAULT_SERVER_NAME);
+        
+        // The device and the phone share a certificate, which is also the root that each is verified against.
+        LocalEndpointOptions options;
+        options.tlsConfiguration.rootCAPath = certificatePath;
+        options.tlsConfiguration.certificatePath = certificatePath;
+        options.tlsConfiguration.privateKeyPath = privateKeyPath;
+        options.topicName = DEFAULT_TOPIC_NAME;
+        options.advertisement.instanceName = "Remote Core LE2RDNFR44";
+        options.advertisement.serviceType = LOCAL_ENDPOINT_SERVICE_TYPE;
+        options.advertisement.hostName = "remote-core-le2rdnfr44";
+        options.advertisementPort = 0;
+        
+        auto receivedMessage = this->receivedMessage;
+        endpoint = std::make_unique<LocalEndpoint>(options, [receivedMessage](const SharedBuffer &message) mutable {
+            receivedMessage.resolve(message.toString());
+        });
+    }
+    
+    void TearDown() override {
+        endpoint.reset();
+        TlsCredentialCache::removeAll();
+        unlink(certificatePath.c_str());
+        unlink(privateKeyPath.c_str());
+    }
+    
+    MqttConnectionOptions optionsWithClientID(const std::string &clientID) {
+        MqttConnectionOptions options;
+        options.host = "127.0.0.1";
+        options.port = endpoint->getPort();
+        options.clientID = clientID;
+        options.commandTimeout = std::chrono::milliseconds(2000);
+        options.reconnectsAutomatically = false;
+        options.usesTLS = true;
+        options.tlsConfiguration.rootCAPath = certificatePath;
+        options.tlsConfiguration.serverName = DEFAULT_SERVER_NAME;
+        return options;
+    }
+};
+
+// MARK: - Tests
+
+TEST_F(LocalEndpointTests, ExchangeMessagesWithPhone) {
+    ASSERT_NE(endpoint->getAdvertiser(), nullptr);
+    EXPECT_EQ(endpoint->getAdvertiser()->getService().port, endpoint->getPort());
+    
+    auto options = optionsWithClientID("phone");
+    options.tlsConfiguration.certificatePath = certificatePath;
+    options.tlsConfiguration.privateKeyPath = privateKeyPath;
+    
+    MqttConnection connection(options);
+    DispatchPromise<std::string> receivedPayload;
+    connection.setMessageHandler([receivedPayload](const std::string &topicName, const std::string &payload) mutable {
+        receivedPayload.resolve(payload);
+    });
+    
+    ASSERT_EQ(TestSupport::waitForStatus([&](MqttConnection::CompletionHandler completionHandler) {
+        connection.connect(completionHandler);
+    }), MqttStatus::Success);
+    ASSERT_EQ(TestSupport::waitForStatus([&](MqttConnection::CompletionHandler completionHandler) {
+        connection.subscribe({DEFAULT_TOPIC_NAME}, 0, completionHandler);
+    }), MqttStatus::Success);
+    
+    // Messages on other topics are not the device's.
+    EXPECT_EQ(TestSupport::waitForStatus([&](MqttConnection::CompletionHandler completionHandler) {
+        connection.publish({"remote_core/account/user/other", "{\"type\":1}", 1, completionHandler});
+    }), MqttStatus::Success);
+    EXPECT_EQ(TestSupport::waitForStatus([&](MqttConnection::CompletionHandler completionHandler) {
+        connection.publish({DEFAULT_TOPIC_NAME, "{\"type\":2}", 1, completionHandler});
+    }), MqttStatus::Success);
+    
+    auto messageFuture = receivedMessage.getFuture();
+    ASSERT_TRUE(messageFuture.waitFor(DEFAULT_TIMEOUT));
+    EXPECT_EQ(messageFuture.get(), "{\"type\":2}");
+    
+    // The phone's own message is delivered back to it, as the IoT Core would, and is followed by the device's.
+    auto payloadFuture = receivedPayload.getFuture();
+    ASSERT_TRUE(payloadFuture.waitFor(DEFAULT_TIMEOUT));
+    EXPECT_EQ(payloadFuture.get(), "{\"type\":2}");
+    
+    DispatchPromise<std::string> responsePayload;
+    connection.setMessageHandler([responsePayload](const std::string &topicName, const std::string &payload) mutable {
+        responsePayload.resolve(payload);
+    });
+    
+    endpoint->publishMessage(std::string("{\"type\":3}"));
+    auto responseFuture = responsePayload.getFuture();
+    ASSERT_TRUE(responseFuture.waitFor(DEFAULT_TIMEOUT));
+    EXPECT_EQ(responseFuture.get(), "{\"type\":3}");
+}
+
+TEST_F(LocalEndpointTests, RejectPhoneWithoutCertificate) {
+    MqttConnection connection(optionsWithClientID("stranger"));
+    EXPECT_NE(TestSupport::waitForStatus([&](MqttConnection::CompletionHandler completionHandler) {
+        connection.connect(completionHandler);
+    }), MqttStatus::Success);
+    EXPECT_FALSE(connection.isConnected());
+}
@@ -0,0 +1,152 @@
+//
+//  MessageOutboxTests.cpp
+//  remote_core_unit_tests
+//
+//  Created by David Moore on 10/19/26.
+//  Copyright © 2026 David Moore. All rights reserved.
+//
+
+#include <cstdio>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <gtest/gtest.h>
+#include "MessageOutbox.hpp"
+
+using namespace RemoteCore;
+
+#define DEFAULT_TOPIC_NAME "remote_core/tests/topic_1"
+
+// MARK: - Test Fixture
+
+class MessageOutboxTests : public testing::Test {
+protected:
+    std::string path;
+    
+    void SetUp() override {
+        path = testing::TempDir() + "remote_core_outbox_" + testing::UnitTest::GetInstance()->current_test_info()->name();
+        std::remove(path.c_str());
+    }
+    
+    void TearDown() override {
+        std::remove(path.c_str());
+    }
+};
+
+// MARK: - Tests
+
+TEST_F(MessageOutboxTests, AppendPeekAndRemove) {
+    MessageOutbox outbox(path, 256, 4);
+    EXPECT_TRUE(outbox.isEmpty());
+    
+    for (int i = 0; i < 3; i++) {
+        ASSERT_TRUE(outbox.append(DEFAULT_TOPIC_NAME, "message_" + std::to_string(i)));
+    }
+    
+    auto messages = outbox.peek(2);
+    ASSERT_EQ(messages.size(), 2u);
+    EXPECT_EQ(messages[0].topicName, DEFAULT_TOPIC_NAME);
+    EXPECT_EQ(messages[0].payload, "message_0");
+    EXPECT_EQ(messages[1].payload, "message_1");
+    
+    // Peeking does not remove anything.
+    EXPECT_EQ(outbox.getCount(), 3u);
+    
+    outbox.remove(messages.back().endOffset);
+    EXPECT_EQ(outbox.getCount(), 1u);
+    
+    messages = outbox.peek(8);
+    ASSERT_EQ(messages.size(), 1u);
+    EXPECT_EQ(messages[0].payload, "message_2");
+    
+    outbox.remove(messages.back().endOffset);
+    EXPECT_TRUE(outbox.isEmpty());
+    EXPECT_EQ(outbox.getStatistics().removedCount, 3u);
+}
+
+TEST_F(MessageOutboxTests, PersistAcrossRestarts) {
+    {
+        MessageOutbox outbox(path, 256, 4);
+        for (int i = 0; i < 5; i++) {
+            ASSERT_TRUE(outbox.append(DEFAULT_TOPIC_NAME, std::to_string(i)));
+        }
+        
+        outbox.remove(outbox.peek(2).back().endOffset);
+    }
+    
+    MessageOutbox outbox(path, 256, 4);
+    auto messages = outbox.peek(8);
+    ASSERT_EQ(messages.size(), 3u);
+    EXPECT_EQ(messages[0].payload, "2");
+    EXPECT_EQ(messages[2].payload, "4");
+}
+
+TEST_F(MessageOutboxTests, DiscardOldestSegmentWhenFull) {
+    MessageOutbox outbox(path, 256, 4);
+    std::string payload(80, 'x');
+    
+    // Two messages fit in a segment, so the ring holds eight of them.
+    for (int i = 0; i < 20; i++) {
+        ASSERT_TRUE(outbox.append(DEFAULT_TOPIC_NAME, payload + std::to_string(i)));
+    }
+    
+    auto statistics = outbox.getStatistics();
+    EXPECT_EQ(statistics.appendedCount, 20u);
+    EXPECT_EQ(statistics.droppedCount + outbox.getCount(), 20u);
+    EXPECT_LE(outbox.getCount(), 8u);
+    
+    // The newest messages are kept, in order.
+    auto messages = outbox.peek(20);
+    ASSERT_EQ(messages.size(), outbox.getCount());
+    for (size_t i = 0; i < messages.size(); i++) {
+        EXPECT_EQ(messages[i].payload, payload + std::to_string(20 - messages.size() + i));
+    }
+}
+
+TEST_F(MessageOutboxTests, RejectOversizedMessage) {
+    MessageOutbox outbox(path, 256, 4);
+    EXPECT_FALSE(outbox.append(DEFAULT_TOPIC_NAME, std::string(256, 'x')));
+    EXPECT_TRUE(outbox.isEmpty());
+    EXPECT_EQ(outbox.getStatistics().rejectedCount, 1u);
+    
+    EXPECT_THROW(MessageOutbox(path, 100, 4), std::logic_error);
+    EXPECT_THROW(MessageOutbox(path, 256, 1), std::logic_error);
+}
+
+TEST_F(MessageOutboxTests, DiscardDamagedRecords) {
+    {
+        MessageOutbox outbox(path, 256, 4);
+        for (int i = 0; i < 3; i++) {
+            ASSERT_TRUE(outbox.append("t", "payload" + std::to_string(i)));
+        }
+    }
+    
+    // Each record is a 16 byte header and a 9 byte body, aligned to 32 bytes, after the 4096 byte file header. Damage the second record's body.
+    {
+        std::fstream file(path, std::ios::in | std::ios::out | std::ios::binary);
+        file.seekp(4096 + 32 + 16 + 4);
+        file.put('!');
+    }
+    
+    MessageOutbox outbox(path, 256, 4);
+    auto messages = outbox.peek(8);
+    ASSERT_EQ(messages.size(), 1u);
+    EXPECT_EQ(messages[0].payload, "payload0");
+    
+    // Appending continues from the last valid record.
+    ASSERT_TRUE(outbox.append("t", "payload3"));
+    messages = outbox.peek(8);
+    ASSERT_EQ(messages.size(), 2u);
+    EXPECT_EQ(messages[1].payload, "payload3");
+}
+
+TEST_F(MessageOutboxTests, DiscardIncompatibleFile) {
+    {
+        MessageOutbox outbox(path, 256, 4);
+        ASSERT_TRUE(outbox.append(DEFAULT_TOPIC_NAME, "message"));
+    }
+    
+    MessageOutbox outbox(path, 512, 4);
+    EXPECT_TRUE(outbox.isEmpty());
+    EXPECT_EQ(outbox.getCapacity(), 2048u);
+}
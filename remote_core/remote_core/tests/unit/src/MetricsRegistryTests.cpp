@@ -0,0 +1,145 @@
+//
+//  MetricsRegistryTests.cpp
+//  remote_core_unit_tests
+//
+//  Created by David Moore on 10/19/26.
+//  Copyright © 2026 David Moore. All rights reserved.
+//
+
+#include <atomic>
+#include <cstdio>
+#include <fstream>
+#include <memory>
+#include <sstream>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+#include <gtest/gtest.h>
+#include "DispatchFuture.hpp"
+#include "DispatchGroup.hpp"
+#include "MetricsExporter.hpp"
+#include "nlohmann/json.hpp"
+
+using namespace RemoteCore;
+
+TEST(MetricsRegistryTests, RegisterMetrics) {
+    MetricsRegistry registry;
+    auto &successes = registry.counter("published_total", "Published.", {{"result", "success"}});
+    auto &failures = registry.counter("published_total", "Published.", {{"result", "failure"}});
+    
+    // Looking a metric up again returns the same one.
+    EXPECT_EQ(&successes, &registry.counter("published_total", "Published.", {{"result", "success"}}));
+    EXPECT_NE(&successes, &failures);
+    
+    EXPECT_THROW(registry.gauge("published_total", "Published."), std::logic_error);
+    EXPECT_THROW(registry.counter("0_published", "Published."), std::logic_error);
+    EXPECT_THROW(registry.counter("published-total", "Published."), std::logic_error);
+}
+
+TEST(MetricsRegistryTests, RecordFromManyThreads) {
+    MetricsRegistry registry;
+    auto &counter = registry.counter("events_total", "Events.");
+    auto &gauge = registry.gauge("in_flight", "In flight.");
+    auto &histogram = registry.histogram("latency_seconds", "Latency.");
+    
+    std::vector<std::thread> threads;
+    for (int i = 0; i < 4; i++) {
+        threads.emplace_back([&]() {
+            for (int j = 0; j < 1000; j++) {
+                counter.increment();
+                gauge.add(1);
+                histogram.record(std::chrono::microseconds(j));
+                gauge.add(-1);
+            }
+        });
+    }
+    
+    for (auto &thread : threads) {
+        thread.join();
+    }
+    
+    EXPECT_EQ(counter.getValue(), 4000u);
+    EXPECT_EQ(gauge.getValue(), 0);
+    
+    auto snapshot = histogram.getSnapshot();
+    EXPECT_EQ(snapshot.count, 4000u);
+    EXPECT_EQ(snapshot.maximumMicroseconds, 999u);
+}
+
+TEST(MetricsRegistryTests, FormatPrometheusText) {
+    MetricsRegistry registry;
+    registry.counter("requests_total", "Requests, by \"path\".", {{"path", "a\"b\\c"}}).increment(3);
+    registry.gauge("depth", "Depth.").set(-2);
+    
+    auto &histogram = registry.histogram("latency_seconds", "Latency.");
+    histogram.record(std::chrono::microseconds(0));
+    histogram.record(std::chrono::microseconds(3));
+    histogram.record(std::chrono::microseconds(1500000));
+    
+    auto text = MetricsRegistry::formatPrometheusText(registry.collect());
+    
+    // Families are sorted by name, and label values are escaped.
+    EXPECT_LT(text.find("# TYPE depth gauge\ndepth -2\n"), text.find("# TYPE latency_seconds histogram\n"));
+    EXPECT_LT(text.find("# TYPE latency_seconds histogram\n"), text.find("# TYPE requests_total counter\n"));
+    EXPECT_NE(text.find("requests_total{path=\"a\\\"b\\\\c\"} 3\n"), std::string::npos);
+    
+    // Buckets are cumulative and in seconds: zero is below one microsecond, three below four microseconds.
+    EXPECT_NE(text.find("latency_seconds_bucket{le=\"1e-06\"} 1\n"), std::string::npos);
+    EXPECT_NE(text.find("latency_seconds_bucket{le=\"2e-06\"} 1\n"), std::string::npos);
+    EXPECT_NE(text.find("latency_seconds_bucket{le=\"4e-06\"} 2\n"), std::string::npos);
+    EXPECT_NE(text.find("latency_seconds_bucket{le=\"1.048576\"} 2\n"), std::string::npos);
+    EXPECT_NE(text.find("latency_seconds_bucket{le=\"2.097152\"} 3\n"), std::string::npos);
+    EXPECT_NE(text.find("latency_seconds_bucket{le=\"+Inf\"} 3\n"), std::string::npos);
+    EXPECT_NE(text.find("latency_seconds_sum 1.500003\n"), std::string::npos);
+    EXPECT_NE(text.find("latency_seconds_count 3\n"), std::string::npos);
+}
+
+TEST(MetricsRegistryTests, CollectDispatchStatistics) {
+    auto &registry = MetricsRegistry::sharedRegistry();
+    {
+        DispatchQueue queue("ca.mooredev.remote_core.MetricsRegistryTests.serial_dispatch_queue");
+        DispatchGroup group;
+        queue.execute(group, []() {});
+        group.wait();
+        
+        auto text = MetricsRegistry::formatPrometheusText(registry.collect());
+        EXPECT_NE(text.find("remote_core_dispatch_enqueued_blocks_total{queue=\"ca.mooredev.remote_core.MetricsRegistryTests.serial_dispatch_queue\"} 1\n"), std::string::npos);
+    }
+    
+    // Queues are no longer collected once they have been destroyed.
+    auto text = MetricsRegistry::formatPrometheusText(registry.collect());
+    EXPECT_EQ(text.find("MetricsRegistryTests"), std::string::npos);
+}
+
+TEST(MetricsRegistryTests, ExportToFileAndHandler) {
+    MetricsRegistry registry;
+    registry.counter("events_total", "Events.").increment(2);
+    registry.histogram("latency_seconds", "Latency.").record(std::chrono::microseconds(10));
+    
+    auto path = testing::TempDir() + "remote_core_metrics_" + testing::UnitTest::GetInstance()->current_test_info()->name() + ".prom";
+    std::remove(path.c_str());
+    
+    DispatchPromise<std::string> promise;
+    auto isResolved = std::make_shared<std::atomic<bool>>(false);
+    {
+        // Only the first export is checked, since the exporter keeps going until it is destroyed.
+        MetricsExporter exporter(registry, path, std::chrono::milliseconds(10), [promise, isResolved](std::string json) mutable {
+            if (!isResolved->exchange(true)) {
+                promise.resolve(json);
+            }
+        });
+        exporter.start();
+        
+        auto json = nlohmann::json::parse(promise.getFuture().get());
+        EXPECT_EQ(json["events_total"], 2);
+        EXPECT_EQ(json["latency_seconds"]["count"], 1);
+        EXPECT_EQ(json["latency_seconds"]["max_us"], 10);
+    }
+    
+    std::ifstream stream(path);
+    std::stringstream contents;
+    contents << stream.rdbuf();
+    EXPECT_NE(contents.str().find("events_total 2\n"), std::string::npos);
+    
+    std::remove(path.c_str());
+}
@@ -0,0 +1,584 @@
+//
+//  MqttConnectionTests.cpp
+//  remote_core_unit_tests
+//
+//  Created by David Moore on 10/19/26.
+//  Copyright © 2026 David Moore. All rights reserved.
+//
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <gtest/gtest.h>
+#include "MqttBroker.hpp"
+#include "MqttConnection.hpp"
+#include "SocketAddress.hpp"
+#include "TlsCredentialCache.hpp"
+#include "DispatchFuture.hpp"
+#include "DispatchGroup.hpp"
+#include "TestSupport.hpp"
+#include "TlsTestSupport.hpp"
+
+using namespace RemoteCore;
+
+#define DEFAULT_TIMEOUT std::chrono::seconds(5)
+#define DEFAULT_TOPIC_NAME "remote_core/tests/topic_1"
+#define DEFAULT_SERVER_NAME "localhost"
+
+// MARK: - Test Fixture
+
+/**
+ TCP transport whose next write can be made to ask for a read first, as TLS does while it processes a key update.
+ */
+class ReadFirstTransport : public TcpTransport {
+    std::shared_ptr<std::atomic<bool>> wantsReadBeforeWrite;
+
+public:
+    ReadFirstTransport(int fd, std::shared_ptr<std::atomic<bool>> wantsReadBeforeWrite) : TcpTransport(fd), wantsReadBeforeWrite(wantsReadBeforeWrite) {}
+    
+    TransportResult writeVector(const struct iovec *vectors, size_t count) override {
+        if (wantsReadBeforeWrite->exchange(false)) {
+            return TransportResult(TransportStatus::WantRead);
+        }
+        
+        return TcpTransport::writeVector(vectors, count);
+    }
+};
+
+/**
+ Accepts a single MQTT 5 client on the loopback interface, and lets the test read every packet the client sends, and choose the answers, so that limits which 'MqttBroker' does not impose can be tested.
+ */
+class ScriptedBroker {
+    int listenFD;
+    int fd;
+    uint16_t port;
+    MqttPacketParser parser;
+
+public:
+    ScriptedBroker() : fd(-1) {
+        SocketAddress address;
+        SocketAddress::parse("127.0.0.1", 0, address);
+        listenFD = socket(AF_INET, SOCK_STREAM, 0);
+        EXPECT_EQ(bind(listenFD, (struct sockaddr *)&address.storage, address.length), 0);
+        EXPECT_EQ(getsockname(listenFD, (struct sockaddr *)&address.storage, &address.length), 0);
+        EXPECT_EQ(listen(listenFD, 1), 0);
+        port = address.getPort();
+        parser.setProtocolLevel(MQTT_5_PROTOCOL_LEVEL);
+    }
+    
+    ~ScriptedBroker() {
+        if (fd >= 0) {
+            close(fd);
+        }
+        
+        close(listenFD);
+    }
+    
+    uint16_t getPort(void) const {
+        return port;
+    }
+    
+    /**
+     Accepts the client's connection, waits for its CONNECT packet, and answers with the CONNACK packet.
+     */
+    bool accept(const MqttPacket &connectAcknowledgement) {
+        struct pollfd descriptor = {listenFD, POLLIN, 0};
+        if (poll(&descriptor, 1, (int)std::chrono::milliseconds(DEFAULT_TIMEOUT).count()) != 1) {
+            return false;
+        }
+        
+        fd = ::accept(listenFD, nullptr, nullptr);
+        MqttPacket connect;
+        if (fd < 0 || !nextPacket(connect, DEFAULT_TIMEOUT) || connect.type != MqttPacketType::Connect) {
+            return false;
+        }
+        
+        send(connectAcknowledgement);
+        return true;
+    }
+    
+    /**
+     Returns false if the client sends no packet within the timeout.
+     */
+    bool nextPacket(MqttPacket &packet, std::chrono::milliseconds timeout) {
+        auto deadline = std::chrono::steady_clock::now() + timeout;
+        while (!parser.nextPacket(packet)) {
+            auto remaining = std::chrono::duration_cast<std::chrono::milliseconds>(deadline - std::chrono::steady_clock::now());
+            struct pollfd descriptor = {fd, POLLIN, 0};
+            if (remaining.count() <= 0 || poll(&descriptor, 1, (int)remaining.count()) != 1) {
+                return false;
+            }
+            
+            char buffer[4096];
+            ssize_t length = recv(fd, buffer, sizeof(buffer), 0);
+            if (length <= 0) {
+                return false;
+            }
+            
+            parser.append(buffer, (size_t)length);
+        }
+        
+        return true;
+    }
+    
+    void send(MqttPacket packet) {
+        packet.protocolLevel = MQTT_5_PROTOCOL_LEVEL;
+        std::string buffer;
+        packet.encode(buffer);
+        EXPECT_EQ(::send(fd, buffer.data(), buffer.size(), MSG_NOSIGNAL), (ssize_t)buffer.size());
+    }
+};
+
+class MqttConnectionTests : public testing::Test {
+protected:
+    std::unique_ptr<MqttBroker> broker;
+    
+    void SetUp() override {
+        broker = std::make_unique<MqttBroker>();
+    }
+    
+    MqttConnectionOptions optionsWithClientID(const std::string &clientID) {
+        MqttConnectionOptions options;
+        options.host = "127.0.0.1";
+        options.port = broker->getPort();
+        options.clientID = clientID;
+        options.commandTimeout = std::chrono::milliseconds(2000);
+        options.minimumReconnectInterval = std::chrono::milliseconds(10);
+        return options;
+    }
+};
+
+// MARK: - Tests
+
+TEST_F(MqttConnectionTests, PublishAndReceive) {
+    MqttConnection connection(optionsWithClientID("subscriber"));
+    DispatchPromise<std::string> receivedPayload;
+    connection.setMessageHandler([receivedPayload](const std::string &topicName, const std::string &payload) mutable {
+        EXPECT_EQ(topicName, DEFAULT_TOPIC_NAME);
+        receivedPayload.resolve(payload);
+    });
+    
+    ASSERT_EQ(TestSupport::waitForStatus([&](MqttConnection::CompletionHandler completionHandler) {
+        connection.connect(completionHandler);
+    }), MqttStatus::Success);
+    EXPECT_TRUE(connection.isConnected());
+    
+    ASSERT_EQ(TestSupport::waitForStatus([&](MqttConnection::CompletionHandler completionHandler) {
+        connection.subscribe({"remote_core/tests/#"}, 1, completionHandler);
+    }), MqttStatus::Success);
+    
+    EXPECT_EQ(TestSupport::waitForStatus([&](MqttConnection::CompletionHandler completionHandler) {
+        connection.publish({DEFAULT_TOPIC_NAME, "{\"value\":1}", 1, completionHandler});
+    }), MqttStatus::Success);
+    
+    auto payloadFuture = receivedPayload.getFuture();
+    ASSERT_TRUE(payloadFuture.waitFor(DEFAULT_TIMEOUT));
+    EXPECT_EQ(payloadFuture.get(), "{\"value\":1}");
+    
+    EXPECT_EQ(TestSupport::waitForStatus([&](MqttConnection::CompletionHandler completionHandler) {
+        connection.unsubscribe({"remote_core/tests/#"}, completionHandler);
+    }), MqttStatus::Success);
+    
+    EXPECT_EQ(TestSupport::waitForStatus([&](MqttConnection::CompletionHandler completionHandler) {
+        connection.disconnect(completionHandler);
+    }), MqttStatus::Success);
+    EXPECT_FALSE(connection.isConnected());
+    
+    // Nothing can be sent once disconnected, rather than waiting for a connection that will not return.
+    EXPECT_EQ(TestSupport::waitForStatus([&](MqttConnection::CompletionHandler completionHandler) {
+        connection.publish({DEFAULT_TOPIC_NAME, "", 1, completionHandler});
+    }), MqttStatus::NotConnected);
+}
+
+TEST_F(MqttConnectionTests, PublishAndReceiveOverTls) {
+    std::string prefix = testing::TempDir() + "remote_core_mqtt_connection_tls";
+    std::string certificatePath = prefix + "_certificate.pem";
+    std::string privateKeyPath = prefix + "_key.pem";
+    TestSupport::writeSelfSignedCertificate(certificatePath, privateKeyPath, "P-256", DEFAULT_SERVER_NAME);
+    
+    TlsConfiguration serverConfiguration;
+    serverConfiguration.certificatePath = certificatePath;
+    serverConfiguration.privateKeyPath = privateKeyPath;
+    serverConfiguration.verifiesPeer = false;
+    broker = std::make_unique<MqttBroker>(0, serverConfiguration);
+    EXPECT_TRUE(broker->usesTLS());
+    
+    auto options = optionsWithClientID("tls");
+    options.usesTLS = true;
+    options.tlsConfiguration.rootCAPath = certificatePath;
+    options.tlsConfiguration.serverName = DEFAULT_SERVER_NAME;
+    
+    MqttConnection connection(options);
+    DispatchPromise<std::string> receivedPayload;
+    connection.setMessageHandler([receivedPayload](const std::string &topicName, const std::string &payload) mutable {
+        receivedPayload.resolve(payload);
+    });
+    
+    ASSERT_EQ(TestSupport::waitForStatus([&](MqttConnection::CompletionHandler completionHandler) {
+        connection.connect(completionHandler);
+    }), MqttStatus::Success);
+    ASSERT_EQ(TestSupport::waitForStatus([&](MqttConnection::CompletionHandler completionHandler) {
+        connection.subscribe({DEFAULT_TOPIC_NAME}, 1, completionHandler);
+    }), MqttStatus::Success);
+    EXPECT_EQ(TestSupport::waitForStatus([&](MqttConnection::CompletionHandler completionHandler) {
+        connection.publish({DEFAULT_TOPIC_NAME, "{\"value\":2}", 1, completionHandler});
+    }), MqttStatus::Success);
+    
+    auto payloadFuture = receivedPayload.getFuture();
+    ASSERT_TRUE(payloadFuture.waitFor(DEFAULT_TIMEOUT));
+    EXPECT_EQ(payloadFuture.get(), "{\"value\":2}");
+    
+    // A client that does not speak TLS never gets an acknowledgement.
+    auto plainOptions = optionsWithClientID("plain");
+    plainOptions.commandTimeout = std::chrono::milliseconds(200);
+    plainOptions.reconnectsAutomatically = false;
+    MqttConnection plainConnection(plainOptions);
+    EXPECT_NE(TestSupport::waitForStatus([&](MqttConnection::CompletionHandler completionHandler) {
+        plainConnection.connect(completionHandler);
+    }), MqttStatus::Success);
+    
+    TlsCredentialCache::removeAll();
+    unlink(certificatePath.c_str());
+    unlink(privateKeyPath.c_str());
+}
+
+TEST_F(MqttConnectionTests, CoalesceBatchedPublishes) {
+    MqttConnection connection(optionsWithClientID("publisher"));
+    ASSERT_EQ(TestSupport::waitForStatus([&](MqttConnection::CompletionHandler completionHandler) {
+        connection.connect(completionHandler);
+    }), MqttStatus::Success);
+    
+    auto statistics = connection.getStatistics();
+    
+    DispatchGroup group;
+    std::atomic<int> successCount(0);
+    std::vector<MqttConnection::OutboundMessage> messages;
+    for (int i = 0; i < 64; i++) {
+        group.enter();
+        messages.push_back({DEFAULT_TOPIC_NAME, std::to_string(i), 1, [group, &successCount](MqttStatus status) mutable {
+            if (status == MqttStatus::Success) {
+                successCount++;
+            }
+            
+            group.leave();
+        }});
+    }
+    
+    connection.publish(std::move(messages));
+    ASSERT_TRUE(group.waitFor(DEFAULT_TIMEOUT));
+    EXPECT_EQ(successCount, 64);
+    
+    // The batch is encoded into one buffer, so it takes far fewer writes than packets.
+    auto batchStatistics = connection.getStatistics();
+    EXPECT_EQ(batchStatistics.sentPacketCount - statistics.sentPacketCount, 64u);
+    EXPECT_LT(batchStatistics.writeCount - statistics.writeCount, 8u);
+    EXPECT_EQ(broker->getStatistics().receivedPublishCount, 64u);
+}
+
+TEST_F(MqttConnectionTests, ReconnectAfterConnectionLoss) {
+    MqttConnection connection(optionsWithClientID("reconnecting"));
+    std::atomic<int> receivedCount(0);
+    connection.setMessageHandler([&receivedCount](const std::string &topicName, const std::string &payload) {
+        receivedCount++;
+    });
+    
+    // Subscriptions are restored by the handler, since the broker does not keep sessions.
+    std::mutex mutex;
+    std::vector<DispatchPromise<bool>> connectionPromises(2);
+    std::atomic<int> connectionCount(0);
+    connection.setConnectionHandler([&](bool isConnected, bool isSessionPresent) {
+        if (!isConnected) {
+            return;
+        }
+        
+        int index = connectionCount++;
+        connection.subscribe({DEFAULT_TOPIC_NAME}, 1, [&, index](MqttStatus status) {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (index < 2) {
+                connectionPromises[index].resolve(status == MqttStatus::Success);
+            }
+        });
+    });
+    
+    ASSERT_EQ(TestSupport::waitForStatus([&](MqttConnection::CompletionHandler completionHandler) {
+        connection.connect(completionHandler);
+    }), MqttStatus::Success);
+    
+    auto firstSubscription = connectionPromises[0].getFuture();
+    ASSERT_TRUE(firstSubscription.waitFor(DEFAULT_TIMEOUT));
+    EXPECT_TRUE(firstSubscription.get());
+    
+    broker->dropConnections();
+    
+    auto secondSubscription = connectionPromises[1].getFuture();
+    ASSERT_TRUE(secondSubscription.waitFor(DEFAULT_TIMEOUT));
+    EXPECT_TRUE(secondSubscription.get());
+    EXPECT_EQ(connection.getStatistics().reconnectCount, 1u);
+    
+    EXPECT_EQ(TestSupport::waitForStatus([&](MqttConnection::CompletionHandler completionHandler) {
+        connection.publish({DEFAULT_TOPIC_NAME, "after", 1, completionHandler});
+    }), MqttStatus::Success);
+    EXPECT_EQ(broker->getStatistics().acceptedConnectionCount, 2u);
+}
+
+TEST_F(MqttConnectionTests, RetryWriteAfterRead) {
+    auto wantsReadBeforeWrite = std::make_shared<std::atomic<bool>>(false);
+    auto options = optionsWithClientID("reading");
+    options.transportFactory = [wantsReadBeforeWrite](int fd) {
+        return std::make_unique<ReadFirstTransport>(fd, wantsReadBeforeWrite);
+    };
+    
+    MqttConnection connection(options);
+    ASSERT_EQ(TestSupport::waitForStatus([&](MqttConnection::CompletionHandler completionHandler) {
+        connection.connect(completionHandler);
+    }), MqttStatus::Success);
+    ASSERT_EQ(TestSupport::waitForStatus([&](MqttConnection::CompletionHandler completionHandler) {
+        connection.subscribe({DEFAULT_TOPIC_NAME}, 0, completionHandler);
+    }), MqttStatus::Success);
+    
+    MqttConnection sender(optionsWithClientID("sender"));
+    ASSERT_EQ(TestSupport::waitForStatus([&](MqttConnection::CompletionHandler completionHandler) {
+        sender.connect(completionHandler);
+    }), MqttStatus::Success);
+    
+    // The publish waits for a read, which only the sender's message provides; nothing else is written until the keep alive.
+    wantsReadBeforeWrite->store(true);
+    DispatchPromise<MqttStatus> publishPromise;
+    connection.publish({"remote_core/tests/topic_2", "{}", 1, [publishPromise](MqttStatus status) mutable {
+        publishPromise.resolve(status);
+    }});
+    
+    auto deadline = std::chrono::steady_clock::now() + DEFAULT_TIMEOUT;
+    while (wantsReadBeforeWrite->load() && std::chrono::steady_clock::now() < deadline) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    ASSERT_FALSE(wantsReadBeforeWrite->load());
+    
+    EXPECT_EQ(TestSupport::waitForStatus([&](MqttConnection::CompletionHandler completionHandler) {
+        sender.publish({DEFAULT_TOPIC_NAME, "{}", 1, completionHandler});
+    }), MqttStatus::Success);
+    
+    auto publishFuture = publishPromise.getFuture();
+    ASSERT_TRUE(publishFuture.waitFor(DEFAULT_TIMEOUT));
+    EXPECT_EQ(publishFuture.get(), MqttStatus::Success);
+}
+
+TEST_F(MqttConnectionTests, PublishWithPropertiesOverMqtt5) {
+    auto options = optionsWithClientID("subscriber");
+    options.protocolLevel = MQTT_5_PROTOCOL_LEVEL;
+    MqttConnection subscriber(options);
+    
+    DispatchPromise<MqttProperties> receivedProperties;
+    subscriber.setPublishHandler([receivedProperties](const std::string &topicName, const SharedBuffer &payload, const MqttProperties &properties) mutable {
+        EXPECT_EQ(topicName, DEFAULT_TOPIC_NAME);
+        EXPECT_EQ(payload, "{\"type\":1}");
+        receivedProperties.resolve(properties);
+    });
+    
+    ASSERT_EQ(TestSupport::waitForStatus([&](MqttConnection::CompletionHandler completionHandler) {
+        subscriber.connect(completionHandler);
+    }), MqttStatus::Success);
+    ASSERT_EQ(TestSupport::waitForStatus([&](MqttConnection::CompletionHandler completionHandler) {
+        subscriber.subscribe({DEFAULT_TOPIC_NAME}, 1, completionHandler);
+    }), MqttStatus::Success);
+    
+    options.clientID = "publisher";
+    MqttConnection publisher(options);
+    ASSERT_EQ(TestSupport::waitForStatus([&](MqttConnection::CompletionHandler completionHandler) {
+        publisher.connect(completionHandler);
+    }), MqttStatus::Success);
+    
+    MqttConnection::OutboundMessage message = {DEFAULT_TOPIC_NAME, "{\"type\":1}", 1, nullptr};
+    message.properties.hasMessageExpiryInterval = true;
+    message.properties.messageExpiryInterval = 60;
+    message.properties.responseTopic = "remote_core/tests/responses";
+    message.properties.correlationData = "request-1";
+    EXPECT_EQ(TestSupport::waitForStatus([&](MqttConnection::CompletionHandler completionHandler) {
+        message.completionHandler = completionHandler;
+        publisher.publish(message);
+    }), MqttStatus::Success);
+    
+    // The metadata arrives without decoding the payload, and the publisher's topic alias is not forwarded.
+    auto propertiesFuture = receivedProperties.getFuture();
+    ASSERT_TRUE(propertiesFuture.waitFor(DEFAULT_TIMEOUT));
+    auto properties = propertiesFuture.get();
+    EXPECT_TRUE(properties.hasMessageExpiryInterval);
+    EXPECT_EQ(properties.messageExpiryInterval, 60u);
+    EXPECT_EQ(properties.responseTopic, "remote_core/tests/responses");
+    EXPECT_EQ(properties.correlationData, "request-1");
+    EXPECT_EQ(properties.topicAlias, 0);
+}
+
+TEST_F(MqttConnectionTests, ReassignTopicAliasesAfterReconnecting) {
+    std::mutex mutex;
+    std::vector<std::string> topicNames;
+    broker->setMessageHandler([&](const std::string &topicName, const SharedBuffer &payload) {
+        std::lock_guard<std::mutex> lock(mutex);
+        topicNames.push_back(topicName);
+    });
+    
+    auto options = optionsWithClientID("publisher");
+    options.protocolLevel = MQTT_5_PROTOCOL_LEVEL;
+    MqttConnection connection(options);
+    
+    DispatchPromise<bool> didReconnect;
+    std::atomic<int> connectionCount(0);
+    connection.setConnectionHandler([&connectionCount, didReconnect](bool isConnected, bool isSessionPresent) mutable {
+        if (isConnected && ++connectionCount == 2) {
+            didReconnect.resolve(true);
+        }
+    });
+    
+    ASSERT_EQ(TestSupport::waitForStatus([&](MqttConnection::CompletionHandler completionHandler) {
+        connection.connect(completionHandler);
+    }), MqttStatus::Success);
+    
+    // The first message assigns the alias, and the second only sends the alias.
+    for (int i = 0; i < 2; i++) {
+        EXPECT_EQ(TestSupport::waitForStatus([&](MqttConnection::CompletionHandler completionHandler) {
+            connection.publish({DEFAULT_TOPIC_NAME, std::to_string(i), 1, completionHandler});
+        }), MqttStatus::Success);
+    }
+    
+    // The new connection knows nothing of the previous aliases, and would refuse a message that only sent one.
+    broker->dropConnections();
+    auto reconnectFuture = didReconnect.getFuture();
+    ASSERT_TRUE(reconnectFuture.waitFor(DEFAULT_TIMEOUT));
+    
+    EXPECT_EQ(TestSupport::waitForStatus([&](MqttConnection::CompletionHandler completionHandler) {
+        connection.publish({DEFAULT_TOPIC_NAME, "after", 1, completionHandler});
+    }), MqttStatus::Success);
+    EXPECT_EQ(broker->getStatistics().acceptedConnectionCount, 2u);
+    
+    std::lock_guard<std::mutex> lock(mutex);
+    EXPECT_EQ(topicNames, std::vector<std::string>(3, DEFAULT_TOPIC_NAME));
+}
+
+TEST_F(MqttConnectionTests, ApplyConnectAcknowledgementLimits) {
+    ScriptedBroker scriptedBroker;
+    auto options = optionsWithClientID("limited");
+    options.port = scriptedBroker.getPort();
+    options.protocolLevel = MQTT_5_PROTOCOL_LEVEL;
+    MqttConnection connection(options);
+    
+    auto connectAcknowledgement = MqttPacket::connectAcknowledgement(false, MQTT_CONNECTION_ACCEPTED);
+    connectAcknowledgement.properties.topicAliasMaximum = 4;
+    connectAcknowledgement.properties.receiveMaximum = 2;
+    connectAcknowledgement.properties.maximumPacketSize = 256;
+    connectAcknowledgement.properties.hasServerKeepAlive = true;
+    connectAcknowledgement.properties.serverKeepAlive = 1;
+    
+    std::thread acceptThread([&]() {
+        EXPECT_TRUE(scriptedBroker.accept(connectAcknowledgement));
+    });
+    EXPECT_EQ(TestSupport::waitForStatus([&](MqttConnection::CompletionHandler completionHandler) {
+        connection.connect(completionHandler);
+    }), MqttStatus::Success);
+    acceptThread.join();
+    
+    // Packets larger than the broker accepts are refused without being sent, whatever their quality of service.
+    for (uint8_t qualityOfService = 0; qualityOfService <= 1; qualityOfService++) {
+        EXPECT_EQ(TestSupport::waitForStatus([&](MqttConnection::CompletionHandler completionHandler) {
+            connection.publish({DEFAULT_TOPIC_NAME, std::string(512, 'x'), qualityOfService, completionHandler});
+        }), MqttStatus::PacketTooLarge);
+    }
+    
+    std::vector<DispatchPromise<MqttStatus>> statuses(3);
+    for (size_t i = 0; i < statuses.size(); i++) {
+        connection.publish({DEFAULT_TOPIC_NAME, std::to_string(i), 1, [promise = statuses[i]](MqttStatus status) mutable {
+            promise.resolve(status);
+        }});
+    }
+    
+    // The refused packets did not take the topic's alias, so the first packet the broker receives still names the topic.
+    MqttPacket first;
+    MqttPacket second;
+    ASSERT_TRUE(scriptedBroker.nextPacket(first, DEFAULT_TIMEOUT));
+    ASSERT_TRUE(scriptedBroker.nextPacket(second, DEFAULT_TIMEOUT));
+    EXPECT_EQ(first.topicName, DEFAULT_TOPIC_NAME);
+    EXPECT_EQ(first.properties.topicAlias, 1);
+    EXPECT_EQ(first.payload, "0");
+    EXPECT_EQ(second.payload, "1");
+    
+    // The third publish waits until fewer than the broker's receive maximum are in flight.
+    MqttPacket third;
+    EXPECT_FALSE(scriptedBroker.nextPacket(third, std::chrono::milliseconds(100)));
+    scriptedBroker.send(MqttPacket::withType(MqttPacketType::PublishAcknowledgement, first.packetIdentifier));
+    ASSERT_TRUE(scriptedBroker.nextPacket(third, DEFAULT_TIMEOUT));
+    EXPECT_EQ(third.payload, "2");
+    
+    scriptedBroker.send(MqttPacket::withType(MqttPacketType::PublishAcknowledgement, second.packetIdentifier));
+    scriptedBroker.send(MqttPacket::withType(MqttPacketType::PublishAcknowledgement, third.packetIdentifier));
+    for (auto &status : statuses) {
+        auto future = status.getFuture();
+        ASSERT_TRUE(future.waitFor(DEFAULT_TIMEOUT));
+        EXPECT_EQ(future.get(), MqttStatus::Success);
+    }
+    
+    // The broker's keep alive interval replaces the client's, which would not have pinged for a minute.
+    MqttPacket ping;
+    ASSERT_TRUE(scriptedBroker.nextPacket(ping, std::chrono::seconds(3)));
+    EXPECT_EQ(ping.type, MqttPacketType::PingRequest);
+}
+
+TEST_F(MqttConnectionTests, FailToConnect) {
+    auto options = optionsWithClientID("unreachable");
+    broker.reset();
+    
+    // Nothing listens on the broker's former port any more.
+    MqttConnection connection(options);
+    EXPECT_EQ(TestSupport::waitForStatus([&](MqttConnection::CompletionHandler completionHandler) {
+        connection.connect(completionHandler);
+    }), MqttStatus::ConnectFailed);
+    
+    EXPECT_EQ(TestSupport::waitForStatus([&](MqttConnection::CompletionHandler completionHandler) {
+        connection.subscribe({DEFAULT_TOPIC_NAME}, 1, completionHandler);
+    }), MqttStatus::NotConnected);
+    
+    EXPECT_THROW(connection.publish({DEFAULT_TOPIC_NAME, "", 2, nullptr}), std::logic_error);
+}
+
+TEST_F(MqttConnectionTests, PublishLatency) {
+    MqttConnection connection(optionsWithClientID("latency"));
+    std::mutex mutex;
+    std::unique_ptr<DispatchPromise<bool>> receivedPromise;
+    connection.setMessageHandler([&](const std::string &topicName, const std::string &payload) {
+        std::lock_guard<std::mutex> lock(mutex);
+        receivedPromise->resolve(true);
+    });
+    
+    ASSERT_EQ(TestSupport::waitForStatus([&](MqttConnection::CompletionHandler completionHandler) {
+        connection.connect(completionHandler);
+    }), MqttStatus::Success);
+    ASSERT_EQ(TestSupport::waitForStatus([&](MqttConnection::CompletionHandler completionHandler) {
+        connection.subscribe({DEFAULT_TOPIC_NAME}, 1, completionHandler);
+    }), MqttStatus::Success);
+    
+    // Measure the round trip from publishing a message until it is delivered back.
+    std::vector<std::chrono::microseconds> latencies;
+    for (int i = 0; i < 100; i++) {
+        DispatchFuture<bool> receivedFuture;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            receivedPromise = std::make_unique<DispatchPromise<bool>>();
+            receivedFuture = receivedPromise->getFuture();
+        }
+        
+        auto start = std::chrono::steady_clock::now();
+        connection.publish({DEFAULT_TOPIC_NAME, std::to_string(i), 1, nullptr});
+        ASSERT_TRUE(receivedFuture.waitFor(DEFAULT_TIMEOUT));
+        latencies.push_back(std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start));
+    }
+    
+    // Nothing waits for a polling interval, so the median is far below one action processing period (200 ms at 5 Hz).
+    std::sort(latencies.begin(), latencies.end());
+    EXPECT_LT(latencies[latencies.size() / 2], std::chrono::milliseconds(20));
+}
@@ -0,0 +1,289 @@
+//
+//  MqttPacketTests.cpp
+//  remote_core_unit_tests
+//
+//  Created by David Moore on 10/19/26.
+//  Copyright © 2026 David Moore. All rights reserved.
+//
+
+#include <string>
+#include <vector>
+#include <gtest/gtest.h>
+#include "MqttPacket.hpp"
+
+using namespace RemoteCore;
+
+static MqttPacket roundTrip(const MqttPacket &packet) {
+    std::string buffer;
+    packet.encode(buffer);
+    
+    MqttPacketParser parser;
+    parser.setProtocolLevel(packet.protocolLevel);
+    parser.append(buffer.data(), buffer.size());
+    
+    MqttPacket decodedPacket;
+    EXPECT_TRUE(parser.nextPacket(decodedPacket));
+    EXPECT_EQ(parser.getBufferedSize(), 0u);
+    return decodedPacket;
+}
+
+TEST(MqttPacketTests, EncodeConnect) {
+    std::string buffer;
+    MqttPacket::connect("abc", 60, true).encode(buffer);
+    
+    // Fixed header, protocol name and level, flags, keep alive, and the client ID.
+    std::string expected("\x10\x0F\x00\x04MQTT\x04\x02\x00\x3C\x00\x03" "abc", 17);
+    EXPECT_EQ(buffer, expected);
+    
+    auto packet = roundTrip(MqttPacket::connect("remote_core", 600, false));
+    EXPECT_EQ(packet.type, MqttPacketType::Connect);
+    EXPECT_EQ(packet.clientID, "remote_core");
+    EXPECT_EQ(packet.keepAliveInterval, 600);
+    EXPECT_FALSE(packet.isCleanSession);
+}
+
+TEST(MqttPacketTests, RoundTripPackets) {
+    auto publish = MqttPacket::publish("remote_core/device", std::string("{\"a\":\0}", 7), 1, 42);
+    publish.isDuplicate = true;
+    auto decodedPublish = roundTrip(publish);
+    EXPECT_EQ(decodedPublish.type, MqttPacketType::Publish);
+    EXPECT_EQ(decodedPublish.topicName, publish.topicName);
+    EXPECT_EQ(decodedPublish.payload, publish.payload);
+    EXPECT_EQ(decodedPublish.qualityOfService, 1);
+    EXPECT_EQ(decodedPublish.packetIdentifier, 42);
+    EXPECT_TRUE(decodedPublish.isDuplicate);
+    
+    auto subscribe = roundTrip(MqttPacket::subscribe(7, {"a/+", "b/#"}, 1));
+    EXPECT_EQ(subscribe.packetIdentifier, 7);
+    EXPECT_EQ(subscribe.topicFilters, std::vector<std::string>({"a/+", "b/#"}));
+    EXPECT_EQ(subscribe.qualityOfServices, std::vector<uint8_t>({1, 1}));
+    
+    auto subscribeAcknowledgement = MqttPacket::withType(MqttPacketType::SubscribeAcknowledgement, 7);
+    subscribeAcknowledgement.qualityOfServices = {1, MQTT_SUBSCRIPTION_FAILURE};
+    EXPECT_EQ(roundTrip(subscribeAcknowledgement).qualityOfServices, subscribeAcknowledgement.qualityOfServices);
+    
+    auto connectAcknowledgement = roundTrip(MqttPacket::connectAcknowledgement(true, 5));
+    EXPECT_TRUE(connectAcknowledgement.isSessionPresent);
+    EXPECT_EQ(connectAcknowledgement.returnCode, 5);
+    
+    EXPECT_EQ(roundTrip(MqttPacket::unsubscribe(9, {"a/+"})).topicFilters, std::vector<std::string>({"a/+"}));
+    EXPECT_EQ(roundTrip(MqttPacket::withType(MqttPacketType::PublishAcknowledgement, 300)).packetIdentifier, 300);
+    EXPECT_EQ(roundTrip(MqttPacket::withType(MqttPacketType::PingResponse)).type, MqttPacketType::PingResponse);
+}
+
+TEST(MqttPacketTests, EncodeMqtt5Publish) {
+    auto publish = MqttPacket::publish("", "x", 0, 0);
+    publish.protocolLevel = MQTT_5_PROTOCOL_LEVEL;
+    publish.properties.topicAlias = 1;
+    
+    // Fixed header, an empty topic name, and the properties, which only hold the topic alias.
+    std::string buffer;
+    publish.encode(buffer);
+    EXPECT_EQ(buffer, std::string("\x30\x07\x00\x00\x03\x23\x00\x01" "x", 9));
+    
+    publish.topicName = "remote_core/device";
+    publish.qualityOfService = 1;
+    publish.packetIdentifier = 42;
+    publish.properties.hasMessageExpiryInterval = true;
+    publish.properties.messageExpiryInterval = 3600;
+    publish.properties.responseTopic = "remote_core/phone";
+    publish.properties.correlationData = std::string("\x01\x00\x02", 3);
+    
+    auto decodedPublish = roundTrip(publish);
+    EXPECT_EQ(decodedPublish.protocolLevel, MQTT_5_PROTOCOL_LEVEL);
+    EXPECT_EQ(decodedPublish.topicName, publish.topicName);
+    EXPECT_EQ(decodedPublish.packetIdentifier, 42);
+    EXPECT_EQ(decodedPublish.payload, "x");
+    EXPECT_EQ(decodedPublish.properties.topicAlias, 1);
+    EXPECT_TRUE(decodedPublish.properties.hasMessageExpiryInterval);
+    EXPECT_EQ(decodedPublish.properties.messageExpiryInterval, 3600u);
+    EXPECT_EQ(decodedPublish.properties.responseTopic, publish.properties.responseTopic);
+    EXPECT_EQ(decodedPublish.properties.correlationData, publish.properties.correlationData);
+}
+
+TEST(MqttPacketTests, EncodeZeroMessageExpiryInterval) {
+    auto publish = MqttPacket::publish("a", "x", 0, 0);
+    publish.protocolLevel = MQTT_5_PROTOCOL_LEVEL;
+    publish.properties.hasMessageExpiryInterval = true;
+    
+    // An interval of zero is still sent, rather than being taken to mean that the message does not expire.
+    std::string buffer;
+    publish.encode(buffer);
+    EXPECT_EQ(buffer, std::string("\x30\x0a\x00\x01" "a" "\x05\x02\x00\x00\x00\x00" "x", 12));
+    
+    auto decodedPublish = roundTrip(publish);
+    EXPECT_TRUE(decodedPublish.properties.hasMessageExpiryInterval);
+    EXPECT_EQ(decodedPublish.properties.messageExpiryInterval, 0u);
+    
+    // Without the property, the message does not expire.
+    publish.properties.hasMessageExpiryInterval = false;
+    EXPECT_FALSE(roundTrip(publish).properties.hasMessageExpiryInterval);
+}
+
+TEST(MqttPacketTests, RoundTripMqtt5Packets) {
+    // The CONNECT packet states its own level, so it is decoded by a parser that still expects MQTT 3.1.1.
+    auto connect = MqttPacket::connect("remote_core", 600, true);
+    connect.protocolLevel = MQTT_5_PROTOCOL_LEVEL;
+    connect.properties.topicAliasMaximum = 8;
+    std::string buffer;
+    connect.encode(buffer);
+    
+    MqttPacketParser parser;
+    MqttPacket decodedConnect;
+    parser.append(buffer.data(), buffer.size());
+    ASSERT_TRUE(parser.nextPacket(decodedConnect));
+    EXPECT_EQ(decodedConnect.protocolLevel, MQTT_5_PROTOCOL_LEVEL);
+    EXPECT_EQ(decodedConnect.clientID, "remote_core");
+    EXPECT_EQ(decodedConnect.properties.topicAliasMaximum, 8);
+    
+    auto connectAcknowledgement = MqttPacket::connectAcknowledgement(false, MQTT_CONNECTION_ACCEPTED);
+    connectAcknowledgement.protocolLevel = MQTT_5_PROTOCOL_LEVEL;
+    connectAcknowledgement.properties.topicAliasMaximum = 16;
+    EXPECT_EQ(roundTrip(connectAcknowledgement).properties.topicAliasMaximum, 16);
+    
+    // A successful acknowledgement leaves out its reason code, and a failed one carries it with its reason.
+    auto publishAcknowledgement = MqttPacket::withType(MqttPacketType::PublishAcknowledgement, 300);
+    publishAcknowledgement.protocolLevel = MQTT_5_PROTOCOL_LEVEL;
+    buffer.clear();
+    publishAcknowledgement.encode(buffer);
+    EXPECT_EQ(buffer.size(), 4u);
+    
+    publishAcknowledgement.returnCode = 0x87;
+    publishAcknowledgement.properties.reasonString = "Not authorized";
+    auto decodedAcknowledgement = roundTrip(publishAcknowledgement);
+    EXPECT_EQ(decodedAcknowledgement.packetIdentifier, 300);
+    EXPECT_EQ(decodedAcknowledgement.returnCode, 0x87);
+    EXPECT_EQ(decodedAcknowledgement.properties.reasonString, "Not authorized");
+    
+    auto subscribe = MqttPacket::subscribe(7, {"a/+"}, 1);
+    subscribe.protocolLevel = MQTT_5_PROTOCOL_LEVEL;
+    EXPECT_EQ(roundTrip(subscribe).qualityOfServices, std::vector<uint8_t>({1}));
+    
+    auto unsubscribeAcknowledgement = MqttPacket::withType(MqttPacketType::UnsubscribeAcknowledgement, 9);
+    unsubscribeAcknowledgement.protocolLevel = MQTT_5_PROTOCOL_LEVEL;
+    unsubscribeAcknowledgement.qualityOfServices = {0x00, 0x11};
+    EXPECT_EQ(roundTrip(unsubscribeAcknowledgement).qualityOfServices, unsubscribeAcknowledgement.qualityOfServices);
+    
+    auto disconnect = MqttPacket::withType(MqttPacketType::Disconnect);
+    disconnect.protocolLevel = MQTT_5_PROTOCOL_LEVEL;
+    disconnect.returnCode = 0x8E;
+    EXPECT_EQ(roundTrip(disconnect).returnCode, 0x8E);
+}
+
+TEST(MqttPacketTests, RoundTripConnectAcknowledgementLimits) {
+    auto connectAcknowledgement = MqttPacket::connectAcknowledgement(false, MQTT_CONNECTION_ACCEPTED);
+    connectAcknowledgement.protocolLevel = MQTT_5_PROTOCOL_LEVEL;
+    connectAcknowledgement.properties.hasServerKeepAlive = true;
+    connectAcknowledgement.properties.serverKeepAlive = 30;
+    connectAcknowledgement.properties.receiveMaximum = 20;
+    connectAcknowledgement.properties.maximumPacketSize = 4096;
+    
+    std::string buffer;
+    connectAcknowledgement.encode(buffer);
+    EXPECT_EQ(connectAcknowledgement.encodedLength(), buffer.size());
+    
+    auto decodedAcknowledgement = roundTrip(connectAcknowledgement);
+    EXPECT_TRUE(decodedAcknowledgement.properties.hasServerKeepAlive);
+    EXPECT_EQ(decodedAcknowledgement.properties.serverKeepAlive, 30);
+    EXPECT_EQ(decodedAcknowledgement.properties.receiveMaximum, 20);
+    EXPECT_EQ(decodedAcknowledgement.properties.maximumPacketSize, 4096u);
+    
+    // A server keep alive of zero disables keep alive, rather than leaving the client's interval.
+    connectAcknowledgement.properties.serverKeepAlive = 0;
+    EXPECT_TRUE(roundTrip(connectAcknowledgement).properties.hasServerKeepAlive);
+    
+    // A large payload needs a multi-byte remaining length, which is counted as well.
+    auto publish = MqttPacket::publish("a", std::string(200000, 'x'), 1, 1);
+    buffer.clear();
+    publish.encode(buffer);
+    EXPECT_EQ(publish.encodedLength(), buffer.size());
+    
+    // Neither limit may be zero.
+    for (auto &bytes : {std::string("\x20\x06\x00\x00\x03\x21\x00\x00", 8), std::string("\x20\x08\x00\x00\x05\x27\x00\x00\x00\x00", 10)}) {
+        MqttPacketParser parser;
+        parser.setProtocolLevel(MQTT_5_PROTOCOL_LEVEL);
+        parser.append(bytes.data(), bytes.size());
+        
+        MqttPacket packet;
+        EXPECT_THROW(parser.nextPacket(packet), MqttProtocolError);
+    }
+}
+
+TEST(MqttPacketTests, SkipUnusedProperties) {
+    // A PUBLISH packet with a user property, and a content type, before its correlation data.
+    std::string bytes("\x30\x15\x00\x01" "a" "\x10" "\x26\x00\x01" "k" "\x00\x01" "v" "\x03\x00\x01" "t" "\x09\x00\x02" "id" "x", 23);
+    MqttPacketParser parser;
+    parser.setProtocolLevel(MQTT_5_PROTOCOL_LEVEL);
+    parser.append(bytes.data(), bytes.size());
+    
+    MqttPacket packet;
+    ASSERT_TRUE(parser.nextPacket(packet));
+    EXPECT_EQ(packet.topicName, "a");
+    EXPECT_EQ(packet.properties.correlationData, "id");
+    EXPECT_EQ(packet.payload, "x");
+    
+    // Unknown properties cannot be skipped, and neither can properties that overrun their length.
+    auto expectMalformed = [](const std::string &bytes) {
+        MqttPacketParser parser;
+        parser.setProtocolLevel(MQTT_5_PROTOCOL_LEVEL);
+        parser.append(bytes.data(), bytes.size());
+        
+        MqttPacket packet;
+        EXPECT_THROW(parser.nextPacket(packet), MqttProtocolError);
+    };
+    
+    expectMalformed(std::string("\x30\x06\x00\x01" "a" "\x01\x7F" "x", 8));
+    expectMalformed(std::string("\x30\x07\x00\x01" "a" "\x02\x23\x00\x01", 9));
+    
+    // A topic name may only be left out in favour of a topic alias.
+    expectMalformed(std::string("\x30\x04\x00\x00\x00" "x", 6));
+}
+
+TEST(MqttPacketTests, ParseSplitStream) {
+    // A large payload needs a multi-byte remaining length.
+    std::string payload(200000, 'x');
+    std::string buffer;
+    MqttPacket::publish("a", payload, 0, 0).encode(buffer);
+    MqttPacket::withType(MqttPacketType::PingRequest).encode(buffer);
+    MqttPacket::publish("b", "small", 1, 1).encode(buffer);
+    
+    // Feed the stream one byte at a time, to exercise every partial state.
+    MqttPacketParser parser;
+    std::vector<MqttPacket> packets;
+    MqttPacket packet;
+    for (char byte : buffer) {
+        parser.append(&byte, 1);
+        while (parser.nextPacket(packet)) {
+            packets.push_back(packet);
+        }
+    }
+    
+    ASSERT_EQ(packets.size(), 3u);
+    EXPECT_EQ(packets[0].payload.size(), payload.size());
+    EXPECT_EQ(packets[1].type, MqttPacketType::PingRequest);
+    EXPECT_EQ(packets[2].payload, "small");
+    EXPECT_EQ(parser.getBufferedSize(), 0u);
+}
+
+TEST(MqttPacketTests, RejectMalformedPackets) {
+    MqttPacket packet;
+    auto expectMalformed = [&packet](const std::string &bytes, size_t maximumPacketSize) {
+        MqttPacketParser parser(maximumPacketSize);
+        parser.append(bytes.data(), bytes.size());
+        EXPECT_THROW(parser.nextPacket(packet), MqttProtocolError);
+    };
+    
+    // Reserved packet type, missing reserved flags, and a remaining length of more than four bytes.
+    expectMalformed(std::string("\xF0\x00", 2), MQTT_DEFAULT_MAXIMUM_PACKET_SIZE);
+    expectMalformed(std::string("\x80\x02\x00\x01", 4), MQTT_DEFAULT_MAXIMUM_PACKET_SIZE);
+    expectMalformed(std::string("\x30\xFF\xFF\xFF\xFF\x01", 6), MQTT_DEFAULT_MAXIMUM_PACKET_SIZE);
+    
+    // A topic name that is longer than the packet, and a packet that is larger than allowed.
+    expectMalformed(std::string("\x30\x03\x00\x05" "a", 5), MQTT_DEFAULT_MAXIMUM_PACKET_SIZE);
+    expectMalformed(std::string("\x30\x7F", 2), 64);
+    
+    // An incomplete packet is not malformed, only unfinished.
+    MqttPacketParser parser;
+    parser.append("\x30\x05\x00", 3);
+    EXPECT_FALSE(parser.nextPacket(packet));
+}
@@ -0,0 +1,166 @@
+//
+//  MulticastDNSAdvertiserTests.cpp
+//  remote_core_unit_tests
+//
+//  Created by David Moore on 10/19/26.
+//  Copyright © 2026 David Moore. All rights reserved.
+//
+
+#include <string>
+#include <vector>
+#include <poll.h>
+#include <unistd.h>
+#include <arpa/inet.h>
+#include <arpa/nameser.h>
+#include <resolv.h>
+#include <sys/socket.h>
+#include <gtest/gtest.h>
+#include "MulticastDNSAdvertiser.hpp"
+
+using namespace RemoteCore;
+
+#define DEFAULT_INSTANCE_NAME "Remote Core LE2RDNFR44"
+#define DEFAULT_SERVICE_TYPE "_remote-core._tcp"
+#define DEFAULT_HOST_NAME "remote-core-le2rdnfr44"
+#define DEFAULT_PORT 8884
+#define DEFAULT_QUERY_IDENTIFIER 0x1234
+#define DEFAULT_TIMEOUT_MILLISECONDS 2000
+
+// MARK: - Test Fixture
+
+class MulticastDNSAdvertiserTests : public testing::Test {
+protected:
+    std::unique_ptr<MulticastDNSAdvertiser> advertiser;
+    int fd = -1;
+    
+    void SetUp() override {
+        ServiceDescription service;
+        service.instanceName = DEFAULT_INSTANCE_NAME;
+        service.serviceType = DEFAULT_SERVICE_TYPE;
+        service.hostName = DEFAULT_HOST_NAME;
+        service.port = DEFAULT_PORT;
+        service.attributes["txtvers"] = "1";
+        advertiser = std::make_unique<MulticastDNSAdvertiser>(service, 0);
+        
+        // Queries come from an ephemeral port, and so are one-shot queries, which are answered directly.
+        fd = socket(AF_INET, SOCK_DGRAM, 0);
+        ASSERT_GE(fd, 0);
+    }
+    
+    void TearDown() override {
+        close(fd);
+    }
+    
+    /**
+     Sends a query with a single question to the advertiser over the loopback interface.
+     */
+    void sendQuery(const std::string &name, uint16_t type) {
+        u_char query[NS_PACKETSZ];
+        int length = res_mkquery(ns_o_query, name.c_str(), ns_c_in, type, nullptr, 0, nullptr, query, sizeof(query));
+        ASSERT_GT(length, 0);
+        ns_put16(DEFAULT_QUERY_IDENTIFIER, query);
+        
+        struct sockaddr_in address = {};
+        address.sin_family = AF_INET;
+        address.sin_port = htons(advertiser->getPort());
+        address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        ASSERT_EQ(sendto(fd, query, length, 0, (struct sockaddr *)&address, sizeof(address)), length);
+    }
+    
+    /**
+     Returns the next response, or an empty string if none arrives before the timeout.
+     */
+    std::string receiveResponse(int timeoutMilliseconds = DEFAULT_TIMEOUT_MILLISECONDS) {
+        struct pollfd descriptor = {fd, POLLIN, 0};
+        if (poll(&descriptor, 1, timeoutMilliseconds) != 1) {
+            return std::string();
+        }
+        
+        char bytes[NS_MAXMSG];
+        ssize_t length = recv(fd, bytes, sizeof(bytes), 0);
+        return length > 0 ? std::string(bytes, length) : std::string();
+    }
+    
+    /**
+     Returns the name that a record's data begins with.
+     */
+    static std::string nameInRecordData(ns_msg &message, ns_rr &record, size_t offset = 0) {
+        char name[NS_MAXDNAME];
+        if (ns_name_uncompress(ns_msg_base(message), ns_msg_end(message), ns_rr_rdata(record) + offset, name, sizeof(name)) < 0) {
+            return std::string();
+        }
+        
+        return name;
+    }
+};
+
+// MARK: - Tests
+
+TEST_F(MulticastDNSAdvertiserTests, AnswerBrowsingQuery) {
+    sendQuery(DEFAULT_SERVICE_TYPE ".local", ns_t_ptr);
+    auto response = receiveResponse();
+    ASSERT_FALSE(response.empty());
+    
+    ns_msg message;
+    ASSERT_EQ(ns_initparse((const u_char *)response.data(), (int)response.size(), &message), 0);
+    EXPECT_EQ(ns_msg_id(message), DEFAULT_QUERY_IDENTIFIER);
+    EXPECT_EQ(ns_msg_getflag(message, ns_f_qr), 1);
+    EXPECT_EQ(ns_msg_getflag(message, ns_f_aa), 1);
+    EXPECT_EQ(ns_msg_count(message, ns_s_qd), 1);
+    
+    // The instance is the answer, and everything needed to connect to it is added.
+    ASSERT_EQ(ns_msg_count(message, ns_s_an), 1);
+    ns_rr record;
+    ASSERT_EQ(ns_parserr(&message, ns_s_an, 0, &record), 0);
+    EXPECT_EQ(ns_rr_type(record), ns_t_ptr);
+    EXPECT_LE(ns_rr_ttl(record), 10u);
+    
+    // Spaces in the instance name are escaped in presentation form.
+    EXPECT_EQ(nameInRecordData(message, record), "Remote\\032Core\\032LE2RDNFR44." DEFAULT_SERVICE_TYPE ".local");
+    
+    bool hasServiceLocation = false;
+    bool hasText = false;
+    for (int i = 0; i < ns_msg_count(message, ns_s_ar); i++) {
+        ASSERT_EQ(ns_parserr(&message, ns_s_ar, i, &record), 0);
+        if (ns_rr_type(record) == ns_t_srv) {
+            hasServiceLocation = true;
+            EXPECT_EQ(ns_get16(ns_rr_rdata(record) + 2 * NS_INT16SZ), DEFAULT_PORT);
+            EXPECT_EQ(nameInRecordData(message, record, 3 * NS_INT16SZ), DEFAULT_HOST_NAME ".local");
+        } else if (ns_rr_type(record) == ns_t_txt) {
+            hasText = true;
+            EXPECT_EQ(std::string((const char *)ns_rr_rdata(record), ns_rr_rdlen(record)), "\x09txtvers=1");
+        } else {
+            EXPECT_EQ(ns_rr_type(record), ns_t_a);
+        }
+    }
+    
+    EXPECT_TRUE(hasServiceLocation);
+    EXPECT_TRUE(hasText);
+}
+
+TEST_F(MulticastDNSAdvertiserTests, AnswerQueriesCaseInsensitively) {
+    sendQuery("_SERVICES._dns-sd._udp.local", ns_t_ptr);
+    auto response = receiveResponse();
+    ASSERT_FALSE(response.empty());
+    
+    ns_msg message;
+    ns_rr record;
+    ASSERT_EQ(ns_initparse((const u_char *)response.data(), (int)response.size(), &message), 0);
+    ASSERT_EQ(ns_msg_count(message, ns_s_an), 1);
+    ASSERT_EQ(ns_parserr(&message, ns_s_an, 0, &record), 0);
+    EXPECT_EQ(nameInRecordData(message, record), DEFAULT_SERVICE_TYPE ".local");
+    
+    sendQuery(DEFAULT_INSTANCE_NAME "._Remote-Core._TCP.local", ns_t_txt);
+    response = receiveResponse();
+    ASSERT_FALSE(response.empty());
+    ASSERT_EQ(ns_initparse((const u_char *)response.data(), (int)response.size(), &message), 0);
+    ASSERT_EQ(ns_msg_count(message, ns_s_an), 1);
+    ASSERT_EQ(ns_parserr(&message, ns_s_an, 0, &record), 0);
+    EXPECT_EQ(ns_rr_type(record), ns_t_txt);
+}
+
+TEST_F(MulticastDNSAdvertiserTests, IgnoreOtherServices) {
+    sendQuery("_http._tcp.local", ns_t_ptr);
+    sendQuery(DEFAULT_SERVICE_TYPE ".local", ns_t_aaaa);
+    EXPECT_TRUE(receiveResponse(200).empty());
+}
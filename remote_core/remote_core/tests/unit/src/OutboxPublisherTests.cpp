@@ -0,0 +1,191 @@
+//
+//  OutboxPublisherTests.cpp
+//  remote_core_unit_tests
+//
+//  Created by David Moore on 10/19/26.
+//  Copyright © 2026 David Moore. All rights reserved.
+//
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include <gtest/gtest.h>
+#include "OutboxPublisher.hpp"
+
+using namespace RemoteCore;
+
+#define DEFAULT_TOPIC_NAME "remote_core/tests/topic_1"
+#define DEFAULT_TIMEOUT std::chrono::seconds(5)
+#define DEFAULT_RETRY_INTERVAL std::chrono::milliseconds(10)
+
+// MARK: - Test Fixture
+
+class OutboxPublisherTests : public testing::Test {
+protected:
+    struct PublishRecord {
+        SharedBuffer payload;
+        std::string topicName;
+        OutboxPublisher::CompletionHandler completionHandler;
+    };
+    
+    std::string path;
+    std::mutex mutex;
+    std::condition_variable condition;
+    std::vector<PublishRecord> publishes;
+    
+    void SetUp() override {
+        path = testing::TempDir() + "remote_core_outbox_publisher_" + testing::UnitTest::GetInstance()->current_test_info()->name();
+        std::remove(path.c_str());
+    }
+    
+    void TearDown() override {
+        std::remove(path.c_str());
+    }
+    
+    /**
+     Returns a publisher whose publishes are recorded, and left pending until the test completes them.
+     */
+    std::unique_ptr<OutboxPublisher> makePublisher(void) {
+        return std::make_unique<OutboxPublisher>(std::make_unique<MessageOutbox>(path, 1024, 4), [this](SharedBuffer payload, const std::string &topicName, OutboxPublisher::CompletionHandler completionHandler) {
+            std::lock_guard<std::mutex> lock(mutex);
+            publishes.push_back({payload, topicName, completionHandler});
+            condition.notify_all();
+        }, 8, DEFAULT_RETRY_INTERVAL);
+    }
+    
+    /**
+     Waits until at least 'count' messages have been published, and returns the publish at 'index'.
+     */
+    PublishRecord waitForPublish(size_t index) {
+        std::unique_lock<std::mutex> lock(mutex);
+        if (!condition.wait_for(lock, DEFAULT_TIMEOUT, [this, index]() { return publishes.size() > index; })) {
+            ADD_FAILURE() << "Timed out waiting for publish " << index << ".";
+            return PublishRecord();
+        }
+        
+        return publishes[index];
+    }
+    
+    size_t getPublishCount(void) {
+        std::lock_guard<std::mutex> lock(mutex);
+        return publishes.size();
+    }
+    
+    static bool waitUntilEmpty(MessageOutbox &outbox) {
+        auto deadline = std::chrono::steady_clock::now() + DEFAULT_TIMEOUT;
+        while (!outbox.isEmpty()) {
+            if (std::chrono::steady_clock::now() > deadline) {
+                return false;
+            }
+            
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        
+        return true;
+    }
+};
+
+// MARK: - Tests
+
+TEST_F(OutboxPublisherTests, PublishLiveWithoutCopying) {
+    auto publisher = makePublisher();
+    publisher->setConnected(true);
+    
+    std::string bytes(200, 'a');
+    const char *data = bytes.data();
+    
+    // The payload is allocated once, when it is moved in, and written to the outbox, but never copied into another buffer or read back.
+    auto statistics = SharedBuffer::getStatistics();
+    publisher->publish(DEFAULT_TOPIC_NAME, SharedBuffer(std::move(bytes)));
+    auto publish = waitForPublish(0);
+    
+    auto newStatistics = SharedBuffer::getStatistics();
+    EXPECT_EQ(publish.payload.data(), data);
+    EXPECT_EQ(publish.topicName, DEFAULT_TOPIC_NAME);
+    EXPECT_EQ(newStatistics.allocationCount - statistics.allocationCount, 1u);
+    EXPECT_EQ(newStatistics.copiedByteCount - statistics.copiedByteCount, 0u);
+    EXPECT_EQ(publisher->getOutbox().getCount(), 1u);
+    
+    publish.completionHandler(true);
+    EXPECT_TRUE(waitUntilEmpty(publisher->getOutbox()));
+    EXPECT_EQ(getPublishCount(), 1u);
+}
+
+TEST_F(OutboxPublisherTests, ReplayAfterFailedPublish) {
+    auto publisher = makePublisher();
+    publisher->setConnected(true);
+    publisher->publish(DEFAULT_TOPIC_NAME, SharedBuffer("message_0"));
+    publisher->publish(DEFAULT_TOPIC_NAME, SharedBuffer("message_1"));
+    
+    // The second message succeeds, but stays in the outbox until the first has been published.
+    waitForPublish(1).completionHandler(true);
+    waitForPublish(0).completionHandler(false);
+    
+    auto firstReplay = waitForPublish(2);
+    auto secondReplay = waitForPublish(3);
+    EXPECT_EQ(firstReplay.payload.toString(), "message_0");
+    EXPECT_EQ(secondReplay.payload.toString(), "message_1");
+    
+    // New messages wait for the replay to finish, and are then published live again.
+    publisher->publish(DEFAULT_TOPIC_NAME, SharedBuffer("message_2"));
+    firstReplay.completionHandler(true);
+    secondReplay.completionHandler(true);
+    
+    auto live = waitForPublish(4);
+    EXPECT_EQ(live.payload.toString(), "message_2");
+    live.completionHandler(true);
+    EXPECT_TRUE(waitUntilEmpty(publisher->getOutbox()));
+    EXPECT_EQ(getPublishCount(), 5u);
+}
+
+TEST_F(OutboxPublisherTests, ReplayAfterConnecting) {
+    {
+        auto publisher = makePublisher();
+        publisher->publish(DEFAULT_TOPIC_NAME, SharedBuffer("message_0"));
+    }
+    
+    // A message kept from before a restart is published before newer ones.
+    auto publisher = makePublisher();
+    publisher->publish(DEFAULT_TOPIC_NAME, SharedBuffer("message_1"));
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    EXPECT_EQ(getPublishCount(), 0u);
+    
+    publisher->setConnected(true);
+    auto first = waitForPublish(0);
+    auto second = waitForPublish(1);
+    EXPECT_EQ(first.payload.toString(), "message_0");
+    EXPECT_EQ(second.payload.toString(), "message_1");
+    
+    // A failed replay is retried after the interval.
+    first.completionHandler(true);
+    second.completionHandler(false);
+    waitForPublish(2).completionHandler(true);
+    waitForPublish(3).completionHandler(true);
+    EXPECT_TRUE(waitUntilEmpty(publisher->getOutbox()));
+}
+
+TEST_F(OutboxPublisherTests, CompleteAfterDestroying) {
+    auto publisher = makePublisher();
+    publisher->setConnected(true);
+    publisher->publish(DEFAULT_TOPIC_NAME, SharedBuffer("message_0"));
+    auto live = waitForPublish(0);
+    publisher.reset();
+    
+    // Completions that arrive after the publisher was destroyed are ignored, and their messages are kept.
+    live.completionHandler(false);
+    
+    publisher = makePublisher();
+    publisher->setConnected(true);
+    auto replay = waitForPublish(1);
+    EXPECT_EQ(replay.payload.toString(), "message_0");
+    publisher.reset();
+    
+    replay.completionHandler(true);
+    EXPECT_EQ(MessageOutbox(path, 1024, 4).getCount(), 1u);
+}
@@ -0,0 +1,106 @@
+//
+//  PublishPipelineTests.cpp
+//  remote_core_unit_tests
+//
+//  Created by David Moore on 10/19/26.
+//  Copyright © 2026 David Moore. All rights reserved.
+//
+
+#include <atomic>
+#include <thread>
+#include <vector>
+#include <gtest/gtest.h>
+#include "PublishPipeline.hpp"
+
+using namespace RemoteCore;
+
+TEST(PublishPipelineTests, WindowAndBacklog) {
+    std::vector<std::vector<int>> batches;
+    PublishPipeline<int> pipeline(2, 3, [&batches](std::vector<int> batch) {
+        batches.push_back(batch);
+    });
+    
+    // Two messages fill the window, and three more fill the backlog.
+    for (int i = 0; i < 5; i++) {
+        EXPECT_TRUE(pipeline.submit(i));
+    }
+    
+    int refusedMessage = 5;
+    EXPECT_FALSE(pipeline.submit(refusedMessage));
+    EXPECT_EQ(refusedMessage, 5);
+    EXPECT_FALSE(pipeline.waitForCapacity(std::chrono::milliseconds(1)));
+    
+    auto statistics = pipeline.getStatistics();
+    EXPECT_EQ(statistics.inFlightCount, 2u);
+    EXPECT_EQ(statistics.backlogCount, 3u);
+    EXPECT_EQ(statistics.rejectedCount, 1u);
+    
+    // Each acknowledgement lets one waiting message through, in order.
+    pipeline.complete();
+    pipeline.complete(2);
+    EXPECT_TRUE(pipeline.waitForCapacity(std::chrono::milliseconds(1)));
+    
+    statistics = pipeline.getStatistics();
+    EXPECT_EQ(statistics.inFlightCount, 2u);
+    EXPECT_EQ(statistics.backlogCount, 0u);
+    EXPECT_EQ(statistics.completedCount, 3u);
+    
+    std::vector<int> sentMessages;
+    for (auto &batch : batches) {
+        sentMessages.insert(sentMessages.end(), batch.begin(), batch.end());
+    }
+    EXPECT_EQ(sentMessages, std::vector<int>({0, 1, 2, 3, 4}));
+    
+    EXPECT_THROW(pipeline.complete(3), std::logic_error);
+}
+
+TEST(PublishPipelineTests, CoalesceWhileSending) {
+    std::atomic<bool> isFirstBatchBlocked(true);
+    std::atomic<bool> didStartFirstBatch(false);
+    std::vector<size_t> batchSizes;
+    
+    PublishPipeline<int> pipeline(16, 16, [&](std::vector<int> batch) {
+        batchSizes.push_back(batch.size());
+        didStartFirstBatch = true;
+        while (isFirstBatchBlocked) {
+            std::this_thread::yield();
+        }
+    });
+    
+    std::thread sender([&pipeline]() {
+        int message = 0;
+        pipeline.submit(message);
+    });
+    
+    while (!didStartFirstBatch) {
+        std::this_thread::yield();
+    }
+    
+    // Submitted while the first batch is being written, so they are sent together afterwards.
+    for (int i = 1; i <= 4; i++) {
+        EXPECT_TRUE(pipeline.submit(i));
+    }
+    
+    isFirstBatchBlocked = false;
+    sender.join();
+    
+    EXPECT_EQ(batchSizes, std::vector<size_t>({1, 4}));
+    EXPECT_EQ(pipeline.getStatistics().batchCount, 2u);
+}
+
+TEST(PublishPipelineTests, CompleteFromSender) {
+    // A sender that fails synchronously completes messages while the pipeline is sending.
+    PublishPipeline<int> *pipelinePointer = nullptr;
+    PublishPipeline<int> pipeline(1, 8, [&pipelinePointer](std::vector<int> batch) {
+        pipelinePointer->complete(batch.size());
+    });
+    pipelinePointer = &pipeline;
+    
+    for (int i = 0; i < 8; i++) {
+        EXPECT_TRUE(pipeline.submit(i));
+    }
+    
+    auto statistics = pipeline.getStatistics();
+    EXPECT_EQ(statistics.inFlightCount, 0u);
+    EXPECT_EQ(statistics.completedCount, 8u);
+}
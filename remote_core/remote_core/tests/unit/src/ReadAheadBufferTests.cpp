@@ -0,0 +1,108 @@
+//
+//  ReadAheadBufferTests.cpp
+//  remote_core_unit_tests
+//
+//  Created by David Moore on 10/19/26.
+//  Copyright © 2026 David Moore. All rights reserved.
+//
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <gtest/gtest.h>
+#include "ReadAheadBuffer.hpp"
+
+using namespace RemoteCore;
+
+// MARK: - Test Fixture
+
+class ReadAheadBufferTests : public testing::Test {
+protected:
+    ReadAheadBufferPool pool;
+    
+    ReadAheadBufferTests() : pool(1) {}
+    
+    /**
+     Appends the bytes to the buffer, and returns the number that fit in the first span of free space.
+     */
+    static size_t append(ReadAheadBuffer &buffer, const std::string &bytes) {
+        size_t length;
+        char *span = buffer.getFreeSpace(length);
+        length = std::min(length, bytes.size());
+        memcpy(span, bytes.data(), length);
+        buffer.commit(length);
+        return length;
+    }
+    
+    static std::string read(ReadAheadBuffer &buffer, size_t length) {
+        std::string bytes(length, 0);
+        bytes.resize(buffer.read(&bytes[0], length));
+        return bytes;
+    }
+};
+
+// MARK: - Tests
+
+TEST_F(ReadAheadBufferTests, ReadInOrder) {
+    ReadAheadBuffer buffer(&pool);
+    EXPECT_TRUE(buffer.isEmpty());
+    
+    EXPECT_EQ(append(buffer, "hello, world"), 12u);
+    EXPECT_EQ(buffer.getByteCount(), 12u);
+    EXPECT_EQ(read(buffer, 5), "hello");
+    EXPECT_EQ(read(buffer, 100), ", world");
+    EXPECT_TRUE(buffer.isEmpty());
+    EXPECT_EQ(read(buffer, 1), "");
+}
+
+TEST_F(ReadAheadBufferTests, WrapAround) {
+    ReadAheadBuffer buffer(&pool);
+    std::string head(READ_AHEAD_BUFFER_CAPACITY - 4, 'a');
+    EXPECT_EQ(append(buffer, head), head.size());
+    EXPECT_EQ(read(buffer, head.size() - 4), std::string(head.size() - 4, 'a'));
+    
+    // The free space at the end is used first, and then the space at the start.
+    EXPECT_EQ(append(buffer, "bcdefgh"), 4u);
+    EXPECT_EQ(append(buffer, "fgh"), 3u);
+    EXPECT_EQ(buffer.getByteCount(), 11u);
+    EXPECT_EQ(read(buffer, 11), "aaaabcdefgh");
+}
+
+TEST_F(ReadAheadBufferTests, FillCompletely) {
+    ReadAheadBuffer buffer(&pool);
+    EXPECT_EQ(append(buffer, std::string(READ_AHEAD_BUFFER_CAPACITY, 'a')), (size_t)READ_AHEAD_BUFFER_CAPACITY);
+    
+    size_t length;
+    buffer.getFreeSpace(length);
+    EXPECT_EQ(length, 0u);
+    EXPECT_THROW(buffer.commit(1), std::logic_error);
+    
+    // Emptying the buffer makes the whole block free again.
+    read(buffer, READ_AHEAD_BUFFER_CAPACITY);
+    buffer.getFreeSpace(length);
+    EXPECT_EQ(length, (size_t)READ_AHEAD_BUFFER_CAPACITY);
+}
+
+TEST_F(ReadAheadBufferTests, ReuseBlocks) {
+    char *block;
+    {
+        ReadAheadBuffer buffer(&pool);
+        size_t length;
+        block = buffer.getFreeSpace(length);
+        EXPECT_EQ(pool.getFreeBlockCount(), 0u);
+    }
+    
+    EXPECT_EQ(pool.getFreeBlockCount(), 1u);
+    
+    ReadAheadBuffer buffer(&pool);
+    size_t length;
+    EXPECT_EQ(buffer.getFreeSpace(length), block);
+    
+    // The pool keeps one block, so a second buffer's block is freed when it is returned.
+    ReadAheadBuffer otherBuffer(&pool);
+    otherBuffer.getFreeSpace(length);
+    otherBuffer.release();
+    buffer.release();
+    EXPECT_EQ(pool.getFreeBlockCount(), 1u);
+}
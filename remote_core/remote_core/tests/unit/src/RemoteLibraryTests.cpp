@@ -0,0 +1,192 @@
+//
+//  RemoteLibraryTests.cpp
+//  remote_core_unit_tests
+//
+//  Created by David Moore on 10/19/26.
+//  Copyright © 2026 David Moore. All rights reserved.
+//
+
+#include <sstream>
+#include <gtest/gtest.h>
+#include "RemoteLibrary.hpp"
+
+using namespace RemoteCore;
+
+#define NEC_CONFIGURATION \
+"# An NEC television remote.\n" \
+"begin remote\n" \
+"  name  LG_TV\n" \
+"  bits           16\n" \
+"  flags SPACE_ENC|CONST_LENGTH\n" \
+"  eps            30\n" \
+"  aeps          100\n" \
+"  header       9000  4500\n" \
+"  one           560  1690\n" \
+"  zero          560   560\n" \
+"  ptrail        560\n" \
+"  pre_data_bits   16\n" \
+"  pre_data       0x20DF\n" \
+"  gap          108000\n" \
+"      begin codes\n" \
+"          KEY_POWER                0x10EF\n" \
+"          KEY_VOLUMEUP             0x40BF   # Volume +\n" \
+"          vol_down                 0xC03F\n" \
+"      end codes\n" \
+"end remote\n"
+
+#define RC5_CONFIGURATION \
+"begin remote\n" \
+"  name  PHILIPS_RC5\n" \
+"  bits           13\n" \
+"  flags RC5|CONST_LENGTH\n" \
+"  one           889   889\n" \
+"  zero          889   889\n" \
+"  plead         889\n" \
+"  gap          113792\n" \
+"  toggle_bit_mask 0x800\n" \
+"      begin codes\n" \
+"          KEY_POWER                0x100C\n" \
+"          KEY_MUTE                 0x100D\n" \
+"      end codes\n" \
+"end remote\n"
+
+#define RAW_CONFIGURATION \
+"begin remote\n" \
+"  name  AIR_CONDITIONER\n" \
+"  flags RAW_CODES\n" \
+"  gap          50000\n" \
+"      begin raw_codes\n" \
+"          name KEY_POWER\n" \
+"             3400 1700 450 1300 450 400 450 1300\n" \
+"             450 400 450\n" \
+"      end raw_codes\n" \
+"end remote\n"
+
+/// Produces an NEC remote with a distinct address, which is used to fill the library.
+static std::string necConfigurationWithAddress(int address) {
+    std::ostringstream configuration;
+    configuration << "begin remote\n";
+    configuration << "  name  REMOTE_" << address << "\n";
+    configuration << "  bits 16\n  flags SPACE_ENC\n  header 9000 4500\n  one 560 1690\n  zero 560 560\n  ptrail 560\n";
+    configuration << "  pre_data_bits 16\n  pre_data 0x" << std::hex << address << std::dec << "\n";
+    configuration << "  begin codes\n";
+    for (int command = 0; command < 40; command++) {
+        configuration << "    KEY_" << command << " 0x" << std::hex << ((command << 8) | (~command & 0xFF)) << std::dec << "\n";
+    }
+    configuration << "  end codes\n";
+    configuration << "end remote\n";
+    
+    return configuration.str();
+}
+
+/// Simulates a button press by rendering the button and decoding the timings, as if they had been captured.
+static LearnedCode capturedCodeForButton(const RemoteCodebook &codebook, const std::string &name) {
+    for (auto &button : codebook.buttons) {
+        if (button.name == name) {
+            auto frame = codebook.learnedCodeForButton(button).rawFrame;
+            
+            // Skew the timings slightly, like a real receiver would.
+            for (size_t i = 0; i < frame.size(); i++) {
+                frame[i] = frame[i] * (i % 2 == 0 ? 104 : 97) / 100;
+            }
+            
+            return LearningEngine().decodeFrame(frame);
+        }
+    }
+    
+    return LearnedCode();
+}
+
+TEST(RemoteLibraryTests, LoadConfiguration) {
+    RemoteLibrary library;
+    std::istringstream stream(std::string(NEC_CONFIGURATION) + RC5_CONFIGURATION + RAW_CONFIGURATION);
+    
+    ASSERT_EQ(library.loadConfiguration(stream), 3u);
+    
+    auto &codebook = library.getCodebook(0);
+    EXPECT_EQ(codebook.name, "LG_TV");
+    EXPECT_EQ(codebook.protocol, PulseProtocol::PulseDistance);
+    EXPECT_EQ(codebook.bitCount, 32u);
+    ASSERT_EQ(codebook.buttons.size(), 3u);
+    EXPECT_EQ(codebook.buttons[0].code, 0x20DF10EFu);
+    EXPECT_EQ(codebook.buttons[2].name, "vol_down");
+    
+    // The start bit is included with the code.
+    auto &rc5Codebook = library.getCodebook(1);
+    EXPECT_EQ(rc5Codebook.protocol, PulseProtocol::Biphase);
+    EXPECT_EQ(rc5Codebook.bitCount, 14u);
+    EXPECT_EQ(rc5Codebook.buttons[0].code, 0x300Cu);
+    
+    auto &rawCodebook = library.getCodebook(2);
+    EXPECT_EQ(rawCodebook.protocol, PulseProtocol::Raw);
+    EXPECT_EQ(rawCodebook.buttons[0].rawFrame.size(), 11u);
+}
+
+TEST(RemoteLibraryTests, RenderButton) {
+    RemoteLibrary library;
+    std::istringstream stream(NEC_CONFIGURATION);
+    library.loadConfiguration(stream);
+    
+    auto &codebook = library.getCodebook(0);
+    auto code = codebook.learnedCodeForButton(codebook.buttons[0]);
+    
+    // Header, 32 bits and a trailing pulse.
+    ASSERT_EQ(code.rawFrame.size(), 67u);
+    EXPECT_EQ(code.rawFrame[0], 9000u);
+    EXPECT_EQ(code.rawFrame[1], 4500u);
+    EXPECT_EQ(code.rawFrame[66], 560u);
+}
+
+TEST(RemoteLibraryTests, IdentifyCode) {
+    RemoteLibrary library;
+    std::istringstream stream(std::string(NEC_CONFIGURATION) + RC5_CONFIGURATION + RAW_CONFIGURATION);
+    library.loadConfiguration(stream);
+    
+    auto necMatches = library.identifyCode(capturedCodeForButton(library.getCodebook(0), "KEY_VOLUMEUP"));
+    ASSERT_EQ(necMatches.size(), 1u);
+    EXPECT_EQ(necMatches[0].codebookIndex, 0u);
+    EXPECT_EQ(necMatches[0].buttonIndex, 1u);
+    EXPECT_GT(necMatches[0].score, 0.9);
+    
+    // Either state of the toggle bit identifies the button.
+    auto rc5Code = capturedCodeForButton(library.getCodebook(1), "KEY_MUTE");
+    rc5Code.code ^= 0x800;
+    
+    auto rc5Matches = library.identifyCode(rc5Code);
+    ASSERT_EQ(rc5Matches.size(), 1u);
+    EXPECT_EQ(rc5Matches[0].codebookIndex, 1u);
+    EXPECT_EQ(rc5Matches[0].buttonIndex, 1u);
+    
+    auto rawMatches = library.identifyCode(capturedCodeForButton(library.getCodebook(2), "KEY_POWER"));
+    ASSERT_EQ(rawMatches.size(), 1u);
+    EXPECT_EQ(rawMatches[0].codebookIndex, 2u);
+}
+
+TEST(RemoteLibraryTests, IdentifyWithMismatchedTiming) {
+    RemoteLibrary library;
+    std::istringstream stream(NEC_CONFIGURATION);
+    library.loadConfiguration(stream);
+    
+    // Same code, but with the header of a different protocol.
+    auto code = capturedCodeForButton(library.getCodebook(0), "KEY_POWER");
+    code.header = {4500, 4500};
+    
+    EXPECT_TRUE(library.identifyCode(code).empty());
+}
+
+TEST(RemoteLibraryTests, IdentifyWithinLargeLibrary) {
+    RemoteLibrary library;
+    for (int address = 0; address < 2000; address++) {
+        std::istringstream stream(necConfigurationWithAddress(address));
+        library.loadConfiguration(stream);
+    }
+    
+    ASSERT_EQ(library.getCodebookCount(), 2000u);
+    
+    auto &codebook = library.getCodebook(1234);
+    auto matches = library.identifyCode(capturedCodeForButton(codebook, "KEY_17"));
+    
+    ASSERT_EQ(matches.size(), 1u);
+    EXPECT_EQ(library.getCodebook(matches[0].codebookIndex).name, "REMOTE_1234");
+    EXPECT_EQ(codebook.buttons[matches[0].buttonIndex].name, "KEY_17");
+}
@@ -0,0 +1,259 @@
+//
+//  StreamConnectorTests.cpp
+//  remote_core_unit_tests
+//
+//  Created by David Moore on 10/19/26.
+//  Copyright © 2026 David Moore. All rights reserved.
+//
+
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <gtest/gtest.h>
+#include "EventLoop.hpp"
+#include "HostResolver.hpp"
+#include "StreamConnector.hpp"
+#include "StreamTransport.hpp"
+
+using namespace RemoteCore;
+
+#define DEFAULT_HOST "broker.example.com"
+#define DEFAULT_ATTEMPT_DELAY std::chrono::milliseconds(50)
+#define DEFAULT_TIMEOUT std::chrono::seconds(5)
+
+// MARK: - Test Fixture
+
+class StreamConnectorTests : public testing::Test {
+protected:
+    EventLoop loop;
+    std::vector<int> openDescriptors;
+    
+    std::atomic<int> lookupCount;
+    SocketAddress lookupAddress;
+    std::unique_ptr<HostResolver> resolver;
+    
+    void SetUp() override {
+        lookupCount = 0;
+        resolver = std::make_unique<HostResolver>([this](const std::string &host) {
+            lookupCount++;
+            
+            HostLookup lookup;
+            lookup.addresses = {lookupAddress};
+            return lookup;
+        });
+    }
+    
+    void TearDown() override {
+        for (int fd : openDescriptors) {
+            close(fd);
+        }
+    }
+    
+    /**
+     Returns the address of a loopback socket that is bound to a port, and listening with the backlog unless it is negative.
+     */
+    SocketAddress makeListener(int backlog) {
+        int fd = socket(AF_INET, SOCK_STREAM, 0);
+        openDescriptors.push_back(fd);
+        
+        SocketAddress address;
+        EXPECT_TRUE(SocketAddress::parse("127.0.0.1", 0, address));
+        EXPECT_EQ(bind(fd, (struct sockaddr *)&address.storage, address.length), 0);
+        EXPECT_EQ(getsockname(fd, (struct sockaddr *)&address.storage, &address.length), 0);
+        if (backlog >= 0) {
+            EXPECT_EQ(listen(fd, backlog), 0);
+        }
+        
+        return address;
+    }
+    
+    /**
+     Returns the address of a listener that never accepts another connection, so that connecting to it does not complete.
+     */
+    SocketAddress makeUnresponsiveListener(void) {
+        auto address = makeListener(0);
+        
+        // Fills the backlog, after which connection requests are dropped.
+        int fd = StreamTransport::startConnecting(address);
+        openDescriptors.push_back(fd);
+        return address;
+    }
+    
+    /**
+     Returns the address of a port that refuses connections.
+     */
+    SocketAddress makeRefusingAddress(void) {
+        return makeListener(-1);
+    }
+    
+    /**
+     Starts connecting on the loop, and runs it until the connector completes.
+     */
+    int connect(std::function<void (StreamConnector::CompletionHandler)> startConnecting, int &error) {
+        int connectedFD = -1;
+        error = -1;
+        
+        auto safetyTimer = loop.addTimer(DEFAULT_TIMEOUT * 2, false, [this]() {
+            ADD_FAILURE() << "Timed out waiting for the connector.";
+            loop.stop();
+        });
+        
+        loop.execute([&]() {
+            startConnecting([&](int fd, int connectError) {
+                connectedFD = fd;
+                error = connectError;
+                loop.stop();
+            });
+        });
+        
+        loop.run();
+        loop.removeTimer(safetyTimer);
+        if (connectedFD >= 0) {
+            openDescriptors.push_back(connectedFD);
+        }
+        
+        return connectedFD;
+    }
+    
+    int connect(StreamConnector &connector, const std::vector<SocketAddress> &addresses, std::chrono::milliseconds timeout, int &error) {
+        return connect([&](StreamConnector::CompletionHandler completionHandler) {
+            connector.connect(addresses, timeout, completionHandler);
+        }, error);
+    }
+    
+    int connect(StreamConnector &connector, const std::string &host, uint16_t port, int &error) {
+        return connect([&](StreamConnector::CompletionHandler completionHandler) {
+            connector.connect(host, port, DEFAULT_TIMEOUT, completionHandler);
+        }, error);
+    }
+    
+    static uint16_t getPeerPort(int fd) {
+        SocketAddress address;
+        address.length = sizeof(address.storage);
+        getpeername(fd, (struct sockaddr *)&address.storage, &address.length);
+        return address.getPort();
+    }
+};
+
+// MARK: - Tests
+
+TEST_F(StreamConnectorTests, ConnectToAddress) {
+    auto address = makeListener(1);
+    StreamConnector connector(loop, DEFAULT_ATTEMPT_DELAY, resolver.get());
+    
+    int error;
+    int fd = connect(connector, std::vector<SocketAddress>({address}), DEFAULT_TIMEOUT, error);
+    EXPECT_GE(fd, 0);
+    EXPECT_EQ(error, 0);
+    EXPECT_EQ(getPeerPort(fd), address.getPort());
+    EXPECT_FALSE(connector.isConnecting());
+}
+
+TEST_F(StreamConnectorTests, StartNextAttemptAfterDelay) {
+    auto unresponsiveAddress = makeUnresponsiveListener();
+    auto address = makeListener(1);
+    StreamConnector connector(loop, DEFAULT_ATTEMPT_DELAY, resolver.get());
+    
+    int error;
+    auto startTime = std::chrono::steady_clock::now();
+    int fd = connect(connector, std::vector<SocketAddress>({unresponsiveAddress, address}), DEFAULT_TIMEOUT, error);
+    EXPECT_EQ(error, 0);
+    EXPECT_EQ(getPeerPort(fd), address.getPort());
+    EXPECT_GE(std::chrono::steady_clock::now() - startTime, DEFAULT_ATTEMPT_DELAY);
+}
+
+TEST_F(StreamConnectorTests, SkipRefusedAddress) {
+    auto refusingAddress = makeRefusingAddress();
+    auto address = makeListener(1);
+    
+    // The refusal starts the next attempt long before the attempt delay elapses.
+    StreamConnector connector(loop, DEFAULT_TIMEOUT, resolver.get());
+    
+    int error;
+    auto startTime = std::chrono::steady_clock::now();
+    int fd = connect(connector, std::vector<SocketAddress>({refusingAddress, address}), DEFAULT_TIMEOUT * 2, error);
+    EXPECT_EQ(error, 0);
+    EXPECT_EQ(getPeerPort(fd), address.getPort());
+    EXPECT_LT(std::chrono::steady_clock::now() - startTime, DEFAULT_TIMEOUT);
+}
+
+TEST_F(StreamConnectorTests, FailWhenEveryAddressRefuses) {
+    StreamConnector connector(loop, DEFAULT_ATTEMPT_DELAY, resolver.get());
+    
+    int error;
+    int fd = connect(connector, std::vector<SocketAddress>({makeRefusingAddress(), makeRefusingAddress()}), DEFAULT_TIMEOUT, error);
+    EXPECT_EQ(fd, -1);
+    EXPECT_EQ(error, ECONNREFUSED);
+}
+
+TEST_F(StreamConnectorTests, TimeOut) {
+    StreamConnector connector(loop, DEFAULT_ATTEMPT_DELAY, resolver.get());
+    
+    int error;
+    int fd = connect(connector, std::vector<SocketAddress>({makeUnresponsiveListener()}), std::chrono::milliseconds(100), error);
+    EXPECT_EQ(fd, -1);
+    EXPECT_EQ(error, ETIMEDOUT);
+}
+
+TEST_F(StreamConnectorTests, ConnectToHost) {
+    lookupAddress = makeListener(1);
+    StreamConnector connector(loop, DEFAULT_ATTEMPT_DELAY, resolver.get());
+    
+    int error;
+    int fd = connect(connector, DEFAULT_HOST, lookupAddress.getPort(), error);
+    EXPECT_EQ(error, 0);
+    EXPECT_EQ(getPeerPort(fd), lookupAddress.getPort());
+    EXPECT_EQ(lookupCount, 1);
+}
+
+TEST_F(StreamConnectorTests, ResolveHostAgainAfterFailure) {
+    lookupAddress = makeRefusingAddress();
+    StreamConnector connector(loop, DEFAULT_ATTEMPT_DELAY, resolver.get());
+    
+    int error;
+    EXPECT_EQ(connect(connector, DEFAULT_HOST, lookupAddress.getPort(), error), -1);
+    EXPECT_EQ(error, ECONNREFUSED);
+    
+    // The failure discards the cached addresses, which may have changed.
+    EXPECT_EQ(connect(connector, DEFAULT_HOST, lookupAddress.getPort(), error), -1);
+    EXPECT_EQ(error, ECONNREFUSED);
+    EXPECT_EQ(lookupCount, 2);
+}
+
+TEST_F(StreamConnectorTests, CancelConnection) {
+    StreamConnector connector(loop, DEFAULT_ATTEMPT_DELAY, resolver.get());
+    
+    bool isCalled = false;
+    connector.connect(std::vector<SocketAddress>({makeUnresponsiveListener()}), std::chrono::milliseconds(50), [&](int fd, int error) {
+        isCalled = true;
+    });
+    
+    EXPECT_TRUE(connector.isConnecting());
+    connector.cancel();
+    EXPECT_FALSE(connector.isConnecting());
+    
+    // Runs the loop for longer than the connection's timeout.
+    loop.addTimer(std::chrono::milliseconds(100), false, [this]() {
+        loop.stop();
+    });
+    
+    loop.run();
+    EXPECT_FALSE(isCalled);
+}
+
+TEST_F(StreamConnectorTests, ConnectAndWait) {
+    auto address = makeListener(1);
+    
+    int error;
+    int fd = StreamConnector::connect("127.0.0.1", address.getPort(), DEFAULT_ATTEMPT_DELAY, DEFAULT_TIMEOUT, error);
+    openDescriptors.push_back(fd);
+    EXPECT_EQ(error, 0);
+    EXPECT_EQ(getPeerPort(fd), address.getPort());
+}
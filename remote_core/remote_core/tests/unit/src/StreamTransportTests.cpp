@@ -0,0 +1,298 @@
+//
+//  StreamTransportTests.cpp
+//  remote_core_unit_tests
+//
+//  Created by David Moore on 10/19/26.
+//  Copyright © 2026 David Moore. All rights reserved.
+//
+
+#include <chrono>
+#include <cstdio>
+#include <functional>
+#include <memory>
+#include <string>
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <gtest/gtest.h>
+#include <openssl/ssl.h>
+#include "StreamTransport.hpp"
+#include "TlsCredentialCache.hpp"
+#include "TlsTestSupport.hpp"
+
+using namespace RemoteCore;
+
+#define DEFAULT_SERVER_NAME "localhost"
+#define DEFAULT_TIMEOUT std::chrono::seconds(5)
+#define DEFAULT_FILE_LENGTH (256 * 1024 + 123)
+
+typedef std::chrono::steady_clock Clock;
+
+/**
+ Returns bytes that differ from one chunk to the next, so that a chunk sent twice or out of order is noticed.
+ */
+static std::string makeFileContents(size_t length) {
+    std::string contents(length, 0);
+    for (size_t i = 0; i < length; i++) {
+        contents[i] = (char)((i * 7 + i / 4096) % 251);
+    }
+    
+    return contents;
+}
+
+// MARK: - Test Fixture
+
+class StreamTransportTests : public testing::Test {
+protected:
+    std::string certificatePath;
+    std::string privateKeyPath;
+    std::string filePath;
+    std::string fileContents;
+    int fileFD = -1;
+    
+    void SetUp() override {
+        std::string prefix = testing::TempDir() + "remote_core_stream_transport_" + testing::UnitTest::GetInstance()->current_test_info()->name();
+        certificatePath = prefix + "_certificate.pem";
+        privateKeyPath = prefix + "_key.pem";
+        TestSupport::writeSelfSignedCertificate(certificatePath, privateKeyPath, "P-256", DEFAULT_SERVER_NAME);
+        
+        filePath = prefix + "_codebook.bin";
+        fileContents = makeFileContents(DEFAULT_FILE_LENGTH);
+        std::unique_ptr<FILE, decltype(&fclose)> file(fopen(filePath.c_str(), "w"), fclose);
+        ASSERT_NE(file, nullptr);
+        ASSERT_EQ(fwrite(fileContents.data(), 1, fileContents.size(), file.get()), fileContents.size());
+        file.reset();
+        
+        fileFD = open(filePath.c_str(), O_RDONLY);
+        ASSERT_GE(fileFD, 0);
+    }
+    
+    void TearDown() override {
+        if (fileFD >= 0) {
+            close(fileFD);
+        }
+        
+        TlsCredentialCache::removeAll();
+        unlink(certificatePath.c_str());
+        unlink(privateKeyPath.c_str());
+        unlink(filePath.c_str());
+    }
+    
+    /**
+     Connects a pair of sockets over the loopback interface.
+     */
+    static void connectSockets(int &clientFD, int &serverFD) {
+        int listenFD = StreamTransport::listenOnLoopback(0);
+        SocketAddress address;
+        ASSERT_TRUE(SocketAddress::parse("127.0.0.1", StreamTransport::getLocalPort(listenFD), address));
+        clientFD = StreamTransport::startConnecting(address);
+        
+        struct pollfd descriptor = {listenFD, POLLIN, 0};
+        ASSERT_EQ(poll(&descriptor, 1, (int)std::chrono::milliseconds(DEFAULT_TIMEOUT).count()), 1);
+        serverFD = accept(listenFD, nullptr, nullptr);
+        close(listenFD);
+        ASSERT_GE(serverFD, 0);
+    }
+    
+    TlsConfiguration makeServerConfiguration(void) {
+        TlsConfiguration configuration;
+        configuration.certificatePath = certificatePath;
+        configuration.privateKeyPath = privateKeyPath;
+        configuration.isServer = true;
+        configuration.verifiesPeer = false;
+        return configuration;
+    }
+    
+    TlsConfiguration makeClientConfiguration(void) {
+        TlsConfiguration configuration;
+        configuration.rootCAPath = certificatePath;
+        configuration.serverName = DEFAULT_SERVER_NAME;
+        return configuration;
+    }
+    
+    /**
+     Returns the client and server of a TLS connection whose handshake has finished.
+     */
+    void connectTls(const TlsConfiguration &clientConfiguration, const TlsConfiguration &serverConfiguration, std::unique_ptr<TlsTransport> &client, std::unique_ptr<TlsTransport> &server) {
+        int clientFD, serverFD;
+        connectSockets(clientFD, serverFD);
+        client.reset(new TlsTransport(clientFD, TlsTransport::makeContext(clientConfiguration), clientConfiguration));
+        server.reset(new TlsTransport(serverFD, TlsTransport::makeContext(serverConfiguration), serverConfiguration));
+        
+        // Both ends are driven from this thread, so neither may wait for the other for long.
+        auto deadline = Clock::now() + DEFAULT_TIMEOUT;
+        bool isClientComplete = false, isServerComplete = false;
+        while (!isClientComplete || !isServerComplete) {
+            ASSERT_LT(Clock::now(), deadline);
+            for (auto pair : {std::make_pair(client.get(), &isClientComplete), std::make_pair(server.get(), &isServerComplete)}) {
+                if (!*pair.second) {
+                    auto status = pair.first->handshake().status;
+                    ASSERT_NE(status, TransportStatus::Failed);
+                    *pair.second = status == TransportStatus::Complete;
+                }
+            }
+            
+            struct pollfd descriptors[] = {{clientFD, POLLIN, 0}, {serverFD, POLLIN, 0}};
+            poll(descriptors, 2, 10);
+        }
+    }
+    
+    /**
+     Sends the first 'length' bytes of the file with 'sendFile', while reading them on the other end, and returns the bytes read.
+     */
+    std::string transferFile(StreamTransport &sender, StreamTransport &receiver, size_t length) {
+        std::string received;
+        off_t offset = 0;
+        auto deadline = Clock::now() + DEFAULT_TIMEOUT;
+        while (received.size() < length && Clock::now() < deadline) {
+            if ((size_t)offset < length) {
+                auto result = sender.sendFile(fileFD, offset, length - (size_t)offset);
+                if (result.status == TransportStatus::Complete) {
+                    offset += (off_t)result.byteCount;
+                } else if (result.status != TransportStatus::WantWrite && result.status != TransportStatus::WantRead) {
+                    ADD_FAILURE() << "Expected the file to be sent.";
+                    break;
+                }
+            }
+            
+            char buffer[16 * 1024];
+            auto result = receiver.read(buffer, sizeof(buffer));
+            if (result.status == TransportStatus::Complete) {
+                received.append(buffer, result.byteCount);
+            } else if (result.status == TransportStatus::WantRead) {
+                struct pollfd descriptor = {receiver.getDescriptor(), POLLIN, 0};
+                poll(&descriptor, 1, 10);
+            } else {
+                ADD_FAILURE() << "Expected the file to be received.";
+                break;
+            }
+        }
+        
+        return received;
+    }
+};
+
+// MARK: - Tests
+
+TEST_F(StreamTransportTests, TcpSendFile) {
+    int clientFD, serverFD;
+    connectSockets(clientFD, serverFD);
+    TcpTransport client(clientFD);
+    TcpTransport server(serverFD);
+    
+    EXPECT_EQ(transferFile(client, server, fileContents.size()), fileContents);
+}
+
+TEST_F(StreamTransportTests, TlsSendFileInUserspace) {
+    std::unique_ptr<TlsTransport> client, server;
+    connectTls(makeClientConfiguration(), makeServerConfiguration(), client, server);
+    
+    EXPECT_FALSE(client->isKernelTlsSending());
+    EXPECT_FALSE(client->isKernelTlsReceiving());
+    EXPECT_EQ(transferFile(*client, *server, fileContents.size()), fileContents);
+}
+
+TEST_F(StreamTransportTests, TlsSendFileWithKernelTls) {
+    auto clientConfiguration = makeClientConfiguration();
+    auto serverConfiguration = makeServerConfiguration();
+    clientConfiguration.usesKernelTls = true;
+    serverConfiguration.usesKernelTls = true;
+    
+    std::unique_ptr<TlsTransport> client, server;
+    connectTls(clientConfiguration, serverConfiguration, client, server);
+    
+    // Whether the kernel took over depends on its 'tls' module, but the bytes must arrive either way, in both directions.
+    EXPECT_EQ(transferFile(*client, *server, fileContents.size()), fileContents);
+    EXPECT_EQ(transferFile(*server, *client, fileContents.size()), fileContents);
+    
+    std::string message = "hello, kernel";
+    EXPECT_EQ(client->write(message.data(), message.size()).byteCount, message.size());
+    
+    char buffer[64];
+    struct pollfd descriptor = {server->getDescriptor(), POLLIN, 0};
+    ASSERT_EQ(poll(&descriptor, 1, (int)std::chrono::milliseconds(DEFAULT_TIMEOUT).count()), 1);
+    auto result = server->read(buffer, sizeof(buffer));
+    ASSERT_EQ(result.status, TransportStatus::Complete);
+    EXPECT_EQ(std::string(buffer, result.byteCount), message);
+}
+
+TEST_F(StreamTransportTests, TlsWriteChain) {
+    std::unique_ptr<TlsTransport> client, server;
+    connectTls(makeClientConfiguration(), makeServerConfiguration(), client, server);
+    
+    // Small segments are gathered into records, and large ones are written directly, in order.
+    BufferChain chain;
+    SharedBuffer largePayload(fileContents.substr(0, 100 * 1024));
+    for (int i = 0; i < 200; i++) {
+        chain.appendBytes("header", 6);
+        chain.append(SharedBuffer(fileContents.substr((size_t)i * 100, 100)));
+        if (i % 50 == 0) {
+            chain.append(largePayload);
+        }
+    }
+    
+    std::string expected = chain.toString();
+    std::string received;
+    auto deadline = Clock::now() + DEFAULT_TIMEOUT;
+    while (received.size() < expected.size() && Clock::now() < deadline) {
+        if (!chain.isEmpty()) {
+            auto status = client->writeChain(chain).status;
+            ASSERT_TRUE(status == TransportStatus::Complete || status == TransportStatus::WantWrite);
+        }
+        
+        char buffer[16 * 1024];
+        auto result = server->read(buffer, sizeof(buffer));
+        if (result.status == TransportStatus::Complete) {
+            received.append(buffer, result.byteCount);
+        } else {
+            ASSERT_EQ(result.status, TransportStatus::WantRead);
+            struct pollfd descriptor = {server->getDescriptor(), POLLIN, 0};
+            poll(&descriptor, 1, 10);
+        }
+    }
+    
+    EXPECT_TRUE(chain.isEmpty());
+    EXPECT_EQ(received, expected);
+}
+
+TEST_F(StreamTransportTests, SendFilePastEnd) {
+    int clientFD, serverFD;
+    connectSockets(clientFD, serverFD);
+    TcpTransport tcpClient(clientFD);
+    TcpTransport tcpServer(serverFD);
+    
+    auto clientConfiguration = makeClientConfiguration();
+    auto serverConfiguration = makeServerConfiguration();
+    clientConfiguration.usesKernelTls = true;
+    serverConfiguration.usesKernelTls = true;
+    
+    std::unique_ptr<TlsTransport> tlsClient, tlsServer;
+    connectTls(clientConfiguration, serverConfiguration, tlsClient, tlsServer);
+    
+    // Nothing remains at the end of the file, so the bytes asked for can never be sent.
+    EXPECT_EQ(tcpClient.sendFile(fileFD, (off_t)fileContents.size(), 10).status, TransportStatus::Failed);
+    EXPECT_EQ(tcpClient.sendFile(fileFD, (off_t)fileContents.size(), 0).status, TransportStatus::Complete);
+    
+    if (!tlsClient->isKernelTlsSending()) {
+        GTEST_SKIP() << "The kernel's 'tls' module is unavailable, so the file cannot be sent through kernel TLS.";
+    }
+    
+    EXPECT_EQ(tlsClient->sendFile(fileFD, (off_t)fileContents.size(), 10).status, TransportStatus::Failed);
+}
+
+TEST_F(StreamTransportTests, ServerHonorsClientPreferenceForChaCha) {
+    auto clientConfiguration = makeClientConfiguration();
+    auto serverConfiguration = makeServerConfiguration();
+    clientConfiguration.cipherPolicy = TlsCipherPolicy::makePreferred(false);
+    serverConfiguration.cipherPolicy = TlsCipherPolicy::makePreferred(true);
+    
+    std::unique_ptr<TlsTransport> client, server;
+    connectTls(clientConfiguration, serverConfiguration, client, server);
+    EXPECT_EQ(client->getCipherName(), "TLS_CHACHA20_POLY1305_SHA256");
+    
+    // A client with AES instructions gets the server's first choice.
+    clientConfiguration.cipherPolicy = TlsCipherPolicy::makePreferred(true);
+    connectTls(clientConfiguration, serverConfiguration, client, server);
+    EXPECT_EQ(client->getCipherName(), "TLS_AES_128_GCM_SHA256");
+}
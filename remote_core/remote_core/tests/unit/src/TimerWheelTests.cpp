@@ -0,0 +1,114 @@
+//
+//  TimerWheelTests.cpp
+//  remote_core_unit_tests
+//
+//  Created by David Moore on 10/19/26.
+//  Copyright © 2026 David Moore. All rights reserved.
+//
+
+#include <algorithm>
+#include <atomic>
+#include <future>
+#include <mutex>
+#include <vector>
+#include <gtest/gtest.h>
+#include "DispatchQueue.hpp"
+#include "TimerWheel.hpp"
+
+using namespace RemoteCore;
+
+#define DEFAULT_TIMEOUT std::chrono::seconds(5)
+
+TEST(TimerWheelTests, ExecuteAfterDelay) {
+    DispatchQueue queue("ca.mooredev.remote_core.TimerWheelTests.serial_dispatch_queue");
+    std::promise<TimerWheel::Clock::time_point> firePromise;
+    
+    auto startTime = TimerWheel::Clock::now();
+    queue.executeAfter(std::chrono::milliseconds(20), [&firePromise]() {
+        firePromise.set_value(TimerWheel::Clock::now());
+    });
+    
+    auto fireFuture = firePromise.get_future();
+    ASSERT_EQ(fireFuture.wait_for(DEFAULT_TIMEOUT), std::future_status::ready);
+    EXPECT_GE(fireFuture.get() - startTime, std::chrono::milliseconds(20));
+}
+
+TEST(TimerWheelTests, CancelTimer) {
+    std::atomic<int> fireCount(0);
+    std::promise<void> laterPromise;
+    
+    DispatchQueue queue("ca.mooredev.remote_core.TimerWheelTests.serial_dispatch_queue");
+    auto timer = queue.executeAfter(std::chrono::milliseconds(10), [&fireCount]() {
+        fireCount++;
+    });
+    
+    queue.executeAfter(std::chrono::milliseconds(30), [&laterPromise]() {
+        laterPromise.set_value();
+    });
+    
+    EXPECT_TRUE(timer.cancel());
+    EXPECT_FALSE(timer.cancel());
+    EXPECT_FALSE(DispatchTimer().cancel());
+    
+    ASSERT_EQ(laterPromise.get_future().wait_for(DEFAULT_TIMEOUT), std::future_status::ready);
+    EXPECT_EQ(fireCount, 0);
+}
+
+TEST(TimerWheelTests, TimersAcrossLevels) {
+    // A fine resolution, so that the deadlines span several levels of the wheel.
+    TimerWheel wheel("ca.mooredev.remote_core.TimerWheelTests.timer_wheel", std::chrono::microseconds(10));
+    std::mutex mutex;
+    std::vector<int> firedTimers;
+    std::atomic<bool> didFireEarly(false);
+    std::promise<void> completionPromise;
+    
+    const std::vector<int> delays = {80, 1, 45, 0, 5, 12, 60, 2, 30};
+    auto startTime = TimerWheel::Clock::now();
+    
+    for (int delay : delays) {
+        auto deadline = startTime + std::chrono::milliseconds(delay);
+        wheel.schedule(deadline, [&, delay, deadline]() {
+            if (TimerWheel::Clock::now() < deadline) {
+                didFireEarly = true;
+            }
+            
+            std::lock_guard<std::mutex> lock(mutex);
+            firedTimers.push_back(delay);
+            if (firedTimers.size() == delays.size()) {
+                completionPromise.set_value();
+            }
+        });
+    }
+    
+    auto cancelledTimer = wheel.schedule(startTime + std::chrono::milliseconds(50), []() {
+        ADD_FAILURE() << "Cancelled timer fired.";
+    });
+    EXPECT_TRUE(cancelledTimer.cancel());
+    
+    ASSERT_EQ(completionPromise.get_future().wait_for(DEFAULT_TIMEOUT), std::future_status::ready);
+    EXPECT_FALSE(didFireEarly);
+    EXPECT_EQ(wheel.getPendingTimerCount(), 0u);
+    
+    std::lock_guard<std::mutex> lock(mutex);
+    EXPECT_TRUE(std::is_sorted(firedTimers.begin(), firedTimers.end()));
+}
+
+TEST(TimerWheelTests, DestroyedQueueDiscardsTimers) {
+    std::atomic<int> fireCount(0);
+    std::promise<void> laterPromise;
+    
+    {
+        DispatchQueue queue("ca.mooredev.remote_core.TimerWheelTests.serial_dispatch_queue");
+        queue.executeAfter(std::chrono::milliseconds(10), [&fireCount]() {
+            fireCount++;
+        });
+    }
+    
+    DispatchQueue otherQueue("ca.mooredev.remote_core.TimerWheelTests.serial_dispatch_queue");
+    otherQueue.executeAfter(std::chrono::milliseconds(30), [&laterPromise]() {
+        laterPromise.set_value();
+    });
+    
+    ASSERT_EQ(laterPromise.get_future().wait_for(DEFAULT_TIMEOUT), std::future_status::ready);
+    EXPECT_EQ(fireCount, 0);
+}
@@ -0,0 +1,79 @@
+//
+//  TlsCipherPolicyTests.cpp
+//  remote_core_unit_tests
+//
+//  Created by David Moore on 10/19/26.
+//  Copyright © 2026 David Moore. All rights reserved.
+//
+
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <gtest/gtest.h>
+#include <openssl/ssl.h>
+#include "StreamTransport.hpp"
+#include "TlsCipherPolicy.hpp"
+
+using namespace RemoteCore;
+
+// MARK: - Test Fixture
+
+class TlsCipherPolicyTests : public testing::Test {
+protected:
+    /**
+     Returns the name of the cipher the context offers first.
+     */
+    static std::string getFirstCipherName(const TlsCipherPolicy &policy) {
+        std::unique_ptr<SSL_CTX, decltype(&SSL_CTX_free)> context(SSL_CTX_new(TLS_client_method()), SSL_CTX_free);
+        EXPECT_TRUE(policy.apply(context.get(), false));
+        
+        STACK_OF(SSL_CIPHER) *ciphers = SSL_CTX_get_ciphers(context.get());
+        return sk_SSL_CIPHER_num(ciphers) > 0 ? SSL_CIPHER_get_name(sk_SSL_CIPHER_value(ciphers, 0)) : "";
+    }
+    
+    static bool startsWith(const std::string &string, const std::string &prefix) {
+        return string.compare(0, prefix.size(), prefix) == 0;
+    }
+};
+
+// MARK: - Tests
+
+TEST_F(TlsCipherPolicyTests, PreferChaChaWithoutAES) {
+    auto policy = TlsCipherPolicy::makePreferred(false);
+    EXPECT_TRUE(startsWith(policy.cipherList, "ECDHE-ECDSA-CHACHA20-POLY1305:"));
+    EXPECT_TRUE(startsWith(policy.cipherSuites, "TLS_CHACHA20_POLY1305_SHA256:"));
+    EXPECT_TRUE(startsWith(policy.groups, "X25519:"));
+    EXPECT_EQ(getFirstCipherName(policy), "TLS_CHACHA20_POLY1305_SHA256");
+}
+
+TEST_F(TlsCipherPolicyTests, PreferAESWithAES) {
+    auto policy = TlsCipherPolicy::makePreferred(true);
+    EXPECT_TRUE(startsWith(policy.cipherList, "ECDHE-ECDSA-AES128-GCM-SHA256:"));
+    EXPECT_TRUE(startsWith(policy.cipherSuites, "TLS_AES_128_GCM_SHA256:"));
+    EXPECT_TRUE(startsWith(policy.groups, "X25519:"));
+    EXPECT_EQ(getFirstCipherName(policy), "TLS_AES_128_GCM_SHA256");
+    
+    // Both offer the same ciphers, in a different order.
+    EXPECT_NE(policy.cipherList.find("CHACHA20"), std::string::npos);
+    EXPECT_NE(policy.cipherSuites.find("CHACHA20"), std::string::npos);
+}
+
+TEST_F(TlsCipherPolicyTests, EmptyListsKeepDefaults) {
+    std::unique_ptr<SSL_CTX, decltype(&SSL_CTX_free)> context(SSL_CTX_new(TLS_client_method()), SSL_CTX_free);
+    int defaultCipherCount = sk_SSL_CIPHER_num(SSL_CTX_get_ciphers(context.get()));
+    
+    EXPECT_TRUE(TlsCipherPolicy().apply(context.get(), false));
+    EXPECT_EQ(sk_SSL_CIPHER_num(SSL_CTX_get_ciphers(context.get())), defaultCipherCount);
+}
+
+TEST_F(TlsCipherPolicyTests, RejectUnsupportedLists) {
+    std::unique_ptr<SSL_CTX, decltype(&SSL_CTX_free)> context(SSL_CTX_new(TLS_client_method()), SSL_CTX_free);
+    
+    TlsCipherPolicy policy;
+    policy.groups = "not-a-group";
+    EXPECT_FALSE(policy.apply(context.get(), false));
+    
+    TlsConfiguration configuration;
+    configuration.cipherPolicy.cipherList = "NOT-A-CIPHER";
+    EXPECT_THROW(TlsTransport::makeContext(configuration), std::runtime_error);
+}
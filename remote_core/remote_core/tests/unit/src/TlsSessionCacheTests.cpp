@@ -0,0 +1,231 @@
+//
+//  TlsSessionCacheTests.cpp
+//  remote_core_unit_tests
+//
+//  Created by David Moore on 10/19/26.
+//  Copyright © 2026 David Moore. All rights reserved.
+//
+
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <gtest/gtest.h>
+#include "StreamTransport.hpp"
+#include "TlsCredentialCache.hpp"
+#include "TlsSessionCache.hpp"
+#include "TlsTestSupport.hpp"
+
+using namespace RemoteCore;
+
+#define DEFAULT_SERVER_NAME "localhost"
+#define DEFAULT_TIMEOUT_MILLISECONDS 5000
+
+/**
+ Waits for the readiness the result asks for, and returns false if it did not arrive in time.
+ */
+static bool waitForResult(int fd, const TransportResult &result) {
+    struct pollfd descriptor = {fd, (short)(result.status == TransportStatus::WantWrite ? POLLOUT : POLLIN), 0};
+    return poll(&descriptor, 1, DEFAULT_TIMEOUT_MILLISECONDS) == 1;
+}
+
+// MARK: - Test Fixture
+
+class TlsSessionCacheTests : public testing::Test {
+protected:
+    std::string certificatePath;
+    std::string privateKeyPath;
+    std::string sessionCachePath;
+    TlsConfiguration serverConfiguration;
+    std::shared_ptr<SSL_CTX> serverContext;
+    int listenFD = -1;
+    
+    void SetUp() override {
+        std::string prefix = testing::TempDir() + "remote_core_tls_" + testing::UnitTest::GetInstance()->current_test_info()->name();
+        certificatePath = prefix + "_certificate.pem";
+        privateKeyPath = prefix + "_key.pem";
+        sessionCachePath = prefix + "_sessions.bin";
+        std::remove(sessionCachePath.c_str());
+        TestSupport::writeSelfSignedCertificate(certificatePath, privateKeyPath);
+        
+        serverConfiguration.certificatePath = certificatePath;
+        serverConfiguration.privateKeyPath = privateKeyPath;
+        serverConfiguration.isServer = true;
+        serverConfiguration.verifiesPeer = false;
+        serverContext = TlsTransport::makeContext(serverConfiguration);
+        
+        listenFD = StreamTransport::listenOnLoopback(0);
+    }
+    
+    void TearDown() override {
+        close(listenFD);
+        TlsCredentialCache::removeAll();
+        std::remove(certificatePath.c_str());
+        std::remove(privateKeyPath.c_str());
+        std::remove(sessionCachePath.c_str());
+    }
+    
+    TlsConfiguration clientConfiguration(std::shared_ptr<TlsSessionCache> sessionCache) {
+        TlsConfiguration configuration;
+        configuration.rootCAPath = certificatePath;
+        configuration.serverName = DEFAULT_SERVER_NAME;
+        configuration.sessionCache = sessionCache;
+        return configuration;
+    }
+    
+    /**
+     Connects a client to the server, exchanges a message so that the client receives any TLS 1.3 session tickets, and returns whether the session was resumed.
+     */
+    bool connect(std::shared_ptr<SSL_CTX> clientContext, const TlsConfiguration &configuration) {
+        SocketAddress address;
+        SocketAddress::parse("127.0.0.1", StreamTransport::getLocalPort(listenFD), address);
+        TlsTransport client(StreamTransport::startConnecting(address), clientContext, configuration);
+        
+        int serverFD = -1;
+        for (auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(DEFAULT_TIMEOUT_MILLISECONDS); serverFD < 0 && std::chrono::steady_clock::now() < deadline;) {
+            serverFD = accept(listenFD, nullptr, nullptr);
+            if (serverFD < 0) {
+                waitForResult(listenFD, TransportResult(TransportStatus::WantRead));
+            }
+        }
+        
+        if (serverFD < 0) {
+            ADD_FAILURE() << "Timed out waiting for the connection.";
+            return false;
+        }
+        
+        TlsTransport server(serverFD, serverContext, serverConfiguration);
+        
+        // Each side's handshake waits on the other's, so they take turns.
+        bool isClientComplete = false;
+        bool isServerComplete = false;
+        for (int i = 0; i < 100 && !(isClientComplete && isServerComplete); i++) {
+            for (auto transport : {&client, &server}) {
+                bool &isComplete = transport == &client ? isClientComplete : isServerComplete;
+                if (!isComplete) {
+                    auto result = transport->handshake();
+                    isComplete = result.status == TransportStatus::Complete;
+                    if (result.status == TransportStatus::Failed) {
+                        ADD_FAILURE() << "The handshake failed.";
+                        return false;
+                    }
+                }
+            }
+            
+            if (!(isClientComplete && isServerComplete)) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            }
+        }
+        
+        if (!(isClientComplete && isServerComplete)) {
+            ADD_FAILURE() << "Timed out waiting for the handshake.";
+            return false;
+        }
+        
+        EXPECT_EQ(server.write("ping", 4).status, TransportStatus::Complete);
+        char buffer[4];
+        auto result = client.read(buffer, sizeof(buffer));
+        while (result.status == TransportStatus::WantRead && waitForResult(client.getDescriptor(), result)) {
+            result = client.read(buffer, sizeof(buffer));
+        }
+        
+        EXPECT_EQ(result.status, TransportStatus::Complete);
+        return client.isSessionResumed();
+    }
+};
+
+// MARK: - Tests
+
+TEST_F(TlsSessionCacheTests, ResumeSession) {
+    auto sessionCache = std::make_shared<TlsSessionCache>();
+    auto configuration = clientConfiguration(sessionCache);
+    auto clientContext = TlsTransport::makeContext(configuration);
+    
+    EXPECT_FALSE(connect(clientContext, configuration));
+    EXPECT_TRUE(sessionCache->containsSession(DEFAULT_SERVER_NAME));
+    
+    // The connection above was dropped without waiting for the server's 'close_notify', as it would be when the network drops.
+    EXPECT_TRUE(connect(clientContext, configuration));
+    
+    auto statistics = sessionCache->getStatistics();
+    EXPECT_EQ(statistics.fullHandshakeCount, 1u);
+    EXPECT_EQ(statistics.resumedHandshakeCount, 1u);
+    EXPECT_GE(statistics.storedSessionCount, 2u);
+}
+
+TEST_F(TlsSessionCacheTests, RemoveSession) {
+    auto sessionCache = std::make_shared<TlsSessionCache>();
+    auto configuration = clientConfiguration(sessionCache);
+    auto clientContext = TlsTransport::makeContext(configuration);
+    EXPECT_FALSE(connect(clientContext, configuration));
+    
+    sessionCache->removeSession(DEFAULT_SERVER_NAME);
+    EXPECT_FALSE(sessionCache->containsSession(DEFAULT_SERVER_NAME));
+    EXPECT_FALSE(connect(clientContext, configuration));
+    EXPECT_EQ(sessionCache->getStatistics().fullHandshakeCount, 2u);
+}
+
+TEST_F(TlsSessionCacheTests, PersistAcrossRestarts) {
+    {
+        auto sessionCache = std::make_shared<TlsSessionCache>(sessionCachePath);
+        auto configuration = clientConfiguration(sessionCache);
+        EXPECT_FALSE(connect(TlsTransport::makeContext(configuration), configuration));
+    }
+    
+    auto sessionCache = std::make_shared<TlsSessionCache>(sessionCachePath);
+    EXPECT_TRUE(sessionCache->containsSession(DEFAULT_SERVER_NAME));
+    
+    auto configuration = clientConfiguration(sessionCache);
+    EXPECT_TRUE(connect(TlsTransport::makeContext(configuration), configuration));
+}
+
+TEST_F(TlsSessionCacheTests, IgnoreDamagedFile) {
+    {
+        std::ofstream file(sessionCachePath, std::ios::binary);
+        file << "RCTS1" << std::string(64, '\xff');
+    }
+    
+    auto sessionCache = std::make_shared<TlsSessionCache>(sessionCachePath);
+    EXPECT_FALSE(sessionCache->containsSession(DEFAULT_SERVER_NAME));
+    
+    auto configuration = clientConfiguration(sessionCache);
+    EXPECT_FALSE(connect(TlsTransport::makeContext(configuration), configuration));
+}
+
+TEST_F(TlsSessionCacheTests, CacheCredentials) {
+    // The server's context already loaded the certificate and key.
+    auto statistics = TlsCredentialCache::getStatistics();
+    
+    TlsConfiguration configuration;
+    configuration.rootCAPath = certificatePath;
+    configuration.certificatePath = certificatePath;
+    configuration.privateKeyPath = privateKeyPath;
+    TlsTransport::makeContext(configuration);
+    
+    auto cachedStatistics = TlsCredentialCache::getStatistics();
+    EXPECT_EQ(cachedStatistics.loadCount, statistics.loadCount + 1);
+    EXPECT_EQ(cachedStatistics.hitCount, statistics.hitCount + 2);
+    
+    // Replacing the files loads them again.
+    TestSupport::writeSelfSignedCertificate(certificatePath, privateKeyPath);
+    TlsTransport::makeContext(configuration);
+    
+    auto reloadedStatistics = TlsCredentialCache::getStatistics();
+    EXPECT_EQ(reloadedStatistics.loadCount, cachedStatistics.loadCount + 3);
+}
+
+TEST_F(TlsSessionCacheTests, RejectMissingCredentials) {
+    TlsConfiguration configuration;
+    configuration.rootCAPath = certificatePath + ".missing";
+    EXPECT_THROW(TlsTransport::makeContext(configuration), std::runtime_error);
+    
+    configuration.rootCAPath.clear();
+    configuration.certificatePath = certificatePath;
+    configuration.privateKeyPath = privateKeyPath + ".missing";
+    EXPECT_THROW(TlsTransport::makeContext(configuration), std::runtime_error);
+}
@@ -0,0 +1,160 @@
+//
+//  TopicRouterTests.cpp
+//  remote_core_unit_tests
+//
+//  Created by David Moore on 10/19/26.
+//  Copyright © 2026 David Moore. All rights reserved.
+//
+
+#include <algorithm>
+#include <atomic>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+#include <gtest/gtest.h>
+#include "TopicRouter.hpp"
+
+using namespace RemoteCore;
+
+TEST(TopicRouterTests, ValidFilters) {
+    EXPECT_TRUE(TopicRouter::isValidFilter("remote_core/account/+/device"));
+    EXPECT_TRUE(TopicRouter::isValidFilter("remote_core/#"));
+    EXPECT_TRUE(TopicRouter::isValidFilter("#"));
+    EXPECT_TRUE(TopicRouter::isValidFilter("+/+"));
+    
+    EXPECT_FALSE(TopicRouter::isValidFilter(""));
+    EXPECT_FALSE(TopicRouter::isValidFilter("remote_core/#/device"));
+    EXPECT_FALSE(TopicRouter::isValidFilter("remote_core/account+"));
+    EXPECT_FALSE(TopicRouter::isValidFilter("remote_core#"));
+}
+
+TEST(TopicRouterTests, FilterMatchesTopic) {
+    EXPECT_TRUE(TopicRouter::filterMatchesTopic("a/b/c", "a/b/c"));
+    EXPECT_TRUE(TopicRouter::filterMatchesTopic("a/+/c", "a/b/c"));
+    EXPECT_TRUE(TopicRouter::filterMatchesTopic("a/#", "a/b/c"));
+    EXPECT_TRUE(TopicRouter::filterMatchesTopic("a/#", "a"));
+    EXPECT_TRUE(TopicRouter::filterMatchesTopic("+/+", "/b"));
+    EXPECT_TRUE(TopicRouter::filterMatchesTopic("$aws/#", "$aws/things"));
+    
+    EXPECT_FALSE(TopicRouter::filterMatchesTopic("a/+", "a/b/c"));
+    EXPECT_FALSE(TopicRouter::filterMatchesTopic("a/b", "a"));
+    EXPECT_FALSE(TopicRouter::filterMatchesTopic("#", "$aws/things"));
+    EXPECT_FALSE(TopicRouter::filterMatchesTopic("+/things", "$aws/things"));
+}
+
+TEST(TopicRouterTests, RouteToMatchingHandlers) {
+    TopicRouter router;
+    std::vector<std::string> calls;
+    auto handlerNamed = [&calls](std::string name) {
+        return [&calls, name](const std::string &topicName, const std::string &payload, const MqttProperties &properties) {
+            calls.push_back(name + ":" + payload);
+        };
+    };
+    
+    router.addRoute("remote_core/account/user/device", handlerNamed("exact"));
+    router.addRoute("remote_core/account/+/device", handlerNamed("single"));
+    router.addRoute("remote_core/#", handlerNamed("multi"));
+    router.addRoute("remote_core/account/other/device", handlerNamed("other"));
+    EXPECT_EQ(router.getRouteCount(), 4u);
+    
+    EXPECT_EQ(router.route("remote_core/account/user/device", "1"), 3u);
+    EXPECT_EQ(router.route("remote_core", "2"), 1u);
+    EXPECT_EQ(router.route("unrelated/topic", "3"), 0u);
+    
+    std::sort(calls.begin(), calls.end());
+    EXPECT_EQ(calls, std::vector<std::string>({"exact:1", "multi:1", "multi:2", "single:1"}));
+    
+    EXPECT_THROW(router.addRoute("remote_core/#/device", handlerNamed("invalid")), std::invalid_argument);
+}
+
+TEST(TopicRouterTests, RouteWithProperties) {
+    TopicRouter router;
+    MqttProperties receivedProperties;
+    router.addRoute("remote_core/+", [&receivedProperties](const std::string &, const std::string &, const MqttProperties &properties) {
+        receivedProperties = properties;
+    });
+    
+    MqttProperties properties;
+    properties.responseTopic = "remote_core/responses";
+    properties.correlationData = "request-1";
+    EXPECT_EQ(router.route("remote_core/device", "", properties), 1u);
+    EXPECT_EQ(receivedProperties.responseTopic, "remote_core/responses");
+    EXPECT_EQ(receivedProperties.correlationData, "request-1");
+    
+    // Messages routed without properties, such as those received with MQTT 3.1.1, have none.
+    EXPECT_EQ(router.route("remote_core/device", ""), 1u);
+    EXPECT_TRUE(receivedProperties.isEmpty());
+}
+
+TEST(TopicRouterTests, ReplaceAndRemoveRoutes) {
+    TopicRouter router;
+    int firstCount = 0;
+    int secondCount = 0;
+    
+    router.addRoute("a/+", [&firstCount](const std::string &, const std::string &, const MqttProperties &) {
+        firstCount++;
+    });
+    router.addRoute("a/+", [&secondCount](const std::string &, const std::string &, const MqttProperties &) {
+        secondCount++;
+    });
+    EXPECT_EQ(router.getRouteCount(), 1u);
+    
+    router.route("a/b", "");
+    EXPECT_EQ(firstCount, 0);
+    EXPECT_EQ(secondCount, 1);
+    
+    EXPECT_FALSE(router.removeRoute("a"));
+    EXPECT_FALSE(router.removeRoute("a/b"));
+    EXPECT_TRUE(router.removeRoute("a/+"));
+    EXPECT_FALSE(router.removeRoute("a/+"));
+    EXPECT_EQ(router.getRouteCount(), 0u);
+    EXPECT_EQ(router.route("a/b", ""), 0u);
+}
+
+TEST(TopicRouterTests, HandlersMayChangeRoutes) {
+    TopicRouter router;
+    int nestedCount = 0;
+    
+    // Adding a route from a handler would deadlock if handlers were called with a lock held.
+    router.addRoute("outer", [&router, &nestedCount](const std::string &, const std::string &, const MqttProperties &) {
+        router.addRoute("inner", [&nestedCount](const std::string &, const std::string &, const MqttProperties &) {
+            nestedCount++;
+        });
+        router.removeRoute("outer");
+    });
+    
+    EXPECT_EQ(router.route("outer", ""), 1u);
+    EXPECT_EQ(router.route("outer", ""), 0u);
+    EXPECT_EQ(router.route("inner", ""), 1u);
+    EXPECT_EQ(nestedCount, 1);
+}
+
+TEST(TopicRouterTests, ConcurrentRoutingAndChanges) {
+    TopicRouter router;
+    std::atomic<int> stableCount(0);
+    std::atomic<bool> isDone(false);
+    
+    router.addRoute("stable/+", [&stableCount](const std::string &, const std::string &, const MqttProperties &) {
+        stableCount++;
+    });
+    
+    std::thread writer([&router, &isDone]() {
+        for (int i = 0; i < 1000; i++) {
+            auto filter = "volatile/" + std::to_string(i % 10);
+            router.addRoute(filter, [](const std::string &, const std::string &, const MqttProperties &) {});
+            router.removeRoute(filter);
+        }
+        
+        isDone = true;
+    });
+    
+    int routedCount = 0;
+    while (!isDone) {
+        router.route("stable/topic", "");
+        routedCount++;
+    }
+    
+    writer.join();
+    EXPECT_EQ(stableCount, routedCount);
+    EXPECT_EQ(router.getRouteCount(), 1u);
+}
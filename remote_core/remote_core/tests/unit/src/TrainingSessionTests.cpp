@@ -0,0 +1,131 @@
+//
+//  TrainingSessionTests.cpp
+//  remote_core_unit_tests
+//
+//  Created by David Moore on 10/19/26.
+//  Copyright © 2026 David Moore. All rights reserved.
+//
+
+#include <cstdio>
+#include <fstream>
+#include <future>
+#include <sstream>
+#include <gtest/gtest.h>
+#include "TrainingSession.hpp"
+#include "MetricsRegistry.hpp"
+
+using namespace RemoteCore;
+
+#define DEFAULT_TIMEOUT std::chrono::seconds(5)
+
+#define TELEVISION_CONFIGURATION \
+"begin remote\n" \
+"  name  LG_TV\n" \
+"  bits           16\n" \
+"  flags SPACE_ENC|CONST_LENGTH\n" \
+"  header       9000  4500\n" \
+"  one           560  1690\n" \
+"  zero          560   560\n" \
+"  ptrail        560\n" \
+"  pre_data_bits   16\n" \
+"  pre_data       0x20DF\n" \
+"  gap          108000\n" \
+"      begin codes\n" \
+"          KEY_POWER                0x10EF\n" \
+"          KEY_VOLUMEUP             0x40BF\n" \
+"      end codes\n" \
+"end remote\n"
+
+class TrainingSessionErrorDelegate : public TrainingSessionDelegate {
+public:
+    std::promise<Error> errorPromise;
+    
+    void trainingSessionDidFailWithError(TrainingSession *session, Error error) override {
+        errorPromise.set_value(error);
+    }
+};
+
+class TrainingSessionIdentificationDelegate : public TrainingSessionErrorDelegate {
+public:
+    void trainingSessionDidIdentifyRemote(TrainingSession *session, Remote remote) override {
+        errorPromise.set_value(Error::None);
+    }
+};
+
+TEST(TrainingSessionTests, IdleTimeout) {
+    auto delegate = std::make_shared<TrainingSessionErrorDelegate>();
+    auto errorFuture = delegate->errorPromise.get_future();
+    
+    TrainingSession session(Remote("Living Room", "living_room"));
+    session.setDelegate(delegate);
+    session.setIdleTimeout(std::chrono::milliseconds(20));
+    session.start();
+    
+    ASSERT_EQ(errorFuture.wait_for(DEFAULT_TIMEOUT), std::future_status::ready);
+    EXPECT_EQ(errorFuture.get(), Error::TrainingTimedOut);
+}
+
+TEST(TrainingSessionTests, SuspendCancelsIdleTimeout) {
+    auto delegate = std::make_shared<TrainingSessionErrorDelegate>();
+    auto errorFuture = delegate->errorPromise.get_future();
+    
+    TrainingSession session(Remote("Living Room", "living_room"));
+    session.setDelegate(delegate);
+    session.setIdleTimeout(std::chrono::milliseconds(20));
+    session.start();
+    session.suspend();
+    
+    EXPECT_EQ(errorFuture.wait_for(std::chrono::milliseconds(100)), std::future_status::timeout);
+}
+
+TEST(TrainingSessionTests, IdentifyRemoteReplacesCommands) {
+    auto library = std::make_shared<RemoteLibrary>();
+    std::istringstream configuration(TELEVISION_CONFIGURATION);
+    ASSERT_EQ(library->loadConfiguration(configuration), 1u);
+    
+    // Record the power button being pressed twice, as a receiver would.
+    auto capturePath = testing::TempDir() + "remote_core_identify_remote.mode2";
+    {
+        auto &codebook = library->getCodebook(0);
+        auto frame = codebook.learnedCodeForButton(codebook.buttons.front()).rawFrame;
+        
+        std::ofstream capture(capturePath);
+        for (int i = 0; i < 2; i++) {
+            capture << "space 100000\n";
+            for (size_t j = 0; j < frame.size(); j++) {
+                capture << (j % 2 == 0 ? "pulse " : "space ") << frame[j] << "\n";
+            }
+        }
+        capture << "space 100000\n";
+    }
+    
+    // The remote already has a command that the codebook shares, and one that it does not.
+    Remote remote("Living Room", "living_room");
+    remote.commands.push_back(Command("Power", "KEY_POWER"));
+    remote.commands.push_back(Command("Mute", "KEY_MUTE"));
+    
+    auto delegate = std::make_shared<TrainingSessionIdentificationDelegate>();
+    auto errorFuture = delegate->errorPromise.get_future();
+    
+    auto &identificationLatency = MetricsRegistry::sharedRegistry().histogram("remote_core_training_learning_latency_seconds", "Time taken to learn a code, from the start of the request until it was decoded.", {{"operation", "identify"}});
+    auto recordedCount = identificationLatency.getSnapshot().count;
+    
+    TrainingSession session(remote);
+    session.setDelegate(delegate);
+    session.setRemoteLibrary(library);
+    session.setCaptureSourcePath(capturePath);
+    session.identifyRemote();
+    
+    ASSERT_EQ(errorFuture.wait_for(DEFAULT_TIMEOUT), std::future_status::ready);
+    ASSERT_EQ(errorFuture.get(), Error::None);
+    
+    auto commands = session.getAssociatedRemote().commands;
+    ASSERT_EQ(commands.size(), 2u);
+    EXPECT_EQ(commands[0].getCommandID(), "KEY_POWER");
+    EXPECT_EQ(commands[1].getCommandID(), "KEY_VOLUMEUP");
+    EXPECT_TRUE(session.learnedCodeForCommand(commands[0]).isValid());
+    EXPECT_EQ(identificationLatency.getSnapshot().count, recordedCount + 1);
+    
+    std::remove(capturePath.c_str());
+    std::remove("remotes/living_room.lircd.conf");
+}
@@ -0,0 +1,225 @@
+//
+//  CatalogGenerator.cpp
+//  remote_core_catalog_generator
+//
+//  Created by David Moore on 10/19/26.
+//  Copyright © 2026 David Moore. All rights reserved.
+//
+
+#include <algorithm>
+#include <cctype>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include "nlohmann/json.hpp"
+#include "Catalog.hpp"
+
+#define CATALOG_GENERATOR_KEYS_PER_BUCKET 4
+#define CATALOG_GENERATOR_MAXIMUM_SEED 10000000u
+
+using namespace RemoteCore;
+
+/**
+ Seeds and slots of a perfect hash table, as they will be emitted.
+ */
+struct GeneratedTable {
+    std::vector<uint32_t> seeds;
+    std::vector<uint16_t> slots;
+};
+
+std::vector<std::string> readKeys(const std::string &path) {
+    std::ifstream stream(path);
+    if (!stream.is_open()) {
+        throw std::runtime_error("Unable to open '" + path + "'.");
+    }
+    
+    auto json = nlohmann::json::parse(stream);
+    return json.get<std::vector<std::string>>();
+}
+
+GeneratedTable generateTable(const std::vector<std::string> &keys) {
+    size_t bucketCount = std::max<size_t>(1, (keys.size() + CATALOG_GENERATOR_KEYS_PER_BUCKET - 1) / CATALOG_GENERATOR_KEYS_PER_BUCKET);
+    size_t slotCount = keys.size() + keys.size() / 4 + 1;
+    if (slotCount >= UINT16_MAX) {
+        throw std::runtime_error("Too many keys for a catalog.");
+    }
+    
+    GeneratedTable table;
+    table.seeds.assign(bucketCount, 0);
+    table.slots.assign(slotCount, (uint16_t)keys.size());
+    
+    std::vector<std::vector<size_t>> buckets(bucketCount);
+    for (size_t i = 0; i < keys.size(); i++) {
+        buckets[catalogHash(keys[i].data(), keys[i].size(), 0) % bucketCount].push_back(i);
+    }
+    
+    // Place the largest buckets first, while most slots are still free.
+    std::vector<size_t> bucketOrder(bucketCount);
+    for (size_t i = 0; i < bucketCount; i++) {
+        bucketOrder[i] = i;
+    }
+    
+    std::stable_sort(bucketOrder.begin(), bucketOrder.end(), [&buckets](size_t lhs, size_t rhs) {
+        return buckets[lhs].size() > buckets[rhs].size();
+    });
+    
+    for (auto bucketIndex : bucketOrder) {
+        auto &bucket = buckets[bucketIndex];
+        if (bucket.empty()) {
+            continue;
+        }
+        
+        bool isPlaced = false;
+        for (uint32_t seed = 1; seed < CATALOG_GENERATOR_MAXIMUM_SEED && !isPlaced; seed++) {
+            std::vector<size_t> candidateSlots;
+            for (auto keyIndex : bucket) {
+                auto &key = keys[keyIndex];
+                size_t slot = catalogHash(key.data(), key.size(), seed) % slotCount;
+                if (table.slots[slot] != keys.size() || std::find(candidateSlots.begin(), candidateSlots.end(), slot) != candidateSlots.end()) {
+                    break;
+                }
+                
+                candidateSlots.push_back(slot);
+            }
+            
+            if (candidateSlots.size() == bucket.size()) {
+                for (size_t i = 0; i < bucket.size(); i++) {
+                    table.slots[candidateSlots[i]] = (uint16_t)bucket[i];
+                }
+                
+                table.seeds[bucketIndex] = seed;
+                isPlaced = true;
+            }
+        }
+        
+        if (!isPlaced) {
+            throw std::runtime_error("Unable to find a perfect hash for the catalog.");
+        }
+    }
+    
+    return table;
+}
+
+/**
+ Writes the keys and their table within the current namespace of the stream.
+ */
+void writeTable(std::ostream &stream, const std::vector<std::string> &keys, const GeneratedTable &table, const std::string &indentation) {
+    stream << indentation << "constexpr size_t keyCount = " << keys.size() << ";\n\n";
+    
+    stream << indentation << "constexpr const char *keys[] = {\n";
+    for (auto &key : keys) {
+        stream << indentation << "    \"" << key << "\",\n";
+    }
+    stream << indentation << "};\n\n";
+    
+    stream << indentation << "constexpr uint32_t seeds[] = {";
+    for (size_t i = 0; i < table.seeds.size(); i++) {
+        stream << (i % 12 == 0 ? "\n" + indentation + "    " : " ") << table.seeds[i] << ",";
+    }
+    stream << "\n" << indentation << "};\n\n";
+    
+    stream << indentation << "constexpr uint16_t slots[] = {";
+    for (size_t i = 0; i < table.slots.size(); i++) {
+        stream << (i % 16 == 0 ? "\n" + indentation + "    " : " ") << table.slots[i] << ",";
+    }
+    stream << "\n" << indentation << "};\n\n";
+    
+    stream << indentation << "constexpr CatalogTable table = {keys, keyCount, seeds, " << table.seeds.size() << ", slots, " << table.slots.size() << "};\n";
+}
+
+std::string generateCommandIDCatalog(std::vector<std::string> commandIDs) {
+    // Sorted, so that training sessions can copy the command IDs without sorting them.
+    std::sort(commandIDs.begin(), commandIDs.end());
+    commandIDs.erase(std::unique(commandIDs.begin(), commandIDs.end()), commandIDs.end());
+    
+    std::ostringstream stream;
+    stream << "// Generated by remote_core_catalog_generator from 'config/remote_core_command_ids.json'. Do not edit.\n\n";
+    stream << "#ifndef CommandIDCatalog_hpp\n#define CommandIDCatalog_hpp\n\n";
+    stream << "#include \"Catalog.hpp\"\n\n";
+    stream << "namespace RemoteCore {\n";
+    stream << "    namespace CommandIDCatalog {\n";
+    writeTable(stream, commandIDs, generateTable(commandIDs), "        ");
+    stream << "    }\n";
+    stream << "}\n\n";
+    stream << "#endif /* CommandIDCatalog_hpp */\n";
+    
+    return stream.str();
+}
+
+std::string generateDirectiveCatalog(const std::vector<std::string> &directives) {
+    std::ostringstream stream;
+    stream << "// Generated by remote_core_catalog_generator from 'config/remote_core_directives.json'. Do not edit.\n\n";
+    stream << "#ifndef DirectiveCatalog_hpp\n#define DirectiveCatalog_hpp\n\n";
+    stream << "#include \"Catalog.hpp\"\n\n";
+    stream << "namespace RemoteCore {\n";
+    
+    // Enumerators are the directive names with the first letter capitalized, in the order they are declared.
+    stream << "    enum class Directive {\n";
+    stream << "        Unknown = -1,\n";
+    for (size_t i = 0; i < directives.size(); i++) {
+        auto name = directives[i];
+        name[0] = (char)std::toupper(name[0]);
+        stream << "        " << name << " = " << i << ",\n";
+    }
+    stream << "    };\n\n";
+    
+    stream << "    namespace DirectiveCatalog {\n";
+    writeTable(stream, directives, generateTable(directives), "        ");
+    stream << "    }\n\n";
+    
+    stream << "    /**\n";
+    stream << "     Returns the directive with the given name, or 'Directive::Unknown'.\n";
+    stream << "     */\n";
+    stream << "    inline Directive directiveForName(const std::string &name) {\n";
+    stream << "        return (Directive)DirectiveCatalog::table.indexOfKey(name);\n";
+    stream << "    }\n\n";
+    stream << "    /**\n";
+    stream << "     Returns the name of the directive that is used within messages.\n";
+    stream << "     */\n";
+    stream << "    inline std::string nameForDirective(Directive directive) {\n";
+    stream << "        return directive == Directive::Unknown ? \"\" : DirectiveCatalog::keys[(size_t)directive];\n";
+    stream << "    }\n";
+    stream << "}\n\n";
+    stream << "#endif /* DirectiveCatalog_hpp */\n";
+    
+    return stream.str();
+}
+
+/**
+ Writes the contents to a file, unless the file is already up to date (which avoids rebuilding everything that includes it).
+ */
+void writeFile(const std::string &path, const std::string &contents) {
+    std::ifstream existingStream(path);
+    std::stringstream existingContents;
+    existingContents << existingStream.rdbuf();
+    if (existingStream.is_open() && existingContents.str() == contents) {
+        return;
+    }
+    
+    std::ofstream stream(path);
+    stream << contents;
+    if (!stream) {
+        throw std::runtime_error("Unable to write '" + path + "'.");
+    }
+}
+
+int main(int argc, const char *argv[]) {
+    if (argc != 4) {
+        std::cerr << "Usage: " << argv[0] << " <command ids json> <directives json> <output directory>" << std::endl;
+        return 1;
+    }
+    
+    try {
+        std::string outputDirectory = argv[3];
+        writeFile(outputDirectory + "/CommandIDCatalog.hpp", generateCommandIDCatalog(readKeys(argv[1])));
+        writeFile(outputDirectory + "/DirectiveCatalog.hpp", generateDirectiveCatalog(readKeys(argv[2])));
+    } catch (const std::exception &exception) {
+        std::cerr << argv[0] << ": " << exception.what() << std::endl;
+        return 1;
+    }
+    
+    return 0;
+}
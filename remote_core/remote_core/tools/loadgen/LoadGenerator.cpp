@@ -0,0 +1,571 @@
+//
+//  LoadGenerator.cpp
+//  remote_core_loadgen
+//
+//  Created by David Moore on 10/19/26.
+//  Copyright © 2026 David Moore. All rights reserved.
+//
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <tuple>
+#include <vector>
+#include <unistd.h>
+#include "Coder.hpp"
+#include "Coding.hpp"
+#include "JSONContainer.hpp"
+#include "Message.hpp"
+#include "MqttBroker.hpp"
+#include "MqttConnection.hpp"
+#include "TestSupport.hpp"
+
+using namespace RemoteCore;
+
+typedef std::chrono::steady_clock Clock;
+
+#define LOAD_GENERATOR_TOPIC_PREFIX "remote_core/account/"
+#define LOAD_GENERATOR_SENDER_PREFIX "loadgen-"
+#define LOAD_GENERATOR_RESPONDER_ID "loadgen-responder"
+#define LOAD_GENERATOR_COMMAND_TIMEOUT std::chrono::seconds(10)
+
+namespace {
+    struct Options {
+        std::string host = "127.0.0.1";
+        uint16_t port = 8883;
+        bool usesTLS = true;
+        std::string rootCAPath;
+        std::string certificatePath;
+        std::string privateKeyPath;
+        std::string serverName;
+        
+        /// Topic of the device under load, which both requests and responses are published to.
+        std::string topicName;
+        
+        size_t clientCount = 10;
+        
+        /// Messages per second sent by each client, of each kind.
+        double commandRate = 10;
+        double trainingRate = 1;
+        
+        std::chrono::milliseconds duration = std::chrono::seconds(10);
+        
+        /// Time to wait, after the last message was sent, for responses that are still outstanding.
+        std::chrono::milliseconds responseTimeout = std::chrono::seconds(5);
+        
+        uint8_t qualityOfService = 1;
+        
+        /// Connects with MQTT 5, so that every message after the first on the topic only carries its topic alias.
+        bool usesMqtt5 = false;
+        std::string remoteID = "loadgen";
+        std::string commandID = "KEY_POWER";
+        std::string directive = "identifyRemote";
+        
+        /// Runs a broker in the process, for the device and the clients to connect to.
+        bool runsBroker = false;
+        std::string brokerCertificatePath;
+        std::string brokerPrivateKeyPath;
+        
+        /// Answers requests in the process, as 'RemoteController' would, which measures everything but the device.
+        bool responds = false;
+    };
+    
+    enum class LoadKind {
+        Command,
+        Training
+    };
+    
+    /**
+     Message as it is sent to and from the device, with the same keys as 'Message'. 'Message' itself takes its sender from the device's configuration, which the load generator does not have.
+     */
+    class LoadMessage : public Coding {
+    public:
+        std::string senderID;
+        std::string messageID;
+        MessageType type = MessageType::Default;
+        std::unique_ptr<Remote> remote;
+        std::unique_ptr<Command> command;
+        std::string directive;
+        
+        void encodeWithCoder(Coder *aCoder) const override {
+            aCoder->encodeStringForKey(senderID, "senderID");
+            aCoder->encodeStringForKey(messageID, "messageID");
+            aCoder->encodeIntForKey(std::underlying_type<MessageType>::type(type), "type");
+            aCoder->encodeObjectForKey(remote.get(), "remote");
+            aCoder->encodeObjectForKey(command.get(), "command");
+            if (!directive.empty()) {
+                aCoder->encodeStringForKey(directive, "directive");
+            }
+        }
+        
+        void decodeWithCoder(const Coder *aCoder) override {
+            senderID = aCoder->decodeStringForKey("senderID");
+            messageID = aCoder->decodeStringForKey("messageID");
+            type = static_cast<MessageType>(aCoder->decodeIntForKey("type"));
+            remote = aCoder->decodeObjectForKey<Remote>("remote");
+            command = aCoder->decodeObjectForKey<Command>("command");
+            directive = aCoder->decodeStringForKey("directive");
+        }
+        
+        std::string generateData(void) const {
+            auto aCoder = std::make_unique<Coder>(std::make_unique<JSONContainer>());
+            aCoder->encodeRootObject(this);
+            return aCoder->invalidateCoder()->generateData();
+        }
+        
+        /**
+         Returns the decoded message, or null if the payload is not a message.
+         */
+        static std::unique_ptr<LoadMessage> decode(const std::string &payload) {
+            try {
+                auto aCoder = std::make_unique<Coder>(std::make_unique<JSONContainer>(payload));
+                return aCoder->decodeRootObject<LoadMessage>();
+            } catch (const std::exception &) {
+                return nullptr;
+            }
+        }
+    };
+    
+    /**
+     Latencies of answered requests, recorded from any thread.
+     */
+    class LatencyRecorder {
+        std::mutex mutex;
+        std::map<LoadKind, std::vector<Clock::duration>> latencies;
+    
+    public:
+        void record(LoadKind kind, Clock::duration latency) {
+            std::lock_guard<std::mutex> lock(mutex);
+            latencies[kind].push_back(latency);
+        }
+        
+        std::vector<Clock::duration> getLatencies(LoadKind kind) {
+            std::lock_guard<std::mutex> lock(mutex);
+            return latencies[kind];
+        }
+    };
+    
+    MqttConnectionOptions makeConnectionOptions(const Options &options, const std::string &clientID) {
+        MqttConnectionOptions connectionOptions;
+        connectionOptions.host = options.host;
+        connectionOptions.port = options.port;
+        connectionOptions.clientID = clientID;
+        connectionOptions.usesTLS = options.usesTLS;
+        connectionOptions.tlsConfiguration.rootCAPath = options.rootCAPath;
+        connectionOptions.tlsConfiguration.certificatePath = options.certificatePath;
+        connectionOptions.tlsConfiguration.privateKeyPath = options.privateKeyPath;
+        connectionOptions.tlsConfiguration.serverName = options.serverName.empty() ? options.host : options.serverName;
+        connectionOptions.tlsConfiguration.verifiesPeer = !options.rootCAPath.empty();
+        if (options.usesMqtt5) {
+            connectionOptions.protocolLevel = MQTT_5_PROTOCOL_LEVEL;
+        }
+        
+        return connectionOptions;
+    }
+    
+    /**
+     Connects the connection, and subscribes it to the topic. Throws 'std::runtime_error' if either fails.
+     */
+    void connectAndSubscribe(MqttConnection &connection, const std::string &topicName, uint8_t qualityOfService) {
+        if (TestSupport::waitForStatus([&](MqttConnection::CompletionHandler completionHandler) { connection.connect(completionHandler); }, LOAD_GENERATOR_COMMAND_TIMEOUT) != MqttStatus::Success) {
+            throw std::runtime_error("Unable to connect to the broker.");
+        }
+        
+        if (TestSupport::waitForStatus([&](MqttConnection::CompletionHandler completionHandler) { connection.subscribe({topicName}, qualityOfService, completionHandler); }, LOAD_GENERATOR_COMMAND_TIMEOUT) != MqttStatus::Success) {
+            throw std::runtime_error("Unable to subscribe to '" + topicName + "'.");
+        }
+    }
+    
+    /**
+     Simulated app, which sends requests to the device and matches the device's responses to them. Requests are told apart by the title of their remote, which every response repeats.
+     */
+    class Client {
+        struct PendingRequest {
+            LoadKind kind;
+            Clock::time_point scheduledTime;
+        };
+        
+        const Options &options;
+        std::string senderID;
+        std::string titlePrefix;
+        LatencyRecorder &recorder;
+        
+        std::mutex mutex;
+        std::map<std::string, PendingRequest> pendingRequests;
+        uint64_t lastSequenceNumber;
+        
+        std::atomic<uint64_t> failedCount;
+        
+        // Destroyed first, since its handlers use the members above.
+        MqttConnection connection;
+        
+        void handleMessage(const std::string &payload) {
+            // Every client receives every message on the topic, so those that cannot be its own are skipped before being decoded.
+            if (payload.find("\"" + titlePrefix) == std::string::npos) {
+                return;
+            }
+            
+            auto message = LoadMessage::decode(payload);
+            if (message == nullptr || message->remote == nullptr || (message->type != MessageType::CommandResponse && message->type != MessageType::TrainingResponse)) {
+                return;
+            }
+            
+            auto now = Clock::now();
+            PendingRequest request;
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                auto position = pendingRequests.find(message->remote->getLocalizedTitle());
+                if (position == pendingRequests.end()) {
+                    return;
+                }
+                
+                request = position->second;
+                pendingRequests.erase(position);
+            }
+            
+            recorder.record(request.kind, now - request.scheduledTime);
+        }
+    
+    public:
+        Client(const Options &options, size_t index, LatencyRecorder &recorder) : options(options), senderID(LOAD_GENERATOR_SENDER_PREFIX + std::to_string(index)), titlePrefix(senderID + "/"), recorder(recorder), lastSequenceNumber(0), failedCount(0), connection(makeConnectionOptions(options, "remote_core_loadgen_" + std::to_string(getpid()) + "_" + std::to_string(index))) {
+            connection.setMessageHandler([this](const std::string &topicName, const std::string &payload) {
+                handleMessage(payload);
+            });
+        }
+        
+        void connect(void) {
+            connectAndSubscribe(connection, options.topicName, options.qualityOfService);
+        }
+        
+        /**
+         Sends a request, whose latency is measured from the time it was scheduled for, rather than when it was sent, so that a stalled sender is not hidden.
+         */
+        void send(LoadKind kind, Clock::time_point scheduledTime) {
+            LoadMessage message;
+            message.senderID = senderID;
+            message.messageID = senderID + "-" + std::to_string(lastSequenceNumber + 1);
+            message.type = kind == LoadKind::Command ? MessageType::Command : MessageType::Training;
+            
+            std::string title = titlePrefix + std::to_string(++lastSequenceNumber);
+            message.remote = std::make_unique<Remote>(title, options.remoteID);
+            if (kind == LoadKind::Command) {
+                message.command = std::make_unique<Command>("", options.commandID);
+            } else {
+                message.directive = options.directive;
+            }
+            
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                pendingRequests[title] = {kind, scheduledTime};
+            }
+            
+            connection.publish({options.topicName, message.generateData(), options.qualityOfService, [this](MqttStatus status) {
+                if (status != MqttStatus::Success) {
+                    failedCount++;
+                }
+            }});
+        }
+        
+        size_t getPendingCount(void) {
+            std::lock_guard<std::mutex> lock(mutex);
+            return pendingRequests.size();
+        }
+        
+        uint64_t getFailedCount(void) const {
+            return failedCount;
+        }
+    };
+    
+    /**
+     Stands in for the device, answering each request with the response 'RemoteController' would send, without sending anything to the hardware.
+     */
+    class Responder {
+        const Options &options;
+        std::atomic<uint64_t> responseCount;
+        MqttConnection connection;
+    
+    public:
+        explicit Responder(const Options &options) : options(options), responseCount(0), connection(makeConnectionOptions(options, "remote_core_loadgen_" + std::to_string(getpid()) + "_responder")) {
+            connection.setMessageHandler([this](const std::string &topicName, const std::string &payload) {
+                auto request = LoadMessage::decode(payload);
+                if (request == nullptr || (request->type != MessageType::Command && request->type != MessageType::Training)) {
+                    return;
+                }
+                
+                LoadMessage response;
+                response.senderID = LOAD_GENERATOR_RESPONDER_ID;
+                response.messageID = request->messageID + "-response";
+                response.type = request->type == MessageType::Command ? MessageType::CommandResponse : MessageType::TrainingResponse;
+                response.remote = std::move(request->remote);
+                response.command = std::move(request->command);
+                response.directive = request->directive;
+                
+                connection.publish({topicName, response.generateData(), this->options.qualityOfService, nullptr});
+                responseCount++;
+            });
+        }
+        
+        void connect(void) {
+            connectAndSubscribe(connection, options.topicName, options.qualityOfService);
+        }
+        
+        uint64_t getResponseCount(void) const {
+            return responseCount;
+        }
+    };
+    
+    void printLatencies(const char *name, std::vector<Clock::duration> latencies) {
+        if (latencies.empty()) {
+            printf("%-9s answered %8zu\n", name, (size_t)0);
+            return;
+        }
+        
+        std::sort(latencies.begin(), latencies.end());
+        printf("%-9s answered %8zu, p50 %9.1f us, p99 %9.1f us, p999 %9.1f us, max %9.1f us\n", name, latencies.size(), TestSupport::percentile(latencies, 0.5), TestSupport::percentile(latencies, 0.99), TestSupport::percentile(latencies, 0.999), TestSupport::percentile(latencies, 1.0));
+    }
+    
+    void printUsage(const char *name) {
+        std::cerr << "Usage: " << name << " [options]\n"
+                  << "\n"
+                  << "Simulates app clients that send command and training messages to a device's topic, and reports the\n"
+                  << "throughput and latency of the device's responses.\n"
+                  << "\n"
+                  << "  --topic NAME              Device topic (or --user-id ID and --serial-number SERIAL).\n"
+                  << "  --host HOST               Broker host (127.0.0.1).\n"
+                  << "  --port PORT               Broker port (8883).\n"
+                  << "  --plain                   Connect without TLS.\n"
+                  << "  --root-ca PATH            Certificate the broker is verified against; unverified if omitted.\n"
+                  << "  --certificate PATH        Client certificate, for brokers that require one.\n"
+                  << "  --key PATH                Client private key.\n"
+                  << "  --server-name NAME        Name the broker's certificate is verified against (the host).\n"
+                  << "  --clients COUNT           Simulated apps (10).\n"
+                  << "  --command-rate RATE       Command messages per second, per client (10).\n"
+                  << "  --training-rate RATE      Training messages per second, per client (1).\n"
+                  << "  --duration SECONDS        Time spent sending (10).\n"
+                  << "  --response-timeout SECONDS Time to wait for the last responses (5).\n"
+                  << "  --qos LEVEL               Quality of service, 0 or 1 (1).\n"
+                  << "  --mqtt5                   Connect with MQTT 5, and publish with topic aliases.\n"
+                  << "  --remote-id ID            Remote that commands are sent to (loadgen).\n"
+                  << "  --command-id ID           Command that is sent (KEY_POWER).\n"
+                  << "  --directive NAME          Directive of training messages (identifyRemote).\n"
+                  << "  --broker                  Run a broker on the loopback interface, on --port.\n"
+                  << "  --broker-certificate PATH Certificate of the broker, which then uses TLS.\n"
+                  << "  --broker-key PATH         Private key of the broker.\n"
+                  << "  --respond                 Answer requests in this process, instead of a device.\n";
+    }
+    
+    /**
+     Reads the options from the arguments. Throws 'std::invalid_argument' if an option is unknown or lacks its value.
+     */
+    Options parseOptions(int argc, const char *argv[]) {
+        Options options;
+        std::string userID, serialNumber;
+        for (int i = 1; i < argc; i++) {
+            std::string name = argv[i];
+            auto value = [&]() -> std::string {
+                if (i + 1 >= argc) {
+                    throw std::invalid_argument("Expected a value for '" + name + "'.");
+                }
+                
+                return argv[++i];
+            };
+            
+            if (name == "--topic") {
+                options.topicName = value();
+            } else if (name == "--user-id") {
+                userID = value();
+            } else if (name == "--serial-number") {
+                serialNumber = value();
+            } else if (name == "--host") {
+                options.host = value();
+            } else if (name == "--port") {
+                options.port = (uint16_t)std::stoul(value());
+            } else if (name == "--plain") {
+                options.usesTLS = false;
+            } else if (name == "--root-ca") {
+                options.rootCAPath = value();
+            } else if (name == "--certificate") {
+                options.certificatePath = value();
+            } else if (name == "--key") {
+                options.privateKeyPath = value();
+            } else if (name == "--server-name") {
+                options.serverName = value();
+            } else if (name == "--clients") {
+                options.clientCount = std::max<size_t>(1, std::stoul(value()));
+            } else if (name == "--command-rate") {
+                options.commandRate = std::stod(value());
+            } else if (name == "--training-rate") {
+                options.trainingRate = std::stod(value());
+            } else if (name == "--duration") {
+                options.duration = std::chrono::milliseconds((int64_t)(std::stod(value()) * 1000));
+            } else if (name == "--response-timeout") {
+                options.responseTimeout = std::chrono::milliseconds((int64_t)(std::stod(value()) * 1000));
+            } else if (name == "--qos") {
+                options.qualityOfService = (uint8_t)std::min<unsigned long>(1, std::stoul(value()));
+            } else if (name == "--mqtt5") {
+                options.usesMqtt5 = true;
+            } else if (name == "--remote-id") {
+                options.remoteID = value();
+            } else if (name == "--command-id") {
+                options.commandID = value();
+            } else if (name == "--directive") {
+                options.directive = value();
+            } else if (name == "--broker") {
+                options.runsBroker = true;
+            } else if (name == "--broker-certificate") {
+                options.brokerCertificatePath = value();
+            } else if (name == "--broker-key") {
+                options.brokerPrivateKeyPath = value();
+            } else if (name == "--respond") {
+                options.responds = true;
+            } else {
+                throw std::invalid_argument("Unknown option '" + name + "'.");
+            }
+        }
+        
+        if (options.topicName.empty() && !userID.empty() && !serialNumber.empty()) {
+            options.topicName = LOAD_GENERATOR_TOPIC_PREFIX + userID + "/" + serialNumber;
+        }
+        
+        if (options.topicName.empty()) {
+            throw std::invalid_argument("Expected '--topic', or '--user-id' and '--serial-number'.");
+        }
+        
+        return options;
+    }
+    
+    /**
+     Sends every client's requests at its rates until the duration has elapsed. The clients' requests are spread evenly over each interval, rather than being sent in bursts.
+     */
+    uint64_t sendLoad(const Options &options, std::vector<std::unique_ptr<Client>> &clients) {
+        typedef std::tuple<Clock::time_point, size_t, LoadKind> ScheduledRequest;
+        std::priority_queue<ScheduledRequest, std::vector<ScheduledRequest>, std::greater<ScheduledRequest>> schedule;
+        std::map<LoadKind, Clock::duration> intervals;
+        
+        auto startTime = Clock::now();
+        for (auto pair : {std::make_pair(LoadKind::Command, options.commandRate), std::make_pair(LoadKind::Training, options.trainingRate)}) {
+            if (pair.second <= 0) {
+                continue;
+            }
+            
+            intervals[pair.first] = std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(1.0 / pair.second));
+            for (size_t i = 0; i < clients.size(); i++) {
+                schedule.emplace(startTime + intervals[pair.first] * i / clients.size(), i, pair.first);
+            }
+        }
+        
+        uint64_t sentCount = 0;
+        auto endTime = startTime + options.duration;
+        while (!schedule.empty() && std::get<0>(schedule.top()) < endTime) {
+            auto request = schedule.top();
+            schedule.pop();
+            
+            std::this_thread::sleep_until(std::get<0>(request));
+            clients[std::get<1>(request)]->send(std::get<2>(request), std::get<0>(request));
+            sentCount++;
+            
+            schedule.emplace(std::get<0>(request) + intervals[std::get<2>(request)], std::get<1>(request), std::get<2>(request));
+        }
+        
+        return sentCount;
+    }
+}
+
+int main(int argc, const char *argv[]) {
+    Options options;
+    try {
+        options = parseOptions(argc, argv);
+    } catch (const std::exception &exception) {
+        std::cerr << argv[0] << ": " << exception.what() << "\n\n";
+        printUsage(argv[0]);
+        return 2;
+    }
+    
+    try {
+        std::unique_ptr<MqttBroker> broker;
+        if (options.runsBroker) {
+            if (options.brokerCertificatePath.empty()) {
+                broker = std::make_unique<MqttBroker>(options.port);
+            } else {
+                TlsConfiguration configuration;
+                configuration.certificatePath = options.brokerCertificatePath;
+                configuration.privateKeyPath = options.brokerPrivateKeyPath;
+                configuration.verifiesPeer = false;
+                broker = std::make_unique<MqttBroker>(options.port, configuration);
+            }
+            
+            options.port = broker->getPort();
+            printf("Broker listening on 127.0.0.1:%u (%s)\n", options.port, broker->usesTLS() ? "TLS" : "plain");
+        }
+        
+        std::unique_ptr<Responder> responder;
+        if (options.responds) {
+            responder = std::make_unique<Responder>(options);
+            responder->connect();
+        }
+        
+        LatencyRecorder recorder;
+        std::vector<std::unique_ptr<Client>> clients;
+        for (size_t i = 0; i < options.clientCount; i++) {
+            clients.push_back(std::make_unique<Client>(options, i, recorder));
+            clients.back()->connect();
+        }
+        
+        printf("%zu clients sending %.1f commands and %.1f training messages per second each to '%s'\n", clients.size(), options.commandRate, options.trainingRate, options.topicName.c_str());
+        
+        auto startTime = Clock::now();
+        uint64_t sentCount = sendLoad(options, clients);
+        double sendingSeconds = std::chrono::duration<double>(Clock::now() - startTime).count();
+        
+        // Responses that arrive after the timeout are counted as lost.
+        auto pendingCount = [&clients]() {
+            size_t count = 0;
+            for (auto &client : clients) {
+                count += client->getPendingCount();
+            }
+            
+            return count;
+        };
+        
+        auto deadline = Clock::now() + options.responseTimeout;
+        while (pendingCount() > 0 && Clock::now() < deadline) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        }
+        
+        auto commandLatencies = recorder.getLatencies(LoadKind::Command);
+        auto trainingLatencies = recorder.getLatencies(LoadKind::Training);
+        auto allLatencies = commandLatencies;
+        allLatencies.insert(allLatencies.end(), trainingLatencies.begin(), trainingLatencies.end());
+        
+        uint64_t failedCount = 0;
+        for (auto &client : clients) {
+            failedCount += client->getFailedCount();
+        }
+        
+        printf("sent %llu in %.2f s (%.1f/s), answered %zu (%.1f/s), lost %zu, failed to publish %llu\n", (unsigned long long)sentCount, sendingSeconds, sentCount / sendingSeconds, allLatencies.size(), allLatencies.size() / sendingSeconds, pendingCount(), (unsigned long long)failedCount);
+        printLatencies("command", commandLatencies);
+        printLatencies("training", trainingLatencies);
+        printLatencies("all", allLatencies);
+        
+        if (broker != nullptr) {
+            auto statistics = broker->getStatistics();
+            printf("broker received %llu publishes, delivered %llu\n", (unsigned long long)statistics.receivedPublishCount, (unsigned long long)statistics.deliveredPublishCount);
+        }
+        
+        return pendingCount() == 0 && failedCount == 0 ? 0 : 1;
+    } catch (const std::exception &exception) {
+        std::cerr << argv[0] << ": " << exception.what() << std::endl;
+        return 1;
+    }
+}